@@ -0,0 +1,322 @@
+// allocator_bench.cpp
+#include "allocator_bench.h"
+
+#include <atomic>
+#include <stdlib.h>
+#include <thread>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/memory/stack_allocator.h"
+#include "demo/memory/thread_cache_allocator.h"
+#include "demo/memory/tlsf_allocator.h"
+#include "demo/utility/hash_utils.h"
+#include "demo/utility/histogram.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+namespace
+{
+
+// CONSTANTS
+/**
+ * The most threads the thread cache is measured with.
+ */
+constexpr uint32 MAX_THREADS = 16;
+
+/**
+ * The number of arrays each thread grows.
+ */
+constexpr uint32 ARRAYS_PER_THREAD = 20000;
+
+/**
+ * The number of elements pushed into each array.
+ */
+constexpr uint32 ARRAY_LENGTH = 256;
+
+/**
+ * The number of live allocation slots in the latency benchmarks.
+ */
+constexpr uint32 SLOT_COUNT = 1024;
+
+/**
+ * The number of operations in the latency benchmarks.
+ */
+constexpr uint32 LATENCY_OPS = 1000000;
+
+/**
+ * The size of the TLSF region.
+ */
+constexpr Size TLSF_REGION_SIZE = 64 * 1024 * 1024;
+
+// TYPES
+/**
+ * Allocates from the heap.
+ */
+struct HeapSource
+{
+    static const char* impl()
+    {
+        return "malloc";
+    }
+
+    void* allocate( Size bytes )
+    {
+        return malloc( bytes );
+    }
+
+    void release( void* pointer )
+    {
+        free( pointer );
+    }
+};
+
+/**
+ * Allocates from a TLSF region.
+ */
+class TlsfSource
+{
+  private:
+    void* _region;
+    mem::TlsfAllocator* _tlsf;
+
+  public:
+    static const char* impl()
+    {
+        return "demo::mem::TlsfAllocator";
+    }
+
+    TlsfSource() : _region( malloc( TLSF_REGION_SIZE ) )
+    {
+        _tlsf = new mem::TlsfAllocator( _region, TLSF_REGION_SIZE );
+    }
+
+    ~TlsfSource()
+    {
+        delete _tlsf;
+        free( _region );
+    }
+
+    void* allocate( Size bytes )
+    {
+        return _tlsf->allocate( bytes );
+    }
+
+    void release( void* pointer )
+    {
+        _tlsf->release( pointer );
+    }
+};
+
+// HELPER FUNCTIONS
+/**
+ * Gets a size between 16 bytes and 4 KiB that favors small sizes.
+ */
+Size randomSize( uint64 random )
+{
+    uint32 shift = 4 + static_cast<uint32>( random % 9 );
+    Size size = static_cast<Size>( 1 ) << shift;
+
+    return size + static_cast<Size>( ( random >> 8 ) % size );
+}
+
+/**
+ * Grows arrays with the given allocator on the given number of threads.
+ * Returns the wall time in nanoseconds.
+ */
+uint64 growArrays( mem::IAllocator<uint64>* allocator, uint32 threadCount )
+{
+    std::atomic<uint32> ready( 0 );
+    std::atomic<bool> go( false );
+
+    cntr::DynamicArray<std::thread*> threads;
+    for ( uint32 i = 0; i < threadCount; ++i )
+    {
+        threads.push( new std::thread( [&]() {
+            ready.fetch_add( 1 );
+            while ( !go.load() )
+            {
+                std::this_thread::yield();
+            }
+
+            for ( uint32 j = 0; j < ARRAYS_PER_THREAD; ++j )
+            {
+                cntr::DynamicArray<uint64> array( allocator );
+                for ( uint32 k = 0; k < ARRAY_LENGTH; ++k )
+                {
+                    array.push( k );
+                }
+                Harness::doNotOptimize( array[ARRAY_LENGTH - 1] );
+            }
+        } ) );
+    }
+
+    while ( ready.load() < threadCount )
+    {
+        std::this_thread::yield();
+    }
+
+    Stopwatch watch;
+    watch.start();
+    go.store( true );
+    for ( uint32 i = 0; i < threadCount; ++i )
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+    watch.stop();
+
+    return watch.elapsed();
+}
+
+/**
+ * Measures the latency of every allocation and release under a random mix.
+ */
+template <typename S>
+void benchLatency( Harness& harness )
+{
+    String name = "latency_mixed";
+    if ( !harness.isEnabled( name ) )
+    {
+        return;
+    }
+
+    S source;
+    void* slots[SLOT_COUNT] = {};
+
+    util::Histogram histogram;
+    uint64 total = 0;
+    for ( uint32 i = 0; i < LATENCY_OPS; ++i )
+    {
+        uint64 random = util::HashUtils::mix64( i );
+        uint32 slot = static_cast<uint32>( random % SLOT_COUNT );
+
+        uint64 start = Stopwatch::now();
+        if ( slots[slot] != nullptr )
+        {
+            source.release( slots[slot] );
+            slots[slot] = nullptr;
+        }
+        else
+        {
+            slots[slot] = source.allocate( randomSize( random >> 16 ) );
+        }
+        uint64 time = Stopwatch::now() - start;
+
+        histogram.record( time );
+        total += time;
+    }
+
+    for ( uint32 i = 0; i < SLOT_COUNT; ++i )
+    {
+        if ( slots[i] != nullptr )
+        {
+            source.release( slots[i] );
+        }
+    }
+
+    Harness::Result* result = harness.record( name, S::impl(), SLOT_COUNT,
+                                              LATENCY_OPS, total );
+    Harness::addMetric( result, "p50_ns",
+                        static_cast<double>( histogram.percentile( 50.0 ) ) );
+    Harness::addMetric( result, "p99_ns",
+                        static_cast<double>( histogram.percentile( 99.0 ) ) );
+    Harness::addMetric( result, "p99.9_ns",
+                        static_cast<double>( histogram.percentile( 99.9 ) ) );
+    Harness::addMetric( result, "p99.99_ns",
+                        static_cast<double>( histogram.percentile( 99.99 ) ) );
+    Harness::addMetric( result, "max_ns",
+                        static_cast<double>( histogram.max() ) );
+}
+
+/**
+ * Measures per-frame scratch allocations released all at once.
+ */
+void benchScratch( Harness& harness )
+{
+    const uint32 blocks = 64;
+    const uint32 frames = 10000;
+
+    mem::StackAllocator stack( 1024 * 1024 );
+    harness.run( "scratch_frame", "demo::mem::StackAllocator", blocks,
+                 blocks * frames, [&]() {
+        Stopwatch watch;
+        watch.start();
+        for ( uint32 i = 0; i < frames; ++i )
+        {
+            mem::StackAllocator::Marker marker = stack.marker();
+            for ( uint32 j = 0; j < blocks; ++j )
+            {
+                Harness::doNotOptimize( stack.allocate(
+                    randomSize( util::HashUtils::mix64( j ) ) ) );
+            }
+            stack.freeToMarker( marker );
+        }
+        watch.stop();
+
+        return watch.elapsed();
+    } );
+
+    harness.run( "scratch_frame", "malloc", blocks, blocks * frames, [&]() {
+        void* pointers[blocks];
+
+        Stopwatch watch;
+        watch.start();
+        for ( uint32 i = 0; i < frames; ++i )
+        {
+            for ( uint32 j = 0; j < blocks; ++j )
+            {
+                pointers[j] = malloc(
+                    randomSize( util::HashUtils::mix64( j ) ) );
+                Harness::doNotOptimize( pointers[j] );
+            }
+            for ( uint32 j = 0; j < blocks; ++j )
+            {
+                free( pointers[j] );
+            }
+        }
+        watch.stop();
+
+        return watch.elapsed();
+    } );
+}
+
+} // End nspc anonymous
+
+// UTILITY FUNCTIONS
+void AllocatorBench::run( Harness& harness )
+{
+    harness.setSuite( "allocator" );
+
+    // the size of a thread cache result is its thread count
+    for ( uint32 threads = 1; threads <= MAX_THREADS; threads *= 2 )
+    {
+        uint64 ops = static_cast<uint64>( threads ) * ARRAYS_PER_THREAD;
+
+        Harness::Result* result = harness.run(
+            "array_growth", "demo::mem::ThreadCacheAllocator", threads, ops,
+            [&]() {
+            return growArrays( mem::ThreadCacheAllocator<uint64>::inst(),
+                               threads );
+        } );
+        Harness::addMetric( result, "reserved_bytes", static_cast<double>(
+            mem::ThreadCacheHeap::reservedBytes() ) );
+
+        harness.run( "array_growth", "demo::mem::DefaultAllocator", threads,
+                     ops, [&]() {
+            return growArrays( nullptr, threads );
+        } );
+    }
+
+    benchLatency<TlsfSource>( harness );
+    benchLatency<HeapSource>( harness );
+
+    benchScratch( harness );
+}
+
+} // End nspc bench
+
+} // End nspc demo
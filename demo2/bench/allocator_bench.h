@@ -0,0 +1,34 @@
+// allocator_bench.h
+//
+// Compares the demo allocators with the default heap.
+//
+// The thread cache is measured by growing dynamic arrays on one to sixteen
+// threads at once. The TLSF and stack allocators are measured per operation
+// so that their tail latency can be compared with malloc.
+//
+#ifndef DEMO_BENCH_ALLOCATOR_BENCH_H
+#define DEMO_BENCH_ALLOCATOR_BENCH_H
+
+#include "harness.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+class AllocatorBench
+{
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Runs every allocator benchmark.
+     */
+    static void run( Harness& harness );
+};
+
+} // End nspc bench
+
+} // End nspc demo
+
+#endif // DEMO_BENCH_ALLOCATOR_BENCH_H
@@ -0,0 +1,743 @@
+// container_bench.cpp
+#include "container_bench.h"
+
+#include <list>
+#include <stdio.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/container/fixed_array.h"
+#include "demo/container/list.h"
+#include "demo/container/map.h"
+#include "demo/container/set.h"
+#include "demo/utility/hash_utils.h"
+#include "footprint.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+namespace
+{
+
+// CONSTANTS
+/**
+ * The most lookups done per lookup benchmark.
+ */
+constexpr uint64 MAX_LOOKUPS = 1000000;
+
+// HELPER FUNCTIONS
+/**
+ * Makes the integer key with the given index.
+ */
+void makeKey( uint64 index, uint64& key )
+{
+    key = util::HashUtils::mix64( index );
+}
+
+/**
+ * Makes the string key with the given index.
+ */
+void makeKey( uint64 index, String& key )
+{
+    char buffer[32];
+    snprintf( buffer, sizeof( buffer ), "models/%010llu.obj",
+              static_cast<unsigned long long>( index ) );
+    key = buffer;
+}
+
+/**
+ * Gets a value that depends on a key.
+ */
+uint64 checksum( uint64 key )
+{
+    return key;
+}
+
+uint64 checksum( const String& key )
+{
+    return key.size();
+}
+
+/**
+ * Makes the given number of keys starting at an index.
+ */
+template <typename K>
+void makeKeys( cntr::DynamicArray<K>& keys, uint64 first, uint64 count )
+{
+    for ( uint64 i = 0; i < count; ++i )
+    {
+        K key;
+        makeKey( first + i, key );
+        keys.push( std::move( key ) );
+    }
+}
+
+/**
+ * Makes a scattered order in which to visit the given number of items.
+ */
+void makeOrder( cntr::DynamicArray<uint32>& order, uint64 size, uint64 count )
+{
+    for ( uint64 i = 0; i < count; ++i )
+    {
+        order.push( static_cast<uint32>(
+            util::HashUtils::mix64( i ) % size ) );
+    }
+}
+
+// ADAPTERS
+template <typename K>
+class DemoMap
+{
+  private:
+    FootprintAllocator<typename cntr::Map<K, uint64>::Pair> _pairAlloc;
+    FootprintAllocator<uint32> _binAlloc;
+    cntr::Map<K, uint64> _map;
+
+  public:
+    static const char* impl()
+    {
+        return "demo::cntr::Map";
+    }
+
+    DemoMap() : _pairAlloc(), _binAlloc(), _map( &_pairAlloc, &_binAlloc )
+    {
+    }
+
+    void insert( const K& key, uint64 value )
+    {
+        _map.put( key, value );
+    }
+
+    uint64 find( const K& key ) const
+    {
+        return _map.has( key ) ? _map[key] : 0;
+    }
+
+    void erase( const K& key )
+    {
+        _map.remove( key );
+    }
+
+    uint64 sum() const
+    {
+        uint64 sum = 0;
+        for ( auto iter = _map.cbegin(); iter != _map.cend(); ++iter )
+        {
+            sum += iter->value;
+        }
+        return sum;
+    }
+};
+
+template <typename K>
+class StdMap
+{
+  private:
+    typedef StdFootprintAllocator<std::pair<const K, uint64>> Allocator;
+
+    std::unordered_map<K, uint64, std::hash<K>, std::equal_to<K>, Allocator>
+        _map;
+
+  public:
+    static const char* impl()
+    {
+        return "std::unordered_map";
+    }
+
+    void insert( const K& key, uint64 value )
+    {
+        _map[key] = value;
+    }
+
+    uint64 find( const K& key ) const
+    {
+        auto iter = _map.find( key );
+        return iter != _map.end() ? iter->second : 0;
+    }
+
+    void erase( const K& key )
+    {
+        _map.erase( key );
+    }
+
+    uint64 sum() const
+    {
+        uint64 sum = 0;
+        for ( auto iter = _map.begin(); iter != _map.end(); ++iter )
+        {
+            sum += iter->second;
+        }
+        return sum;
+    }
+};
+
+template <typename K>
+class DemoSet
+{
+  private:
+    FootprintAllocator<K> _valueAlloc;
+    FootprintAllocator<uint32> _binAlloc;
+    cntr::Set<K> _set;
+
+  public:
+    static const char* impl()
+    {
+        return "demo::cntr::Set";
+    }
+
+    DemoSet() : _valueAlloc(), _binAlloc(), _set( &_valueAlloc, &_binAlloc )
+    {
+    }
+
+    void insert( const K& key, uint64 value )
+    {
+        _set.add( key );
+    }
+
+    uint64 find( const K& key ) const
+    {
+        return _set.has( key ) ? 1 : 0;
+    }
+
+    void erase( const K& key )
+    {
+        _set.remove( key );
+    }
+
+    uint64 sum() const
+    {
+        uint64 sum = 0;
+        for ( auto iter = _set.cbegin(); iter != _set.cend(); ++iter )
+        {
+            sum += checksum( *iter );
+        }
+        return sum;
+    }
+};
+
+template <typename K>
+class StdSet
+{
+  private:
+    std::unordered_set<K, std::hash<K>, std::equal_to<K>,
+                       StdFootprintAllocator<K>> _set;
+
+  public:
+    static const char* impl()
+    {
+        return "std::unordered_set";
+    }
+
+    void insert( const K& key, uint64 value )
+    {
+        _set.insert( key );
+    }
+
+    uint64 find( const K& key ) const
+    {
+        return _set.count( key );
+    }
+
+    void erase( const K& key )
+    {
+        _set.erase( key );
+    }
+
+    uint64 sum() const
+    {
+        uint64 sum = 0;
+        for ( auto iter = _set.begin(); iter != _set.end(); ++iter )
+        {
+            sum += checksum( *iter );
+        }
+        return sum;
+    }
+};
+
+class DemoArray
+{
+  private:
+    FootprintAllocator<uint64> _alloc;
+    cntr::DynamicArray<uint64> _array;
+
+  public:
+    static const char* impl()
+    {
+        return "demo::cntr::DynamicArray";
+    }
+
+    explicit DemoArray( uint32 capacity ) : _alloc(), _array( &_alloc )
+    {
+    }
+
+    void push( uint64 value )
+    {
+        _array.push( value );
+    }
+
+    uint64 pop()
+    {
+        return _array.pop();
+    }
+
+    uint64 at( uint32 index ) const
+    {
+        return _array[index];
+    }
+
+    uint64 sum() const
+    {
+        uint64 sum = 0;
+        for ( auto iter = _array.cbegin(); iter != _array.cend(); ++iter )
+        {
+            sum += *iter;
+        }
+        return sum;
+    }
+};
+
+class StdVector
+{
+  protected:
+    std::vector<uint64, StdFootprintAllocator<uint64>> _vector;
+
+  public:
+    static const char* impl()
+    {
+        return "std::vector";
+    }
+
+    explicit StdVector( uint32 capacity )
+    {
+    }
+
+    void push( uint64 value )
+    {
+        _vector.push_back( value );
+    }
+
+    uint64 pop()
+    {
+        uint64 value = _vector.back();
+        _vector.pop_back();
+        return value;
+    }
+
+    uint64 at( uint32 index ) const
+    {
+        return _vector[index];
+    }
+
+    uint64 sum() const
+    {
+        uint64 sum = 0;
+        for ( auto iter = _vector.begin(); iter != _vector.end(); ++iter )
+        {
+            sum += *iter;
+        }
+        return sum;
+    }
+};
+
+class DemoFixedArray
+{
+  private:
+    FootprintAllocator<uint64> _alloc;
+    cntr::FixedArray<uint64> _array;
+
+  public:
+    static const char* impl()
+    {
+        return "demo::cntr::FixedArray";
+    }
+
+    explicit DemoFixedArray( uint32 capacity )
+        : _alloc(), _array( &_alloc, capacity )
+    {
+    }
+
+    void push( uint64 value )
+    {
+        _array.push( value );
+    }
+
+    uint64 pop()
+    {
+        return _array.pop();
+    }
+
+    uint64 at( uint32 index ) const
+    {
+        return _array[index];
+    }
+
+    uint64 sum() const
+    {
+        uint64 sum = 0;
+        for ( auto iter = _array.cbegin(); iter != _array.cend(); ++iter )
+        {
+            sum += *iter;
+        }
+        return sum;
+    }
+};
+
+class StdReservedVector : public StdVector
+{
+  public:
+    static const char* impl()
+    {
+        return "std::vector (reserved)";
+    }
+
+    explicit StdReservedVector( uint32 capacity ) : StdVector( capacity )
+    {
+        _vector.reserve( capacity );
+    }
+};
+
+class DemoList
+{
+  private:
+    FootprintAllocator<cntr::List<uint64>::Node> _alloc;
+    cntr::List<uint64> _list;
+
+  public:
+    static const char* impl()
+    {
+        return "demo::cntr::List";
+    }
+
+    explicit DemoList( uint32 capacity ) : _alloc(), _list( &_alloc )
+    {
+    }
+
+    void push( uint64 value )
+    {
+        _list.push( value );
+    }
+
+    uint64 pop()
+    {
+        return _list.pop();
+    }
+
+    uint64 sum() const
+    {
+        uint64 sum = 0;
+        for ( auto iter = _list.cbegin(); iter != _list.cend(); ++iter )
+        {
+            sum += *iter;
+        }
+        return sum;
+    }
+};
+
+class StdList
+{
+  private:
+    std::list<uint64, StdFootprintAllocator<uint64>> _list;
+
+  public:
+    static const char* impl()
+    {
+        return "std::list";
+    }
+
+    explicit StdList( uint32 capacity )
+    {
+    }
+
+    void push( uint64 value )
+    {
+        _list.push_back( value );
+    }
+
+    uint64 pop()
+    {
+        uint64 value = _list.back();
+        _list.pop_back();
+        return value;
+    }
+
+    uint64 sum() const
+    {
+        uint64 sum = 0;
+        for ( auto iter = _list.begin(); iter != _list.end(); ++iter )
+        {
+            sum += *iter;
+        }
+        return sum;
+    }
+};
+
+// BENCHMARKS
+/**
+ * Benchmarks inserting, looking up, iterating and erasing keys.
+ */
+template <typename A, typename K>
+void benchAssociative( Harness& harness, const String& name,
+                       const cntr::DynamicArray<K>& keys,
+                       const cntr::DynamicArray<K>& misses,
+                       const cntr::DynamicArray<uint32>& order )
+{
+    uint64 size = keys.size();
+    uint64 lookups = order.size();
+
+    Size footprint = 0;
+    Harness::Result* result = harness.run(
+        name + "/insert", A::impl(), size, size, [&]() {
+        Size base = Footprint::bytes();
+        Footprint::resetPeak();
+
+        A* container = new A();
+
+        Stopwatch watch;
+        watch.start();
+        for ( uint64 i = 0; i < size; ++i )
+        {
+            container->insert( keys[i], i );
+        }
+        watch.stop();
+
+        footprint = Footprint::peakBytes() - base;
+        delete container;
+
+        return watch.elapsed();
+    } );
+    Harness::addMetric( result, "bytes", static_cast<double>( footprint ) );
+    Harness::addMetric( result, "bytes_per_entry",
+                        static_cast<double>( footprint ) / size );
+
+    if ( harness.isEnabled( name + "/lookup_hit" ) ||
+         harness.isEnabled( name + "/lookup_miss" ) ||
+         harness.isEnabled( name + "/iterate" ) )
+    {
+        A container;
+        for ( uint64 i = 0; i < size; ++i )
+        {
+            container.insert( keys[i], i );
+        }
+
+        harness.run( name + "/lookup_hit", A::impl(), size, lookups, [&]() {
+            Stopwatch watch;
+            watch.start();
+            uint64 sum = 0;
+            for ( uint64 i = 0; i < lookups; ++i )
+            {
+                sum += container.find( keys[order[i]] );
+            }
+            watch.stop();
+
+            Harness::doNotOptimize( sum );
+            return watch.elapsed();
+        } );
+
+        harness.run( name + "/lookup_miss", A::impl(), size, lookups, [&]() {
+            Stopwatch watch;
+            watch.start();
+            uint64 sum = 0;
+            for ( uint64 i = 0; i < lookups; ++i )
+            {
+                sum += container.find( misses[i] );
+            }
+            watch.stop();
+
+            Harness::doNotOptimize( sum );
+            return watch.elapsed();
+        } );
+
+        harness.run( name + "/iterate", A::impl(), size, size, [&]() {
+            Stopwatch watch;
+            watch.start();
+            uint64 sum = container.sum();
+            watch.stop();
+
+            Harness::doNotOptimize( sum );
+            return watch.elapsed();
+        } );
+    }
+
+    harness.run( name + "/erase", A::impl(), size, size, [&]() {
+        A* container = new A();
+        for ( uint64 i = 0; i < size; ++i )
+        {
+            container->insert( keys[i], i );
+        }
+
+        Stopwatch watch;
+        watch.start();
+        for ( uint64 i = 0; i < size; ++i )
+        {
+            container->erase( keys[i] );
+        }
+        watch.stop();
+
+        delete container;
+        return watch.elapsed();
+    } );
+}
+
+/**
+ * Benchmarks filling, iterating and emptying a sequence.
+ */
+template <typename A>
+void benchSequence( Harness& harness, const String& name, uint64 size )
+{
+    uint32 capacity = static_cast<uint32>( size );
+
+    Size footprint = 0;
+    Harness::Result* result = harness.run(
+        name + "/push", A::impl(), size, size, [&]() {
+        Size base = Footprint::bytes();
+        Footprint::resetPeak();
+
+        A* container = new A( capacity );
+
+        Stopwatch watch;
+        watch.start();
+        for ( uint64 i = 0; i < size; ++i )
+        {
+            container->push( i );
+        }
+        watch.stop();
+
+        footprint = Footprint::peakBytes() - base;
+        delete container;
+
+        return watch.elapsed();
+    } );
+    Harness::addMetric( result, "bytes", static_cast<double>( footprint ) );
+    Harness::addMetric( result, "bytes_per_entry",
+                        static_cast<double>( footprint ) / size );
+
+    A container( capacity );
+    for ( uint64 i = 0; i < size; ++i )
+    {
+        container.push( i );
+    }
+
+    harness.run( name + "/iterate", A::impl(), size, size, [&]() {
+        Stopwatch watch;
+        watch.start();
+        uint64 sum = container.sum();
+        watch.stop();
+
+        Harness::doNotOptimize( sum );
+        return watch.elapsed();
+    } );
+
+    harness.run( name + "/pop", A::impl(), size, size, [&]() {
+        A* filled = new A( capacity );
+        for ( uint64 i = 0; i < size; ++i )
+        {
+            filled->push( i );
+        }
+
+        Stopwatch watch;
+        watch.start();
+        uint64 sum = 0;
+        for ( uint64 i = 0; i < size; ++i )
+        {
+            sum += filled->pop();
+        }
+        watch.stop();
+
+        delete filled;
+        Harness::doNotOptimize( sum );
+        return watch.elapsed();
+    } );
+}
+
+/**
+ * Benchmarks random access into a filled array.
+ */
+template <typename A>
+void benchIndex( Harness& harness, const String& name, uint64 size,
+                 const cntr::DynamicArray<uint32>& order )
+{
+    uint64 lookups = order.size();
+    A container( static_cast<uint32>( size ) );
+    for ( uint64 i = 0; i < size; ++i )
+    {
+        container.push( i );
+    }
+
+    harness.run( name + "/index", A::impl(), size, lookups, [&]() {
+        Stopwatch watch;
+        watch.start();
+        uint64 sum = 0;
+        for ( uint64 i = 0; i < lookups; ++i )
+        {
+            sum += container.at( order[i] );
+        }
+        watch.stop();
+
+        Harness::doNotOptimize( sum );
+        return watch.elapsed();
+    } );
+}
+
+/**
+ * Benchmarks the maps and sets with one key type.
+ */
+template <typename K>
+void benchKeys( Harness& harness, const char* keyName, uint64 size,
+                const cntr::DynamicArray<uint32>& order )
+{
+    cntr::DynamicArray<K> keys;
+    cntr::DynamicArray<K> misses;
+    makeKeys( keys, 0, size );
+    makeKeys( misses, size, order.size() );
+
+    String mapName = String( "Map<" ) + keyName + ">";
+    benchAssociative<DemoMap<K>>( harness, mapName, keys, misses, order );
+    benchAssociative<StdMap<K>>( harness, mapName, keys, misses, order );
+
+    String setName = String( "Set<" ) + keyName + ">";
+    benchAssociative<DemoSet<K>>( harness, setName, keys, misses, order );
+    benchAssociative<StdSet<K>>( harness, setName, keys, misses, order );
+}
+
+} // End nspc anonymous
+
+// UTILITY FUNCTIONS
+void ContainerBench::run( Harness& harness )
+{
+    harness.setSuite( "container" );
+
+    for ( uint32 i = 0; i < Harness::SIZE_COUNT; ++i )
+    {
+        uint64 size = Harness::SIZES[i];
+        if ( size > harness.options().maxSize )
+        {
+            break;
+        }
+
+        cntr::DynamicArray<uint32> order;
+        makeOrder( order, size, size < MAX_LOOKUPS ? size : MAX_LOOKUPS );
+
+        benchKeys<uint64>( harness, "uint64", size, order );
+        benchKeys<String>( harness, "String", size, order );
+
+        benchSequence<DemoArray>( harness, "Array", size );
+        benchSequence<StdVector>( harness, "Array", size );
+        benchIndex<DemoArray>( harness, "Array", size, order );
+        benchIndex<StdVector>( harness, "Array", size, order );
+
+        benchSequence<DemoFixedArray>( harness, "FixedArray", size );
+        benchSequence<StdReservedVector>( harness, "FixedArray", size );
+
+        benchSequence<DemoList>( harness, "List", size );
+        benchSequence<StdList>( harness, "List", size );
+    }
+}
+
+} // End nspc bench
+
+} // End nspc demo
@@ -0,0 +1,35 @@
+// container_bench.h
+//
+// Compares the demo containers with their standard equivalents.
+//
+// Maps and sets are measured with scattered integer keys and with path-like
+// string keys long enough to defeat the small string optimization. Sequences
+// are measured with integers. Every insert benchmark also reports the peak
+// memory held by the container.
+//
+#ifndef DEMO_BENCH_CONTAINER_BENCH_H
+#define DEMO_BENCH_CONTAINER_BENCH_H
+
+#include "harness.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+class ContainerBench
+{
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Runs every container benchmark.
+     */
+    static void run( Harness& harness );
+};
+
+} // End nspc bench
+
+} // End nspc demo
+
+#endif // DEMO_BENCH_CONTAINER_BENCH_H
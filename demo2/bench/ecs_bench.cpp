@@ -0,0 +1,240 @@
+// ecs_bench.cpp
+#include "ecs_bench.h"
+
+#include <algorithm>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/object/command_buffer.h"
+#include "demo/object/entity_registry.h"
+#include "demo/object/query.h"
+#include "demo/utility/hash_utils.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+namespace
+{
+
+// CONSTANTS
+/**
+ * The entity counts that are iterated per run.
+ */
+constexpr uint32 ENTITY_COUNTS[] = { 1000, 100000, 1000000 };
+
+/**
+ * The time step each entity is moved by.
+ */
+constexpr float TIME_STEP = 1.0f / 60.0f;
+
+// TYPES
+/**
+ * The position of an entity.
+ */
+struct Position
+{
+    float x;
+    float y;
+    float z;
+};
+
+/**
+ * The velocity of an entity.
+ */
+struct Velocity
+{
+    float x;
+    float y;
+    float z;
+};
+
+/**
+ * An entity that is moved through a virtual call.
+ */
+class Mover
+{
+  public:
+    virtual ~Mover()
+    {
+    }
+
+    virtual void tick( float dt ) = 0;
+};
+
+/**
+ * A mover with a position and velocity, standing in for an object.
+ */
+class BodyMover : public Mover
+{
+  public:
+    Position position;
+
+    Velocity velocity;
+
+    void tick( float dt ) override
+    {
+        position.x += velocity.x * dt;
+        position.y += velocity.y * dt;
+        position.z += velocity.z * dt;
+    }
+};
+
+// HELPER FUNCTIONS
+/**
+ * Gets a pseudo-random value in [0, 1).
+ */
+float randomValue( uint64 seed )
+{
+    uint64 random = util::HashUtils::mix64( seed );
+    return static_cast<float>( random & 0xFFFF ) / 65536.0f;
+}
+
+/**
+ * Measures moving every entity through a query over the chunks.
+ */
+void benchChunks( Harness& harness, uint32 count )
+{
+    obj::EntityRegistry registry;
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        obj::Entity entity = registry.create();
+        registry.add<Position>( entity, Position{ 0.0f, 0.0f, 0.0f } );
+        registry.add<Velocity>( entity, Velocity{ randomValue( i ), 0.0f,
+                                                  0.0f } );
+    }
+
+    obj::Query<Position, const Velocity> query( &registry );
+    Harness::Result* result = harness.run( "iterate", "archetype", count,
+                                           count, [&]() {
+        Stopwatch watch;
+        watch.start();
+        query.forEachChunk( [&]( uint32 size, const obj::Entity* entities,
+                                 Position* positions,
+                                 const Velocity* velocities ) {
+            for ( uint32 i = 0; i < size; ++i )
+            {
+                positions[i].x += velocities[i].x * TIME_STEP;
+                positions[i].y += velocities[i].y * TIME_STEP;
+                positions[i].z += velocities[i].z * TIME_STEP;
+            }
+        } );
+        watch.stop();
+
+        Harness::doNotOptimize( registry );
+        return watch.elapsed();
+    } );
+
+    // positions are read and written, velocities only read
+    if ( result != nullptr )
+    {
+        double bytes = static_cast<double>( sizeof( Position ) * 2 +
+                                            sizeof( Velocity ) );
+        Harness::addMetric( result, "gb_per_s", bytes / result->nsPerOp );
+    }
+}
+
+/**
+ * Measures moving every entity through a virtual call on each object.
+ */
+void benchVirtual( Harness& harness, uint32 count )
+{
+    cntr::DynamicArray<Mover*> movers;
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        BodyMover* mover = new BodyMover();
+        mover->position = Position{ 0.0f, 0.0f, 0.0f };
+        mover->velocity = Velocity{ randomValue( i ), 0.0f, 0.0f };
+        movers.push( mover );
+    }
+
+    // visit the objects in an order unrelated to where they were allocated
+    for ( uint32 i = count; i-- > 1; )
+    {
+        uint32 j = static_cast<uint32>( util::HashUtils::mix64( i ) %
+                                        ( i + 1 ) );
+        std::swap( movers[i], movers[j] );
+    }
+
+    harness.run( "iterate", "virtual", count, count, [&]() {
+        Stopwatch watch;
+        watch.start();
+        for ( uint32 i = 0; i < movers.size(); ++i )
+        {
+            movers[i]->tick( TIME_STEP );
+        }
+        watch.stop();
+
+        Harness::doNotOptimize( movers[0] );
+        return watch.elapsed();
+    } );
+
+    for ( uint32 i = 0; i < movers.size(); ++i )
+    {
+        delete movers[i];
+    }
+}
+
+/**
+ * Measures recording and flushing the creation of entities with components.
+ */
+void benchCommands( Harness& harness, uint32 count )
+{
+    obj::EntityRegistry registry;
+    obj::CommandBuffer commands;
+
+    harness.run( "create_deferred", "archetype", count, count, [&]() {
+        Stopwatch watch;
+        watch.start();
+        for ( uint32 i = 0; i < count; ++i )
+        {
+            obj::Entity entity = commands.create();
+            commands.add<Position>( entity, Position{ 0.0f, 0.0f, 0.0f } );
+            commands.add<Velocity>( entity, Velocity{ 1.0f, 0.0f, 0.0f } );
+        }
+        commands.flush( &registry );
+        watch.stop();
+
+        // start the next run from an empty registry without timing it
+        obj::Query<Position> query( &registry );
+        query.forEach( [&]( obj::Entity entity, Position& position ) {
+            commands.destroy( entity );
+        } );
+        commands.flush( &registry );
+
+        return watch.elapsed();
+    } );
+}
+
+} // End nspc anonymous
+
+// UTILITY FUNCTIONS
+void EcsBench::run( Harness& harness )
+{
+    harness.setSuite( "ecs" );
+
+    for ( uint32 i = 0; i < sizeof( ENTITY_COUNTS ) / sizeof( uint32 ); ++i )
+    {
+        uint32 count = ENTITY_COUNTS[i];
+        if ( count > harness.options().maxSize )
+        {
+            continue;
+        }
+
+        if ( harness.isEnabled( "iterate" ) )
+        {
+            benchChunks( harness, count );
+            benchVirtual( harness, count );
+        }
+
+        if ( harness.isEnabled( "create_deferred" ) )
+        {
+            benchCommands( harness, count );
+        }
+    }
+}
+
+} // End nspc bench
+
+} // End nspc demo
@@ -0,0 +1,36 @@
+// ecs_bench.h
+//
+// Compares iterating entities stored in archetype chunks with calling a
+// virtual tick on heap allocated objects.
+//
+// Both move every entity by its velocity. The objects are allocated one at a
+// time in a shuffled order, as they would be after a while of play, so the
+// virtual calls also pay for scattered memory. The bandwidth of the chunk
+// iteration is reported so it can be compared with that of the machine.
+//
+#ifndef DEMO_BENCH_ECS_BENCH_H
+#define DEMO_BENCH_ECS_BENCH_H
+
+#include "harness.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+class EcsBench
+{
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Runs every entity benchmark.
+     */
+    static void run( Harness& harness );
+};
+
+} // End nspc bench
+
+} // End nspc demo
+
+#endif // DEMO_BENCH_ECS_BENCH_H
@@ -0,0 +1,17 @@
+// footprint.cpp
+#include "footprint.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+// GLOBALS
+Size Footprint::g_bytes = 0;
+
+Size Footprint::g_peakBytes = 0;
+
+} // End nspc bench
+
+} // End nspc demo
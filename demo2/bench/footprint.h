@@ -0,0 +1,232 @@
+// footprint.h
+//
+// Allocators that measure how much memory a container holds.
+//
+// Both the demo allocator and the standard allocator report into the same
+// counters so that the footprint of a demo container can be compared with its
+// standard equivalent. Only the container's own storage is counted, not
+// memory owned by the elements.
+//
+#ifndef DEMO_BENCH_FOOTPRINT_H
+#define DEMO_BENCH_FOOTPRINT_H
+
+#include <assert.h>
+#include <new>
+
+#include "demo/intdef.h"
+#include "demo/memory/iallocator.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+class Footprint
+{
+  private:
+    // GLOBALS
+    /**
+     * The number of bytes currently allocated.
+     */
+    static Size g_bytes;
+
+    /**
+     * The most bytes allocated at once since the last reset.
+     */
+    static Size g_peakBytes;
+
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Counts an allocation.
+     */
+    static void allocated( Size bytes );
+
+    /**
+     * Counts a release.
+     */
+    static void released( Size bytes );
+
+    /**
+     * Gets the number of bytes currently allocated.
+     */
+    static Size bytes();
+
+    /**
+     * Gets the most bytes allocated at once since the last reset.
+     */
+    static Size peakBytes();
+
+    /**
+     * Restarts the peak from the current number of bytes.
+     */
+    static void resetPeak();
+};
+
+template <typename T>
+class FootprintAllocator : public mem::IAllocator<T>
+{
+  public:
+    // MEMBER FUNCTIONS
+    /**
+     * Allocates the given number of instances.
+     *
+     * Behavior is undefined when:
+     * count is less than or equal to zero
+     */
+    virtual T* get( uint32 count );
+
+    /**
+     * Releases the allocation with the given number of instances.
+     *
+     * Behavior is undefined when:
+     * pointer is invalid
+     * count is less than or equal to zero
+     */
+    virtual void release( T* pointer, uint32 count );
+};
+
+template <typename T>
+class StdFootprintAllocator
+{
+  public:
+    // TYPES
+    typedef T value_type;
+
+    // CONSTRUCTORS
+    /**
+     * Constructs a new allocator.
+     */
+    StdFootprintAllocator();
+
+    /**
+     * Constructs an allocator from one for another type.
+     */
+    template <typename U>
+    StdFootprintAllocator( const StdFootprintAllocator<U>& other );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Allocates storage for the given number of instances.
+     */
+    T* allocate( Size count );
+
+    /**
+     * Releases storage for the given number of instances.
+     */
+    void deallocate( T* pointer, Size count );
+};
+
+// UTILITY FUNCTIONS
+inline
+void Footprint::allocated( Size bytes )
+{
+    g_bytes += bytes;
+    if ( g_bytes > g_peakBytes )
+    {
+        g_peakBytes = g_bytes;
+    }
+}
+
+inline
+void Footprint::released( Size bytes )
+{
+    assert( g_bytes >= bytes );
+    g_bytes -= bytes;
+}
+
+inline
+Size Footprint::bytes()
+{
+    return g_bytes;
+}
+
+inline
+Size Footprint::peakBytes()
+{
+    return g_peakBytes;
+}
+
+inline
+void Footprint::resetPeak()
+{
+    g_peakBytes = g_bytes;
+}
+
+// MEMBER FUNCTIONS
+template <typename T>
+inline
+T* FootprintAllocator<T>::get( uint32 count )
+{
+    assert( count > 0 );
+
+    Footprint::allocated( count * sizeof( T ) );
+    return new T[count];
+}
+
+template <typename T>
+inline
+void FootprintAllocator<T>::release( T* pointer, uint32 count )
+{
+    assert( pointer != nullptr );
+    assert( count > 0 );
+
+    Footprint::released( count * sizeof( T ) );
+    delete[] pointer;
+}
+
+// STD CONSTRUCTORS
+template <typename T>
+inline
+StdFootprintAllocator<T>::StdFootprintAllocator()
+{
+}
+
+template <typename T>
+template <typename U>
+inline
+StdFootprintAllocator<T>::StdFootprintAllocator(
+    const StdFootprintAllocator<U>& other )
+{
+}
+
+// STD MEMBER FUNCTIONS
+template <typename T>
+inline
+T* StdFootprintAllocator<T>::allocate( Size count )
+{
+    Footprint::allocated( count * sizeof( T ) );
+    return static_cast<T*>( ::operator new( count * sizeof( T ) ) );
+}
+
+template <typename T>
+inline
+void StdFootprintAllocator<T>::deallocate( T* pointer, Size count )
+{
+    Footprint::released( count * sizeof( T ) );
+    ::operator delete( pointer );
+}
+
+// STD OPERATORS
+template <typename T, typename U>
+inline
+bool operator==( const StdFootprintAllocator<T>& lhs,
+                 const StdFootprintAllocator<U>& rhs )
+{
+    return true;
+}
+
+template <typename T, typename U>
+inline
+bool operator!=( const StdFootprintAllocator<T>& lhs,
+                 const StdFootprintAllocator<U>& rhs )
+{
+    return false;
+}
+
+} // End nspc bench
+
+} // End nspc demo
+
+#endif // DEMO_BENCH_FOOTPRINT_H
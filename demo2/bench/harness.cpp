@@ -0,0 +1,189 @@
+// harness.cpp
+#include "harness.h"
+
+#include <algorithm>
+
+namespace demo
+{
+
+namespace bench
+{
+
+// CONSTANTS
+constexpr uint64 Harness::SIZES[];
+constexpr uint32 Harness::SIZE_COUNT;
+
+// CONSTRUCTORS
+Harness::Harness( const Options& options ) : _options( options )
+{
+}
+
+Harness::~Harness()
+{
+    for ( uint32 i = 0; i < _results.size(); ++i )
+    {
+        delete _results[i];
+    }
+}
+
+// MEMBER FUNCTIONS
+bool Harness::isEnabled( const String& name ) const
+{
+    if ( _options.filter.empty() )
+    {
+        return true;
+    }
+
+    String qualified = _suite + "/" + name;
+    return qualified.find( _options.filter ) != String::npos;
+}
+
+Harness::Result* Harness::record( const String& name, const String& impl,
+                                  uint64 size, uint64 ops,
+                                  uint64 nanoseconds )
+{
+    if ( !isEnabled( name ) )
+    {
+        return nullptr;
+    }
+
+    cntr::DynamicArray<uint64> times;
+    times.push( nanoseconds );
+
+    return addResult( name, impl, size, ops, times );
+}
+
+void Harness::addMetric( Result* result, const String& name, double value )
+{
+    if ( result == nullptr )
+    {
+        return;
+    }
+
+    Metric metric;
+    metric.name = name;
+    metric.value = value;
+
+    result->metrics.push( metric );
+}
+
+void Harness::writeJson( FILE* file ) const
+{
+    fprintf( file, "{\n  \"schema\": 1,\n" );
+
+    #ifdef __VERSION__
+    fprintf( file, "  \"compiler\": " );
+    writeString( file, __VERSION__ );
+    fprintf( file, ",\n" );
+    #endif
+
+    #ifdef NDEBUG
+    fprintf( file, "  \"assertions\": false,\n" );
+    #else
+    fprintf( file, "  \"assertions\": true,\n" );
+    #endif
+
+    fprintf( file, "  \"results\": [" );
+    for ( uint32 i = 0; i < _results.size(); ++i )
+    {
+        const Result& result = *_results[i];
+
+        fprintf( file, "%s\n    {\"suite\": ", i == 0 ? "" : "," );
+        writeString( file, result.suite );
+        fprintf( file, ", \"name\": " );
+        writeString( file, result.name );
+        fprintf( file, ", \"impl\": " );
+        writeString( file, result.impl );
+        fprintf( file, ", \"size\": %llu, \"ops\": %llu, \"runs\": %u, "
+                 "\"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f, "
+                 "\"max_ns_per_op\": %.3f",
+                 static_cast<unsigned long long>( result.size ),
+                 static_cast<unsigned long long>( result.ops ), result.runs,
+                 result.nsPerOp, result.minNsPerOp, result.maxNsPerOp );
+
+        fprintf( file, ", \"metrics\": {" );
+        for ( uint32 j = 0; j < result.metrics.size(); ++j )
+        {
+            fprintf( file, "%s", j == 0 ? "" : ", " );
+            writeString( file, result.metrics[j].name );
+            fprintf( file, ": %.6g", result.metrics[j].value );
+        }
+        fprintf( file, "}}" );
+    }
+    fprintf( file, "\n  ]\n}\n" );
+}
+
+void Harness::writeSummary( FILE* file ) const
+{
+    for ( uint32 i = 0; i < _results.size(); ++i )
+    {
+        const Result& result = *_results[i];
+
+        fprintf( file, "%-10s %-32s %-20s %10llu %12.2f ns/op",
+                 result.suite.c_str(), result.name.c_str(),
+                 result.impl.c_str(),
+                 static_cast<unsigned long long>( result.size ),
+                 result.nsPerOp );
+
+        for ( uint32 j = 0; j < result.metrics.size(); ++j )
+        {
+            fprintf( file, "  %s=%.4g", result.metrics[j].name.c_str(),
+                     result.metrics[j].value );
+        }
+        fprintf( file, "\n" );
+    }
+}
+
+// HELPER FUNCTIONS
+Harness::Result* Harness::addResult( const String& name, const String& impl,
+                                     uint64 size, uint64 ops,
+                                     cntr::DynamicArray<uint64>& times )
+{
+    uint32 runs = times.size();
+    uint64* values = &times[0];
+    std::sort( values, values + runs );
+
+    double perOp = ops > 0 ? 1.0 / static_cast<double>( ops ) : 1.0;
+
+    Result* result = new Result();
+    result->suite = _suite;
+    result->name = name;
+    result->impl = impl;
+    result->size = size;
+    result->ops = ops;
+    result->runs = runs;
+    result->nsPerOp = static_cast<double>( values[runs / 2] ) * perOp;
+    result->minNsPerOp = static_cast<double>( values[0] ) * perOp;
+    result->maxNsPerOp = static_cast<double>( values[runs - 1] ) * perOp;
+
+    _results.push( result );
+
+    return result;
+}
+
+void Harness::writeString( FILE* file, const String& value )
+{
+    fputc( '"', file );
+    for ( Size i = 0; i < value.size(); ++i )
+    {
+        char c = value[i];
+        if ( c == '"' || c == '\\' )
+        {
+            fputc( '\\', file );
+            fputc( c, file );
+        }
+        else if ( static_cast<unsigned char>( c ) < 0x20 )
+        {
+            fprintf( file, "\\u%04x", c );
+        }
+        else
+        {
+            fputc( c, file );
+        }
+    }
+    fputc( '"', file );
+}
+
+} // End nspc bench
+
+} // End nspc demo
@@ -0,0 +1,346 @@
+// harness.h
+//
+// A small self-contained benchmark harness.
+//
+// A benchmark is a function that sets up its own state, times the part that
+// is being measured with a Stopwatch and returns the elapsed nanoseconds. The
+// harness runs it repeatedly until enough time has been measured and keeps
+// the median, fastest and slowest run. Results can carry extra named metrics
+// such as a memory footprint or a latency percentile and are written out as
+// JSON so that runs from different commits can be diffed.
+//
+#ifndef DEMO_BENCH_HARNESS_H
+#define DEMO_BENCH_HARNESS_H
+
+#include <chrono>
+#include <stdio.h>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/intdef.h"
+#include "demo/strdef.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+class Stopwatch
+{
+  private:
+    // TYPES
+    typedef std::chrono::steady_clock SysClock;
+
+    // MEMBERS
+    /**
+     * The time the stopwatch was started.
+     */
+    SysClock::time_point _start;
+
+    /**
+     * The accumulated time of stopped intervals.
+     */
+    uint64 _elapsed;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs a stopped stopwatch.
+     */
+    Stopwatch();
+
+    // MEMBER FUNCTIONS
+    /**
+     * Starts timing an interval.
+     */
+    void start();
+
+    /**
+     * Stops timing the interval and adds it to the total.
+     */
+    void stop();
+
+    /**
+     * Gets the total time of every stopped interval in nanoseconds.
+     */
+    uint64 elapsed() const;
+
+    // UTILITY FUNCTIONS
+    /**
+     * Gets the current time in nanoseconds.
+     */
+    static uint64 now();
+};
+
+class Harness
+{
+  public:
+    // TYPES
+    /**
+     * A named value attached to a result.
+     */
+    struct Metric
+    {
+        String name;
+        double value;
+    };
+
+    /**
+     * The outcome of one benchmark.
+     */
+    struct Result
+    {
+        String suite;
+        String name;
+        String impl;
+        uint64 size;
+        uint64 ops;
+        uint32 runs;
+        double nsPerOp;
+        double minNsPerOp;
+        double maxNsPerOp;
+        cntr::DynamicArray<Metric> metrics;
+    };
+
+    /**
+     * Controls what is run and for how long.
+     */
+    struct Options
+    {
+        String filter;
+        uint64 maxSize; // the largest container size in SIZES to run
+        uint64 minTimeNs;
+        uint32 maxRuns;
+    };
+
+    // CONSTANTS
+    /**
+     * The benchmark sizes, from which those up to the maximum size are run.
+     */
+    static constexpr uint64 SIZES[] = { 10, 1000, 100000, 1000000, 10000000 };
+
+    /**
+     * The number of benchmark sizes.
+     */
+    static constexpr uint32 SIZE_COUNT = 5;
+
+  private:
+    // MEMBERS
+    /**
+     * The options.
+     */
+    Options _options;
+
+    /**
+     * The suite that new results belong to.
+     */
+    String _suite;
+
+    /**
+     * The results so far.
+     */
+    cntr::DynamicArray<Result*> _results;
+
+    // HELPER FUNCTIONS
+    /**
+     * Adds a result from the run times.
+     */
+    Result* addResult( const String& name, const String& impl, uint64 size,
+                       uint64 ops, cntr::DynamicArray<uint64>& times );
+
+    /**
+     * Writes a string as a quoted JSON string.
+     */
+    static void writeString( FILE* file, const String& value );
+
+    /**
+     * Constructs a copy of the given harness.
+     *
+     * This is not a supported operation for harnesses.
+     */
+    Harness( const Harness& other );
+
+    /**
+     * Assigns this as a copy of the other harness.
+     *
+     * This is not a supported operation for harnesses.
+     */
+    Harness& operator=( const Harness& other );
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs a harness with the given options.
+     */
+    Harness( const Options& options );
+
+    /**
+     * Destructs the harness.
+     */
+    ~Harness();
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Gets the options.
+     */
+    const Options& options() const;
+
+    /**
+     * Gets the results so far.
+     */
+    const cntr::DynamicArray<Result*>& results() const;
+
+    // MUTATOR FUNCTIONS
+    /**
+     * Sets the suite that new results belong to.
+     */
+    void setSuite( const String& suite );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Checks if the benchmark with the given name passes the filter.
+     */
+    bool isEnabled( const String& name ) const;
+
+    /**
+     * Runs a benchmark that performs the given number of operations.
+     *
+     * The benchmark is given no arguments and returns the nanoseconds its
+     * timed part took. It is run at least once and then repeated until the
+     * minimum time has been measured or the maximum number of runs is
+     * reached.
+     *
+     * Returns null when the benchmark is filtered out.
+     */
+    template <typename F>
+    Result* run( const String& name, const String& impl, uint64 size,
+                 uint64 ops, F benchmark );
+
+    /**
+     * Records a result that was measured by the caller.
+     */
+    Result* record( const String& name, const String& impl, uint64 size,
+                    uint64 ops, uint64 nanoseconds );
+
+    /**
+     * Adds a named metric to a result.
+     * This does nothing if the result is null.
+     */
+    static void addMetric( Result* result, const String& name, double value );
+
+    /**
+     * Writes every result as JSON.
+     */
+    void writeJson( FILE* file ) const;
+
+    /**
+     * Writes a line per result for reading in a terminal.
+     */
+    void writeSummary( FILE* file ) const;
+
+    // UTILITY FUNCTIONS
+    /**
+     * Keeps the compiler from optimizing away the computation of a value.
+     */
+    template <typename T>
+    static void doNotOptimize( const T& value );
+};
+
+// STOPWATCH CONSTRUCTORS
+inline
+Stopwatch::Stopwatch() : _start(), _elapsed( 0 )
+{
+}
+
+// STOPWATCH MEMBER FUNCTIONS
+inline
+void Stopwatch::start()
+{
+    _start = SysClock::now();
+}
+
+inline
+void Stopwatch::stop()
+{
+    using namespace std::chrono;
+
+    _elapsed += static_cast<uint64>( duration_cast<nanoseconds>(
+        SysClock::now() - _start ).count() );
+}
+
+inline
+uint64 Stopwatch::elapsed() const
+{
+    return _elapsed;
+}
+
+inline
+uint64 Stopwatch::now()
+{
+    using namespace std::chrono;
+
+    return static_cast<uint64>( duration_cast<nanoseconds>(
+        SysClock::now().time_since_epoch() ).count() );
+}
+
+// ACCESSOR FUNCTIONS
+inline
+const Harness::Options& Harness::options() const
+{
+    return _options;
+}
+
+inline
+const cntr::DynamicArray<Harness::Result*>& Harness::results() const
+{
+    return _results;
+}
+
+// MUTATOR FUNCTIONS
+inline
+void Harness::setSuite( const String& suite )
+{
+    _suite = suite;
+}
+
+// MEMBER FUNCTIONS
+template <typename F>
+inline
+Harness::Result* Harness::run( const String& name, const String& impl,
+                               uint64 size, uint64 ops, F benchmark )
+{
+    if ( !isEnabled( name ) )
+    {
+        return nullptr;
+    }
+
+    cntr::DynamicArray<uint64> times;
+    uint64 total = 0;
+    do
+    {
+        uint64 time = benchmark();
+        times.push( time );
+        total += time;
+    } while ( total < _options.minTimeNs && times.size() < _options.maxRuns );
+
+    return addResult( name, impl, size, ops, times );
+}
+
+// UTILITY FUNCTIONS
+template <typename T>
+inline
+void Harness::doNotOptimize( const T& value )
+{
+    #ifdef __GNUC__
+    asm volatile( "" : : "r,m"( value ) : "memory" );
+    #else
+    static volatile const T* g_sink;
+    g_sink = &value;
+    #endif
+}
+
+} // End nspc bench
+
+} // End nspc demo
+
+#endif // DEMO_BENCH_HARNESS_H
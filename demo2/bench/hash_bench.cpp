@@ -0,0 +1,294 @@
+// hash_bench.cpp
+#include "hash_bench.h"
+
+#include <functional>
+#include <stdio.h>
+#include <string.h>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/utility/hash_utils.h"
+#include "demo/utility/hasher.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+namespace
+{
+
+// CONSTANTS
+/**
+ * The span lengths that throughput is measured with.
+ */
+constexpr Size SPAN_LENGTHS[] = { 8, 64, 1024, 64 * 1024 };
+
+/**
+ * The number of bytes hashed per throughput run.
+ */
+constexpr Size BYTES_PER_RUN = 16 * 1024 * 1024;
+
+/**
+ * The number of random inputs used to measure avalanche.
+ */
+constexpr uint32 AVALANCHE_SAMPLES = 4096;
+
+/**
+ * The number of keys used to measure the bucket distribution.
+ */
+constexpr uint32 BUCKET_KEYS = 1 << 16;
+
+/**
+ * The number of buckets, which puts the table at half load.
+ */
+constexpr uint32 BUCKET_COUNT = BUCKET_KEYS * 2;
+
+// TYPES
+typedef uint64 ( *SpanHash )( const void* data, Size length );
+
+// HELPER FUNCTIONS
+uint64 demoSpanHash( const void* data, Size length )
+{
+    return util::HashUtils::hash64( data, length );
+}
+
+uint64 fnvSpanHash( const void* data, Size length )
+{
+    return util::HashUtils::fnv1a64( static_cast<const char*>( data ),
+                                     length );
+}
+
+uint64 demoIntHash( const void* data, Size length )
+{
+    uint64 value;
+    memcpy( &value, data, sizeof( value ) );
+    return util::Hasher<uint64>::hash64( value );
+}
+
+uint64 stdIntHash( const void* data, Size length )
+{
+    uint64 value;
+    memcpy( &value, data, sizeof( value ) );
+    return std::hash<uint64>()( value );
+}
+
+/**
+ * Makes the string key with the given index.
+ */
+String makeKey( uint32 index )
+{
+    char buffer[32];
+    snprintf( buffer, sizeof( buffer ), "models/%010u.obj", index );
+    return String( buffer );
+}
+
+/**
+ * Measures the bytes per second of a span hash.
+ */
+void benchThroughput( Harness& harness, const char* impl, SpanHash hash,
+                      const cntr::DynamicArray<uint8>& data )
+{
+    for ( uint32 i = 0; i < sizeof( SPAN_LENGTHS ) / sizeof( Size ); ++i )
+    {
+        Size length = SPAN_LENGTHS[i];
+        uint64 ops = BYTES_PER_RUN / length;
+        uint64 spans = data.size() / length;
+
+        Harness::Result* result = harness.run(
+            "throughput", impl, length, ops, [&]() {
+            Stopwatch watch;
+            watch.start();
+            uint64 sum = 0;
+            for ( uint64 j = 0; j < ops; ++j )
+            {
+                sum += hash( &data[static_cast<uint32>(
+                    ( j % spans ) * length )], length );
+            }
+            watch.stop();
+
+            Harness::doNotOptimize( sum );
+            return watch.elapsed();
+        } );
+
+        if ( result != nullptr )
+        {
+            Harness::addMetric( result, "gb_per_s",
+                                static_cast<double>( length ) /
+                                result->nsPerOp );
+        }
+    }
+}
+
+/**
+ * Measures how far each output bit is from flipping with probability one
+ * half when a single input bit flips.
+ */
+void benchAvalanche( Harness& harness, const char* impl, SpanHash hash,
+                     Size length )
+{
+    if ( !harness.isEnabled( "avalanche" ) )
+    {
+        return;
+    }
+
+    const uint32 inputBits = static_cast<uint32>( length * 8 );
+    cntr::DynamicArray<uint32> flips;
+    for ( uint32 i = 0; i < inputBits * 64; ++i )
+    {
+        flips.push( 0 );
+    }
+
+    uint8 input[64];
+    Stopwatch watch;
+    watch.start();
+    for ( uint32 sample = 0; sample < AVALANCHE_SAMPLES; ++sample )
+    {
+        for ( Size i = 0; i < length; i += 8 )
+        {
+            uint64 random = util::HashUtils::mix64( sample * 8 + i + 1 );
+            memcpy( input + i, &random, 8 );
+        }
+
+        uint64 original = hash( input, length );
+        for ( uint32 bit = 0; bit < inputBits; ++bit )
+        {
+            input[bit / 8] ^= static_cast<uint8>( 1 << ( bit % 8 ) );
+            uint64 changed = original ^ hash( input, length );
+            input[bit / 8] ^= static_cast<uint8>( 1 << ( bit % 8 ) );
+
+            for ( uint32 out = 0; out < 64; ++out )
+            {
+                flips[bit * 64 + out] += ( changed >> out ) & 1;
+            }
+        }
+    }
+    watch.stop();
+
+    double meanBias = 0.0;
+    double maxBias = 0.0;
+    for ( uint32 i = 0; i < flips.size(); ++i )
+    {
+        double bias = static_cast<double>( flips[i] ) / AVALANCHE_SAMPLES -
+                      0.5;
+        bias = bias < 0.0 ? -bias : bias;
+
+        meanBias += bias;
+        maxBias = bias > maxBias ? bias : maxBias;
+    }
+    meanBias /= flips.size();
+
+    Harness::Result* result = harness.record(
+        "avalanche", impl, length,
+        static_cast<uint64>( AVALANCHE_SAMPLES ) * ( inputBits + 1 ),
+        watch.elapsed() );
+    Harness::addMetric( result, "mean_bias", meanBias );
+    Harness::addMetric( result, "max_bias", maxBias );
+}
+
+/**
+ * Measures how evenly hash codes fill the buckets of a half-full power of
+ * two table.
+ */
+void benchBuckets( Harness& harness, const char* name, const char* impl,
+                   const cntr::DynamicArray<uint32>& codes )
+{
+    if ( !harness.isEnabled( name ) )
+    {
+        return;
+    }
+
+    cntr::DynamicArray<uint32> counts;
+    for ( uint32 i = 0; i < BUCKET_COUNT; ++i )
+    {
+        counts.push( 0 );
+    }
+
+    for ( uint32 i = 0; i < codes.size(); ++i )
+    {
+        ++counts[codes[i] & ( BUCKET_COUNT - 1 )];
+    }
+
+    double expected = static_cast<double>( codes.size() ) / BUCKET_COUNT;
+    double chiSquared = 0.0;
+    uint32 maxLoad = 0;
+    uint32 usedBuckets = 0;
+    for ( uint32 i = 0; i < BUCKET_COUNT; ++i )
+    {
+        double difference = counts[i] - expected;
+        chiSquared += difference * difference / expected;
+        maxLoad = counts[i] > maxLoad ? counts[i] : maxLoad;
+        usedBuckets += counts[i] > 0 ? 1 : 0;
+    }
+
+    Harness::Result* result = harness.record( name, impl, codes.size(), 0,
+                                              0 );
+    Harness::addMetric( result, "chi2_ratio",
+                        chiSquared / ( BUCKET_COUNT - 1 ) );
+    Harness::addMetric( result, "max_load", maxLoad );
+    Harness::addMetric( result, "used_buckets", usedBuckets );
+}
+
+} // End nspc anonymous
+
+// UTILITY FUNCTIONS
+void HashBench::run( Harness& harness )
+{
+    harness.setSuite( "hash" );
+
+    // throughput
+    cntr::DynamicArray<uint8> data;
+    for ( uint32 i = 0; i < 1024 * 1024; ++i )
+    {
+        data.push( static_cast<uint8>( util::HashUtils::mix64( i ) ) );
+    }
+
+    benchThroughput( harness, "demo::util::HashUtils::hash64", &demoSpanHash,
+                     data );
+    benchThroughput( harness, "demo::util::HashUtils::fnv1a64", &fnvSpanHash,
+                     data );
+
+    // avalanche
+    benchAvalanche( harness, "demo::util::Hasher<uint64>", &demoIntHash, 8 );
+    benchAvalanche( harness, "std::hash<uint64>", &stdIntHash, 8 );
+    benchAvalanche( harness, "demo::util::HashUtils::hash64", &demoSpanHash,
+                    16 );
+    benchAvalanche( harness, "demo::util::HashUtils::fnv1a64", &fnvSpanHash,
+                    16 );
+
+    // buckets for aligned integer keys, such as addresses or ids with flags
+    cntr::DynamicArray<uint32> demoCodes;
+    cntr::DynamicArray<uint32> stdCodes;
+    for ( uint32 i = 0; i < BUCKET_KEYS; ++i )
+    {
+        uint64 key = static_cast<uint64>( i ) << 12;
+        demoCodes.push( util::Hasher<uint64>::hash( key ) );
+        stdCodes.push( static_cast<uint32>( std::hash<uint64>()( key ) ) );
+    }
+    benchBuckets( harness, "buckets_aligned_uint64",
+                  "demo::util::Hasher<uint64>", demoCodes );
+    benchBuckets( harness, "buckets_aligned_uint64", "std::hash<uint64>",
+                  stdCodes );
+
+    // buckets for path-like string keys
+    cntr::DynamicArray<uint32> fnvCodes;
+    demoCodes.clear();
+    stdCodes.clear();
+    for ( uint32 i = 0; i < BUCKET_KEYS; ++i )
+    {
+        String key = makeKey( i );
+        demoCodes.push( util::Hasher<String>::hash( key ) );
+        fnvCodes.push( util::HashUtils::fnv1a( key ) );
+        stdCodes.push( static_cast<uint32>( std::hash<String>()( key ) ) );
+    }
+    benchBuckets( harness, "buckets_path_string",
+                  "demo::util::Hasher<String>", demoCodes );
+    benchBuckets( harness, "buckets_path_string",
+                  "demo::util::HashUtils::fnv1a", fnvCodes );
+    benchBuckets( harness, "buckets_path_string", "std::hash<String>",
+                  stdCodes );
+}
+
+} // End nspc bench
+
+} // End nspc demo
@@ -0,0 +1,35 @@
+// hash_bench.h
+//
+// Measures the speed and quality of the hash functions.
+//
+// Throughput is measured over byte spans from 8 bytes to 64 KiB. Quality is
+// measured by the avalanche bias, how far each output bit is from flipping
+// half the time when a single input bit flips, and by how evenly keys fill a
+// power of two table indexed by the low bits as cntr::Map does.
+//
+#ifndef DEMO_BENCH_HASH_BENCH_H
+#define DEMO_BENCH_HASH_BENCH_H
+
+#include "harness.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+class HashBench
+{
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Runs every hash benchmark.
+     */
+    static void run( Harness& harness );
+};
+
+} // End nspc bench
+
+} // End nspc demo
+
+#endif // DEMO_BENCH_HASH_BENCH_H
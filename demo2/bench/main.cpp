@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator_bench.h"
+#include "container_bench.h"
+#include "ecs_bench.h"
+#include "hash_bench.h"
+#include "harness.h"
+#include "simd_bench.h"
+#include "spatial_bench.h"
+#include "transform_bench.h"
+
+#include "demo/utility/cpu_features.h"
+
+namespace
+{
+
+/**
+ * Gets the value of an option of the form --name=value or null.
+ */
+const char* optionValue( const char* argument, const char* name )
+{
+    size_t length = strlen( name );
+    if ( strncmp( argument, name, length ) == 0 && argument[length] == '=' )
+    {
+        return argument + length + 1;
+    }
+
+    return nullptr;
+}
+
+void printUsage()
+{
+    fprintf( stderr,
+             "usage: demo_bench [--filter=TEXT] [--max-size=N] "
+             "[--min-time=MS] [--max-runs=N] [--out=FILE]\n"
+             "  --filter    only run benchmarks whose suite/name contains "
+             "TEXT\n"
+             "  --max-size  largest container size to run, up to 10000000 "
+             "(default 1000000)\n"
+             "  --min-time  time to measure each benchmark for "
+             "(default 100)\n"
+             "  --max-runs  most runs of each benchmark (default 1000)\n"
+             "  --out       write the JSON results to FILE instead of "
+             "stdout\n" );
+}
+
+} // End nspc anonymous
+
+int main( int argc, char** argv )
+{
+    using namespace demo;
+
+    bench::Harness::Options options;
+    options.maxSize = 1000000;
+    options.minTimeNs = 100 * 1000000ULL;
+    options.maxRuns = 1000;
+
+    const char* outPath = nullptr;
+    for ( int i = 1; i < argc; ++i )
+    {
+        const char* value;
+        if ( ( value = optionValue( argv[i], "--filter" ) ) != nullptr )
+        {
+            options.filter = value;
+        }
+        else if ( ( value = optionValue( argv[i], "--max-size" ) ) != nullptr )
+        {
+            options.maxSize = strtoull( value, nullptr, 10 );
+        }
+        else if ( ( value = optionValue( argv[i], "--min-time" ) ) != nullptr )
+        {
+            options.minTimeNs = strtoull( value, nullptr, 10 ) * 1000000ULL;
+        }
+        else if ( ( value = optionValue( argv[i], "--max-runs" ) ) != nullptr )
+        {
+            options.maxRuns = static_cast<uint32>(
+                strtoul( value, nullptr, 10 ) );
+        }
+        else if ( ( value = optionValue( argv[i], "--out" ) ) != nullptr )
+        {
+            outPath = value;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if ( options.maxRuns == 0 )
+    {
+        options.maxRuns = 1;
+    }
+
+    util::CpuFeatures::describe( stderr );
+
+    // run benchmarks
+    bench::Harness harness( options );
+    bench::ContainerBench::run( harness );
+    bench::AllocatorBench::run( harness );
+    bench::HashBench::run( harness );
+    bench::SimdBench::run( harness );
+    bench::EcsBench::run( harness );
+    bench::TransformBench::run( harness );
+    bench::SpatialBench::run( harness );
+
+    // report results
+    harness.writeSummary( stderr );
+
+    FILE* out = stdout;
+    if ( outPath != nullptr )
+    {
+        out = fopen( outPath, "w" );
+        if ( out == nullptr )
+        {
+            fprintf( stderr, "Failed to open %s\n", outPath );
+            return 1;
+        }
+    }
+
+    harness.writeJson( out );
+
+    if ( out != stdout )
+    {
+        fclose( out );
+    }
+
+    return 0;
+}
@@ -0,0 +1,468 @@
+// simd_bench.cpp
+#include "simd_bench.h"
+
+#include <algorithm>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/utility/cpu_features.h"
+#include "demo/utility/hash_utils.h"
+#include "demo/utility/simd_kernels.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+namespace
+{
+
+// CONSTANTS
+/**
+ * The matrix counts that are multiplied per run, from a handful of objects to
+ * more than fit in the last level cache.
+ */
+constexpr uint32 MATRIX_COUNTS[] = { 16, 1000, 100000, 1000000 };
+
+/**
+ * The planes boxes are culled against: the middle half of the unit cube on
+ * every axis, which leaves about a fifth of the boxes inside.
+ */
+constexpr float CULL_PLANES[] = {  1.0f,  0.0f,  0.0f, -0.25f,
+                                  -1.0f,  0.0f,  0.0f,  0.75f,
+                                   0.0f,  1.0f,  0.0f, -0.25f,
+                                   0.0f, -1.0f,  0.0f,  0.75f,
+                                   0.0f,  0.0f,  1.0f, -0.25f,
+                                   0.0f,  0.0f, -1.0f,  0.75f };
+
+/**
+ * The triangle counts that are rasterized per run, from a few occluders to
+ * far more than the occlusion culler is meant for.
+ */
+constexpr uint32 TRIANGLE_COUNTS[] = { 16, 256, 4096 };
+
+/**
+ * The width of the depth buffer triangles are rasterized into.
+ */
+constexpr uint32 RASTER_WIDTH = 256;
+
+/**
+ * The height of the depth buffer triangles are rasterized into.
+ */
+constexpr uint32 RASTER_HEIGHT = 128;
+
+/**
+ * The farthest a triangle's vertices are from its first, in pixels.
+ */
+constexpr float RASTER_SPREAD = 48.0f;
+
+/**
+ * The word counts that are filled per run, from the bins of a small map to
+ * more than fit in the last level cache.
+ */
+constexpr uint32 FILL_COUNTS[] = { 64, 4096, 1000000 };
+
+// HELPER FUNCTIONS
+/**
+ * Fills an array with the given number of pseudo-random values.
+ */
+void fillValues( cntr::DynamicArray<float>& values, uint32 count,
+                 uint64 seed )
+{
+    values.clear();
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        uint64 random = util::HashUtils::mix64( seed + i );
+        values.push( static_cast<float>( random & 0xFFFF ) / 65536.0f );
+    }
+}
+
+/**
+ * Fills an array with the given number of pseudo-random triangles, at flat
+ * depths, as described by util::SimdKernels::rasterizeDepth.
+ */
+void fillTriangles( cntr::DynamicArray<float>& triangles, uint32 count )
+{
+    cntr::DynamicArray<float> values;
+    fillValues( values, count * 7, count );
+
+    triangles.clear();
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        const float* value = &values[i * 7];
+        float x[3];
+        float y[3];
+        x[0] = value[0] * RASTER_WIDTH;
+        y[0] = value[1] * RASTER_HEIGHT;
+        for ( uint32 j = 1; j < 3; ++j )
+        {
+            x[j] = x[0] + ( value[j * 2] * 2.0f - 1.0f ) * RASTER_SPREAD;
+            y[j] = y[0] + ( value[j * 2 + 1] * 2.0f - 1.0f ) * RASTER_SPREAD;
+        }
+
+        // the winding is made the one whose edge functions are positive
+        // inside
+        if ( ( x[1] - x[0] ) * ( y[2] - y[0] ) -
+             ( x[2] - x[0] ) * ( y[1] - y[0] ) < 0.0f )
+        {
+            std::swap( x[1], x[2] );
+            std::swap( y[1], y[2] );
+        }
+
+        for ( uint32 edge = 0; edge < 3; ++edge )
+        {
+            uint32 j = ( edge + 1 ) % 3;
+            uint32 k = ( edge + 2 ) % 3;
+            float dx = x[k] - x[j];
+            float dy = y[k] - y[j];
+            triangles.push( -dy );
+            triangles.push( dx );
+            triangles.push( dy * x[j] - dx * y[j] );
+        }
+
+        triangles.push( 0.0f );
+        triangles.push( 0.0f );
+        triangles.push( value[6] );
+
+        triangles.push( std::max( std::min( x[0], std::min( x[1], x[2] ) ),
+                                  0.0f ) );
+        triangles.push( std::max( std::min( y[0], std::min( y[1], y[2] ) ),
+                                  0.0f ) );
+        triangles.push( std::min( std::max( x[0], std::max( x[1], x[2] ) ),
+                                  RASTER_WIDTH - 1.0f ) );
+        triangles.push( std::min( std::max( y[0], std::max( y[1], y[2] ) ),
+                                  RASTER_HEIGHT - 1.0f ) );
+    }
+}
+
+/**
+ * Measures every supported implementation of the matrix multiply.
+ */
+void benchMultiply( Harness& harness )
+{
+    if ( !harness.isEnabled( "multiply_matrices" ) )
+    {
+        return;
+    }
+
+    cntr::DynamicArray<float> left;
+    cntr::DynamicArray<float> right;
+    cntr::DynamicArray<float> out;
+
+    const util::Dispatch<util::SimdKernels::MultiplyMatricesFn>& dispatch =
+        util::SimdKernels::multiplyMatricesDispatch();
+
+    for ( uint32 i = 0; i < sizeof( MATRIX_COUNTS ) / sizeof( uint32 ); ++i )
+    {
+        uint32 count = MATRIX_COUNTS[i];
+        if ( count > harness.options().maxSize )
+        {
+            continue;
+        }
+
+        fillValues( left, count * 16, 0 );
+        fillValues( right, count * 16, count * 16 );
+        fillValues( out, count * 16, 0 );
+
+        for ( uint32 tier = 0;
+              tier <= util::CpuFeatures::supportedTier();
+              ++tier )
+        {
+            util::SimdKernels::MultiplyMatricesFn multiply = dispatch.at(
+                static_cast<util::CpuFeatures::Tier>( tier ) );
+            if ( multiply == nullptr )
+            {
+                continue;
+            }
+
+            harness.run( "multiply_matrices",
+                         util::CpuFeatures::name(
+                             static_cast<util::CpuFeatures::Tier>( tier ) ),
+                         count, count, [&]() {
+                Stopwatch watch;
+                watch.start();
+                multiply( &out[0], &left[0], &right[0], count );
+                watch.stop();
+
+                Harness::doNotOptimize( out[count * 16 - 1] );
+                return watch.elapsed();
+            } );
+        }
+    }
+}
+
+/**
+ * Measures every supported implementation of the transform composition.
+ */
+void benchCompose( Harness& harness )
+{
+    if ( !harness.isEnabled( "compose_transforms" ) )
+    {
+        return;
+    }
+
+    const uint32 ROWS = util::SimdKernels::TRANSFORM_COMPONENTS;
+
+    cntr::DynamicArray<float> components;
+    cntr::DynamicArray<float> out;
+
+    const util::Dispatch<util::SimdKernels::ComposeTransformsFn>& dispatch =
+        util::SimdKernels::composeTransformsDispatch();
+
+    for ( uint32 i = 0; i < sizeof( MATRIX_COUNTS ) / sizeof( uint32 ); ++i )
+    {
+        uint32 count = MATRIX_COUNTS[i];
+        if ( count > harness.options().maxSize )
+        {
+            continue;
+        }
+
+        fillValues( components, count * ROWS, 0 );
+        fillValues( out, count * 16, 0 );
+
+        const float* rows[ROWS];
+        for ( uint32 row = 0; row < ROWS; ++row )
+        {
+            rows[row] = &components[row * count];
+        }
+
+        for ( uint32 tier = 0;
+              tier <= util::CpuFeatures::supportedTier();
+              ++tier )
+        {
+            util::SimdKernels::ComposeTransformsFn compose = dispatch.at(
+                static_cast<util::CpuFeatures::Tier>( tier ) );
+            if ( compose == nullptr )
+            {
+                continue;
+            }
+
+            harness.run( "compose_transforms",
+                         util::CpuFeatures::name(
+                             static_cast<util::CpuFeatures::Tier>( tier ) ),
+                         count, count, [&]() {
+                Stopwatch watch;
+                watch.start();
+                compose( &out[0], rows, count );
+                watch.stop();
+
+                Harness::doNotOptimize( out[count * 16 - 1] );
+                return watch.elapsed();
+            } );
+        }
+    }
+}
+
+/**
+ * Measures every supported implementation of the box culling.
+ */
+void benchCull( Harness& harness )
+{
+    if ( !harness.isEnabled( "cull_boxes" ) )
+    {
+        return;
+    }
+
+    const uint32 ROWS = util::SimdKernels::BOX_COMPONENTS;
+
+    cntr::DynamicArray<float> boxes;
+    cntr::DynamicArray<uint32> visible;
+
+    const util::Dispatch<util::SimdKernels::CullBoxesFn>& dispatch =
+        util::SimdKernels::cullBoxesDispatch();
+
+    for ( uint32 i = 0; i < sizeof( MATRIX_COUNTS ) / sizeof( uint32 ); ++i )
+    {
+        uint32 count = MATRIX_COUNTS[i];
+        if ( count > harness.options().maxSize )
+        {
+            continue;
+        }
+
+        // centers anywhere in the unit cube with small extents
+        fillValues( boxes, count * ROWS, 0 );
+        for ( uint32 j = 3 * count; j < ROWS * count; ++j )
+        {
+            boxes[j] *= 0.05f;
+        }
+
+        visible.clear();
+        for ( uint32 j = 0; j < count; ++j )
+        {
+            visible.push( 0 );
+        }
+
+        const float* rows[ROWS];
+        for ( uint32 row = 0; row < ROWS; ++row )
+        {
+            rows[row] = &boxes[row * count];
+        }
+
+        for ( uint32 tier = 0;
+              tier <= util::CpuFeatures::supportedTier();
+              ++tier )
+        {
+            util::SimdKernels::CullBoxesFn cull = dispatch.at(
+                static_cast<util::CpuFeatures::Tier>( tier ) );
+            if ( cull == nullptr )
+            {
+                continue;
+            }
+
+            harness.run( "cull_boxes",
+                         util::CpuFeatures::name(
+                             static_cast<util::CpuFeatures::Tier>( tier ) ),
+                         count, count, [&]() {
+                Stopwatch watch;
+                watch.start();
+                uint32 visibleCount = cull( &visible[0], CULL_PLANES, rows,
+                                            count );
+                watch.stop();
+
+                Harness::doNotOptimize( visibleCount );
+                return watch.elapsed();
+            } );
+        }
+    }
+}
+
+/**
+ * Measures every supported implementation of the depth rasterizer.
+ */
+void benchRasterize( Harness& harness )
+{
+    if ( !harness.isEnabled( "rasterize_depth" ) )
+    {
+        return;
+    }
+
+    const uint32 RECT[4] = { 0, 0, RASTER_WIDTH, RASTER_HEIGHT };
+
+    cntr::DynamicArray<float> triangles;
+    cntr::DynamicArray<uint32> indices;
+    cntr::DynamicArray<float> depth;
+    for ( uint32 i = 0; i < RASTER_WIDTH * RASTER_HEIGHT; ++i )
+    {
+        depth.push( 1.0f );
+    }
+
+    const util::Dispatch<util::SimdKernels::RasterizeDepthFn>& dispatch =
+        util::SimdKernels::rasterizeDepthDispatch();
+
+    for ( uint32 i = 0; i < sizeof( TRIANGLE_COUNTS ) / sizeof( uint32 ); ++i )
+    {
+        uint32 count = TRIANGLE_COUNTS[i];
+        if ( count > harness.options().maxSize )
+        {
+            continue;
+        }
+
+        fillTriangles( triangles, count );
+        indices.clear();
+        for ( uint32 j = 0; j < count; ++j )
+        {
+            indices.push( j );
+        }
+
+        for ( uint32 tier = 0;
+              tier <= util::CpuFeatures::supportedTier();
+              ++tier )
+        {
+            util::SimdKernels::RasterizeDepthFn rasterize = dispatch.at(
+                static_cast<util::CpuFeatures::Tier>( tier ) );
+            if ( rasterize == nullptr )
+            {
+                continue;
+            }
+
+            harness.run( "rasterize_depth",
+                         util::CpuFeatures::name(
+                             static_cast<util::CpuFeatures::Tier>( tier ) ),
+                         count, count, [&]() {
+                std::fill( &depth[0], &depth[0] + depth.size(), 1.0f );
+
+                Stopwatch watch;
+                watch.start();
+                rasterize( &depth[0], RASTER_WIDTH, RECT, &triangles[0],
+                           &indices[0], count );
+                watch.stop();
+
+                Harness::doNotOptimize( depth[depth.size() / 2] );
+                return watch.elapsed();
+            } );
+        }
+    }
+}
+
+/**
+ * Measures every supported implementation of the fill.
+ */
+void benchFill( Harness& harness )
+{
+    if ( !harness.isEnabled( "fill" ) )
+    {
+        return;
+    }
+
+    cntr::DynamicArray<uint32> out;
+
+    const util::Dispatch<util::SimdKernels::FillFn>& dispatch =
+        util::SimdKernels::fillDispatch();
+
+    for ( uint32 i = 0; i < sizeof( FILL_COUNTS ) / sizeof( uint32 ); ++i )
+    {
+        uint32 count = FILL_COUNTS[i];
+        if ( count > harness.options().maxSize )
+        {
+            continue;
+        }
+
+        while ( out.size() < count )
+        {
+            out.push( 0 );
+        }
+
+        for ( uint32 tier = 0;
+              tier <= util::CpuFeatures::supportedTier();
+              ++tier )
+        {
+            util::SimdKernels::FillFn fill = dispatch.at(
+                static_cast<util::CpuFeatures::Tier>( tier ) );
+            if ( fill == nullptr )
+            {
+                continue;
+            }
+
+            harness.run( "fill",
+                         util::CpuFeatures::name(
+                             static_cast<util::CpuFeatures::Tier>( tier ) ),
+                         count, count, [&]() {
+                Stopwatch watch;
+                watch.start();
+                fill( &out[0], count, count );
+                watch.stop();
+
+                Harness::doNotOptimize( out[count - 1] );
+                return watch.elapsed();
+            } );
+        }
+    }
+}
+
+} // End nspc anonymous
+
+// UTILITY FUNCTIONS
+void SimdBench::run( Harness& harness )
+{
+    harness.setSuite( "simd" );
+
+    benchMultiply( harness );
+    benchCompose( harness );
+    benchCull( harness );
+    benchRasterize( harness );
+    benchFill( harness );
+}
+
+} // End nspc bench
+
+} // End nspc demo
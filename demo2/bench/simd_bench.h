@@ -0,0 +1,35 @@
+// simd_bench.h
+//
+// Compares every SIMD tier of the hot math and raster kernels with the scalar
+// one.
+//
+// Only the tiers supported by the machine are measured. The implementation
+// name is the tier, so results from machines of different generations can be
+// lined up against each other.
+//
+#ifndef DEMO_BENCH_SIMD_BENCH_H
+#define DEMO_BENCH_SIMD_BENCH_H
+
+#include "harness.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+class SimdBench
+{
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Runs every SIMD kernel benchmark.
+     */
+    static void run( Harness& harness );
+};
+
+} // End nspc bench
+
+} // End nspc demo
+
+#endif // DEMO_BENCH_SIMD_BENCH_H
@@ -0,0 +1,624 @@
+// spatial_bench.cpp
+#include "spatial_bench.h"
+
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/object/bvh.h"
+#include "demo/object/spatial_hash.h"
+#include "demo/render/frustum.h"
+#include "demo/utility/hash_utils.h"
+#include "demo/utility/thread_pool.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+namespace
+{
+
+// CONSTANTS
+/**
+ * The box counts the index is measured with.
+ */
+constexpr uint32 BOX_COUNTS[] = { 10000, 100000, 1000000 };
+
+/**
+ * The space given to each box, as the side of a cube.
+ */
+constexpr float BOX_SPACING = 4.0f;
+
+/**
+ * The largest side of a box.
+ */
+constexpr float MAX_BOX_SIZE = 2.0f;
+
+/**
+ * The fraction of the boxes, as one over this, moved far per sparse run.
+ */
+constexpr uint32 SPARSE_RATIO = 100;
+
+/**
+ * The side of the boxes the index is queried with.
+ */
+constexpr float QUERY_SIZE = 16.0f;
+
+/**
+ * The number of box queries and rays per run.
+ */
+constexpr uint32 QUERY_COUNT = 1000;
+
+/**
+ * The number of box queries per run when every box is tested.
+ */
+constexpr uint32 SCAN_QUERY_COUNT = 16;
+
+/**
+ * The farthest a box moves per run when every box moves.
+ */
+constexpr float MAX_STEP = 2.0f;
+
+/**
+ * The distance pairs of boxes are found within.
+ */
+constexpr float PAIR_DISTANCE = 1.0f;
+
+// TYPES
+/**
+ * Boxes scattered through a cube.
+ */
+struct Scatter
+{
+    cntr::DynamicArray<rndr::Bounds> boxes;
+    float side;
+};
+
+// HELPER FUNCTIONS
+/**
+ * Gets a pseudo-random value in [0, 1).
+ */
+float randomValue( uint64 seed )
+{
+    uint64 random = util::HashUtils::mix64( seed );
+    return static_cast<float>( random & 0xFFFF ) / 65536.0f;
+}
+
+/**
+ * Gets a pseudo-random point in a cube with its corner at the origin.
+ */
+glm::vec3 randomPoint( uint64 seed, float side )
+{
+    return glm::vec3( randomValue( seed * 3 ), randomValue( seed * 3 + 1 ),
+                      randomValue( seed * 3 + 2 ) ) * side;
+}
+
+/**
+ * Gets a pseudo-random box around a point.
+ */
+rndr::Bounds randomBox( uint64 seed, const glm::vec3& center )
+{
+    glm::vec3 extents = ( glm::vec3( randomValue( seed + 7 ),
+                                     randomValue( seed + 11 ),
+                                     randomValue( seed + 13 ) ) + 0.25f ) *
+                        ( MAX_BOX_SIZE * 0.4f );
+    return rndr::Bounds( center - extents, center + extents,
+                         glm::length( extents ) );
+}
+
+/**
+ * Gets the given number of boxes scattered at the same density.
+ */
+Scatter scatter( uint32 count )
+{
+    Scatter result;
+    result.side = std::cbrt( static_cast<float>( count ) ) * BOX_SPACING;
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        result.boxes.push( randomBox( i, randomPoint( i, result.side ) ) );
+    }
+
+    return result;
+}
+
+/**
+ * Builds the tree from every box by the surface area heuristic.
+ */
+void build( obj::Bvh* bvh, const Scatter& boxes )
+{
+    bvh->invalidate();
+    for ( uint32 i = 0; i < boxes.boxes.size(); ++i )
+    {
+        bvh->createProxy( boxes.boxes[i] );
+    }
+    bvh->rebuild();
+}
+
+/**
+ * Gets a box moved by up to the largest step on each axis.
+ */
+rndr::Bounds step( uint64 seed, const rndr::Bounds& box )
+{
+    glm::vec3 offset = ( randomPoint( seed, 2.0f ) - 1.0f ) * MAX_STEP;
+    return rndr::Bounds( box.min() + offset, box.max() + offset,
+                         box.radius() );
+}
+
+/**
+ * Gets a 60 degree frustum from the middle of one face of the cube looking
+ * halfway across it.
+ */
+rndr::Frustum viewFrustum( float side )
+{
+    glm::vec3 eye( side * 0.5f, side * 0.5f, 0.0f );
+    glm::mat4 view = glm::lookAt( eye, eye + glm::vec3( 0.0f, 0.0f, 1.0f ),
+                                  glm::vec3( 0.0f, 1.0f, 0.0f ) );
+    glm::mat4 project = glm::perspective( glm::radians( 60.0f ), 1.0f,
+                                          0.1f, side * 0.5f );
+    return rndr::Frustum( project * view );
+}
+
+/**
+ * Gets the box of the given query.
+ */
+rndr::Bounds queryBox( uint64 seed, float side )
+{
+    glm::vec3 min = randomPoint( seed, side - QUERY_SIZE );
+    return rndr::Bounds( min, min + QUERY_SIZE,
+                         QUERY_SIZE * 0.5f * std::sqrt( 3.0f ) );
+}
+
+/**
+ * Checks if two boxes overlap.
+ */
+bool overlaps( const rndr::Bounds& a, const rndr::Bounds& b )
+{
+    return a.min().x <= b.max().x && b.min().x <= a.max().x &&
+           a.min().y <= b.max().y && b.min().y <= a.max().y &&
+           a.min().z <= b.max().z && b.min().z <= a.max().z;
+}
+
+/**
+ * Measures building a tree by the surface area heuristic and by inserting
+ * every box.
+ */
+void benchBuild( Harness& harness, const Scatter& boxes )
+{
+    if ( !harness.isEnabled( "bvh_build" ) )
+    {
+        return;
+    }
+
+    uint32 count = boxes.boxes.size();
+    obj::Bvh bvh;
+    Harness::Result* result = harness.run( "bvh_build", "sah", count, count,
+                                           [&]() {
+        bvh.clear();
+        Stopwatch watch;
+        watch.start();
+        build( &bvh, boxes );
+        watch.stop();
+
+        Harness::doNotOptimize( bvh.cost() );
+        return watch.elapsed();
+    } );
+    Harness::addMetric( result, "height", bvh.height() );
+    Harness::addMetric( result, "cost", bvh.cost() );
+
+    result = harness.run( "bvh_build", "insert", count, count, [&]() {
+        bvh.clear();
+        Stopwatch watch;
+        watch.start();
+        for ( uint32 i = 0; i < count; ++i )
+        {
+            bvh.createProxy( boxes.boxes[i] );
+        }
+        watch.stop();
+
+        Harness::doNotOptimize( bvh.cost() );
+        return watch.elapsed();
+    } );
+    Harness::addMetric( result, "height", bvh.height() );
+    Harness::addMetric( result, "cost", bvh.cost() );
+}
+
+/**
+ * Measures moving a sparse few boxes far, which reinserts them, and every
+ * box a little, which refits the tree.
+ */
+void benchMove( Harness& harness, const Scatter& boxes )
+{
+    if ( !harness.isEnabled( "bvh_move" ) )
+    {
+        return;
+    }
+
+    uint32 count = boxes.boxes.size();
+    obj::Bvh bvh;
+    build( &bvh, boxes );
+
+    uint64 run = 0;
+    uint32 sparse = count / SPARSE_RATIO;
+    harness.run( "bvh_move", "reinsert", count, sparse, [&]() {
+        ++run;
+        Stopwatch watch;
+        watch.start();
+        for ( uint32 i = 0; i < sparse; ++i )
+        {
+            uint32 proxy = static_cast<uint32>(
+                util::HashUtils::mix64( run * count + i ) % count );
+            bvh.moveProxy( proxy, randomBox( proxy, randomPoint(
+                run * count + i, boxes.side ) ) );
+        }
+        bvh.rebalance();
+        watch.stop();
+
+        Harness::doNotOptimize( bvh.cost() );
+        return watch.elapsed();
+    } );
+
+    build( &bvh, boxes );
+    run = 0;
+    harness.run( "bvh_move", "refit", count, count, [&]() {
+        // every box sways back and forth by a little more than the margin
+        ++run;
+        glm::vec3 offset( ( run & 1 ) != 0 ? 0.25f : 0.0f );
+
+        Stopwatch watch;
+        watch.start();
+        for ( uint32 i = 0; i < count; ++i )
+        {
+            const rndr::Bounds& box = boxes.boxes[i];
+            bvh.refitProxy( i, rndr::Bounds( box.min() + offset,
+                                             box.max() + offset,
+                                             box.radius() ) );
+        }
+        bvh.refit();
+        watch.stop();
+
+        Harness::doNotOptimize( bvh.cost() );
+        return watch.elapsed();
+    } );
+}
+
+/**
+ * Measures finding the boxes inside a frustum and overlapping boxes, with
+ * the tree and by testing every box.
+ */
+void benchQueries( Harness& harness, const Scatter& boxes )
+{
+    uint32 count = boxes.boxes.size();
+    obj::Bvh bvh;
+    build( &bvh, boxes );
+
+    if ( harness.isEnabled( "bvh_frustum" ) )
+    {
+        rndr::Frustum frustum = viewFrustum( boxes.side );
+        uint32 found = 0;
+        Harness::Result* result = harness.run( "bvh_frustum", "bvh", count,
+                                               1, [&]() {
+            found = 0;
+            Stopwatch watch;
+            watch.start();
+            bvh.queryFrustum( frustum, [&]( uint32 ) { ++found; } );
+            watch.stop();
+
+            Harness::doNotOptimize( found );
+            return watch.elapsed();
+        } );
+        Harness::addMetric( result, "found", found );
+
+        harness.run( "bvh_frustum", "scan", count, 1, [&]() {
+            found = 0;
+            Stopwatch watch;
+            watch.start();
+            for ( uint32 i = 0; i < count; ++i )
+            {
+                found += frustum.intersects( boxes.boxes[i] ) ? 1 : 0;
+            }
+            watch.stop();
+
+            Harness::doNotOptimize( found );
+            return watch.elapsed();
+        } );
+    }
+
+    if ( harness.isEnabled( "bvh_box" ) )
+    {
+        cntr::DynamicArray<rndr::Bounds> queries;
+        for ( uint32 i = 0; i < QUERY_COUNT; ++i )
+        {
+            queries.push( queryBox( i, boxes.side ) );
+        }
+
+        cntr::DynamicArray<uint32> proxies;
+        cntr::DynamicArray<uint32> ends;
+        Harness::Result* result = harness.run( "bvh_box", "bvh", count,
+                                               QUERY_COUNT, [&]() {
+            Stopwatch watch;
+            watch.start();
+            bvh.queryBoxes( &queries[0], QUERY_COUNT, &proxies, &ends );
+            watch.stop();
+
+            Harness::doNotOptimize( proxies.size() );
+            return watch.elapsed();
+        } );
+        Harness::addMetric( result, "found",
+                            static_cast<double>( proxies.size() ) /
+                            QUERY_COUNT );
+
+        harness.run( "bvh_box", "scan", count, SCAN_QUERY_COUNT, [&]() {
+            uint32 found = 0;
+            Stopwatch watch;
+            watch.start();
+            for ( uint32 query = 0; query < SCAN_QUERY_COUNT; ++query )
+            {
+                for ( uint32 i = 0; i < count; ++i )
+                {
+                    found += overlaps( queries[query], boxes.boxes[i] ) ?
+                             1 : 0;
+                }
+            }
+            watch.stop();
+
+            Harness::doNotOptimize( found );
+            return watch.elapsed();
+        } );
+    }
+
+    if ( harness.isEnabled( "bvh_ray" ) )
+    {
+        cntr::DynamicArray<obj::Bvh::Ray> rays;
+        cntr::DynamicArray<obj::Bvh::RayHit> hits;
+        for ( uint32 i = 0; i < QUERY_COUNT; ++i )
+        {
+            glm::vec3 direction = randomPoint( i + count, 2.0f ) - 1.0f;
+            rays.push( obj::Bvh::Ray{ randomPoint( i, boxes.side ),
+                                      glm::normalize( direction ),
+                                      boxes.side } );
+            hits.push( obj::Bvh::RayHit() );
+        }
+
+        harness.run( "bvh_ray", "single", count, QUERY_COUNT, [&]() {
+            Stopwatch watch;
+            watch.start();
+            bvh.raycast( &rays[0], QUERY_COUNT, &hits[0], nullptr );
+            watch.stop();
+
+            Harness::doNotOptimize( hits[0].distance );
+            return watch.elapsed();
+        } );
+
+        util::ThreadPool threadPool( util::ThreadPool::defaultThreadCount() );
+        harness.run( "bvh_ray", "batch", count, QUERY_COUNT, [&]() {
+            Stopwatch watch;
+            watch.start();
+            bvh.raycast( &rays[0], QUERY_COUNT, &hits[0], &threadPool );
+            watch.stop();
+
+            Harness::doNotOptimize( hits[0].distance );
+            return watch.elapsed();
+        } );
+    }
+}
+
+/**
+ * Measures moving every box of the hash, relinking each one that changes
+ * cells and sorting every box into its cell again.
+ */
+void benchHashMove( Harness& harness, const Scatter& boxes )
+{
+    if ( !harness.isEnabled( "hash_move" ) )
+    {
+        return;
+    }
+
+    uint32 count = boxes.boxes.size();
+    obj::SpatialHash hash( BOX_SPACING );
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        hash.createProxy( boxes.boxes[i] );
+    }
+
+    cntr::DynamicArray<rndr::Bounds> moved;
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        moved.push( step( i, boxes.boxes[i] ) );
+    }
+
+    // the boxes step back and forth so they stay scattered
+    uint64 run = 0;
+    uint32 changed = 0;
+    Harness::Result* result = harness.run( "hash_move", "relink", count,
+                                           count, [&]() {
+        const cntr::DynamicArray<rndr::Bounds>& target =
+            ( ++run & 1 ) != 0 ? moved : boxes.boxes;
+
+        changed = 0;
+        Stopwatch watch;
+        watch.start();
+        for ( uint32 i = 0; i < count; ++i )
+        {
+            changed += hash.moveProxy( i, target[i] ) ? 1 : 0;
+        }
+        hash.rebalance();
+        watch.stop();
+
+        Harness::doNotOptimize( hash.cellCount() );
+        return watch.elapsed();
+    } );
+    Harness::addMetric( result, "changed",
+                        static_cast<double>( changed ) / count );
+
+    harness.run( "hash_move", "rebuild", count, count, [&]() {
+        const cntr::DynamicArray<rndr::Bounds>& target =
+            ( ++run & 1 ) != 0 ? moved : boxes.boxes;
+
+        Stopwatch watch;
+        watch.start();
+        hash.invalidate();
+        for ( uint32 i = 0; i < count; ++i )
+        {
+            hash.moveProxy( i, target[i] );
+        }
+        hash.rebuild();
+        watch.stop();
+
+        Harness::doNotOptimize( hash.cellCount() );
+        return watch.elapsed();
+    } );
+}
+
+/**
+ * Measures finding spheres of boxes and every pair of near boxes, with the
+ * hash and with the tree.
+ */
+void benchHashQueries( Harness& harness, const Scatter& boxes )
+{
+    uint32 count = boxes.boxes.size();
+    obj::SpatialHash hash( BOX_SPACING );
+    obj::Bvh bvh;
+    build( &bvh, boxes );
+    hash.invalidate();
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        hash.createProxy( boxes.boxes[i] );
+    }
+    hash.rebuild();
+
+    if ( harness.isEnabled( "hash_sphere" ) )
+    {
+        cntr::DynamicArray<glm::vec3> centers;
+        for ( uint32 i = 0; i < QUERY_COUNT; ++i )
+        {
+            centers.push( randomPoint( i, boxes.side ) );
+        }
+
+        uint32 found = 0;
+        Harness::Result* result = harness.run( "hash_sphere", "hash", count,
+                                               QUERY_COUNT, [&]() {
+            found = 0;
+            Stopwatch watch;
+            watch.start();
+            for ( uint32 i = 0; i < QUERY_COUNT; ++i )
+            {
+                hash.querySphere( centers[i], QUERY_SIZE * 0.5f,
+                                  [&]( uint32 ) { ++found; } );
+            }
+            watch.stop();
+
+            Harness::doNotOptimize( found );
+            return watch.elapsed();
+        } );
+        Harness::addMetric( result, "found",
+                            static_cast<double>( found ) / QUERY_COUNT );
+
+        harness.run( "hash_sphere", "bvh", count, QUERY_COUNT, [&]() {
+            found = 0;
+            Stopwatch watch;
+            watch.start();
+            for ( uint32 i = 0; i < QUERY_COUNT; ++i )
+            {
+                bvh.querySphere( centers[i], QUERY_SIZE * 0.5f,
+                                 [&]( uint32 ) { ++found; } );
+            }
+            watch.stop();
+
+            Harness::doNotOptimize( found );
+            return watch.elapsed();
+        } );
+    }
+
+    if ( harness.isEnabled( "hash_pairs" ) )
+    {
+        cntr::DynamicArray<obj::SpatialHash::Pair> pairs;
+        Harness::Result* result = harness.run( "hash_pairs", "hash", count,
+                                               count, [&]() {
+            Stopwatch watch;
+            watch.start();
+            hash.queryPairs( PAIR_DISTANCE, &pairs, nullptr );
+            watch.stop();
+
+            Harness::doNotOptimize( pairs.size() );
+            return watch.elapsed();
+        } );
+        Harness::addMetric( result, "pairs", pairs.size() );
+
+        util::ThreadPool threadPool( util::ThreadPool::defaultThreadCount() );
+        harness.run( "hash_pairs", "hash_batch", count, count, [&]() {
+            Stopwatch watch;
+            watch.start();
+            hash.queryPairs( PAIR_DISTANCE, &pairs, &threadPool );
+            watch.stop();
+
+            Harness::doNotOptimize( pairs.size() );
+            return watch.elapsed();
+        } );
+
+        // the tree finds the pairs by querying around every box, which finds
+        // each pair twice
+        uint32 found = 0;
+        harness.run( "hash_pairs", "bvh", count, count, [&]() {
+            found = 0;
+            Stopwatch watch;
+            watch.start();
+            for ( uint32 i = 0; i < count; ++i )
+            {
+                const rndr::Bounds& box = boxes.boxes[i];
+                rndr::Bounds grown( box.min() - PAIR_DISTANCE,
+                                    box.max() + PAIR_DISTANCE,
+                                    box.radius() + PAIR_DISTANCE );
+                bvh.queryBox( grown, [&]( uint32 proxy ) {
+                    found += proxy > i ? 1 : 0;
+                } );
+            }
+            watch.stop();
+
+            Harness::doNotOptimize( found );
+            return watch.elapsed();
+        } );
+    }
+}
+
+} // End nspc anonymous
+
+// UTILITY FUNCTIONS
+void SpatialBench::run( Harness& harness )
+{
+    harness.setSuite( "spatial" );
+
+    if ( !harness.isEnabled( "bvh_build" ) &&
+         !harness.isEnabled( "bvh_move" ) &&
+         !harness.isEnabled( "bvh_frustum" ) &&
+         !harness.isEnabled( "bvh_box" ) &&
+         !harness.isEnabled( "bvh_ray" ) &&
+         !harness.isEnabled( "hash_move" ) &&
+         !harness.isEnabled( "hash_sphere" ) &&
+         !harness.isEnabled( "hash_pairs" ) )
+    {
+        return;
+    }
+
+    for ( uint32 i = 0; i < sizeof( BOX_COUNTS ) / sizeof( uint32 ); ++i )
+    {
+        uint32 count = BOX_COUNTS[i];
+        if ( count > harness.options().maxSize )
+        {
+            continue;
+        }
+
+        Scatter boxes = scatter( count );
+        benchBuild( harness, boxes );
+        benchMove( harness, boxes );
+        benchQueries( harness, boxes );
+        benchHashMove( harness, boxes );
+        benchHashQueries( harness, boxes );
+    }
+}
+
+} // End nspc bench
+
+} // End nspc demo
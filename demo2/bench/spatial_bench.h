@@ -0,0 +1,38 @@
+// spatial_bench.h
+//
+// Measures building, updating, and querying the bounding volume hierarchy
+// and the spatial hash.
+//
+// The boxes are scattered through a cube that grows with their number, so
+// every size has the same density and each query finds about as many boxes.
+// Queries are compared with testing every box, which is what the renderer
+// did before the scene kept a spatial index, and the hash is compared with
+// the tree for the spheres and near pairs that highly dynamic objects are
+// queried with.
+//
+#ifndef DEMO_BENCH_SPATIAL_BENCH_H
+#define DEMO_BENCH_SPATIAL_BENCH_H
+
+#include "harness.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+class SpatialBench
+{
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Runs every spatial index benchmark.
+     */
+    static void run( Harness& harness );
+};
+
+} // End nspc bench
+
+} // End nspc demo
+
+#endif // DEMO_BENCH_SPATIAL_BENCH_H
@@ -0,0 +1,106 @@
+// transform_bench.cpp
+#include "transform_bench.h"
+
+#include "demo/container/dynamic_array.h"
+#include "demo/object/transform_system.h"
+#include "demo/utility/hash_utils.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+namespace
+{
+
+// CONSTANTS
+/**
+ * The transform counts that are updated per run.
+ */
+constexpr uint32 TRANSFORM_COUNTS[] = { 16, 1000, 100000, 1000000 };
+
+/**
+ * The fraction of the transforms, as one over this, moved per sparse run.
+ */
+constexpr uint32 SPARSE_RATIO = 100;
+
+// HELPER FUNCTIONS
+/**
+ * Gets a pseudo-random value in [0, 1).
+ */
+float randomValue( uint64 seed )
+{
+    uint64 random = util::HashUtils::mix64( seed );
+    return static_cast<float>( random & 0xFFFF ) / 65536.0f;
+}
+
+/**
+ * Measures updating the given number of transforms, with every one of them
+ * moved or only a sparse few.
+ */
+void benchUpdate( Harness& harness, const String& impl, uint32 count,
+                  uint32 stride )
+{
+    obj::TransformSystem system;
+    cntr::DynamicArray<uint32> ids;
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        uint32 id = system.create();
+        system.setRotation( id, glm::normalize( glm::quat(
+            randomValue( i ), randomValue( i + count ),
+            randomValue( i + 2 * count ), randomValue( i + 3 * count ) ) ) );
+        ids.push( id );
+    }
+    system.update( nullptr );
+
+    uint32 ops = ( count + stride - 1 ) / stride;
+    uint64 run = 0;
+    harness.run( "update_transforms", impl, count, ops, [&]() {
+        for ( uint32 i = 0; i < count; i += stride )
+        {
+            uint32 id = ids[( i + run ) % count];
+            system.setPosition( id, glm::vec3( randomValue( i + run ) ) );
+        }
+        ++run;
+
+        Stopwatch watch;
+        watch.start();
+        system.update( nullptr );
+        watch.stop();
+
+        Harness::doNotOptimize( system.worldMatrix( ids[0] ) );
+        return watch.elapsed();
+    } );
+}
+
+} // End nspc anonymous
+
+// UTILITY FUNCTIONS
+void TransformBench::run( Harness& harness )
+{
+    harness.setSuite( "transform" );
+
+    if ( !harness.isEnabled( "update_transforms" ) )
+    {
+        return;
+    }
+
+    for ( uint32 i = 0;
+          i < sizeof( TRANSFORM_COUNTS ) / sizeof( uint32 );
+          ++i )
+    {
+        uint32 count = TRANSFORM_COUNTS[i];
+        if ( count > harness.options().maxSize )
+        {
+            continue;
+        }
+
+        benchUpdate( harness, "all", count, 1 );
+        benchUpdate( harness, "sparse", count, SPARSE_RATIO );
+    }
+}
+
+} // End nspc bench
+
+} // End nspc demo
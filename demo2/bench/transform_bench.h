@@ -0,0 +1,34 @@
+// transform_bench.h
+//
+// Measures updating the world matrices of the transform system.
+//
+// Every transform is a root, so the results show the cost of streaming the
+// components through the compose kernel and writing the matrices. The sizes
+// run from a handful of objects to more than fit in the last level cache.
+//
+#ifndef DEMO_BENCH_TRANSFORM_BENCH_H
+#define DEMO_BENCH_TRANSFORM_BENCH_H
+
+#include "harness.h"
+
+namespace demo
+{
+
+namespace bench
+{
+
+class TransformBench
+{
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Runs every transform benchmark.
+     */
+    static void run( Harness& harness );
+};
+
+} // End nspc bench
+
+} // End nspc demo
+
+#endif // DEMO_BENCH_TRANSFORM_BENCH_H
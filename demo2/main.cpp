@@ -1,12 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "demo/demo.h"
+#include "demo/stress_test.h"
+#include "demo/utility/log.h"
+#include "demo/utility/profiler.h"
+
+namespace
+{
+
+/**
+ * Gets the value of an option of the form --name=value or null.
+ */
+const char* optionValue( const char* argument, const char* name )
+{
+    size_t length = strlen( name );
+    if ( strncmp( argument, name, length ) == 0 && argument[length] == '=' )
+    {
+        return argument + length + 1;
+    }
+
+    return nullptr;
+}
+
+void printUsage()
+{
+    fprintf( stderr,
+             "usage: demo2 [--stress=N] [--frames=K] [--log=PATH] "
+             "[--trace=PATH]\n"
+             "  --stress  draw N objects (10 to 100000) along a scripted "
+             "camera path\n"
+             "            and report the time of each phase and the GL "
+             "calls made\n"
+             "  --frames  the number of stress test frames (default 600)\n"
+             "  --log     write log messages to PATH instead of stdout\n"
+             "  --trace   write a Chrome trace of the run to PATH (needs "
+             "DEMO_PROFILE)\n" );
+}
+
+/**
+ * Stops capturing profiler events and writes the trace if one was asked for.
+ */
+void writeTrace( const char* path )
+{
+    using namespace demo;
 
-int main()
+    if ( path != nullptr && !util::Profiler::stopCapture( String( path ) ) )
+    {
+        DEMO_LOG_ERROR( "profile", "Failed to write the trace to %s", path );
+    }
+}
+
+} // End nspc anonymous
+
+int main( int argc, char** argv )
 {
+    using namespace demo;
+
+    // a headless window never closes so only the stress test can run
+    #ifdef DEMO_HEADLESS
+    bool isStress = true;
+    #else
+    bool isStress = false;
+    #endif
+
+    uint32 objectCount = StressTest::DEFAULT_OBJECTS;
+    uint32 frameCount = StressTest::DEFAULT_FRAMES;
+    const char* logPath = nullptr;
+    const char* tracePath = nullptr;
+    for ( int i = 1; i < argc; ++i )
+    {
+        const char* value;
+        if ( ( value = optionValue( argv[i], "--stress" ) ) != nullptr )
+        {
+            isStress = true;
+            objectCount = static_cast<uint32>( strtoul( value, nullptr, 10 ) );
+        }
+        else if ( ( value = optionValue( argv[i], "--frames" ) ) != nullptr )
+        {
+            frameCount = static_cast<uint32>( strtoul( value, nullptr, 10 ) );
+        }
+        else if ( ( value = optionValue( argv[i], "--log" ) ) != nullptr )
+        {
+            logPath = value;
+        }
+        else if ( ( value = optionValue( argv[i], "--trace" ) ) != nullptr )
+        {
+            tracePath = value;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // start logging
+    if ( logPath == nullptr || !util::Log::startup( String( logPath ) ) )
+    {
+        util::Log::startup( stdout );
+    }
+    util::Log::installCrashHandler();
+
+    // capture profiler events only when a trace was asked for
+    if ( tracePath != nullptr )
+    {
+        util::Profiler::startCapture();
+    }
+
+    // run stress test
+    if ( isStress )
+    {
+        StressTest test( objectCount, frameCount );
+        if ( !test.startup() )
+        {
+            util::Log::shutdown();
+            return 1;
+        }
+        bool isAllocationFree = test.run();
+        if ( !isAllocationFree )
+        {
+            DEMO_LOG_ERROR( "stress", "Frames allocated after the warm-up" );
+        }
+
+        // keep pending messages out of the report
+        util::Log::flush();
+        test.report( stdout );
+        test.shutdown();
+        writeTrace( tracePath );
+        util::Log::shutdown();
+
+        return isAllocationFree ? 0 : 1;
+    }
+
     // run demo
     demo::Demo demo;
     demo.startup();
     demo.run();
     demo.shutdown();
+    writeTrace( tracePath );
+    util::Log::shutdown();
 
     return 0;
-}
\ No newline at end of file
+}
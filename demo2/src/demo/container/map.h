@@ -51,6 +51,13 @@ class Map
      */
     static constexpr uint32 BIN_EMPTY = static_cast<uint32>( -1 );
 
+    /**
+     * Defines a bin whose pair was removed.
+     *
+     * Lookups probe past it so that keys placed after it are still found.
+     */
+    static constexpr uint32 BIN_REMOVED = static_cast<uint32>( -2 );
+
     /**
      * The threshold percentage at which the map grows.
      */
@@ -83,7 +90,8 @@ class Map
     uint32* _bins;
 
     /**
-     * The number of bins in use.
+     * The number of bins that hold a pair or were removed since the last
+     * resize.
      */
     uint32 _binsInUse;
 
@@ -152,7 +160,8 @@ class Map
     bool shouldGrow() const;
 
     /**
-     * Grows the bin array to twice the current capacity.
+     * Grows the bin array to twice the current capacity, or rehashes it at
+     * the same capacity when most used bins were removed.
      */
     void grow();
 
@@ -413,6 +422,9 @@ constexpr uint32 Map<K, V>::MIN_BINS;
 template <typename K, typename V>
 constexpr uint32 Map<K, V>::BIN_EMPTY;
 
+template <typename K, typename V>
+constexpr uint32 Map<K, V>::BIN_REMOVED;
+
 template <typename K, typename V>
 constexpr uint32 Map<K, V>::GROW_THRESHOLD;
 
@@ -643,6 +655,11 @@ V& Map<K, V>::operator[]( const K& key )
 template <typename K, typename V>
 void Map<K, V>::put( const K& key, const V& value )
 {
+    if ( shouldGrow() )
+    {
+        grow();
+    }
+
     uint32 binIndex = findBinForKey( key );
 
     if ( isBinEmpty( binIndex ) )
@@ -660,6 +677,11 @@ void Map<K, V>::put( const K& key, const V& value )
 template <typename K, typename V>
 void Map<K, V>::put( const K& key, V&& value )
 {
+    if ( shouldGrow() )
+    {
+        grow();
+    }
+
     uint32 binIndex = findBinForKey( key );
 
     if ( isBinEmpty( binIndex ) )
@@ -683,23 +705,21 @@ V Map<K, V>::remove( const K& key )
     }
 
     uint32 binIndex = findBinForKey( key );
-    uint32 i;
-
     assert( !isBinEmpty( binIndex ) );
 
-    --_binsInUse;
-    V value( _pairs.removeAt( _bins[binIndex] ).value );
+    uint32 index = _bins[binIndex];
+    uint32 last = _pairs.size() - 1;
+    V value( std::move( _pairs[index].value ) );
 
-    // correct bin indices
-    for ( i = 0; i < _binCount; ++i )
+    // move the last pair into the hole so no other bin needs correcting
+    if ( index != last )
     {
-        if ( !isBinEmpty( i ) && _bins[i] > _bins[binIndex] )
-        {
-            --( _bins[i] );
-        }
+        _bins[findBinForKey( _pairs[last].key )] = index;
+        _pairs[index] = std::move( _pairs[last] );
     }
 
-    _bins[binIndex] = BIN_EMPTY;
+    _pairs.pop();
+    _bins[binIndex] = BIN_REMOVED;
 
     return value;
 }
@@ -836,14 +856,14 @@ inline
 bool Map<K, V>::doesBinContain( uint32 binIndex, const K& key ) const
 {
     return binIndex < _binCount && !isBinEmpty( binIndex ) &&
-       _pairs[_bins[binIndex]].key == key;
+       _bins[binIndex] != BIN_REMOVED && _pairs[_bins[binIndex]].key == key;
 }
 
 template <typename K, typename V>
 inline
 bool Map<K, V>::shouldShrink() const
 {
-    return ( ( _binsInUse * 100 ) / _binCount ) <= SHRINK_THRESHOLD &&
+    return ( ( _pairs.size() * 100 ) / _binCount ) <= SHRINK_THRESHOLD &&
            _binCount > MIN_BINS;
 }
 
@@ -858,7 +878,15 @@ template <typename K, typename V>
 inline
 void Map<K, V>::grow()
 {
-    resize( _binCount << 1 );
+    // rehash in place when most of the used bins were removed
+    if ( ( _pairs.size() * 100 ) / _binCount < GROW_THRESHOLD / 2 )
+    {
+        resize( _binCount );
+    }
+    else
+    {
+        resize( _binCount << 1 );
+    }
 }
 
 template <typename K, typename V>
@@ -875,6 +903,7 @@ void Map<K, V>::resize( uint32 newSize )
     _binAlloc.release( _bins, _binCount );
     _bins = _binAlloc.get( newSize );
     _binCount = newSize;
+    _binsInUse = _pairs.size();
     clearBins();
 
     uint32 i;
@@ -44,6 +44,13 @@ class Set
      */
     static constexpr uint32 BIN_EMPTY = static_cast<uint32>( -1 );
 
+    /**
+     * Defines a bin whose value was removed.
+     *
+     * Lookups probe past it so that values placed after it are still found.
+     */
+    static constexpr uint32 BIN_REMOVED = static_cast<uint32>( -2 );
+
     /**
      * The threshold percentage at which the map grows.
      */
@@ -76,7 +83,8 @@ class Set
     uint32* _bins;
 
     /**
-     * The number of bins currently in use.
+     * The number of bins that hold a value or were removed since the last
+     * resize.
      */
     uint32 _binsInUse;
 
@@ -135,7 +143,8 @@ class Set
     bool shouldGrow() const;
 
     /**
-     * Grows the bin array to twice the current capacity.
+     * Grows the bin array to twice the current capacity, or rehashes it at
+     * the same capacity when most used bins were removed.
      */
     void grow();
 
@@ -385,6 +394,9 @@ constexpr uint32 Set<T>::MIN_BINS;
 template <typename T>
 constexpr uint32 Set<T>::BIN_EMPTY;
 
+template <typename T>
+constexpr uint32 Set<T>::BIN_REMOVED;
+
 template <typename T>
 constexpr uint32 Set<T>::GROW_THRESHOLD;
 
@@ -633,22 +645,20 @@ void Set<T>::remove( const T& value )
     }
 
     uint32 binIndex = findBinForValue( value );
-    uint32 i;
     if ( !isBinEmpty( binIndex ) )
     {
-        --_binsInUse;
-        _values.removeAt( _bins[binIndex] );
+        uint32 index = _bins[binIndex];
+        uint32 last = _values.size() - 1;
 
-        // correct bin indices
-        for ( i = 0; i < _binCount; ++i )
+        // move the last value into the hole so no other bin needs correcting
+        if ( index != last )
         {
-            if ( !isBinEmpty( i ) && _bins[i] > _bins[binIndex] )
-            {
-                --( _bins[i] );
-            }
+            _bins[findBinForValue( _values[last] )] = index;
+            _values[index] = std::move( _values[last] );
         }
 
-        _bins[binIndex] = BIN_EMPTY;
+        _values.pop();
+        _bins[binIndex] = BIN_REMOVED;
     }
 }
 
@@ -706,7 +716,7 @@ uint32 Set<T>::findBinForValue( const T& value ) const
     uint32 probes;
     for ( i = wrap( hashCode ), probes = 0;
           !isBinEmpty( i ) && !doesBinContain( i, value );
-          i = probe( ++probes ) )
+          i = wrap( i + probe( ++probes ) ) )
     {
         // do nothing
     }
@@ -748,14 +758,14 @@ inline
 bool Set<T>::doesBinContain( uint32 binIndex, const T& value ) const
 {
     return binIndex < _binCount && !isBinEmpty( binIndex ) &&
-        _values[_bins[binIndex]] == value;
+        _bins[binIndex] != BIN_REMOVED && _values[_bins[binIndex]] == value;
 }
 
 template <typename T>
 inline
 bool Set<T>::shouldShrink() const
 {
-    return ( ( _binsInUse * 100 ) / _binCount ) <= SHRINK_THRESHOLD &&
+    return ( ( _values.size() * 100 ) / _binCount ) <= SHRINK_THRESHOLD &&
         _binCount > MIN_BINS;
 }
 
@@ -770,7 +780,15 @@ template <typename T>
 inline
 void Set<T>::grow()
 {
-    resize( _binCount << 1 );
+    // rehash in place when most of the used bins were removed
+    if ( ( _values.size() * 100 ) / _binCount < GROW_THRESHOLD / 2 )
+    {
+        resize( _binCount );
+    }
+    else
+    {
+        resize( _binCount << 1 );
+    }
 }
 
 template <typename T>
@@ -787,6 +805,7 @@ void Set<T>::resize( uint32 newSize )
     _binAlloc.release( _bins, _binCount );
     _bins = _binAlloc.get( newSize );
     _binCount = newSize;
+    _binsInUse = _values.size();
     clearBins();
 
     uint32 i;
@@ -1,15 +1,25 @@
 // demo.cpp
 #include "demo.h"
 
-#include <iostream>
-
+#include "demo/memory/allocation_counter.h"
+#include "demo/memory/no_alloc_scope.h"
 #include "demo/resource/resource_manager.h"
+#include "demo/utility/cpu_features.h"
+#include "demo/utility/log.h"
+#include "demo/utility/profiler.h"
 
 namespace demo
 {
 
+// CONSTANTS
+constexpr uint32 Demo::WARMUP_FRAMES;
+constexpr float Demo::SPIN_RATE;
+
+// MEMBER FUNCTIONS
 bool Demo::startup()
 {
+    DEMO_PROFILE_SCOPE( "Demo::startup" );
+
     // start up subsystems
     bool successful = rndr::GrApi::startup();
     res::ResourceManager::startup();
@@ -23,19 +33,26 @@ bool Demo::startup()
     _window.setTitle( "Demo 2: Texture Mapping" );
     _window.open();
     _window.activate();
-    printf( "OpenGL version is (%s)\n", glGetString( GL_VERSION ) );
+    DEMO_LOG_INFO( "gpu", "OpenGL version is (%s)",
+                   reinterpret_cast<const char*>( glGetString( GL_VERSION ) ) );
+    char features[util::CpuFeatures::DESCRIPTION_SIZE];
+    util::CpuFeatures::describe( features, sizeof( features ) );
+    DEMO_LOG_INFO( "cpu", "%s", features );
 
 	// set up GLEW (if necessary)
     #ifdef _GLEW_
 	int32 output = glewInit();
 	if (GLEW_OK != output)
 	{
-		std::cout << "ERROR: " << glewGetErrorString(output)
-			<< std::endl;
+		DEMO_LOG_ERROR( "gpu", "ERROR: %s", reinterpret_cast<const char*>(
+			glewGetErrorString( output ) ) );
 		return false;
 	}
 	#endif
 
+    // report errors as soon as the driver sees them
+    rndr::GrApi::installDebugOutput();
+
     // create and compile shader
     _shader = rndr::Shader( "simple" );
     _shader.load();
@@ -54,7 +71,7 @@ bool Demo::startup()
 
     // load resources
     res::ResourceManager* resMgr = res::ResourceManager::inst();
-    rndr::GrApi::logError( "Model.push" );
+    DEMO_GL_CHECK( "Model.push" );
 
     rndr::ModelPtr model = resMgr->loadModel( "models/cyborg.obj" );
     model->push( _shader );
@@ -64,6 +81,11 @@ bool Demo::startup()
     // prepare scene
     _scene.addObject( &_model );
 
+    // record frame times
+    util::FrameStats::installSignalHandler();
+    _gameClock.setFrameStats( &_frameStats );
+    _scene.setFrameStats( &_frameStats );
+
     return true;
 }
 
@@ -74,32 +96,117 @@ void Demo::run()
 
     glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
 
-    _gameClock.reset();
+    _scheduler.reset();
 
     // run while the window is open
+    uint32 frame = 0;
     while ( _window.isOpen() )
     {
+        mem::AllocationCounter::beginFrame();
+
+        // steady-state frames must not touch the heap
+        if ( frame < WARMUP_FRAMES )
+        {
+            ++frame;
+            runFrame();
+        }
+        else
+        {
+            mem::NoAllocScope guard( "Demo::run" );
+            runFrame();
+        }
+    }
+}
+
+void Demo::shutdown()
+{
+    #ifdef DEMO_PROFILE
+    util::Profiler::report( stdout );
+    #endif
+
+    _frameStats.dump( stdout );
+    _scene.dumpTickGroups( stdout );
+    _scene.dumpSpatialIndex( stdout );
+    _renderer.dumpCullStats( stdout );
+
+    _model.setModel( nullptr );
+    res::ResourceManager::shutdown();
+    rndr::GrApi::shutdown();
+}
+
+// HELPER FUNCTIONS
+void Demo::runFrame()
+{
+    _scheduler.beginFrame();
+
+    {
+        DEMO_PROFILE_SCOPE( "Demo::update" );
+        util::PhaseTimer timer( &_frameStats, util::FrameStats::UPDATE );
+
+        glfwPollEvents();
+
+        if ( _window.isMinimized() )
+        {
+            _scheduler.setActivity( util::FrameScheduler::MINIMIZED );
+        }
+        else if ( !_window.isFocused() )
+        {
+            _scheduler.setActivity( util::FrameScheduler::BACKGROUND );
+        }
+        else
+        {
+            _scheduler.setActivity( util::FrameScheduler::FOREGROUND );
+        }
+
+        while ( _scheduler.advance() )
+        {
+            simulate( _scheduler.step() );
+        }
+    }
+
+    {
+        DEMO_PROFILE_SCOPE( "Demo::render" );
+        util::PhaseTimer timer( &_frameStats, util::FrameStats::RENDER );
+
+        // blend between the last two simulated states
+        float alpha = _scheduler.alpha();
+        _model.transform().setEulerRotation(
+            0.0f, _previousSpin + ( _spin - _previousSpin ) * alpha, 0.0f );
+        _scene.updateTransforms();
+
         glViewport( 0, 0, _window.width(), _window.height() );
         glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
         _renderer.render( _camera, _scene );
 
-        rndr::GrApi::logError( "MainLoop (render)" );
+        DEMO_GL_CHECK_FRAME( "MainLoop (render)" );
+    }
 
-        _model.transform().rotateEuler( 0.0f, _gameClock.dt() * 22.5f, 0.0f );
+    {
+        DEMO_PROFILE_SCOPE( "Demo::swap" );
+        util::PhaseTimer timer( &_frameStats, util::FrameStats::SWAP );
 
-        glfwPollEvents();
         _window.swapBuffer();
         _window.update();
-        _gameClock.tick();
     }
+
+    _scheduler.endFrame();
+    DEMO_PROFILE_FRAME();
 }
 
-void Demo::shutdown()
+void Demo::simulate( float dt )
 {
-    _model.setModel( nullptr );
-    res::ResourceManager::shutdown();
-    rndr::GrApi::shutdown();
+    _previousSpin = _spin;
+    _spin += dt * SPIN_RATE;
+
+    // keep the angle small so it does not lose precision
+    if ( _spin >= 360.0f )
+    {
+        _spin -= 360.0f;
+        _previousSpin -= 360.0f;
+    }
+
+    _scene.tick( dt );
 }
 
 } // End nspc demo
\ No newline at end of file
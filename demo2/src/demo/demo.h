@@ -13,6 +13,8 @@
 #include "demo/render/shader.h"
 #include "demo/render/window.h"
 #include "demo/utility/clock.h"
+#include "demo/utility/frame_scheduler.h"
+#include "demo/utility/frame_stats.h"
 
 namespace demo
 {
@@ -20,6 +22,18 @@ namespace demo
 class Demo
 {
   private:
+    // CONSTANTS
+    /**
+     * The number of frames that may allocate before the main loop is
+     * required to be allocation free.
+     */
+    static constexpr uint32 WARMUP_FRAMES = 8;
+
+    /**
+     * How fast the model spins in degrees per second.
+     */
+    static constexpr float SPIN_RATE = 22.5f;
+
     // MEMBERS
     /**
      * The renderer.
@@ -57,6 +71,38 @@ class Demo
      */
     util::Clock _gameClock;
 
+    /**
+     * The frame time telemetry.
+     */
+    util::FrameStats _frameStats;
+
+    /**
+     * Paces frames and steps the simulation.
+     */
+    util::FrameScheduler _scheduler;
+
+    /**
+     * The spin of the model after the latest simulation step in degrees.
+     */
+    float _spin;
+
+    /**
+     * The spin of the model after the step before it in degrees.
+     */
+    float _previousSpin;
+
+    // HELPER FUNCTIONS
+    /**
+     * Run a single frame of the main loop.
+     */
+    void runFrame();
+
+    /**
+     * Advance the simulation by one fixed step.
+     * @param dt The step in seconds.
+     */
+    void simulate( float dt );
+
     // HIDDEN FUNCTIONS
     /**
      * Hidden constructor.
@@ -112,7 +158,8 @@ class Demo
 // CONSTRUCTORS
 inline
 Demo::Demo() : _renderer(), _shader(), _window(), _camera(), _scene(),
-               _gameClock()
+               _gameClock(), _frameStats(), _scheduler( &_gameClock ),
+               _spin( 0.0f ), _previousSpin( 0.0f )
 {
 }
 
@@ -0,0 +1,134 @@
+// allocation_counter.cpp
+#include "demo/memory/allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+#include "demo/memory/no_alloc_scope.h"
+
+namespace demo
+{
+
+namespace mem
+{
+
+// CONSTANTS
+constexpr bool AllocationCounter::IS_TRACKING;
+
+// GLOBALS
+std::atomic<uint64> AllocationCounter::g_totalCount( 0 );
+std::atomic<uint64> AllocationCounter::g_liveCount( 0 );
+thread_local uint64 AllocationCounter::t_count = 0;
+thread_local uint64 AllocationCounter::t_bytes = 0;
+thread_local uint64 AllocationCounter::t_frameStart = 0;
+
+// UTILITY FUNCTIONS
+uint64 AllocationCounter::threadCount()
+{
+    return t_count;
+}
+
+uint64 AllocationCounter::threadBytes()
+{
+    return t_bytes;
+}
+
+uint64 AllocationCounter::totalCount()
+{
+    return g_totalCount.load( std::memory_order_relaxed );
+}
+
+uint64 AllocationCounter::liveCount()
+{
+    return g_liveCount.load( std::memory_order_relaxed );
+}
+
+void AllocationCounter::beginFrame()
+{
+    t_frameStart = t_count;
+}
+
+uint64 AllocationCounter::frameCount()
+{
+    return t_count - t_frameStart;
+}
+
+void AllocationCounter::recordAllocation( Size size )
+{
+    ++t_count;
+    t_bytes += size;
+    g_totalCount.fetch_add( 1, std::memory_order_relaxed );
+    g_liveCount.fetch_add( 1, std::memory_order_relaxed );
+
+    if ( NoAllocScope::isActive() )
+    {
+        NoAllocScope::reportViolation( size );
+    }
+}
+
+void AllocationCounter::recordRelease()
+{
+    g_liveCount.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+} // End nspc mem
+
+} // End nspc demo
+
+#ifdef DEMO_TRACK_ALLOCATIONS
+
+// GLOBAL ALLOCATION HOOK
+void* operator new( std::size_t size )
+{
+    demo::mem::AllocationCounter::recordAllocation( size );
+
+    void* pointer = std::malloc( size > 0 ? size : 1 );
+    if ( pointer == nullptr )
+    {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void* operator new[]( std::size_t size )
+{
+    return operator new( size );
+}
+
+void* operator new( std::size_t size, const std::nothrow_t& ) noexcept
+{
+    demo::mem::AllocationCounter::recordAllocation( size );
+    return std::malloc( size > 0 ? size : 1 );
+}
+
+void* operator new[]( std::size_t size, const std::nothrow_t& tag ) noexcept
+{
+    return operator new( size, tag );
+}
+
+void operator delete( void* pointer ) noexcept
+{
+    if ( pointer != nullptr )
+    {
+        demo::mem::AllocationCounter::recordRelease();
+        std::free( pointer );
+    }
+}
+
+void operator delete[]( void* pointer ) noexcept
+{
+    operator delete( pointer );
+}
+
+void operator delete( void* pointer, const std::nothrow_t& ) noexcept
+{
+    operator delete( pointer );
+}
+
+void operator delete[]( void* pointer, const std::nothrow_t& ) noexcept
+{
+    operator delete( pointer );
+}
+
+#endif // DEMO_TRACK_ALLOCATIONS
@@ -0,0 +1,120 @@
+// allocation_counter.h
+//
+// Counts heap allocations made through the global operator new.
+//
+// The counting hook replaces the global operator new and delete and is only
+// compiled in when DEMO_TRACK_ALLOCATIONS is defined. Without it every count
+// reported here is zero, which keeps release builds free of the bookkeeping.
+//
+// Counts are kept per thread so that a scope can measure its own
+// allocations without being disturbed by other threads. A process-wide total
+// is kept as well.
+//
+#ifndef DEMO_ALLOCATION_COUNTER_H
+#define DEMO_ALLOCATION_COUNTER_H
+
+#include <atomic>
+
+#include "demo/intdef.h"
+
+namespace demo
+{
+
+namespace mem
+{
+
+class AllocationCounter
+{
+  private:
+    // GLOBALS
+    /**
+     * The number of allocations made by all threads.
+     */
+    static std::atomic<uint64> g_totalCount;
+
+    /**
+     * The number of allocations that have not been released.
+     */
+    static std::atomic<uint64> g_liveCount;
+
+    /**
+     * The number of allocations made by the current thread.
+     */
+    static thread_local uint64 t_count;
+
+    /**
+     * The number of bytes allocated by the current thread.
+     */
+    static thread_local uint64 t_bytes;
+
+    /**
+     * The current thread's allocation count at the start of the frame.
+     */
+    static thread_local uint64 t_frameStart;
+
+  public:
+    // CONSTANTS
+    /**
+     * Whether the global allocation hook is compiled in.
+     */
+    static constexpr bool IS_TRACKING =
+#ifdef DEMO_TRACK_ALLOCATIONS
+        true;
+#else
+        false;
+#endif
+
+    // UTILITY FUNCTIONS
+    /**
+     * Gets the number of allocations made by the calling thread.
+     */
+    static uint64 threadCount();
+
+    /**
+     * Gets the number of bytes allocated by the calling thread.
+     */
+    static uint64 threadBytes();
+
+    /**
+     * Gets the number of allocations made by all threads.
+     */
+    static uint64 totalCount();
+
+    /**
+     * Gets the number of allocations that have not been released.
+     */
+    static uint64 liveCount();
+
+    /**
+     * Marks the start of a new frame on the calling thread.
+     */
+    static void beginFrame();
+
+    /**
+     * Gets the number of allocations the calling thread made since the last
+     * call to beginFrame.
+     */
+    static uint64 frameCount();
+
+    /**
+     * Records an allocation of the given size.
+     *
+     * This is called by the allocation hook and should not be called
+     * directly.
+     */
+    static void recordAllocation( Size size );
+
+    /**
+     * Records a release.
+     *
+     * This is called by the allocation hook and should not be called
+     * directly.
+     */
+    static void recordRelease();
+};
+
+} // End nspc mem
+
+} // End nspc demo
+
+#endif // DEMO_ALLOCATION_COUNTER_H
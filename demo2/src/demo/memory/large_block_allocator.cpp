@@ -0,0 +1,159 @@
+// large_block_allocator.cpp
+#include "demo/memory/large_block_allocator.h"
+
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace demo
+{
+
+namespace mem
+{
+
+// CONSTANTS
+constexpr Size LargeBlockHeap::HUGE_PAGE_SIZE;
+
+// GLOBALS
+std::atomic<Size> LargeBlockHeap::g_mappedBytes( 0 );
+std::atomic<uint32> LargeBlockHeap::g_blockCount( 0 );
+
+// UTILITY FUNCTIONS
+void* LargeBlockHeap::map( Size bytes )
+{
+    Size length = mappedSize( bytes );
+    void* pointer;
+
+    #ifdef _WIN32
+    pointer = VirtualAlloc( nullptr, length, MEM_RESERVE | MEM_COMMIT,
+                            PAGE_READWRITE );
+    if ( pointer == nullptr )
+    {
+        throw std::bad_alloc();
+    }
+    #else
+    if ( length < HUGE_PAGE_SIZE )
+    {
+        pointer = mmap( nullptr, length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if ( pointer == MAP_FAILED )
+        {
+            throw std::bad_alloc();
+        }
+    }
+    else
+    {
+        // over-map by one huge page and trim both ends so that the block
+        // starts on a huge page boundary
+        Size padded = length + HUGE_PAGE_SIZE;
+        void* region = mmap( nullptr, padded, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if ( region == MAP_FAILED )
+        {
+            throw std::bad_alloc();
+        }
+
+        uintptr_t start = reinterpret_cast<uintptr_t>( region );
+        uintptr_t aligned = ( start + HUGE_PAGE_SIZE - 1 ) &
+                            ~static_cast<uintptr_t>( HUGE_PAGE_SIZE - 1 );
+        Size head = aligned - start;
+        Size tail = padded - head - length;
+
+        if ( head > 0 )
+        {
+            munmap( region, head );
+        }
+
+        if ( tail > 0 )
+        {
+            munmap( reinterpret_cast<void*>( aligned + length ), tail );
+        }
+
+        pointer = reinterpret_cast<void*>( aligned );
+
+        #ifdef MADV_HUGEPAGE
+        madvise( pointer, length, MADV_HUGEPAGE );
+        #endif
+    }
+    #endif
+
+    g_mappedBytes.fetch_add( length, std::memory_order_relaxed );
+    g_blockCount.fetch_add( 1, std::memory_order_relaxed );
+
+    return pointer;
+}
+
+void LargeBlockHeap::unmap( void* pointer, Size bytes )
+{
+    assert( pointer != nullptr );
+
+    Size length = mappedSize( bytes );
+
+    #ifdef _WIN32
+    VirtualFree( pointer, 0, MEM_RELEASE );
+    #else
+    munmap( pointer, length );
+    #endif
+
+    g_mappedBytes.fetch_sub( length, std::memory_order_relaxed );
+    g_blockCount.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+Size LargeBlockHeap::mappedSize( Size bytes )
+{
+    #ifdef _WIN32
+    static const Size pageSize = 64 * 1024;
+    #else
+    static const Size pageSize = static_cast<Size>( sysconf( _SC_PAGESIZE ) );
+    #endif
+
+    Size granularity = bytes < HUGE_PAGE_SIZE ? pageSize : HUGE_PAGE_SIZE;
+
+    return ( bytes + granularity - 1 ) / granularity * granularity;
+}
+
+Size LargeBlockHeap::mappedBytes()
+{
+    return g_mappedBytes.load( std::memory_order_relaxed );
+}
+
+uint32 LargeBlockHeap::blockCount()
+{
+    return g_blockCount.load( std::memory_order_relaxed );
+}
+
+Size LargeBlockHeap::residentBytes()
+{
+    #if defined( __linux__ )
+    FILE* file = fopen( "/proc/self/statm", "r" );
+    if ( file == nullptr )
+    {
+        return 0;
+    }
+
+    unsigned long pages = 0;
+    unsigned long resident = 0;
+    int32 read = fscanf( file, "%lu %lu", &pages, &resident );
+    fclose( file );
+
+    if ( read != 2 )
+    {
+        return 0;
+    }
+
+    return static_cast<Size>( resident ) *
+           static_cast<Size>( sysconf( _SC_PAGESIZE ) );
+    #else
+    return 0;
+    #endif
+}
+
+} // End nspc mem
+
+} // End nspc demo
@@ -0,0 +1,294 @@
+// large_block_allocator.h
+//
+// An allocator for large buffers such as decoded images and vertex arrays.
+//
+// Allocations at or above the allocator's threshold are mapped directly from
+// the operating system instead of being carved out of the heap. This keeps
+// large, long-lived buffers from fragmenting the heap and lets the kernel back
+// them with transparent huge pages, which reduces TLB pressure when they are
+// streamed. Blocks of at least one huge page are aligned to a huge page
+// boundary. Allocations below the threshold fall back to new and delete so
+// that callers can route every allocation through it regardless of size.
+//
+// Released blocks are unmapped immediately which returns their pages to the
+// system. The mapped totals are tracked globally so that the memory held by
+// large blocks can be reported alongside the process resident set size.
+//
+#ifndef DEMO_LARGE_BLOCK_ALLOCATOR_H
+#define DEMO_LARGE_BLOCK_ALLOCATOR_H
+
+#include <assert.h>
+#include <atomic>
+
+#include "demo/memory/iallocator.h"
+#include "demo/memory/memory_utils.h"
+
+namespace demo
+{
+
+namespace mem
+{
+
+class LargeBlockHeap
+{
+  private:
+    // GLOBALS
+    /**
+     * The number of bytes currently mapped.
+     */
+    static std::atomic<Size> g_mappedBytes;
+
+    /**
+     * The number of blocks currently mapped.
+     */
+    static std::atomic<uint32> g_blockCount;
+
+  public:
+    // CONSTANTS
+    /**
+     * The size of a transparent huge page.
+     */
+    static constexpr Size HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    // UTILITY FUNCTIONS
+    /**
+     * Maps a zeroed block of at least the given number of bytes.
+     *
+     * Throws a bad_alloc when:
+     * the system is out of memory
+     */
+    static void* map( Size bytes );
+
+    /**
+     * Unmaps a block that was mapped with the given number of bytes.
+     *
+     * Behavior is undefined when:
+     * pointer was not returned by map
+     * bytes differs from the size the block was mapped with
+     */
+    static void unmap( void* pointer, Size bytes );
+
+    /**
+     * Gets the number of bytes mapped for the given request size.
+     */
+    static Size mappedSize( Size bytes );
+
+    /**
+     * Gets the number of bytes currently mapped by all blocks.
+     */
+    static Size mappedBytes();
+
+    /**
+     * Gets the number of blocks that are currently mapped.
+     */
+    static uint32 blockCount();
+
+    /**
+     * Gets the resident set size of the process in bytes.
+     *
+     * Returns zero if it can not be determined on this platform.
+     */
+    static Size residentBytes();
+};
+
+template <typename T>
+class LargeBlockAllocator : public IAllocator<T>
+{
+  private:
+    // GLOBALS
+    /**
+     * The shared instance that uses the default threshold.
+     */
+    static LargeBlockAllocator<T> g_instance;
+
+    // MEMBERS
+    /**
+     * The size in bytes at which allocations are mapped.
+     */
+    Size _threshold;
+
+    // HELPER FUNCTIONS
+    /**
+     * Checks if an allocation of the given number of instances is mapped.
+     */
+    bool isLarge( uint32 count ) const;
+
+  public:
+    // CONSTANTS
+    /**
+     * The default size in bytes at which allocations are mapped.
+     */
+    static constexpr Size DEFAULT_THRESHOLD = 256 * 1024;
+
+    // CONSTRUCTORS
+    /**
+     * Constructs an allocator that uses the default threshold.
+     */
+    LargeBlockAllocator();
+
+    /**
+     * Constructs an allocator that maps allocations of at least the given
+     * number of bytes.
+     */
+    LargeBlockAllocator( Size threshold );
+
+    /**
+     * Constructs a copy of an allocator.
+     */
+    LargeBlockAllocator( const LargeBlockAllocator<T>& copy );
+
+    /**
+     * Destructs the allocator.
+     */
+    virtual ~LargeBlockAllocator();
+
+    // OPERATORS
+    /**
+     * Assigns a copy of an allocator.
+     */
+    LargeBlockAllocator<T>& operator=( const LargeBlockAllocator<T>& assign );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Allocates the given number of instances.
+     *
+     * Behavior is undefined when:
+     * T is void
+     * count is less than or equal to zero
+     * out of memory
+     */
+    virtual T* get( uint32 count );
+
+    /**
+     * Releases the allocation with the given number of instances.
+     *
+     * Behavior is undefined when:
+     * T is void
+     * pointer is invalid
+     * count is less than or equal to zero
+     * count differs from the count it was allocated with
+     */
+    virtual void release( T* pointer, uint32 count );
+
+    /**
+     * Gets the size in bytes at which allocations are mapped.
+     */
+    Size threshold() const;
+
+    // GLOBAL FUNCTIONS
+    /**
+     * Gets the shared instance that uses the default threshold.
+     */
+    static LargeBlockAllocator<T>* inst();
+};
+
+// CONSTANTS
+template <typename T>
+constexpr Size LargeBlockAllocator<T>::DEFAULT_THRESHOLD;
+
+// GLOBALS
+template <typename T>
+LargeBlockAllocator<T> LargeBlockAllocator<T>::g_instance;
+
+// CONSTRUCTORS
+template <typename T>
+inline
+LargeBlockAllocator<T>::LargeBlockAllocator()
+    : _threshold( DEFAULT_THRESHOLD )
+{
+}
+
+template <typename T>
+inline
+LargeBlockAllocator<T>::LargeBlockAllocator( Size threshold )
+    : _threshold( threshold )
+{
+}
+
+template <typename T>
+inline
+LargeBlockAllocator<T>::LargeBlockAllocator(
+    const LargeBlockAllocator<T>& copy ) : _threshold( copy._threshold )
+{
+}
+
+template <typename T>
+inline
+LargeBlockAllocator<T>::~LargeBlockAllocator()
+{
+}
+
+// OPERATORS
+template <typename T>
+inline
+LargeBlockAllocator<T>& LargeBlockAllocator<T>::operator=(
+    const LargeBlockAllocator<T>& assign )
+{
+    _threshold = assign._threshold;
+
+    return *this;
+}
+
+// MEMBER FUNCTIONS
+template <typename T>
+inline
+T* LargeBlockAllocator<T>::get( uint32 count )
+{
+    assert( count > 0 );
+
+    if ( !isLarge( count ) )
+    {
+        return new T[count];
+    }
+
+    T* pointer = static_cast<T*>( LargeBlockHeap::map( count * sizeof( T ) ) );
+    MemoryUtils::construct( pointer, count );
+
+    return pointer;
+}
+
+template <typename T>
+inline
+void LargeBlockAllocator<T>::release( T* pointer, uint32 count )
+{
+    assert( count > 0 );
+    assert( pointer != nullptr );
+
+    if ( !isLarge( count ) )
+    {
+        delete[] pointer;
+        return;
+    }
+
+    MemoryUtils::destruct( pointer, count );
+    LargeBlockHeap::unmap( pointer, count * sizeof( T ) );
+}
+
+template <typename T>
+inline
+Size LargeBlockAllocator<T>::threshold() const
+{
+    return _threshold;
+}
+
+// GLOBAL FUNCTIONS
+template <typename T>
+inline
+LargeBlockAllocator<T>* LargeBlockAllocator<T>::inst()
+{
+    return &g_instance;
+}
+
+// HELPER FUNCTIONS
+template <typename T>
+inline
+bool LargeBlockAllocator<T>::isLarge( uint32 count ) const
+{
+    return static_cast<Size>( count ) * sizeof( T ) >= _threshold;
+}
+
+} // End nspc mem
+
+} // End nspc demo
+
+#endif // DEMO_LARGE_BLOCK_ALLOCATOR_H
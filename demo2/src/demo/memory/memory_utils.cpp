@@ -1,2 +1,20 @@
 // memory_utils.cpp
 #include "demo/memory/memory_utils.h"
+
+#include "demo/utility/simd_kernels.h"
+
+namespace demo
+{
+
+namespace mem
+{
+
+// MEMBER FUNCTIONS
+void MemoryUtils::set( uint32* ptr, uint32 value, uint32 count )
+{
+    util::SimdKernels::fill( ptr, value, count );
+}
+
+} // End nspc mem
+
+} // End nspc demo
@@ -2,6 +2,7 @@
 #ifndef DEMO_MEMORY_UTILS_H
 #define DEMO_MEMORY_UTILS_H
 
+#include <new>
 #include <utility>
 
 #include "demo/intdef.h"
@@ -32,6 +33,24 @@ struct MemoryUtils
      */
     template <typename T>
     static void set( T* ptr, const T& value, uint32 count );
+
+    /**
+     * Sets all of the words in the array to the given value with the best
+     * SIMD tier the machine allows.
+     */
+    static void set( uint32* ptr, uint32 value, uint32 count );
+
+    /**
+     * Default constructs the given number of items in raw memory.
+     */
+    template <typename T>
+    static void construct( T* ptr, uint32 count );
+
+    /**
+     * Destructs the given number of items without releasing their memory.
+     */
+    template <typename T>
+    static void destruct( T* ptr, uint32 count );
 };
 
 template <typename T>
@@ -64,6 +83,26 @@ void MemoryUtils::set( T* ptr, const T& value, uint32 count )
     }
 }
 
+template <typename T>
+void MemoryUtils::construct( T* ptr, uint32 count )
+{
+    uint32 i;
+    for ( i = 0; i < count; ++i )
+    {
+        new ( ptr + i ) T;
+    }
+}
+
+template <typename T>
+void MemoryUtils::destruct( T* ptr, uint32 count )
+{
+    uint32 i;
+    for ( i = 0; i < count; ++i )
+    {
+        ptr[i].~T();
+    }
+}
+
 } // End nspc mem
 
 } // End nspc demo
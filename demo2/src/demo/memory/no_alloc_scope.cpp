@@ -0,0 +1,70 @@
+// no_alloc_scope.cpp
+#include "demo/memory/no_alloc_scope.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+#if !defined( NDEBUG ) && defined( __GLIBC__ )
+#define DEMO_NO_ALLOC_BACKTRACE
+#include <execinfo.h>
+#endif
+
+namespace demo
+{
+
+namespace mem
+{
+
+// GLOBALS
+thread_local NoAllocScope* NoAllocScope::t_active = nullptr;
+thread_local bool NoAllocScope::t_isReporting = false;
+
+// CONSTRUCTORS
+NoAllocScope::~NoAllocScope()
+{
+    assert( t_active == this );
+    t_active = _parent;
+
+    uint64 violations = allocations();
+    if ( violations > 0 )
+    {
+        fprintf( stderr, "NoAllocScope[%s]: %llu heap allocation(s)\n",
+                 _name, static_cast<unsigned long long>( violations ) );
+    }
+
+    assert( !_isStrict || violations == 0 );
+}
+
+// GLOBAL FUNCTIONS
+void NoAllocScope::reportViolation( Size size )
+{
+    if ( t_isReporting )
+    {
+        return;
+    }
+
+    t_isReporting = true;
+
+    NoAllocScope* scope;
+    for ( scope = t_active; scope != nullptr; scope = scope->_parent )
+    {
+        scope->_violations.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    #ifdef DEMO_NO_ALLOC_BACKTRACE
+    static constexpr int32 MAX_FRAMES = 32;
+
+    void* frames[MAX_FRAMES];
+    int32 frameCount = backtrace( frames, MAX_FRAMES );
+
+    fprintf( stderr, "NoAllocScope[%s]: allocated %zu bytes at:\n",
+             t_active->_name, size );
+    backtrace_symbols_fd( frames, frameCount, fileno( stderr ) );
+    #endif
+
+    t_isReporting = false;
+}
+
+} // End nspc mem
+
+} // End nspc demo
@@ -0,0 +1,197 @@
+// no_alloc_scope.h
+//
+// Guards a scope that must not allocate from the heap.
+//
+// Any allocation made through the global operator new on the guarding thread
+// while the scope is alive is counted as a violation. In debug builds each
+// violation prints the call stack of the offending allocation and the guard
+// asserts when it goes out of scope.
+//
+// A thread pool worker that runs tasks for a guarded thread makes the scope
+// active on itself while it does (see setActive), so work spread across the
+// pool is guarded as well. Violations are counted atomically for this.
+//
+// Violations can only be detected when the allocation hook is compiled in
+// (see AllocationCounter). Without it the guard is a no-op.
+//
+#ifndef DEMO_NO_ALLOC_SCOPE_H
+#define DEMO_NO_ALLOC_SCOPE_H
+
+#include <atomic>
+
+#include "demo/intdef.h"
+
+namespace demo
+{
+
+namespace mem
+{
+
+class NoAllocScope
+{
+  private:
+    // GLOBALS
+    /**
+     * The innermost active scope on the current thread.
+     */
+    static thread_local NoAllocScope* t_active;
+
+    /**
+     * Whether a violation is currently being reported on this thread.
+     *
+     * Reporting may allocate so this prevents recursive reports.
+     */
+    static thread_local bool t_isReporting;
+
+    // MEMBERS
+    /**
+     * The enclosing scope.
+     */
+    NoAllocScope* _parent;
+
+    /**
+     * The scope name used in reports.
+     */
+    const char* _name;
+
+    /**
+     * The number of allocations made while the scope was active.
+     */
+    std::atomic<uint64> _violations;
+
+    /**
+     * Whether the scope asserts that no allocations were made.
+     */
+    bool _isStrict;
+
+    /**
+     * Constructs a copy of the given scope.
+     *
+     * This is not a supported operation for scopes.
+     */
+    NoAllocScope( const NoAllocScope& scope );
+
+    /**
+     * Assigns this as a copy of the other scope.
+     *
+     * This is not a supported operation for scopes.
+     */
+    NoAllocScope& operator=( const NoAllocScope& scope );
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs a strict scope with the given name.
+     *
+     * The name must outlive the scope.
+     */
+    NoAllocScope( const char* name );
+
+    /**
+     * Constructs a scope with the given name.
+     *
+     * A strict scope asserts that no allocations were made when it is
+     * destructed. A scope that is not strict only counts them.
+     */
+    NoAllocScope( const char* name, bool isStrict );
+
+    /**
+     * Destructs the scope.
+     */
+    ~NoAllocScope();
+
+    // MEMBER FUNCTIONS
+    /**
+     * Gets the number of allocations made within the scope so far.
+     */
+    uint64 allocations() const;
+
+    /**
+     * Gets the scope name.
+     */
+    const char* name() const;
+
+    // GLOBAL FUNCTIONS
+    /**
+     * Checks if a scope is active on the current thread.
+     */
+    static bool isActive();
+
+    /**
+     * Gets the innermost active scope on the current thread or null.
+     */
+    static NoAllocScope* active();
+
+    /**
+     * Makes a scope active on the current thread and gets the scope that was
+     * active.
+     *
+     * This lets a worker running tasks for another thread be guarded by that
+     * thread's scope, which must stay alive until the previous scope is made
+     * active again.
+     */
+    static NoAllocScope* setActive( NoAllocScope* scope );
+
+    /**
+     * Reports an allocation of the given size to every active scope on the
+     * current thread.
+     *
+     * This is called by the allocation hook and should not be called
+     * directly.
+     */
+    static void reportViolation( Size size );
+};
+
+// CONSTRUCTORS
+inline
+NoAllocScope::NoAllocScope( const char* name ) : NoAllocScope( name, true )
+{
+}
+
+inline
+NoAllocScope::NoAllocScope( const char* name, bool isStrict )
+    : _parent( t_active ), _name( name ), _violations( 0 ),
+      _isStrict( isStrict )
+{
+    t_active = this;
+}
+
+// MEMBER FUNCTIONS
+inline
+uint64 NoAllocScope::allocations() const
+{
+    return _violations.load( std::memory_order_relaxed );
+}
+
+inline
+const char* NoAllocScope::name() const
+{
+    return _name;
+}
+
+// GLOBAL FUNCTIONS
+inline
+bool NoAllocScope::isActive()
+{
+    return t_active != nullptr;
+}
+
+inline
+NoAllocScope* NoAllocScope::active()
+{
+    return t_active;
+}
+
+inline
+NoAllocScope* NoAllocScope::setActive( NoAllocScope* scope )
+{
+    NoAllocScope* previous = t_active;
+    t_active = scope;
+    return previous;
+}
+
+} // End nspc mem
+
+} // End nspc demo
+
+#endif // DEMO_NO_ALLOC_SCOPE_H
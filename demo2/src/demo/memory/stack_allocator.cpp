@@ -0,0 +1,76 @@
+// stack_allocator.cpp
+#include "demo/memory/stack_allocator.h"
+
+#include <new>
+
+namespace demo
+{
+
+namespace mem
+{
+
+// CONSTANTS
+constexpr Size StackAllocator::DEFAULT_ALIGNMENT;
+
+// MEMBER FUNCTIONS
+void* StackAllocator::allocate( Size bytes, Size alignment )
+{
+    assert( alignment > 0 && ( alignment & ( alignment - 1 ) ) == 0 );
+
+    uintptr_t top = reinterpret_cast<uintptr_t>( _top );
+    uintptr_t limit = reinterpret_cast<uintptr_t>( this->limit() );
+    uintptr_t mask = static_cast<uintptr_t>( alignment - 1 );
+    uintptr_t start;
+
+    if ( _isDescending )
+    {
+        if ( top - limit < bytes )
+        {
+            throw std::bad_alloc();
+        }
+
+        start = ( top - bytes ) & ~mask;
+        if ( start < limit )
+        {
+            throw std::bad_alloc();
+        }
+
+        _top = reinterpret_cast<uint8*>( start );
+    }
+    else
+    {
+        start = ( top + mask ) & ~mask;
+        if ( start > limit || limit - start < bytes )
+        {
+            throw std::bad_alloc();
+        }
+
+        _top = reinterpret_cast<uint8*>( start + bytes );
+    }
+
+    return reinterpret_cast<void*>( start );
+}
+
+void StackAllocator::release( void* pointer, Size bytes )
+{
+    uint8* start = static_cast<uint8*>( pointer );
+    assert( start >= _begin && start + bytes <= _end );
+
+    // only the most recent allocation can be reclaimed, the rest is left for
+    // the next unwind
+    if ( _isDescending )
+    {
+        if ( start == _top )
+        {
+            _top = start + bytes;
+        }
+    }
+    else if ( start + bytes == _top )
+    {
+        _top = start;
+    }
+}
+
+} // End nspc mem
+
+} // End nspc demo
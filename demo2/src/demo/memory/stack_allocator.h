@@ -0,0 +1,581 @@
+// stack_allocator.h
+//
+// A stack allocator hands out memory from a contiguous region by bumping a
+// top pointer. Memory is reclaimed in LIFO order: releasing the most recent
+// allocation moves the top back, while releasing any other allocation is
+// deferred until the stack is unwound to a marker that precedes it.
+//
+// Markers capture the top of the stack so that everything allocated after
+// them can be released in a single step. StackScope restores a marker when it
+// goes out of scope which makes it convenient for temporary data such as the
+// working set of a loader.
+//
+// The double-ended variant shares one region between two stacks that grow
+// towards each other. This allows long-lived data to be kept at one end while
+// scratch data is pushed and popped at the other.
+//
+// Instances that are still alive when a marker is restored are not
+// destructed. Only trivially destructible data or data that has already been
+// released should be left on the stack when it unwinds.
+//
+#ifndef DEMO_STACK_ALLOCATOR_H
+#define DEMO_STACK_ALLOCATOR_H
+
+#include <assert.h>
+
+#include "demo/intdef.h"
+#include "demo/memory/iallocator.h"
+#include "demo/memory/memory_utils.h"
+
+namespace demo
+{
+
+namespace mem
+{
+
+class DoubleEndedStackAllocator;
+
+class StackAllocator
+{
+  public:
+    // TYPES
+    /**
+     * Defines a position in the stack.
+     *
+     * This is the number of bytes in use when the marker was taken.
+     */
+    typedef Size Marker;
+
+  private:
+    // FRIENDS
+    friend class DoubleEndedStackAllocator;
+
+    // MEMBERS
+    /**
+     * The owned region or null if the region is external.
+     */
+    uint8* _buffer;
+
+    /**
+     * The start of the region.
+     */
+    uint8* _begin;
+
+    /**
+     * The end of the region.
+     */
+    uint8* _end;
+
+    /**
+     * The current top of the stack.
+     */
+    uint8* _top;
+
+    /**
+     * The stack growing towards this one when the region is shared.
+     */
+    const StackAllocator* _opposite;
+
+    /**
+     * Whether the stack grows from the end of the region towards the start.
+     */
+    bool _isDescending;
+
+    // CONSTRUCTORS
+    /**
+     * Constructs one end of a shared region.
+     */
+    StackAllocator( uint8* region, Size capacity,
+                    const StackAllocator* opposite, bool isDescending );
+
+    /**
+     * Constructs a copy of the given allocator.
+     *
+     * This is not a supported operation for stack allocators.
+     */
+    StackAllocator( const StackAllocator& other );
+
+    /**
+     * Assigns this as a copy of the other allocator.
+     *
+     * This is not a supported operation for stack allocators.
+     */
+    StackAllocator& operator=( const StackAllocator& other );
+
+    // HELPER FUNCTIONS
+    /**
+     * Gets the furthest point the top may move to.
+     */
+    const uint8* limit() const;
+
+  public:
+    // CONSTANTS
+    /**
+     * The default allocation alignment.
+     */
+    static constexpr Size DEFAULT_ALIGNMENT = alignof( std::max_align_t );
+
+    // CONSTRUCTORS
+    /**
+     * Constructs a stack that owns a region of the given size.
+     */
+    StackAllocator( Size capacity );
+
+    /**
+     * Constructs a stack over an external region.
+     *
+     * The region is not released when the stack is destructed.
+     */
+    StackAllocator( void* region, Size capacity );
+
+    /**
+     * Destructs the stack and releases the region if it is owned.
+     */
+    ~StackAllocator();
+
+    // MEMBER FUNCTIONS
+    /**
+     * Allocates the given number of bytes with the default alignment.
+     *
+     * Throws a bad_alloc when:
+     * there is not enough space left in the region
+     */
+    void* allocate( Size bytes );
+
+    /**
+     * Allocates the given number of bytes with the given alignment.
+     *
+     * Throws a bad_alloc when:
+     * there is not enough space left in the region
+     *
+     * Behavior is undefined when:
+     * alignment is not a power of two
+     */
+    void* allocate( Size bytes, Size alignment );
+
+    /**
+     * Releases an allocation.
+     *
+     * The space is only reclaimed immediately if it is the most recent
+     * allocation. Otherwise it is reclaimed when the stack is unwound past it.
+     */
+    void release( void* pointer, Size bytes );
+
+    /**
+     * Gets a marker for the current top of the stack.
+     */
+    Marker marker() const;
+
+    /**
+     * Releases everything that was allocated after the marker was taken.
+     *
+     * Behavior is undefined when:
+     * the marker is above the current top of the stack
+     */
+    void freeToMarker( Marker marker );
+
+    /**
+     * Releases everything.
+     */
+    void clear();
+
+    /**
+     * Gets the number of bytes in use.
+     */
+    Size used() const;
+
+    /**
+     * Gets the number of bytes that can still be allocated.
+     */
+    Size available() const;
+
+    /**
+     * Gets the total size of the region.
+     */
+    Size capacity() const;
+};
+
+class DoubleEndedStackAllocator
+{
+  private:
+    // MEMBERS
+    /**
+     * The shared region.
+     */
+    uint8* _buffer;
+
+    /**
+     * The stack that grows from the start of the region.
+     */
+    StackAllocator _lower;
+
+    /**
+     * The stack that grows from the end of the region.
+     */
+    StackAllocator _upper;
+
+    /**
+     * Constructs a copy of the given allocator.
+     *
+     * This is not a supported operation for stack allocators.
+     */
+    DoubleEndedStackAllocator( const DoubleEndedStackAllocator& other );
+
+    /**
+     * Assigns this as a copy of the other allocator.
+     *
+     * This is not a supported operation for stack allocators.
+     */
+    DoubleEndedStackAllocator& operator=(
+        const DoubleEndedStackAllocator& other );
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs a double-ended stack that owns a region of the given size.
+     */
+    DoubleEndedStackAllocator( Size capacity );
+
+    /**
+     * Destructs the stack and releases the region.
+     */
+    ~DoubleEndedStackAllocator();
+
+    // MEMBER FUNCTIONS
+    /**
+     * Gets the stack that grows from the start of the region.
+     *
+     * By convention this end holds long-lived data.
+     */
+    StackAllocator& lower();
+
+    /**
+     * Gets the stack that grows from the end of the region.
+     *
+     * By convention this end holds scratch data.
+     */
+    StackAllocator& upper();
+
+    /**
+     * Gets the number of bytes that can still be allocated from either end.
+     */
+    Size available() const;
+
+    /**
+     * Gets the total size of the region.
+     */
+    Size capacity() const;
+};
+
+class StackScope
+{
+  private:
+    // MEMBERS
+    /**
+     * The stack that is unwound.
+     */
+    StackAllocator* _stack;
+
+    /**
+     * The marker that is restored.
+     */
+    StackAllocator::Marker _marker;
+
+    /**
+     * Constructs a copy of the given scope.
+     *
+     * This is not a supported operation for scopes.
+     */
+    StackScope( const StackScope& other );
+
+    /**
+     * Assigns this as a copy of the other scope.
+     *
+     * This is not a supported operation for scopes.
+     */
+    StackScope& operator=( const StackScope& other );
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs a scope that marks the current top of the stack.
+     */
+    StackScope( StackAllocator& stack );
+
+    /**
+     * Destructs the scope and unwinds the stack to the marker.
+     */
+    ~StackScope();
+};
+
+/**
+ * Adapts a stack allocator so that it can be used wherever an IAllocator is
+ * expected, including containers and StackGuard.
+ *
+ * Releases are LIFO: releasing the most recent allocation reclaims it
+ * immediately, anything else is reclaimed when the stack unwinds.
+ */
+template <typename T>
+class StackAdapter : public IAllocator<T>
+{
+  private:
+    // MEMBERS
+    /**
+     * The underlying stack.
+     */
+    StackAllocator* _stack;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs an adapter for the given stack.
+     */
+    StackAdapter( StackAllocator* stack );
+
+    /**
+     * Constructs a copy of an adapter.
+     */
+    StackAdapter( const StackAdapter<T>& copy );
+
+    /**
+     * Destructs the adapter.
+     */
+    virtual ~StackAdapter();
+
+    // OPERATORS
+    /**
+     * Assigns a copy of an adapter.
+     */
+    StackAdapter<T>& operator=( const StackAdapter<T>& assign );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Allocates the given number of instances.
+     *
+     * Behavior is undefined when:
+     * T is void
+     * count is less than or equal to zero
+     * out of memory
+     */
+    virtual T* get( uint32 count );
+
+    /**
+     * Releases the allocation with the given number of instances.
+     *
+     * Behavior is undefined when:
+     * T is void
+     * pointer is invalid
+     * count is less than or equal to zero
+     */
+    virtual void release( T* pointer, uint32 count );
+};
+
+// CONSTRUCTORS
+inline
+StackAllocator::StackAllocator( Size capacity )
+    : _buffer( new uint8[capacity] ), _begin( _buffer ),
+      _end( _buffer + capacity ), _top( _buffer ), _opposite( nullptr ),
+      _isDescending( false )
+{
+}
+
+inline
+StackAllocator::StackAllocator( void* region, Size capacity )
+    : _buffer( nullptr ), _begin( static_cast<uint8*>( region ) ),
+      _end( static_cast<uint8*>( region ) + capacity ),
+      _top( static_cast<uint8*>( region ) ), _opposite( nullptr ),
+      _isDescending( false )
+{
+}
+
+inline
+StackAllocator::StackAllocator( uint8* region, Size capacity,
+                                const StackAllocator* opposite,
+                                bool isDescending )
+    : _buffer( nullptr ), _begin( region ), _end( region + capacity ),
+      _top( isDescending ? region + capacity : region ),
+      _opposite( opposite ), _isDescending( isDescending )
+{
+}
+
+inline
+StackAllocator::~StackAllocator()
+{
+    delete[] _buffer;
+    _buffer = nullptr;
+}
+
+// MEMBER FUNCTIONS
+inline
+void* StackAllocator::allocate( Size bytes )
+{
+    return allocate( bytes, DEFAULT_ALIGNMENT );
+}
+
+inline
+StackAllocator::Marker StackAllocator::marker() const
+{
+    return used();
+}
+
+inline
+void StackAllocator::freeToMarker( Marker marker )
+{
+    assert( marker <= used() );
+    _top = _isDescending ? _end - marker : _begin + marker;
+}
+
+inline
+void StackAllocator::clear()
+{
+    _top = _isDescending ? _end : _begin;
+}
+
+inline
+Size StackAllocator::used() const
+{
+    return static_cast<Size>( _isDescending ? _end - _top : _top - _begin );
+}
+
+inline
+Size StackAllocator::available() const
+{
+    return static_cast<Size>( _isDescending ? _top - limit() :
+                                              limit() - _top );
+}
+
+inline
+Size StackAllocator::capacity() const
+{
+    return static_cast<Size>( _end - _begin );
+}
+
+// HELPER FUNCTIONS
+inline
+const uint8* StackAllocator::limit() const
+{
+    if ( _opposite != nullptr )
+    {
+        return _opposite->_top;
+    }
+
+    return _isDescending ? _begin : _end;
+}
+
+// DOUBLE-ENDED CONSTRUCTORS
+inline
+DoubleEndedStackAllocator::DoubleEndedStackAllocator( Size capacity )
+    : _buffer( new uint8[capacity] ),
+      _lower( _buffer, capacity, &_upper, false ),
+      _upper( _buffer, capacity, &_lower, true )
+{
+}
+
+inline
+DoubleEndedStackAllocator::~DoubleEndedStackAllocator()
+{
+    delete[] _buffer;
+    _buffer = nullptr;
+}
+
+// DOUBLE-ENDED MEMBER FUNCTIONS
+inline
+StackAllocator& DoubleEndedStackAllocator::lower()
+{
+    return _lower;
+}
+
+inline
+StackAllocator& DoubleEndedStackAllocator::upper()
+{
+    return _upper;
+}
+
+inline
+Size DoubleEndedStackAllocator::available() const
+{
+    return _lower.available();
+}
+
+inline
+Size DoubleEndedStackAllocator::capacity() const
+{
+    return _lower.capacity();
+}
+
+// SCOPE CONSTRUCTORS
+inline
+StackScope::StackScope( StackAllocator& stack )
+    : _stack( &stack ), _marker( stack.marker() )
+{
+}
+
+inline
+StackScope::~StackScope()
+{
+    _stack->freeToMarker( _marker );
+    _stack = nullptr;
+}
+
+// ADAPTER CONSTRUCTORS
+template <typename T>
+inline
+StackAdapter<T>::StackAdapter( StackAllocator* stack ) : _stack( stack )
+{
+    assert( stack != nullptr );
+}
+
+template <typename T>
+inline
+StackAdapter<T>::StackAdapter( const StackAdapter<T>& copy )
+    : _stack( copy._stack )
+{
+}
+
+template <typename T>
+inline
+StackAdapter<T>::~StackAdapter()
+{
+    _stack = nullptr;
+}
+
+// ADAPTER OPERATORS
+template <typename T>
+inline
+StackAdapter<T>& StackAdapter<T>::operator=( const StackAdapter<T>& assign )
+{
+    _stack = assign._stack;
+
+    return *this;
+}
+
+// ADAPTER MEMBER FUNCTIONS
+template <typename T>
+inline
+T* StackAdapter<T>::get( uint32 count )
+{
+    assert( count > 0 );
+
+    T* pointer = static_cast<T*>( _stack->allocate( count * sizeof( T ),
+                                                    alignof( T ) ) );
+    MemoryUtils::construct( pointer, count );
+
+    return pointer;
+}
+
+template <typename T>
+inline
+void StackAdapter<T>::release( T* pointer, uint32 count )
+{
+    assert( count > 0 );
+    assert( pointer != nullptr );
+
+    MemoryUtils::destruct( pointer, count );
+    _stack->release( pointer, count * sizeof( T ) );
+}
+
+} // End nspc mem
+
+} // End nspc demo
+
+#endif // DEMO_STACK_ALLOCATOR_H
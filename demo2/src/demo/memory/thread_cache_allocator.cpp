@@ -0,0 +1,319 @@
+// thread_cache_allocator.cpp
+#include "demo/memory/thread_cache_allocator.h"
+
+#include <new>
+
+namespace demo
+{
+
+namespace mem
+{
+
+// CONSTANTS
+constexpr uint32 ThreadCacheHeap::CLASS_COUNT;
+constexpr Size ThreadCacheHeap::MIN_BLOCK_SIZE;
+constexpr Size ThreadCacheHeap::MAX_BLOCK_SIZE;
+constexpr Size ThreadCacheHeap::HEADER_SIZE;
+
+// GLOBALS
+ThreadCacheHeap::CentralList ThreadCacheHeap::g_central[CLASS_COUNT];
+std::mutex ThreadCacheHeap::g_orphanMutex;
+ThreadCacheHeap::ThreadCache* ThreadCacheHeap::g_orphans = nullptr;
+std::atomic<Size> ThreadCacheHeap::g_reservedBytes( 0 );
+thread_local ThreadCacheHeap::CacheHolder ThreadCacheHeap::t_holder;
+
+// CONSTRUCTORS
+ThreadCacheHeap::CacheHolder::~CacheHolder()
+{
+    if ( cache == nullptr )
+    {
+        return;
+    }
+
+    // give the blocks back and park the cache for the next thread, it can't
+    // be deleted because other threads may still free blocks into it
+    drainRemote( cache );
+    for ( uint32 i = 0; i < CLASS_COUNT; ++i )
+    {
+        flushClass( cache, i, cache->counts[i] );
+    }
+
+    std::lock_guard<std::mutex> lock( g_orphanMutex );
+    cache->nextOrphan = g_orphans;
+    g_orphans = cache;
+    cache = nullptr;
+}
+
+// UTILITY FUNCTIONS
+void* ThreadCacheHeap::allocate( Size bytes )
+{
+    static_assert( sizeof( Header ) <= HEADER_SIZE, "header does not fit" );
+
+    uint32 sizeClass = classOf( bytes );
+    Header* header;
+
+    if ( sizeClass == CLASS_COUNT )
+    {
+        header = static_cast<Header*>( ::operator new( HEADER_SIZE + bytes ) );
+        header->owner = nullptr;
+    }
+    else
+    {
+        ThreadCache* cache = localCache();
+        if ( cache->freeLists[sizeClass] == nullptr )
+        {
+            refill( cache, sizeClass );
+        }
+
+        header = cache->freeLists[sizeClass];
+        cache->freeLists[sizeClass] = header->next;
+        --cache->counts[sizeClass];
+
+        header->owner = cache;
+    }
+
+    header->sizeClass = sizeClass;
+
+    return reinterpret_cast<uint8*>( header ) + HEADER_SIZE;
+}
+
+void ThreadCacheHeap::release( void* pointer )
+{
+    assert( pointer != nullptr );
+
+    Header* header = reinterpret_cast<Header*>(
+        static_cast<uint8*>( pointer ) - HEADER_SIZE );
+    uint32 sizeClass = static_cast<uint32>( header->sizeClass );
+
+    if ( sizeClass == CLASS_COUNT )
+    {
+        ::operator delete( header );
+        return;
+    }
+
+    ThreadCache* owner = header->owner;
+    ThreadCache* cache = t_holder.cache;
+    assert( owner != nullptr );
+
+    if ( owner == cache )
+    {
+        header->next = cache->freeLists[sizeClass];
+        cache->freeLists[sizeClass] = header;
+
+        uint32 batch = batchSize( sizeClass );
+        if ( ++cache->counts[sizeClass] > 2 * batch )
+        {
+            flushClass( cache, sizeClass, batch );
+        }
+    }
+    else
+    {
+        // freed on another thread, hand it back to the owner without a lock
+        Header* head = owner->remoteFrees.load( std::memory_order_relaxed );
+        do
+        {
+            header->next = head;
+        } while ( !owner->remoteFrees.compare_exchange_weak(
+                      head, header, std::memory_order_release,
+                      std::memory_order_relaxed ) );
+    }
+}
+
+void ThreadCacheHeap::flush()
+{
+    ThreadCache* cache = t_holder.cache;
+    if ( cache == nullptr )
+    {
+        return;
+    }
+
+    drainRemote( cache );
+    for ( uint32 i = 0; i < CLASS_COUNT; ++i )
+    {
+        flushClass( cache, i, cache->counts[i] );
+    }
+}
+
+Size ThreadCacheHeap::reservedBytes()
+{
+    return g_reservedBytes.load( std::memory_order_relaxed );
+}
+
+// HELPER FUNCTIONS
+uint32 ThreadCacheHeap::classOf( Size bytes )
+{
+    if ( bytes <= MIN_BLOCK_SIZE )
+    {
+        return 0;
+    }
+
+    if ( bytes > MAX_BLOCK_SIZE )
+    {
+        return CLASS_COUNT;
+    }
+
+    // the smallest power of two that holds the request, relative to the
+    // smallest class
+    uint64 value = static_cast<uint64>( bytes - 1 );
+    #ifdef __GNUC__
+    return static_cast<uint32>( 64 - __builtin_clzll( value ) ) - 4;
+    #else
+    uint32 sizeClass = 0;
+    for ( value >>= 4; value != 0; value >>= 1 )
+    {
+        ++sizeClass;
+    }
+
+    return sizeClass;
+    #endif
+}
+
+uint32 ThreadCacheHeap::batchSize( uint32 sizeClass )
+{
+    // move about 8 KiB at a time, but at least a few blocks
+    uint32 batch = static_cast<uint32>(
+        8192 / ( MIN_BLOCK_SIZE << sizeClass ) );
+
+    return batch < 4 ? 4 : batch > 64 ? 64 : batch;
+}
+
+ThreadCacheHeap::ThreadCache* ThreadCacheHeap::localCache()
+{
+    ThreadCache* cache = t_holder.cache;
+    if ( cache != nullptr )
+    {
+        return cache;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( g_orphanMutex );
+        cache = g_orphans;
+        if ( cache != nullptr )
+        {
+            g_orphans = cache->nextOrphan;
+        }
+    }
+
+    if ( cache == nullptr )
+    {
+        cache = new ThreadCache();
+        for ( uint32 i = 0; i < CLASS_COUNT; ++i )
+        {
+            cache->freeLists[i] = nullptr;
+            cache->counts[i] = 0;
+        }
+        cache->remoteFrees.store( nullptr, std::memory_order_relaxed );
+    }
+
+    cache->nextOrphan = nullptr;
+    t_holder.cache = cache;
+
+    return cache;
+}
+
+void ThreadCacheHeap::refill( ThreadCache* cache, uint32 sizeClass )
+{
+    assert( cache->freeLists[sizeClass] == nullptr );
+
+    drainRemote( cache );
+    if ( cache->freeLists[sizeClass] != nullptr )
+    {
+        return;
+    }
+
+    uint32 batch = batchSize( sizeClass );
+
+    // take a batch from the central pool
+    {
+        CentralList& central = g_central[sizeClass];
+        std::lock_guard<std::mutex> lock( central.mutex );
+
+        Header* head = central.head;
+        if ( head != nullptr )
+        {
+            Header* tail = head;
+            uint32 count = 1;
+            while ( count < batch && tail->next != nullptr )
+            {
+                tail = tail->next;
+                ++count;
+            }
+
+            central.head = tail->next;
+            central.count -= count;
+
+            tail->next = nullptr;
+            cache->freeLists[sizeClass] = head;
+            cache->counts[sizeClass] = count;
+            return;
+        }
+    }
+
+    // the pool is empty so carve a new batch from the heap
+    Size blockSize = HEADER_SIZE + ( MIN_BLOCK_SIZE << sizeClass );
+    uint8* chunk = static_cast<uint8*>( ::operator new( blockSize * batch ) );
+    g_reservedBytes.fetch_add( blockSize * batch, std::memory_order_relaxed );
+
+    Header* head = nullptr;
+    for ( uint32 i = batch; i > 0; --i )
+    {
+        Header* header = reinterpret_cast<Header*>(
+            chunk + ( i - 1 ) * blockSize );
+        header->next = head;
+        header->sizeClass = sizeClass;
+        head = header;
+    }
+
+    cache->freeLists[sizeClass] = head;
+    cache->counts[sizeClass] = batch;
+}
+
+void ThreadCacheHeap::drainRemote( ThreadCache* cache )
+{
+    Header* header = cache->remoteFrees.exchange( nullptr,
+                                                  std::memory_order_acquire );
+    while ( header != nullptr )
+    {
+        Header* next = header->next;
+        uint32 sizeClass = static_cast<uint32>( header->sizeClass );
+
+        header->next = cache->freeLists[sizeClass];
+        cache->freeLists[sizeClass] = header;
+        ++cache->counts[sizeClass];
+
+        header = next;
+    }
+}
+
+void ThreadCacheHeap::flushClass( ThreadCache* cache, uint32 sizeClass,
+                                  uint32 count )
+{
+    if ( count == 0 )
+    {
+        return;
+    }
+
+    assert( count <= cache->counts[sizeClass] );
+
+    // unlink the first count blocks before taking the lock
+    Header* head = cache->freeLists[sizeClass];
+    Header* tail = head;
+    for ( uint32 i = 1; i < count; ++i )
+    {
+        tail = tail->next;
+    }
+
+    cache->freeLists[sizeClass] = tail->next;
+    cache->counts[sizeClass] -= count;
+
+    CentralList& central = g_central[sizeClass];
+    std::lock_guard<std::mutex> lock( central.mutex );
+
+    tail->next = central.head;
+    central.head = head;
+    central.count += count;
+}
+
+} // End nspc mem
+
+} // End nspc demo
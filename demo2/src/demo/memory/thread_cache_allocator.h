@@ -0,0 +1,342 @@
+// thread_cache_allocator.h
+//
+// A thread caching allocator for workloads that allocate from many threads.
+//
+// Small allocations are rounded up to a power of two size class and served
+// from a free list that belongs to the calling thread, so the common path
+// takes no locks. When a thread's list for a class runs dry it is refilled
+// with a batch of blocks from a central pool, and when it grows too long a
+// batch is returned to the pool. The central pool carves new blocks from the
+// heap in batches as well, so the global heap lock is only taken once per
+// batch instead of once per allocation.
+//
+// Every block carries a small header that records its size class and the
+// cache that handed it out. A block released on another thread is pushed
+// onto its owner's remote free list with a lock-free compare and swap and is
+// reclaimed by the owner the next time it refills. Caches are never destroyed
+// while the program runs: when a thread exits its blocks are returned to the
+// central pool and the cache is kept aside for the next new thread so that
+// late remote frees always have somewhere to go.
+//
+// Allocations larger than the biggest size class go straight to the heap.
+//
+#ifndef DEMO_THREAD_CACHE_ALLOCATOR_H
+#define DEMO_THREAD_CACHE_ALLOCATOR_H
+
+#include <assert.h>
+#include <atomic>
+#include <mutex>
+
+#include "demo/memory/iallocator.h"
+#include "demo/memory/memory_utils.h"
+
+namespace demo
+{
+
+namespace mem
+{
+
+class ThreadCacheHeap
+{
+  public:
+    // CONSTANTS
+    /**
+     * The number of size classes.
+     */
+    static constexpr uint32 CLASS_COUNT = 12;
+
+    /**
+     * The size in bytes of the smallest size class.
+     */
+    static constexpr Size MIN_BLOCK_SIZE = 16;
+
+    /**
+     * The size in bytes of the largest size class.
+     */
+    static constexpr Size MAX_BLOCK_SIZE = MIN_BLOCK_SIZE << ( CLASS_COUNT - 1 );
+
+    /**
+     * The size in bytes of the block header.
+     *
+     * This is also the alignment of every allocation.
+     */
+    static constexpr Size HEADER_SIZE = 16;
+
+  private:
+    // TYPES
+    struct ThreadCache;
+
+    /**
+     * Precedes every block.
+     *
+     * The owner is only valid while the block is allocated and the link is
+     * only valid while it is free.
+     */
+    struct Header
+    {
+        union
+        {
+            ThreadCache* owner;
+            Header* next;
+        };
+        uint64 sizeClass;
+    };
+
+    /**
+     * The free lists of a single thread.
+     */
+    struct ThreadCache
+    {
+        Header* freeLists[CLASS_COUNT];
+        uint32 counts[CLASS_COUNT];
+        std::atomic<Header*> remoteFrees;
+        ThreadCache* nextOrphan;
+    };
+
+    /**
+     * The shared free list of a size class.
+     */
+    struct alignas( 64 ) CentralList
+    {
+        std::mutex mutex;
+        Header* head;
+        uint32 count;
+    };
+
+    /**
+     * Returns the thread's cache when the thread exits.
+     */
+    struct CacheHolder
+    {
+        ThreadCache* cache;
+        ~CacheHolder();
+    };
+
+    // GLOBALS
+    /**
+     * The central pool for each size class.
+     */
+    static CentralList g_central[CLASS_COUNT];
+
+    /**
+     * Guards the orphaned caches.
+     */
+    static std::mutex g_orphanMutex;
+
+    /**
+     * The caches of threads that have exited.
+     */
+    static ThreadCache* g_orphans;
+
+    /**
+     * The number of bytes carved from the heap for size classes.
+     */
+    static std::atomic<Size> g_reservedBytes;
+
+    /**
+     * The cache of the current thread.
+     */
+    static thread_local CacheHolder t_holder;
+
+    // HELPER FUNCTIONS
+    /**
+     * Gets the size class for the given number of bytes.
+     *
+     * Returns CLASS_COUNT when it is larger than every class.
+     */
+    static uint32 classOf( Size bytes );
+
+    /**
+     * Gets the number of blocks that are moved at once for a size class.
+     */
+    static uint32 batchSize( uint32 sizeClass );
+
+    /**
+     * Gets the cache of the current thread, creating or adopting one.
+     */
+    static ThreadCache* localCache();
+
+    /**
+     * Fills an empty free list of the given cache.
+     */
+    static void refill( ThreadCache* cache, uint32 sizeClass );
+
+    /**
+     * Moves every block freed by other threads into the cache's lists.
+     */
+    static void drainRemote( ThreadCache* cache );
+
+    /**
+     * Returns up to the given number of blocks of a class to the central pool.
+     */
+    static void flushClass( ThreadCache* cache, uint32 sizeClass,
+                            uint32 count );
+
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Allocates at least the given number of bytes.
+     *
+     * Throws a bad_alloc when:
+     * the system is out of memory
+     */
+    static void* allocate( Size bytes );
+
+    /**
+     * Releases an allocation from any thread.
+     *
+     * Behavior is undefined when:
+     * pointer was not returned by allocate
+     */
+    static void release( void* pointer );
+
+    /**
+     * Returns every block cached by the current thread to the central pool.
+     */
+    static void flush();
+
+    /**
+     * Gets the number of bytes carved from the heap for size classes.
+     *
+     * Blocks are recycled but never returned to the heap.
+     */
+    static Size reservedBytes();
+};
+
+template <typename T>
+class ThreadCacheAllocator : public IAllocator<T>
+{
+  private:
+    // GLOBALS
+    /**
+     * The shared instance.
+     */
+    static ThreadCacheAllocator<T> g_instance;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs a new allocator.
+     */
+    ThreadCacheAllocator();
+
+    /**
+     * Constructs a copy of an allocator.
+     */
+    ThreadCacheAllocator( const ThreadCacheAllocator<T>& copy );
+
+    /**
+     * Destructs the allocator.
+     */
+    virtual ~ThreadCacheAllocator();
+
+    // OPERATORS
+    /**
+     * Assigns a copy of an allocator.
+     */
+    ThreadCacheAllocator<T>& operator=( const ThreadCacheAllocator<T>& assign );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Allocates the given number of instances.
+     *
+     * Behavior is undefined when:
+     * T is void
+     * count is less than or equal to zero
+     * out of memory
+     */
+    virtual T* get( uint32 count );
+
+    /**
+     * Releases the allocation with the given number of instances.
+     *
+     * The allocation may be released on a different thread than the one it
+     * was allocated on.
+     *
+     * Behavior is undefined when:
+     * T is void
+     * pointer is invalid
+     * count is less than or equal to zero
+     */
+    virtual void release( T* pointer, uint32 count );
+
+    // GLOBAL FUNCTIONS
+    /**
+     * Gets the shared instance.
+     */
+    static ThreadCacheAllocator<T>* inst();
+};
+
+// GLOBALS
+template <typename T>
+ThreadCacheAllocator<T> ThreadCacheAllocator<T>::g_instance;
+
+// CONSTRUCTORS
+template <typename T>
+inline
+ThreadCacheAllocator<T>::ThreadCacheAllocator()
+{
+    static_assert( alignof( T ) <= ThreadCacheHeap::HEADER_SIZE,
+                   "type is over-aligned for the thread cache" );
+}
+
+template <typename T>
+inline
+ThreadCacheAllocator<T>::ThreadCacheAllocator(
+    const ThreadCacheAllocator<T>& copy )
+{
+}
+
+template <typename T>
+inline
+ThreadCacheAllocator<T>::~ThreadCacheAllocator()
+{
+}
+
+// OPERATORS
+template <typename T>
+inline
+ThreadCacheAllocator<T>& ThreadCacheAllocator<T>::operator=(
+    const ThreadCacheAllocator<T>& assign )
+{
+    return *this;
+}
+
+// MEMBER FUNCTIONS
+template <typename T>
+inline
+T* ThreadCacheAllocator<T>::get( uint32 count )
+{
+    assert( count > 0 );
+
+    T* pointer = static_cast<T*>(
+        ThreadCacheHeap::allocate( count * sizeof( T ) ) );
+    MemoryUtils::construct( pointer, count );
+
+    return pointer;
+}
+
+template <typename T>
+inline
+void ThreadCacheAllocator<T>::release( T* pointer, uint32 count )
+{
+    assert( count > 0 );
+    assert( pointer != nullptr );
+
+    MemoryUtils::destruct( pointer, count );
+    ThreadCacheHeap::release( pointer );
+}
+
+// GLOBAL FUNCTIONS
+template <typename T>
+inline
+ThreadCacheAllocator<T>* ThreadCacheAllocator<T>::inst()
+{
+    return &g_instance;
+}
+
+} // End nspc mem
+
+} // End nspc demo
+
+#endif // DEMO_THREAD_CACHE_ALLOCATOR_H
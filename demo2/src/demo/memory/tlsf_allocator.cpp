@@ -0,0 +1,601 @@
+// tlsf_allocator.cpp
+#include "demo/memory/tlsf_allocator.h"
+
+#include <new>
+
+namespace demo
+{
+
+namespace mem
+{
+
+// CONSTANTS
+constexpr uint32 TlsfAllocator::ALIGN_SIZE_LOG2;
+constexpr Size TlsfAllocator::ALIGN_SIZE;
+constexpr uint32 TlsfAllocator::SL_INDEX_COUNT_LOG2;
+constexpr uint32 TlsfAllocator::SL_INDEX_COUNT;
+constexpr uint32 TlsfAllocator::FL_INDEX_MAX;
+constexpr uint32 TlsfAllocator::FL_INDEX_SHIFT;
+constexpr uint32 TlsfAllocator::FL_INDEX_COUNT;
+constexpr Size TlsfAllocator::SMALL_BLOCK_SIZE;
+
+constexpr Size TlsfAllocator::FREE_BIT;
+constexpr Size TlsfAllocator::PREV_FREE_BIT;
+constexpr Size TlsfAllocator::BLOCK_OVERHEAD;
+constexpr Size TlsfAllocator::BLOCK_START_OFFSET;
+constexpr Size TlsfAllocator::BLOCK_SIZE_MIN;
+constexpr Size TlsfAllocator::BLOCK_SIZE_MAX;
+
+// CONSTRUCTORS
+TlsfAllocator::TlsfAllocator( void* region, Size bytes )
+    : _flBitmap( 0 ), _region( static_cast<uint8*>( region ) ),
+      _capacity( bytes ), _poolSize( 0 ), _usedBytes( 0 ), _freeBytes( 0 ),
+      _freeBlockCount( 0 ), _usedBlockCount( 0 ), _isValidating( false )
+{
+    assert( region != nullptr );
+    assert( reinterpret_cast<uintptr_t>( region ) % ALIGN_SIZE == 0 );
+    assert( bytes > 2 * BLOCK_OVERHEAD + BLOCK_SIZE_MIN );
+
+    for ( uint32 i = 0; i < FL_INDEX_COUNT; ++i )
+    {
+        _slBitmaps[i] = 0;
+        for ( uint32 j = 0; j < SL_INDEX_COUNT; ++j )
+        {
+            _blocks[i][j] = nullptr;
+        }
+    }
+
+    // the region holds one free block followed by an empty sentinel, the
+    // first header starts one word before the region because its previous
+    // physical link is never used
+    _poolSize = ( bytes - 2 * BLOCK_OVERHEAD ) & ~( ALIGN_SIZE - 1 );
+    assert( _poolSize <= BLOCK_SIZE_MAX );
+
+    BlockHeader* block = firstBlock();
+    block->size = _poolSize | FREE_BIT;
+    insertFreeBlock( block );
+
+    BlockHeader* sentinel = linkNext( block );
+    sentinel->size = PREV_FREE_BIT;
+
+    check();
+}
+
+TlsfAllocator::~TlsfAllocator()
+{
+    _region = nullptr;
+}
+
+// MEMBER FUNCTIONS
+void* TlsfAllocator::allocate( Size bytes, Size alignment )
+{
+    assert( alignment > 0 && ( alignment & ( alignment - 1 ) ) == 0 );
+
+    Size adjusted = adjustRequest( bytes, ALIGN_SIZE );
+    if ( adjusted == 0 )
+    {
+        throw std::bad_alloc();
+    }
+
+    BlockHeader* block;
+    if ( alignment <= ALIGN_SIZE )
+    {
+        block = locateFree( adjusted );
+        if ( block == nullptr )
+        {
+            throw std::bad_alloc();
+        }
+    }
+    else
+    {
+        // reserve room to move the payload forward to the alignment while
+        // still leaving a gap large enough to become a free block
+        Size gapMinimum = sizeof( BlockHeader );
+        Size padded = adjustRequest( adjusted + alignment + gapMinimum,
+                                     alignment );
+        block = padded == 0 ? nullptr : locateFree( padded );
+        if ( block == nullptr )
+        {
+            throw std::bad_alloc();
+        }
+
+        uintptr_t payload = reinterpret_cast<uintptr_t>( payloadOf( block ) );
+        uintptr_t mask = static_cast<uintptr_t>( alignment - 1 );
+        uintptr_t aligned = ( payload + mask ) & ~mask;
+        Size gap = static_cast<Size>( aligned - payload );
+
+        if ( gap > 0 && gap < gapMinimum )
+        {
+            Size remaining = gapMinimum - gap;
+            Size offset = remaining > alignment ? remaining : alignment;
+            aligned = ( aligned + offset + mask ) & ~mask;
+            gap = static_cast<Size>( aligned - payload );
+        }
+
+        if ( gap > 0 )
+        {
+            block = trimFreeLeading( block, gap );
+        }
+    }
+
+    void* pointer = prepareUsed( block, adjusted );
+    check();
+
+    return pointer;
+}
+
+void TlsfAllocator::release( void* pointer )
+{
+    if ( pointer == nullptr )
+    {
+        return;
+    }
+
+    BlockHeader* block = blockOf( pointer );
+    assert( ( block->size & FREE_BIT ) == 0 );
+
+    _usedBytes -= sizeOf( block );
+    --_usedBlockCount;
+
+    markFree( block );
+    block = mergePrevious( block );
+    block = mergeNext( block );
+    insertFreeBlock( block );
+
+    check();
+}
+
+Size TlsfAllocator::blockSize( const void* pointer ) const
+{
+    assert( pointer != nullptr );
+
+    return sizeOf( blockOf( const_cast<void*>( pointer ) ) );
+}
+
+bool TlsfAllocator::validate() const
+{
+    // every free block must be in the bin its size maps to
+    uint32 freeCount = 0;
+    Size freeBytes = 0;
+    for ( uint32 i = 0; i < FL_INDEX_COUNT; ++i )
+    {
+        bool hasFl = ( _flBitmap & ( 1u << i ) ) != 0;
+        if ( hasFl != ( _slBitmaps[i] != 0 ) )
+        {
+            return false;
+        }
+
+        for ( uint32 j = 0; j < SL_INDEX_COUNT; ++j )
+        {
+            bool hasSl = ( _slBitmaps[i] & ( 1u << j ) ) != 0;
+            if ( hasSl != ( _blocks[i][j] != nullptr ) )
+            {
+                return false;
+            }
+
+            const BlockHeader* previous = nullptr;
+            const BlockHeader* block;
+            for ( block = _blocks[i][j]; block != nullptr;
+                  block = block->nextFree )
+            {
+                uint32 fl;
+                uint32 sl;
+                mappingInsert( sizeOf( block ), &fl, &sl );
+
+                if ( ( block->size & FREE_BIT ) == 0 ||
+                     block->prevFree != previous || fl != i || sl != j )
+                {
+                    return false;
+                }
+
+                ++freeCount;
+                freeBytes += sizeOf( block );
+                previous = block;
+            }
+        }
+    }
+
+    if ( freeCount != _freeBlockCount || freeBytes != _freeBytes )
+    {
+        return false;
+    }
+
+    // every physical block must agree with its neighbours and no two free
+    // blocks may be adjacent
+    uint32 blockCount = 0;
+    Size totalBytes = 0;
+    bool isPrevFree = false;
+    BlockHeader* block;
+    for ( block = firstBlock(); sizeOf( block ) != 0;
+          block = nextPhysical( block ) )
+    {
+        bool isFree = ( block->size & FREE_BIT ) != 0;
+        if ( ( ( block->size & PREV_FREE_BIT ) != 0 ) != isPrevFree ||
+             ( isFree && isPrevFree ) || sizeOf( block ) < BLOCK_SIZE_MIN ||
+             sizeOf( block ) % ALIGN_SIZE != 0 )
+        {
+            return false;
+        }
+
+        if ( isFree && nextPhysical( block )->prevPhysical != block )
+        {
+            return false;
+        }
+
+        ++blockCount;
+        totalBytes += sizeOf( block ) + BLOCK_OVERHEAD;
+        isPrevFree = isFree;
+    }
+
+    return ( ( block->size & PREV_FREE_BIT ) != 0 ) == isPrevFree &&
+           blockCount == _freeBlockCount + _usedBlockCount &&
+           totalBytes == _poolSize + BLOCK_OVERHEAD;
+}
+
+Size TlsfAllocator::largestFreeBlock() const
+{
+    if ( _flBitmap == 0 )
+    {
+        return 0;
+    }
+
+    uint32 fl = findLastSet( _flBitmap );
+    uint32 sl = findLastSet( _slBitmaps[fl] );
+
+    Size largest = 0;
+    const BlockHeader* block;
+    for ( block = _blocks[fl][sl]; block != nullptr; block = block->nextFree )
+    {
+        if ( sizeOf( block ) > largest )
+        {
+            largest = sizeOf( block );
+        }
+    }
+
+    return largest;
+}
+
+float TlsfAllocator::fragmentation() const
+{
+    if ( _freeBytes == 0 )
+    {
+        return 0.0f;
+    }
+
+    return 1.0f - static_cast<float>( largestFreeBlock() ) /
+                  static_cast<float>( _freeBytes );
+}
+
+// HELPER FUNCTIONS
+uint32 TlsfAllocator::findFirstSet( uint32 word )
+{
+    assert( word != 0 );
+
+    #ifdef __GNUC__
+    return static_cast<uint32>( __builtin_ctz( word ) );
+    #else
+    uint32 bit = 0;
+    while ( ( word & 1 ) == 0 )
+    {
+        word >>= 1;
+        ++bit;
+    }
+
+    return bit;
+    #endif
+}
+
+uint32 TlsfAllocator::findLastSet( uint64 word )
+{
+    assert( word != 0 );
+
+    #ifdef __GNUC__
+    return static_cast<uint32>( 63 - __builtin_clzll( word ) );
+    #else
+    uint32 bit = 0;
+    while ( word >>= 1 )
+    {
+        ++bit;
+    }
+
+    return bit;
+    #endif
+}
+
+Size TlsfAllocator::sizeOf( const BlockHeader* block )
+{
+    return block->size & ~( FREE_BIT | PREV_FREE_BIT );
+}
+
+void* TlsfAllocator::payloadOf( BlockHeader* block )
+{
+    return reinterpret_cast<uint8*>( block ) + BLOCK_START_OFFSET;
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::blockOf( void* pointer )
+{
+    return reinterpret_cast<BlockHeader*>(
+        static_cast<uint8*>( pointer ) - BLOCK_START_OFFSET );
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::nextPhysical(
+    const BlockHeader* block )
+{
+    // the next header starts at the last word of this block's payload
+    return reinterpret_cast<BlockHeader*>(
+        reinterpret_cast<uint8*>( const_cast<BlockHeader*>( block ) ) +
+        BLOCK_START_OFFSET + sizeOf( block ) - BLOCK_OVERHEAD );
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::linkNext( BlockHeader* block )
+{
+    BlockHeader* next = nextPhysical( block );
+    next->prevPhysical = block;
+
+    return next;
+}
+
+void TlsfAllocator::markFree( BlockHeader* block )
+{
+    BlockHeader* next = linkNext( block );
+    next->size |= PREV_FREE_BIT;
+    block->size |= FREE_BIT;
+}
+
+void TlsfAllocator::markUsed( BlockHeader* block )
+{
+    BlockHeader* next = nextPhysical( block );
+    next->size &= ~PREV_FREE_BIT;
+    block->size &= ~FREE_BIT;
+}
+
+Size TlsfAllocator::adjustRequest( Size bytes, Size alignment )
+{
+    if ( bytes == 0 )
+    {
+        bytes = 1;
+    }
+
+    Size aligned = ( bytes + alignment - 1 ) & ~( alignment - 1 );
+    if ( aligned < bytes || aligned >= BLOCK_SIZE_MAX )
+    {
+        return 0;
+    }
+
+    return aligned < BLOCK_SIZE_MIN ? BLOCK_SIZE_MIN : aligned;
+}
+
+void TlsfAllocator::mappingInsert( Size size, uint32* fl, uint32* sl )
+{
+    if ( size < SMALL_BLOCK_SIZE )
+    {
+        // small blocks are binned linearly in the first level
+        *fl = 0;
+        *sl = static_cast<uint32>( size / ( SMALL_BLOCK_SIZE /
+                                            SL_INDEX_COUNT ) );
+    }
+    else
+    {
+        uint32 bit = findLastSet( size );
+        *sl = static_cast<uint32>( size >> ( bit - SL_INDEX_COUNT_LOG2 ) ) ^
+              SL_INDEX_COUNT;
+        *fl = bit - ( FL_INDEX_SHIFT - 1 );
+    }
+}
+
+void TlsfAllocator::mappingSearch( Size size, uint32* fl, uint32* sl )
+{
+    // round up to the next bin so that any block in it fits
+    if ( size >= SMALL_BLOCK_SIZE )
+    {
+        Size round = ( static_cast<Size>( 1 ) <<
+                       ( findLastSet( size ) - SL_INDEX_COUNT_LOG2 ) ) - 1;
+        size += round;
+    }
+
+    mappingInsert( size, fl, sl );
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::searchSuitableBlock(
+    uint32* fl, uint32* sl ) const
+{
+    uint32 slMap = _slBitmaps[*fl] & ( ~0u << *sl );
+    if ( slMap == 0 )
+    {
+        // no block in this first level so look in the next larger one
+        uint32 flMap = *fl + 1 < 32 ? _flBitmap & ( ~0u << ( *fl + 1 ) ) : 0;
+        if ( flMap == 0 )
+        {
+            return nullptr;
+        }
+
+        *fl = findFirstSet( flMap );
+        slMap = _slBitmaps[*fl];
+    }
+
+    *sl = findFirstSet( slMap );
+
+    return _blocks[*fl][*sl];
+}
+
+void TlsfAllocator::insertFreeBlock( BlockHeader* block )
+{
+    uint32 fl;
+    uint32 sl;
+    mappingInsert( sizeOf( block ), &fl, &sl );
+
+    BlockHeader* head = _blocks[fl][sl];
+    block->nextFree = head;
+    block->prevFree = nullptr;
+    if ( head != nullptr )
+    {
+        head->prevFree = block;
+    }
+
+    _blocks[fl][sl] = block;
+    _flBitmap |= 1u << fl;
+    _slBitmaps[fl] |= 1u << sl;
+
+    _freeBytes += sizeOf( block );
+    ++_freeBlockCount;
+}
+
+void TlsfAllocator::removeFreeBlock( BlockHeader* block, uint32 fl, uint32 sl )
+{
+    BlockHeader* previous = block->prevFree;
+    BlockHeader* next = block->nextFree;
+
+    if ( next != nullptr )
+    {
+        next->prevFree = previous;
+    }
+
+    if ( previous != nullptr )
+    {
+        previous->nextFree = next;
+    }
+    else
+    {
+        _blocks[fl][sl] = next;
+        if ( next == nullptr )
+        {
+            _slBitmaps[fl] &= ~( 1u << sl );
+            if ( _slBitmaps[fl] == 0 )
+            {
+                _flBitmap &= ~( 1u << fl );
+            }
+        }
+    }
+
+    _freeBytes -= sizeOf( block );
+    --_freeBlockCount;
+}
+
+void TlsfAllocator::removeFreeBlock( BlockHeader* block )
+{
+    uint32 fl;
+    uint32 sl;
+    mappingInsert( sizeOf( block ), &fl, &sl );
+    removeFreeBlock( block, fl, sl );
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::locateFree( Size size )
+{
+    uint32 fl;
+    uint32 sl;
+    mappingSearch( size, &fl, &sl );
+
+    if ( fl >= FL_INDEX_COUNT )
+    {
+        return nullptr;
+    }
+
+    BlockHeader* block = searchSuitableBlock( &fl, &sl );
+    if ( block != nullptr )
+    {
+        assert( sizeOf( block ) >= size );
+        removeFreeBlock( block, fl, sl );
+    }
+
+    return block;
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::split( BlockHeader* block,
+                                                  Size size )
+{
+    BlockHeader* remaining = reinterpret_cast<BlockHeader*>(
+        static_cast<uint8*>( payloadOf( block ) ) + size - BLOCK_OVERHEAD );
+    Size remainingSize = sizeOf( block ) - ( size + BLOCK_OVERHEAD );
+
+    assert( remainingSize >= BLOCK_SIZE_MIN );
+    remaining->size = remainingSize;
+    block->size = size | ( block->size & ( FREE_BIT | PREV_FREE_BIT ) );
+
+    markFree( remaining );
+
+    return remaining;
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::absorb( BlockHeader* previous,
+                                                   BlockHeader* block )
+{
+    previous->size += sizeOf( block ) + BLOCK_OVERHEAD;
+    linkNext( previous );
+
+    return previous;
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::mergePrevious( BlockHeader* block )
+{
+    if ( ( block->size & PREV_FREE_BIT ) != 0 )
+    {
+        BlockHeader* previous = block->prevPhysical;
+        removeFreeBlock( previous );
+        block = absorb( previous, block );
+    }
+
+    return block;
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::mergeNext( BlockHeader* block )
+{
+    BlockHeader* next = nextPhysical( block );
+    if ( ( next->size & FREE_BIT ) != 0 )
+    {
+        removeFreeBlock( next );
+        block = absorb( block, next );
+    }
+
+    return block;
+}
+
+void TlsfAllocator::trimFree( BlockHeader* block, Size size )
+{
+    if ( sizeOf( block ) >= sizeof( BlockHeader ) + size )
+    {
+        BlockHeader* remaining = split( block, size );
+        linkNext( block );
+        remaining->size |= PREV_FREE_BIT;
+        insertFreeBlock( remaining );
+    }
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::trimFreeLeading(
+    BlockHeader* block, Size size )
+{
+    BlockHeader* remaining = block;
+    if ( sizeOf( block ) >= sizeof( BlockHeader ) + size )
+    {
+        remaining = split( block, size - BLOCK_OVERHEAD );
+        remaining->size |= PREV_FREE_BIT;
+        linkNext( block );
+        insertFreeBlock( block );
+    }
+
+    return remaining;
+}
+
+void* TlsfAllocator::prepareUsed( BlockHeader* block, Size size )
+{
+    trimFree( block, size );
+    markUsed( block );
+
+    _usedBytes += sizeOf( block );
+    ++_usedBlockCount;
+
+    return payloadOf( block );
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::firstBlock() const
+{
+    return reinterpret_cast<BlockHeader*>( _region - BLOCK_OVERHEAD );
+}
+
+void TlsfAllocator::check() const
+{
+    assert( !_isValidating || validate() );
+}
+
+} // End nspc mem
+
+} // End nspc demo
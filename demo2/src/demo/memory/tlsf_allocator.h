@@ -0,0 +1,614 @@
+// tlsf_allocator.h
+//
+// A two-level segregated fit (TLSF) allocator over a caller supplied region.
+//
+// Free blocks are binned by size into a first level of power of two ranges,
+// each of which is split linearly into a second level of sub-ranges. A bitmap
+// per level records which bins hold blocks so that a fitting block is found
+// with two find-first-set instructions instead of a search. Released blocks
+// are merged with their free physical neighbours immediately. Both
+// allocation and release therefore run in constant time regardless of how
+// many blocks exist, which makes the allocator suitable for work that must
+// not stall within a frame.
+//
+// The allocator only manages the region it is given. It never grows and
+// never calls into the system allocator.
+//
+// Fragmentation is reported as the share of free memory that lies outside
+// the largest free block. A validation mode checks every block and bin after
+// each operation, which is slow but catches heap corruption where it happens.
+//
+#ifndef DEMO_TLSF_ALLOCATOR_H
+#define DEMO_TLSF_ALLOCATOR_H
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "demo/intdef.h"
+#include "demo/memory/iallocator.h"
+#include "demo/memory/memory_utils.h"
+
+namespace demo
+{
+
+namespace mem
+{
+
+class TlsfAllocator
+{
+  public:
+    // CONSTANTS
+    /**
+     * The log2 of the allocation granularity.
+     */
+    static constexpr uint32 ALIGN_SIZE_LOG2 = sizeof( Size ) == 8 ? 3 : 2;
+
+    /**
+     * The allocation granularity and the minimum alignment.
+     */
+    static constexpr Size ALIGN_SIZE = static_cast<Size>( 1 ) << ALIGN_SIZE_LOG2;
+
+    /**
+     * The log2 of the number of second level bins per first level bin.
+     */
+    static constexpr uint32 SL_INDEX_COUNT_LOG2 = 5;
+
+    /**
+     * The number of second level bins per first level bin.
+     */
+    static constexpr uint32 SL_INDEX_COUNT = 1 << SL_INDEX_COUNT_LOG2;
+
+    /**
+     * The log2 of the largest supported block.
+     */
+    static constexpr uint32 FL_INDEX_MAX = sizeof( Size ) == 8 ? 32 : 30;
+
+    /**
+     * The first level below which blocks are binned linearly.
+     */
+    static constexpr uint32 FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 +
+                                             ALIGN_SIZE_LOG2;
+
+    /**
+     * The number of first level bins.
+     */
+    static constexpr uint32 FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+
+    /**
+     * The size below which blocks are binned linearly.
+     */
+    static constexpr Size SMALL_BLOCK_SIZE = static_cast<Size>( 1 ) <<
+                                             FL_INDEX_SHIFT;
+
+  private:
+    // TYPES
+    /**
+     * Describes a block.
+     *
+     * The previous physical link is stored in the last word of the previous
+     * block and is only valid while that block is free. The free list links
+     * are stored in the block's payload and are only valid while the block
+     * is free. The two lowest bits of the size hold the free flags.
+     */
+    struct BlockHeader
+    {
+        BlockHeader* prevPhysical;
+        Size size;
+        BlockHeader* nextFree;
+        BlockHeader* prevFree;
+    };
+
+    // CONSTANTS
+    /**
+     * The size flag set when the block is free.
+     */
+    static constexpr Size FREE_BIT = 1;
+
+    /**
+     * The size flag set when the previous physical block is free.
+     */
+    static constexpr Size PREV_FREE_BIT = 2;
+
+    /**
+     * The bytes used by an allocated block beyond its payload.
+     */
+    static constexpr Size BLOCK_OVERHEAD = sizeof( Size );
+
+    /**
+     * The offset of the payload from the start of the header.
+     */
+    static constexpr Size BLOCK_START_OFFSET = offsetof( BlockHeader, size ) +
+                                               sizeof( Size );
+
+    /**
+     * The smallest block that can hold the free list links.
+     */
+    static constexpr Size BLOCK_SIZE_MIN = sizeof( BlockHeader ) -
+                                           sizeof( BlockHeader* );
+
+    /**
+     * The size above which blocks are not supported.
+     */
+    static constexpr Size BLOCK_SIZE_MAX = static_cast<Size>( 1 ) <<
+                                           FL_INDEX_MAX;
+
+    // MEMBERS
+    /**
+     * The bitmap of first level bins that hold free blocks.
+     */
+    uint32 _flBitmap;
+
+    /**
+     * The bitmaps of second level bins that hold free blocks.
+     */
+    uint32 _slBitmaps[FL_INDEX_COUNT];
+
+    /**
+     * The free lists of every bin.
+     */
+    BlockHeader* _blocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
+
+    /**
+     * The managed region.
+     */
+    uint8* _region;
+
+    /**
+     * The size of the managed region.
+     */
+    Size _capacity;
+
+    /**
+     * The number of usable bytes in the region.
+     */
+    Size _poolSize;
+
+    /**
+     * The number of bytes in allocated blocks.
+     */
+    Size _usedBytes;
+
+    /**
+     * The number of bytes in free blocks.
+     */
+    Size _freeBytes;
+
+    /**
+     * The number of free blocks.
+     */
+    uint32 _freeBlockCount;
+
+    /**
+     * The number of allocated blocks.
+     */
+    uint32 _usedBlockCount;
+
+    /**
+     * Whether the heap is validated after every operation.
+     */
+    bool _isValidating;
+
+    /**
+     * Constructs a copy of the given allocator.
+     *
+     * This is not a supported operation for region allocators.
+     */
+    TlsfAllocator( const TlsfAllocator& other );
+
+    /**
+     * Assigns this as a copy of the other allocator.
+     *
+     * This is not a supported operation for region allocators.
+     */
+    TlsfAllocator& operator=( const TlsfAllocator& other );
+
+    // HELPER FUNCTIONS
+    /**
+     * Gets the index of the lowest set bit.
+     */
+    static uint32 findFirstSet( uint32 word );
+
+    /**
+     * Gets the index of the highest set bit.
+     */
+    static uint32 findLastSet( uint64 word );
+
+    /**
+     * Gets the payload size of a block.
+     */
+    static Size sizeOf( const BlockHeader* block );
+
+    /**
+     * Gets the payload of a block.
+     */
+    static void* payloadOf( BlockHeader* block );
+
+    /**
+     * Gets the block of a payload.
+     */
+    static BlockHeader* blockOf( void* pointer );
+
+    /**
+     * Gets the next physical block.
+     */
+    static BlockHeader* nextPhysical( const BlockHeader* block );
+
+    /**
+     * Links the next physical block back to this one and gets it.
+     */
+    static BlockHeader* linkNext( BlockHeader* block );
+
+    /**
+     * Flags a block and its next physical neighbour for a free block.
+     */
+    static void markFree( BlockHeader* block );
+
+    /**
+     * Flags a block and its next physical neighbour for a used block.
+     */
+    static void markUsed( BlockHeader* block );
+
+    /**
+     * Rounds a request up to a valid block size.
+     *
+     * Returns zero if the request is too large.
+     */
+    static Size adjustRequest( Size bytes, Size alignment );
+
+    /**
+     * Gets the bin for a block of the given size.
+     */
+    static void mappingInsert( Size size, uint32* fl, uint32* sl );
+
+    /**
+     * Gets the first bin whose blocks are all at least the given size.
+     */
+    static void mappingSearch( Size size, uint32* fl, uint32* sl );
+
+    /**
+     * Gets a free block from the first non-empty bin at or above the given
+     * bin and updates the bin to the one it was found in.
+     */
+    BlockHeader* searchSuitableBlock( uint32* fl, uint32* sl ) const;
+
+    /**
+     * Adds a free block to its bin.
+     */
+    void insertFreeBlock( BlockHeader* block );
+
+    /**
+     * Removes a free block from the given bin.
+     */
+    void removeFreeBlock( BlockHeader* block, uint32 fl, uint32 sl );
+
+    /**
+     * Removes a free block from its bin.
+     */
+    void removeFreeBlock( BlockHeader* block );
+
+    /**
+     * Finds and removes a free block of at least the given size.
+     */
+    BlockHeader* locateFree( Size size );
+
+    /**
+     * Splits a block so that it has the given size and returns the rest.
+     */
+    BlockHeader* split( BlockHeader* block, Size size );
+
+    /**
+     * Merges a block into the free block that precedes it.
+     */
+    BlockHeader* absorb( BlockHeader* previous, BlockHeader* block );
+
+    /**
+     * Merges a block with its previous physical neighbour if it is free.
+     */
+    BlockHeader* mergePrevious( BlockHeader* block );
+
+    /**
+     * Merges a block with its next physical neighbour if it is free.
+     */
+    BlockHeader* mergeNext( BlockHeader* block );
+
+    /**
+     * Returns the tail of a free block beyond the given size to the bins.
+     */
+    void trimFree( BlockHeader* block, Size size );
+
+    /**
+     * Returns the head of a free block before the given offset to the bins.
+     */
+    BlockHeader* trimFreeLeading( BlockHeader* block, Size size );
+
+    /**
+     * Marks a free block as allocated and gets its payload.
+     */
+    void* prepareUsed( BlockHeader* block, Size size );
+
+    /**
+     * Gets the first block in the region.
+     */
+    BlockHeader* firstBlock() const;
+
+    /**
+     * Asserts that the heap is valid if validation is enabled.
+     */
+    void check() const;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs an allocator over the given region.
+     *
+     * The region must outlive the allocator.
+     *
+     * Behavior is undefined when:
+     * region is not aligned to ALIGN_SIZE
+     * bytes is too small to hold a block or larger than the largest block
+     */
+    TlsfAllocator( void* region, Size bytes );
+
+    /**
+     * Destructs the allocator.
+     */
+    ~TlsfAllocator();
+
+    // MEMBER FUNCTIONS
+    /**
+     * Allocates the given number of bytes aligned to ALIGN_SIZE.
+     *
+     * Throws a bad_alloc when:
+     * no free block is large enough
+     */
+    void* allocate( Size bytes );
+
+    /**
+     * Allocates the given number of bytes with the given alignment.
+     *
+     * Throws a bad_alloc when:
+     * no free block is large enough
+     *
+     * Behavior is undefined when:
+     * alignment is not a power of two
+     */
+    void* allocate( Size bytes, Size alignment );
+
+    /**
+     * Releases an allocation.
+     *
+     * Behavior is undefined when:
+     * pointer was not returned by this allocator
+     */
+    void release( void* pointer );
+
+    /**
+     * Gets the usable size of an allocation.
+     */
+    Size blockSize( const void* pointer ) const;
+
+    /**
+     * Checks every block and bin for consistency.
+     */
+    bool validate() const;
+
+    /**
+     * Sets whether the heap is validated after every operation.
+     */
+    void setValidating( bool isValidating );
+
+    /**
+     * Checks if the heap is validated after every operation.
+     */
+    bool isValidating() const;
+
+    /**
+     * Gets the number of bytes in allocated blocks.
+     */
+    Size usedBytes() const;
+
+    /**
+     * Gets the number of bytes in free blocks.
+     */
+    Size freeBytes() const;
+
+    /**
+     * Gets the number of allocated blocks.
+     */
+    uint32 usedBlockCount() const;
+
+    /**
+     * Gets the number of free blocks.
+     */
+    uint32 freeBlockCount() const;
+
+    /**
+     * Gets the size of the largest free block.
+     *
+     * This searches the largest non-empty bin.
+     */
+    Size largestFreeBlock() const;
+
+    /**
+     * Gets the share of free memory outside the largest free block.
+     *
+     * This is zero when all free memory is contiguous.
+     */
+    float fragmentation() const;
+
+    /**
+     * Gets the size of the managed region.
+     */
+    Size capacity() const;
+};
+
+/**
+ * Adapts a TLSF allocator so that it can be used wherever an IAllocator is
+ * expected, including containers.
+ */
+template <typename T>
+class TlsfAdapter : public IAllocator<T>
+{
+  private:
+    // MEMBERS
+    /**
+     * The underlying allocator.
+     */
+    TlsfAllocator* _tlsf;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs an adapter for the given allocator.
+     */
+    TlsfAdapter( TlsfAllocator* tlsf );
+
+    /**
+     * Constructs a copy of an adapter.
+     */
+    TlsfAdapter( const TlsfAdapter<T>& copy );
+
+    /**
+     * Destructs the adapter.
+     */
+    virtual ~TlsfAdapter();
+
+    // OPERATORS
+    /**
+     * Assigns a copy of an adapter.
+     */
+    TlsfAdapter<T>& operator=( const TlsfAdapter<T>& assign );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Allocates the given number of instances.
+     *
+     * Behavior is undefined when:
+     * T is void
+     * count is less than or equal to zero
+     * out of memory
+     */
+    virtual T* get( uint32 count );
+
+    /**
+     * Releases the allocation with the given number of instances.
+     *
+     * Behavior is undefined when:
+     * T is void
+     * pointer is invalid
+     * count is less than or equal to zero
+     */
+    virtual void release( T* pointer, uint32 count );
+};
+
+// MEMBER FUNCTIONS
+inline
+void* TlsfAllocator::allocate( Size bytes )
+{
+    return allocate( bytes, ALIGN_SIZE );
+}
+
+inline
+void TlsfAllocator::setValidating( bool isValidating )
+{
+    _isValidating = isValidating;
+}
+
+inline
+bool TlsfAllocator::isValidating() const
+{
+    return _isValidating;
+}
+
+inline
+Size TlsfAllocator::usedBytes() const
+{
+    return _usedBytes;
+}
+
+inline
+Size TlsfAllocator::freeBytes() const
+{
+    return _freeBytes;
+}
+
+inline
+uint32 TlsfAllocator::usedBlockCount() const
+{
+    return _usedBlockCount;
+}
+
+inline
+uint32 TlsfAllocator::freeBlockCount() const
+{
+    return _freeBlockCount;
+}
+
+inline
+Size TlsfAllocator::capacity() const
+{
+    return _capacity;
+}
+
+// ADAPTER CONSTRUCTORS
+template <typename T>
+inline
+TlsfAdapter<T>::TlsfAdapter( TlsfAllocator* tlsf ) : _tlsf( tlsf )
+{
+    assert( tlsf != nullptr );
+}
+
+template <typename T>
+inline
+TlsfAdapter<T>::TlsfAdapter( const TlsfAdapter<T>& copy )
+    : _tlsf( copy._tlsf )
+{
+}
+
+template <typename T>
+inline
+TlsfAdapter<T>::~TlsfAdapter()
+{
+    _tlsf = nullptr;
+}
+
+// ADAPTER OPERATORS
+template <typename T>
+inline
+TlsfAdapter<T>& TlsfAdapter<T>::operator=( const TlsfAdapter<T>& assign )
+{
+    _tlsf = assign._tlsf;
+
+    return *this;
+}
+
+// ADAPTER MEMBER FUNCTIONS
+template <typename T>
+inline
+T* TlsfAdapter<T>::get( uint32 count )
+{
+    assert( count > 0 );
+
+    T* pointer = static_cast<T*>( _tlsf->allocate( count * sizeof( T ),
+                                                   alignof( T ) ) );
+    MemoryUtils::construct( pointer, count );
+
+    return pointer;
+}
+
+template <typename T>
+inline
+void TlsfAdapter<T>::release( T* pointer, uint32 count )
+{
+    assert( count > 0 );
+    assert( pointer != nullptr );
+
+    MemoryUtils::destruct( pointer, count );
+    _tlsf->release( pointer );
+}
+
+} // End nspc mem
+
+} // End nspc demo
+
+#endif // DEMO_TLSF_ALLOCATOR_H
@@ -0,0 +1,151 @@
+// archetype.cpp
+#include "archetype.h"
+
+#include <stdint.h>
+
+namespace demo
+{
+
+namespace obj
+{
+
+// CONSTANTS
+constexpr uint32 Archetype::CHUNK_SIZE;
+constexpr uint32 Archetype::NO_COLUMN;
+constexpr uint32 Archetype::CACHE_LINE_SIZE;
+
+// HELPER FUNCTIONS
+uint32 Archetype::layout( uint32 capacity )
+{
+    uint32 end = capacity * static_cast<uint32>( sizeof( Entity ) );
+    for ( uint32 i = 0; i < _types.size(); ++i )
+    {
+        end = ( end + CACHE_LINE_SIZE - 1 ) & ~( CACHE_LINE_SIZE - 1 );
+        _offsets[i] = end;
+        end += capacity * _sizes[i];
+    }
+
+    return end;
+}
+
+// CONSTRUCTORS
+Archetype::Archetype( ComponentMask mask )
+    : _mask( mask ), _types(), _offsets(), _sizes(), _chunks(),
+      _spare( nullptr ), _capacity( 0 ), _size( 0 )
+{
+    uint32 rowSize = sizeof( Entity );
+    for ( uint32 type = 0; type < ComponentType::MAX_TYPES; ++type )
+    {
+        _columns[type] = NO_COLUMN;
+        if ( ( mask & ComponentType::maskOf( type ) ) != 0 )
+        {
+            const ComponentType::Info& info = ComponentType::info( type );
+            assert( info.alignment <= CACHE_LINE_SIZE );
+
+            _columns[type] = _types.size();
+            _types.push( type );
+            _offsets.push( 0 );
+            _sizes.push( info.size );
+            rowSize += info.size;
+        }
+    }
+
+    // start from the count that ignores the padding and back off until the
+    // padded columns fit
+    _capacity = CHUNK_SIZE / rowSize;
+    while ( _capacity > 0 && layout( _capacity ) > CHUNK_SIZE )
+    {
+        --_capacity;
+    }
+    assert( _capacity > 0 );
+}
+
+Archetype::~Archetype()
+{
+    for ( uint32 row = 0; row < _size; ++row )
+    {
+        destruct( row );
+    }
+
+    for ( uint32 i = 0; i < _chunks.size(); ++i )
+    {
+        delete[] _chunks[i].memory;
+    }
+    delete[] _spare;
+}
+
+// MEMBER FUNCTIONS
+uint32 Archetype::allocate( Entity entity )
+{
+    if ( _chunks.size() == 0 || _chunks[_chunks.size() - 1].size == _capacity )
+    {
+        Chunk chunk;
+        if ( _spare != nullptr )
+        {
+            chunk.memory = _spare;
+            _spare = nullptr;
+        }
+        else
+        {
+            chunk.memory = new uint8[CHUNK_SIZE + CACHE_LINE_SIZE];
+        }
+
+        uintptr_t address = reinterpret_cast<uintptr_t>( chunk.memory );
+        address = ( address + CACHE_LINE_SIZE - 1 ) & ~static_cast<uintptr_t>(
+            CACHE_LINE_SIZE - 1 );
+        chunk.data = reinterpret_cast<uint8*>( address );
+        chunk.size = 0;
+        _chunks.push( chunk );
+    }
+
+    Chunk& chunk = _chunks[_chunks.size() - 1];
+    reinterpret_cast<Entity*>( chunk.data )[chunk.size] = entity;
+    ++chunk.size;
+
+    return _size++;
+}
+
+void Archetype::destruct( uint32 row )
+{
+    for ( uint32 i = 0; i < _types.size(); ++i )
+    {
+        ComponentType::info( _types[i] ).destruct( component( row, i ) );
+    }
+}
+
+Entity Archetype::release( uint32 row )
+{
+    assert( row < _size );
+
+    uint32 last = _size - 1;
+    Entity moved;
+    if ( row != last )
+    {
+        for ( uint32 i = 0; i < _types.size(); ++i )
+        {
+            ComponentType::info( _types[i] ).move( component( row, i ),
+                                                   component( last, i ) );
+        }
+
+        moved = entity( last );
+        Entity* rowEntities = reinterpret_cast<Entity*>(
+            _chunks[row / _capacity].data );
+        rowEntities[row % _capacity] = moved;
+    }
+
+    // keep one emptied chunk so an entity moving back and forth across a
+    // chunk boundary does not allocate each time
+    Chunk& chunk = _chunks[_chunks.size() - 1];
+    if ( --chunk.size == 0 )
+    {
+        delete[] _spare;
+        _spare = _chunks.pop().memory;
+    }
+
+    --_size;
+    return moved;
+}
+
+} // End nspc obj
+
+} // End nspc demo
@@ -0,0 +1,321 @@
+// archetype.h
+//
+// The storage of every entity with the same set of component types.
+//
+// Entities are stored in chunks of 16 KB. A chunk holds an array of entity
+// handles followed by an array per component type, each starting on a cache
+// line, so iterating one component of a chunk streams through contiguous
+// memory and a query over several components reads a few linear streams.
+// The number of entities per chunk is as many as fit.
+//
+// Entities are addressed by row, which runs through the chunks in order.
+// Every chunk but the last is full: a released row is filled by moving the
+// last row into it, so the rows stay dense without gaps to skip.
+//
+#ifndef DEMO_ARCHETYPE_H
+#define DEMO_ARCHETYPE_H
+
+#include <assert.h>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/intdef.h"
+#include "demo/object/component_type.h"
+#include "demo/object/entity.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+class Archetype
+{
+  public:
+    // CONSTANTS
+    /**
+     * The size of a chunk in bytes.
+     */
+    static constexpr uint32 CHUNK_SIZE = 16 * 1024;
+
+    /**
+     * The column of a component type that is not stored.
+     */
+    static constexpr uint32 NO_COLUMN = 0xFFFFFFFF;
+
+  private:
+    // TYPES
+    /**
+     * A chunk of entities.
+     */
+    struct Chunk
+    {
+        uint8* memory;
+        uint8* data;
+        uint32 size;
+    };
+
+    // CONSTANTS
+    /**
+     * The alignment of each array in a chunk.
+     */
+    static constexpr uint32 CACHE_LINE_SIZE = 64;
+
+    // MEMBERS
+    /**
+     * The component types stored.
+     */
+    ComponentMask _mask;
+
+    /**
+     * The type id of each column.
+     */
+    cntr::DynamicArray<uint32> _types;
+
+    /**
+     * The offset of each column in a chunk.
+     */
+    cntr::DynamicArray<uint32> _offsets;
+
+    /**
+     * The size of a component in each column.
+     */
+    cntr::DynamicArray<uint32> _sizes;
+
+    /**
+     * The column of each type id or NO_COLUMN.
+     */
+    uint32 _columns[ComponentType::MAX_TYPES];
+
+    /**
+     * The chunks in row order.
+     */
+    cntr::DynamicArray<Chunk> _chunks;
+
+    /**
+     * An emptied chunk kept for reuse or nullptr.
+     */
+    uint8* _spare;
+
+    /**
+     * The number of entities per chunk.
+     */
+    uint32 _capacity;
+
+    /**
+     * The number of entities.
+     */
+    uint32 _size;
+
+    // HELPER FUNCTIONS
+    /**
+     * Lay the columns out in a chunk for the given number of entities.
+     * @param capacity The number of entities.
+     * @return The bytes used.
+     */
+    uint32 layout( uint32 capacity );
+
+    // HIDDEN FUNCTIONS
+    Archetype( const Archetype& other ) = delete;
+
+    Archetype& operator=( const Archetype& other ) = delete;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct an empty archetype.
+     * @param mask The component types to store.
+     */
+    explicit Archetype( ComponentMask mask );
+
+    /**
+     * Destruct the archetype and every component in it.
+     */
+    ~Archetype();
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the component types stored.
+     * @return The component types.
+     */
+    ComponentMask mask() const;
+
+    /**
+     * Get the number of entities per chunk.
+     * @return The number of entities.
+     */
+    uint32 capacity() const;
+
+    /**
+     * Get the number of entities.
+     * @return The number of entities.
+     */
+    uint32 size() const;
+
+    /**
+     * Get the number of columns.
+     * @return The number of columns.
+     */
+    uint32 columnCount() const;
+
+    /**
+     * Get the type id of a column.
+     * @param column The column.
+     * @return The type id.
+     */
+    uint32 type( uint32 column ) const;
+
+    /**
+     * Get the column of a component type.
+     * @param type The type id.
+     * @return The column or NO_COLUMN if the type is not stored.
+     */
+    uint32 column( uint32 type ) const;
+
+    /**
+     * Get the number of chunks.
+     * @return The number of chunks.
+     */
+    uint32 chunkCount() const;
+
+    /**
+     * Get the number of entities in a chunk.
+     * @param chunk The chunk.
+     * @return The number of entities.
+     */
+    uint32 chunkSize( uint32 chunk ) const;
+
+    /**
+     * Get the entities in a chunk.
+     * @param chunk The chunk.
+     * @return The entities.
+     */
+    const Entity* entities( uint32 chunk ) const;
+
+    /**
+     * Get the components in a column of a chunk.
+     * @param chunk The chunk.
+     * @param column The column.
+     * @return The components.
+     */
+    void* components( uint32 chunk, uint32 column ) const;
+
+    /**
+     * Get the entity in a row.
+     * @param row The row.
+     * @return The entity.
+     */
+    Entity entity( uint32 row ) const;
+
+    /**
+     * Get the component in a column of a row.
+     * @param row The row.
+     * @param column The column.
+     * @return The component.
+     */
+    void* component( uint32 row, uint32 column ) const;
+
+    // MEMBER FUNCTIONS
+    /**
+     * Append a row for an entity.
+     * The components of the row are left unconstructed.
+     * @param entity The entity.
+     * @return The row.
+     */
+    uint32 allocate( Entity entity );
+
+    /**
+     * Destruct the components of a row.
+     * @param row The row.
+     */
+    void destruct( uint32 row );
+
+    /**
+     * Release a row whose components have been destructed or moved out by
+     * moving the last row into it.
+     * @param row The row.
+     * @return The entity moved into the row or the null entity if the row
+     * was the last.
+     */
+    Entity release( uint32 row );
+};
+
+// ACCESSOR FUNCTIONS
+inline
+ComponentMask Archetype::mask() const
+{
+    return _mask;
+}
+
+inline
+uint32 Archetype::capacity() const
+{
+    return _capacity;
+}
+
+inline
+uint32 Archetype::size() const
+{
+    return _size;
+}
+
+inline
+uint32 Archetype::columnCount() const
+{
+    return _types.size();
+}
+
+inline
+uint32 Archetype::type( uint32 column ) const
+{
+    return _types[column];
+}
+
+inline
+uint32 Archetype::column( uint32 type ) const
+{
+    assert( type < ComponentType::MAX_TYPES );
+    return _columns[type];
+}
+
+inline
+uint32 Archetype::chunkCount() const
+{
+    return _chunks.size();
+}
+
+inline
+uint32 Archetype::chunkSize( uint32 chunk ) const
+{
+    return _chunks[chunk].size;
+}
+
+inline
+const Entity* Archetype::entities( uint32 chunk ) const
+{
+    return reinterpret_cast<const Entity*>( _chunks[chunk].data );
+}
+
+inline
+void* Archetype::components( uint32 chunk, uint32 column ) const
+{
+    return _chunks[chunk].data + _offsets[column];
+}
+
+inline
+Entity Archetype::entity( uint32 row ) const
+{
+    return entities( row / _capacity )[row % _capacity];
+}
+
+inline
+void* Archetype::component( uint32 row, uint32 column ) const
+{
+    return _chunks[row / _capacity].data + _offsets[column] +
+           ( row % _capacity ) * _sizes[column];
+}
+
+} // End nspc obj
+
+} // End nspc demo
+
+#endif // DEMO_ARCHETYPE_H
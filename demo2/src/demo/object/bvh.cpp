@@ -0,0 +1,737 @@
+// bvh.cpp
+#include "bvh.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "demo/utility/thread_pool.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+// CONSTANTS
+constexpr uint32 Bvh::NO_PROXY;
+constexpr uint32 Bvh::MAX_DEPTH;
+constexpr uint32 Bvh::NO_NODE;
+constexpr uint32 Bvh::FREE_HEIGHT;
+constexpr uint32 Bvh::BIN_COUNT;
+constexpr uint32 Bvh::SAH_DEPTH;
+constexpr float Bvh::DISPLACEMENT_FACTOR;
+constexpr float Bvh::LOOSE_MARGINS;
+constexpr float Bvh::REBUILD_RATIO;
+constexpr uint32 Bvh::REBALANCE_RATIO;
+constexpr uint32 Bvh::RAY_BATCH_SIZE;
+
+// HELPER FUNCTIONS
+uint32 Bvh::allocateNode()
+{
+    if ( _freeNode == NO_NODE )
+    {
+        _nodes.push( Node() );
+        _parents.push( NO_NODE );
+        _heights.push( 0 );
+        return _nodes.size() - 1;
+    }
+
+    uint32 node = _freeNode;
+    _freeNode = _parents[node];
+    _parents[node] = NO_NODE;
+    _heights[node] = 0;
+    return node;
+}
+
+void Bvh::freeNode( uint32 node )
+{
+    _parents[node] = _freeNode;
+    _heights[node] = FREE_HEIGHT;
+    _freeNode = node;
+}
+
+void Bvh::updateNode( uint32 node )
+{
+    Node& parent = _nodes[node];
+    const Node& left = _nodes[parent.left];
+    const Node& right = _nodes[parent.right];
+
+    parent.min = glm::min( left.min, right.min );
+    parent.max = glm::max( left.max, right.max );
+    _heights[node] = 1 + std::max( _heights[parent.left],
+                                   _heights[parent.right] );
+}
+
+void Bvh::insertLeaf( uint32 leaf )
+{
+    ++_changeCount;
+
+    if ( _root == NO_NODE )
+    {
+        _root = leaf;
+        _parents[leaf] = NO_NODE;
+        return;
+    }
+
+    // descend while going down costs less than pairing the leaf with the
+    // node here; every node passed on the way grows to hold the leaf
+    const glm::vec3 leafMin = _nodes[leaf].min;
+    const glm::vec3 leafMax = _nodes[leaf].max;
+    uint32 index = _root;
+    while ( !isLeaf( index ) )
+    {
+        const Node& node = _nodes[index];
+        float nodeArea = area( node.min, node.max );
+        float combinedArea = area( glm::min( node.min, leafMin ),
+                                   glm::max( node.max, leafMax ) );
+
+        float cost = 2.0f * combinedArea;
+        float inheritedCost = 2.0f * ( combinedArea - nodeArea );
+
+        float childCosts[2];
+        uint32 children[2] = { node.left, node.right };
+        for ( uint32 i = 0; i < 2; ++i )
+        {
+            const Node& child = _nodes[children[i]];
+            float grown = area( glm::min( child.min, leafMin ),
+                                glm::max( child.max, leafMax ) );
+            childCosts[i] = inheritedCost +
+                            ( isLeaf( children[i] ) ?
+                              grown : grown - area( child.min, child.max ) );
+        }
+
+        if ( cost < childCosts[0] && cost < childCosts[1] )
+        {
+            break;
+        }
+
+        index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+    }
+
+    uint32 sibling = index;
+    uint32 oldParent = _parents[sibling];
+    uint32 newParent = allocateNode();
+
+    Node& parent = _nodes[newParent];
+    parent.left = sibling;
+    parent.right = leaf;
+    _parents[newParent] = oldParent;
+    _parents[sibling] = newParent;
+    _parents[leaf] = newParent;
+
+    if ( oldParent == NO_NODE )
+    {
+        _root = newParent;
+    }
+    else if ( _nodes[oldParent].left == sibling )
+    {
+        _nodes[oldParent].left = newParent;
+    }
+    else
+    {
+        _nodes[oldParent].right = newParent;
+    }
+
+    // fix the boxes and heights on the way back up
+    updateNode( newParent );
+    for ( index = newParent; index != NO_NODE; index = _parents[index] )
+    {
+        index = balance( index );
+        updateNode( index );
+    }
+}
+
+void Bvh::removeLeaf( uint32 leaf )
+{
+    ++_changeCount;
+
+    if ( leaf == _root )
+    {
+        _root = NO_NODE;
+        return;
+    }
+
+    uint32 parent = _parents[leaf];
+    uint32 grandParent = _parents[parent];
+    uint32 sibling = _nodes[parent].left == leaf ? _nodes[parent].right :
+                                                   _nodes[parent].left;
+
+    // the sibling takes the parent's place
+    freeNode( parent );
+    _parents[sibling] = grandParent;
+    if ( grandParent == NO_NODE )
+    {
+        _root = sibling;
+        return;
+    }
+
+    if ( _nodes[grandParent].left == parent )
+    {
+        _nodes[grandParent].left = sibling;
+    }
+    else
+    {
+        _nodes[grandParent].right = sibling;
+    }
+
+    for ( uint32 index = grandParent;
+          index != NO_NODE;
+          index = _parents[index] )
+    {
+        index = balance( index );
+        updateNode( index );
+    }
+}
+
+uint32 Bvh::balance( uint32 a )
+{
+    if ( isLeaf( a ) || _heights[a] < 2 )
+    {
+        return a;
+    }
+
+    uint32 b = _nodes[a].left;
+    uint32 c = _nodes[a].right;
+    int32 difference = static_cast<int32>( _heights[c] ) -
+                       static_cast<int32>( _heights[b] );
+    if ( difference >= -1 && difference <= 1 )
+    {
+        return a;
+    }
+
+    // the taller child takes a's place, a takes the taller child's shorter
+    // child, and the taller child keeps its taller one
+    uint32 up = difference > 1 ? c : b;
+    uint32 first = _nodes[up].left;
+    uint32 second = _nodes[up].right;
+    uint32 keep = _heights[first] > _heights[second] ? first : second;
+    uint32 give = keep == first ? second : first;
+
+    uint32 parent = _parents[a];
+    _parents[up] = parent;
+    _parents[a] = up;
+    if ( parent == NO_NODE )
+    {
+        _root = up;
+    }
+    else if ( _nodes[parent].left == a )
+    {
+        _nodes[parent].left = up;
+    }
+    else
+    {
+        _nodes[parent].right = up;
+    }
+
+    _nodes[up].left = a;
+    _nodes[up].right = keep;
+    if ( difference > 1 )
+    {
+        _nodes[a].right = give;
+    }
+    else
+    {
+        _nodes[a].left = give;
+    }
+    _parents[give] = a;
+
+    updateNode( a );
+    updateNode( up );
+    return up;
+}
+
+void Bvh::fatten( const rndr::Bounds& bounds, const glm::vec3& displacement,
+                  Node* leaf ) const
+{
+    glm::vec3 margin( _margin );
+    glm::vec3 stretch = displacement * DISPLACEMENT_FACTOR;
+
+    leaf->min = bounds.min() - margin + glm::min( stretch, glm::vec3( 0.0f ) );
+    leaf->max = bounds.max() + margin + glm::max( stretch, glm::vec3( 0.0f ) );
+}
+
+bool Bvh::isEscaped( const Node& leaf, const rndr::Bounds& bounds,
+                     const Node& fat ) const
+{
+    const glm::vec3& min = bounds.min();
+    const glm::vec3& max = bounds.max();
+    if ( min.x < leaf.min.x || min.y < leaf.min.y || min.z < leaf.min.z ||
+         max.x > leaf.max.x || max.y > leaf.max.y || max.z > leaf.max.z )
+    {
+        return true;
+    }
+
+    // a fat box left far larger than a fresh one would be is shrunk
+    glm::vec3 slack( _margin * LOOSE_MARGINS );
+    glm::vec3 hugeMin = fat.min - slack;
+    glm::vec3 hugeMax = fat.max + slack;
+    return leaf.min.x < hugeMin.x || leaf.min.y < hugeMin.y ||
+           leaf.min.z < hugeMin.z || leaf.max.x > hugeMax.x ||
+           leaf.max.y > hugeMax.y || leaf.max.z > hugeMax.z;
+}
+
+uint32 Bvh::split( const BuildTask& task )
+{
+    Node* items = &_buildItems[0];
+    uint32 count = task.end - task.begin;
+
+    // split along the axis the centers are spread farthest on
+    glm::vec3 low = items[task.begin].min + items[task.begin].max;
+    glm::vec3 high = low;
+    for ( uint32 i = task.begin + 1; i < task.end; ++i )
+    {
+        glm::vec3 center = items[i].min + items[i].max;
+        low = glm::min( low, center );
+        high = glm::max( high, center );
+    }
+
+    glm::vec3 spread = high - low;
+    uint32 axis = spread.x > spread.y ?
+                  ( spread.x > spread.z ? 0 : 2 ) :
+                  ( spread.y > spread.z ? 1 : 2 );
+
+    // boxes with the same center can only be split by count
+    if ( spread[axis] <= 0.0f )
+    {
+        return task.begin + count / 2;
+    }
+
+    auto centerOf = [axis]( const Node& item ) {
+        return item.min[axis] + item.max[axis];
+    };
+
+    if ( task.depth >= SAH_DEPTH || count <= 2 )
+    {
+        uint32 middle = task.begin + count / 2;
+        std::nth_element( items + task.begin, items + middle,
+                          items + task.end,
+                          [&]( const Node& left, const Node& right ) {
+            return centerOf( left ) < centerOf( right );
+        } );
+        return middle;
+    }
+
+    // sort the boxes into bins by center
+    uint32 binCounts[BIN_COUNT] = {};
+    glm::vec3 binMins[BIN_COUNT];
+    glm::vec3 binMaxes[BIN_COUNT];
+    for ( uint32 i = 0; i < BIN_COUNT; ++i )
+    {
+        binMins[i] = glm::vec3( std::numeric_limits<float>::max() );
+        binMaxes[i] = glm::vec3( -std::numeric_limits<float>::max() );
+    }
+
+    float scale = BIN_COUNT / spread[axis];
+    auto binOf = [&]( const Node& item ) {
+        uint32 bin = static_cast<uint32>( ( centerOf( item ) - low[axis] ) *
+                                          scale );
+        return std::min( bin, BIN_COUNT - 1 );
+    };
+
+    for ( uint32 i = task.begin; i < task.end; ++i )
+    {
+        uint32 bin = binOf( items[i] );
+        ++binCounts[bin];
+        binMins[bin] = glm::min( binMins[bin], items[i].min );
+        binMaxes[bin] = glm::max( binMaxes[bin], items[i].max );
+    }
+
+    // sweep from the right to get the cost of every right side, then from
+    // the left to find the cheapest split
+    float rightCosts[BIN_COUNT];
+    glm::vec3 min = binMins[BIN_COUNT - 1];
+    glm::vec3 max = binMaxes[BIN_COUNT - 1];
+    uint32 rightCount = 0;
+    for ( uint32 i = BIN_COUNT - 1; i > 0; --i )
+    {
+        min = glm::min( min, binMins[i] );
+        max = glm::max( max, binMaxes[i] );
+        rightCount += binCounts[i];
+        rightCosts[i] = rightCount == 0 ? 0.0f : rightCount * area( min, max );
+    }
+
+    uint32 best = 0;
+    float bestCost = std::numeric_limits<float>::max();
+    min = binMins[0];
+    max = binMaxes[0];
+    uint32 leftCount = 0;
+    for ( uint32 i = 1; i < BIN_COUNT; ++i )
+    {
+        min = glm::min( min, binMins[i - 1] );
+        max = glm::max( max, binMaxes[i - 1] );
+        leftCount += binCounts[i - 1];
+        if ( leftCount == 0 || leftCount == count )
+        {
+            continue;
+        }
+
+        float cost = leftCount * area( min, max ) + rightCosts[i];
+        if ( cost < bestCost )
+        {
+            best = i;
+            bestCost = cost;
+        }
+    }
+
+    assert( best != 0 );
+
+    Node* middle = std::partition( items + task.begin, items + task.end,
+                                   [&]( const Node& item ) {
+        return binOf( item ) < best;
+    } );
+    return static_cast<uint32>( middle - items );
+}
+
+// ACCESSOR FUNCTIONS
+float Bvh::cost() const
+{
+    if ( _root == NO_NODE || isLeaf( _root ) )
+    {
+        return 0.0f;
+    }
+
+    float total = 0.0f;
+    for ( uint32 i = 0; i < _nodes.size(); ++i )
+    {
+        if ( _heights[i] != FREE_HEIGHT && _heights[i] > 0 )
+        {
+            total += area( _nodes[i].min, _nodes[i].max );
+        }
+    }
+
+    float rootArea = area( _nodes[_root].min, _nodes[_root].max );
+    return rootArea > 0.0f ? total / rootArea : 0.0f;
+}
+
+// MEMBER FUNCTIONS
+uint32 Bvh::createProxy( const rndr::Bounds& bounds )
+{
+    assert( !bounds.isEmpty() );
+
+    uint32 proxy = _freeProxy;
+    if ( proxy == NO_PROXY )
+    {
+        _proxies.push( Proxy() );
+        proxy = _proxies.size() - 1;
+    }
+    else
+    {
+        _freeProxy = _proxies[proxy].nextFree;
+    }
+
+    uint32 leaf = allocateNode();
+    fatten( bounds, glm::vec3( 0.0f ), &_nodes[leaf] );
+    _nodes[leaf].left = NO_NODE;
+    _nodes[leaf].right = proxy;
+
+    Proxy& p = _proxies[proxy];
+    p.min = bounds.min();
+    p.max = bounds.max();
+    p.node = leaf;
+    p.nextFree = NO_PROXY;
+    ++_proxyCount;
+
+    if ( !_isDirty )
+    {
+        insertLeaf( leaf );
+    }
+    return proxy;
+}
+
+void Bvh::destroyProxy( uint32 proxy )
+{
+    assert( _proxies[proxy].node != NO_NODE );
+
+    uint32 leaf = _proxies[proxy].node;
+    if ( !_isDirty )
+    {
+        removeLeaf( leaf );
+    }
+    freeNode( leaf );
+
+    _proxies[proxy].node = NO_NODE;
+    _proxies[proxy].nextFree = _freeProxy;
+    _freeProxy = proxy;
+    --_proxyCount;
+}
+
+bool Bvh::moveProxy( uint32 proxy, const rndr::Bounds& bounds )
+{
+    Proxy& p = _proxies[proxy];
+    Node fat;
+    fatten( bounds, bounds.center() - ( p.min + p.max ) * 0.5f, &fat );
+    p.min = bounds.min();
+    p.max = bounds.max();
+
+    uint32 leaf = p.node;
+    if ( !isEscaped( _nodes[leaf], bounds, fat ) )
+    {
+        return false;
+    }
+
+    if ( !_isDirty )
+    {
+        removeLeaf( leaf );
+    }
+
+    _nodes[leaf].min = fat.min;
+    _nodes[leaf].max = fat.max;
+
+    if ( !_isDirty )
+    {
+        insertLeaf( leaf );
+    }
+    return true;
+}
+
+bool Bvh::refitProxy( uint32 proxy, const rndr::Bounds& bounds )
+{
+    Proxy& p = _proxies[proxy];
+    Node fat;
+    fatten( bounds, bounds.center() - ( p.min + p.max ) * 0.5f, &fat );
+    p.min = bounds.min();
+    p.max = bounds.max();
+
+    Node& leaf = _nodes[p.node];
+    if ( !isEscaped( leaf, bounds, fat ) )
+    {
+        return false;
+    }
+
+    leaf.min = fat.min;
+    leaf.max = fat.max;
+    if ( !_isDirty )
+    {
+        ++_changeCount;
+        _isRefitNeeded = true;
+    }
+    return true;
+}
+
+void Bvh::refit()
+{
+    if ( !_isRefitNeeded )
+    {
+        return;
+    }
+
+    // every node comes before its children in the order, so walking it
+    // backwards sees the children done first
+    _refitOrder.clear();
+    _refitOrder.push( _root );
+    for ( uint32 i = 0; i < _refitOrder.size(); ++i )
+    {
+        const Node& node = _nodes[_refitOrder[i]];
+        if ( node.left != NO_NODE )
+        {
+            _refitOrder.push( node.left );
+            _refitOrder.push( node.right );
+        }
+    }
+
+    for ( uint32 i = _refitOrder.size(); i-- > 0; )
+    {
+        if ( !isLeaf( _refitOrder[i] ) )
+        {
+            updateNode( _refitOrder[i] );
+        }
+    }
+
+    _isRefitNeeded = false;
+}
+
+void Bvh::invalidate()
+{
+    _isDirty = true;
+    _isRefitNeeded = false;
+}
+
+void Bvh::rebuild()
+{
+    // gather the leaves, then lay the tree out again from the start
+    _buildItems.clear();
+    for ( uint32 i = 0; i < _proxies.size(); ++i )
+    {
+        if ( _proxies[i].node != NO_NODE )
+        {
+            _buildItems.push( _nodes[_proxies[i].node] );
+        }
+    }
+
+    _nodes.clear();
+    _parents.clear();
+    _heights.clear();
+    _root = NO_NODE;
+    _freeNode = NO_NODE;
+    _isDirty = false;
+    _isRefitNeeded = false;
+    _changeCount = 0;
+    _buildCost = 0.0f;
+
+    if ( _buildItems.size() == 0 )
+    {
+        return;
+    }
+
+    _root = allocateNode();
+
+    BuildTask tasks[MAX_DEPTH];
+    uint32 taskCount = 0;
+    tasks[taskCount++] = BuildTask{ _root, 0, _buildItems.size(), 0 };
+    while ( taskCount > 0 )
+    {
+        BuildTask task = tasks[--taskCount];
+        if ( task.end - task.begin == 1 )
+        {
+            const Node& item = _buildItems[task.begin];
+            _nodes[task.node] = item;
+            _proxies[item.right].node = task.node;
+            continue;
+        }
+
+        // the children of a node sit side by side
+        uint32 middle = split( task );
+        uint32 left = allocateNode();
+        uint32 right = allocateNode();
+        _nodes[task.node].left = left;
+        _nodes[task.node].right = right;
+        _parents[left] = task.node;
+        _parents[right] = task.node;
+
+        // the left run is popped first, so its nodes follow these
+        assert( taskCount + 2 <= MAX_DEPTH );
+        tasks[taskCount++] = BuildTask{ right, middle, task.end,
+                                        task.depth + 1 };
+        tasks[taskCount++] = BuildTask{ left, task.begin, middle,
+                                        task.depth + 1 };
+    }
+
+    // children always come after their parents
+    for ( uint32 i = _nodes.size(); i-- > 0; )
+    {
+        if ( !isLeaf( i ) )
+        {
+            updateNode( i );
+        }
+    }
+
+    _buildCost = cost();
+}
+
+bool Bvh::rebalance()
+{
+    assert( !_isDirty );
+
+    // checking the cost walks every node, so it waits for enough changes
+    if ( _changeCount == 0 || _changeCount < _proxyCount / REBALANCE_RATIO )
+    {
+        return false;
+    }
+
+    _changeCount = 0;
+    if ( _buildCost > 0.0f && cost() <= _buildCost * REBUILD_RATIO )
+    {
+        return false;
+    }
+
+    rebuild();
+    return true;
+}
+
+void Bvh::clear()
+{
+    _nodes.clear();
+    _parents.clear();
+    _heights.clear();
+    _proxies.clear();
+    _root = NO_NODE;
+    _freeNode = NO_NODE;
+    _freeProxy = NO_PROXY;
+    _proxyCount = 0;
+    _buildCost = 0.0f;
+    _changeCount = 0;
+    _isDirty = false;
+    _isRefitNeeded = false;
+}
+
+Bvh::RayHit Bvh::raycast( const Ray& ray ) const
+{
+    RayHit hit = { NO_PROXY, ray.maxDistance };
+    raycast( ray, [&hit]( uint32 proxy, float distance ) {
+        if ( distance < hit.distance || hit.proxy == NO_PROXY )
+        {
+            hit.proxy = proxy;
+            hit.distance = distance;
+        }
+        return hit.distance;
+    } );
+    return hit;
+}
+
+void Bvh::raycast( const Ray* rays, uint32 count, RayHit* hits,
+                   util::ThreadPool* threadPool ) const
+{
+    auto castBatch = [&]( uint32 batch ) {
+        uint32 end = std::min( ( batch + 1 ) * RAY_BATCH_SIZE, count );
+        for ( uint32 i = batch * RAY_BATCH_SIZE; i < end; ++i )
+        {
+            hits[i] = raycast( rays[i] );
+        }
+    };
+
+    uint32 batchCount = ( count + RAY_BATCH_SIZE - 1 ) / RAY_BATCH_SIZE;
+    if ( threadPool == nullptr || batchCount < 2 )
+    {
+        for ( uint32 batch = 0; batch < batchCount; ++batch )
+        {
+            castBatch( batch );
+        }
+    }
+    else
+    {
+        threadPool->parallelFor( batchCount, castBatch );
+    }
+}
+
+void Bvh::queryBoxes( const rndr::Bounds* boxes, uint32 count,
+                      cntr::DynamicArray<uint32>* proxies,
+                      cntr::DynamicArray<uint32>* ends ) const
+{
+    proxies->clear();
+    ends->clear();
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        queryBox( boxes[i], [proxies]( uint32 proxy ) {
+            proxies->push( proxy );
+        } );
+        ends->push( proxies->size() );
+    }
+}
+
+// UTILITY FUNCTIONS
+float Bvh::intersect( const glm::vec3& min, const glm::vec3& max,
+                      const glm::vec3& origin, const glm::vec3& inverse,
+                      float maxDistance )
+{
+    float enter = 0.0f;
+    float exit = maxDistance;
+    for ( uint32 axis = 0; axis < 3; ++axis )
+    {
+        float near = ( min[axis] - origin[axis] ) * inverse[axis];
+        float far = ( max[axis] - origin[axis] ) * inverse[axis];
+        if ( near > far )
+        {
+            std::swap( near, far );
+        }
+
+        // written so that a ray along a face, which gives NaN, still hits
+        enter = near > enter ? near : enter;
+        exit = far < exit ? far : exit;
+    }
+
+    return enter <= exit ? enter : -1.0f;
+}
+
+} // End nspc obj
+
+} // End nspc demo
@@ -0,0 +1,828 @@
+// bvh.h
+//
+// A bounding volume hierarchy over boxes, for finding what is inside a
+// frustum, overlaps a box or sphere, or is hit by a ray without testing
+// every box.
+//
+// Each box is a proxy with an id that stays the same for as long as it
+// exists. The tree stores a fat copy of each box, grown by a margin and
+// stretched in the direction the box last moved, so a box that moves a
+// little stays inside its fat box and costs nothing. A box that escapes is
+// either reinserted, which keeps the tree tight, or refit, which grows its
+// leaf in place and leaves the boxes above it to be recomputed in one pass
+// by refit. Refitting is cheaper when many boxes move at once, but the tree
+// gets looser over time; rebalance rebuilds it once it has degraded enough.
+//
+// Reinsertion walks down the tree picking the sibling that adds the least
+// surface area and then rotates the nodes on the way back up to keep the
+// tree balanced. A rebuild sorts every box into bins and splits where the
+// surface area heuristic is lowest, which gives the best tree but takes
+// longer; it suits boxes that seldom move. Invalidating the tree stops it
+// from being kept up to date until the next rebuild, which makes adding or
+// moving a large number of boxes cheap.
+//
+// The nodes are kept in a flat array. Every node holds only its box and its
+// children, so two fit in a cache line, and a rebuild lays them out depth
+// first with both children of a node next to each other. Queries only read
+// the tree, so any number of them may run at once.
+//
+#ifndef DEMO_BVH_H
+#define DEMO_BVH_H
+
+#include <assert.h>
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/intdef.h"
+#include "demo/render/bounds.h"
+#include "demo/render/frustum.h"
+
+namespace demo
+{
+
+namespace util
+{
+
+class ThreadPool;
+
+} // End nspc util
+
+namespace obj
+{
+
+class Bvh
+{
+  public:
+    // CONSTANTS
+    /**
+     * The id of no proxy.
+     */
+    static constexpr uint32 NO_PROXY = 0xFFFFFFFF;
+
+    /**
+     * The deepest a tree may get.
+     */
+    static constexpr uint32 MAX_DEPTH = 64;
+
+    // TYPES
+    /**
+     * A ray to cast through the tree.
+     */
+    struct Ray
+    {
+        glm::vec3 origin;
+        glm::vec3 direction;
+        float maxDistance;
+    };
+
+    /**
+     * The closest box a ray hit.
+     */
+    struct RayHit
+    {
+        uint32 proxy;
+        float distance;
+    };
+
+  private:
+    // CONSTANTS
+    /**
+     * The index of no node.
+     */
+    static constexpr uint32 NO_NODE = 0xFFFFFFFF;
+
+    /**
+     * The height that marks a node as free.
+     */
+    static constexpr uint32 FREE_HEIGHT = 0xFFFFFFFF;
+
+    /**
+     * The number of bins boxes are sorted into when rebuilding.
+     */
+    static constexpr uint32 BIN_COUNT = 16;
+
+    /**
+     * The depth past which a rebuild splits at the median, which keeps the
+     * tree within MAX_DEPTH however the boxes are spread.
+     */
+    static constexpr uint32 SAH_DEPTH = 32;
+
+    /**
+     * How far along its last move a fat box is stretched, in moves.
+     */
+    static constexpr float DISPLACEMENT_FACTOR = 2.0f;
+
+    /**
+     * How many margins a fat box may reach past a fresh one on any side
+     * before it is shrunk, so boxes that once moved far do not stay loose.
+     */
+    static constexpr float LOOSE_MARGINS = 4.0f;
+
+    /**
+     * How many times the cost after the last rebuild the tree may reach
+     * before rebalance rebuilds it.
+     */
+    static constexpr float REBUILD_RATIO = 1.5f;
+
+    /**
+     * The fraction of the proxies, as one over this, that must change
+     * before rebalance checks the cost.
+     */
+    static constexpr uint32 REBALANCE_RATIO = 4;
+
+    /**
+     * The number of rays cast by each task of a batch.
+     */
+    static constexpr uint32 RAY_BATCH_SIZE = 64;
+
+    // TYPES
+    /**
+     * A node of the tree: a leaf holds one proxy, every other node has two
+     * children.
+     */
+    struct Node
+    {
+        glm::vec3 min;
+        uint32 left;
+        glm::vec3 max;
+        uint32 right;
+    };
+
+    /**
+     * The exact box of a proxy and its leaf.
+     */
+    struct Proxy
+    {
+        glm::vec3 min;
+        uint32 node;
+        glm::vec3 max;
+        uint32 nextFree;
+    };
+
+    /**
+     * A run of the boxes being rebuilt and the node they go under.
+     */
+    struct BuildTask
+    {
+        uint32 node;
+        uint32 begin;
+        uint32 end;
+        uint32 depth;
+    };
+
+    // MEMBERS
+    /**
+     * The nodes. A leaf has no left child and its right child is its
+     * proxy.
+     */
+    cntr::DynamicArray<Node> _nodes;
+
+    /**
+     * The parent of each node, or the next free node for free ones.
+     */
+    cntr::DynamicArray<uint32> _parents;
+
+    /**
+     * The height of each node, which is 0 for leaves.
+     */
+    cntr::DynamicArray<uint32> _heights;
+
+    /**
+     * The proxies.
+     */
+    cntr::DynamicArray<Proxy> _proxies;
+
+    /**
+     * The leaves and the runs of boxes being rebuilt.
+     */
+    cntr::DynamicArray<Node> _buildItems;
+
+    /**
+     * The nodes in the order they are refit.
+     */
+    cntr::DynamicArray<uint32> _refitOrder;
+
+    /**
+     * The root node or NO_NODE for an empty tree.
+     */
+    uint32 _root;
+
+    /**
+     * The first free node or NO_NODE for none.
+     */
+    uint32 _freeNode;
+
+    /**
+     * The first free proxy or NO_PROXY for none.
+     */
+    uint32 _freeProxy;
+
+    /**
+     * The number of proxies.
+     */
+    uint32 _proxyCount;
+
+    /**
+     * The distance fat boxes are grown by on every side.
+     */
+    float _margin;
+
+    /**
+     * The cost right after the last rebuild or 0 for none.
+     */
+    float _buildCost;
+
+    /**
+     * The number of leaves inserted, removed, or refit since the cost was
+     * last checked.
+     */
+    uint32 _changeCount;
+
+    /**
+     * Whether the tree is out of date until the next rebuild.
+     */
+    bool _isDirty;
+
+    /**
+     * Whether leaves were refit since the last refit.
+     */
+    bool _isRefitNeeded;
+
+    // HELPER FUNCTIONS
+    /**
+     * Check if a node is a leaf.
+     * @param node The node.
+     * @return Is it a leaf?
+     */
+    bool isLeaf( uint32 node ) const;
+
+    /**
+     * Take a node from the free list or add one.
+     * @return The node.
+     */
+    uint32 allocateNode();
+
+    /**
+     * Put a node on the free list.
+     * @param node The node.
+     */
+    void freeNode( uint32 node );
+
+    /**
+     * Set the box of a node to the union of its children's and its height
+     * to one more than the taller one's.
+     * @param node The node.
+     */
+    void updateNode( uint32 node );
+
+    /**
+     * Insert a leaf next to the node that adds the least surface area.
+     * @param leaf The leaf.
+     */
+    void insertLeaf( uint32 leaf );
+
+    /**
+     * Take a leaf out of the tree.
+     * @param leaf The leaf.
+     */
+    void removeLeaf( uint32 leaf );
+
+    /**
+     * Rotate the taller child of a node above it when its children's
+     * heights differ by more than one.
+     * @param node The node.
+     * @return The node now in its place.
+     */
+    uint32 balance( uint32 node );
+
+    /**
+     * Compute the fat box of a proxy.
+     * @param bounds The exact box.
+     * @param displacement How far the box moved.
+     * @param leaf The node to write the box into.
+     */
+    void fatten( const rndr::Bounds& bounds, const glm::vec3& displacement,
+                 Node* leaf ) const;
+
+    /**
+     * Check if a leaf's fat box must change, because a box escaped it or it
+     * has grown too loose.
+     * @param leaf The leaf.
+     * @param bounds The exact box.
+     * @param fat The fat box the leaf would be given now.
+     * @return Must it change?
+     */
+    bool isEscaped( const Node& leaf, const rndr::Bounds& bounds,
+                    const Node& fat ) const;
+
+    /**
+     * Split a run of the boxes being rebuilt.
+     * @param task The run.
+     * @return The index of the first box of the right half.
+     */
+    uint32 split( const BuildTask& task );
+
+    /**
+     * Visit the proxies whose boxes pass a test.
+     * @param test The test, which takes a box's min and max.
+     * @param visit The function called with each proxy.
+     */
+    template <typename Test, typename Visitor>
+    void query( const Test& test, const Visitor& visit ) const;
+
+    /**
+     * Get the surface area of a box.
+     * @param min The box's min.
+     * @param max The box's max.
+     * @return Half the surface area, which is enough to compare boxes.
+     */
+    static float area( const glm::vec3& min, const glm::vec3& max );
+
+    // HIDDEN FUNCTIONS
+    Bvh( const Bvh& other ) = delete;
+
+    Bvh& operator=( const Bvh& other ) = delete;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct an empty tree.
+     * @param margin The distance fat boxes are grown by on every side.
+     */
+    explicit Bvh( float margin = 0.1f );
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the number of proxies.
+     * @return The proxy count.
+     */
+    uint32 proxyCount() const;
+
+    /**
+     * Get the exact box of a proxy.
+     * @param proxy The proxy.
+     * @return The box, whose radius is half its diagonal.
+     */
+    rndr::Bounds bounds( uint32 proxy ) const;
+
+    /**
+     * Get the distance fat boxes are grown by.
+     * @return The margin.
+     */
+    float margin() const;
+
+    /**
+     * Get the height of the tree.
+     * @return The height, which is 0 for a single leaf.
+     */
+    uint32 height() const;
+
+    /**
+     * Get how costly the tree is to query, by the surface area heuristic.
+     * @return The surface area of every node above the leaves over that of
+     * the root.
+     */
+    float cost() const;
+
+    /**
+     * Check if the tree is out of date until the next rebuild.
+     * @return Is it dirty?
+     */
+    bool isDirty() const;
+
+    // MUTATOR FUNCTIONS
+    /**
+     * Set the distance fat boxes are grown by, which applies to boxes as
+     * they next escape.
+     * @param margin The margin, at least 0.
+     */
+    void setMargin( float margin );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Add a box.
+     * @param bounds The box.
+     * @return The proxy.
+     */
+    uint32 createProxy( const rndr::Bounds& bounds );
+
+    /**
+     * Remove a box.
+     * @param proxy The proxy.
+     */
+    void destroyProxy( uint32 proxy );
+
+    /**
+     * Move a box, reinserting it if it escapes its fat box.
+     * @param proxy The proxy.
+     * @param bounds The new box.
+     * @return Did it escape?
+     */
+    bool moveProxy( uint32 proxy, const rndr::Bounds& bounds );
+
+    /**
+     * Move a box, growing its leaf in place if it escapes its fat box.
+     * The tree must be refit before it is next queried.
+     * @param proxy The proxy.
+     * @param bounds The new box.
+     * @return Did it escape?
+     */
+    bool refitProxy( uint32 proxy, const rndr::Bounds& bounds );
+
+    /**
+     * Recompute the boxes above the leaves that were refit.
+     */
+    void refit();
+
+    /**
+     * Stop keeping the tree up to date until the next rebuild.
+     */
+    void invalidate();
+
+    /**
+     * Build the tree again from every box by the surface area heuristic.
+     */
+    void rebuild();
+
+    /**
+     * Rebuild the tree if enough has changed that it may have degraded and
+     * its cost has grown too far past what it was after the last rebuild.
+     * @return Was it rebuilt?
+     */
+    bool rebalance();
+
+    /**
+     * Remove every box.
+     */
+    void clear();
+
+    /**
+     * Visit the proxies whose boxes overlap a box.
+     * @param bounds The box.
+     * @param visit The function called with each proxy.
+     */
+    template <typename Visitor>
+    void queryBox( const rndr::Bounds& bounds, const Visitor& visit ) const;
+
+    /**
+     * Visit the proxies whose boxes overlap a sphere.
+     * @param center The center of the sphere.
+     * @param radius The radius of the sphere.
+     * @param visit The function called with each proxy.
+     */
+    template <typename Visitor>
+    void querySphere( const glm::vec3& center, float radius,
+                      const Visitor& visit ) const;
+
+    /**
+     * Visit the proxies whose boxes are at least partly inside a frustum.
+     * Subtrees entirely inside are visited without further tests.
+     * @param frustum The frustum.
+     * @param visit The function called with each proxy.
+     */
+    template <typename Visitor>
+    void queryFrustum( const rndr::Frustum& frustum,
+                       const Visitor& visit ) const;
+
+    /**
+     * Visit the proxies whose boxes a ray hits, nearer subtrees first.
+     * @param ray The ray.
+     * @param visit The function called with each proxy and the distance to
+     * its box, which returns the farthest distance still of interest: the
+     * distance to stop at the closest hit or the ray's to find every hit.
+     */
+    template <typename Visitor>
+    void raycast( const Ray& ray, const Visitor& visit ) const;
+
+    /**
+     * Find the closest box a ray hits.
+     * @param ray The ray.
+     * @return The hit, whose proxy is NO_PROXY for none.
+     */
+    RayHit raycast( const Ray& ray ) const;
+
+    /**
+     * Find the closest box each of several rays hits.
+     * @param rays The rays.
+     * @param count The number of rays.
+     * @param hits The hits, one for each ray.
+     * @param threadPool The threads to spread the rays across or nullptr
+     * to cast them on the calling thread.
+     */
+    void raycast( const Ray* rays, uint32 count, RayHit* hits,
+                  util::ThreadPool* threadPool ) const;
+
+    /**
+     * Find the proxies whose boxes overlap each of several boxes.
+     * @param boxes The boxes.
+     * @param count The number of boxes.
+     * @param proxies The proxies found, those of each box after those of
+     * the one before.
+     * @param ends The end of each box's proxies.
+     */
+    void queryBoxes( const rndr::Bounds* boxes, uint32 count,
+                     cntr::DynamicArray<uint32>* proxies,
+                     cntr::DynamicArray<uint32>* ends ) const;
+
+    // UTILITY FUNCTIONS
+    /**
+     * Get the distance along a ray to a box.
+     * @param min The box's min.
+     * @param max The box's max.
+     * @param origin The ray's origin.
+     * @param inverse One over each component of the ray's direction.
+     * @param maxDistance The farthest distance that counts.
+     * @return The distance or a negative number for a miss.
+     */
+    static float intersect( const glm::vec3& min, const glm::vec3& max,
+                            const glm::vec3& origin,
+                            const glm::vec3& inverse, float maxDistance );
+};
+
+// HELPER FUNCTIONS
+inline
+bool Bvh::isLeaf( uint32 node ) const
+{
+    return _nodes[node].left == NO_NODE;
+}
+
+template <typename Test, typename Visitor>
+void Bvh::query( const Test& test, const Visitor& visit ) const
+{
+    assert( !_isDirty && !_isRefitNeeded );
+
+    if ( _root == NO_NODE )
+    {
+        return;
+    }
+
+    const Node* nodes = &_nodes[0];
+    const Proxy* proxies = &_proxies[0];
+
+    uint32 stack[MAX_DEPTH];
+    uint32 count = 0;
+    stack[count++] = _root;
+    while ( count > 0 )
+    {
+        const Node& node = nodes[stack[--count]];
+        if ( !test( node.min, node.max ) )
+        {
+            continue;
+        }
+
+        if ( node.left == NO_NODE )
+        {
+            // the fat box may overlap when the exact box does not
+            const Proxy& proxy = proxies[node.right];
+            if ( test( proxy.min, proxy.max ) )
+            {
+                visit( node.right );
+            }
+            continue;
+        }
+
+        assert( count + 2 <= MAX_DEPTH );
+        stack[count++] = node.right;
+        stack[count++] = node.left;
+    }
+}
+
+inline
+float Bvh::area( const glm::vec3& min, const glm::vec3& max )
+{
+    glm::vec3 size = max - min;
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+// CONSTRUCTORS
+inline
+Bvh::Bvh( float margin ) : _nodes(), _parents(), _heights(), _proxies(),
+                           _buildItems(), _refitOrder(), _root( NO_NODE ),
+                           _freeNode( NO_NODE ), _freeProxy( NO_PROXY ),
+                           _proxyCount( 0 ), _margin( margin ),
+                           _buildCost( 0.0f ), _changeCount( 0 ),
+                           _isDirty( false ), _isRefitNeeded( false )
+{
+}
+
+// ACCESSOR FUNCTIONS
+inline
+uint32 Bvh::proxyCount() const
+{
+    return _proxyCount;
+}
+
+inline
+rndr::Bounds Bvh::bounds( uint32 proxy ) const
+{
+    const Proxy& p = _proxies[proxy];
+    return rndr::Bounds( p.min, p.max, glm::length( p.max - p.min ) * 0.5f );
+}
+
+inline
+float Bvh::margin() const
+{
+    return _margin;
+}
+
+inline
+uint32 Bvh::height() const
+{
+    return _root == NO_NODE ? 0 : _heights[_root];
+}
+
+inline
+bool Bvh::isDirty() const
+{
+    return _isDirty;
+}
+
+// MUTATOR FUNCTIONS
+inline
+void Bvh::setMargin( float margin )
+{
+    assert( margin >= 0.0f );
+    _margin = margin;
+}
+
+// MEMBER FUNCTIONS
+template <typename Visitor>
+void Bvh::queryBox( const rndr::Bounds& bounds, const Visitor& visit ) const
+{
+    const glm::vec3& min = bounds.min();
+    const glm::vec3& max = bounds.max();
+    query( [&]( const glm::vec3& boxMin, const glm::vec3& boxMax ) {
+        return boxMin.x <= max.x && boxMax.x >= min.x &&
+               boxMin.y <= max.y && boxMax.y >= min.y &&
+               boxMin.z <= max.z && boxMax.z >= min.z;
+    }, visit );
+}
+
+template <typename Visitor>
+void Bvh::querySphere( const glm::vec3& center, float radius,
+                       const Visitor& visit ) const
+{
+    float radiusSquared = radius * radius;
+    query( [&]( const glm::vec3& boxMin, const glm::vec3& boxMax ) {
+        glm::vec3 offset = glm::clamp( center, boxMin, boxMax ) - center;
+        return glm::dot( offset, offset ) <= radiusSquared;
+    }, visit );
+}
+
+template <typename Visitor>
+void Bvh::queryFrustum( const rndr::Frustum& frustum,
+                        const Visitor& visit ) const
+{
+    assert( !_isDirty && !_isRefitNeeded );
+
+    if ( _root == NO_NODE )
+    {
+        return;
+    }
+
+    const uint32 ALL_PLANES = ( 1 << rndr::Frustum::PLANE_COUNT ) - 1;
+
+    const Node* nodes = &_nodes[0];
+    const Proxy* proxies = &_proxies[0];
+
+    // each entry carries the planes its parent was not entirely inside, so
+    // deeper nodes only test the planes that can still cut them
+    uint32 stack[MAX_DEPTH];
+    uint32 masks[MAX_DEPTH];
+    uint32 count = 0;
+    stack[count] = _root;
+    masks[count++] = ALL_PLANES;
+    while ( count > 0 )
+    {
+        --count;
+        const Node& node = nodes[stack[count]];
+        uint32 mask = masks[count];
+
+        bool isOutside = false;
+        glm::vec3 center = ( node.min + node.max ) * 0.5f;
+        glm::vec3 extents = ( node.max - node.min ) * 0.5f;
+        for ( uint32 i = 0; i < rndr::Frustum::PLANE_COUNT; ++i )
+        {
+            if ( ( mask & ( 1 << i ) ) == 0 )
+            {
+                continue;
+            }
+
+            const glm::vec4& plane = frustum.plane( i );
+            float distance = plane.x * center.x + plane.y * center.y +
+                             plane.z * center.z + plane.w;
+            float reach = std::abs( plane.x ) * extents.x +
+                          std::abs( plane.y ) * extents.y +
+                          std::abs( plane.z ) * extents.z;
+            if ( distance + reach < 0.0f )
+            {
+                isOutside = true;
+                break;
+            }
+
+            if ( distance - reach >= 0.0f )
+            {
+                mask &= ~( 1 << i );
+            }
+        }
+
+        if ( isOutside )
+        {
+            continue;
+        }
+
+        if ( node.left == NO_NODE )
+        {
+            // a fat box that is cut by a plane may hold an exact box that
+            // is outside it
+            if ( mask == 0 || frustum.intersects(
+                     rndr::Bounds( proxies[node.right].min,
+                                   proxies[node.right].max, 0.0f ) ) )
+            {
+                visit( node.right );
+            }
+            continue;
+        }
+
+        assert( count + 2 <= MAX_DEPTH );
+        stack[count] = node.right;
+        masks[count++] = mask;
+        stack[count] = node.left;
+        masks[count++] = mask;
+    }
+}
+
+template <typename Visitor>
+void Bvh::raycast( const Ray& ray, const Visitor& visit ) const
+{
+    assert( !_isDirty && !_isRefitNeeded );
+
+    if ( _root == NO_NODE )
+    {
+        return;
+    }
+
+    const Node* nodes = &_nodes[0];
+    const Proxy* proxies = &_proxies[0];
+
+    glm::vec3 inverse( 1.0f / ray.direction.x, 1.0f / ray.direction.y,
+                       1.0f / ray.direction.z );
+    float maxDistance = ray.maxDistance;
+
+    uint32 stack[MAX_DEPTH];
+    float distances[MAX_DEPTH];
+    uint32 count = 0;
+    stack[count] = _root;
+    distances[count++] = intersect( nodes[_root].min, nodes[_root].max,
+                                    ray.origin, inverse, maxDistance );
+    while ( count > 0 )
+    {
+        --count;
+
+        // the nodes were hit when pushed, but a closer hit since may have
+        // put them out of reach
+        if ( distances[count] < 0.0f || distances[count] > maxDistance )
+        {
+            continue;
+        }
+
+        const Node& node = nodes[stack[count]];
+        if ( node.left == NO_NODE )
+        {
+            const Proxy& proxy = proxies[node.right];
+            float distance = intersect( proxy.min, proxy.max, ray.origin,
+                                        inverse, maxDistance );
+            if ( distance >= 0.0f )
+            {
+                maxDistance = visit( node.right, distance );
+            }
+            continue;
+        }
+
+        // the nearer child is popped first
+        const Node& left = nodes[node.left];
+        const Node& right = nodes[node.right];
+        float leftDistance = intersect( left.min, left.max, ray.origin,
+                                        inverse, maxDistance );
+        float rightDistance = intersect( right.min, right.max, ray.origin,
+                                         inverse, maxDistance );
+        bool isLeftFirst = leftDistance >= 0.0f &&
+                           ( rightDistance < 0.0f ||
+                             leftDistance <= rightDistance );
+
+        assert( count + 2 <= MAX_DEPTH );
+        stack[count] = isLeftFirst ? node.right : node.left;
+        distances[count++] = isLeftFirst ? rightDistance : leftDistance;
+        stack[count] = isLeftFirst ? node.left : node.right;
+        distances[count++] = isLeftFirst ? leftDistance : rightDistance;
+    }
+}
+
+} // End nspc obj
+
+} // End nspc demo
+
+#endif // DEMO_BVH_H
@@ -1,6 +1,8 @@
 // camera.cpp
 #include "camera.h"
 
+#include <glm/gtc/matrix_transform.hpp>
+
 namespace demo
 {
 
@@ -16,6 +18,23 @@ Camera& Camera::operator=( const Camera& other )
     return *this;
 }
 
+// ACCESSOR FUNCTIONS
+glm::mat4 Camera::view() const
+{
+    return glm::inverse( transform().matrix() );
+}
+
+glm::mat4 Camera::projection( float aspectRatio ) const
+{
+    return glm::perspective( glm::radians( _fieldOfView ), aspectRatio,
+                             _nearPlane, _farPlane );
+}
+
+rndr::Frustum Camera::frustum( float aspectRatio ) const
+{
+    return rndr::Frustum( projection( aspectRatio ) * view() );
+}
+
 } // End nspc obj
 
 } // End nspc demo
\ No newline at end of file
@@ -2,10 +2,17 @@
 //
 // A camera that can be used to render a scene.
 //
+// The camera looks down its transform's negative z axis. Its view is the
+// inverse of its transform, and its projection is a perspective one whose
+// aspect ratio is given by the render target it draws to.
+//
 #ifndef DEMO_CAMERA_H
 #define DEMO_CAMERA_H
 
+#include <glm/glm.hpp>
+
 #include "demo/object/object.h"
+#include "demo/render/frustum.h"
 
 namespace demo
 {
@@ -77,6 +84,26 @@ class Camera : public Object
      */
     float farPlane() const;
 
+    /**
+     * Get the matrix from world space to the camera's space.
+     * @return The view matrix.
+     */
+    glm::mat4 view() const;
+
+    /**
+     * Get the matrix from the camera's space to clip space.
+     * @param aspectRatio The width of the render target over its height.
+     * @return The projection matrix.
+     */
+    glm::mat4 projection( float aspectRatio ) const;
+
+    /**
+     * Get the volume the camera sees in world space.
+     * @param aspectRatio The width of the render target over its height.
+     * @return The frustum.
+     */
+    rndr::Frustum frustum( float aspectRatio ) const;
+
     // MUTATOR FUNCTIONS
     /**
      * Set the field of view.
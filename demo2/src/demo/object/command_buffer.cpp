@@ -0,0 +1,148 @@
+// command_buffer.cpp
+#include "command_buffer.h"
+
+#include <stdint.h>
+
+namespace demo
+{
+
+namespace obj
+{
+
+// CONSTANTS
+constexpr uint32 CommandBuffer::PENDING_GENERATION;
+constexpr uint32 CommandBuffer::BLOCK_SIZE;
+
+// HELPER FUNCTIONS
+void* CommandBuffer::allocate( uint32 size, uint32 alignment )
+{
+    assert( size + alignment <= BLOCK_SIZE );
+
+    while ( true )
+    {
+        if ( _block == _blocks.size() )
+        {
+            _blocks.push( new uint8[BLOCK_SIZE] );
+        }
+
+        uintptr_t start = reinterpret_cast<uintptr_t>( _blocks[_block] );
+        uintptr_t address = ( start + _blockUsed + alignment - 1 ) &
+                            ~static_cast<uintptr_t>( alignment - 1 );
+        uint32 end = static_cast<uint32>( address - start ) + size;
+        if ( end <= BLOCK_SIZE )
+        {
+            _blockUsed = end;
+            return reinterpret_cast<void*>( address );
+        }
+
+        ++_block;
+        _blockUsed = 0;
+    }
+}
+
+Entity CommandBuffer::resolve( Entity entity ) const
+{
+    if ( entity.generation() == PENDING_GENERATION )
+    {
+        assert( entity.index() < _created.size() );
+        return _created[entity.index()];
+    }
+
+    return entity;
+}
+
+void CommandBuffer::discard()
+{
+    for ( uint32 i = 0; i < _commands.size(); ++i )
+    {
+        const Command& command = _commands[i];
+        if ( command.type == CommandType::ADD && command.value != nullptr )
+        {
+            ComponentType::info( command.componentType ).destruct(
+                command.value );
+        }
+    }
+
+    _commands.clear();
+    _created.clear();
+    _block = 0;
+    _blockUsed = 0;
+    _createCount = 0;
+}
+
+// CONSTRUCTORS
+CommandBuffer::CommandBuffer()
+    : _commands(), _created(), _blocks(), _block( 0 ), _blockUsed( 0 ),
+      _createCount( 0 )
+{
+}
+
+CommandBuffer::~CommandBuffer()
+{
+    discard();
+
+    for ( uint32 i = 0; i < _blocks.size(); ++i )
+    {
+        delete[] _blocks[i];
+    }
+}
+
+// MEMBER FUNCTIONS
+void CommandBuffer::flush( EntityRegistry* registry )
+{
+    assert( !registry->isLocked() );
+
+    for ( uint32 i = 0; i < _commands.size(); ++i )
+    {
+        Command& command = _commands[i];
+        if ( command.type == CommandType::CREATE )
+        {
+            _created.push( registry->create() );
+            continue;
+        }
+
+        Entity entity = resolve( command.entity );
+        if ( !registry->isAlive( entity ) )
+        {
+            continue;
+        }
+
+        switch ( command.type )
+        {
+            case CommandType::DESTROY:
+                registry->destroy( entity );
+                break;
+
+            case CommandType::ADD:
+                if ( command.value == nullptr )
+                {
+                    ComponentType::info( command.componentType ).construct(
+                        registry->addComponent( entity,
+                                                command.componentType ) );
+                    break;
+                }
+
+                ComponentType::info( command.componentType ).move(
+                    registry->addComponent( entity, command.componentType ),
+                    command.value );
+
+                // the value now belongs to the registry
+                command.value = nullptr;
+                break;
+
+            case CommandType::REMOVE:
+                registry->removeComponent( entity, command.componentType );
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    // only the values of dropped commands are left to destruct
+    discard();
+}
+
+} // End nspc obj
+
+} // End nspc demo
@@ -0,0 +1,264 @@
+// command_buffer.h
+//
+// Records changes to the entities of a registry to be made later.
+//
+// The archetypes of a registry must not change while a query runs, so
+// entities that are created or destroyed and components that are added or
+// removed during one are recorded here and flushed into the registry once the
+// query is done. Commands are played back in the order they were recorded.
+//
+// Entities created through a buffer do not exist until it is flushed. The
+// handle returned stands in for the entity in later commands of the same
+// buffer and is replaced by the real one when they are played back.
+// Commands for entities that have been destroyed by the time of the flush
+// are dropped.
+//
+// Added components are moved into blocks owned by the buffer, which are kept
+// for reuse after a flush. A buffer is used from one thread, so a query
+// spread across a thread pool records into a buffer per thread.
+//
+// A component added without a value is only recorded by type and is default
+// constructed when the buffer is flushed, on the thread that flushes it.
+// Components whose construction is not thread safe are added this way from
+// workers. Transforms are one: constructing one takes a slot in the transform
+// system, which only the main thread may do, so they cannot be added with a
+// value at all.
+//
+#ifndef DEMO_COMMAND_BUFFER_H
+#define DEMO_COMMAND_BUFFER_H
+
+#include <assert.h>
+
+#include <new>
+#include <utility>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/intdef.h"
+#include "demo/object/component_type.h"
+#include "demo/object/entity.h"
+#include "demo/object/entity_registry.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+class Transform;
+
+class CommandBuffer
+{
+  public:
+    // CONSTANTS
+    /**
+     * The generation of the handles that stand in for entities created
+     * through a buffer, which no entity in a registry has.
+     */
+    static constexpr uint32 PENDING_GENERATION =
+        EntityRegistry::MAX_GENERATION + 1;
+
+  private:
+    // TYPES
+    /**
+     * The kind of a command.
+     */
+    enum class CommandType : uint8
+    {
+        CREATE,
+        DESTROY,
+        ADD,
+        REMOVE
+    };
+
+    /**
+     * A recorded change.
+     */
+    struct Command
+    {
+        CommandType type;
+        uint32 componentType;
+        Entity entity;
+        void* value;
+    };
+
+    // CONSTANTS
+    /**
+     * The size of a block of component values.
+     */
+    static constexpr uint32 BLOCK_SIZE = 16 * 1024;
+
+    // MEMBERS
+    /**
+     * The commands in the order they were recorded.
+     */
+    cntr::DynamicArray<Command> _commands;
+
+    /**
+     * The entities created so far during a flush.
+     */
+    cntr::DynamicArray<Entity> _created;
+
+    /**
+     * The blocks holding the values of added components.
+     */
+    cntr::DynamicArray<uint8*> _blocks;
+
+    /**
+     * The block values are allocated from.
+     */
+    uint32 _block;
+
+    /**
+     * The bytes used in the current block.
+     */
+    uint32 _blockUsed;
+
+    /**
+     * The number of entities created since the last flush.
+     */
+    uint32 _createCount;
+
+    // HELPER FUNCTIONS
+    /**
+     * Allocate memory for a component value.
+     * @param size The size in bytes.
+     * @param alignment The alignment in bytes.
+     * @return The memory.
+     */
+    void* allocate( uint32 size, uint32 alignment );
+
+    /**
+     * Get the entity a handle refers to during a flush.
+     * @param entity The handle.
+     * @return The entity.
+     */
+    Entity resolve( Entity entity ) const;
+
+    /**
+     * Destruct the values of the unflushed commands and forget them.
+     */
+    void discard();
+
+    // HIDDEN FUNCTIONS
+    CommandBuffer( const CommandBuffer& other ) = delete;
+
+    CommandBuffer& operator=( const CommandBuffer& other ) = delete;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct an empty command buffer.
+     */
+    CommandBuffer();
+
+    /**
+     * Destruct the command buffer, dropping any unflushed commands.
+     */
+    ~CommandBuffer();
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Check if there are no commands to flush.
+     * @return Is it empty?
+     */
+    bool isEmpty() const;
+
+    // MEMBER FUNCTIONS
+    /**
+     * Record the creation of an entity with no components.
+     * @return The handle that stands in for the entity.
+     */
+    Entity create();
+
+    /**
+     * Record the destruction of an entity.
+     * @param entity The entity.
+     */
+    void destroy( Entity entity );
+
+    /**
+     * Record adding a default constructed component to an entity.
+     * The component is constructed during the flush.
+     * @param entity The entity.
+     */
+    template <typename T>
+    void add( Entity entity );
+
+    /**
+     * Record adding a component to an entity.
+     * @param entity The entity.
+     * @param value The component.
+     */
+    template <typename T>
+    void add( Entity entity, T value );
+
+    /**
+     * Record removing a component from an entity.
+     * @param entity The entity.
+     */
+    template <typename T>
+    void remove( Entity entity );
+
+    /**
+     * Make the recorded changes to a registry and clear the buffer.
+     * @param registry The registry, which must not have a query running.
+     */
+    void flush( EntityRegistry* registry );
+};
+
+// ACCESSOR FUNCTIONS
+inline
+bool CommandBuffer::isEmpty() const
+{
+    return _commands.size() == 0;
+}
+
+// MEMBER FUNCTIONS
+inline
+Entity CommandBuffer::create()
+{
+    _commands.push( Command{ CommandType::CREATE, 0, Entity(), nullptr } );
+    return Entity( _createCount++, PENDING_GENERATION );
+}
+
+inline
+void CommandBuffer::destroy( Entity entity )
+{
+    _commands.push( Command{ CommandType::DESTROY, 0, entity, nullptr } );
+}
+
+template <typename T>
+inline
+void CommandBuffer::add( Entity entity )
+{
+    _commands.push( Command{ CommandType::ADD, ComponentType::id<T>(), entity,
+                             nullptr } );
+}
+
+template <typename T>
+inline
+void CommandBuffer::add( Entity entity, T value )
+{
+    void* memory = allocate( sizeof( T ), alignof( T ) );
+    new ( memory ) T( std::move( value ) );
+    _commands.push( Command{ CommandType::ADD, ComponentType::id<T>(), entity,
+                             memory } );
+}
+
+template <typename T>
+inline
+void CommandBuffer::remove( Entity entity )
+{
+    _commands.push( Command{ CommandType::REMOVE, ComponentType::id<T>(),
+                             entity, nullptr } );
+}
+
+// transforms take their slot when the buffer is flushed
+template <>
+void CommandBuffer::add<Transform>( Entity entity, Transform value ) = delete;
+
+} // End nspc obj
+
+} // End nspc demo
+
+#endif // DEMO_COMMAND_BUFFER_H
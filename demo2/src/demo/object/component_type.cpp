@@ -0,0 +1,32 @@
+// component_type.cpp
+#include "component_type.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+// CONSTANTS
+constexpr uint32 ComponentType::MAX_TYPES;
+
+// GLOBALS
+ComponentType::Info ComponentType::g_infos[MAX_TYPES];
+
+std::atomic<uint32> ComponentType::g_count( 0 );
+
+// HELPER FUNCTIONS
+uint32 ComponentType::registerType( const Info& info )
+{
+    // ids are only given out from the guarded initialization in id, so the
+    // description is written before any other thread can see the id
+    uint32 id = g_count.fetch_add( 1 );
+    assert( id < MAX_TYPES );
+
+    g_infos[id] = info;
+    return id;
+}
+
+} // End nspc obj
+
+} // End nspc demo
@@ -0,0 +1,208 @@
+// component_type.h
+//
+// Run-time descriptions of the component types stored in entity registries.
+//
+// Each type that is used as a component is given a small id the first time
+// it is seen. The id indexes a table holding the size and alignment of the
+// type along with functions to construct, move, and destruct instances in
+// raw memory, which is all the archetype chunks need to store the type
+// without knowing it. A set of component types is a bit mask over the ids.
+//
+// Components must be default constructible and movable.
+//
+#ifndef DEMO_COMPONENT_TYPE_H
+#define DEMO_COMPONENT_TYPE_H
+
+#include <assert.h>
+
+#include <atomic>
+#include <new>
+#include <utility>
+
+#include "demo/intdef.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+/**
+ * A set of component types with a bit per type id.
+ */
+typedef uint64 ComponentMask;
+
+class ComponentType
+{
+  public:
+    // CONSTANTS
+    /**
+     * The most component types there may be.
+     */
+    static constexpr uint32 MAX_TYPES = 64;
+
+    // TYPES
+    /**
+     * Default constructs an instance in raw memory.
+     */
+    typedef void ( *ConstructFn )( void* pointer );
+
+    /**
+     * Constructs an instance in raw memory by moving from another, which is
+     * then destructed.
+     */
+    typedef void ( *MoveFn )( void* destination, void* source );
+
+    /**
+     * Destructs an instance, leaving raw memory.
+     */
+    typedef void ( *DestructFn )( void* pointer );
+
+    /**
+     * The description of a component type.
+     */
+    struct Info
+    {
+        uint32 size;
+        uint32 alignment;
+        ConstructFn construct;
+        MoveFn move;
+        DestructFn destruct;
+    };
+
+  private:
+    // GLOBALS
+    /**
+     * The description of each type id.
+     */
+    static Info g_infos[MAX_TYPES];
+
+    /**
+     * The number of type ids given out.
+     */
+    static std::atomic<uint32> g_count;
+
+    // HELPER FUNCTIONS
+    /**
+     * Give out the next type id.
+     * @param info The description of the type.
+     * @return The type id.
+     */
+    static uint32 registerType( const Info& info );
+
+    /**
+     * Default construct an instance in raw memory.
+     * @param pointer The memory.
+     */
+    template <typename T>
+    static void constructInstance( void* pointer );
+
+    /**
+     * Move an instance into raw memory and destruct the original.
+     * @param destination The memory.
+     * @param source The instance.
+     */
+    template <typename T>
+    static void moveInstance( void* destination, void* source );
+
+    /**
+     * Destruct an instance.
+     * @param pointer The instance.
+     */
+    template <typename T>
+    static void destructInstance( void* pointer );
+
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Get the id of a component type, registering it on first use.
+     * @return The type id.
+     */
+    template <typename T>
+    static uint32 id();
+
+    /**
+     * Get the mask holding only a component type.
+     * @return The mask.
+     */
+    template <typename T>
+    static ComponentMask mask();
+
+    /**
+     * Get the description of a type id.
+     * @param id The type id.
+     * @return The description.
+     */
+    static const Info& info( uint32 id );
+
+    /**
+     * Get the mask holding only a type id.
+     * @param id The type id.
+     * @return The mask.
+     */
+    static ComponentMask maskOf( uint32 id );
+};
+
+// HELPER FUNCTIONS
+template <typename T>
+inline
+void ComponentType::constructInstance( void* pointer )
+{
+    new ( pointer ) T();
+}
+
+template <typename T>
+inline
+void ComponentType::moveInstance( void* destination, void* source )
+{
+    T* instance = static_cast<T*>( source );
+    new ( destination ) T( std::move( *instance ) );
+    instance->~T();
+}
+
+template <typename T>
+inline
+void ComponentType::destructInstance( void* pointer )
+{
+    static_cast<T*>( pointer )->~T();
+}
+
+// UTILITY FUNCTIONS
+template <typename T>
+inline
+uint32 ComponentType::id()
+{
+    static const uint32 typeId = registerType( Info{
+        static_cast<uint32>( sizeof( T ) ),
+        static_cast<uint32>( alignof( T ) ),
+        &constructInstance<T>,
+        &moveInstance<T>,
+        &destructInstance<T> } );
+    return typeId;
+}
+
+template <typename T>
+inline
+ComponentMask ComponentType::mask()
+{
+    return maskOf( id<T>() );
+}
+
+inline
+const ComponentType::Info& ComponentType::info( uint32 id )
+{
+    assert( id < g_count.load( std::memory_order_relaxed ) );
+    return g_infos[id];
+}
+
+inline
+ComponentMask ComponentType::maskOf( uint32 id )
+{
+    return static_cast<ComponentMask>( 1 ) << id;
+}
+
+} // End nspc obj
+
+} // End nspc demo
+
+#endif // DEMO_COMPONENT_TYPE_H
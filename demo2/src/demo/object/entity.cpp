@@ -0,0 +1,15 @@
+// entity.cpp
+#include "entity.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+// CONSTANTS
+constexpr uint32 Entity::NULL_INDEX;
+
+} // End nspc obj
+
+} // End nspc demo
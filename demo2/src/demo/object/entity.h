@@ -0,0 +1,137 @@
+// entity.h
+//
+// A handle to an entity in an entity registry.
+//
+// An entity is an index into the registry together with the generation of
+// that index. Destroying an entity advances the generation, so handles to it
+// are recognized as dead even once the index has been reused.
+//
+#ifndef DEMO_ENTITY_H
+#define DEMO_ENTITY_H
+
+#include "demo/intdef.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+class Entity
+{
+  private:
+    // MEMBERS
+    /**
+     * The index in the registry.
+     */
+    uint32 _index;
+
+    /**
+     * The generation of the index.
+     */
+    uint32 _generation;
+
+  public:
+    // CONSTANTS
+    /**
+     * The index of the null entity.
+     */
+    static constexpr uint32 NULL_INDEX = 0xFFFFFFFF;
+
+    // CONSTRUCTORS
+    /**
+     * Construct the null entity.
+     */
+    Entity();
+
+    /**
+     * Construct an entity handle.
+     * @param index The index in the registry.
+     * @param generation The generation of the index.
+     */
+    Entity( uint32 index, uint32 generation );
+
+    // OPERATORS
+    /**
+     * Check if two handles refer to the same entity.
+     * @param other The other handle.
+     * @return Are they the same?
+     */
+    bool operator==( const Entity& other ) const;
+
+    /**
+     * Check if two handles refer to different entities.
+     * @param other The other handle.
+     * @return Are they different?
+     */
+    bool operator!=( const Entity& other ) const;
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the index in the registry.
+     * @return The index.
+     */
+    uint32 index() const;
+
+    /**
+     * Get the generation of the index.
+     * @return The generation.
+     */
+    uint32 generation() const;
+
+    /**
+     * Check if this is the null entity.
+     * @return Is it null?
+     */
+    bool isNull() const;
+};
+
+// CONSTRUCTORS
+inline
+Entity::Entity() : _index( NULL_INDEX ), _generation( 0 )
+{
+}
+
+inline
+Entity::Entity( uint32 index, uint32 generation )
+    : _index( index ), _generation( generation )
+{
+}
+
+// OPERATORS
+inline
+bool Entity::operator==( const Entity& other ) const
+{
+    return _index == other._index && _generation == other._generation;
+}
+
+inline
+bool Entity::operator!=( const Entity& other ) const
+{
+    return !( *this == other );
+}
+
+// ACCESSOR FUNCTIONS
+inline
+uint32 Entity::index() const
+{
+    return _index;
+}
+
+inline
+uint32 Entity::generation() const
+{
+    return _generation;
+}
+
+inline
+bool Entity::isNull() const
+{
+    return _index == NULL_INDEX;
+}
+
+} // End nspc obj
+
+} // End nspc demo
+
+#endif // DEMO_ENTITY_H
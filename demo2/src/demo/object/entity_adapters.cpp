@@ -0,0 +1,48 @@
+// entity_adapters.cpp
+#include "entity_adapters.h"
+
+#include <assert.h>
+
+namespace demo
+{
+
+namespace obj
+{
+
+// UTILITY FUNCTIONS
+Entity EntityAdapters::createModel( EntityRegistry* registry,
+                                    const ModelObject& object )
+{
+    Entity entity = registry->create();
+    registry->add<Transform>( entity, object.transform() );
+    registry->add<ModelComponent>( entity,
+                                   ModelComponent{ object.model() } );
+    return entity;
+}
+
+Entity EntityAdapters::createCamera( EntityRegistry* registry,
+                                     const Camera& camera )
+{
+    Entity entity = registry->create();
+    registry->add<Transform>( entity, camera.transform() );
+    registry->add<CameraComponent>( entity, CameraComponent{
+        camera.fieldOfView(), camera.nearPlane(), camera.farPlane() } );
+    return entity;
+}
+
+void EntityAdapters::applyCamera( const EntityRegistry& registry,
+                                  Entity entity, Camera* camera )
+{
+    const Transform* transform = registry.get<Transform>( entity );
+    const CameraComponent* lens = registry.get<CameraComponent>( entity );
+    assert( transform != nullptr && lens != nullptr );
+
+    camera->setTransform( *transform );
+    camera->setFieldOfView( lens->fieldOfView );
+    camera->setNearPlane( lens->nearPlane );
+    camera->setFarPlane( lens->farPlane );
+}
+
+} // End nspc obj
+
+} // End nspc demo
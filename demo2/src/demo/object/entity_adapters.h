@@ -0,0 +1,82 @@
+// entity_adapters.h
+//
+// Components that let models and cameras live in an entity registry, and
+// functions that turn objects into entities.
+//
+// A transform is a component as it is: it is a handle into the transform
+// system, so the world matrices of entities are updated along with those of
+// objects when the scene updates its transforms. Models are shared and owned
+// by the resource manager, so a model component only refers to one.
+//
+#ifndef DEMO_ENTITY_ADAPTERS_H
+#define DEMO_ENTITY_ADAPTERS_H
+
+#include "demo/object/camera.h"
+#include "demo/object/entity.h"
+#include "demo/object/entity_registry.h"
+#include "demo/object/model_object.h"
+#include "demo/object/transform.h"
+#include "demo/render/model.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+/**
+ * A model to render at the entity's transform.
+ */
+struct ModelComponent
+{
+    rndr::ModelPtr model;
+};
+
+/**
+ * The lens of a camera at the entity's transform.
+ */
+struct CameraComponent
+{
+    float fieldOfView;
+    float nearPlane;
+    float farPlane;
+};
+
+class EntityAdapters
+{
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Create an entity with the transform and model of an object.
+     * @param registry The registry.
+     * @param object The object.
+     * @return The entity.
+     */
+    static Entity createModel( EntityRegistry* registry,
+                               const ModelObject& object );
+
+    /**
+     * Create an entity with the transform and lens of a camera.
+     * @param registry The registry.
+     * @param camera The camera.
+     * @return The entity.
+     */
+    static Entity createCamera( EntityRegistry* registry,
+                                const Camera& camera );
+
+    /**
+     * Copy the transform and lens of an entity to a camera.
+     * @param registry The registry.
+     * @param entity The entity, which must have a transform and a camera
+     * component.
+     * @param camera The camera.
+     */
+    static void applyCamera( const EntityRegistry& registry, Entity entity,
+                             Camera* camera );
+};
+
+} // End nspc obj
+
+} // End nspc demo
+
+#endif // DEMO_ENTITY_ADAPTERS_H
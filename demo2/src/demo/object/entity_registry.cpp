@@ -0,0 +1,181 @@
+// entity_registry.cpp
+#include "entity_registry.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+// CONSTANTS
+constexpr uint32 EntityRegistry::MAX_GENERATION;
+constexpr uint32 EntityRegistry::NO_ARCHETYPE;
+
+// HELPER FUNCTIONS
+uint32 EntityRegistry::findArchetype( ComponentMask mask )
+{
+    if ( _archetypeIndices.has( mask ) )
+    {
+        return _archetypeIndices[mask];
+    }
+
+    uint32 index = _archetypes.size();
+    _archetypes.push( new Archetype( mask ) );
+    _archetypeIndices.put( mask, index );
+    for ( uint32 type = 0; type < ComponentType::MAX_TYPES; ++type )
+    {
+        _edges.push( NO_ARCHETYPE );
+    }
+
+    return index;
+}
+
+uint32 EntityRegistry::toggleArchetype( uint32 archetype, uint32 type )
+{
+    // entities tend to gain their components one at a time in the same
+    // order, so the same few steps are taken over and over
+    uint32 edge = archetype * ComponentType::MAX_TYPES + type;
+    if ( _edges[edge] == NO_ARCHETYPE )
+    {
+        // finding the archetype may grow the edges, so look it up first
+        ComponentMask mask = _archetypes[archetype]->mask() ^
+                             ComponentType::maskOf( type );
+        uint32 target = findArchetype( mask );
+        _edges[edge] = target;
+    }
+
+    return _edges[edge];
+}
+
+void EntityRegistry::moveEntity( Entity entity, uint32 target )
+{
+    Location& location = _locations[entity.index()];
+    Archetype* source = _archetypes[location.archetype];
+    Archetype* destination = _archetypes[target];
+
+    uint32 row = destination->allocate( entity );
+    for ( uint32 i = 0; i < source->columnCount(); ++i )
+    {
+        const ComponentType::Info& info =
+            ComponentType::info( source->type( i ) );
+        void* component = source->component( location.row, i );
+
+        uint32 column = destination->column( source->type( i ) );
+        if ( column != Archetype::NO_COLUMN )
+        {
+            info.move( destination->component( row, column ), component );
+        }
+        else
+        {
+            info.destruct( component );
+        }
+    }
+
+    Entity moved = source->release( location.row );
+    if ( !moved.isNull() )
+    {
+        _locations[moved.index()].row = location.row;
+    }
+
+    location.archetype = target;
+    location.row = row;
+}
+
+// CONSTRUCTORS
+EntityRegistry::EntityRegistry()
+    : _archetypes(), _archetypeIndices(), _edges(), _locations(),
+      _generations(), _freeIndices(), _lockCount( 0 )
+{
+    // entities without components live in the first archetype
+    findArchetype( 0 );
+}
+
+EntityRegistry::~EntityRegistry()
+{
+    assert( _lockCount == 0 );
+
+    for ( uint32 i = 0; i < _archetypes.size(); ++i )
+    {
+        delete _archetypes[i];
+    }
+}
+
+// MEMBER FUNCTIONS
+Entity EntityRegistry::create()
+{
+    assert( _lockCount == 0 );
+
+    uint32 index;
+    if ( _freeIndices.size() > 0 )
+    {
+        index = _freeIndices.pop();
+    }
+    else
+    {
+        index = _generations.size();
+        _generations.push( 0 );
+        _locations.push( Location{ 0, 0 } );
+    }
+
+    Entity entity( index, _generations[index] );
+    _locations[index] = Location{ 0, _archetypes[0]->allocate( entity ) };
+    return entity;
+}
+
+void EntityRegistry::destroy( Entity entity )
+{
+    assert( _lockCount == 0 );
+    assert( isAlive( entity ) );
+
+    const Location& location = _locations[entity.index()];
+    Archetype* archetype = _archetypes[location.archetype];
+    archetype->destruct( location.row );
+
+    Entity moved = archetype->release( location.row );
+    if ( !moved.isNull() )
+    {
+        _locations[moved.index()].row = location.row;
+    }
+
+    uint32& generation = _generations[entity.index()];
+    generation = generation == MAX_GENERATION ? 0 : generation + 1;
+    _freeIndices.push( entity.index() );
+}
+
+void* EntityRegistry::addComponent( Entity entity, uint32 type )
+{
+    assert( _lockCount == 0 );
+    assert( isAlive( entity ) );
+
+    const Location& location = _locations[entity.index()];
+    Archetype* archetype = _archetypes[location.archetype];
+    uint32 column = archetype->column( type );
+    if ( column != Archetype::NO_COLUMN )
+    {
+        void* component = archetype->component( location.row, column );
+        ComponentType::info( type ).destruct( component );
+        return component;
+    }
+
+    moveEntity( entity, toggleArchetype( location.archetype, type ) );
+
+    archetype = _archetypes[location.archetype];
+    return archetype->component( location.row, archetype->column( type ) );
+}
+
+void EntityRegistry::removeComponent( Entity entity, uint32 type )
+{
+    assert( _lockCount == 0 );
+    assert( isAlive( entity ) );
+
+    const Location& location = _locations[entity.index()];
+    if ( _archetypes[location.archetype]->column( type ) !=
+         Archetype::NO_COLUMN )
+    {
+        moveEntity( entity, toggleArchetype( location.archetype, type ) );
+    }
+}
+
+} // End nspc obj
+
+} // End nspc demo
@@ -0,0 +1,363 @@
+// entity_registry.h
+//
+// Stores entities and their components grouped by archetype.
+//
+// Every entity belongs to the archetype of its exact set of component types,
+// so entities that share a set are packed together in the same chunks. Adding
+// or removing a component moves the entity to the archetype of its new set.
+// Handles stay valid across moves since they are resolved through a table of
+// locations indexed by the entity.
+//
+// Entities are iterated with queries. While a query runs the archetypes must
+// not change, so creating and destroying entities and adding and removing
+// components is not allowed until it is done; changes found during a query
+// are recorded in a command buffer and flushed afterwards.
+//
+// The registry is used from one thread. Queries may spread the chunks they
+// visit across a thread pool, but only read and write components.
+//
+#ifndef DEMO_ENTITY_REGISTRY_H
+#define DEMO_ENTITY_REGISTRY_H
+
+#include <assert.h>
+
+#include <new>
+#include <utility>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/container/map.h"
+#include "demo/intdef.h"
+#include "demo/object/archetype.h"
+#include "demo/object/component_type.h"
+#include "demo/object/entity.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+template <typename... Ts>
+class Query;
+
+class EntityRegistry
+{
+  public:
+    // CONSTANTS
+    /**
+     * The highest generation of an entity; the generation starts over after
+     * it.
+     */
+    static constexpr uint32 MAX_GENERATION = 0x7FFFFFFF;
+
+  private:
+    // FRIENDS
+    template <typename... Ts>
+    friend class Query;
+
+    // CONSTANTS
+    /**
+     * The index of an archetype that has not been looked up.
+     */
+    static constexpr uint32 NO_ARCHETYPE = 0xFFFFFFFF;
+
+    // TYPES
+    /**
+     * Where the components of an entity are stored.
+     */
+    struct Location
+    {
+        uint32 archetype;
+        uint32 row;
+    };
+
+    // MEMBERS
+    /**
+     * The archetypes in the order they were created.
+     */
+    cntr::DynamicArray<Archetype*> _archetypes;
+
+    /**
+     * The index of the archetype of each set of component types.
+     */
+    cntr::Map<ComponentMask, uint32> _archetypeIndices;
+
+    /**
+     * The archetype reached from each archetype by adding or removing each
+     * component type, or NO_ARCHETYPE until it is first needed.
+     */
+    cntr::DynamicArray<uint32> _edges;
+
+    /**
+     * The location of each entity index.
+     */
+    cntr::DynamicArray<Location> _locations;
+
+    /**
+     * The current generation of each entity index.
+     */
+    cntr::DynamicArray<uint32> _generations;
+
+    /**
+     * The entity indices available for reuse.
+     */
+    cntr::DynamicArray<uint32> _freeIndices;
+
+    /**
+     * The number of queries running.
+     */
+    mutable uint32 _lockCount;
+
+    // HELPER FUNCTIONS
+    /**
+     * Get the archetype of a set of component types, creating it if needed.
+     * @param mask The component types.
+     * @return The index of the archetype.
+     */
+    uint32 findArchetype( ComponentMask mask );
+
+    /**
+     * Get the archetype reached by adding or removing a component type.
+     * @param archetype The index of the archetype.
+     * @param type The type id.
+     * @return The index of the archetype reached.
+     */
+    uint32 toggleArchetype( uint32 archetype, uint32 type );
+
+    /**
+     * Move an entity to another archetype.
+     * The components in both are moved, those only in the old one are
+     * destructed, and those only in the new one are left unconstructed.
+     * @param entity The entity.
+     * @param target The index of the archetype.
+     */
+    void moveEntity( Entity entity, uint32 target );
+
+    /**
+     * Mark a query as running.
+     */
+    void lock() const;
+
+    /**
+     * Mark a query as done.
+     */
+    void unlock() const;
+
+    // HIDDEN FUNCTIONS
+    EntityRegistry( const EntityRegistry& other ) = delete;
+
+    EntityRegistry& operator=( const EntityRegistry& other ) = delete;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct an empty registry.
+     */
+    EntityRegistry();
+
+    /**
+     * Destruct the registry and every component in it.
+     */
+    ~EntityRegistry();
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Check if an entity has not been destroyed.
+     * @param entity The entity.
+     * @return Is it alive?
+     */
+    bool isAlive( Entity entity ) const;
+
+    /**
+     * Get the component types of an entity.
+     * @param entity The entity.
+     * @return The component types.
+     */
+    ComponentMask mask( Entity entity ) const;
+
+    /**
+     * Check if an entity has a component.
+     * @param entity The entity.
+     * @return Does it have the component?
+     */
+    template <typename T>
+    bool has( Entity entity ) const;
+
+    /**
+     * Get a component of an entity.
+     * The pointer is invalidated by the next change to the archetypes.
+     * @param entity The entity.
+     * @return The component or nullptr if the entity does not have it.
+     */
+    template <typename T>
+    T* get( Entity entity ) const;
+
+    /**
+     * Get the number of live entities.
+     * @return The number of entities.
+     */
+    uint32 size() const;
+
+    /**
+     * Get the number of archetypes.
+     * @return The number of archetypes.
+     */
+    uint32 archetypeCount() const;
+
+    /**
+     * Get an archetype.
+     * @param index The index of the archetype.
+     * @return The archetype.
+     */
+    const Archetype& archetype( uint32 index ) const;
+
+    /**
+     * Check if a query is running, during which the archetypes must not
+     * change.
+     * @return Is one running?
+     */
+    bool isLocked() const;
+
+    // MEMBER FUNCTIONS
+    /**
+     * Create an entity with no components.
+     * @return The entity.
+     */
+    Entity create();
+
+    /**
+     * Destroy an entity and its components.
+     * @param entity The entity.
+     */
+    void destroy( Entity entity );
+
+    /**
+     * Add a component to an entity, replacing the one it has.
+     * @param entity The entity.
+     * @param value The component.
+     * @return The component in the registry.
+     */
+    template <typename T>
+    T& add( Entity entity, T value = T() );
+
+    /**
+     * Remove a component from an entity if it has it.
+     * @param entity The entity.
+     */
+    template <typename T>
+    void remove( Entity entity );
+
+    /**
+     * Make room for a component of an entity, destructing the one it has.
+     * @param entity The entity.
+     * @param type The type id.
+     * @return The unconstructed component to construct in place.
+     */
+    void* addComponent( Entity entity, uint32 type );
+
+    /**
+     * Remove a component from an entity if it has it.
+     * @param entity The entity.
+     * @param type The type id.
+     */
+    void removeComponent( Entity entity, uint32 type );
+};
+
+// ACCESSOR FUNCTIONS
+inline
+bool EntityRegistry::isAlive( Entity entity ) const
+{
+    return entity.index() < _generations.size() &&
+           _generations[entity.index()] == entity.generation();
+}
+
+inline
+ComponentMask EntityRegistry::mask( Entity entity ) const
+{
+    assert( isAlive( entity ) );
+    return _archetypes[_locations[entity.index()].archetype]->mask();
+}
+
+template <typename T>
+inline
+bool EntityRegistry::has( Entity entity ) const
+{
+    return ( mask( entity ) & ComponentType::mask<T>() ) != 0;
+}
+
+template <typename T>
+inline
+T* EntityRegistry::get( Entity entity ) const
+{
+    assert( isAlive( entity ) );
+
+    const Location& location = _locations[entity.index()];
+    const Archetype* archetype = _archetypes[location.archetype];
+    uint32 column = archetype->column( ComponentType::id<T>() );
+    if ( column == Archetype::NO_COLUMN )
+    {
+        return nullptr;
+    }
+
+    return static_cast<T*>( archetype->component( location.row, column ) );
+}
+
+inline
+uint32 EntityRegistry::size() const
+{
+    return _generations.size() - _freeIndices.size();
+}
+
+inline
+uint32 EntityRegistry::archetypeCount() const
+{
+    return _archetypes.size();
+}
+
+inline
+const Archetype& EntityRegistry::archetype( uint32 index ) const
+{
+    return *_archetypes[index];
+}
+
+inline
+bool EntityRegistry::isLocked() const
+{
+    return _lockCount > 0;
+}
+
+// HELPER FUNCTIONS
+inline
+void EntityRegistry::lock() const
+{
+    ++_lockCount;
+}
+
+inline
+void EntityRegistry::unlock() const
+{
+    assert( _lockCount > 0 );
+    --_lockCount;
+}
+
+// MEMBER FUNCTIONS
+template <typename T>
+inline
+T& EntityRegistry::add( Entity entity, T value )
+{
+    void* component = addComponent( entity, ComponentType::id<T>() );
+    return *new ( component ) T( std::move( value ) );
+}
+
+template <typename T>
+inline
+void EntityRegistry::remove( Entity entity )
+{
+    removeComponent( entity, ComponentType::id<T>() );
+}
+
+} // End nspc obj
+
+} // End nspc demo
+
+#endif // DEMO_ENTITY_REGISTRY_H
@@ -56,12 +56,30 @@ class ModelObject : public Object
     ModelObject& operator=( const ModelObject& other );
 
     // ACCESSOR FUNCTIONS
+    /**
+     * Get the model.
+     * @return The model.
+     */
+    rndr::ModelPtr model() const;
+
     /**
      * Check if the object is renderable.
      * @return Is it renderable?
      */
     bool isRenderable() const override;
 
+    /**
+     * Get the bounds of the model.
+     * @return The bounds.
+     */
+    rndr::Bounds bounds() const override;
+
+    /**
+     * Get the simplified geometry of the model.
+     * @return The occluder or nullptr if there is no loaded model.
+     */
+    const rndr::Occluder* occluder() const override;
+
     // MUTATOR FUNCTIONS
     /**
      * Set the model.
@@ -75,6 +93,15 @@ class ModelObject : public Object
      * @param shader The shader to use during rendering.
      */
     void render( const rndr::Shader& shader ) override;
+
+    /**
+     * Render the meshes of the model that are inside a frustum.
+     * @param shader The shader to use during rendering.
+     * @param frustum The frustum in the object's space.
+     * @return The number of meshes culled.
+     */
+    uint32 render( const rndr::Shader& shader,
+                   const rndr::Frustum& frustum ) override;
 };
 
 // CONSTRUCTORS
@@ -111,17 +138,37 @@ ModelObject& ModelObject::operator=( const ModelObject& other )
 }
 
 // ACCESSOR FUNCTIONS
+inline
+rndr::ModelPtr ModelObject::model() const
+{
+    return _model;
+}
+
 inline
 bool ModelObject::isRenderable() const
 {
     return _model->isLoaded();
 }
 
+inline
+rndr::Bounds ModelObject::bounds() const
+{
+    return _model != nullptr ? _model->bounds() : rndr::Bounds();
+}
+
+inline
+const rndr::Occluder* ModelObject::occluder() const
+{
+    return _model != nullptr && _model->isLoaded() ? &_model->occluder() :
+                                                     nullptr;
+}
+
 // MUTATOR FUNCTIONS
 inline
 void ModelObject::setModel( rndr::ModelPtr model )
 {
     _model = model;
+    updateBounds();
 }
 
 // MEMBER FUNCTIONS
@@ -131,6 +178,13 @@ void ModelObject::render( const rndr::Shader& shader )
     _model->render( shader );
 }
 
+inline
+uint32 ModelObject::render( const rndr::Shader& shader,
+                            const rndr::Frustum& frustum )
+{
+    return _model->render( shader, frustum );
+}
+
 } // End nspc obj
 
 } // End nspc demo
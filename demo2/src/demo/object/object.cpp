@@ -1,6 +1,10 @@
 // object.cpp
 #include "object.h"
 
+#include <assert.h>
+
+#include "demo/object/scene.h"
+
 namespace demo
 {
 
@@ -10,6 +14,123 @@ namespace obj
 // GLOBALS
 uint64 Object::g_nextId = 0L;
 
+// CONSTRUCTORS
+Object::~Object()
+{
+    // leave the children as roots rather than pointing at a dead parent
+    while ( _firstChild != nullptr )
+    {
+        _firstChild->setParent( nullptr );
+    }
+
+    setParent( nullptr );
+}
+
+// MUTATOR FUNCTIONS
+void Object::setParent( Object* parent )
+{
+    if ( parent == _parent )
+    {
+        return;
+    }
+
+    #ifndef NDEBUG
+    for ( const Object* ancestor = parent;
+          ancestor != nullptr;
+          ancestor = ancestor->_parent )
+    {
+        assert( ancestor != this );
+    }
+    #endif
+
+    if ( _parent != nullptr )
+    {
+        Object** link = &_parent->_firstChild;
+        while ( *link != this )
+        {
+            link = &( *link )->_nextSibling;
+        }
+        *link = _nextSibling;
+        _nextSibling = nullptr;
+    }
+
+    if ( parent != nullptr )
+    {
+        Object** link = &parent->_firstChild;
+        while ( *link != nullptr )
+        {
+            link = &( *link )->_nextSibling;
+        }
+        *link = this;
+    }
+
+    _parent = parent;
+    _transform.setParent( parent != nullptr ? &parent->_transform : nullptr );
+}
+
+void Object::setTickGroup( uint32 tickGroup )
+{
+    assert( tickGroup < Scene::MAX_TICK_GROUPS );
+
+    _tickGroup = tickGroup;
+    if ( _scene != nullptr )
+    {
+        _scene->_isTickOrderDirty = true;
+        _lastTickTime = _scene->tickGroup( tickGroup ).time();
+    }
+}
+
+void Object::setStatic( bool isStatic )
+{
+    if ( isStatic != _isStatic )
+    {
+        _isStatic = isStatic;
+        updateBounds();
+    }
+}
+
+void Object::setHighlyDynamic( bool isHighlyDynamic )
+{
+    if ( isHighlyDynamic != _isHighlyDynamic )
+    {
+        _isHighlyDynamic = isHighlyDynamic;
+        updateBounds();
+    }
+}
+
+// MEMBER FUNCTIONS
+void Object::sleep()
+{
+    if ( _scene != nullptr )
+    {
+        _scene->requestAwake( this, false );
+    }
+    else
+    {
+        _isAwake = false;
+    }
+}
+
+void Object::wake()
+{
+    if ( _scene != nullptr )
+    {
+        _scene->requestAwake( this, true );
+    }
+    else
+    {
+        _isAwake = true;
+    }
+}
+
+void Object::updateBounds()
+{
+    if ( _scene != nullptr )
+    {
+        _scene->requestBoundsUpdate( this );
+    }
+}
+
 } // End nspc obj
 
-} // End nspc demo
\ No newline at end of file
+} // End nspc demo
@@ -2,24 +2,64 @@
 //
 // An object that can be placed in the world and interact with it.
 //
+// Objects form a hierarchy: an object's transform is relative to its parent,
+// so moving a parent carries its children along. The world matrix is
+// resolved by the transform system each time a scene updates its
+// transforms.
+//
+// Objects in a scene are ticked by it in the order of their tick groups,
+// lower groups first. Objects in the same group may tick at the same time on
+// different threads, so a tick must only change the object itself unless the
+// scene has been told that the objects depend on each other. How often the
+// objects of a group tick is set on the scene's tick group.
+//
+// An object that has nothing to do can be put to sleep, which takes it out
+// of the ticks altogether until it is woken. Sleeping and waking may be asked
+// for from any tick; they take effect on the next frame.
+//
+// A scene keeps the objects with bounds in a spatial index, which finds the
+// ones the scene's transforms moved on its own. Objects whose bounds change
+// without moving must say so with updateBounds. Objects marked static are
+// indexed for fast queries rather than fast updates, and objects marked
+// highly dynamic, which move every frame, are kept in a grid that is cheaper
+// to update than a tree.
+//
+// Objects marked occluding hide what is behind them from the renderer's
+// occlusion culling, using the simplified geometry they give with occluder.
+//
 #ifndef DEMO_OBJECT_H
 #define DEMO_OBJECT_H
 
 #include "demo/intdef.h"
 #include "demo/object/itickable.h"
 #include "demo/object/transform.h"
+#include "demo/render/bounds.h"
+#include "demo/render/frustum.h"
 #include "demo/render/irenderable.h"
 #include "demo/strdef.h"
+#include "demo/utility/string_id.h"
 
 namespace demo
 {
 
+namespace rndr
+{
+
+class Occluder;
+
+} // End nspc rndr
+
 namespace obj
 {
 
+class Scene;
+
 class Object : public ITickable, rndr::IRenderable
 {
   private:
+    // FRIENDS
+    friend class Scene;
+
     // GLOBALS
     /**
      * The next id.
@@ -35,19 +75,100 @@ class Object : public ITickable, rndr::IRenderable
     /**
      * The tag.
      */
-    String _tag;
+    util::StringId _tag;
 
     /**
      * The unique id.
      */
     uint64 _id;
 
+    /**
+     * The scene the object is in.
+     */
+    Scene* _scene;
+
+    /**
+     * The parent.
+     */
+    Object* _parent;
+
+    /**
+     * The first child.
+     */
+    Object* _firstChild;
+
+    /**
+     * The next child of the parent.
+     */
+    Object* _nextSibling;
+
+    /**
+     * The tick group.
+     */
+    uint32 _tickGroup;
+
+    /**
+     * The index in the scene's tick order.
+     */
+    uint32 _tickIndex;
+
+    /**
+     * The group time of the last tick.
+     */
+    double _lastTickTime;
+
+    /**
+     * The proxy in the scene's spatial index, or the index among the
+     * scene's objects without bounds.
+     */
+    uint32 _proxy;
+
+    /**
+     * Where the scene's spatial index keeps the object.
+     */
+    uint8 _placement;
+
     /**
      * Whether this is enabled.
      * This is true by default.
      */
     bool _isEnabled;
 
+    /**
+     * Whether this ticks or is asleep.
+     * This is true by default.
+     */
+    bool _isAwake;
+
+    /**
+     * Whether this was visible when last rendered.
+     * This is true by default.
+     */
+    bool _isVisible;
+
+    /**
+     * Whether this seldom moves.
+     * This is false by default.
+     */
+    bool _isStatic;
+
+    /**
+     * Whether this moves nearly every frame.
+     * This is false by default.
+     */
+    bool _isHighlyDynamic;
+
+    /**
+     * Whether this hides what is behind it when rendered.
+     * This is false by default.
+     */
+    bool _isOccluding;
+
+    /**
+     * Whether the scene must update the object's place in its spatial index.
+     */
+    bool _isBoundsDirty;
+
   public:
     // CONSTRUCTORS
     /**
@@ -87,29 +208,110 @@ class Object : public ITickable, rndr::IRenderable
      */
     Transform& transform();
 
+    /**
+     * Get the world matrix, which is the transform composed with those of
+     * every ancestor, as of the last Scene::updateTransforms.
+     * @return The world matrix.
+     */
+    const glm::mat4& worldMatrix() const;
+
+    /**
+     * Get the parent.
+     * @return The parent or nullptr for none.
+     */
+    Object* parent() const;
+
+    /**
+     * Get the first child.
+     * @return The child or nullptr for none.
+     */
+    Object* firstChild() const;
+
+    /**
+     * Get the next child of the parent.
+     * @return The sibling or nullptr for none.
+     */
+    Object* nextSibling() const;
+
+    /**
+     * Get the scene the object is in.
+     * @return The scene or nullptr for none.
+     */
+    Scene* scene() const;
+
     /**
      * Get the tag.
      * @return tag The tag.
      */
-    const String& tag() const;
+    util::StringId tag() const;
 
     /**
      * Get the unique object id.
      */
     uint64 id() const;
 
+    /**
+     * Get the tick group.
+     * @return The tick group.
+     */
+    uint32 tickGroup() const;
+
     /**
      * Check if the object is renderable.
      * @return Is it renderable?
      */
     virtual bool isRenderable() const;
 
+    /**
+     * Get the bounds of what the object renders in its own space.
+     * Objects with empty bounds are never culled.
+     * @return The bounds.
+     */
+    virtual rndr::Bounds bounds() const;
+
+    /**
+     * Get the simplified geometry of what the object renders in its own
+     * space, which hides what is behind it when the object is occluding.
+     * @return The occluder or nullptr if there is none.
+     */
+    virtual const rndr::Occluder* occluder() const;
+
     /**
      * Check if the object is enabled.
      * @return Is it enabled?
      */
     bool isEnabled() const;
 
+    /**
+     * Check if the object ticks or is asleep.
+     * @return Is it awake?
+     */
+    bool isAwake() const;
+
+    /**
+     * Check if the object was visible when last rendered.
+     * @return Is it visible?
+     */
+    bool isVisible() const;
+
+    /**
+     * Check if the object seldom moves.
+     * @return Is it static?
+     */
+    bool isStatic() const;
+
+    /**
+     * Check if the object moves nearly every frame.
+     * @return Is it highly dynamic?
+     */
+    bool isHighlyDynamic() const;
+
+    /**
+     * Check if the object hides what is behind it when rendered.
+     * @return Is it occluding?
+     */
+    bool isOccluding() const;
+
     // MUTATOR FUNCTIONS
     /**
      * Set the transform.
@@ -117,11 +319,25 @@ class Object : public ITickable, rndr::IRenderable
      */
     void setTransform( const Transform& transform );
 
+    /**
+     * Set the parent, making the transform relative to it.
+     * The object is appended to the parent's children. A parent must not be
+     * the object or one of its descendants.
+     * @param parent The parent or nullptr for none.
+     */
+    void setParent( Object* parent );
+
+    /**
+     * Set the tick group, which must be less than Scene::MAX_TICK_GROUPS.
+     * @param tickGroup The tick group.
+     */
+    void setTickGroup( uint32 tickGroup );
+
     /**
      * Set the tag.
      * @param tag The tag.
      */
-    void setTag( const String& tag );
+    void setTag( util::StringId tag );
 
     /**
      * Set whether this is enabled.
@@ -129,7 +345,57 @@ class Object : public ITickable, rndr::IRenderable
      */
     void setEnabled( bool enabled );
 
+    /**
+     * Set whether the object was visible when last rendered.
+     * Objects in groups that tick when visible only tick while visible.
+     * @param visible Is it visible?
+     */
+    void setVisible( bool visible );
+
+    /**
+     * Set whether the object seldom moves.
+     * Static objects are indexed for fast queries rather than fast updates,
+     * so moving them costs more.
+     * @param isStatic Is it static?
+     */
+    void setStatic( bool isStatic );
+
+    /**
+     * Set whether the object moves nearly every frame.
+     * Highly dynamic objects are kept in the scene's spatial hash, which is
+     * cheap to update but slower to query than a tree. Static takes
+     * precedence.
+     * @param isHighlyDynamic Is it highly dynamic?
+     */
+    void setHighlyDynamic( bool isHighlyDynamic );
+
+    /**
+     * Set whether the object hides what is behind it when rendered.
+     * Only large objects that hide a lot are worth making occluders, since
+     * each is rasterized on the CPU every frame it is inside the frustum.
+     * @param isOccluding Is it occluding?
+     */
+    void setOccluding( bool isOccluding );
+
     // MEMBER FUNCTIONS
+    /**
+     * Stop ticking until woken.
+     */
+    void sleep();
+
+    /**
+     * Tell the scene that the bounds changed without the object moving.
+     * The scene's spatial index catches up on the next
+     * Scene::updateTransforms.
+     */
+    void updateBounds();
+
+    /**
+     * Start ticking again.
+     * The first tick is given the time since waking.
+     */
+    void wake();
+
     /**
      * Prepare for the next tick cycle.
      */
@@ -151,22 +417,41 @@ class Object : public ITickable, rndr::IRenderable
      * @param shader The shader to use during rendering.
      */
     void render( const rndr::Shader& shader ) override;
+
+    /**
+     * Render the parts of the object that are inside a frustum.
+     * By default the whole object is rendered.
+     * @param shader The shader to use during rendering.
+     * @param frustum The frustum in the object's space.
+     * @return The number of meshes culled.
+     */
+    virtual uint32 render( const rndr::Shader& shader,
+                           const rndr::Frustum& frustum );
 };
 
 // CONSTRUCTORS
 inline
-Object::Object() : _transform(), _tag(), _id( ++g_nextId ), _isEnabled( true )
+Object::Object() : _transform(), _tag(), _id( ++g_nextId ), _scene( nullptr ),
+                   _parent( nullptr ), _firstChild( nullptr ),
+                   _nextSibling( nullptr ), _tickGroup( 0 ),
+                   _tickIndex( 0 ), _lastTickTime( 0.0 ), _proxy( 0 ),
+                   _placement( 0 ), _isEnabled( true ), _isAwake( true ),
+                   _isVisible( true ), _isStatic( false ),
+                   _isHighlyDynamic( false ), _isOccluding( false ),
+                   _isBoundsDirty( false )
 {
 }
 
 inline
 Object::Object( const Object& other ) 
-    : _transform(), _tag( other._tag ), _id( other._id ), _isEnabled( true )
-{
-}
-
-inline
-Object::~Object()
+    : _transform(), _tag( other._tag ), _id( other._id ), _scene( nullptr ),
+      _parent( nullptr ), _firstChild( nullptr ), _nextSibling( nullptr ),
+      _tickGroup( other._tickGroup ), _tickIndex( 0 ),
+      _lastTickTime( 0.0 ), _proxy( 0 ), _placement( 0 ),
+      _isEnabled( true ), _isAwake( true ), _isVisible( true ),
+      _isStatic( other._isStatic ),
+      _isHighlyDynamic( other._isHighlyDynamic ),
+      _isOccluding( other._isOccluding ), _isBoundsDirty( false )
 {
 }
 
@@ -194,7 +479,37 @@ Transform& Object::transform()
 }
 
 inline
-const String& Object::tag() const
+const glm::mat4& Object::worldMatrix() const
+{
+    return _transform.worldMatrix();
+}
+
+inline
+Object* Object::parent() const
+{
+    return _parent;
+}
+
+inline
+Object* Object::firstChild() const
+{
+    return _firstChild;
+}
+
+inline
+Object* Object::nextSibling() const
+{
+    return _nextSibling;
+}
+
+inline
+Scene* Object::scene() const
+{
+    return _scene;
+}
+
+inline
+util::StringId Object::tag() const
 {
     return _tag;
 }
@@ -205,18 +520,66 @@ uint64 Object::id() const
     return _id;
 }
 
+inline
+uint32 Object::tickGroup() const
+{
+    return _tickGroup;
+}
+
 inline
 bool Object::isRenderable() const
 {
     return false;
 }
 
+inline
+rndr::Bounds Object::bounds() const
+{
+    return rndr::Bounds();
+}
+
+inline
+const rndr::Occluder* Object::occluder() const
+{
+    return nullptr;
+}
+
 inline
 bool Object::isEnabled() const
 {
     return _isEnabled;
 }
 
+inline
+bool Object::isAwake() const
+{
+    return _isAwake;
+}
+
+inline
+bool Object::isVisible() const
+{
+    return _isVisible;
+}
+
+inline
+bool Object::isStatic() const
+{
+    return _isStatic;
+}
+
+inline
+bool Object::isHighlyDynamic() const
+{
+    return _isHighlyDynamic;
+}
+
+inline
+bool Object::isOccluding() const
+{
+    return _isOccluding;
+}
+
 // MUTATOR FUNCTIONS
 inline
 void Object::setTransform( const Transform& transform )
@@ -225,7 +588,7 @@ void Object::setTransform( const Transform& transform )
 }
 
 inline
-void Object::setTag( const String& tag )
+void Object::setTag( util::StringId tag )
 {
     _tag = tag;
 }
@@ -233,7 +596,19 @@ void Object::setTag( const String& tag )
 inline
 void Object::setEnabled( bool enabled )
 {
-    _isEnabled = true;
+    _isEnabled = enabled;
+}
+
+inline
+void Object::setVisible( bool visible )
+{
+    _isVisible = visible;
+}
+
+inline
+void Object::setOccluding( bool isOccluding )
+{
+    _isOccluding = isOccluding;
 }
 
 // MEMBER FUNCTIONS
@@ -257,6 +632,14 @@ void Object::render( const rndr::Shader& shader )
 {
 }
 
+inline
+uint32 Object::render( const rndr::Shader& shader,
+                       const rndr::Frustum& frustum )
+{
+    render( shader );
+    return 0;
+}
+
 } // End nspc obj
 
 } // End nspc demo
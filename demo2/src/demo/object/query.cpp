@@ -0,0 +1,2 @@
+// query.cpp
+#include "query.h"
@@ -0,0 +1,265 @@
+// query.h
+//
+// Iterates the entities of a registry that have a set of components.
+//
+// A query visits every archetype holding all of its component types and
+// hands over a chunk at a time: the number of entities in the chunk, their
+// handles, and a pointer to the array of each requested component. Working
+// on the arrays streams through contiguous memory, which is the fastest way
+// to touch many entities. The per entity form is a loop over the same arrays.
+//
+// Components requested as const are only read. The archetypes of the
+// registry must not change while a query runs; record such changes in a
+// command buffer instead. The chunks may be spread across a thread pool, in
+// which case the function is called from several threads at once, each with
+// a different chunk.
+//
+#ifndef DEMO_QUERY_H
+#define DEMO_QUERY_H
+
+#include <type_traits>
+
+#include "demo/intdef.h"
+#include "demo/object/archetype.h"
+#include "demo/object/component_type.h"
+#include "demo/object/entity.h"
+#include "demo/object/entity_registry.h"
+#include "demo/utility/thread_pool.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+template <typename... Ts>
+class Query
+{
+  private:
+    // MEMBERS
+    /**
+     * The registry to iterate.
+     */
+    const EntityRegistry* _registry;
+
+    /**
+     * The component types an entity must have.
+     */
+    ComponentMask _mask;
+
+    // HELPER FUNCTIONS
+    /**
+     * Get the array of a component in a chunk.
+     * @param archetype The archetype.
+     * @param chunk The chunk.
+     * @return The components.
+     */
+    template <typename T>
+    static T* column( const Archetype& archetype, uint32 chunk );
+
+    /**
+     * Check if an archetype has every component type of the query.
+     * @param archetype The archetype.
+     * @return Does it match?
+     */
+    bool matches( const Archetype& archetype ) const;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct a query over a registry.
+     * @param registry The registry.
+     */
+    explicit Query( const EntityRegistry* registry );
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the number of entities that match.
+     * @return The number of entities.
+     */
+    uint32 size() const;
+
+    /**
+     * Get the number of chunks that match.
+     * @return The number of chunks.
+     */
+    uint32 chunkCount() const;
+
+    // MEMBER FUNCTIONS
+    /**
+     * Call a function for every matching chunk.
+     * @param function The function, which takes the number of entities, the
+     * entities, and a pointer to the components of each type.
+     */
+    template <typename Function>
+    void forEachChunk( const Function& function ) const;
+
+    /**
+     * Call a function for every matching chunk, spread across a thread pool.
+     * @param threadPool The thread pool or nullptr to run on the calling
+     * thread.
+     * @param function The function, which takes the number of entities, the
+     * entities, and a pointer to the components of each type.
+     */
+    template <typename Function>
+    void forEachChunk( util::ThreadPool* threadPool,
+                       const Function& function ) const;
+
+    /**
+     * Call a function for every matching entity.
+     * @param function The function, which takes the entity and a reference
+     * to the component of each type.
+     */
+    template <typename Function>
+    void forEach( const Function& function ) const;
+};
+
+// HELPER FUNCTIONS
+template <typename... Ts>
+template <typename T>
+inline
+T* Query<Ts...>::column( const Archetype& archetype, uint32 chunk )
+{
+    uint32 type = ComponentType::id<typename std::remove_const<T>::type>();
+    return static_cast<T*>( archetype.components( chunk,
+                                                  archetype.column( type ) ) );
+}
+
+template <typename... Ts>
+inline
+bool Query<Ts...>::matches( const Archetype& archetype ) const
+{
+    return ( archetype.mask() & _mask ) == _mask && archetype.size() > 0;
+}
+
+// CONSTRUCTORS
+template <typename... Ts>
+inline
+Query<Ts...>::Query( const EntityRegistry* registry )
+    : _registry( registry ), _mask( 0 )
+{
+    ComponentMask masks[] = {
+        0, ComponentType::mask<typename std::remove_const<Ts>::type>()... };
+    for ( uint32 i = 0; i < sizeof( masks ) / sizeof( ComponentMask ); ++i )
+    {
+        _mask |= masks[i];
+    }
+}
+
+// ACCESSOR FUNCTIONS
+template <typename... Ts>
+inline
+uint32 Query<Ts...>::size() const
+{
+    uint32 size = 0;
+    for ( uint32 i = 0; i < _registry->archetypeCount(); ++i )
+    {
+        const Archetype& archetype = _registry->archetype( i );
+        if ( matches( archetype ) )
+        {
+            size += archetype.size();
+        }
+    }
+
+    return size;
+}
+
+template <typename... Ts>
+inline
+uint32 Query<Ts...>::chunkCount() const
+{
+    uint32 count = 0;
+    for ( uint32 i = 0; i < _registry->archetypeCount(); ++i )
+    {
+        const Archetype& archetype = _registry->archetype( i );
+        if ( matches( archetype ) )
+        {
+            count += archetype.chunkCount();
+        }
+    }
+
+    return count;
+}
+
+// MEMBER FUNCTIONS
+template <typename... Ts>
+template <typename Function>
+inline
+void Query<Ts...>::forEachChunk( const Function& function ) const
+{
+    _registry->lock();
+    for ( uint32 i = 0; i < _registry->archetypeCount(); ++i )
+    {
+        const Archetype& archetype = _registry->archetype( i );
+        if ( !matches( archetype ) )
+        {
+            continue;
+        }
+
+        for ( uint32 chunk = 0; chunk < archetype.chunkCount(); ++chunk )
+        {
+            function( archetype.chunkSize( chunk ),
+                      archetype.entities( chunk ),
+                      column<Ts>( archetype, chunk )... );
+        }
+    }
+    _registry->unlock();
+}
+
+template <typename... Ts>
+template <typename Function>
+inline
+void Query<Ts...>::forEachChunk( util::ThreadPool* threadPool,
+                                 const Function& function ) const
+{
+    if ( threadPool == nullptr )
+    {
+        forEachChunk( function );
+        return;
+    }
+
+    // each task finds its chunk by walking the archetypes, which are few
+    // next to the chunks, so nothing has to be gathered up front
+    _registry->lock();
+    threadPool->parallelFor( chunkCount(), [&]( uint32 task ) {
+        uint32 chunk = task;
+        for ( uint32 i = 0; i < _registry->archetypeCount(); ++i )
+        {
+            const Archetype& archetype = _registry->archetype( i );
+            if ( !matches( archetype ) )
+            {
+                continue;
+            }
+
+            if ( chunk < archetype.chunkCount() )
+            {
+                function( archetype.chunkSize( chunk ),
+                          archetype.entities( chunk ),
+                          column<Ts>( archetype, chunk )... );
+                return;
+            }
+            chunk -= archetype.chunkCount();
+        }
+    } );
+    _registry->unlock();
+}
+
+template <typename... Ts>
+template <typename Function>
+inline
+void Query<Ts...>::forEach( const Function& function ) const
+{
+    forEachChunk( [&]( uint32 count, const Entity* entities,
+                       Ts*... components ) {
+        for ( uint32 i = 0; i < count; ++i )
+        {
+            function( entities[i], components[i]... );
+        }
+    } );
+}
+
+} // End nspc obj
+
+} // End nspc demo
+
+#endif // DEMO_QUERY_H
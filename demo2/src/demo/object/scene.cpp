@@ -1,2 +1,881 @@
 // scene.cpp
 #include "scene.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "demo/container/map.h"
+#include "demo/container/set.h"
+#include "demo/object/transform_system.h"
+#include "demo/utility/clock.h"
+#include "demo/utility/frame_stats.h"
+#include "demo/utility/log.h"
+#include "demo/utility/profiler.h"
+#include "demo/utility/thread_pool.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+// CONSTANTS
+constexpr uint32 Scene::MAX_TICK_GROUPS;
+constexpr uint32 Scene::TICK_BATCH_SIZE;
+constexpr uint32 Scene::TREE_COUNT;
+constexpr uint32 Scene::BULK_RATIO;
+constexpr uint32 Scene::RAY_BATCH_SIZE;
+
+// HELPER FUNCTIONS
+void Scene::buildTickOrder()
+{
+    // the level of an object is the length of the longest chain of
+    // prerequisites before it in its own group
+    cntr::Map<const Object*, uint32> indices;
+    cntr::DynamicArray<uint32> levels;
+    for ( uint32 i = 0; i < _objects.size(); ++i )
+    {
+        indices.put( _objects[i], i );
+        levels.push( 0 );
+    }
+
+    // relax the levels until they settle, which takes no more passes than
+    // the longest chain is long; a cycle never settles, so stop there
+    bool isChanged = true;
+    for ( uint32 pass = 0; isChanged; ++pass )
+    {
+        if ( pass > _tickDependencies.size() )
+        {
+            DEMO_LOG_ERROR( "scene", "Tick dependencies form a cycle" );
+            assert( false );
+            break;
+        }
+
+        isChanged = false;
+        for ( uint32 i = 0; i < _tickDependencies.size(); ++i )
+        {
+            const TickDependency& dependency = _tickDependencies[i];
+            uint32 object = indices[dependency.object];
+            uint32 prerequisite = indices[dependency.prerequisite];
+            if ( dependency.prerequisite->tickGroup() !=
+                 dependency.object->tickGroup() )
+            {
+                continue;
+            }
+
+            if ( levels[object] <= levels[prerequisite] )
+            {
+                levels[object] = levels[prerequisite] + 1;
+                isChanged = true;
+            }
+        }
+    }
+
+    cntr::DynamicArray<uint32> order;
+    for ( uint32 i = 0; i < _objects.size(); ++i )
+    {
+        order.push( i );
+    }
+
+    // the sleeping objects go last in their stage
+    std::stable_sort( &order[0], &order[0] + order.size(),
+                      [&]( uint32 left, uint32 right ) {
+        uint32 leftGroup = _objects[left]->tickGroup();
+        uint32 rightGroup = _objects[right]->tickGroup();
+        if ( leftGroup != rightGroup )
+        {
+            return leftGroup < rightGroup;
+        }
+
+        if ( levels[left] != levels[right] )
+        {
+            return levels[left] < levels[right];
+        }
+
+        return _objects[left]->isAwake() && !_objects[right]->isAwake();
+    } );
+
+    _tickOrder.clear();
+    _stages.clear();
+    for ( uint32 i = 0; i < order.size(); ++i )
+    {
+        Object* object = _objects[order[i]];
+        const Object* previous = i > 0 ? _objects[order[i - 1]] : nullptr;
+        if ( previous == nullptr ||
+             previous->tickGroup() != object->tickGroup() ||
+             levels[order[i - 1]] != levels[order[i]] )
+        {
+            _stages.push( Stage{ i, i, i, object->tickGroup(), 0, 0.0f,
+                                 0, 0 } );
+        }
+
+        Stage& stage = _stages[_stages.size() - 1];
+        if ( object->isAwake() )
+        {
+            stage.awakeEnd = i + 1;
+        }
+        stage.end = i + 1;
+
+        object->_tickIndex = i;
+        _tickOrder.push( object );
+    }
+
+    _isTickOrderDirty = false;
+}
+
+bool Scene::isTickDependent( const Object* object,
+                             const Object* prerequisite ) const
+{
+    // walk the prerequisites of the object until the other one turns up
+    cntr::DynamicArray<const Object*> open;
+    cntr::Set<const Object*> visited;
+    open.push( object );
+    while ( open.size() > 0 )
+    {
+        const Object* current = open[open.size() - 1];
+        open.pop();
+        if ( current == prerequisite )
+        {
+            return true;
+        }
+
+        if ( visited.has( current ) )
+        {
+            continue;
+        }
+        visited.add( current );
+
+        for ( uint32 i = 0; i < _tickDependencies.size(); ++i )
+        {
+            if ( _tickDependencies[i].object == current )
+            {
+                open.push( _tickDependencies[i].prerequisite );
+            }
+        }
+    }
+
+    return false;
+}
+
+void Scene::requestAwake( Object* object, bool isAwake )
+{
+    std::lock_guard<std::mutex> lock( _awakeMutex );
+    _awakeRequests.push( AwakeRequest{ object, isAwake } );
+}
+
+void Scene::applyAwakeRequests()
+{
+    std::lock_guard<std::mutex> lock( _awakeMutex );
+    for ( uint32 i = 0; i < _awakeRequests.size(); ++i )
+    {
+        Object* object = _awakeRequests[i].object;
+        bool isAwake = _awakeRequests[i].isAwake;
+        if ( object->_isAwake == isAwake )
+        {
+            continue;
+        }
+
+        object->_isAwake = isAwake;
+        if ( isAwake )
+        {
+            object->_lastTickTime = _tickGroups[object->_tickGroup]._time;
+        }
+
+        // move the object across the boundary between the awake and the
+        // sleeping objects of its stage
+        uint32 index = object->_tickIndex;
+        Stage* stages = &_stages[0];
+        Stage* stage = std::upper_bound( stages, stages + _stages.size(),
+                                         index,
+                                         []( uint32 value, const Stage& s ) {
+            return value < s.begin;
+        } ) - 1;
+        uint32 target = isAwake ? stage->awakeEnd++ : --stage->awakeEnd;
+
+        Object* other = _tickOrder[target];
+        _tickOrder[target] = object;
+        _tickOrder[index] = other;
+        object->_tickIndex = target;
+        other->_tickIndex = index;
+    }
+    _awakeRequests.clear();
+}
+
+void Scene::planTicks( float dt )
+{
+    float shares[MAX_TICK_GROUPS];
+    for ( uint32 i = 0; i < MAX_TICK_GROUPS; ++i )
+    {
+        shares[i] = _tickGroups[i].advance( dt );
+    }
+
+    // each stage ticks its share of the awake objects, carrying the
+    // fraction of an object over to the next frame, and picks up where it
+    // left off
+    _batches.clear();
+    for ( uint32 i = 0; i < _stages.size(); ++i )
+    {
+        Stage& stage = _stages[i];
+        uint32 awake = stage.awakeEnd - stage.begin;
+        stage.batchBegin = _batches.size();
+        stage.batchEnd = stage.batchBegin;
+        if ( awake == 0 )
+        {
+            continue;
+        }
+
+        stage.carry += awake * shares[stage.group];
+        uint32 count = static_cast<uint32>( stage.carry );
+        if ( count >= awake )
+        {
+            count = awake;
+            stage.carry = 0.0f;
+        }
+        else
+        {
+            stage.carry -= count;
+        }
+
+        if ( stage.cursor >= awake )
+        {
+            stage.cursor = 0;
+        }
+
+        uint32 wrapped = std::min( count, awake - stage.cursor );
+        queueBatches( stage.begin + stage.cursor,
+                      stage.begin + stage.cursor + wrapped );
+        queueBatches( stage.begin, stage.begin + count - wrapped );
+        stage.cursor = ( stage.cursor + count ) % awake;
+        stage.batchEnd = _batches.size();
+
+        _tickGroups[stage.group]._lastTickCount += count;
+    }
+}
+
+void Scene::queueBatches( uint32 begin, uint32 end )
+{
+    for ( uint32 first = begin; first < end; first += TICK_BATCH_SIZE )
+    {
+        _batches.push( Range{ first,
+                              std::min( first + TICK_BATCH_SIZE, end ) } );
+    }
+}
+
+bool Scene::isTicking( const Object* object ) const
+{
+    return object->isEnabled() &&
+           ( object->isVisible() ||
+             _tickGroups[object->_tickGroup]._rate != TickGroup::WHEN_VISIBLE );
+}
+
+template <typename Phase>
+void Scene::runBatches( uint32 begin, uint32 end, const Phase& phase )
+{
+    Object* const* objects = &_tickOrder[0];
+    const Range* batches = &_batches[begin];
+
+    auto runBatch = [&]( uint32 batch ) {
+        for ( uint32 i = batches[batch].begin; i < batches[batch].end; ++i )
+        {
+            if ( isTicking( objects[i] ) )
+            {
+                phase( objects[i] );
+            }
+        }
+    };
+
+    if ( _threadPool == nullptr )
+    {
+        for ( uint32 batch = 0; batch < end - begin; ++batch )
+        {
+            runBatch( batch );
+        }
+    }
+    else
+    {
+        _threadPool->parallelFor( end - begin, runBatch );
+    }
+}
+
+void Scene::requestBoundsUpdate( Object* object )
+{
+    std::lock_guard<std::mutex> lock( _boundsMutex );
+    if ( !object->_isBoundsDirty )
+    {
+        object->_isBoundsDirty = true;
+        _boundsRequests.push( object );
+    }
+}
+
+void Scene::place( Object* object, uint32 placement,
+                   const rndr::Bounds& bounds )
+{
+    if ( placement == UNBOUNDED )
+    {
+        object->_proxy = _unboundedObjects.size();
+        _unboundedObjects.push( object );
+    }
+    else if ( placement == HASHED )
+    {
+        uint32 proxy = _hash.createProxy( bounds );
+        while ( _hashObjects.size() <= proxy )
+        {
+            _hashObjects.push( nullptr );
+        }
+        _hashObjects[proxy] = object;
+        object->_proxy = proxy;
+    }
+    else if ( placement >= STATIC_TREE )
+    {
+        uint32 tree = placement - STATIC_TREE;
+        uint32 proxy = _trees[tree].createProxy( bounds );
+        while ( _treeObjects[tree].size() <= proxy )
+        {
+            _treeObjects[tree].push( nullptr );
+        }
+        _treeObjects[tree][proxy] = object;
+        object->_proxy = proxy;
+    }
+
+    object->_placement = static_cast<uint8>( placement );
+}
+
+void Scene::unplace( Object* object )
+{
+    if ( object->_placement == UNBOUNDED )
+    {
+        // the last object takes the place of the removed one
+        Object* last = _unboundedObjects[_unboundedObjects.size() - 1];
+        _unboundedObjects[object->_proxy] = last;
+        last->_proxy = object->_proxy;
+        _unboundedObjects.pop();
+    }
+    else if ( object->_placement == HASHED )
+    {
+        _hash.destroyProxy( object->_proxy );
+        _hashObjects[object->_proxy] = nullptr;
+    }
+    else if ( object->_placement != UNPLACED )
+    {
+        uint32 tree = object->_placement - STATIC_TREE;
+        _trees[tree].destroyProxy( object->_proxy );
+        _treeObjects[tree][object->_proxy] = nullptr;
+    }
+
+    object->_placement = UNPLACED;
+}
+
+void Scene::updateIndex()
+{
+    DEMO_PROFILE_SCOPE( "Scene::updateIndex" );
+
+    std::lock_guard<std::mutex> lock( _boundsMutex );
+
+    // the objects whose transforms moved join the ones that asked
+    TransformSystem::inst()->forEachUpdated( [this]( uint32 id ) {
+        Object* object = id < _transformObjects.size() ?
+                         _transformObjects[id] : nullptr;
+        if ( object != nullptr && !object->_isBoundsDirty )
+        {
+            object->_isBoundsDirty = true;
+            _boundsRequests.push( object );
+        }
+    } );
+
+    if ( _boundsRequests.size() == 0 )
+    {
+        return;
+    }
+
+    // work out where each object goes and how much each tree and the hash
+    // change
+    uint32 structural[TREE_COUNT] = {};
+    uint32 moves[TREE_COUNT] = {};
+    uint32 hashChanges = 0;
+    _boundsUpdates.clear();
+    for ( uint32 i = 0; i < _boundsRequests.size(); ++i )
+    {
+        Object* object = _boundsRequests[i];
+        object->_isBoundsDirty = false;
+
+        rndr::Bounds bounds = object->bounds();
+        uint32 placement = UNBOUNDED;
+        if ( !bounds.isEmpty() )
+        {
+            bounds = bounds.transformed( object->worldMatrix() );
+            placement = object->_isStatic ? STATIC_TREE :
+                        object->_isHighlyDynamic ? HASHED : DYNAMIC_TREE;
+        }
+
+        if ( placement == HASHED || object->_placement == HASHED )
+        {
+            ++hashChanges;
+        }
+
+        if ( placement != object->_placement )
+        {
+            if ( object->_placement >= STATIC_TREE )
+            {
+                ++structural[object->_placement - STATIC_TREE];
+            }
+            if ( placement >= STATIC_TREE )
+            {
+                ++structural[placement - STATIC_TREE];
+            }
+        }
+        else if ( placement >= STATIC_TREE )
+        {
+            ++moves[placement - STATIC_TREE];
+        }
+
+        _boundsUpdates.push( BoundsUpdate{ object, bounds, placement } );
+    }
+    _boundsRequests.clear();
+
+    // a tree that changes shape a lot is rebuilt afterwards and one where
+    // many objects move is refit, rather than updating one object at a time
+    bool isRefitting[TREE_COUNT];
+    for ( uint32 tree = 0; tree < TREE_COUNT; ++tree )
+    {
+        uint32 bulk = _trees[tree].proxyCount() / BULK_RATIO;
+        if ( structural[tree] > bulk )
+        {
+            _trees[tree].invalidate();
+        }
+        isRefitting[tree] = moves[tree] > bulk;
+    }
+
+    // the hash is sorted again from scratch when most of it moves, which is
+    // cheaper than relinking most of its objects
+    if ( hashChanges > _hash.proxyCount() / BULK_RATIO )
+    {
+        _hash.invalidate();
+    }
+
+    for ( uint32 i = 0; i < _boundsUpdates.size(); ++i )
+    {
+        const BoundsUpdate& update = _boundsUpdates[i];
+        Object* object = update.object;
+        if ( update.placement != object->_placement )
+        {
+            // objects without bounds cannot be culled, so they are always
+            // visible, and objects entering the index stay hidden until a
+            // frustum finds them
+            if ( update.placement == UNBOUNDED )
+            {
+                object->_isVisible = true;
+            }
+            else if ( object->_placement < HASHED )
+            {
+                object->_isVisible = false;
+            }
+
+            unplace( object );
+            place( object, update.placement, update.bounds );
+        }
+        else if ( update.placement == HASHED )
+        {
+            _hash.moveProxy( object->_proxy, update.bounds );
+        }
+        else if ( update.placement >= STATIC_TREE )
+        {
+            uint32 tree = update.placement - STATIC_TREE;
+            if ( isRefitting[tree] )
+            {
+                _trees[tree].refitProxy( object->_proxy, update.bounds );
+            }
+            else
+            {
+                _trees[tree].moveProxy( object->_proxy, update.bounds );
+            }
+        }
+    }
+
+    for ( uint32 tree = 0; tree < TREE_COUNT; ++tree )
+    {
+        if ( _trees[tree].isDirty() )
+        {
+            _trees[tree].rebuild();
+        }
+        else
+        {
+            _trees[tree].refit();
+            _trees[tree].rebalance();
+        }
+    }
+
+    if ( _hash.isDirty() )
+    {
+        _hash.rebuild();
+    }
+    else
+    {
+        _hash.rebalance();
+    }
+}
+
+// CONSTRUCTORS
+Scene::~Scene()
+{
+    for ( uint32 i = 0; i < _objects.size(); ++i )
+    {
+        _objects[i]->_scene = nullptr;
+        _objects[i]->_placement = UNPLACED;
+        _objects[i]->_isBoundsDirty = false;
+    }
+}
+
+// MEMBER FUNCTIONS
+void Scene::addObject( Object* object )
+{
+    assert( object->_scene == nullptr );
+
+    object->_scene = this;
+    object->_lastTickTime = _tickGroups[object->_tickGroup]._time;
+    _objects.push( object );
+    _isTickOrderDirty = true;
+
+    uint32 id = object->_transform.id();
+    while ( _transformObjects.size() <= id )
+    {
+        _transformObjects.push( nullptr );
+    }
+    _transformObjects[id] = object;
+    requestBoundsUpdate( object );
+}
+
+void Scene::removeObject( Object* object )
+{
+    if ( !_objects.remove( object ) )
+    {
+        return;
+    }
+
+    object->_scene = nullptr;
+    _transformObjects[object->_transform.id()] = nullptr;
+    unplace( object );
+    if ( object->_isVisible )
+    {
+        _visibleObjects.remove( object );
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( _boundsMutex );
+        if ( object->_isBoundsDirty )
+        {
+            _boundsRequests.remove( object );
+            object->_isBoundsDirty = false;
+        }
+    }
+
+    for ( uint32 i = _tickDependencies.size(); i-- > 0; )
+    {
+        if ( _tickDependencies[i].object == object ||
+             _tickDependencies[i].prerequisite == object )
+        {
+            _tickDependencies.removeAt( i );
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( _awakeMutex );
+        for ( uint32 i = _awakeRequests.size(); i-- > 0; )
+        {
+            if ( _awakeRequests[i].object == object )
+            {
+                _awakeRequests.removeAt( i );
+            }
+        }
+    }
+    _isTickOrderDirty = true;
+}
+
+bool Scene::addTickDependency( Object* object, Object* prerequisite )
+{
+    assert( object->_scene == this && prerequisite->_scene == this );
+    assert( prerequisite->tickGroup() <= object->tickGroup() );
+
+    if ( isTickDependent( prerequisite, object ) )
+    {
+        DEMO_LOG_ERROR( "scene", "Tick dependency would form a cycle" );
+        return false;
+    }
+
+    _tickDependencies.push( TickDependency{ object, prerequisite } );
+    _isTickOrderDirty = true;
+    return true;
+}
+
+void Scene::removeTickDependency( Object* object, Object* prerequisite )
+{
+    for ( uint32 i = 0; i < _tickDependencies.size(); ++i )
+    {
+        if ( _tickDependencies[i].object == object &&
+             _tickDependencies[i].prerequisite == prerequisite )
+        {
+            _tickDependencies.removeAt( i );
+            _isTickOrderDirty = true;
+            return;
+        }
+    }
+}
+
+void Scene::tick( float dt )
+{
+    DEMO_PROFILE_SCOPE( "Scene::tick" );
+
+    if ( _isTickOrderDirty )
+    {
+        buildTickOrder();
+    }
+
+    applyAwakeRequests();
+    planTicks( dt );
+    if ( _batches.size() == 0 )
+    {
+        return;
+    }
+
+    // objects move their own transforms from whichever thread ticks them
+    TransformSystem* transforms = TransformSystem::inst();
+    transforms->beginConcurrentChanges();
+
+    {
+        util::PhaseTimer timer( _frameStats, util::FrameStats::PRE_TICK );
+        runBatches( 0, _batches.size(), []( Object* object ) {
+            object->preTick();
+        } );
+    }
+
+    {
+        util::PhaseTimer timer( _frameStats, util::FrameStats::TICK );
+        for ( uint32 i = 0; i < _stages.size(); ++i )
+        {
+            const Stage& stage = _stages[i];
+            if ( stage.batchBegin == stage.batchEnd )
+            {
+                continue;
+            }
+
+            // each object is given the group time since its last tick
+            TickGroup& group = _tickGroups[stage.group];
+            util::Clock::SysClock::time_point start = util::Clock::SysClock::now();
+            runBatches( stage.batchBegin, stage.batchEnd,
+                        [&group]( Object* object ) {
+                object->tick( static_cast<float>(
+                    group._time - object->_lastTickTime ) );
+                object->_lastTickTime = group._time;
+            } );
+            group._lastCost += std::chrono::duration<double>(
+                util::Clock::SysClock::now() - start ).count();
+        }
+    }
+
+    {
+        util::PhaseTimer timer( _frameStats, util::FrameStats::POST_TICK );
+        runBatches( 0, _batches.size(), []( Object* object ) {
+            object->postTick();
+        } );
+    }
+
+    transforms->endConcurrentChanges();
+
+    for ( uint32 i = 0; i < MAX_TICK_GROUPS; ++i )
+    {
+        _tickGroups[i]._totalCost += _tickGroups[i]._lastCost;
+        _tickGroups[i]._totalTickCount += _tickGroups[i]._lastTickCount;
+    }
+}
+
+void Scene::updateTransforms()
+{
+    TransformSystem::inst()->update( _threadPool );
+    updateIndex();
+}
+
+void Scene::queryBox( const rndr::Bounds& bounds,
+                      cntr::DynamicArray<Object*>* objects ) const
+{
+    for ( uint32 tree = 0; tree < TREE_COUNT; ++tree )
+    {
+        const cntr::DynamicArray<Object*>& treeObjects = _treeObjects[tree];
+        _trees[tree].queryBox( bounds, [&]( uint32 proxy ) {
+            objects->push( treeObjects[proxy] );
+        } );
+    }
+
+    _hash.queryBox( bounds, [&]( uint32 proxy ) {
+        objects->push( _hashObjects[proxy] );
+    } );
+}
+
+void Scene::querySphere( const glm::vec3& center, float radius,
+                         cntr::DynamicArray<Object*>* objects ) const
+{
+    for ( uint32 tree = 0; tree < TREE_COUNT; ++tree )
+    {
+        const cntr::DynamicArray<Object*>& treeObjects = _treeObjects[tree];
+        _trees[tree].querySphere( center, radius, [&]( uint32 proxy ) {
+            objects->push( treeObjects[proxy] );
+        } );
+    }
+
+    _hash.querySphere( center, radius, [&]( uint32 proxy ) {
+        objects->push( _hashObjects[proxy] );
+    } );
+}
+
+void Scene::queryFrustum( const rndr::Frustum& frustum,
+                          cntr::DynamicArray<Object*>* objects ) const
+{
+    for ( uint32 tree = 0; tree < TREE_COUNT; ++tree )
+    {
+        const cntr::DynamicArray<Object*>& treeObjects = _treeObjects[tree];
+        _trees[tree].queryFrustum( frustum, [&]( uint32 proxy ) {
+            objects->push( treeObjects[proxy] );
+        } );
+    }
+
+    _hash.queryFrustum( frustum, [&]( uint32 proxy ) {
+        objects->push( _hashObjects[proxy] );
+    } );
+}
+
+Scene::RayHit Scene::raycast( const Bvh::Ray& ray ) const
+{
+    // each structure only needs searching up to the closest hit so far
+    RayHit hit = { nullptr, ray.maxDistance };
+    Bvh::Ray clipped = ray;
+    for ( uint32 tree = 0; tree < TREE_COUNT; ++tree )
+    {
+        Bvh::RayHit treeHit = _trees[tree].raycast( clipped );
+        if ( treeHit.proxy != Bvh::NO_PROXY )
+        {
+            hit.object = _treeObjects[tree][treeHit.proxy];
+            hit.distance = treeHit.distance;
+            clipped.maxDistance = treeHit.distance;
+        }
+    }
+
+    SpatialHash::RayHit hashHit = _hash.raycast( clipped );
+    if ( hashHit.proxy != SpatialHash::NO_PROXY )
+    {
+        hit.object = _hashObjects[hashHit.proxy];
+        hit.distance = hashHit.distance;
+    }
+
+    return hit;
+}
+
+void Scene::raycast( const Bvh::Ray* rays, uint32 count, RayHit* hits ) const
+{
+    auto runBatch = [&]( uint32 batch ) {
+        uint32 end = std::min( ( batch + 1 ) * RAY_BATCH_SIZE, count );
+        for ( uint32 i = batch * RAY_BATCH_SIZE; i < end; ++i )
+        {
+            hits[i] = raycast( rays[i] );
+        }
+    };
+
+    uint32 batchCount = ( count + RAY_BATCH_SIZE - 1 ) / RAY_BATCH_SIZE;
+    if ( _threadPool == nullptr )
+    {
+        for ( uint32 batch = 0; batch < batchCount; ++batch )
+        {
+            runBatch( batch );
+        }
+    }
+    else
+    {
+        _threadPool->parallelFor( batchCount, runBatch );
+    }
+}
+
+void Scene::queryPairs( float distance,
+                        cntr::DynamicArray<ObjectPair>* pairs )
+{
+    _hash.queryPairs( distance, &_hashPairs, _threadPool );
+
+    pairs->clear();
+    for ( uint32 i = 0; i < _hashPairs.size(); ++i )
+    {
+        pairs->push( ObjectPair{ _hashObjects[_hashPairs[i].first],
+                                 _hashObjects[_hashPairs[i].second] } );
+    }
+}
+
+const cntr::DynamicArray<Object*>& Scene::updateVisibility(
+    const rndr::Frustum& frustum )
+{
+    DEMO_PROFILE_SCOPE( "Scene::updateVisibility" );
+
+    // objects that have left the index since are visible for other reasons
+    for ( uint32 i = 0; i < _visibleObjects.size(); ++i )
+    {
+        if ( _visibleObjects[i]->_placement >= HASHED )
+        {
+            _visibleObjects[i]->_isVisible = false;
+        }
+    }
+
+    _visibleObjects.clear();
+    queryFrustum( frustum, &_visibleObjects );
+    for ( uint32 i = 0; i < _visibleObjects.size(); ++i )
+    {
+        _visibleObjects[i]->_isVisible = true;
+    }
+
+    return _visibleObjects;
+}
+
+void Scene::dumpTickGroups( FILE* file ) const
+{
+    static const char* const RATE_NAMES[] = {
+        "frame", "nth", "fixed", "visible" };
+
+    fprintf( file, "Tick groups:\n" );
+    fprintf( file, "  %-5s %-7s %12s %10s %10s\n", "group", "rate", "ticks",
+             "total ms", "us/tick" );
+
+    for ( uint32 i = 0; i < MAX_TICK_GROUPS; ++i )
+    {
+        const TickGroup& group = _tickGroups[i];
+        if ( group.totalTickCount() == 0 )
+        {
+            continue;
+        }
+
+        fprintf( file, "  %-5u %-7s %12llu %10.3f %10.3f\n", i,
+                 RATE_NAMES[group.rate()],
+                 static_cast<unsigned long long>( group.totalTickCount() ),
+                 group.totalCost() * 1000.0,
+                 group.totalCost() * 1000000.0 / group.totalTickCount() );
+    }
+}
+
+void Scene::dumpSpatialIndex( FILE* file ) const
+{
+    static const char* const TREE_NAMES[] = { "static", "dynamic" };
+
+    fprintf( file, "Spatial index:\n" );
+    fprintf( file, "  %-7s %10s %7s %10s\n", "tree", "objects", "height",
+             "cost" );
+
+    for ( uint32 tree = 0; tree < TREE_COUNT; ++tree )
+    {
+        fprintf( file, "  %-7s %10u %7u %10.2f\n", TREE_NAMES[tree],
+                 _trees[tree].proxyCount(), _trees[tree].height(),
+                 _trees[tree].cost() );
+    }
+    fprintf( file, "  hash    %10u %7u cell(s), %.2f per cell\n",
+             _hash.proxyCount(), _hash.cellCount(),
+             _hash.averageOccupancy() );
+    fprintf( file, "  %u object(s) without bounds\n",
+             _unboundedObjects.size() );
+}
+
+} // End nspc obj
+
+} // End nspc demo
@@ -3,27 +3,405 @@
 // Manages a set of objects in a scene that can be interacted with and
 // rendered.
 //
+// Besides objects, a scene holds an entity registry for things that are
+// better stored as components, such as large numbers of plain models.
+//
+// The transforms of the objects, including their hierarchy, are owned by the
+// transform system, as are the transforms of the entities. Updating the
+// scene's transforms brings every world matrix up to date, spread across the
+// scene's thread pool when there is one.
+//
+// Ticking the scene runs the pre-tick, tick, and post-tick of every enabled
+// object as three phases with a barrier between them, so every object has
+// finished one phase before any starts the next. Each phase is split into
+// batches of objects that are spread across the thread pool. Ticks run in
+// stages: the tick groups in order, and within a group the objects that
+// depend on others after them. The objects of a stage tick at the same time,
+// so a tick may read the objects of earlier stages but must only change its
+// own object, and must not add or remove objects or change the hierarchy.
+// The pre-ticks and post-ticks of all objects run at once.
+//
+// Each tick group has its own rate and time scale. A stage of a group that
+// ticks less than every frame ticks the next share of its objects in turn,
+// which spreads the work evenly across frames. Sleeping objects are kept at
+// the end of their stage, past the objects that are ticked, so they cost
+// nothing until they wake.
+//
+// The stages are worked out again on the first tick after objects, groups,
+// or dependencies change, so steady-state ticks do not allocate. Sleeping
+// and waking move an object within its stage on the next tick.
+//
+// The objects with bounds are kept in a spatial index of two bounding volume
+// hierarchies: one built for fast queries that holds the static objects and
+// one kept up to date incrementally that holds the rest. Updating the
+// scene's transforms also moves the objects whose world matrices changed
+// within the index, so the index is only as current as the last
+// updateTransforms. When much of a tree changes at once it is rebuilt or
+// refit in one pass instead. Objects marked highly dynamic, which move every
+// frame, are kept in a spatial hash beside the trees instead, which is
+// rebuilt with a counting sort when most of it moves. The index answers
+// frustum, box, sphere, and ray queries, finds the pairs of highly dynamic
+// objects that are near each other, and keeps track of which objects a
+// frustum last found so their visibility can be updated without visiting
+// every object.
+//
 #ifndef DEMO_SCENE_H
 #define DEMO_SCENE_H
 
+#include <assert.h>
+#include <stdio.h>
+
+#include <mutex>
+
 #include "demo/container/dynamic_array.h"
+#include "demo/object/bvh.h"
+#include "demo/object/entity_registry.h"
 #include "demo/object/object.h"
+#include "demo/object/spatial_hash.h"
+#include "demo/object/tick_group.h"
 
 namespace demo
 {
 
+namespace util
+{
+
+class FrameStats;
+class ThreadPool;
+
+} // End nspc util
+
 namespace obj
 {
 
 class Scene
 {
+  public:
+    // CONSTANTS
+    /**
+     * The number of tick groups.
+     */
+    static constexpr uint32 MAX_TICK_GROUPS = 8;
+
+    // TYPES
+    /**
+     * The closest object a ray hit.
+     */
+    struct RayHit
+    {
+        Object* object;
+        float distance;
+    };
+
+    /**
+     * Two objects near each other.
+     */
+    struct ObjectPair
+    {
+        Object* first;
+        Object* second;
+    };
+
   private:
+    // FRIENDS
+    friend class Object;
+
+    // TYPES
+    /**
+     * An object that must tick after another.
+     */
+    struct TickDependency
+    {
+        Object* object;
+        Object* prerequisite;
+    };
+
+    /**
+     * An object to put to sleep or wake.
+     */
+    struct AwakeRequest
+    {
+        Object* object;
+        bool isAwake;
+    };
+
+    /**
+     * Where the spatial index keeps an object.
+     */
+    enum Placement
+    {
+        UNPLACED,
+        UNBOUNDED,
+        HASHED,
+        STATIC_TREE,
+        DYNAMIC_TREE
+    };
+
+    /**
+     * The world bounds of an object and where they go in the spatial
+     * index.
+     */
+    struct BoundsUpdate
+    {
+        Object* object;
+        rndr::Bounds bounds;
+        uint32 placement;
+    };
+
+    /**
+     * A half-open run of the tick order.
+     */
+    struct Range
+    {
+        uint32 begin;
+        uint32 end;
+    };
+
+    /**
+     * A run of the tick order whose objects tick at the same time.
+     * The awake objects come first.
+     */
+    struct Stage
+    {
+        uint32 begin;
+        uint32 awakeEnd;
+        uint32 end;
+        uint32 group;
+        uint32 cursor;
+        float carry;
+        uint32 batchBegin;
+        uint32 batchEnd;
+    };
+
+    // CONSTANTS
+    /**
+     * The number of objects in a batch handed to a thread.
+     */
+    static constexpr uint32 TICK_BATCH_SIZE = 128;
+
+    /**
+     * The number of trees in the spatial index.
+     */
+    static constexpr uint32 TREE_COUNT = 2;
+
+    /**
+     * The fraction of a tree's objects, as one over this, that must change
+     * at once for the tree to be rebuilt or refit rather than updated an
+     * object at a time.
+     */
+    static constexpr uint32 BULK_RATIO = 4;
+
+    /**
+     * The number of rays in a batch handed to a thread.
+     */
+    static constexpr uint32 RAY_BATCH_SIZE = 64;
+
     // MEMBERS
     /**
      * The objects in the scene.
      */
     cntr::DynamicArray<Object*> _objects;
 
+    /**
+     * The entities in the scene.
+     */
+    EntityRegistry _registry;
+
+    /**
+     * The threads large updates are spread across or nullptr for none.
+     */
+    util::ThreadPool* _threadPool;
+
+    /**
+     * The stats tick phases are recorded into or nullptr for none.
+     */
+    util::FrameStats* _frameStats;
+
+    /**
+     * The objects that must tick after others.
+     */
+    cntr::DynamicArray<TickDependency> _tickDependencies;
+
+    /**
+     * The objects in the order they tick.
+     */
+    cntr::DynamicArray<Object*> _tickOrder;
+
+    /**
+     * The stages of the tick order.
+     */
+    cntr::DynamicArray<Stage> _stages;
+
+    /**
+     * The batches of objects that tick this frame, by stage.
+     */
+    cntr::DynamicArray<Range> _batches;
+
+    /**
+     * The tick groups.
+     */
+    TickGroup _tickGroups[MAX_TICK_GROUPS];
+
+    /**
+     * The objects to put to sleep or wake on the next tick.
+     */
+    cntr::DynamicArray<AwakeRequest> _awakeRequests;
+
+    /**
+     * The mutex that guards the awake requests.
+     */
+    std::mutex _awakeMutex;
+
+    /**
+     * The static and the other objects with bounds.
+     */
+    Bvh _trees[TREE_COUNT];
+
+    /**
+     * The object of each proxy in each tree.
+     */
+    cntr::DynamicArray<Object*> _treeObjects[TREE_COUNT];
+
+    /**
+     * The highly dynamic objects with bounds.
+     */
+    SpatialHash _hash;
+
+    /**
+     * The object of each proxy in the hash.
+     */
+    cntr::DynamicArray<Object*> _hashObjects;
+
+    /**
+     * The pairs of proxies found by the last pair query.
+     */
+    cntr::DynamicArray<SpatialHash::Pair> _hashPairs;
+
+    /**
+     * The objects without bounds.
+     */
+    cntr::DynamicArray<Object*> _unboundedObjects;
+
+    /**
+     * The object of each transform id or nullptr for none.
+     */
+    cntr::DynamicArray<Object*> _transformObjects;
+
+    /**
+     * The objects whose place in the spatial index must be updated.
+     */
+    cntr::DynamicArray<Object*> _boundsRequests;
+
+    /**
+     * The updates to the spatial index being applied.
+     */
+    cntr::DynamicArray<BoundsUpdate> _boundsUpdates;
+
+    /**
+     * The objects the last visibility update found.
+     */
+    cntr::DynamicArray<Object*> _visibleObjects;
+
+    /**
+     * The mutex that guards the bounds requests.
+     */
+    std::mutex _boundsMutex;
+
+    /**
+     * Whether the tick order must be worked out again.
+     */
+    bool _isTickOrderDirty;
+
+    // HELPER FUNCTIONS
+    /**
+     * Work out the tick order and its stages.
+     */
+    void buildTickOrder();
+
+    /**
+     * Check if an object ticks after another, directly or through other
+     * dependencies.
+     * @param object The object.
+     * @param prerequisite The object that may tick first.
+     * @return Does it tick after it?
+     */
+    bool isTickDependent( const Object* object,
+                          const Object* prerequisite ) const;
+
+    /**
+     * Ask for an object to be put to sleep or woken on the next tick.
+     * @param object The object.
+     * @param isAwake Should it be awake?
+     */
+    void requestAwake( Object* object, bool isAwake );
+
+    /**
+     * Put to sleep or wake the objects asked for.
+     */
+    void applyAwakeRequests();
+
+    /**
+     * Advance the tick groups and pick the objects that tick this frame.
+     * @param dt The elapsed time in seconds.
+     */
+    void planTicks( float dt );
+
+    /**
+     * Split a run of the tick order into batches.
+     * @param begin The first index in the tick order.
+     * @param end The index after the last.
+     */
+    void queueBatches( uint32 begin, uint32 end );
+
+    /**
+     * Check if an object ticks when its batch runs.
+     * @param object The object.
+     * @return Does it tick?
+     */
+    bool isTicking( const Object* object ) const;
+
+    /**
+     * Run a phase on every object in a run of batches, spread across the
+     * thread pool.
+     * @param begin The first batch.
+     * @param end The batch after the last.
+     * @param phase The phase, which takes the object.
+     */
+    template <typename Phase>
+    void runBatches( uint32 begin, uint32 end, const Phase& phase );
+
+    /**
+     * Ask for an object's place in the spatial index to be updated.
+     * @param object The object.
+     */
+    void requestBoundsUpdate( Object* object );
+
+    /**
+     * Put an object into the spatial index.
+     * @param object The object.
+     * @param placement Where it goes.
+     * @param bounds Its world bounds.
+     */
+    void place( Object* object, uint32 placement,
+                const rndr::Bounds& bounds );
+
+    /**
+     * Take an object out of the spatial index.
+     * @param object The object.
+     */
+    void unplace( Object* object );
+
+    /**
+     * Update the places in the spatial index of the objects that moved or
+     * asked for it.
+     */
+    void updateIndex();
+
+    // HIDDEN FUNCTIONS
+    Scene( const Scene& other ) = delete;
+
+    Scene& operator=( const Scene& other ) = delete;
+
   public:
     // CONSTRUCTORS
     /**
@@ -32,23 +410,78 @@ class Scene
     Scene();
 
     /**
-     * Construct a copy of another scene.
-     * @param other The other scene.
+     * Destruct the scene.
      */
-    Scene( const Scene& other );
+    ~Scene();
 
+    // ACCESSOR FUNCTIONS
     /**
-     * Destruct the scene.
+     * Get the entities in the scene.
+     * @return The entity registry.
      */
-    ~Scene();
+    const EntityRegistry& registry() const;
+
+    /**
+     * Get the entities in the scene.
+     * @return The entity registry.
+     */
+    EntityRegistry& registry();
+
+    /**
+     * Get a tick group.
+     * @param group The index of the group.
+     * @return The tick group.
+     */
+    const TickGroup& tickGroup( uint32 group ) const;
+
+    /**
+     * Get a tick group to change how often it ticks.
+     * @param group The index of the group.
+     * @return The tick group.
+     */
+    TickGroup& tickGroup( uint32 group );
+
+    /**
+     * Get the objects without bounds, which the spatial index leaves out.
+     * @return The objects.
+     */
+    const cntr::DynamicArray<Object*>& unboundedObjects() const;
+
+    /**
+     * Get the number of objects in the spatial index.
+     * @return The number of objects with bounds.
+     */
+    uint32 indexedObjectCount() const;
+
+    // MUTATOR FUNCTIONS
+    /**
+     * Set the threads large updates are spread across.
+     * @param threadPool The thread pool or nullptr to update on the calling
+     * thread.
+     */
+    void setThreadPool( util::ThreadPool* threadPool );
+
+    /**
+     * Set the stats the tick phases are recorded into.
+     * @param frameStats The stats or nullptr for none.
+     */
+    void setFrameStats( util::FrameStats* frameStats );
+
+    /**
+     * Set the distance the boxes of objects that move are grown by in the
+     * spatial index, so small moves do not change the index.
+     * @param margin The margin, at least 0.
+     */
+    void setIndexMargin( float margin );
 
-    // OPERATORS
     /**
-     * Assign this as a copy of another scene.
-     * @param other The other scene.
-     * @return This.
+     * Set the size of the cells of the spatial hash on each axis, which is
+     * best about the size of the highly dynamic objects or the distance
+     * they are queried at.
+     * The hash is rebuilt right away.
+     * @param cellSize The cell size.
      */
-    Scene& operator=( const Scene& other );
+    void setHashCellSize( float cellSize );
 
     // MEMBER FUNCTIONS
     /**
@@ -59,6 +492,7 @@ class Scene
 
     /**
      * Remove an object.
+     * Its tick dependencies are removed with it.
      * @param object The object.
      */
     void removeObject( Object* object );
@@ -68,45 +502,196 @@ class Scene
      * @return The objects in the scene.
      */
     const cntr::DynamicArray<Object*>& getObjects() const;
+
+    /**
+     * Make an object tick after another.
+     * The prerequisite must be in the same tick group or an earlier one. A
+     * dependency that would form a cycle is logged and not added.
+     * @param object The object.
+     * @param prerequisite The object to tick first.
+     * @return Was it added?
+     */
+    bool addTickDependency( Object* object, Object* prerequisite );
+
+    /**
+     * Stop making an object tick after another.
+     * @param object The object.
+     * @param prerequisite The object it ticked after.
+     */
+    void removeTickDependency( Object* object, Object* prerequisite );
+
+    /**
+     * Run the pre-tick, tick, and post-tick of every enabled object.
+     * @param dt The elapsed time in seconds.
+     */
+    void tick( float dt );
+
+    /**
+     * Recompute the world matrices of every changed transform and of the
+     * subtrees under them, then move the objects they belong to within the
+     * spatial index.
+     * This should be called after the scene is updated and before it is
+     * rendered. The transforms are shared by every scene, so only one scene
+     * should update them each frame.
+     */
+    void updateTransforms();
+
+    /**
+     * Find the objects whose bounds overlap a box.
+     * The objects found are added to the array.
+     * @param bounds The box.
+     * @param objects The objects found.
+     */
+    void queryBox( const rndr::Bounds& bounds,
+                   cntr::DynamicArray<Object*>* objects ) const;
+
+    /**
+     * Find the objects whose bounds overlap a sphere.
+     * The objects found are added to the array.
+     * @param center The center of the sphere.
+     * @param radius The radius of the sphere.
+     * @param objects The objects found.
+     */
+    void querySphere( const glm::vec3& center, float radius,
+                      cntr::DynamicArray<Object*>* objects ) const;
+
+    /**
+     * Find the objects whose bounds are at least partly inside a frustum.
+     * The objects found are added to the array.
+     * @param frustum The frustum.
+     * @param objects The objects found.
+     */
+    void queryFrustum( const rndr::Frustum& frustum,
+                       cntr::DynamicArray<Object*>* objects ) const;
+
+    /**
+     * Find the closest object whose bounds a ray hits.
+     * @param ray The ray.
+     * @return The hit, whose object is nullptr for none.
+     */
+    RayHit raycast( const Bvh::Ray& ray ) const;
+
+    /**
+     * Find the closest object each of several rays hits, spread across the
+     * thread pool.
+     * @param rays The rays.
+     * @param count The number of rays.
+     * @param hits The hits, one for each ray.
+     */
+    void raycast( const Bvh::Ray* rays, uint32 count, RayHit* hits ) const;
+
+    /**
+     * Find every pair of highly dynamic objects whose bounds are no farther
+     * apart than a distance.
+     * @param distance The distance.
+     * @param pairs The pairs found.
+     */
+    void queryPairs( float distance, cntr::DynamicArray<ObjectPair>* pairs );
+
+    /**
+     * Find the objects inside a frustum and mark them visible, and mark the
+     * ones the last update found that are no longer inside as not visible.
+     * Objects without bounds are always visible and are left out.
+     * @param frustum The frustum.
+     * @return The visible objects.
+     */
+    const cntr::DynamicArray<Object*>& updateVisibility(
+        const rndr::Frustum& frustum );
+
+    /**
+     * Print the tick counts and costs of the tick groups that have ticked.
+     * @param file The file to print to.
+     */
+    void dumpTickGroups( FILE* file ) const;
+
+    /**
+     * Print the size and quality of the spatial index.
+     * @param file The file to print to.
+     */
+    void dumpSpatialIndex( FILE* file ) const;
 };
 
 // CONSTRUCTORS
 inline
-Scene::Scene() : _objects()
+Scene::Scene() : _objects(), _registry(), _threadPool( nullptr ),
+                 _frameStats( nullptr ), _tickDependencies(), _tickOrder(),
+                 _stages(), _batches(), _tickGroups(), _awakeRequests(),
+                 _awakeMutex(), _trees(), _treeObjects(), _hash(),
+                 _hashObjects(), _hashPairs(), _unboundedObjects(),
+                 _transformObjects(), _boundsRequests(), _boundsUpdates(),
+                 _visibleObjects(), _boundsMutex(), _isTickOrderDirty( false )
 {
+    // static objects are not expected to move, so their boxes are exact
+    _trees[STATIC_TREE - STATIC_TREE].setMargin( 0.0f );
 }
 
+// ACCESSOR FUNCTIONS
 inline
-Scene::Scene( const Scene& other ) : _objects( other._objects )
+const EntityRegistry& Scene::registry() const
 {
+    return _registry;
 }
 
 inline
-Scene::~Scene()
+EntityRegistry& Scene::registry()
 {
+    return _registry;
 }
 
-// OPERATORS
 inline
-Scene& Scene::operator=( const Scene& other )
+const TickGroup& Scene::tickGroup( uint32 group ) const
 {
-    _objects = other._objects;
-    return *this;
+    assert( group < MAX_TICK_GROUPS );
+    return _tickGroups[group];
+}
+
+inline
+TickGroup& Scene::tickGroup( uint32 group )
+{
+    assert( group < MAX_TICK_GROUPS );
+    return _tickGroups[group];
 }
 
-// MEMBER FUNCTIONS
 inline
-void Scene::addObject( Object* object )
+const cntr::DynamicArray<Object*>& Scene::unboundedObjects() const
 {
-    _objects.push( object );
+    return _unboundedObjects;
 }
 
 inline
-void Scene::removeObject( Object* object )
+uint32 Scene::indexedObjectCount() const
 {
-    _objects.remove( object );
+    return _trees[0].proxyCount() + _trees[1].proxyCount() +
+           _hash.proxyCount();
 }
 
+// MUTATOR FUNCTIONS
+inline
+void Scene::setThreadPool( util::ThreadPool* threadPool )
+{
+    _threadPool = threadPool;
+}
+
+inline
+void Scene::setFrameStats( util::FrameStats* frameStats )
+{
+    _frameStats = frameStats;
+}
+
+inline
+void Scene::setIndexMargin( float margin )
+{
+    _trees[DYNAMIC_TREE - STATIC_TREE].setMargin( margin );
+}
+
+inline
+void Scene::setHashCellSize( float cellSize )
+{
+    _hash.setCellSize( cellSize );
+    _hash.rebuild();
+}
+
+// MEMBER FUNCTIONS
 inline
 const cntr::DynamicArray<Object *>& Scene::getObjects() const
 {
@@ -0,0 +1,486 @@
+// spatial_hash.cpp
+#include "spatial_hash.h"
+
+#include <utility>
+
+#include "demo/utility/thread_pool.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+// CONSTANTS
+constexpr uint32 SpatialHash::NO_PROXY;
+constexpr uint32 SpatialHash::NO_ITEM;
+constexpr uint64 SpatialHash::NO_KEY;
+constexpr uint32 SpatialHash::FREE_PROXY;
+constexpr uint32 SpatialHash::COORD_BITS;
+constexpr int32 SpatialHash::MAX_COORD;
+constexpr uint32 SpatialHash::MIN_TABLE_SIZE;
+constexpr uint32 SpatialHash::REBALANCE_RATIO;
+constexpr uint32 SpatialHash::PAIR_BATCH_SIZE;
+
+// HELPER FUNCTIONS
+uint32 SpatialHash::insertCell( uint64 key )
+{
+    uint32 cell = findCell( key );
+    if ( cell != NO_ITEM )
+    {
+        return cell;
+    }
+
+    // the table is kept at most half full so probes stay short
+    if ( ( _cellCount + 1 ) * 2 > _cells.size() )
+    {
+        growTable();
+    }
+
+    uint32 mask = _cells.size() - 1;
+    cell = static_cast<uint32>( util::HashUtils::mix64( key ) ) & mask;
+    while ( _cells[cell].key != NO_KEY )
+    {
+        cell = ( cell + 1 ) & mask;
+    }
+
+    _cells[cell] = Cell{ key, NO_ITEM, 0 };
+    ++_cellCount;
+    return cell;
+}
+
+void SpatialHash::growTable()
+{
+    cntr::DynamicArray<Cell> cells( _cells );
+    uint32 size = _cells.size() * 2;
+    _cells.clear();
+    for ( uint32 i = 0; i < size; ++i )
+    {
+        _cells.push( Cell{ NO_KEY, NO_ITEM, 0 } );
+    }
+
+    // the items link to each other rather than to their cells, so the
+    // cells can move without touching them
+    uint32 mask = size - 1;
+    for ( uint32 i = 0; i < cells.size(); ++i )
+    {
+        if ( cells[i].key == NO_KEY )
+        {
+            continue;
+        }
+
+        uint32 cell = static_cast<uint32>(
+            util::HashUtils::mix64( cells[i].key ) ) & mask;
+        while ( _cells[cell].key != NO_KEY )
+        {
+            cell = ( cell + 1 ) & mask;
+        }
+        _cells[cell] = cells[i];
+    }
+}
+
+void SpatialHash::link( uint32 item, uint32 cell )
+{
+    _items[item].next = _cells[cell].first;
+    _cells[cell].first = item;
+    if ( _cells[cell].count++ == 0 )
+    {
+        ++_occupiedCount;
+    }
+}
+
+void SpatialHash::unlink( uint32 item, uint32 cell )
+{
+    uint32* link = &_cells[cell].first;
+    while ( *link != item )
+    {
+        link = &_items[*link].next;
+    }
+    *link = _items[item].next;
+
+    if ( --_cells[cell].count == 0 )
+    {
+        --_occupiedCount;
+    }
+}
+
+void SpatialHash::include( const glm::vec3& min, const glm::vec3& max )
+{
+    _min = glm::min( _min, min );
+    _max = glm::max( _max, max );
+
+    glm::vec3 extents = ( max - min ) * 0.5f;
+    _maxExtent = std::max( _maxExtent, std::max( extents.x,
+                                                 std::max( extents.y,
+                                                           extents.z ) ) );
+}
+
+void SpatialHash::findPairs( uint32 cell, int32 reach, float distanceSq,
+                             cntr::DynamicArray<Pair>* pairs ) const
+{
+    const Cell& home = _cells[cell];
+    if ( home.count == 0 )
+    {
+        return;
+    }
+
+    const Item* items = &_items[0];
+    for ( uint32 a = home.first; a != NO_ITEM; a = items[a].next )
+    {
+        for ( uint32 b = items[a].next; b != NO_ITEM; b = items[b].next )
+        {
+            if ( isNear( items[a], items[b], distanceSq ) )
+            {
+                pairs->push( Pair{ items[a].proxy, items[b].proxy } );
+            }
+        }
+    }
+
+    // only the cells after this one in z, then y, then x order are compared
+    // with it, so each pair of cells is compared once
+    int32 coords[3];
+    coordsOf( home.key, coords );
+    for ( int32 dz = 0; dz <= reach; ++dz )
+    {
+        for ( int32 dy = dz == 0 ? 0 : -reach; dy <= reach; ++dy )
+        {
+            for ( int32 dx = dz == 0 && dy == 0 ? 1 : -reach;
+                  dx <= reach;
+                  ++dx )
+            {
+                uint32 other = findCell( keyOf( coords[0] + dx,
+                                                coords[1] + dy,
+                                                coords[2] + dz ) );
+                if ( other == NO_ITEM || _cells[other].count == 0 )
+                {
+                    continue;
+                }
+
+                for ( uint32 a = home.first; a != NO_ITEM; a = items[a].next )
+                {
+                    for ( uint32 b = _cells[other].first;
+                          b != NO_ITEM;
+                          b = items[b].next )
+                    {
+                        if ( isNear( items[a], items[b], distanceSq ) )
+                        {
+                            pairs->push( Pair{ items[a].proxy,
+                                               items[b].proxy } );
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// MUTATOR FUNCTIONS
+void SpatialHash::setCellSize( float cellSize )
+{
+    _cellSize = cellSize;
+    _isDirty = true;
+}
+
+// MEMBER FUNCTIONS
+uint32 SpatialHash::createProxy( const rndr::Bounds& bounds )
+{
+    uint32 proxy = _freeProxy;
+    if ( proxy == NO_PROXY )
+    {
+        proxy = _proxyItems.size();
+        _proxyItems.push( NO_ITEM );
+    }
+    else
+    {
+        uint32 next = _proxyItems[proxy];
+        _freeProxy = next == NO_PROXY ? NO_PROXY : next & ~FREE_PROXY;
+    }
+
+    uint32 item = _items.size();
+    _items.push( Item{ bounds.min(), proxy, bounds.max(), NO_ITEM } );
+    _proxyItems[proxy] = item;
+    include( bounds.min(), bounds.max() );
+
+    if ( !_isDirty )
+    {
+        link( item, insertCell( keyOf( bounds.min(), bounds.max() ) ) );
+    }
+
+    return proxy;
+}
+
+void SpatialHash::destroyProxy( uint32 proxy )
+{
+    uint32 item = _proxyItems[proxy];
+    assert( ( item & FREE_PROXY ) == 0 );
+
+    if ( !_isDirty )
+    {
+        unlink( item, findCell( keyOf( _items[item].min, _items[item].max ) ) );
+    }
+
+    // the last item fills the hole, and whatever linked to it links to the
+    // hole instead
+    uint32 last = _items.size() - 1;
+    if ( item != last )
+    {
+        if ( !_isDirty )
+        {
+            uint32 cell = findCell( keyOf( _items[last].min,
+                                           _items[last].max ) );
+            uint32* link = &_cells[cell].first;
+            while ( *link != last )
+            {
+                link = &_items[*link].next;
+            }
+            *link = item;
+        }
+
+        _items[item] = _items[last];
+        _proxyItems[_items[item].proxy] = item;
+    }
+    _items.pop();
+
+    _proxyItems[proxy] = _freeProxy == NO_PROXY ?
+                         NO_PROXY : _freeProxy | FREE_PROXY;
+    _freeProxy = proxy;
+}
+
+bool SpatialHash::moveProxy( uint32 proxy, const rndr::Bounds& bounds )
+{
+    uint32 index = _proxyItems[proxy];
+    Item& item = _items[index];
+    uint64 oldKey = keyOf( item.min, item.max );
+    uint64 newKey = keyOf( bounds.min(), bounds.max() );
+
+    item.min = bounds.min();
+    item.max = bounds.max();
+    include( bounds.min(), bounds.max() );
+
+    if ( oldKey == newKey )
+    {
+        return false;
+    }
+
+    if ( !_isDirty )
+    {
+        unlink( index, findCell( oldKey ) );
+        link( index, insertCell( newKey ) );
+    }
+
+    return true;
+}
+
+void SpatialHash::invalidate()
+{
+    _isDirty = true;
+}
+
+void SpatialHash::rebuild()
+{
+    // start from an empty table with room for a cell per box, so it never
+    // grows while the cells are being counted
+    uint32 size = MIN_TABLE_SIZE;
+    while ( size < _items.size() * 2 )
+    {
+        size *= 2;
+    }
+
+    _cells.clear();
+    for ( uint32 i = 0; i < size; ++i )
+    {
+        _cells.push( Cell{ NO_KEY, NO_ITEM, 0 } );
+    }
+    _cellCount = 0;
+    _occupiedCount = 0;
+    _maxExtent = 0.0f;
+    _min = glm::vec3( INFINITY );
+    _max = glm::vec3( -INFINITY );
+
+    // count the boxes of each cell
+    _itemCells.clear();
+    for ( uint32 i = 0; i < _items.size(); ++i )
+    {
+        const Item& item = _items[i];
+        include( item.min, item.max );
+
+        uint32 cell = insertCell( keyOf( item.min, item.max ) );
+        ++_cells[cell].count;
+        _itemCells.push( cell );
+    }
+    assert( _cells.size() == size );
+
+    // give each cell a run of the sorted boxes
+    uint32 offset = 0;
+    for ( uint32 cell = 0; cell < _cells.size(); ++cell )
+    {
+        if ( _cells[cell].count > 0 )
+        {
+            ++_occupiedCount;
+            _cells[cell].first = offset;
+            offset += _cells[cell].count;
+        }
+    }
+
+    // place the boxes, with each cell's first as its cursor
+    _sortedItems.clear();
+    for ( uint32 i = 0; i < _items.size(); ++i )
+    {
+        _sortedItems.push( Item() );
+    }
+
+    for ( uint32 i = 0; i < _items.size(); ++i )
+    {
+        uint32 slot = _cells[_itemCells[i]].first++;
+        _sortedItems[slot] = _items[i];
+        _proxyItems[_items[i].proxy] = slot;
+    }
+    std::swap( _items, _sortedItems );
+
+    // link the boxes of each cell in order
+    for ( uint32 cell = 0; cell < _cells.size(); ++cell )
+    {
+        uint32 count = _cells[cell].count;
+        if ( count == 0 )
+        {
+            continue;
+        }
+
+        uint32 end = _cells[cell].first;
+        uint32 first = end - count;
+        _cells[cell].first = first;
+        for ( uint32 item = first; item < end; ++item )
+        {
+            _items[item].next = item + 1 < end ? item + 1 : NO_ITEM;
+        }
+    }
+
+    _isDirty = false;
+}
+
+bool SpatialHash::rebalance()
+{
+    if ( _cellCount * 2 <= MIN_TABLE_SIZE ||
+         _cellCount <= _occupiedCount * REBALANCE_RATIO )
+    {
+        return false;
+    }
+
+    rebuild();
+    return true;
+}
+
+void SpatialHash::clear()
+{
+    _items.clear();
+    _proxyItems.clear();
+    _cells.clear();
+    for ( uint32 i = 0; i < MIN_TABLE_SIZE; ++i )
+    {
+        _cells.push( Cell{ NO_KEY, NO_ITEM, 0 } );
+    }
+
+    _cellCount = 0;
+    _occupiedCount = 0;
+    _freeProxy = NO_PROXY;
+    _maxExtent = 0.0f;
+    _min = glm::vec3( INFINITY );
+    _max = glm::vec3( -INFINITY );
+    _isDirty = false;
+}
+
+SpatialHash::RayHit SpatialHash::raycast( const Ray& ray ) const
+{
+    RayHit hit = { NO_PROXY, ray.maxDistance };
+    raycast( ray, [&hit]( uint32 proxy, float distance ) {
+        if ( hit.proxy == NO_PROXY || distance < hit.distance )
+        {
+            hit.proxy = proxy;
+            hit.distance = distance;
+        }
+        return hit.distance;
+    } );
+
+    return hit;
+}
+
+void SpatialHash::queryPairs( float distance,
+                              cntr::DynamicArray<Pair>* pairs,
+                              util::ThreadPool* threadPool ) const
+{
+    assert( !_isDirty );
+
+    pairs->clear();
+    if ( _items.size() == 0 )
+    {
+        return;
+    }
+
+    const Item* items = &_items[0];
+    float distanceSq = distance * distance;
+
+    // boxes whose centers are this many cells apart may still be near
+    int32 reach = static_cast<int32>(
+        std::ceil( ( distance + 2.0f * _maxExtent ) / _cellSize ) );
+    uint64 side = 2 * static_cast<uint64>( reach ) + 1;
+
+    // looking up more cells than there are boxes is slower than testing
+    // every pair
+    if ( side * side * side / 2 > _items.size() )
+    {
+        for ( uint32 a = 0; a < _items.size(); ++a )
+        {
+            for ( uint32 b = a + 1; b < _items.size(); ++b )
+            {
+                if ( isNear( items[a], items[b], distanceSq ) )
+                {
+                    pairs->push( Pair{ items[a].proxy, items[b].proxy } );
+                }
+            }
+        }
+        return;
+    }
+
+    uint32 batchCount = ( _cells.size() + PAIR_BATCH_SIZE - 1 ) /
+                        PAIR_BATCH_SIZE;
+    if ( threadPool == nullptr || batchCount < 2 )
+    {
+        for ( uint32 cell = 0; cell < _cells.size(); ++cell )
+        {
+            findPairs( cell, reach, distanceSq, pairs );
+        }
+        return;
+    }
+
+    // each batch of the table finds its pairs into its own array, and the
+    // arrays are joined in order after
+    while ( _batchPairs.size() < batchCount )
+    {
+        _batchPairs.push( cntr::DynamicArray<Pair>() );
+    }
+
+    threadPool->parallelFor( batchCount, [&]( uint32 batch ) {
+        cntr::DynamicArray<Pair>* batchPairs = &_batchPairs[batch];
+        batchPairs->clear();
+
+        uint32 end = std::min( ( batch + 1 ) * PAIR_BATCH_SIZE,
+                               _cells.size() );
+        for ( uint32 cell = batch * PAIR_BATCH_SIZE; cell < end; ++cell )
+        {
+            findPairs( cell, reach, distanceSq, batchPairs );
+        }
+    } );
+
+    for ( uint32 batch = 0; batch < batchCount; ++batch )
+    {
+        const cntr::DynamicArray<Pair>& batchPairs = _batchPairs[batch];
+        for ( uint32 i = 0; i < batchPairs.size(); ++i )
+        {
+            pairs->push( batchPairs[i] );
+        }
+    }
+}
+
+} // End nspc obj
+
+} // End nspc demo
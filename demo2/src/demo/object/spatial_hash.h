@@ -0,0 +1,930 @@
+// spatial_hash.h
+//
+// A uniform grid over boxes, for finding what is near something when most of
+// the boxes move every frame.
+//
+// Each box is a proxy with an id that stays the same for as long as it
+// exists. A box belongs to the one cell its center is in, so moving a box
+// within its cell only rewrites the box and moving it to another cell only
+// relinks it; nothing is ever rebuilt to keep up. Queries look in every cell
+// whose boxes could reach what they are looking for, which is as far as the
+// largest box reaches past its cell, so the grid works best when the cells
+// are at least as big as the boxes.
+//
+// Only the cells that hold something exist. They are kept in an open
+// addressing table keyed by their quantized coordinates, and each one links
+// its boxes together. A rebuild sorts the boxes by cell with a counting sort
+// so the boxes of each cell sit next to each other, which is what queries
+// read fastest; moving boxes to other cells slowly undoes this until the
+// next rebuild. Invalidating the grid stops it from being kept up to date
+// until the next rebuild, which makes moving every box and then rebuilding
+// each frame cheaper than moving them one at a time.
+//
+// Queries only read the grid, so any number of them may run at once, apart
+// from queryPairs spread across a thread pool, which keeps the pairs of each
+// batch in the grid.
+//
+#ifndef DEMO_SPATIAL_HASH_H
+#define DEMO_SPATIAL_HASH_H
+
+#include <assert.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/intdef.h"
+#include "demo/object/bvh.h"
+#include "demo/render/bounds.h"
+#include "demo/render/frustum.h"
+#include "demo/utility/hash_utils.h"
+
+namespace demo
+{
+
+namespace util
+{
+
+class ThreadPool;
+
+} // End nspc util
+
+namespace obj
+{
+
+class SpatialHash
+{
+  public:
+    // CONSTANTS
+    /**
+     * The id of no proxy.
+     */
+    static constexpr uint32 NO_PROXY = 0xFFFFFFFF;
+
+    // TYPES
+    /**
+     * A ray to cast through the grid.
+     */
+    typedef Bvh::Ray Ray;
+
+    /**
+     * The closest box a ray hit.
+     */
+    typedef Bvh::RayHit RayHit;
+
+    /**
+     * Two proxies whose boxes are near each other.
+     */
+    struct Pair
+    {
+        uint32 first;
+        uint32 second;
+    };
+
+  private:
+    // CONSTANTS
+    /**
+     * The index of no item.
+     */
+    static constexpr uint32 NO_ITEM = 0xFFFFFFFF;
+
+    /**
+     * The key of an unused entry of the cell table.
+     */
+    static constexpr uint64 NO_KEY = 0xFFFFFFFFFFFFFFFFULL;
+
+    /**
+     * The bit that marks a proxy as free.
+     */
+    static constexpr uint32 FREE_PROXY = 0x80000000;
+
+    /**
+     * The number of bits of each coordinate in a cell key.
+     */
+    static constexpr uint32 COORD_BITS = 21;
+
+    /**
+     * The largest distance in cells from the origin on any axis. Boxes
+     * farther out share the cells at the edge.
+     */
+    static constexpr int32 MAX_COORD = ( 1 << ( COORD_BITS - 1 ) ) - 1;
+
+    /**
+     * The fewest entries the cell table has.
+     */
+    static constexpr uint32 MIN_TABLE_SIZE = 64;
+
+    /**
+     * The number of cells in the table, as a multiple of the ones that hold
+     * something, past which rebalance rebuilds the grid.
+     */
+    static constexpr uint32 REBALANCE_RATIO = 2;
+
+    /**
+     * The number of entries of the cell table in each batch that queryPairs
+     * spreads across threads.
+     */
+    static constexpr uint32 PAIR_BATCH_SIZE = 4096;
+
+    // TYPES
+    /**
+     * A box and the next box in its cell.
+     */
+    struct Item
+    {
+        glm::vec3 min;
+        uint32 proxy;
+        glm::vec3 max;
+        uint32 next;
+    };
+
+    /**
+     * The boxes whose centers are in a cell.
+     */
+    struct Cell
+    {
+        uint64 key;
+        uint32 first;
+        uint32 count;
+    };
+
+    // MEMBERS
+    /**
+     * The boxes, those of each cell together after a rebuild.
+     */
+    cntr::DynamicArray<Item> _items;
+
+    /**
+     * The boxes being sorted by a rebuild.
+     */
+    cntr::DynamicArray<Item> _sortedItems;
+
+    /**
+     * The item of each proxy, or the next free proxy marked as free.
+     */
+    cntr::DynamicArray<uint32> _proxyItems;
+
+    /**
+     * The cell of each item during a rebuild.
+     */
+    cntr::DynamicArray<uint32> _itemCells;
+
+    /**
+     * The cell table, whose size is a power of two.
+     */
+    cntr::DynamicArray<Cell> _cells;
+
+    /**
+     * The number of cells in the table.
+     */
+    uint32 _cellCount;
+
+    /**
+     * The number of cells that hold at least one box.
+     */
+    uint32 _occupiedCount;
+
+    /**
+     * The first free proxy.
+     */
+    uint32 _freeProxy;
+
+    /**
+     * The size of a cell on each axis.
+     */
+    float _cellSize;
+
+    /**
+     * The largest distance a box reaches from its center on any axis since
+     * the last rebuild.
+     */
+    float _maxExtent;
+
+    /**
+     * The corner with the smallest coordinates of a box around every box
+     * since the last rebuild.
+     */
+    glm::vec3 _min;
+
+    /**
+     * The corner with the largest coordinates of a box around every box
+     * since the last rebuild.
+     */
+    glm::vec3 _max;
+
+    /**
+     * Whether the cells are out of date until the next rebuild.
+     */
+    bool _isDirty;
+
+    /**
+     * The pairs found by each batch of a threaded queryPairs.
+     */
+    mutable cntr::DynamicArray<cntr::DynamicArray<Pair>> _batchPairs;
+
+    // HELPER FUNCTIONS
+    /**
+     * Get the coordinates of the cell a point is in.
+     * @param point The point.
+     * @param coords The coordinates.
+     */
+    void coordsOf( const glm::vec3& point, int32* coords ) const;
+
+    /**
+     * Get the key of the cell with the given coordinates.
+     * @param x The x coordinate.
+     * @param y The y coordinate.
+     * @param z The z coordinate.
+     * @return The key.
+     */
+    static uint64 keyOf( int32 x, int32 y, int32 z );
+
+    /**
+     * Get the key of the cell a box's center is in.
+     * @param min The box's min.
+     * @param max The box's max.
+     * @return The key.
+     */
+    uint64 keyOf( const glm::vec3& min, const glm::vec3& max ) const;
+
+    /**
+     * Get the coordinates of the cell with the given key.
+     * @param key The key.
+     * @param coords The coordinates.
+     */
+    static void coordsOf( uint64 key, int32* coords );
+
+    /**
+     * Get the cell with the given key.
+     * @param key The key.
+     * @return The index of the cell in the table or NO_ITEM for none.
+     */
+    uint32 findCell( uint64 key ) const;
+
+    /**
+     * Get the cell with the given key, adding it if there is none.
+     * @param key The key.
+     * @return The index of the cell in the table.
+     */
+    uint32 insertCell( uint64 key );
+
+    /**
+     * Double the size of the cell table.
+     */
+    void growTable();
+
+    /**
+     * Add an item to a cell.
+     * @param item The item.
+     * @param cell The index of the cell in the table.
+     */
+    void link( uint32 item, uint32 cell );
+
+    /**
+     * Remove an item from a cell.
+     * @param item The item.
+     * @param cell The index of the cell in the table.
+     */
+    void unlink( uint32 item, uint32 cell );
+
+    /**
+     * Grow the reach of the boxes and the box around them to take in a box.
+     * @param min The box's min.
+     * @param max The box's max.
+     */
+    void include( const glm::vec3& min, const glm::vec3& max );
+
+    /**
+     * Find the pairs of near boxes in a cell and between it and the cells
+     * after it.
+     * @param cell The index of the cell in the table.
+     * @param reach The distance in cells that boxes may be near across.
+     * @param distanceSq The square of the distance.
+     * @param pairs The array the pairs are added to.
+     */
+    void findPairs( uint32 cell, int32 reach, float distanceSq,
+                    cntr::DynamicArray<Pair>* pairs ) const;
+
+    /**
+     * Visit the items in the cells whose boxes may overlap a box that pass
+     * a test.
+     * @param min The box's min.
+     * @param max The box's max.
+     * @param test The test, which takes an item's min and max.
+     * @param visit The function called with each proxy.
+     */
+    template <typename Test, typename Visitor>
+    void query( const glm::vec3& min, const glm::vec3& max, const Test& test,
+                const Visitor& visit ) const;
+
+    /**
+     * Visit the items of a block of cells whose boxes a ray hits.
+     * @param first The coordinates of the first corner of the block.
+     * @param last The coordinates of the last corner of the block.
+     * @param ray The ray.
+     * @param inverse One over each component of the ray's direction.
+     * @param maxDistance The farthest distance still of interest, which is
+     * updated by the visits.
+     * @param visit The function called with each proxy and the distance to
+     * its box.
+     */
+    template <typename Visitor>
+    void castBlock( const int32* first, const int32* last, const Ray& ray,
+                    const glm::vec3& inverse, float* maxDistance,
+                    const Visitor& visit ) const;
+
+    /**
+     * Check if two boxes are no farther apart than a distance.
+     * @param a The first box.
+     * @param b The second box.
+     * @param distanceSq The square of the distance.
+     * @return Are they near?
+     */
+    static bool isNear( const Item& a, const Item& b, float distanceSq );
+
+    // HIDDEN FUNCTIONS
+    SpatialHash( const SpatialHash& other ) = delete;
+
+    SpatialHash& operator=( const SpatialHash& other ) = delete;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct an empty grid.
+     * @param cellSize The size of a cell on each axis.
+     */
+    explicit SpatialHash( float cellSize = 4.0f );
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the number of proxies.
+     * @return The number of proxies.
+     */
+    uint32 proxyCount() const;
+
+    /**
+     * Get the box of a proxy.
+     * @param proxy The proxy.
+     * @return The box.
+     */
+    rndr::Bounds bounds( uint32 proxy ) const;
+
+    /**
+     * Get the size of a cell on each axis.
+     * @return The cell size.
+     */
+    float cellSize() const;
+
+    /**
+     * Get the number of cells that hold at least one box.
+     * @return The number of cells.
+     */
+    uint32 cellCount() const;
+
+    /**
+     * Get the average number of boxes in a cell that holds any.
+     * @return The average.
+     */
+    float averageOccupancy() const;
+
+    /**
+     * Check if the cells are out of date until the next rebuild.
+     * @return Is it dirty?
+     */
+    bool isDirty() const;
+
+    // MUTATOR FUNCTIONS
+    /**
+     * Set the size of a cell on each axis.
+     * The grid must be rebuilt before it is next queried.
+     * @param cellSize The cell size.
+     */
+    void setCellSize( float cellSize );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Add a box.
+     * @param bounds The box.
+     * @return The proxy.
+     */
+    uint32 createProxy( const rndr::Bounds& bounds );
+
+    /**
+     * Remove a box.
+     * @param proxy The proxy.
+     */
+    void destroyProxy( uint32 proxy );
+
+    /**
+     * Move a box.
+     * @param proxy The proxy.
+     * @param bounds The new box.
+     * @return Did it change cells?
+     */
+    bool moveProxy( uint32 proxy, const rndr::Bounds& bounds );
+
+    /**
+     * Stop keeping the cells up to date until the next rebuild.
+     */
+    void invalidate();
+
+    /**
+     * Sort every box into its cell again.
+     */
+    void rebuild();
+
+    /**
+     * Rebuild the grid if enough cells have emptied out that they slow
+     * down queries.
+     * @return Was it rebuilt?
+     */
+    bool rebalance();
+
+    /**
+     * Remove every box.
+     */
+    void clear();
+
+    /**
+     * Visit the proxies whose boxes overlap a box.
+     * @param bounds The box.
+     * @param visit The function called with each proxy.
+     */
+    template <typename Visitor>
+    void queryBox( const rndr::Bounds& bounds, const Visitor& visit ) const;
+
+    /**
+     * Visit the proxies whose boxes overlap a sphere.
+     * @param center The center of the sphere.
+     * @param radius The radius of the sphere.
+     * @param visit The function called with each proxy.
+     */
+    template <typename Visitor>
+    void querySphere( const glm::vec3& center, float radius,
+                      const Visitor& visit ) const;
+
+    /**
+     * Visit the proxies whose boxes are at least partly inside a frustum.
+     * Every cell that holds a box is tested, so this is slower than
+     * querying a tree.
+     * @param frustum The frustum.
+     * @param visit The function called with each proxy.
+     */
+    template <typename Visitor>
+    void queryFrustum( const rndr::Frustum& frustum,
+                       const Visitor& visit ) const;
+
+    /**
+     * Visit the proxies whose boxes a ray hits, walking the cells along it
+     * from nearest to farthest.
+     * @param ray The ray.
+     * @param visit The function called with each proxy and the distance to
+     * its box, which returns the farthest distance still of interest: the
+     * distance to stop at the closest hit or the ray's to find every hit.
+     */
+    template <typename Visitor>
+    void raycast( const Ray& ray, const Visitor& visit ) const;
+
+    /**
+     * Find the closest box a ray hits.
+     * @param ray The ray.
+     * @return The hit, whose proxy is NO_PROXY for none.
+     */
+    RayHit raycast( const Ray& ray ) const;
+
+    /**
+     * Find every pair of boxes no farther apart than a distance.
+     * Each cell is compared with the cells on one side of it, so each pair
+     * is found once. Spreading the cells across threads uses scratch of the
+     * grid, so only one threaded search may run at a time.
+     * @param distance The distance.
+     * @param pairs The pairs found.
+     * @param threadPool The threads to spread the cells across or nullptr
+     * to search on the calling thread.
+     */
+    void queryPairs( float distance, cntr::DynamicArray<Pair>* pairs,
+                     util::ThreadPool* threadPool ) const;
+};
+
+// HELPER FUNCTIONS
+inline
+void SpatialHash::coordsOf( const glm::vec3& point, int32* coords ) const
+{
+    for ( uint32 axis = 0; axis < 3; ++axis )
+    {
+        float coord = std::floor( point[axis] / _cellSize );
+        coord = coord < -MAX_COORD ? -MAX_COORD : coord;
+        coord = coord > MAX_COORD ? MAX_COORD : coord;
+        coords[axis] = static_cast<int32>( coord );
+    }
+}
+
+inline
+uint64 SpatialHash::keyOf( int32 x, int32 y, int32 z )
+{
+    const uint64 mask = ( 1ULL << COORD_BITS ) - 1;
+    return ( static_cast<uint64>( x + MAX_COORD ) & mask ) |
+           ( ( static_cast<uint64>( y + MAX_COORD ) & mask ) << COORD_BITS ) |
+           ( ( static_cast<uint64>( z + MAX_COORD ) & mask ) <<
+             ( 2 * COORD_BITS ) );
+}
+
+inline
+uint64 SpatialHash::keyOf( const glm::vec3& min, const glm::vec3& max ) const
+{
+    int32 coords[3];
+    coordsOf( ( min + max ) * 0.5f, coords );
+    return keyOf( coords[0], coords[1], coords[2] );
+}
+
+inline
+void SpatialHash::coordsOf( uint64 key, int32* coords )
+{
+    const uint64 mask = ( 1ULL << COORD_BITS ) - 1;
+    for ( uint32 axis = 0; axis < 3; ++axis )
+    {
+        coords[axis] = static_cast<int32>( ( key >> ( axis * COORD_BITS ) ) &
+                                           mask ) - MAX_COORD;
+    }
+}
+
+inline
+uint32 SpatialHash::findCell( uint64 key ) const
+{
+    uint32 mask = _cells.size() - 1;
+    uint32 cell = static_cast<uint32>( util::HashUtils::mix64( key ) ) & mask;
+    while ( _cells[cell].key != key )
+    {
+        if ( _cells[cell].key == NO_KEY )
+        {
+            return NO_ITEM;
+        }
+        cell = ( cell + 1 ) & mask;
+    }
+
+    return cell;
+}
+
+inline
+bool SpatialHash::isNear( const Item& a, const Item& b, float distanceSq )
+{
+    float total = 0.0f;
+    for ( uint32 axis = 0; axis < 3; ++axis )
+    {
+        float gap = std::max( a.min[axis] - b.max[axis],
+                              b.min[axis] - a.max[axis] );
+        total += gap > 0.0f ? gap * gap : 0.0f;
+    }
+
+    return total <= distanceSq;
+}
+
+template <typename Test, typename Visitor>
+void SpatialHash::query( const glm::vec3& min, const glm::vec3& max,
+                         const Test& test, const Visitor& visit ) const
+{
+    assert( !_isDirty );
+
+    if ( _items.size() == 0 )
+    {
+        return;
+    }
+
+    const Item* items = &_items[0];
+
+    // the boxes in cells farther out than the largest reach cannot overlap
+    int32 first[3];
+    int32 last[3];
+    coordsOf( glm::max( min, _min ) - _maxExtent, first );
+    coordsOf( glm::min( max, _max ) + _maxExtent, last );
+
+    uint64 cellCount = 1;
+    for ( uint32 axis = 0; axis < 3; ++axis )
+    {
+        if ( last[axis] < first[axis] )
+        {
+            return;
+        }
+        cellCount *= static_cast<uint64>( last[axis] - first[axis] + 1 );
+    }
+
+    // looking up more cells than there are boxes is slower than testing
+    // every box
+    if ( cellCount > _items.size() )
+    {
+        for ( uint32 i = 0; i < _items.size(); ++i )
+        {
+            if ( test( items[i].min, items[i].max ) )
+            {
+                visit( items[i].proxy );
+            }
+        }
+        return;
+    }
+
+    for ( int32 z = first[2]; z <= last[2]; ++z )
+    {
+        for ( int32 y = first[1]; y <= last[1]; ++y )
+        {
+            for ( int32 x = first[0]; x <= last[0]; ++x )
+            {
+                uint32 cell = findCell( keyOf( x, y, z ) );
+                if ( cell == NO_ITEM )
+                {
+                    continue;
+                }
+
+                for ( uint32 item = _cells[cell].first;
+                      item != NO_ITEM;
+                      item = items[item].next )
+                {
+                    if ( test( items[item].min, items[item].max ) )
+                    {
+                        visit( items[item].proxy );
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename Visitor>
+void SpatialHash::castBlock( const int32* first, const int32* last,
+                             const Ray& ray, const glm::vec3& inverse,
+                             float* maxDistance, const Visitor& visit ) const
+{
+    const Item* items = &_items[0];
+    for ( int32 z = first[2]; z <= last[2]; ++z )
+    {
+        for ( int32 y = first[1]; y <= last[1]; ++y )
+        {
+            for ( int32 x = first[0]; x <= last[0]; ++x )
+            {
+                uint32 cell = findCell( keyOf( x, y, z ) );
+                if ( cell == NO_ITEM )
+                {
+                    continue;
+                }
+
+                for ( uint32 item = _cells[cell].first;
+                      item != NO_ITEM;
+                      item = items[item].next )
+                {
+                    float distance = Bvh::intersect( items[item].min,
+                                                     items[item].max,
+                                                     ray.origin, inverse,
+                                                     *maxDistance );
+                    if ( distance >= 0.0f )
+                    {
+                        *maxDistance = visit( items[item].proxy, distance );
+                    }
+                }
+            }
+        }
+    }
+}
+
+// CONSTRUCTORS
+inline
+SpatialHash::SpatialHash( float cellSize )
+    : _items(), _sortedItems(), _proxyItems(), _itemCells(), _cells(),
+      _cellCount( 0 ), _occupiedCount( 0 ), _freeProxy( NO_PROXY ),
+      _cellSize( cellSize ), _maxExtent( 0.0f ), _min( INFINITY ), _max( -INFINITY ),
+      _isDirty( false )
+{
+    for ( uint32 i = 0; i < MIN_TABLE_SIZE; ++i )
+    {
+        _cells.push( Cell{ NO_KEY, NO_ITEM, 0 } );
+    }
+}
+
+// ACCESSOR FUNCTIONS
+inline
+uint32 SpatialHash::proxyCount() const
+{
+    return _items.size();
+}
+
+inline
+rndr::Bounds SpatialHash::bounds( uint32 proxy ) const
+{
+    const Item& item = _items[_proxyItems[proxy]];
+    return rndr::Bounds( item.min, item.max,
+                         glm::length( item.max - item.min ) * 0.5f );
+}
+
+inline
+float SpatialHash::cellSize() const
+{
+    return _cellSize;
+}
+
+inline
+uint32 SpatialHash::cellCount() const
+{
+    return _occupiedCount;
+}
+
+inline
+float SpatialHash::averageOccupancy() const
+{
+    return _occupiedCount == 0 ?
+           0.0f : static_cast<float>( _items.size() ) / _occupiedCount;
+}
+
+inline
+bool SpatialHash::isDirty() const
+{
+    return _isDirty;
+}
+
+// MEMBER FUNCTIONS
+template <typename Visitor>
+void SpatialHash::queryBox( const rndr::Bounds& bounds,
+                            const Visitor& visit ) const
+{
+    const glm::vec3& queryMin = bounds.min();
+    const glm::vec3& queryMax = bounds.max();
+    query( queryMin, queryMax,
+           [&]( const glm::vec3& min, const glm::vec3& max ) {
+        return min.x <= queryMax.x && queryMin.x <= max.x &&
+               min.y <= queryMax.y && queryMin.y <= max.y &&
+               min.z <= queryMax.z && queryMin.z <= max.z;
+    }, visit );
+}
+
+template <typename Visitor>
+void SpatialHash::querySphere( const glm::vec3& center, float radius,
+                               const Visitor& visit ) const
+{
+    float radiusSq = radius * radius;
+    query( center - radius, center + radius,
+           [&]( const glm::vec3& min, const glm::vec3& max ) {
+        glm::vec3 closest = glm::clamp( center, min, max );
+        glm::vec3 offset = closest - center;
+        return glm::dot( offset, offset ) <= radiusSq;
+    }, visit );
+}
+
+template <typename Visitor>
+void SpatialHash::queryFrustum( const rndr::Frustum& frustum,
+                                const Visitor& visit ) const
+{
+    assert( !_isDirty );
+
+    if ( _items.size() == 0 )
+    {
+        return;
+    }
+
+    const Item* items = &_items[0];
+    for ( uint32 cell = 0; cell < _cells.size(); ++cell )
+    {
+        if ( _cells[cell].count == 0 )
+        {
+            continue;
+        }
+
+        // the boxes of a cell reach past it by at most the largest reach
+        int32 coords[3];
+        coordsOf( _cells[cell].key, coords );
+        glm::vec3 min( coords[0] * _cellSize, coords[1] * _cellSize,
+                       coords[2] * _cellSize );
+        if ( !frustum.intersects( rndr::Bounds( min - _maxExtent,
+                                                min + _cellSize + _maxExtent,
+                                                0.0f ) ) )
+        {
+            continue;
+        }
+
+        for ( uint32 item = _cells[cell].first;
+              item != NO_ITEM;
+              item = items[item].next )
+        {
+            if ( frustum.intersects( rndr::Bounds( items[item].min,
+                                                   items[item].max, 0.0f ) ) )
+            {
+                visit( items[item].proxy );
+            }
+        }
+    }
+}
+
+template <typename Visitor>
+void SpatialHash::raycast( const Ray& ray, const Visitor& visit ) const
+{
+    assert( !_isDirty );
+
+    if ( _items.size() == 0 )
+    {
+        return;
+    }
+
+    glm::vec3 inverse( 1.0f / ray.direction.x, 1.0f / ray.direction.y,
+                       1.0f / ray.direction.z );
+    float maxDistance = ray.maxDistance;
+
+    // only the part of the ray inside the box around every box is walked
+    float enter = Bvh::intersect( _min, _max, ray.origin, inverse,
+                                  maxDistance );
+    if ( enter < 0.0f )
+    {
+        return;
+    }
+
+    float exit = maxDistance;
+    for ( uint32 axis = 0; axis < 3; ++axis )
+    {
+        if ( ray.direction[axis] != 0.0f )
+        {
+            exit = std::min( exit, std::max(
+                ( _min[axis] - ray.origin[axis] ) * inverse[axis],
+                ( _max[axis] - ray.origin[axis] ) * inverse[axis] ) );
+        }
+    }
+
+    glm::vec3 start = ray.origin + ray.direction * enter;
+    int32 cell[3];
+    coordsOf( start, cell );
+
+    // the boxes whose centers are this many cells away may reach into the
+    // cell being walked through
+    int32 reach = static_cast<int32>( std::ceil( _maxExtent / _cellSize ) );
+
+    int32 step[3];
+    float next[3];
+    float delta[3];
+    for ( uint32 axis = 0; axis < 3; ++axis )
+    {
+        float direction = ray.direction[axis];
+        if ( direction > 0.0f )
+        {
+            step[axis] = 1;
+            next[axis] = enter + ( ( cell[axis] + 1 ) * _cellSize -
+                                   start[axis] ) / direction;
+            delta[axis] = _cellSize / direction;
+        }
+        else if ( direction < 0.0f )
+        {
+            step[axis] = -1;
+            next[axis] = enter + ( cell[axis] * _cellSize - start[axis] ) /
+                                 direction;
+            delta[axis] = -_cellSize / direction;
+        }
+        else
+        {
+            step[axis] = 0;
+            next[axis] = INFINITY;
+            delta[axis] = INFINITY;
+        }
+    }
+
+    // the block around the first cell is cast whole, and each step after
+    // only adds the face of the block it moves toward, so no cell is cast
+    // twice
+    int32 first[3];
+    int32 last[3];
+    for ( uint32 axis = 0; axis < 3; ++axis )
+    {
+        first[axis] = cell[axis] - reach;
+        last[axis] = cell[axis] + reach;
+    }
+    castBlock( first, last, ray, inverse, &maxDistance, visit );
+
+    float distance = enter;
+    while ( true )
+    {
+        uint32 axis = next[0] < next[1] ?
+                      ( next[0] < next[2] ? 0 : 2 ) :
+                      ( next[1] < next[2] ? 1 : 2 );
+        distance = next[axis];
+
+        // a box that was hit before here was found in an earlier block
+        if ( !( distance <= maxDistance ) || distance > exit ||
+             std::abs( cell[axis] ) >= MAX_COORD )
+        {
+            break;
+        }
+
+        cell[axis] += step[axis];
+        next[axis] += delta[axis];
+
+        int32 face = cell[axis] + step[axis] * reach;
+        for ( uint32 other = 0; other < 3; ++other )
+        {
+            first[other] = cell[other] - reach;
+            last[other] = cell[other] + reach;
+        }
+        first[axis] = face;
+        last[axis] = face;
+        castBlock( first, last, ray, inverse, &maxDistance, visit );
+    }
+}
+
+} // End nspc obj
+
+} // End nspc demo
+
+#endif // DEMO_SPATIAL_HASH_H
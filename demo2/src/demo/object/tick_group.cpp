@@ -0,0 +1,35 @@
+// tick_group.cpp
+#include "tick_group.h"
+
+#include <algorithm>
+
+namespace demo
+{
+
+namespace obj
+{
+
+// HELPER FUNCTIONS
+float TickGroup::advance( float dt )
+{
+    float scaledDt = dt * _timeScale;
+    _time += scaledDt;
+    _lastCost = 0.0;
+    _lastTickCount = 0;
+
+    switch ( _rate )
+    {
+        case EVERY_NTH_FRAME:
+            return 1.0f / _interval;
+
+        case FIXED_RATE:
+            return std::min( std::max( scaledDt * _frequency, 0.0f ), 1.0f );
+
+        default:
+            return 1.0f;
+    }
+}
+
+} // End nspc obj
+
+} // End nspc demo
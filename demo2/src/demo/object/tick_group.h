@@ -0,0 +1,327 @@
+// tick_group.h
+//
+// How often the objects in a tick group tick and what their ticks cost.
+//
+// A group ticks every frame, every Nth frame, at a fixed rate, or every frame
+// but only for the objects that are visible. Groups that tick less than
+// every frame do not tick all of their objects on the same frame; each frame
+// ticks its share of them in turn, so the work is spread evenly across the
+// frames in between.
+//
+// Each group keeps its own time, which advances by the scene's elapsed time
+// times the group's time scale. The scene's elapsed time is game time, which
+// is already scaled by the clock, so pausing or slowing the clock slows
+// every group with it, fixed rates included. An object's tick is given the
+// group time since it last ticked, so objects that tick less often get
+// larger steps.
+//
+#ifndef DEMO_TICK_GROUP_H
+#define DEMO_TICK_GROUP_H
+
+#include <assert.h>
+
+#include "demo/intdef.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+class TickGroup
+{
+  public:
+    // TYPES
+    /**
+     * How often the objects in the group tick.
+     */
+    enum Rate
+    {
+        EVERY_FRAME,
+        EVERY_NTH_FRAME,
+        FIXED_RATE,
+        WHEN_VISIBLE
+    };
+
+  private:
+    // FRIENDS
+    friend class Scene;
+
+    // MEMBERS
+    /**
+     * How often the objects tick.
+     */
+    Rate _rate;
+
+    /**
+     * The number of frames between ticks of an object.
+     */
+    uint32 _interval;
+
+    /**
+     * The ticks per second of an object.
+     */
+    float _frequency;
+
+    /**
+     * The factor the elapsed time is scaled by.
+     */
+    float _timeScale;
+
+    /**
+     * The group time in seconds.
+     */
+    double _time;
+
+    /**
+     * The seconds the ticks took on the last frame.
+     */
+    double _lastCost;
+
+    /**
+     * The seconds the ticks took in total.
+     */
+    double _totalCost;
+
+    /**
+     * The number of objects due to tick on the last frame.
+     */
+    uint32 _lastTickCount;
+
+    /**
+     * The number of objects due to tick in total.
+     */
+    uint64 _totalTickCount;
+
+    // HELPER FUNCTIONS
+    /**
+     * Advance the group time and get the share of the objects to tick.
+     * @param dt The elapsed time in seconds.
+     * @return The share of the objects, between 0 and 1.
+     */
+    float advance( float dt );
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct a group that ticks every frame.
+     */
+    TickGroup();
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get how often the objects tick.
+     * @return The rate.
+     */
+    Rate rate() const;
+
+    /**
+     * Get the number of frames between ticks of an object.
+     * @return The interval, which is 1 unless ticking every Nth frame.
+     */
+    uint32 interval() const;
+
+    /**
+     * Get the ticks per second of an object.
+     * @return The frequency, which is 0 unless ticking at a fixed rate.
+     */
+    float frequency() const;
+
+    /**
+     * Get the factor the elapsed time is scaled by.
+     * @return The time scale.
+     */
+    float timeScale() const;
+
+    /**
+     * Get the group time.
+     * @return The time in seconds.
+     */
+    double time() const;
+
+    /**
+     * Get the time the ticks took on the last frame.
+     * @return The cost in seconds.
+     */
+    double lastCost() const;
+
+    /**
+     * Get the time the ticks took in total.
+     * @return The cost in seconds.
+     */
+    double totalCost() const;
+
+    /**
+     * Get the number of objects due to tick on the last frame.
+     * Disabled objects and objects that are not visible when they must be
+     * are counted even though they are skipped.
+     * @return The number of ticks.
+     */
+    uint32 lastTickCount() const;
+
+    /**
+     * Get the number of objects due to tick in total.
+     * @return The number of ticks.
+     */
+    uint64 totalTickCount() const;
+
+    // MUTATOR FUNCTIONS
+    /**
+     * Tick every object every frame.
+     */
+    void setEveryFrame();
+
+    /**
+     * Tick every object once every few frames.
+     * @param interval The number of frames between ticks, at least 1.
+     */
+    void setEveryNthFrame( uint32 interval );
+
+    /**
+     * Tick every object a number of times per second of group time.
+     * An object ticks at most once per frame, so rates above the frame rate
+     * tick every frame.
+     * @param frequency The ticks per second, more than 0.
+     */
+    void setFixedRate( float frequency );
+
+    /**
+     * Tick the visible objects every frame.
+     */
+    void setWhenVisible();
+
+    /**
+     * Set the factor the elapsed time is scaled by.
+     * @param timeScale The time scale, which may be 0 to freeze the group.
+     */
+    void setTimeScale( float timeScale );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Reset the costs and tick counts.
+     */
+    void resetStats();
+};
+
+// CONSTRUCTORS
+inline
+TickGroup::TickGroup() : _rate( EVERY_FRAME ), _interval( 1 ),
+                         _frequency( 0.0f ), _timeScale( 1.0f ),
+                         _time( 0.0 ), _lastCost( 0.0 ), _totalCost( 0.0 ),
+                         _lastTickCount( 0 ), _totalTickCount( 0 )
+{
+}
+
+// ACCESSOR FUNCTIONS
+inline
+TickGroup::Rate TickGroup::rate() const
+{
+    return _rate;
+}
+
+inline
+uint32 TickGroup::interval() const
+{
+    return _interval;
+}
+
+inline
+float TickGroup::frequency() const
+{
+    return _frequency;
+}
+
+inline
+float TickGroup::timeScale() const
+{
+    return _timeScale;
+}
+
+inline
+double TickGroup::time() const
+{
+    return _time;
+}
+
+inline
+double TickGroup::lastCost() const
+{
+    return _lastCost;
+}
+
+inline
+double TickGroup::totalCost() const
+{
+    return _totalCost;
+}
+
+inline
+uint32 TickGroup::lastTickCount() const
+{
+    return _lastTickCount;
+}
+
+inline
+uint64 TickGroup::totalTickCount() const
+{
+    return _totalTickCount;
+}
+
+// MUTATOR FUNCTIONS
+inline
+void TickGroup::setEveryFrame()
+{
+    _rate = EVERY_FRAME;
+    _interval = 1;
+    _frequency = 0.0f;
+}
+
+inline
+void TickGroup::setEveryNthFrame( uint32 interval )
+{
+    assert( interval >= 1 );
+
+    _rate = EVERY_NTH_FRAME;
+    _interval = interval;
+    _frequency = 0.0f;
+}
+
+inline
+void TickGroup::setFixedRate( float frequency )
+{
+    assert( frequency > 0.0f );
+
+    _rate = FIXED_RATE;
+    _interval = 1;
+    _frequency = frequency;
+}
+
+inline
+void TickGroup::setWhenVisible()
+{
+    _rate = WHEN_VISIBLE;
+    _interval = 1;
+    _frequency = 0.0f;
+}
+
+inline
+void TickGroup::setTimeScale( float timeScale )
+{
+    _timeScale = timeScale;
+}
+
+// MEMBER FUNCTIONS
+inline
+void TickGroup::resetStats()
+{
+    _lastCost = 0.0;
+    _totalCost = 0.0;
+    _lastTickCount = 0;
+    _totalTickCount = 0;
+}
+
+} // End nspc obj
+
+} // End nspc demo
+
+#endif // DEMO_TICK_GROUP_H
@@ -28,15 +28,14 @@ void Transform::setEulerRotation( const glm::vec3& rotation )
     glm::quat roll = glm::rotate( glm::quat(), glm::radians( rotation.y ),
                                   glm::vec3( 0.0f, 1.0f, 0.0f ) );
 
-    _rotation = yaw * pitch * roll;
-    recomputeMatrix();
+    setRotation( yaw * pitch * roll );
 }
 
 // MEMBER FUNCTIONS
 void Transform::rotateEuler( const glm::vec3& rotation )
 {
     // todo: figure out why rotations are not being done in degrees
-    glm::quat rot = glm::rotate( _rotation, glm::radians( rotation.z ),
+    glm::quat rot = glm::rotate( this->rotation(), glm::radians( rotation.z ),
                                  glm::vec3( 0.0f, 0.0f, 1.0f ) );
 
     rot = glm::rotate( rot, glm::radians( rotation.x ),
@@ -44,19 +43,17 @@ void Transform::rotateEuler( const glm::vec3& rotation )
     rot = glm::rotate( rot, glm::radians( rotation.y ),
                        glm::vec3( 0.0f, 1.0f, 0.0f ) );
 
-    _rotation = rot;
-    recomputeMatrix();
+    setRotation( rot );
 }
 
 void Transform::rotateAround( const glm::vec3& point,
                               const glm::quat& rotation )
 {
-    glm::vec4 pos = rotation * glm::vec4( _position - point, 1.0f );
+    glm::vec4 pos = rotation * glm::vec4( position() - point, 1.0f );
 
-    _position = glm::vec3( pos.x / pos.w, pos.y / pos.w, pos.z / pos.w ) +
-        point;
-    _rotation *= rotation;
-    recomputeMatrix();
+    setPosition( glm::vec3( pos.x / pos.w, pos.y / pos.w, pos.z / pos.w ) +
+                 point );
+    setRotation( this->rotation() * rotation );
 }
 
 void Transform::lookAt( const glm::vec3& eye, const glm::vec3& center,
@@ -93,32 +90,11 @@ void Transform::lookAt( const glm::vec3& eye, const glm::vec3& center,
     glm::quat lookQuat = glm::angleAxis( lookAngle, lookAxis );
     glm::quat upQuat = glm::normalize( glm::quat( upAxis * upAngle ) );
 
-    _rotation = glm::quat_cast( glm::mat4_cast( lookQuat ) *
-                                glm::mat4_cast( upQuat ) );
-    _position = eye;
-
-    recomputeMatrix();
-}
-
-// HELPER FUNCTIONS
-void Transform::recomputeMatrix()
-{
-    glm::mat4 trans;
-    trans[3][0] = _position.x;
-    trans[3][1] = _position.y;
-    trans[3][2] = _position.z;
-
-    glm::mat4 rot( glm::mat4_cast( _rotation ) );
-
-    glm::mat4 scale( _scale.x, 0, 0, 0,
-                     0, _scale.y, 0, 0,
-                     0, 0, _scale.z, 0,
-                     0, 0, 0, 1 );
-
-    _matrix = trans * rot * scale;
-    _hasChanged = true;
+    setRotation( glm::quat_cast( glm::mat4_cast( lookQuat ) *
+                                 glm::mat4_cast( upQuat ) ) );
+    setPosition( eye );
 }
 
 } // End nspc obj
 
-} // End nspc demo
\ No newline at end of file
+} // End nspc demo
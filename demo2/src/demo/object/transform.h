@@ -13,12 +13,23 @@
 // Rotating about a point affects both scale and rotation.
 // Changing the rotation directly will not effect position.
 //
+// A transform is a handle to data owned by the transform system, which keeps
+// the components of every transform in arrays of their own and composes the
+// world matrices in SIMD batches. Copying a transform copies its values into a
+// new slot, while moving one hands its slot over, so a transform can be moved
+// around in component storage without losing its place in the hierarchy. The
+// world matrix includes the parent's and is recomputed by
+// TransformSystem::update.
+//
 #ifndef DEMO_TRANSFORM_H
 #define DEMO_TRANSFORM_H
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include "demo/intdef.h"
+#include "demo/object/transform_system.h"
+
 namespace demo
 {
 
@@ -30,35 +41,16 @@ class Transform
   private:
     // MEMBERS
     /**
-     * The transformation matrix.
-     */
-    glm::mat4 _matrix;
-
-    /**
-     * The rotation.
-     */
-    glm::quat _rotation;
-
-    /**
-     * The position.
-     */
-    glm::vec3 _position;
-
-    /**
-     * The scale.
-     */
-    glm::vec3 _scale;
-
-    /**
-     * Whether or not the transform has changed.
+     * The id of the data in the transform system.
      */
-    bool _hasChanged;
+    uint32 _id;
 
     // HELPER FUNCTIONS
     /**
-     * Recompute the transformation matrix.
+     * Get the transform system.
+     * @return The transform system.
      */
-    void recomputeMatrix();
+    static TransformSystem* system();
 
   public:
     // CONSTANTS
@@ -93,6 +85,13 @@ class Transform
      */
     Transform( const Transform& other );
 
+    /**
+     * Construct a transform by taking over the data of another, which is
+     * left without any.
+     * @param other The other transform.
+     */
+    Transform( Transform&& other );
+
     /**
      * Destruct the transformation matrix.
      */
@@ -108,28 +107,40 @@ class Transform
 
     // ACCESSOR FUNCTIONS
     /**
-     * Get the transformation matrix.
+     * Get the id of the data in the transform system.
+     * @return The id.
+     */
+    uint32 id() const;
+
+    /**
+     * Get the transformation matrix relative to the parent.
+     * @return The matrix.
+     */
+    glm::mat4 matrix() const;
+
+    /**
+     * Get the world matrix as of the last TransformSystem::update.
      * @return The matrix.
      */
-    const glm::mat4& matrix() const;
+    const glm::mat4& worldMatrix() const;
 
     /**
      * Get the position.
      * @return The position.
      */
-    const glm::vec3& position() const;
+    glm::vec3 position() const;
 
     /**
      * Get the rotation.
      * @return The rotation.
      */
-    const glm::quat& rotation() const;
+    glm::quat rotation() const;
 
     /**
      * Get the scale factor vector.
      * @return The scale factor vector.
      */
-    const glm::vec3& scale() const;
+    glm::vec3 scale() const;
 
     /**
      * Get the euler rotation angles.
@@ -176,7 +187,7 @@ class Transform
     float scaleZ() const;
 
     /**
-     * Check if the transform has changed since the flag was last reset.
+     * Check if the transform has changed since the last update.
      * @return Has it changed?
      */
     bool hasChanged() const;
@@ -266,6 +277,12 @@ class Transform
      */
     void setScaleZ( float scale );
 
+    /**
+     * Set the parent, making this relative to it.
+     * @param parent The parent or nullptr for none.
+     */
+    void setParent( const Transform* parent );
+
     // MEMBER FUNCTIONS
     /**
      * Translate the transform.
@@ -376,120 +393,129 @@ class Transform
     void lookAt( const glm::vec3& eye,
                  const glm::vec3& center,
                  const glm::vec3& up );
-
-    /**
-     * Reset the hasChanged flag.
-     */
-    void resetChangedFlag();
 };
 
 // CONSTRUCTORS
 inline
-Transform::Transform() : _matrix(), _position(), _scale( 1.0f, 1.0f, 1.0f ),
-                         _rotation(), _hasChanged( true )
+Transform::Transform() : _id( system()->create() )
+{
+}
+
+inline
+Transform::Transform( const Transform& other ) : _id( system()->create() )
 {
+    system()->copy( _id, other._id );
 }
 
 inline
-Transform::Transform( const Transform& other )
-    : _matrix( other._matrix ), _position( other._position ),
-      _scale( other._scale ), _rotation( other._rotation ),
-      _hasChanged( true )
+Transform::Transform( Transform&& other ) : _id( other._id )
 {
+    other._id = TransformSystem::NO_ID;
 }
 
 inline
 Transform::~Transform()
 {
+    if ( _id != TransformSystem::NO_ID )
+    {
+        system()->destroy( _id );
+    }
 }
 
 // OPERATORS
 inline
 Transform& Transform::operator=( const Transform& other )
 {
-    _matrix = other._matrix;
-    _position = other._position;
-    _rotation = other._rotation;
-    _scale = other._scale;
-    _hasChanged = true;
-
+    system()->copy( _id, other._id );
     return *this;
 }
 
 // ACCESSOR FUNCTIONS
 inline
-const glm::mat4& Transform::matrix() const
+uint32 Transform::id() const
 {
-    return _matrix;
+    return _id;
 }
 
 inline
-const glm::vec3& Transform::position() const
+glm::mat4 Transform::matrix() const
 {
-    return _position;
+    return system()->localMatrix( _id );
 }
 
 inline
-const glm::quat& Transform::rotation() const
+const glm::mat4& Transform::worldMatrix() const
 {
-    return _rotation;
+    return system()->worldMatrix( _id );
 }
 
 inline
-const glm::vec3& Transform::scale() const
+glm::vec3 Transform::position() const
 {
-    return _scale;
+    return system()->position( _id );
+}
+
+inline
+glm::quat Transform::rotation() const
+{
+    return system()->rotation( _id );
+}
+
+inline
+glm::vec3 Transform::scale() const
+{
+    return system()->scale( _id );
 }
 
 inline
 glm::vec3 Transform::eulerRotation() const
 {
-    return glm::eulerAngles( _rotation );
+    return glm::eulerAngles( rotation() );
 }
 
 inline
 glm::vec3 Transform::forward() const
 {
-    glm::vec4 dir = _rotation * glm::vec4( FORWARD, 1.0f );
+    glm::vec4 dir = rotation() * glm::vec4( FORWARD, 1.0f );
     return glm::normalize( glm::vec3( dir ) );
 }
 
 inline
 glm::vec3 Transform::up() const
 {
-    glm::vec4 dir = _rotation * glm::vec4( UP, 1.0f );
+    glm::vec4 dir = rotation() * glm::vec4( UP, 1.0f );
     return glm::normalize( glm::vec3( dir ) );
 }
 
 inline
 glm::vec3 Transform::right() const
 {
-    glm::vec4 dir = _rotation * glm::vec4( RIGHT, 1.0f );
+    glm::vec4 dir = rotation() * glm::vec4( RIGHT, 1.0f );
     return glm::normalize( glm::vec3( dir ) );
 }
 
 inline
 bool Transform::hasChanged() const
 {
-    return _hasChanged;
+    return system()->hasChanged( _id );
 }
 
 inline
 float Transform::scaleX() const
 {
-    return _scale.x;
+    return scale().x;
 }
 
 inline
 float Transform::scaleY() const
 {
-    return _scale.y;
+    return scale().y;
 }
 
 inline
 float Transform::scaleZ() const
 {
-    return _scale.z;
+    return scale().z;
 }
 
 // MUTATOR FUNCTIONS
@@ -502,8 +528,7 @@ void Transform::setPosition( float x, float y, float z )
 inline
 void Transform::setPosition( const glm::vec3& position )
 {
-    _position = position;
-    recomputeMatrix();
+    system()->setPosition( _id, position );
 }
 
 inline
@@ -515,8 +540,7 @@ void Transform::setRotation( float x, float y, float z, float r )
 inline
 void Transform::setRotation( const glm::quat& rotation )
 {
-    _rotation = rotation;
-    recomputeMatrix();
+    system()->setRotation( _id, rotation );
 }
 
 inline
@@ -528,8 +552,7 @@ void Transform::setEulerRotation( float x, float y, float z )
 inline
 void Transform::setScale( float scale )
 {
-    _scale = glm::vec3( scale, scale, scale );
-    recomputeMatrix();
+    setScale( glm::vec3( scale, scale, scale ) );
 }
 
 inline
@@ -541,29 +564,38 @@ void Transform::setScale( float xScale, float yScale, float zScale )
 inline
 void Transform::setScale( const glm::vec3& scale )
 {
-    _scale = scale;
-    recomputeMatrix();
+    system()->setScale( _id, scale );
 }
 
 inline
 void Transform::setScaleX( float scale )
 {
-    _scale.x = scale;
-    recomputeMatrix();
+    glm::vec3 factors = this->scale();
+    factors.x = scale;
+    setScale( factors );
 }
 
 inline
 void Transform::setScaleY( float scale )
 {
-    _scale.y = scale;
-    recomputeMatrix();
+    glm::vec3 factors = this->scale();
+    factors.y = scale;
+    setScale( factors );
 }
 
 inline
 void Transform::setScaleZ( float scale )
 {
-    _scale.z = scale;
-    recomputeMatrix();
+    glm::vec3 factors = this->scale();
+    factors.z = scale;
+    setScale( factors );
+}
+
+inline
+void Transform::setParent( const Transform* parent )
+{
+    system()->setParent( _id, parent != nullptr ? parent->_id :
+                                                  TransformSystem::NO_ID );
 }
 
 // MEMBER FUNCTIONS
@@ -576,8 +608,7 @@ void Transform::translate( float x, float y, float z )
 inline
 void Transform::translate( const glm::vec3& translation )
 {
-    _position += translation;
-    recomputeMatrix();
+    setPosition( position() + translation );
 }
 
 inline
@@ -589,8 +620,7 @@ void Transform::rotate( float x, float y, float z, float r )
 inline
 void Transform::rotate( const glm::quat& rotation )
 {
-    _rotation *= rotation;
-    recomputeMatrix();
+    setRotation( this->rotation() * rotation );
 }
 
 inline
@@ -602,26 +632,31 @@ void Transform::rotateEuler( float x, float y, float z )
 inline
 void Transform::scale( float scale )
 {
-    _scale *= scale;
-    recomputeMatrix();
+    setScale( this->scale() * scale );
 }
 
 inline
 void Transform::scaleX( float scale )
 {
-    _scale.x *= scale;
+    glm::vec3 factors = this->scale();
+    factors.x *= scale;
+    setScale( factors );
 }
 
 inline
 void Transform::scaleY( float scale )
 {
-    _scale.y *= scale;
+    glm::vec3 factors = this->scale();
+    factors.y *= scale;
+    setScale( factors );
 }
 
 inline
 void Transform::scaleZ( float scale )
 {
-    _scale.z *= scale;
+    glm::vec3 factors = this->scale();
+    factors.z *= scale;
+    setScale( factors );
 }
 
 inline
@@ -633,13 +668,14 @@ void Transform::lookAt( const glm::vec3& center )
 inline
 void Transform::lookAt( const glm::vec3& center, const glm::vec3& up )
 {
-    lookAt( _position, center, up );
+    lookAt( position(), center, up );
 }
 
+// HELPER FUNCTIONS
 inline
-void Transform::resetChangedFlag()
+TransformSystem* Transform::system()
 {
-    _hasChanged = false;
+    return TransformSystem::inst();
 }
 
 } // End nspc obj
@@ -0,0 +1,471 @@
+// transform_system.cpp
+#include "transform_system.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "demo/utility/thread_pool.h"
+
+namespace demo
+{
+
+namespace obj
+{
+
+// CONSTANTS
+constexpr uint32 TransformSystem::NO_ID;
+constexpr uint32 TransformSystem::COMPONENTS;
+constexpr uint32 TransformSystem::NO_PARENT;
+constexpr uint32 TransformSystem::BATCH_SIZE;
+constexpr uint32 TransformSystem::PARALLEL_GRAIN;
+constexpr uint32 TransformSystem::TASKS_PER_THREAD;
+constexpr uint32 TransformSystem::SCAN_RATIO;
+constexpr uint32 TransformSystem::COMPACT_RATIO;
+
+// HELPER FUNCTIONS
+/**
+ * The components of an identity transform.
+ */
+static const float IDENTITY[] = { 0.0f, 0.0f, 0.0f,
+                                  0.0f, 0.0f, 0.0f, 1.0f,
+                                  1.0f, 1.0f, 1.0f };
+
+void TransformSystem::unlink( uint32 id )
+{
+    uint32 parent = _parentIds[id];
+    if ( parent == NO_ID )
+    {
+        return;
+    }
+
+    uint32* link = &_firstChildIds[parent];
+    while ( *link != id )
+    {
+        link = &_nextSiblingIds[*link];
+    }
+    *link = _nextSiblingIds[id];
+
+    _nextSiblingIds[id] = NO_ID;
+    _parentIds[id] = NO_ID;
+}
+
+void TransformSystem::rebuild()
+{
+    cntr::DynamicArray<float> components[COMPONENTS];
+    cntr::DynamicArray<uint32> ids;
+    _parents.clear();
+    _subtreeSizes.clear();
+
+    // walk each root's subtree depth first through the sibling links,
+    // skipping the destroyed slots
+    for ( uint32 i = 0; i < _ids.size(); ++i )
+    {
+        uint32 root = _ids[i];
+        if ( root == NO_ID || _parentIds[root] != NO_ID )
+        {
+            continue;
+        }
+
+        uint32 id = root;
+        while ( id != NO_ID )
+        {
+            uint32 slot = _slots[id];
+            for ( uint32 c = 0; c < COMPONENTS; ++c )
+            {
+                components[c].push( _components[c][slot] );
+            }
+            _parents.push( id == root ? NO_PARENT :
+                           _slots[_parentIds[id]] );
+            _subtreeSizes.push( 1 );
+
+            // the new slot is known once the old one has been read
+            _slots[id] = ids.size();
+            ids.push( id );
+
+            uint32 next = _firstChildIds[id];
+            while ( next == NO_ID && id != root )
+            {
+                next = _nextSiblingIds[id];
+                id = _parentIds[id];
+            }
+            id = next;
+        }
+    }
+
+    for ( uint32 c = 0; c < COMPONENTS; ++c )
+    {
+        _components[c] = std::move( components[c] );
+    }
+    _ids = std::move( ids );
+    _deadCount = 0;
+
+    // children come after their parents, so a backward pass sees every
+    // subtree complete before adding it to its parent
+    for ( uint32 i = _ids.size(); i-- > 0; )
+    {
+        if ( _parents[i] != NO_PARENT )
+        {
+            _subtreeSizes[_parents[i]] += _subtreeSizes[i];
+        }
+    }
+
+    _worldMatrices.clear();
+    _isChanged.clear();
+    for ( uint32 i = 0; i < _ids.size(); ++i )
+    {
+        _worldMatrices.push( glm::mat4() );
+        _isChanged.push( 1 );
+    }
+
+    _ranges.clear();
+    queueRange( 0, _ids.size() );
+
+    _isHierarchyDirty = false;
+}
+
+void TransformSystem::collectChangedRanges()
+{
+    _ranges.clear();
+    if ( _changes.size() == 0 && !_isScanNeeded )
+    {
+        return;
+    }
+
+    // when much of the system changed, checking every slot is cheaper than
+    // sorting the changes
+    if ( _isScanNeeded || _changes.size() > _ids.size() / SCAN_RATIO )
+    {
+        const uint8* isChanged = &_isChanged[0];
+        uint32 slot = 0;
+        while ( slot < _ids.size() )
+        {
+            if ( isChanged[slot] != 0 )
+            {
+                queueRange( slot, slot + _subtreeSizes[slot] );
+                slot += _subtreeSizes[slot];
+            }
+            else
+            {
+                ++slot;
+            }
+        }
+        return;
+    }
+
+    // in slot order a change inside an earlier subtree is already covered
+    std::sort( &_changes[0], &_changes[0] + _changes.size() );
+
+    uint32 end = 0;
+    for ( uint32 i = 0; i < _changes.size(); ++i )
+    {
+        uint32 slot = _changes[i];
+        if ( slot < end )
+        {
+            continue;
+        }
+
+        end = slot + _subtreeSizes[slot];
+        queueRange( slot, end );
+    }
+}
+
+void TransformSystem::planTasks( util::ThreadPool* threadPool )
+{
+    _tasks.clear();
+
+    uint32 total = 0;
+    for ( uint32 i = 0; i < _ranges.size(); ++i )
+    {
+        total += _ranges[i].end - _ranges[i].begin;
+    }
+
+    if ( threadPool == nullptr || total < 2 * PARALLEL_GRAIN )
+    {
+        _tasks.push( Range{ 0, _ranges.size() } );
+        return;
+    }
+
+    uint32 taskCount = ( threadPool->threadCount() + 1 ) * TASKS_PER_THREAD;
+    uint32 taskSize = std::max( total / taskCount, PARALLEL_GRAIN );
+
+    // cut the runs too big for one task between their subtrees, and resolve
+    // the root of a single subtree that is too big here so its children can
+    // be cut apart
+    uint32 i = 0;
+    while ( i < _ranges.size() )
+    {
+        Range range = _ranges[i];
+        if ( range.end - range.begin <= taskSize )
+        {
+            ++i;
+            continue;
+        }
+
+        uint32 end = range.begin + _subtreeSizes[range.begin];
+        if ( end == range.end )
+        {
+            updateRange( Range{ range.begin, range.begin + 1 } );
+            _ranges[i] = Range{ range.begin + 1, range.end };
+            continue;
+        }
+
+        while ( end < range.end &&
+                end + _subtreeSizes[end] - range.begin <= taskSize )
+        {
+            end += _subtreeSizes[end];
+        }
+
+        _ranges[i] = Range{ range.begin, end };
+        _ranges.push( Range{ end, range.end } );
+    }
+
+    // the subtrees are independent, so group them into tasks of about the
+    // same size
+    uint32 begin = 0;
+    uint32 size = 0;
+    for ( i = 0; i < _ranges.size(); ++i )
+    {
+        size += _ranges[i].end - _ranges[i].begin;
+        if ( size >= taskSize )
+        {
+            _tasks.push( Range{ begin, i + 1 } );
+            begin = i + 1;
+            size = 0;
+        }
+    }
+
+    if ( begin < _ranges.size() )
+    {
+        _tasks.push( Range{ begin, _ranges.size() } );
+    }
+}
+
+void TransformSystem::queueRange( uint32 begin, uint32 end )
+{
+    // neighboring subtrees are updated in one pass
+    uint32 last = _ranges.size() - 1;
+    if ( _ranges.size() > 0 && _ranges[last].end == begin )
+    {
+        _ranges[last].end = end;
+    }
+    else if ( begin < end )
+    {
+        _ranges.push( Range{ begin, end } );
+    }
+}
+
+void TransformSystem::updateRange( const Range& range )
+{
+    glm::mat4* world = &_worldMatrices[0];
+    const uint32* parents = &_parents[0];
+
+    for ( uint32 begin = range.begin; begin < range.end; begin += BATCH_SIZE )
+    {
+        uint32 count = std::min( range.end - begin, BATCH_SIZE );
+
+        // compose the local matrices in place, then apply the parents while
+        // the batch is still in cache; a parent is always earlier, so it is
+        // final by the time its children are reached
+        const float* components[COMPONENTS];
+        for ( uint32 c = 0; c < COMPONENTS; ++c )
+        {
+            components[c] = &_components[c][begin];
+        }
+        util::SimdKernels::composeTransforms( &world[begin][0][0], components,
+                                              count );
+
+        for ( uint32 slot = begin; slot < begin + count; ++slot )
+        {
+            if ( parents[slot] != NO_PARENT )
+            {
+                world[slot] = world[parents[slot]] * world[slot];
+            }
+        }
+    }
+
+    memset( &_isChanged[range.begin], 0, range.end - range.begin );
+}
+
+void TransformSystem::runTask( uint32 task )
+{
+    const Range& ranges = _tasks[task];
+    for ( uint32 i = ranges.begin; i < ranges.end; ++i )
+    {
+        updateRange( _ranges[i] );
+    }
+}
+
+// CONSTRUCTORS
+TransformSystem::TransformSystem()
+    : _worldMatrices(), _parents(), _subtreeSizes(), _ids(), _isChanged(),
+      _slots(), _parentIds(), _firstChildIds(), _nextSiblingIds(),
+      _freeIds(), _changes(), _ranges(), _tasks(), _updatedRanges(),
+      _deadCount( 0 ), _isHierarchyDirty( false ), _isConcurrent( false ),
+      _isScanNeeded( false ), _isChangedConcurrently( false )
+{
+}
+
+// ACCESSOR FUNCTIONS
+glm::mat4 TransformSystem::localMatrix( uint32 id ) const
+{
+    uint32 slot = _slots[id];
+    const float* components[COMPONENTS];
+    for ( uint32 c = 0; c < COMPONENTS; ++c )
+    {
+        components[c] = &_components[c][slot];
+    }
+
+    glm::mat4 matrix;
+    util::SimdKernels::composeTransforms( &matrix[0][0], components, 1 );
+    return matrix;
+}
+
+// MUTATOR FUNCTIONS
+void TransformSystem::setParent( uint32 id, uint32 parent )
+{
+    assert( !_isConcurrent );
+
+    if ( parent == _parentIds[id] )
+    {
+        return;
+    }
+
+    #ifndef NDEBUG
+    for ( uint32 ancestor = parent;
+          ancestor != NO_ID;
+          ancestor = _parentIds[ancestor] )
+    {
+        assert( ancestor != id );
+    }
+    #endif
+
+    unlink( id );
+
+    if ( parent != NO_ID )
+    {
+        uint32* link = &_firstChildIds[parent];
+        while ( *link != NO_ID )
+        {
+            link = &_nextSiblingIds[*link];
+        }
+        *link = id;
+    }
+
+    _parentIds[id] = parent;
+    _isHierarchyDirty = true;
+}
+
+// MEMBER FUNCTIONS
+uint32 TransformSystem::create()
+{
+    assert( !_isConcurrent );
+
+    uint32 id;
+    if ( _freeIds.size() > 0 )
+    {
+        id = _freeIds.pop();
+    }
+    else
+    {
+        id = _slots.size();
+        _slots.push( 0 );
+        _parentIds.push( NO_ID );
+        _firstChildIds.push( NO_ID );
+        _nextSiblingIds.push( NO_ID );
+    }
+
+    // a new root at the end keeps the hierarchy order intact
+    uint32 slot = _ids.size();
+    for ( uint32 c = 0; c < COMPONENTS; ++c )
+    {
+        _components[c].push( IDENTITY[c] );
+    }
+    _worldMatrices.push( glm::mat4() );
+    _parents.push( NO_PARENT );
+    _subtreeSizes.push( 1 );
+    _ids.push( id );
+    _isChanged.push( 0 );
+
+    _slots[id] = slot;
+    markChanged( slot );
+
+    return id;
+}
+
+void TransformSystem::destroy( uint32 id )
+{
+    assert( !_isConcurrent );
+
+    while ( _firstChildIds[id] != NO_ID )
+    {
+        setParent( _firstChildIds[id], NO_ID );
+    }
+    unlink( id );
+
+    // the slot stays behind as part of its parent's subtree until the next
+    // rebuild, so a destroyed leaf does not force one
+    uint32 slot = _slots[id];
+    _ids[slot] = NO_ID;
+    _freeIds.push( id );
+    ++_deadCount;
+
+    if ( _deadCount > _ids.size() / COMPACT_RATIO )
+    {
+        _isHierarchyDirty = true;
+    }
+}
+
+void TransformSystem::copy( uint32 id, uint32 source )
+{
+    uint32 slot = _slots[id];
+    uint32 sourceSlot = _slots[source];
+    for ( uint32 c = 0; c < COMPONENTS; ++c )
+    {
+        _components[c][slot] = _components[c][sourceSlot];
+    }
+    markChanged( slot );
+}
+
+void TransformSystem::update( util::ThreadPool* threadPool )
+{
+    assert( !_isConcurrent );
+
+    if ( _isHierarchyDirty )
+    {
+        rebuild();
+    }
+    else
+    {
+        collectChangedRanges();
+    }
+    _changes.clear();
+    _isScanNeeded = false;
+
+    // the tasks cut the ranges apart, so keep them as they were
+    _updatedRanges.clear();
+    for ( uint32 i = 0; i < _ranges.size(); ++i )
+    {
+        _updatedRanges.push( _ranges[i] );
+    }
+
+    if ( _ranges.size() == 0 )
+    {
+        return;
+    }
+
+    planTasks( threadPool );
+    if ( _tasks.size() == 1 )
+    {
+        runTask( 0 );
+    }
+    else
+    {
+        threadPool->parallelFor( _tasks.size(),
+                                 [this]( uint32 task ) { runTask( task ); } );
+    }
+}
+
+} // End nspc obj
+
+} // End nspc demo
@@ -0,0 +1,579 @@
+// transform_system.h
+//
+// Owns the data of every transform.
+//
+// The components of the transforms are stored as structure of arrays: the
+// position x, y and z, the rotation x, y, z and w, and the scale x, y and z
+// each have an array of their own, next to an array of world matrices. This
+// lets the SIMD kernels compose 4 or 8 matrices at a time straight from
+// storage, and an update only streams through the data it needs. Transforms
+// are handles into the system that refer to their data by id.
+//
+// The slots are kept in hierarchy order: every transform is followed by its
+// descendants, so each subtree is a contiguous run and a parent always comes
+// before its children. A changed subtree is therefore recomputed in a single
+// linear pass with every parent already resolved by the time its children are
+// reached. Changes are recorded as they are made, so an update only touches
+// the subtrees under the transforms that moved. When there is a thread pool,
+// large subtrees are split into their child subtrees and spread across the
+// threads.
+//
+// New transforms are appended as roots and destroyed ones are left in place,
+// so neither disturbs the order. Reparenting marks the order out of date and
+// the next update rebuilds it, which also reclaims destroyed slots.
+//
+// Transforms are created, changed, and destroyed on one thread. Between
+// beginConcurrentChanges and endConcurrentChanges the components of different
+// transforms may be changed from several threads at once; the changes are then
+// only flagged per slot and the next update finds them by checking every slot.
+//
+#ifndef DEMO_TRANSFORM_SYSTEM_H
+#define DEMO_TRANSFORM_SYSTEM_H
+
+#include <assert.h>
+
+#include <atomic>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/intdef.h"
+#include "demo/utility/simd_kernels.h"
+
+namespace demo
+{
+
+namespace util
+{
+
+class ThreadPool;
+
+} // End nspc util
+
+namespace obj
+{
+
+class TransformSystem
+{
+  public:
+    // CONSTANTS
+    /**
+     * The id of no transform.
+     */
+    static constexpr uint32 NO_ID = 0xFFFFFFFF;
+
+  private:
+    // TYPES
+    /**
+     * A half-open run of indices.
+     */
+    struct Range
+    {
+        uint32 begin;
+        uint32 end;
+    };
+
+    // CONSTANTS
+    /**
+     * The number of component arrays.
+     */
+    static constexpr uint32 COMPONENTS =
+        util::SimdKernels::TRANSFORM_COMPONENTS;
+
+    /**
+     * The parent slot of a root.
+     */
+    static constexpr uint32 NO_PARENT = 0xFFFFFFFF;
+
+    /**
+     * The number of matrices composed before their parents are applied, small
+     * enough that they are still in cache.
+     */
+    static constexpr uint32 BATCH_SIZE = 256;
+
+    /**
+     * The fewest slots worth handing to another thread.
+     */
+    static constexpr uint32 PARALLEL_GRAIN = 4096;
+
+    /**
+     * The number of tasks per thread an update is split into so uneven
+     * subtrees still balance.
+     */
+    static constexpr uint32 TASKS_PER_THREAD = 4;
+
+    /**
+     * The fraction of the slots, as one over this, beyond which changes are
+     * found by checking every slot instead of sorting the change list.
+     */
+    static constexpr uint32 SCAN_RATIO = 16;
+
+    /**
+     * The fraction of the slots, as one over this, that may be destroyed
+     * before they are reclaimed.
+     */
+    static constexpr uint32 COMPACT_RATIO = 4;
+
+    // MEMBERS
+    /**
+     * The components of each slot.
+     */
+    cntr::DynamicArray<float> _components[COMPONENTS];
+
+    /**
+     * The world matrix of each slot.
+     */
+    cntr::DynamicArray<glm::mat4> _worldMatrices;
+
+    /**
+     * The parent of each slot or NO_PARENT for roots.
+     */
+    cntr::DynamicArray<uint32> _parents;
+
+    /**
+     * The number of slots in the subtree under each slot, itself included.
+     */
+    cntr::DynamicArray<uint32> _subtreeSizes;
+
+    /**
+     * The id of each slot or NO_ID once destroyed.
+     */
+    cntr::DynamicArray<uint32> _ids;
+
+    /**
+     * Whether each slot changed since the last update.
+     */
+    cntr::DynamicArray<uint8> _isChanged;
+
+    /**
+     * The slot of each id.
+     */
+    cntr::DynamicArray<uint32> _slots;
+
+    /**
+     * The parent id of each id.
+     */
+    cntr::DynamicArray<uint32> _parentIds;
+
+    /**
+     * The first child id of each id.
+     */
+    cntr::DynamicArray<uint32> _firstChildIds;
+
+    /**
+     * The next sibling id of each id.
+     */
+    cntr::DynamicArray<uint32> _nextSiblingIds;
+
+    /**
+     * The ids available for reuse.
+     */
+    cntr::DynamicArray<uint32> _freeIds;
+
+    /**
+     * The slots that changed since the last update.
+     */
+    cntr::DynamicArray<uint32> _changes;
+
+    /**
+     * The runs of subtrees to recompute in the current update.
+     */
+    cntr::DynamicArray<Range> _ranges;
+
+    /**
+     * The runs of subtrees given to each task in the current update.
+     */
+    cntr::DynamicArray<Range> _tasks;
+
+    /**
+     * The runs of subtrees recomputed by the last update.
+     */
+    cntr::DynamicArray<Range> _updatedRanges;
+
+    /**
+     * The number of destroyed slots not yet reclaimed.
+     */
+    uint32 _deadCount;
+
+    /**
+     * Whether the slots must be reordered before the next update.
+     */
+    bool _isHierarchyDirty;
+
+    /**
+     * Whether components may be changed from several threads.
+     */
+    bool _isConcurrent;
+
+    /**
+     * Whether changes were made that are missing from the change list.
+     */
+    bool _isScanNeeded;
+
+    /**
+     * Whether any slot was changed while changes were concurrent.
+     */
+    std::atomic<bool> _isChangedConcurrently;
+
+    // HELPER FUNCTIONS
+    /**
+     * Record that a slot changed.
+     * @param slot The slot.
+     */
+    void markChanged( uint32 slot );
+
+    /**
+     * Remove an id from the children of its parent.
+     * @param id The id.
+     */
+    void unlink( uint32 id );
+
+    /**
+     * Reorder the slots by hierarchy, reclaim destroyed ones, and queue every
+     * subtree for update.
+     */
+    void rebuild();
+
+    /**
+     * Queue a run of whole subtrees for update, joining it to the last one
+     * when they touch.
+     * @param begin The first slot.
+     * @param end The slot after the last.
+     */
+    void queueRange( uint32 begin, uint32 end );
+
+    /**
+     * Queue the subtrees under the changed slots for update.
+     */
+    void collectChangedRanges();
+
+    /**
+     * Split the queued subtrees into tasks for the thread pool.
+     * @param threadPool The thread pool or nullptr for none.
+     */
+    void planTasks( util::ThreadPool* threadPool );
+
+    /**
+     * Recompute the world matrices of a run of slots whose parents outside
+     * the run are up to date.
+     * @param range The slots.
+     */
+    void updateRange( const Range& range );
+
+    /**
+     * Recompute the world matrices of the subtrees given to a task.
+     * @param task The task.
+     */
+    void runTask( uint32 task );
+
+    // HIDDEN FUNCTIONS
+    TransformSystem( const TransformSystem& other ) = delete;
+
+    TransformSystem& operator=( const TransformSystem& other ) = delete;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct an empty transform system.
+     */
+    TransformSystem();
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the position.
+     * @param id The transform.
+     * @return The position.
+     */
+    glm::vec3 position( uint32 id ) const;
+
+    /**
+     * Get the rotation.
+     * @param id The transform.
+     * @return The rotation.
+     */
+    glm::quat rotation( uint32 id ) const;
+
+    /**
+     * Get the scale factor vector.
+     * @param id The transform.
+     * @return The scale factor vector.
+     */
+    glm::vec3 scale( uint32 id ) const;
+
+    /**
+     * Get the matrix of the transform relative to its parent.
+     * @param id The transform.
+     * @return The matrix.
+     */
+    glm::mat4 localMatrix( uint32 id ) const;
+
+    /**
+     * Get the world matrix as of the last update.
+     * @param id The transform.
+     * @return The matrix.
+     */
+    const glm::mat4& worldMatrix( uint32 id ) const;
+
+    /**
+     * Get the parent.
+     * @param id The transform.
+     * @return The parent or NO_ID for none.
+     */
+    uint32 parent( uint32 id ) const;
+
+    /**
+     * Check if the transform changed since the last update.
+     * @param id The transform.
+     * @return Has it changed?
+     */
+    bool hasChanged( uint32 id ) const;
+
+    /**
+     * Get the number of transforms.
+     * @return The number of transforms.
+     */
+    uint32 size() const;
+
+    // MUTATOR FUNCTIONS
+    /**
+     * Set the position.
+     * @param id The transform.
+     * @param position The position.
+     */
+    void setPosition( uint32 id, const glm::vec3& position );
+
+    /**
+     * Set the rotation.
+     * @param id The transform.
+     * @param rotation The rotation.
+     */
+    void setRotation( uint32 id, const glm::quat& rotation );
+
+    /**
+     * Set the scale factor vector.
+     * @param id The transform.
+     * @param scale The scale factor vector.
+     */
+    void setScale( uint32 id, const glm::vec3& scale );
+
+    /**
+     * Set the parent, making the transform relative to it.
+     * The transform is appended to the parent's children. A parent must not
+     * be the transform or one of its descendants.
+     * @param id The transform.
+     * @param parent The parent or NO_ID for none.
+     */
+    void setParent( uint32 id, uint32 parent );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Create an identity transform with no parent.
+     * @return The transform.
+     */
+    uint32 create();
+
+    /**
+     * Destroy a transform.
+     * Its children become roots.
+     * @param id The transform.
+     */
+    void destroy( uint32 id );
+
+    /**
+     * Copy the position, rotation, and scale of another transform.
+     * @param id The transform.
+     * @param source The transform to copy.
+     */
+    void copy( uint32 id, uint32 source );
+
+    /**
+     * Allow the components of different transforms to be changed from
+     * several threads until endConcurrentChanges.
+     * Transforms must not be created, destroyed, or reparented meanwhile.
+     */
+    void beginConcurrentChanges();
+
+    /**
+     * Go back to changing transforms from one thread.
+     */
+    void endConcurrentChanges();
+
+    /**
+     * Recompute the world matrices of every changed transform and of the
+     * subtrees under them.
+     * @param threadPool The thread pool to spread large updates across or
+     * nullptr to update on the calling thread.
+     */
+    void update( util::ThreadPool* threadPool );
+
+    /**
+     * Call a function with every transform whose world matrix the last
+     * update recomputed.
+     * @param function The function, which takes the id.
+     */
+    template <typename Function>
+    void forEachUpdated( const Function& function ) const;
+
+    // UTILITY FUNCTIONS
+    /**
+     * Get the transform system.
+     * It is created on first use since transforms may be constructed before
+     * anything is started up.
+     * @return The transform system.
+     */
+    static TransformSystem* inst();
+};
+
+// ACCESSOR FUNCTIONS
+inline
+glm::vec3 TransformSystem::position( uint32 id ) const
+{
+    uint32 slot = _slots[id];
+    return glm::vec3( _components[0][slot], _components[1][slot],
+                      _components[2][slot] );
+}
+
+inline
+glm::quat TransformSystem::rotation( uint32 id ) const
+{
+    uint32 slot = _slots[id];
+    return glm::quat( _components[6][slot], _components[3][slot],
+                      _components[4][slot], _components[5][slot] );
+}
+
+inline
+glm::vec3 TransformSystem::scale( uint32 id ) const
+{
+    uint32 slot = _slots[id];
+    return glm::vec3( _components[7][slot], _components[8][slot],
+                      _components[9][slot] );
+}
+
+inline
+const glm::mat4& TransformSystem::worldMatrix( uint32 id ) const
+{
+    return _worldMatrices[_slots[id]];
+}
+
+inline
+uint32 TransformSystem::parent( uint32 id ) const
+{
+    return _parentIds[id];
+}
+
+inline
+bool TransformSystem::hasChanged( uint32 id ) const
+{
+    return _isChanged[_slots[id]] != 0;
+}
+
+inline
+uint32 TransformSystem::size() const
+{
+    return _ids.size() - _deadCount;
+}
+
+// MUTATOR FUNCTIONS
+inline
+void TransformSystem::setPosition( uint32 id, const glm::vec3& position )
+{
+    uint32 slot = _slots[id];
+    _components[0][slot] = position.x;
+    _components[1][slot] = position.y;
+    _components[2][slot] = position.z;
+    markChanged( slot );
+}
+
+inline
+void TransformSystem::setRotation( uint32 id, const glm::quat& rotation )
+{
+    uint32 slot = _slots[id];
+    _components[3][slot] = rotation.x;
+    _components[4][slot] = rotation.y;
+    _components[5][slot] = rotation.z;
+    _components[6][slot] = rotation.w;
+    markChanged( slot );
+}
+
+inline
+void TransformSystem::setScale( uint32 id, const glm::vec3& scale )
+{
+    uint32 slot = _slots[id];
+    _components[7][slot] = scale.x;
+    _components[8][slot] = scale.y;
+    _components[9][slot] = scale.z;
+    markChanged( slot );
+}
+
+// HELPER FUNCTIONS
+inline
+void TransformSystem::markChanged( uint32 slot )
+{
+    // each thread only touches the flags of its own slots, but the shared
+    // change list must wait for the scan
+    if ( _isChanged[slot] == 0 )
+    {
+        _isChanged[slot] = 1;
+        if ( !_isConcurrent )
+        {
+            _changes.push( slot );
+        }
+        else if ( !_isChangedConcurrently.load( std::memory_order_relaxed ) )
+        {
+            _isChangedConcurrently.store( true, std::memory_order_relaxed );
+        }
+    }
+}
+
+// MEMBER FUNCTIONS
+inline
+void TransformSystem::beginConcurrentChanges()
+{
+    assert( !_isConcurrent );
+    _isConcurrent = true;
+}
+
+inline
+void TransformSystem::endConcurrentChanges()
+{
+    assert( _isConcurrent );
+    _isConcurrent = false;
+
+    // only a frame that moved something pays for the scan
+    if ( _isChangedConcurrently.exchange( false,
+                                          std::memory_order_relaxed ) )
+    {
+        _isScanNeeded = true;
+    }
+}
+
+template <typename Function>
+void TransformSystem::forEachUpdated( const Function& function ) const
+{
+    for ( uint32 i = 0; i < _updatedRanges.size(); ++i )
+    {
+        const Range& range = _updatedRanges[i];
+        for ( uint32 slot = range.begin; slot < range.end; ++slot )
+        {
+            if ( _ids[slot] != NO_ID )
+            {
+                function( _ids[slot] );
+            }
+        }
+    }
+}
+
+// UTILITY FUNCTIONS
+inline
+TransformSystem* TransformSystem::inst()
+{
+    static TransformSystem instance;
+    return &instance;
+}
+
+} // End nspc obj
+
+} // End nspc demo
+
+#endif // DEMO_TRANSFORM_SYSTEM_H
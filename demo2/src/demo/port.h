@@ -31,4 +31,30 @@
 #define vc_typename typename
 #endif // _MSC_VER
 
+/**
+ * DEMO_ARCH_X86 is defined when building for 32 or 64-bit x86, which is the
+ * only architecture that has SIMD implementations of the hot kernels. Every
+ * other architecture uses the scalar implementations.
+ */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#define DEMO_ARCH_X86
+#endif
+
+/**
+ * The project is built without any -m flags so that one binary runs on every
+ * machine. Functions that use a newer instruction set than the baseline are
+ * marked with DEMO_TARGET, which tells GCC and Clang to generate code for
+ * that set in that function only, for example:
+ * DEMO_TARGET( "avx2,fma" ) void multiplyAvx2( ... );
+ * Such a function must only be called after util::CpuFeatures reports that
+ * the instructions are supported. MSVC allows intrinsics from any set
+ * without flags so the macro expands to nothing there.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define DEMO_TARGET( isa ) __attribute__(( target( isa ) ))
+#else
+#define DEMO_TARGET( isa )
+#endif
+
 #endif // DEMO_PORT_H
\ No newline at end of file
@@ -0,0 +1,105 @@
+// bounds.cpp
+#include "bounds.h"
+
+#include <cmath>
+
+#include <algorithm>
+
+namespace demo
+{
+
+namespace rndr
+{
+
+// MEMBER FUNCTIONS
+void Bounds::merge( const Bounds& other )
+{
+    if ( other.isEmpty() )
+    {
+        return;
+    }
+
+    if ( isEmpty() )
+    {
+        *this = other;
+        return;
+    }
+
+    glm::vec3 center = this->center();
+    glm::vec3 otherCenter = other.center();
+
+    _min = glm::min( _min, other._min );
+    _max = glm::max( _max, other._max );
+
+    // the sphere around the new center must reach around both old ones, but
+    // never needs to be larger than the one around the whole box
+    glm::vec3 merged = this->center();
+    float radius = std::max( glm::length( center - merged ) + _radius,
+                             glm::length( otherCenter - merged ) +
+                             other._radius );
+    _radius = std::min( radius, glm::length( extents() ) );
+}
+
+Bounds Bounds::transformed( const glm::mat4& matrix ) const
+{
+    if ( isEmpty() )
+    {
+        return *this;
+    }
+
+    glm::vec3 center = glm::vec3( matrix * glm::vec4( this->center(), 1.0f ) );
+    glm::vec3 extents = this->extents();
+
+    // each axis of the new box reaches as far as the old axes it is made of
+    glm::vec3 reach;
+    float scale = 0.0f;
+    for ( uint32 row = 0; row < 3; ++row )
+    {
+        reach[row] = std::abs( matrix[0][row] ) * extents.x +
+                     std::abs( matrix[1][row] ) * extents.y +
+                     std::abs( matrix[2][row] ) * extents.z;
+        scale = std::max( scale, glm::length( glm::vec3( matrix[row] ) ) );
+    }
+
+    return Bounds( center - reach, center + reach,
+                   std::min( _radius * scale, glm::length( reach ) ) );
+}
+
+// UTILITY FUNCTIONS
+Bounds Bounds::fromPoints( const glm::vec3* points, uint32 count,
+                           uint32 stride )
+{
+    if ( count == 0 )
+    {
+        return Bounds();
+    }
+
+    const uint8* first = reinterpret_cast<const uint8*>( points );
+
+    glm::vec3 min = *points;
+    glm::vec3 max = *points;
+    for ( uint32 i = 1; i < count; ++i )
+    {
+        const glm::vec3& point =
+            *reinterpret_cast<const glm::vec3*>( first + i * stride );
+        min = glm::min( min, point );
+        max = glm::max( max, point );
+    }
+
+    // a second pass finds the point farthest from the center of the box
+    glm::vec3 center = ( min + max ) * 0.5f;
+    float radius = 0.0f;
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        const glm::vec3& point =
+            *reinterpret_cast<const glm::vec3*>( first + i * stride );
+        glm::vec3 offset = point - center;
+        radius = std::max( radius, glm::dot( offset, offset ) );
+    }
+
+    return Bounds( min, max, std::sqrt( radius ) );
+}
+
+} // End nspc rndr
+
+} // End nspc demo
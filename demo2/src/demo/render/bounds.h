@@ -0,0 +1,176 @@
+// bounds.h
+//
+// The bounding box and bounding sphere of a piece of geometry.
+//
+// The box is axis aligned and the sphere is centered on it, which keeps the
+// sphere's radius no larger than half the box's diagonal and often much
+// smaller for round shapes. Bounds that contain nothing are empty; merging
+// an empty bounds changes nothing.
+//
+#ifndef DEMO_BOUNDS_H
+#define DEMO_BOUNDS_H
+
+#include <glm/glm.hpp>
+
+#include "demo/intdef.h"
+
+namespace demo
+{
+
+namespace rndr
+{
+
+class Bounds
+{
+  private:
+    // MEMBERS
+    /**
+     * The corner of the box with the smallest coordinates.
+     */
+    glm::vec3 _min;
+
+    /**
+     * The corner of the box with the largest coordinates.
+     */
+    glm::vec3 _max;
+
+    /**
+     * The radius of the sphere around the center of the box.
+     */
+    float _radius;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct empty bounds.
+     */
+    Bounds();
+
+    /**
+     * Construct bounds from a box and the radius of a sphere around its
+     * center.
+     * @param min The corner with the smallest coordinates.
+     * @param max The corner with the largest coordinates.
+     * @param radius The radius of the sphere.
+     */
+    Bounds( const glm::vec3& min, const glm::vec3& max, float radius );
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the corner of the box with the smallest coordinates.
+     * @return The minimum corner.
+     */
+    const glm::vec3& min() const;
+
+    /**
+     * Get the corner of the box with the largest coordinates.
+     * @return The maximum corner.
+     */
+    const glm::vec3& max() const;
+
+    /**
+     * Get the center of the box and the sphere.
+     * @return The center.
+     */
+    glm::vec3 center() const;
+
+    /**
+     * Get the distance from the center of the box to its faces.
+     * @return The half size on each axis.
+     */
+    glm::vec3 extents() const;
+
+    /**
+     * Get the radius of the sphere.
+     * @return The radius.
+     */
+    float radius() const;
+
+    /**
+     * Check if the bounds contain nothing.
+     * @return Is it empty?
+     */
+    bool isEmpty() const;
+
+    // MEMBER FUNCTIONS
+    /**
+     * Grow the bounds to contain other bounds.
+     * @param other The other bounds.
+     */
+    void merge( const Bounds& other );
+
+    /**
+     * Get the bounds of the geometry after it is transformed.
+     * The box contains the transformed box and the sphere is grown by the
+     * largest scale of the transform.
+     * @param matrix The transform.
+     * @return The transformed bounds.
+     */
+    Bounds transformed( const glm::mat4& matrix ) const;
+
+    // UTILITY FUNCTIONS
+    /**
+     * Compute the bounds of a set of points.
+     * @param points The first point.
+     * @param count The number of points.
+     * @param stride The bytes from one point to the next.
+     * @return The bounds.
+     */
+    static Bounds fromPoints( const glm::vec3* points, uint32 count,
+                              uint32 stride );
+};
+
+// CONSTRUCTORS
+inline
+Bounds::Bounds() : _min( 1.0f ), _max( -1.0f ), _radius( -1.0f )
+{
+}
+
+inline
+Bounds::Bounds( const glm::vec3& min, const glm::vec3& max, float radius )
+    : _min( min ), _max( max ), _radius( radius )
+{
+}
+
+// ACCESSOR FUNCTIONS
+inline
+const glm::vec3& Bounds::min() const
+{
+    return _min;
+}
+
+inline
+const glm::vec3& Bounds::max() const
+{
+    return _max;
+}
+
+inline
+glm::vec3 Bounds::center() const
+{
+    return ( _min + _max ) * 0.5f;
+}
+
+inline
+glm::vec3 Bounds::extents() const
+{
+    return ( _max - _min ) * 0.5f;
+}
+
+inline
+float Bounds::radius() const
+{
+    return _radius;
+}
+
+inline
+bool Bounds::isEmpty() const
+{
+    return _radius < 0.0f;
+}
+
+} // End nspc rndr
+
+} // End nspc demo
+
+#endif // DEMO_BOUNDS_H
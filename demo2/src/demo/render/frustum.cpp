@@ -0,0 +1,82 @@
+// frustum.cpp
+#include "frustum.h"
+
+#include <cmath>
+
+namespace demo
+{
+
+namespace rndr
+{
+
+// CONSTANTS
+constexpr uint32 Frustum::PLANE_COUNT;
+
+// CONSTRUCTORS
+Frustum::Frustum( const glm::mat4& viewProjection )
+{
+    // each plane is the last row of the matrix plus or minus another row,
+    // which bounds the clip coordinates to -w <= x, y, z <= w
+    glm::vec4 rows[4];
+    for ( uint32 row = 0; row < 4; ++row )
+    {
+        rows[row] = glm::vec4( viewProjection[0][row],
+                               viewProjection[1][row],
+                               viewProjection[2][row],
+                               viewProjection[3][row] );
+    }
+
+    for ( uint32 i = 0; i < PLANE_COUNT; ++i )
+    {
+        glm::vec4 plane = i % 2 == 0 ? rows[3] + rows[i / 2] :
+                                       rows[3] - rows[i / 2];
+        _planes[i] = plane * ( 1.0f / glm::length( glm::vec3( plane ) ) );
+    }
+}
+
+// MEMBER FUNCTIONS
+Frustum Frustum::transformed( const glm::mat4& matrix ) const
+{
+    // a point p in the source space is on a plane when plane . ( M * p ) is
+    // zero, which is ( transpose( M ) * plane ) . p
+    Frustum frustum;
+    for ( uint32 i = 0; i < PLANE_COUNT; ++i )
+    {
+        for ( uint32 column = 0; column < 4; ++column )
+        {
+            frustum._planes[i][column] = glm::dot( matrix[column],
+                                                   _planes[i] );
+        }
+    }
+    return frustum;
+}
+
+bool Frustum::intersects( const Bounds& bounds ) const
+{
+    if ( bounds.isEmpty() )
+    {
+        return false;
+    }
+
+    glm::vec3 center = bounds.center();
+    glm::vec3 extents = bounds.extents();
+
+    // the box is outside when even its corner nearest the inside is behind
+    // a plane
+    for ( uint32 i = 0; i < PLANE_COUNT; ++i )
+    {
+        const glm::vec4& plane = _planes[i];
+        float distance = glm::dot( glm::vec3( plane ), center ) + plane.w;
+        float reach = glm::dot( glm::abs( glm::vec3( plane ) ), extents );
+        if ( distance + reach < 0.0f )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // End nspc rndr
+
+} // End nspc demo
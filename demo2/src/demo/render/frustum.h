@@ -0,0 +1,117 @@
+// frustum.h
+//
+// The volume a camera can see, bounded by six planes.
+//
+// Each plane is stored as ( a, b, c, d ) such that a point ( x, y, z ) is on
+// the inner side when a * x + b * y + c * z + d >= 0. The planes are
+// extracted from a view-projection matrix, so they are in world space, and
+// can be carried into the local space of an object with its world matrix to
+// test geometry without transforming it.
+//
+// The planes are laid out as consecutive floats so that they can be passed
+// to util::SimdKernels::cullBoxes.
+//
+#ifndef DEMO_FRUSTUM_H
+#define DEMO_FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include "demo/intdef.h"
+#include "demo/render/bounds.h"
+
+namespace demo
+{
+
+namespace rndr
+{
+
+class Frustum
+{
+  public:
+    // CONSTANTS
+    /**
+     * The number of planes.
+     */
+    static constexpr uint32 PLANE_COUNT = 6;
+
+  private:
+    // MEMBERS
+    /**
+     * The left, right, bottom, top, near, and far planes.
+     */
+    glm::vec4 _planes[PLANE_COUNT];
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct a frustum that contains everything.
+     */
+    Frustum();
+
+    /**
+     * Construct the frustum of a view-projection matrix.
+     * @param viewProjection The projection matrix times the view matrix.
+     */
+    explicit Frustum( const glm::mat4& viewProjection );
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get a plane.
+     * @param index The index of the plane.
+     * @return The plane.
+     */
+    const glm::vec4& plane( uint32 index ) const;
+
+    /**
+     * Get the planes as PLANE_COUNT groups of four floats.
+     * @return The first float of the first plane.
+     */
+    const float* planes() const;
+
+    // MEMBER FUNCTIONS
+    /**
+     * Get the frustum in the space a transform maps from.
+     * The planes are no longer normalized, which the box tests do not need.
+     * @param matrix The transform, such as a world matrix.
+     * @return The transformed frustum.
+     */
+    Frustum transformed( const glm::mat4& matrix ) const;
+
+    /**
+     * Check if a box is at least partly inside.
+     * This is conservative: a box near a corner of the frustum may pass
+     * although it is outside.
+     * @param bounds The bounds whose box is tested.
+     * @return Is it inside?
+     */
+    bool intersects( const Bounds& bounds ) const;
+};
+
+// CONSTRUCTORS
+inline
+Frustum::Frustum()
+{
+    for ( uint32 i = 0; i < PLANE_COUNT; ++i )
+    {
+        _planes[i] = glm::vec4( 0.0f, 0.0f, 0.0f, 1.0f );
+    }
+}
+
+// ACCESSOR FUNCTIONS
+inline
+const glm::vec4& Frustum::plane( uint32 index ) const
+{
+    return _planes[index];
+}
+
+inline
+const float* Frustum::planes() const
+{
+    return &_planes[0][0];
+}
+
+} // End nspc rndr
+
+} // End nspc demo
+
+#endif // DEMO_FRUSTUM_H
@@ -0,0 +1,96 @@
+// gl_recorder.cpp
+#include "demo/render/gl_recorder.h"
+
+#include <algorithm>
+
+namespace demo
+{
+
+namespace rndr
+{
+
+// GLOBALS
+uint64 GlRecorder::g_counts[CALL_COUNT] = {};
+uint64 GlRecorder::g_uploadBytes = 0;
+
+// UTILITY FUNCTIONS
+uint64 GlRecorder::total()
+{
+    uint64 sum = 0;
+    for ( uint32 i = 0; i < CALL_COUNT; ++i )
+    {
+        sum += g_counts[i];
+    }
+
+    return sum;
+}
+
+const char* GlRecorder::name( Call call )
+{
+    static const char* const CALL_NAMES[CALL_COUNT] = {
+        "glActiveTexture", "glAttachShader", "glBindBuffer", "glBindTexture",
+        "glBindVertexArray", "glBufferData", "glClear", "glClearColor",
+        "glCompileShader", "glCreateProgram", "glCreateShader",
+        "glDebugMessageCallback", "glDebugMessageControl", "glDeleteBuffers",
+        "glDeleteProgram", "glDeleteShader",
+        "glDeleteTextures", "glDeleteVertexArrays", "glDetachShader",
+        "glDrawElements", "glEnable", "glEnableVertexAttribArray",
+        "glGenBuffers", "glGenTextures", "glGenVertexArrays",
+        "glGenerateMipmap", "glGetAttribLocation", "glGetError",
+        "glGetProgramInfoLog", "glGetProgramiv", "glGetShaderInfoLog",
+        "glGetShaderiv", "glGetString", "glGetUniformLocation",
+        "glLinkProgram", "glShaderSource", "glTexImage2D", "glTexParameteri",
+        "glUniform1f", "glUniform1i", "glUniform1ui", "glUniform3fv",
+        "glUniformMatrix3fv", "glUniformMatrix4fv", "glUseProgram",
+        "glVertexAttribPointer", "glViewport" };
+
+    return CALL_NAMES[call];
+}
+
+void GlRecorder::dump( FILE* file, uint64 frameCount )
+{
+    if ( !isRecording() )
+    {
+        fprintf( file, "GL calls are only recorded by headless builds.\n" );
+        return;
+    }
+
+    // order the calls by how often they were made
+    Call calls[CALL_COUNT];
+    for ( uint32 i = 0; i < CALL_COUNT; ++i )
+    {
+        calls[i] = static_cast<Call>( i );
+    }
+    std::stable_sort( calls, calls + CALL_COUNT, []( Call a, Call b ) {
+        return g_counts[a] > g_counts[b];
+    } );
+
+    double frames = frameCount > 0 ? static_cast<double>( frameCount ) : 1.0;
+    fprintf( file, "GL calls over %llu frame(s), %llu total, %.1f per "
+             "frame, %llu byte(s) uploaded:\n",
+             static_cast<unsigned long long>( frameCount ),
+             static_cast<unsigned long long>( total() ), total() / frames,
+             static_cast<unsigned long long>( g_uploadBytes ) );
+    fprintf( file, "  %-28s %12s %12s\n", "call", "count", "per frame" );
+
+    for ( uint32 i = 0; i < CALL_COUNT && g_counts[calls[i]] > 0; ++i )
+    {
+        fprintf( file, "  %-28s %12llu %12.1f\n", name( calls[i] ),
+                 static_cast<unsigned long long>( g_counts[calls[i]] ),
+                 g_counts[calls[i]] / frames );
+    }
+}
+
+void GlRecorder::reset()
+{
+    for ( uint32 i = 0; i < CALL_COUNT; ++i )
+    {
+        g_counts[i] = 0;
+    }
+
+    g_uploadBytes = 0;
+}
+
+} // End nspc rndr
+
+} // End nspc demo
@@ -0,0 +1,184 @@
+// gl_recorder.h
+//
+// Counts the graphics api calls made by the renderer.
+//
+// The counts are only recorded by the headless backend, which replaces every
+// OpenGL and GLFW entry point with a no-op that records the call. This makes
+// the CPU cost of the render path measurable on machines without a GPU.
+//
+// The counts are not synchronized; the graphics api may only be used from
+// the thread that owns the context.
+//
+#ifndef DEMO_GL_RECORDER_H
+#define DEMO_GL_RECORDER_H
+
+#include <stdio.h>
+
+#include "demo/intdef.h"
+
+namespace demo
+{
+
+namespace rndr
+{
+
+class GlRecorder
+{
+  public:
+    // TYPES
+    /**
+     * The recorded OpenGL entry points.
+     */
+    enum Call
+    {
+        ACTIVE_TEXTURE,
+        ATTACH_SHADER,
+        BIND_BUFFER,
+        BIND_TEXTURE,
+        BIND_VERTEX_ARRAY,
+        BUFFER_DATA,
+        CLEAR,
+        CLEAR_COLOR,
+        COMPILE_SHADER,
+        CREATE_PROGRAM,
+        CREATE_SHADER,
+        DEBUG_MESSAGE_CALLBACK,
+        DEBUG_MESSAGE_CONTROL,
+        DELETE_BUFFERS,
+        DELETE_PROGRAM,
+        DELETE_SHADER,
+        DELETE_TEXTURES,
+        DELETE_VERTEX_ARRAYS,
+        DETACH_SHADER,
+        DRAW_ELEMENTS,
+        ENABLE,
+        ENABLE_VERTEX_ATTRIB_ARRAY,
+        GEN_BUFFERS,
+        GEN_TEXTURES,
+        GEN_VERTEX_ARRAYS,
+        GENERATE_MIPMAP,
+        GET_ATTRIB_LOCATION,
+        GET_ERROR,
+        GET_PROGRAM_INFO_LOG,
+        GET_PROGRAMIV,
+        GET_SHADER_INFO_LOG,
+        GET_SHADERIV,
+        GET_STRING,
+        GET_UNIFORM_LOCATION,
+        LINK_PROGRAM,
+        SHADER_SOURCE,
+        TEX_IMAGE_2D,
+        TEX_PARAMETERI,
+        UNIFORM_1F,
+        UNIFORM_1I,
+        UNIFORM_1UI,
+        UNIFORM_3FV,
+        UNIFORM_MATRIX_3FV,
+        UNIFORM_MATRIX_4FV,
+        USE_PROGRAM,
+        VERTEX_ATTRIB_POINTER,
+        VIEWPORT,
+        CALL_COUNT
+    };
+
+  private:
+    // GLOBALS
+    /**
+     * The number of times each call was made.
+     */
+    static uint64 g_counts[CALL_COUNT];
+
+    /**
+     * The number of bytes uploaded with buffer and texture data.
+     */
+    static uint64 g_uploadBytes;
+
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Records a call.
+     */
+    static void record( Call call );
+
+    /**
+     * Records an upload of the given number of bytes.
+     */
+    static void recordUpload( uint64 bytes );
+
+    /**
+     * Gets the number of times a call was made.
+     */
+    static uint64 count( Call call );
+
+    /**
+     * Gets the number of calls of every kind.
+     */
+    static uint64 total();
+
+    /**
+     * Gets the number of bytes uploaded.
+     */
+    static uint64 uploadBytes();
+
+    /**
+     * Gets the name of the entry point for a call.
+     */
+    static const char* name( Call call );
+
+    /**
+     * Checks if calls are being recorded by this build.
+     */
+    static bool isRecording();
+
+    /**
+     * Writes the calls that were made, most frequent first, along with the
+     * average number per frame.
+     */
+    static void dump( FILE* file, uint64 frameCount );
+
+    /**
+     * Clears every count.
+     */
+    static void reset();
+};
+
+// UTILITY FUNCTIONS
+inline
+void GlRecorder::record( Call call )
+{
+    ++g_counts[call];
+}
+
+inline
+void GlRecorder::recordUpload( uint64 bytes )
+{
+    g_uploadBytes += bytes;
+}
+
+inline
+uint64 GlRecorder::count( Call call )
+{
+    return g_counts[call];
+}
+
+inline
+uint64 GlRecorder::uploadBytes()
+{
+    return g_uploadBytes;
+}
+
+inline
+bool GlRecorder::isRecording()
+{
+    #ifdef DEMO_HEADLESS
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+} // End nspc rndr
+
+} // End nspc demo
+
+#endif // DEMO_GL_RECORDER_H
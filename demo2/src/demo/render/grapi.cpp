@@ -1,10 +1,8 @@
 // grapi.cpp
 #include "grapi.h"
 
-#include <iostream>
-
-#include "demo/intdef.h"
 #include "demo/render/window.h"
+#include "demo/utility/log.h"
 
 namespace demo
 {
@@ -12,6 +10,128 @@ namespace demo
 namespace rndr
 {
 
+// CONSTANTS
+constexpr uint32 GrApi::MAX_FRAME_ERRORS;
+constexpr uint32 GrApi::MAX_ERROR_FLAGS;
+
+// GLOBALS
+GrApi::FrameError GrApi::g_frameErrors[MAX_FRAME_ERRORS];
+uint32 GrApi::g_frameErrorCount = 0;
+uint64 GrApi::g_errorCount = 0;
+bool GrApi::g_hasDebugOutput = false;
+
+// HELPER FUNCTIONS
+/**
+ * Get the name of a KHR_debug message type.
+ */
+static const char* debugTypeName( GLenum type )
+{
+    switch ( type )
+    {
+        case GL_DEBUG_TYPE_ERROR:
+            return "error";
+
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+            return "deprecated";
+
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+            return "undefined behavior";
+
+        case GL_DEBUG_TYPE_PORTABILITY:
+            return "portability";
+
+        case GL_DEBUG_TYPE_PERFORMANCE:
+            return "performance";
+
+        default:
+            return "other";
+    }
+}
+
+bool GrApi::recordError( const char* tag, const char* detail, uint32 code )
+{
+    ++g_errorCount;
+
+    for ( uint32 i = 0; i < g_frameErrorCount; ++i )
+    {
+        FrameError& error = g_frameErrors[i];
+        if ( error.code == code && error.tag == tag && error.detail == detail )
+        {
+            ++error.count;
+            return false;
+        }
+    }
+
+    // once the table is full new errors are still reported, just not counted
+    if ( g_frameErrorCount < MAX_FRAME_ERRORS )
+    {
+        FrameError& error = g_frameErrors[g_frameErrorCount++];
+        error.tag = tag;
+        error.detail = detail;
+        error.code = code;
+        error.count = 1;
+    }
+
+    return true;
+}
+
+void GrApi::reportErrors( const char* tag, const char* detail )
+{
+    // the driver already reported these through the debug callback
+    if ( g_hasDebugOutput )
+    {
+        return;
+    }
+
+    for ( uint32 i = 0; i < MAX_ERROR_FLAGS; ++i )
+    {
+        GLenum error = glGetError();
+        if ( error == GL_NO_ERROR )
+        {
+            break;
+        }
+
+        if ( !recordError( tag, detail, error ) )
+        {
+            continue;
+        }
+
+        if ( detail == nullptr )
+        {
+            DEMO_LOG_ERROR( "gpu", "GPU Error [%s]: %s (0x%04x)", tag,
+                            errorName( error ), error );
+        }
+        else
+        {
+            DEMO_LOG_ERROR( "gpu", "GPU Error [%s(%s)]: %s (0x%04x)", tag,
+                            detail, errorName( error ), error );
+        }
+    }
+}
+
+void GLAPIENTRY GrApi::handleDebugMessage( GLenum source, GLenum type,
+                                          GLuint id, GLenum severity,
+                                          GLsizei length,
+                                          const GLchar* message,
+                                          const void* userParam )
+{
+    const char* typeName = debugTypeName( type );
+    if ( !recordError( "debug", typeName, id ) )
+    {
+        return;
+    }
+
+    if ( type == GL_DEBUG_TYPE_ERROR )
+    {
+        DEMO_LOG_ERROR( "gpu", "GPU Error [%u]: %s", id, message );
+    }
+    else
+    {
+        DEMO_LOG_WARN( "gpu", "GPU Warning [%s %u]: %s", typeName, id,
+                       message );
+    }
+}
+
 // UTILITY FUNCTIONS
 bool GrApi::startup()
 {
@@ -20,18 +140,103 @@ bool GrApi::startup()
 
 void GrApi::shutdown()
 {
+    g_hasDebugOutput = false;
     glfwTerminate();
 }
 
-void GrApi::logError( const String& tag )
+bool GrApi::installDebugOutput()
+{
+    #if DEMO_GL_DIAGNOSTICS >= 2
+    if ( !glfwExtensionSupported( "GL_KHR_debug" ) )
+    {
+        DEMO_LOG_INFO( "gpu", "KHR_debug is unavailable, checking for errors "
+                       "after each operation" );
+        return false;
+    }
+
+    glEnable( GL_DEBUG_OUTPUT );
+    glEnable( GL_DEBUG_OUTPUT_SYNCHRONOUS );
+    glDebugMessageCallback( &GrApi::handleDebugMessage, nullptr );
+
+    // notifications are informational chatter such as buffer placement
+    glDebugMessageControl( GL_DONT_CARE, GL_DONT_CARE,
+                           GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr,
+                           GL_FALSE );
+
+    g_hasDebugOutput = true;
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+void GrApi::checkFrame( const char* tag )
 {
-    int32 error = glGetError();
-    if ( error != GL_NO_ERROR )
+    if ( g_hasDebugOutput )
+    {
+        // clear the flags raised by errors the callback already reported
+        for ( uint32 i = 0; i < MAX_ERROR_FLAGS; ++i )
+        {
+            if ( glGetError() == GL_NO_ERROR )
+            {
+                break;
+            }
+        }
+    }
+    else
     {
-        std::cout << "GPU Error [" + tag + "]: " << error << std::endl;
+        reportErrors( tag, nullptr );
+    }
+
+    for ( uint32 i = 0; i < g_frameErrorCount; ++i )
+    {
+        const FrameError& error = g_frameErrors[i];
+        if ( error.count > 1 )
+        {
+            DEMO_LOG_WARN( "gpu", "GPU [%s%s%s]: 0x%04x repeated %u "
+                           "time(s) this frame", error.tag,
+                           error.detail != nullptr ? ":" : "",
+                           error.detail != nullptr ? error.detail : "",
+                           error.code, error.count );
+        }
+    }
+
+    g_frameErrorCount = 0;
+}
+
+const char* GrApi::errorName( uint32 code )
+{
+    switch ( code )
+    {
+        case GL_NO_ERROR:
+            return "GL_NO_ERROR";
+
+        case GL_INVALID_ENUM:
+            return "GL_INVALID_ENUM";
+
+        case GL_INVALID_VALUE:
+            return "GL_INVALID_VALUE";
+
+        case GL_INVALID_OPERATION:
+            return "GL_INVALID_OPERATION";
+
+        case GL_STACK_OVERFLOW:
+            return "GL_STACK_OVERFLOW";
+
+        case GL_STACK_UNDERFLOW:
+            return "GL_STACK_UNDERFLOW";
+
+        case GL_OUT_OF_MEMORY:
+            return "GL_OUT_OF_MEMORY";
+
+        case GL_INVALID_FRAMEBUFFER_OPERATION:
+            return "GL_INVALID_FRAMEBUFFER_OPERATION";
+
+        default:
+            return "unknown error";
     }
 }
 
 } // End nspc rndr
 
-} // End nspc demo
\ No newline at end of file
+} // End nspc demo
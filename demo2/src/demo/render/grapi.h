@@ -5,8 +5,13 @@
 #ifndef DEMO_GRAPI_H
 #define DEMO_GRAPI_H
 
+// if building without a GPU then record calls instead
+#if defined(DEMO_HEADLESS)
+
+#include "demo/render/headless_gl.h"
+
 // if on Windows with MinGW32 or MSVC
-#if defined(__MINGW32__) || defined(_MSC_VER)
+#elif defined(__MINGW32__) || defined(_MSC_VER)
 
 #define _GLEW_
 
@@ -22,19 +27,124 @@
 
 #endif
 
+#ifndef DEMO_HEADLESS
 #include <GLFW/glfw3.h>
+#endif
 
+#include "demo/intdef.h"
 #include "demo/strdef.h"
 
+// GL diagnostics: 0 compiles every check out, 1 samples the error flags once
+// per frame and 2 also checks after each GL operation, reporting errors from
+// the driver through KHR_debug as they happen when it is available.
+#ifndef DEMO_GL_DIAGNOSTICS
+#ifdef NDEBUG
+#define DEMO_GL_DIAGNOSTICS 0
+#else
+#define DEMO_GL_DIAGNOSTICS 2
+#endif
+#endif
+
+#if DEMO_GL_DIAGNOSTICS >= 2
+/**
+ * Reports errors raised by the preceding GL operation.
+ */
+#define DEMO_GL_CHECK( ... ) demo::rndr::GrApi::logError( __VA_ARGS__ )
+#else
+#define DEMO_GL_CHECK( ... ) ( ( void ) 0 )
+#endif
+
+#if DEMO_GL_DIAGNOSTICS >= 1
+/**
+ * Reports errors raised during the frame and the number of repeats.
+ */
+#define DEMO_GL_CHECK_FRAME( tag ) demo::rndr::GrApi::checkFrame( tag )
+#else
+#define DEMO_GL_CHECK_FRAME( tag ) ( ( void ) 0 )
+#endif
+
 namespace demo
 {
 
 namespace rndr
 {
 
-
-struct GrApi
+class GrApi
 {
+  private:
+    // CONSTANTS
+    /**
+     * The most distinct errors counted in a frame.
+     */
+    static constexpr uint32 MAX_FRAME_ERRORS = 32;
+
+    /**
+     * The most error flags read at once. A lost context may report an error
+     * on every read, so the reads are bounded.
+     */
+    static constexpr uint32 MAX_ERROR_FLAGS = 8;
+
+    // TYPES
+    /**
+     * An error seen during the current frame.
+     */
+    struct FrameError
+    {
+        const char* tag;
+        const char* detail;
+        uint32 code;
+        uint32 count;
+    };
+
+    // GLOBALS
+    /**
+     * The distinct errors seen during the current frame.
+     */
+    static FrameError g_frameErrors[MAX_FRAME_ERRORS];
+
+    /**
+     * The number of distinct errors seen during the current frame.
+     */
+    static uint32 g_frameErrorCount;
+
+    /**
+     * The number of errors seen since startup.
+     */
+    static uint64 g_errorCount;
+
+    /**
+     * Whether the driver reports errors through KHR_debug.
+     */
+    static bool g_hasDebugOutput;
+
+    // HELPER FUNCTIONS
+    /**
+     * Count an error for the current frame.
+     * @param tag The log tag.
+     * @param detail The tag detail or null.
+     * @param code The error code or debug message id.
+     * @return Is this the first time the error was seen this frame?
+     */
+    static bool recordError( const char* tag, const char* detail,
+                             uint32 code );
+
+    /**
+     * Read and report the error flags.
+     * @param tag The log tag.
+     * @param detail The tag detail or null.
+     */
+    static void reportErrors( const char* tag, const char* detail );
+
+    /**
+     * Receive a message from the driver.
+     */
+    static void GLAPIENTRY handleDebugMessage( GLenum source, GLenum type,
+                                              GLuint id, GLenum severity,
+                                              GLsizei length,
+                                              const GLchar* message,
+                                              const void* userParam );
+
+  public:
     // UTILITY FUNCTIONS
     /**
      * Initialize the graphics api.
@@ -49,13 +159,72 @@ struct GrApi
      */
     static void shutdown();
 
+    /**
+     * Have the driver report errors and warnings through KHR_debug as they
+     * happen, synchronously so that the offending call is on the stack.
+     * This must be called with the context current and only does anything
+     * when DEMO_GL_DIAGNOSTICS is 2.
+     * @return Is debug output enabled?
+     */
+    static bool installDebugOutput();
+
+    /**
+     * Print the most recent gpu error.
+     * Prefer DEMO_GL_CHECK so the check is compiled out of release builds.
+     * @param tag The log tag.
+     */
+    static void logError( const char* tag );
+
     /**
      * Print the most recent gpu error.
-     * @param The log tag.
+     * The tag and detail are only joined when there is an error to report.
+     * Prefer DEMO_GL_CHECK so the check is compiled out of release builds.
+     * @param tag The log tag.
+     * @param detail The tag detail (ie. the texture type).
+     */
+    static void logError( const char* tag, const char* detail );
+
+    /**
+     * Print the errors raised since the last check and how often each one
+     * was repeated during the frame, then start counting the next frame.
+     * Prefer DEMO_GL_CHECK_FRAME so the check can be compiled out.
+     * @param tag The log tag.
+     */
+    static void checkFrame( const char* tag );
+
+    /**
+     * Get the number of gpu errors seen since startup.
+     * @return The number of errors.
+     */
+    static uint64 errorCount();
+
+    /**
+     * Get the name of an error code.
+     * @param code The error code.
+     * @return The name.
      */
-    static void logError( const String& tag );
+    static const char* errorName( uint32 code );
 };
 
+// UTILITY FUNCTIONS
+inline
+void GrApi::logError( const char* tag )
+{
+    reportErrors( tag, nullptr );
+}
+
+inline
+void GrApi::logError( const char* tag, const char* detail )
+{
+    reportErrors( tag, detail );
+}
+
+inline
+uint64 GrApi::errorCount()
+{
+    return g_errorCount;
+}
+
 } // End nspc rndr
 
 } // End nspc demo
@@ -0,0 +1,403 @@
+// headless_gl.cpp
+#ifdef DEMO_HEADLESS
+
+#include "demo/render/headless_gl.h"
+
+#include <string.h>
+
+#include "demo/render/gl_recorder.h"
+
+using demo::rndr::GlRecorder;
+
+namespace
+{
+
+// GLOBALS
+/**
+ * The next object id handed out, zero is never a valid object.
+ */
+GLuint g_nextId = 1;
+
+/**
+ * The next uniform or attribute location handed out.
+ */
+GLint g_nextLocation = 0;
+
+/**
+ * The single headless window.
+ */
+GLFWwindow g_window = { 0, 0 };
+
+/**
+ * Whether the headless window exists.
+ */
+bool g_hasWindow = false;
+
+// HELPER FUNCTIONS
+/**
+ * Fills an array with new object ids.
+ */
+void generate( GLsizei n, GLuint* ids )
+{
+    for ( GLsizei i = 0; i < n; ++i )
+    {
+        ids[i] = g_nextId++;
+    }
+}
+
+} // End nspc anonymous
+
+// OPENGL FUNCTIONS
+void glActiveTexture( GLenum texture )
+{
+    GlRecorder::record( GlRecorder::ACTIVE_TEXTURE );
+}
+
+void glAttachShader( GLuint program, GLuint shader )
+{
+    GlRecorder::record( GlRecorder::ATTACH_SHADER );
+}
+
+void glBindBuffer( GLenum target, GLuint buffer )
+{
+    GlRecorder::record( GlRecorder::BIND_BUFFER );
+}
+
+void glBindTexture( GLenum target, GLuint texture )
+{
+    GlRecorder::record( GlRecorder::BIND_TEXTURE );
+}
+
+void glBindVertexArray( GLuint array )
+{
+    GlRecorder::record( GlRecorder::BIND_VERTEX_ARRAY );
+}
+
+void glBufferData( GLenum target, GLsizeiptr size, const GLvoid* data,
+                   GLenum usage )
+{
+    GlRecorder::record( GlRecorder::BUFFER_DATA );
+    GlRecorder::recordUpload( static_cast<demo::uint64>( size ) );
+}
+
+void glClear( GLbitfield mask )
+{
+    GlRecorder::record( GlRecorder::CLEAR );
+}
+
+void glClearColor( GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha )
+{
+    GlRecorder::record( GlRecorder::CLEAR_COLOR );
+}
+
+void glCompileShader( GLuint shader )
+{
+    GlRecorder::record( GlRecorder::COMPILE_SHADER );
+}
+
+GLuint glCreateProgram()
+{
+    GlRecorder::record( GlRecorder::CREATE_PROGRAM );
+    return g_nextId++;
+}
+
+GLuint glCreateShader( GLenum type )
+{
+    GlRecorder::record( GlRecorder::CREATE_SHADER );
+    return g_nextId++;
+}
+
+void glDebugMessageCallback( GLDEBUGPROC callback, const void* userParam )
+{
+    // the headless driver never has anything to report
+    GlRecorder::record( GlRecorder::DEBUG_MESSAGE_CALLBACK );
+}
+
+void glDebugMessageControl( GLenum source, GLenum type, GLenum severity,
+                            GLsizei count, const GLuint* ids,
+                            GLboolean enabled )
+{
+    GlRecorder::record( GlRecorder::DEBUG_MESSAGE_CONTROL );
+}
+
+void glDeleteBuffers( GLsizei n, const GLuint* buffers )
+{
+    GlRecorder::record( GlRecorder::DELETE_BUFFERS );
+}
+
+void glDeleteProgram( GLuint program )
+{
+    GlRecorder::record( GlRecorder::DELETE_PROGRAM );
+}
+
+void glDeleteShader( GLuint shader )
+{
+    GlRecorder::record( GlRecorder::DELETE_SHADER );
+}
+
+void glDeleteTextures( GLsizei n, const GLuint* textures )
+{
+    GlRecorder::record( GlRecorder::DELETE_TEXTURES );
+}
+
+void glDeleteVertexArrays( GLsizei n, const GLuint* arrays )
+{
+    GlRecorder::record( GlRecorder::DELETE_VERTEX_ARRAYS );
+}
+
+void glDetachShader( GLuint program, GLuint shader )
+{
+    GlRecorder::record( GlRecorder::DETACH_SHADER );
+}
+
+void glDrawElements( GLenum mode, GLsizei count, GLenum type,
+                     const GLvoid* indices )
+{
+    GlRecorder::record( GlRecorder::DRAW_ELEMENTS );
+}
+
+void glEnable( GLenum cap )
+{
+    GlRecorder::record( GlRecorder::ENABLE );
+}
+
+void glEnableVertexAttribArray( GLuint index )
+{
+    GlRecorder::record( GlRecorder::ENABLE_VERTEX_ATTRIB_ARRAY );
+}
+
+void glGenBuffers( GLsizei n, GLuint* buffers )
+{
+    GlRecorder::record( GlRecorder::GEN_BUFFERS );
+    generate( n, buffers );
+}
+
+void glGenTextures( GLsizei n, GLuint* textures )
+{
+    GlRecorder::record( GlRecorder::GEN_TEXTURES );
+    generate( n, textures );
+}
+
+void glGenVertexArrays( GLsizei n, GLuint* arrays )
+{
+    GlRecorder::record( GlRecorder::GEN_VERTEX_ARRAYS );
+    generate( n, arrays );
+}
+
+void glGenerateMipmap( GLenum target )
+{
+    GlRecorder::record( GlRecorder::GENERATE_MIPMAP );
+}
+
+GLint glGetAttribLocation( GLuint program, const GLchar* name )
+{
+    GlRecorder::record( GlRecorder::GET_ATTRIB_LOCATION );
+    return g_nextLocation++;
+}
+
+GLenum glGetError()
+{
+    GlRecorder::record( GlRecorder::GET_ERROR );
+    return GL_NO_ERROR;
+}
+
+void glGetProgramInfoLog( GLuint program, GLsizei bufSize, GLsizei* length,
+                          GLchar* infoLog )
+{
+    GlRecorder::record( GlRecorder::GET_PROGRAM_INFO_LOG );
+    if ( bufSize > 0 )
+    {
+        infoLog[0] = '\0';
+    }
+}
+
+void glGetProgramiv( GLuint program, GLenum pname, GLint* params )
+{
+    GlRecorder::record( GlRecorder::GET_PROGRAMIV );
+    *params = pname == GL_LINK_STATUS ? GL_TRUE : 0;
+}
+
+void glGetShaderInfoLog( GLuint shader, GLsizei bufSize, GLsizei* length,
+                         GLchar* infoLog )
+{
+    GlRecorder::record( GlRecorder::GET_SHADER_INFO_LOG );
+    if ( bufSize > 0 )
+    {
+        infoLog[0] = '\0';
+    }
+}
+
+void glGetShaderiv( GLuint shader, GLenum pname, GLint* params )
+{
+    GlRecorder::record( GlRecorder::GET_SHADERIV );
+    *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+const GLubyte* glGetString( GLenum name )
+{
+    GlRecorder::record( GlRecorder::GET_STRING );
+    return reinterpret_cast<const GLubyte*>( "headless" );
+}
+
+GLint glGetUniformLocation( GLuint program, const GLchar* name )
+{
+    GlRecorder::record( GlRecorder::GET_UNIFORM_LOCATION );
+    return g_nextLocation++;
+}
+
+void glLinkProgram( GLuint program )
+{
+    GlRecorder::record( GlRecorder::LINK_PROGRAM );
+}
+
+void glShaderSource( GLuint shader, GLsizei count,
+                     const GLchar* const* string, const GLint* length )
+{
+    GlRecorder::record( GlRecorder::SHADER_SOURCE );
+}
+
+void glTexImage2D( GLenum target, GLint level, GLint internalformat,
+                   GLsizei width, GLsizei height, GLint border, GLenum format,
+                   GLenum type, const GLvoid* pixels )
+{
+    GlRecorder::record( GlRecorder::TEX_IMAGE_2D );
+
+    // every format the demo uploads is four bytes per pixel
+    GlRecorder::recordUpload( static_cast<demo::uint64>( width ) * height *
+                              4 );
+}
+
+void glTexParameteri( GLenum target, GLenum pname, GLint param )
+{
+    GlRecorder::record( GlRecorder::TEX_PARAMETERI );
+}
+
+void glUniform1f( GLint location, GLfloat v0 )
+{
+    GlRecorder::record( GlRecorder::UNIFORM_1F );
+}
+
+void glUniform1i( GLint location, GLint v0 )
+{
+    GlRecorder::record( GlRecorder::UNIFORM_1I );
+}
+
+void glUniform1ui( GLint location, GLuint v0 )
+{
+    GlRecorder::record( GlRecorder::UNIFORM_1UI );
+}
+
+void glUniform3fv( GLint location, GLsizei count, const GLfloat* value )
+{
+    GlRecorder::record( GlRecorder::UNIFORM_3FV );
+}
+
+void glUniformMatrix3fv( GLint location, GLsizei count, GLboolean transpose,
+                         const GLfloat* value )
+{
+    GlRecorder::record( GlRecorder::UNIFORM_MATRIX_3FV );
+}
+
+void glUniformMatrix4fv( GLint location, GLsizei count, GLboolean transpose,
+                         const GLfloat* value )
+{
+    GlRecorder::record( GlRecorder::UNIFORM_MATRIX_4FV );
+}
+
+void glUseProgram( GLuint program )
+{
+    GlRecorder::record( GlRecorder::USE_PROGRAM );
+}
+
+void glVertexAttribPointer( GLuint index, GLint size, GLenum type,
+                            GLboolean normalized, GLsizei stride,
+                            const GLvoid* pointer )
+{
+    GlRecorder::record( GlRecorder::VERTEX_ATTRIB_POINTER );
+}
+
+void glViewport( GLint x, GLint y, GLsizei width, GLsizei height )
+{
+    GlRecorder::record( GlRecorder::VIEWPORT );
+}
+
+// GLFW FUNCTIONS
+int glfwInit()
+{
+    return 1;
+}
+
+void glfwTerminate()
+{
+    g_hasWindow = false;
+}
+
+void glfwPollEvents()
+{
+}
+
+void glfwWindowHint( int hint, int value )
+{
+}
+
+GLFWwindow* glfwCreateWindow( int width, int height, const char* title,
+                              GLFWmonitor* monitor, GLFWwindow* share )
+{
+    // the demo only ever needs one window
+    if ( g_hasWindow )
+    {
+        return nullptr;
+    }
+
+    g_hasWindow = true;
+    g_window.width = width;
+    g_window.height = height;
+    return &g_window;
+}
+
+void glfwDestroyWindow( GLFWwindow* window )
+{
+    g_hasWindow = false;
+}
+
+void glfwMakeContextCurrent( GLFWwindow* window )
+{
+}
+
+void glfwSetWindowTitle( GLFWwindow* window, const char* title )
+{
+}
+
+void glfwSetWindowSize( GLFWwindow* window, int width, int height )
+{
+    window->width = width;
+    window->height = height;
+}
+
+void glfwGetWindowSize( GLFWwindow* window, int* width, int* height )
+{
+    *width = window->width;
+    *height = window->height;
+}
+
+int glfwGetWindowAttrib( GLFWwindow* window, int attrib )
+{
+    // the headless window is always in the foreground
+    return attrib == GLFW_FOCUSED ? 1 : 0;
+}
+
+int glfwExtensionSupported( const char* extension )
+{
+    return strcmp( extension, "GL_KHR_debug" ) == 0 ? 1 : 0;
+}
+
+int glfwWindowShouldClose( GLFWwindow* window )
+{
+    return 0;
+}
+
+void glfwSwapBuffers( GLFWwindow* window )
+{
+}
+
+#endif // DEMO_HEADLESS
@@ -0,0 +1,193 @@
+// headless_gl.h
+//
+// A recording stand-in for the subset of OpenGL and GLFW the demo uses.
+//
+// Headless builds include this in place of the real graphics headers. Every
+// entry point does nothing except record the call with the GlRecorder and
+// hand back plausible results: objects get increasing ids, shaders always
+// compile and link, and the single window never closes. No GPU, display or
+// driver is required.
+//
+// Only the declarations needed by the demo are provided; add the entry point
+// here and to GlRecorder when the renderer starts using a new one.
+//
+#ifndef DEMO_HEADLESS_GL_H
+#define DEMO_HEADLESS_GL_H
+
+#include <stddef.h>
+
+// TYPES
+typedef unsigned int GLenum;
+typedef unsigned int GLuint;
+typedef int GLint;
+typedef int GLsizei;
+typedef char GLchar;
+typedef void GLvoid;
+typedef float GLfloat;
+typedef unsigned char GLboolean;
+typedef unsigned int GLbitfield;
+typedef unsigned char GLubyte;
+typedef ptrdiff_t GLsizeiptr;
+
+#define GLAPIENTRY
+
+typedef void ( GLAPIENTRY *GLDEBUGPROC )( GLenum source, GLenum type,
+                                          GLuint id, GLenum severity,
+                                          GLsizei length,
+                                          const GLchar* message,
+                                          const void* userParam );
+
+/**
+ * The state of the headless window.
+ */
+struct GLFWwindow
+{
+    int width;
+    int height;
+};
+
+typedef struct GLFWmonitor GLFWmonitor;
+
+// CONSTANTS
+#define GL_FALSE                        0
+#define GL_TRUE                         1
+#define GL_NO_ERROR                     0
+#define GL_TRIANGLES                    0x0004
+#define GL_INVALID_ENUM                 0x0500
+#define GL_INVALID_VALUE                0x0501
+#define GL_INVALID_OPERATION            0x0502
+#define GL_STACK_OVERFLOW               0x0503
+#define GL_STACK_UNDERFLOW              0x0504
+#define GL_OUT_OF_MEMORY                0x0505
+#define GL_INVALID_FRAMEBUFFER_OPERATION 0x0506
+#define GL_CULL_FACE                    0x0B44
+#define GL_DEPTH_TEST                   0x0B71
+#define GL_TEXTURE_2D                   0x0DE1
+#define GL_UNSIGNED_BYTE                0x1401
+#define GL_UNSIGNED_INT                 0x1405
+#define GL_FLOAT                        0x1406
+#define GL_LUMINANCE                    0x1909
+#define GL_RGBA                         0x1908
+#define GL_DONT_CARE                    0x1100
+#define GL_VERSION                      0x1F02
+#define GL_LINEAR                       0x2601
+#define GL_LINEAR_MIPMAP_LINEAR         0x2703
+#define GL_TEXTURE_MAG_FILTER           0x2800
+#define GL_TEXTURE_MIN_FILTER           0x2801
+#define GL_TEXTURE_WRAP_S               0x2802
+#define GL_TEXTURE_WRAP_T               0x2803
+#define GL_REPEAT                       0x2901
+#define GL_LUMINANCE8                   0x8040
+#define GL_BGRA                         0x80E1
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS     0x8242
+#define GL_DEBUG_TYPE_ERROR             0x824C
+#define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR 0x824D
+#define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR 0x824E
+#define GL_DEBUG_TYPE_PORTABILITY       0x824F
+#define GL_DEBUG_TYPE_PERFORMANCE       0x8250
+#define GL_DEBUG_SEVERITY_NOTIFICATION  0x826B
+#define GL_TEXTURE0                     0x84C0
+#define GL_ARRAY_BUFFER                 0x8892
+#define GL_ELEMENT_ARRAY_BUFFER         0x8893
+#define GL_STATIC_DRAW                  0x88E4
+#define GL_FRAGMENT_SHADER              0x8B30
+#define GL_VERTEX_SHADER                0x8B31
+#define GL_COMPILE_STATUS               0x8B81
+#define GL_LINK_STATUS                  0x8B82
+#define GL_INFO_LOG_LENGTH              0x8B84
+#define GL_GEOMETRY_SHADER              0x8DD9
+#define GL_TESS_EVALUATION_SHADER       0x8E87
+#define GL_TESS_CONTROL_SHADER          0x8E88
+#define GL_COMPUTE_SHADER               0x91B9
+#define GL_DEBUG_OUTPUT                 0x92E0
+#define GL_DEPTH_BUFFER_BIT             0x00000100
+#define GL_COLOR_BUFFER_BIT             0x00004000
+
+#define GLFW_FOCUSED                    0x00020001
+#define GLFW_ICONIFIED                  0x00020002
+#define GLFW_CONTEXT_VERSION_MAJOR      0x00022002
+#define GLFW_CONTEXT_VERSION_MINOR      0x00022003
+#define GLFW_OPENGL_DEBUG_CONTEXT       0x00022007
+#define GLFW_OPENGL_PROFILE             0x00022008
+#define GLFW_OPENGL_CORE_PROFILE        0x00032001
+
+// OPENGL FUNCTIONS
+void glActiveTexture( GLenum texture );
+void glAttachShader( GLuint program, GLuint shader );
+void glBindBuffer( GLenum target, GLuint buffer );
+void glBindTexture( GLenum target, GLuint texture );
+void glBindVertexArray( GLuint array );
+void glBufferData( GLenum target, GLsizeiptr size, const GLvoid* data,
+                   GLenum usage );
+void glClear( GLbitfield mask );
+void glClearColor( GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha );
+void glCompileShader( GLuint shader );
+GLuint glCreateProgram();
+GLuint glCreateShader( GLenum type );
+void glDebugMessageCallback( GLDEBUGPROC callback, const void* userParam );
+void glDebugMessageControl( GLenum source, GLenum type, GLenum severity,
+                            GLsizei count, const GLuint* ids,
+                            GLboolean enabled );
+void glDeleteBuffers( GLsizei n, const GLuint* buffers );
+void glDeleteProgram( GLuint program );
+void glDeleteShader( GLuint shader );
+void glDeleteTextures( GLsizei n, const GLuint* textures );
+void glDeleteVertexArrays( GLsizei n, const GLuint* arrays );
+void glDetachShader( GLuint program, GLuint shader );
+void glDrawElements( GLenum mode, GLsizei count, GLenum type,
+                     const GLvoid* indices );
+void glEnable( GLenum cap );
+void glEnableVertexAttribArray( GLuint index );
+void glGenBuffers( GLsizei n, GLuint* buffers );
+void glGenTextures( GLsizei n, GLuint* textures );
+void glGenVertexArrays( GLsizei n, GLuint* arrays );
+void glGenerateMipmap( GLenum target );
+GLint glGetAttribLocation( GLuint program, const GLchar* name );
+GLenum glGetError();
+void glGetProgramInfoLog( GLuint program, GLsizei bufSize, GLsizei* length,
+                          GLchar* infoLog );
+void glGetProgramiv( GLuint program, GLenum pname, GLint* params );
+void glGetShaderInfoLog( GLuint shader, GLsizei bufSize, GLsizei* length,
+                         GLchar* infoLog );
+void glGetShaderiv( GLuint shader, GLenum pname, GLint* params );
+const GLubyte* glGetString( GLenum name );
+GLint glGetUniformLocation( GLuint program, const GLchar* name );
+void glLinkProgram( GLuint program );
+void glShaderSource( GLuint shader, GLsizei count,
+                     const GLchar* const* string, const GLint* length );
+void glTexImage2D( GLenum target, GLint level, GLint internalformat,
+                   GLsizei width, GLsizei height, GLint border, GLenum format,
+                   GLenum type, const GLvoid* pixels );
+void glTexParameteri( GLenum target, GLenum pname, GLint param );
+void glUniform1f( GLint location, GLfloat v0 );
+void glUniform1i( GLint location, GLint v0 );
+void glUniform1ui( GLint location, GLuint v0 );
+void glUniform3fv( GLint location, GLsizei count, const GLfloat* value );
+void glUniformMatrix3fv( GLint location, GLsizei count, GLboolean transpose,
+                         const GLfloat* value );
+void glUniformMatrix4fv( GLint location, GLsizei count, GLboolean transpose,
+                         const GLfloat* value );
+void glUseProgram( GLuint program );
+void glVertexAttribPointer( GLuint index, GLint size, GLenum type,
+                            GLboolean normalized, GLsizei stride,
+                            const GLvoid* pointer );
+void glViewport( GLint x, GLint y, GLsizei width, GLsizei height );
+
+// GLFW FUNCTIONS
+int glfwInit();
+void glfwTerminate();
+void glfwPollEvents();
+void glfwWindowHint( int hint, int value );
+GLFWwindow* glfwCreateWindow( int width, int height, const char* title,
+                              GLFWmonitor* monitor, GLFWwindow* share );
+void glfwDestroyWindow( GLFWwindow* window );
+void glfwMakeContextCurrent( GLFWwindow* window );
+void glfwSetWindowTitle( GLFWwindow* window, const char* title );
+void glfwSetWindowSize( GLFWwindow* window, int width, int height );
+void glfwGetWindowSize( GLFWwindow* window, int* width, int* height );
+int glfwGetWindowAttrib( GLFWwindow* window, int attrib );
+int glfwExtensionSupported( const char* extension );
+int glfwWindowShouldClose( GLFWwindow* window );
+void glfwSwapBuffers( GLFWwindow* window );
+
+#endif // DEMO_HEADLESS_GL_H
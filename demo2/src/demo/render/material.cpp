@@ -3,6 +3,8 @@
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include "demo/utility/profiler.h"
+
 namespace demo
 {
 
@@ -96,6 +98,8 @@ void Material::load( cntr::DynamicArray<TexturePtr>&& textures,
 
 void Material::bind( const Shader& shader )
 {
+    DEMO_PROFILE_SCOPE( "Material::bind" );
+
     if ( !isLoaded() )
     {
         return;
@@ -127,7 +131,7 @@ void Material::bind( const Shader& shader )
         glUniform1ui( shader.valMatFlags(), _texFlags );
     }
 
-    GrApi::logError( "Material.bind" );
+    DEMO_GL_CHECK( "Material.bind" );
 }
 
 void Material::unbind()
@@ -143,7 +147,7 @@ void Material::unbind()
         ( *iter )->unbind();
     }
 
-    GrApi::logError( "Material.unbind" );
+    DEMO_GL_CHECK( "Material.unbind" );
 }
 
 } // End nspc rndr
@@ -218,7 +218,7 @@ void Material::push( const Shader& shader )
         ( *iter )->push( shader );
     }
 
-    GrApi::logError( "Material.push" );
+    DEMO_GL_CHECK( "Material.push" );
 }
 
 inline
@@ -229,7 +229,7 @@ void Material::remove()
         ( *iter )->remove();
     }
 
-    GrApi::logError( "Material.remove" );
+    DEMO_GL_CHECK( "Material.remove" );
 }
 
 } // End npsc rndr
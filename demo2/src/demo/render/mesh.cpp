@@ -21,6 +21,7 @@ Mesh& Mesh::operator=( const Mesh& other )
     _indices = other._indices;
     _gl = GlMesh();
     _materialIndex = other._materialIndex;
+    _bounds = other._bounds;
     _isLoaded = other._isLoaded;
     _isOnGpu = false;
 
@@ -38,11 +39,13 @@ Mesh& Mesh::operator=( Mesh&& other )
     _indices = std::move( other._indices );
     _gl = std::move( other._gl );
     _materialIndex = other._materialIndex;
+    _bounds = other._bounds;
     _isLoaded = other._isLoaded;
     _isOnGpu = other._isOnGpu;
 
     other._gl = GlMesh();
     other._materialIndex = NO_MATERIAL;
+    other._bounds = Bounds();
     other._isLoaded = false;
     other._isOnGpu = false;
 
@@ -52,7 +55,7 @@ Mesh& Mesh::operator=( Mesh&& other )
 // MEMBER FUNCTIONS
 void Mesh::load( cntr::FixedArray<Vertex>&& vertices,
                  cntr::FixedArray<uint32>&& indices,
-                 uint32 materialIndex )
+                 uint32 materialIndex, const Bounds& bounds )
 {
     if ( isOnGpu() )
     {
@@ -62,6 +65,7 @@ void Mesh::load( cntr::FixedArray<Vertex>&& vertices,
     _vertices = std::move( vertices );
     _indices = std::move( indices );
     _materialIndex = materialIndex;
+    _bounds = bounds;
 
     _isLoaded = true;
 }
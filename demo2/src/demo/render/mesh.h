@@ -13,6 +13,7 @@
 #include <glm/glm.hpp>
 
 #include "demo/container/fixed_array.h"
+#include "demo/render/bounds.h"
 #include "demo/render/irenderable.h"
 #include "demo/render/material.h"
 
@@ -89,6 +90,11 @@ class Mesh : public IRenderable
      */
     uint32 _materialIndex;
 
+    /**
+     * The bounds of the vertices.
+     */
+    Bounds _bounds;
+
     /**
      * Whether the mesh has been loaded.
      */
@@ -185,6 +191,24 @@ class Mesh : public IRenderable
      */
     uint32 materialIndex() const;
 
+    /**
+     * Get the bounds of the vertices.
+     * @return The bounds.
+     */
+    const Bounds& bounds() const;
+
+    /**
+     * Get the vertices.
+     * @return The vertices.
+     */
+    const cntr::FixedArray<Vertex>& vertices() const;
+
+    /**
+     * Get the vertex indices, three per triangle.
+     * @return The indices.
+     */
+    const cntr::FixedArray<uint32>& indices() const;
+
     /**
      * Check if the mesh has been loaded.
      * @return Is it loaded?
@@ -205,10 +229,11 @@ class Mesh : public IRenderable
      * @param vertices The mesh vertices.
      * @param indices The mesh indices.
      * @param materialIndex The index of the material to use.
+     * @param bounds The bounds of the vertices.
      */
     void load( cntr::FixedArray<Vertex>&& vertices,
                cntr::FixedArray<uint32>&& indices,
-               uint32 materialIndex );
+               uint32 materialIndex, const Bounds& bounds );
 
     /**
      * Push the mesh to the GPU.
@@ -235,7 +260,7 @@ class Mesh : public IRenderable
 // CONSTRUCTORS
 inline
 Mesh::Mesh() : _vertices(), _indices(), _gl(), _materialIndex( NO_MATERIAL ),
-               _isLoaded(), _isOnGpu()
+               _bounds(), _isLoaded(), _isOnGpu()
 {
 }
 
@@ -243,7 +268,7 @@ inline
 Mesh::Mesh( const Mesh& other )
         : _vertices( other._vertices ), _indices( other._indices ),
           _materialIndex( other._materialIndex ), _gl(),
-          _isLoaded( other._isLoaded ), _isOnGpu()
+          _bounds( other._bounds ), _isLoaded( other._isLoaded ), _isOnGpu()
 {
 }
 
@@ -252,11 +277,13 @@ Mesh::Mesh( Mesh&& other ) : _vertices( std::move( other._vertices ) ),
                              _indices( std::move( other._indices ) ),
                              _materialIndex( other._materialIndex ),
                              _gl( std::move( other._gl ) ),
+                             _bounds( other._bounds ),
                              _isLoaded( other._isLoaded ),
                              _isOnGpu( other._isOnGpu )
 {
     other._gl = GlMesh();
     other._materialIndex = NO_MATERIAL;
+    other._bounds = Bounds();
     other._isLoaded = false;
     other._isOnGpu = false;
 }
@@ -277,6 +304,24 @@ uint32 Mesh::materialIndex() const
     return _materialIndex;
 }
 
+inline
+const Bounds& Mesh::bounds() const
+{
+    return _bounds;
+}
+
+inline
+const cntr::FixedArray<Mesh::Vertex>& Mesh::vertices() const
+{
+    return _vertices;
+}
+
+inline
+const cntr::FixedArray<uint32>& Mesh::indices() const
+{
+    return _indices;
+}
+
 // MEMBER FUNCTIONS
 inline
 bool Mesh::isLoaded() const
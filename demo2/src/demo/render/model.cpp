@@ -1,12 +1,36 @@
 // model.cpp
 #include "model.h"
 
+#include <algorithm>
+
+#include "demo/utility/profiler.h"
+#include "demo/utility/simd_kernels.h"
+
 namespace demo
 {
 
 namespace rndr
 {
 
+// CONSTANTS
+constexpr uint32 Model::CULL_BATCH_SIZE;
+
+// HELPER FUNCTIONS
+void Model::renderMesh( const Shader& shader, Mesh& mesh )
+{
+    if ( _materials.size() > 0 )
+    {
+        _materials[mesh.materialIndex()].bind( shader );
+    }
+
+    mesh.render( shader );
+
+    if ( _materials.size() > 0 )
+    {
+        _materials[mesh.materialIndex()].unbind();
+    }
+}
+
 // OPERATORS
 Model& Model::operator=( Model&& other )
 {
@@ -16,8 +40,15 @@ Model& Model::operator=( Model&& other )
     }
 
     _meshes = std::move( other._meshes );
+    _materials = std::move( other._materials );
+    _meshBoxes = std::move( other._meshBoxes );
+    _bounds = other._bounds;
+    _occluder = std::move( other._occluder );
+    _isLoaded = other._isLoaded;
     _isOnGpu = other._isOnGpu;
 
+    other._bounds = Bounds();
+    other._isLoaded = false;
     other._isOnGpu = false;
 
     return *this;
@@ -31,6 +62,29 @@ void Model::load( cntr::FixedArray<Mesh>&& meshes,
 
     _meshes = std::move( meshes );
     _materials = std::move( materials );
+
+    const uint32 ROWS = util::SimdKernels::BOX_COMPONENTS;
+    // like the empty model's arrays, this keeps room for at least one value
+    _meshBoxes = cntr::FixedArray<float>(
+        std::max( _meshes.size() * ROWS, static_cast<uint32>( 1 ) ) );
+    _bounds = Bounds();
+    for ( uint32 row = 0; row < ROWS; ++row )
+    {
+        for ( uint32 i = 0; i < _meshes.size(); ++i )
+        {
+            const Bounds& bounds = _meshes[i].bounds();
+            _meshBoxes.push( row < 3 ? bounds.center()[row] :
+                                       bounds.extents()[row - 3] );
+        }
+    }
+
+    for ( uint32 i = 0; i < _meshes.size(); ++i )
+    {
+        _bounds.merge( _meshes[i].bounds() );
+    }
+
+    _occluder.build( _meshes );
+
     _isLoaded = true;
     _isOnGpu = false;
 }
@@ -52,13 +106,15 @@ void Model::push( const Shader& shader )
         iter->push( shader );
     }
 
-    GrApi::logError( "Model.push" );
+    DEMO_GL_CHECK( "Model.push" );
 
     _isOnGpu = true;
 }
 
 void Model::render( const Shader& shader )
 {
+    DEMO_PROFILE_SCOPE( "Model::render" );
+
     if ( !isOnGpu() )
     {
         return;
@@ -66,20 +122,46 @@ void Model::render( const Shader& shader )
 
     for ( auto iter = _meshes.begin(); iter != _meshes.end(); ++iter )
     {
-        if ( _materials.size() > 0 )
+        renderMesh( shader, *iter );
+    }
+
+    DEMO_GL_CHECK( "Model.render" );
+}
+
+uint32 Model::render( const Shader& shader, const Frustum& frustum )
+{
+    DEMO_PROFILE_SCOPE( "Model::render" );
+
+    if ( !isOnGpu() )
+    {
+        return 0;
+    }
+
+    const uint32 ROWS = util::SimdKernels::BOX_COMPONENTS;
+
+    uint32 visible[CULL_BATCH_SIZE];
+    uint32 culled = 0;
+    for ( uint32 first = 0; first < _meshes.size(); first += CULL_BATCH_SIZE )
+    {
+        uint32 count = std::min( _meshes.size() - first, CULL_BATCH_SIZE );
+
+        const float* boxes[ROWS];
+        for ( uint32 row = 0; row < ROWS; ++row )
         {
-            _materials[iter->materialIndex()].bind( shader );
+            boxes[row] = &_meshBoxes[row * _meshes.size() + first];
         }
 
-        iter->render( shader );
-
-        if ( _materials.size() > 0 )
+        uint32 visibleCount = util::SimdKernels::cullBoxes(
+            visible, frustum.planes(), boxes, count );
+        for ( uint32 i = 0; i < visibleCount; ++i )
         {
-            _materials[iter->materialIndex()].unbind();
+            renderMesh( shader, _meshes[first + visible[i]] );
         }
+        culled += count - visibleCount;
     }
 
-    GrApi::logError( "Model.render" );
+    DEMO_GL_CHECK( "Model.render" );
+    return culled;
 }
 
 void Model::remove()
@@ -99,7 +181,7 @@ void Model::remove()
         iter->remove();
     }
 
-    GrApi::logError( "Model.remove" );
+    DEMO_GL_CHECK( "Model.remove" );
 
     _isOnGpu = false;
 }
@@ -2,13 +2,23 @@
 //
 // Container class for a 3D model.
 //
+// The model's bounds contain the bounds of all of its meshes. The mesh
+// bounds are also kept as rows of box components so that the meshes can be
+// culled together when the model is rendered against a frustum.
+//
+// A simplified occluder of all of the meshes is built when the model is
+// loaded, for objects that hide what is behind them (see rndr::Occluder).
+//
 #ifndef DEMO_MODEL_H
 #define DEMO_MODEL_H
 
 #include "demo/intdef.h"
 #include "demo/container/fixed_array.h"
+#include "demo/render/bounds.h"
+#include "demo/render/frustum.h"
 #include "demo/render/irenderable.h"
 #include "demo/render/mesh.h"
+#include "demo/render/occluder.h"
 #include "demo/strdef.h"
 
 namespace demo
@@ -32,6 +42,12 @@ typedef Model* ModelPtr;
 class Model : public IRenderable
 {
   private:
+    // CONSTANTS
+    /**
+     * The number of meshes culled at a time.
+     */
+    static constexpr uint32 CULL_BATCH_SIZE = 64;
+
     // MEMBERS
     /**
      * The meshes that make up the model.
@@ -43,6 +59,21 @@ class Model : public IRenderable
      */
     cntr::FixedArray<Material> _materials;
 
+    /**
+     * The boxes of the meshes, as a row of each box component.
+     */
+    cntr::FixedArray<float> _meshBoxes;
+
+    /**
+     * The bounds of all of the meshes.
+     */
+    Bounds _bounds;
+
+    /**
+     * The simplified geometry of all of the meshes.
+     */
+    Occluder _occluder;
+
     /**
      * Whether the model has been loaded.
      */
@@ -53,6 +84,14 @@ class Model : public IRenderable
      */
     bool _isOnGpu;
 
+    // HELPER FUNCTIONS
+    /**
+     * Draw a mesh with its material.
+     * @param shader The shader to render with.
+     * @param mesh The mesh.
+     */
+    void renderMesh( const Shader& shader, Mesh& mesh );
+
   public:
     // CONSTRUCTORS
     /**
@@ -91,6 +130,18 @@ class Model : public IRenderable
      */
     bool isOnGpu() const;
 
+    /**
+     * Get the bounds of all of the meshes.
+     * @return The bounds, which are empty until the model is loaded.
+     */
+    const Bounds& bounds() const;
+
+    /**
+     * Get the simplified geometry of all of the meshes.
+     * @return The occluder, which is empty until the model is loaded.
+     */
+    const Occluder& occluder() const;
+
     // OPERATORS
     /**
      * Assign as a copy of another model.
@@ -132,6 +183,15 @@ class Model : public IRenderable
      */
     virtual void render( const Shader& shader );
 
+    /**
+     * Render the meshes that are inside a frustum.
+     * This does nothing if not on the GPU.
+     * @param shader The shader to render with.
+     * @param frustum The frustum in the model's space.
+     * @return The number of meshes culled.
+     */
+    uint32 render( const Shader& shader, const Frustum& frustum );
+
     /**
      * Remove from the GPU.
      * This does nothing if not on the GPU.
@@ -141,23 +201,30 @@ class Model : public IRenderable
 
 // CONSTRUCTORS
 inline
-Model::Model() : _meshes( 1 ), _materials( 1 ), _isLoaded(), _isOnGpu()
+Model::Model() : _meshes( 1 ), _materials( 1 ), _meshBoxes( 1 ), _bounds(),
+                 _occluder(), _isLoaded(), _isOnGpu()
 {
 }
 
 inline
 Model::Model( const Model& other )
         : _meshes( other._meshes ), _materials( other._materials ),
-          _isLoaded( other._isLoaded ), _isOnGpu()
+          _meshBoxes( other._meshBoxes ), _bounds( other._bounds ),
+          _occluder( other._occluder ), _isLoaded( other._isLoaded ),
+          _isOnGpu()
 {
 }
 
 inline
 Model::Model( Model&& other ) : _meshes( std::move( other._meshes ) ),
                                 _materials( std::move( other._materials ) ),
+                                _meshBoxes( std::move( other._meshBoxes ) ),
+                                _bounds( other._bounds ),
+                                _occluder( std::move( other._occluder ) ),
                                 _isLoaded( other._isLoaded ),
                                 _isOnGpu( other._isOnGpu )
 {
+    other._bounds = Bounds();
     other._isLoaded = false;
     other._isOnGpu = false;
 }
@@ -178,6 +245,9 @@ Model& Model::operator=( const Model& other )
 
     _meshes = other._meshes;
     _materials = other._materials;
+    _meshBoxes = other._meshBoxes;
+    _bounds = other._bounds;
+    _occluder = other._occluder;
     _isLoaded = other._isLoaded;
 
     return *this;
@@ -196,6 +266,18 @@ bool Model::isOnGpu() const
     return _isOnGpu;
 }
 
+inline
+const Bounds& Model::bounds() const
+{
+    return _bounds;
+}
+
+inline
+const Occluder& Model::occluder() const
+{
+    return _occluder;
+}
+
 } // End nspc rndr
 
 } // End nspc demo
@@ -0,0 +1,216 @@
+// occluder.cpp
+#include "occluder.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "demo/utility/profiler.h"
+
+namespace demo
+{
+
+namespace rndr
+{
+
+// CONSTANTS
+constexpr uint32 Occluder::MAX_TRIANGLES;
+constexpr uint32 Occluder::MAX_GRID_SIZE;
+
+// HELPER FUNCTIONS
+bool Occluder::cluster( const cntr::DynamicArray<glm::vec3>& positions,
+                        const cntr::DynamicArray<uint32>& indices,
+                        const glm::vec3& min, const glm::vec3& max,
+                        uint32 gridSize, uint32 maxTriangles )
+{
+    const uint32 NO_VERTEX = static_cast<uint32>( -1 );
+
+    glm::vec3 scale;
+    for ( uint32 axis = 0; axis < 3; ++axis )
+    {
+        float size = max[axis] - min[axis];
+        scale[axis] = size > 0.0f ? gridSize / size : 0.0f;
+    }
+
+    // sort the vertices by cell, so each cell's vertices are consecutive
+    cntr::DynamicArray<uint64> cells;
+    for ( uint32 i = 0; i < positions.size(); ++i )
+    {
+        glm::vec3 coords = ( positions[i] - min ) * scale;
+        uint64 cell = 0;
+        for ( uint32 axis = 3; axis-- > 0; )
+        {
+            uint32 coord = std::min( static_cast<uint32>( coords[axis] ),
+                                     gridSize - 1 );
+            cell = cell * gridSize + coord;
+        }
+        cells.push( cell << 32 | i );
+    }
+    std::sort( &cells[0], &cells[0] + cells.size() );
+
+    // each cell's vertices become a cluster at their mean
+    cntr::DynamicArray<uint32> clusters;
+    cntr::DynamicArray<glm::vec3> means;
+    cntr::DynamicArray<uint32> counts;
+    for ( uint32 i = 0; i < positions.size(); ++i )
+    {
+        clusters.push( 0 );
+    }
+
+    for ( uint32 i = 0; i < cells.size(); ++i )
+    {
+        if ( i == 0 || cells[i] >> 32 != cells[i - 1] >> 32 )
+        {
+            means.push( glm::vec3( 0.0f ) );
+            counts.push( 0 );
+        }
+
+        uint32 vertex = static_cast<uint32>( cells[i] );
+        clusters[vertex] = means.size() - 1;
+        means[means.size() - 1] += positions[vertex];
+        ++counts[counts.size() - 1];
+    }
+
+    // keep each triangle between three clusters once, whatever its winding
+    cntr::DynamicArray<uint64> triangles;
+    for ( uint32 i = 0; i + 2 < indices.size(); i += 3 )
+    {
+        uint64 corners[3] = { clusters[indices[i]], clusters[indices[i + 1]],
+                              clusters[indices[i + 2]] };
+        std::sort( corners, corners + 3 );
+        if ( corners[0] == corners[1] || corners[1] == corners[2] )
+        {
+            continue;
+        }
+
+        triangles.push( corners[0] | corners[1] << 21 | corners[2] << 42 );
+    }
+
+    uint32 triangleCount = 0;
+    if ( triangles.size() > 0 )
+    {
+        std::sort( &triangles[0], &triangles[0] + triangles.size() );
+        triangleCount = static_cast<uint32>(
+            std::unique( &triangles[0], &triangles[0] + triangles.size() ) -
+            &triangles[0] );
+    }
+
+    if ( triangleCount > maxTriangles )
+    {
+        return false;
+    }
+
+    // only the clusters the triangles use are kept
+    cntr::DynamicArray<uint32> remap;
+    uint32 vertexCount = 0;
+    for ( uint32 i = 0; i < means.size(); ++i )
+    {
+        remap.push( NO_VERTEX );
+    }
+
+    for ( uint32 i = 0; i < triangleCount; ++i )
+    {
+        for ( uint32 corner = 0; corner < 3; ++corner )
+        {
+            uint32 cluster = ( triangles[i] >> ( corner * 21 ) ) & 0x1FFFFF;
+            if ( remap[cluster] == NO_VERTEX )
+            {
+                remap[cluster] = vertexCount++;
+            }
+        }
+    }
+
+    _vertices = cntr::FixedArray<glm::vec3>( std::max( vertexCount, 1u ) );
+    for ( uint32 i = 0; i < means.size(); ++i )
+    {
+        if ( remap[i] != NO_VERTEX )
+        {
+            _vertices.push( means[i] / static_cast<float>( counts[i] ) );
+        }
+    }
+
+    _indices = cntr::FixedArray<uint32>( std::max( triangleCount * 3, 1u ) );
+    for ( uint32 i = 0; i < triangleCount; ++i )
+    {
+        for ( uint32 corner = 0; corner < 3; ++corner )
+        {
+            _indices.push(
+                remap[( triangles[i] >> ( corner * 21 ) ) & 0x1FFFFF] );
+        }
+    }
+
+    return true;
+}
+
+// MEMBER FUNCTIONS
+void Occluder::build( const cntr::FixedArray<Mesh>& meshes,
+                      uint32 maxTriangles )
+{
+    DEMO_PROFILE_SCOPE( "Occluder::build" );
+
+    // gather every mesh into one triangle soup
+    cntr::DynamicArray<glm::vec3> positions;
+    cntr::DynamicArray<uint32> indices;
+    for ( uint32 i = 0; i < meshes.size(); ++i )
+    {
+        const Mesh& mesh = meshes[i];
+        uint32 base = positions.size();
+        for ( uint32 j = 0; j < mesh.vertices().size(); ++j )
+        {
+            positions.push( mesh.vertices()[j].position );
+        }
+
+        for ( uint32 j = 0; j < mesh.indices().size(); ++j )
+        {
+            indices.push( base + mesh.indices()[j] );
+        }
+    }
+
+    build( positions, indices, maxTriangles );
+}
+
+void Occluder::build( const cntr::DynamicArray<glm::vec3>& positions,
+                      const cntr::DynamicArray<uint32>& indices,
+                      uint32 maxTriangles )
+{
+    if ( indices.size() / 3 <= maxTriangles )
+    {
+        _vertices = cntr::FixedArray<glm::vec3>(
+            std::max( positions.size(), 1u ) );
+        for ( uint32 i = 0; i < positions.size(); ++i )
+        {
+            _vertices.push( positions[i] );
+        }
+
+        _indices = cntr::FixedArray<uint32>( std::max( indices.size(), 1u ) );
+        for ( uint32 i = 0; i < indices.size(); ++i )
+        {
+            _indices.push( indices[i] );
+        }
+        return;
+    }
+
+    glm::vec3 min( INFINITY );
+    glm::vec3 max( -INFINITY );
+    for ( uint32 i = 0; i < positions.size(); ++i )
+    {
+        min = glm::min( min, positions[i] );
+        max = glm::max( max, positions[i] );
+    }
+
+    for ( uint32 gridSize = MAX_GRID_SIZE; gridSize > 1; gridSize /= 2 )
+    {
+        if ( cluster( positions, indices, min, max, gridSize,
+                      maxTriangles ) )
+        {
+            return;
+        }
+    }
+
+    // even the coarsest grid keeps too many triangles
+    _vertices = cntr::FixedArray<glm::vec3>( 1 );
+    _indices = cntr::FixedArray<uint32>( 1 );
+}
+
+} // End nspc rndr
+
+} // End nspc demo
@@ -0,0 +1,162 @@
+// occluder.h
+//
+// Simplified geometry of a model that hides what is behind it.
+//
+// Occluders are what the occlusion culler rasterizes on the CPU, so they are
+// kept to a small number of triangles. Meshes that already have few enough
+// triangles are used as they are. Larger ones are simplified by clustering
+// their vertices on a grid, which is made coarser until the triangles fit:
+// each cluster becomes one vertex at the mean of its vertices, and the
+// triangles that collapse or repeat are dropped. Triangles are rasterized
+// from both sides, so their winding is not kept.
+//
+// The result only approximates the meshes and may reach slightly past them,
+// so thin or open meshes make poor occluders.
+//
+#ifndef DEMO_OCCLUDER_H
+#define DEMO_OCCLUDER_H
+
+#include <glm/glm.hpp>
+
+#include "demo/intdef.h"
+#include "demo/container/dynamic_array.h"
+#include "demo/container/fixed_array.h"
+#include "demo/render/mesh.h"
+
+namespace demo
+{
+
+namespace rndr
+{
+
+class Occluder
+{
+  public:
+    // CONSTANTS
+    /**
+     * The most triangles an occluder is simplified to by default.
+     */
+    static constexpr uint32 MAX_TRIANGLES = 256;
+
+  private:
+    // CONSTANTS
+    /**
+     * The number of cells on each axis of the finest clustering grid.
+     */
+    static constexpr uint32 MAX_GRID_SIZE = 64;
+
+    // MEMBERS
+    /**
+     * The vertices.
+     */
+    cntr::FixedArray<glm::vec3> _vertices;
+
+    /**
+     * The vertex indices, three per triangle.
+     */
+    cntr::FixedArray<uint32> _indices;
+
+    // HELPER FUNCTIONS
+    /**
+     * Cluster vertices on a grid and keep the triangles between clusters.
+     * @param positions The vertices.
+     * @param indices The vertex indices, three per triangle.
+     * @param min The corner of the vertices with the smallest coordinates.
+     * @param max The corner of the vertices with the largest coordinates.
+     * @param gridSize The number of cells on each axis.
+     * @param maxTriangles The most triangles to keep.
+     * @return Whether the triangles fit.
+     */
+    bool cluster( const cntr::DynamicArray<glm::vec3>& positions,
+                  const cntr::DynamicArray<uint32>& indices,
+                  const glm::vec3& min, const glm::vec3& max,
+                  uint32 gridSize, uint32 maxTriangles );
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct an empty occluder.
+     */
+    Occluder();
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the vertices.
+     * @return The vertices.
+     */
+    const cntr::FixedArray<glm::vec3>& vertices() const;
+
+    /**
+     * Get the vertex indices, three per triangle.
+     * @return The indices.
+     */
+    const cntr::FixedArray<uint32>& indices() const;
+
+    /**
+     * Get the number of triangles.
+     * @return The triangle count.
+     */
+    uint32 triangleCount() const;
+
+    /**
+     * Check if there is nothing to rasterize.
+     * @return Is it empty?
+     */
+    bool isEmpty() const;
+
+    // MEMBER FUNCTIONS
+    /**
+     * Build the occluder of some meshes.
+     * @param meshes The meshes.
+     * @param maxTriangles The most triangles to keep.
+     */
+    void build( const cntr::FixedArray<Mesh>& meshes,
+                uint32 maxTriangles = MAX_TRIANGLES );
+
+    /**
+     * Build the occluder of some triangles.
+     * @param positions The vertices.
+     * @param indices The vertex indices, three per triangle.
+     * @param maxTriangles The most triangles to keep.
+     */
+    void build( const cntr::DynamicArray<glm::vec3>& positions,
+                const cntr::DynamicArray<uint32>& indices,
+                uint32 maxTriangles = MAX_TRIANGLES );
+};
+
+// CONSTRUCTORS
+inline
+Occluder::Occluder() : _vertices( 1 ), _indices( 1 )
+{
+}
+
+// ACCESSOR FUNCTIONS
+inline
+const cntr::FixedArray<glm::vec3>& Occluder::vertices() const
+{
+    return _vertices;
+}
+
+inline
+const cntr::FixedArray<uint32>& Occluder::indices() const
+{
+    return _indices;
+}
+
+inline
+uint32 Occluder::triangleCount() const
+{
+    return _indices.size() / 3;
+}
+
+inline
+bool Occluder::isEmpty() const
+{
+    return _indices.size() == 0;
+}
+
+} // End nspc rndr
+
+} // End nspc demo
+
+#endif // DEMO_OCCLUDER_H
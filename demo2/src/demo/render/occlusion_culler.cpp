@@ -0,0 +1,503 @@
+// occlusion_culler.cpp
+#include "occlusion_culler.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+
+#include "demo/utility/profiler.h"
+#include "demo/utility/simd_kernels.h"
+
+namespace demo
+{
+
+namespace rndr
+{
+
+// CONSTANTS
+constexpr uint32 OcclusionCuller::TILE_SIZE;
+constexpr uint32 OcclusionCuller::DEFAULT_WIDTH;
+constexpr uint32 OcclusionCuller::DEFAULT_HEIGHT;
+constexpr uint32 OcclusionCuller::TILE_LEVELS;
+constexpr uint32 OcclusionCuller::MAX_LEVELS;
+constexpr float OcclusionCuller::GUARD_BAND;
+constexpr uint32 OcclusionCuller::TEST_BATCH_SIZE;
+
+// HELPER FUNCTIONS
+void OcclusionCuller::addTriangle( const glm::vec4& a, const glm::vec4& b,
+                                   const glm::vec4& c )
+{
+    const glm::vec4* vertices[3] = { &a, &b, &c };
+    float x[3];
+    float y[3];
+    float z[3];
+    for ( uint32 i = 0; i < 3; ++i )
+    {
+        // only what is in front of the near plane is rasterized, so a
+        // triangle that crosses it is dropped rather than clipped
+        const glm::vec4& vertex = *vertices[i];
+        if ( !( vertex.w > 0.0f ) || vertex.z < -vertex.w )
+        {
+            return;
+        }
+
+        float inverse = 1.0f / vertex.w;
+        x[i] = ( vertex.x * inverse * 0.5f + 0.5f ) * _width;
+        y[i] = ( vertex.y * inverse * 0.5f + 0.5f ) * _height;
+        z[i] = vertex.z * inverse * 0.5f + 0.5f;
+
+        if ( std::abs( x[i] - _width * 0.5f ) > _width * GUARD_BAND ||
+             std::abs( y[i] - _height * 0.5f ) > _height * GUARD_BAND )
+        {
+            return;
+        }
+    }
+
+    // triangles past the far plane hide nothing inside the frustum
+    if ( std::min( z[0], std::min( z[1], z[2] ) ) >= 1.0f )
+    {
+        return;
+    }
+
+    // the pixels whose centers the triangle's box covers
+    float firstColumn = std::max(
+        std::ceil( std::min( x[0], std::min( x[1], x[2] ) ) - 0.5f ), 0.0f );
+    float firstRow = std::max(
+        std::ceil( std::min( y[0], std::min( y[1], y[2] ) ) - 0.5f ), 0.0f );
+    float lastColumn = std::min(
+        std::floor( std::max( x[0], std::max( x[1], x[2] ) ) - 0.5f ),
+        _width - 1.0f );
+    float lastRow = std::min(
+        std::floor( std::max( y[0], std::max( y[1], y[2] ) ) - 0.5f ),
+        _height - 1.0f );
+    if ( firstColumn > lastColumn || firstRow > lastRow )
+    {
+        return;
+    }
+
+    // occluders are rasterized from both sides, so the winding is made the
+    // one whose edge functions are positive inside
+    double area = ( static_cast<double>( x[1] ) - x[0] ) * ( y[2] - y[0] ) -
+                  ( static_cast<double>( x[2] ) - x[0] ) * ( y[1] - y[0] );
+    if ( area == 0.0 )
+    {
+        return;
+    }
+    else if ( area < 0.0 )
+    {
+        std::swap( x[1], x[2] );
+        std::swap( y[1], y[2] );
+        std::swap( z[1], z[2] );
+        area = -area;
+    }
+
+    // each edge function is the area of the triangle a point makes with the
+    // edge opposite a vertex, which is also that vertex's weight times the
+    // triangle's area
+    float triangle[util::SimdKernels::TRIANGLE_COMPONENTS];
+    double depth[3] = { 0.0, 0.0, 0.0 };
+    for ( uint32 edge = 0; edge < 3; ++edge )
+    {
+        uint32 i = ( edge + 1 ) % 3;
+        uint32 j = ( edge + 2 ) % 3;
+        double dx = static_cast<double>( x[j] ) - x[i];
+        double dy = static_cast<double>( y[j] ) - y[i];
+        double coefficients[3] = { -dy, dx, dy * x[i] - dx * y[i] };
+        for ( uint32 k = 0; k < 3; ++k )
+        {
+            triangle[edge * 3 + k] = static_cast<float>( coefficients[k] );
+            depth[k] += coefficients[k] * z[edge] / area;
+        }
+    }
+
+    triangle[9] = static_cast<float>( depth[0] );
+    triangle[10] = static_cast<float>( depth[1] );
+    triangle[11] = static_cast<float>( depth[2] );
+    triangle[12] = firstColumn;
+    triangle[13] = firstRow;
+    triangle[14] = lastColumn;
+    triangle[15] = lastRow;
+
+    for ( uint32 i = 0; i < util::SimdKernels::TRIANGLE_COMPONENTS; ++i )
+    {
+        _triangles.push( triangle[i] );
+    }
+}
+
+void OcclusionCuller::rasterizeTile( uint32 tile )
+{
+    uint32 column = tile % _tileColumns;
+    uint32 row = tile / _tileColumns;
+    uint32 rect[4] = { column * TILE_SIZE, row * TILE_SIZE,
+                       ( column + 1 ) * TILE_SIZE, ( row + 1 ) * TILE_SIZE };
+
+    float* depth = &_levels[0];
+    for ( uint32 y = rect[1]; y < rect[3]; ++y )
+    {
+        std::fill( depth + y * _width + rect[0], depth + y * _width + rect[2],
+                   1.0f );
+    }
+
+    uint32 first = _binOffsets[tile];
+    uint32 count = _binOffsets[tile + 1] - first;
+    if ( count > 0 )
+    {
+        util::SimdKernels::rasterizeDepth( depth, _width, rect,
+                                           &_triangles[0],
+                                           &_binnedTriangles[first], count );
+    }
+
+    for ( uint32 level = 0; level < TILE_LEVELS; ++level )
+    {
+        uint32 size = TILE_SIZE >> ( level + 1 );
+        reduce( level, column * size, row * size, ( column + 1 ) * size,
+                ( row + 1 ) * size );
+    }
+}
+
+void OcclusionCuller::reduce( uint32 level, uint32 x0, uint32 y0, uint32 x1,
+                              uint32 y1 )
+{
+    uint32 width = _levelWidths[level];
+    uint32 height = _levelHeights[level];
+    uint32 coarseWidth = _levelWidths[level + 1];
+    const float* fine = &_levels[_levelOffsets[level]];
+    float* coarse = &_levels[_levelOffsets[level + 1]];
+
+    // a texel on an odd edge covers the last row or column twice
+    for ( uint32 y = y0; y < y1; ++y )
+    {
+        const float* top = fine + std::min( y * 2 + 1, height - 1 ) * width;
+        const float* bottom = fine + y * 2 * width;
+        for ( uint32 x = x0; x < x1; ++x )
+        {
+            uint32 left = x * 2;
+            uint32 right = std::min( left + 1, width - 1 );
+            coarse[y * coarseWidth + x] = std::max(
+                std::max( bottom[left], bottom[right] ),
+                std::max( top[left], top[right] ) );
+        }
+    }
+}
+
+// CONSTRUCTORS
+OcclusionCuller::OcclusionCuller() : _width( 0 ), _height( 0 ),
+                                     _tileColumns( 0 ), _tileRows( 0 ),
+                                     _levelCount( 0 ), _levels(),
+                                     _viewProjection( 1.0f ), _triangles(),
+                                     _clipVertices(), _binOffsets(),
+                                     _binnedTriangles(), _batchCounts(),
+                                     _threadPool( nullptr ),
+                                     _isRasterized( false )
+{
+    setResolution( DEFAULT_WIDTH, DEFAULT_HEIGHT );
+}
+
+// ACCESSOR FUNCTIONS
+uint32 OcclusionCuller::triangleCount() const
+{
+    return _triangles.size() / util::SimdKernels::TRIANGLE_COMPONENTS;
+}
+
+// MUTATOR FUNCTIONS
+void OcclusionCuller::setResolution( uint32 width, uint32 height )
+{
+    _tileColumns = std::max( ( width + TILE_SIZE - 1 ) / TILE_SIZE, 1u );
+    _tileRows = std::max( ( height + TILE_SIZE - 1 ) / TILE_SIZE, 1u );
+    _width = _tileColumns * TILE_SIZE;
+    _height = _tileRows * TILE_SIZE;
+
+    // each level halves the one below, rounding up, until a single texel
+    uint32 texelCount = 0;
+    _levelCount = 0;
+    width = _width;
+    height = _height;
+    while ( true )
+    {
+        assert( _levelCount < MAX_LEVELS );
+        _levelWidths[_levelCount] = width;
+        _levelHeights[_levelCount] = height;
+        _levelOffsets[_levelCount] = texelCount;
+        texelCount += width * height;
+        ++_levelCount;
+
+        if ( width == 1 && height == 1 )
+        {
+            break;
+        }
+        width = ( width + 1 ) / 2;
+        height = ( height + 1 ) / 2;
+    }
+
+    _levels.clear();
+    for ( uint32 i = 0; i < texelCount; ++i )
+    {
+        _levels.push( 1.0f );
+    }
+    _isRasterized = false;
+}
+
+// MEMBER FUNCTIONS
+void OcclusionCuller::begin( const glm::mat4& viewProjection )
+{
+    _viewProjection = viewProjection;
+    _triangles.clear();
+    _isRasterized = false;
+}
+
+void OcclusionCuller::addOccluder( const Occluder& occluder,
+                                   const glm::mat4& world )
+{
+    glm::mat4 matrix = _viewProjection * world;
+
+    _clipVertices.clear();
+    const cntr::FixedArray<glm::vec3>& vertices = occluder.vertices();
+    for ( uint32 i = 0; i < vertices.size(); ++i )
+    {
+        _clipVertices.push( matrix * glm::vec4( vertices[i], 1.0f ) );
+    }
+
+    const cntr::FixedArray<uint32>& indices = occluder.indices();
+    for ( uint32 i = 0; i + 2 < indices.size(); i += 3 )
+    {
+        addTriangle( _clipVertices[indices[i]], _clipVertices[indices[i + 1]],
+                     _clipVertices[indices[i + 2]] );
+    }
+}
+
+void OcclusionCuller::rasterize()
+{
+    DEMO_PROFILE_SCOPE( "OcclusionCuller::rasterize" );
+
+    const uint32 COMPONENTS = util::SimdKernels::TRIANGLE_COMPONENTS;
+    uint32 tileCount = _tileColumns * _tileRows;
+    uint32 triangleCount = this->triangleCount();
+
+    // count the triangles that overlap each tile, after the offset of the
+    // tile itself
+    _binOffsets.clear();
+    for ( uint32 tile = 0; tile <= tileCount; ++tile )
+    {
+        _binOffsets.push( 0 );
+    }
+
+    for ( uint32 i = 0; i < triangleCount; ++i )
+    {
+        const float* triangle = &_triangles[i * COMPONENTS];
+        uint32 lastColumn = static_cast<uint32>( triangle[14] ) / TILE_SIZE;
+        uint32 lastRow = static_cast<uint32>( triangle[15] ) / TILE_SIZE;
+        for ( uint32 row = static_cast<uint32>( triangle[13] ) / TILE_SIZE;
+              row <= lastRow;
+              ++row )
+        {
+            for ( uint32 column =
+                      static_cast<uint32>( triangle[12] ) / TILE_SIZE;
+                  column <= lastColumn;
+                  ++column )
+            {
+                ++_binOffsets[row * _tileColumns + column + 1];
+            }
+        }
+    }
+
+    for ( uint32 tile = 1; tile <= tileCount; ++tile )
+    {
+        _binOffsets[tile] += _binOffsets[tile - 1];
+    }
+
+    // place the triangles, with each tile's offset as its cursor, and move
+    // the offsets back once they have reached the next tile's
+    _binnedTriangles.clear();
+    for ( uint32 i = 0; i < _binOffsets[tileCount]; ++i )
+    {
+        _binnedTriangles.push( 0 );
+    }
+
+    for ( uint32 i = 0; i < triangleCount; ++i )
+    {
+        const float* triangle = &_triangles[i * COMPONENTS];
+        uint32 lastColumn = static_cast<uint32>( triangle[14] ) / TILE_SIZE;
+        uint32 lastRow = static_cast<uint32>( triangle[15] ) / TILE_SIZE;
+        for ( uint32 row = static_cast<uint32>( triangle[13] ) / TILE_SIZE;
+              row <= lastRow;
+              ++row )
+        {
+            for ( uint32 column =
+                      static_cast<uint32>( triangle[12] ) / TILE_SIZE;
+                  column <= lastColumn;
+                  ++column )
+            {
+                _binnedTriangles[_binOffsets[row * _tileColumns + column]++] =
+                    i;
+            }
+        }
+    }
+
+    for ( uint32 tile = tileCount; tile > 0; --tile )
+    {
+        _binOffsets[tile] = _binOffsets[tile - 1];
+    }
+    _binOffsets[0] = 0;
+
+    // the tiles write to separate texels of the levels they cover
+    if ( _threadPool == nullptr )
+    {
+        for ( uint32 tile = 0; tile < tileCount; ++tile )
+        {
+            rasterizeTile( tile );
+        }
+    }
+    else
+    {
+        _threadPool->parallelFor( tileCount, [this]( uint32 tile ) {
+            rasterizeTile( tile );
+        } );
+    }
+
+    for ( uint32 level = TILE_LEVELS; level + 1 < _levelCount; ++level )
+    {
+        reduce( level, 0, 0, _levelWidths[level + 1],
+                _levelHeights[level + 1] );
+    }
+
+    _isRasterized = true;
+}
+
+bool OcclusionCuller::isHidden( const glm::vec3& center,
+                                const glm::vec3& extents ) const
+{
+    if ( !_isRasterized )
+    {
+        return false;
+    }
+
+    // the corners are the center plus or minus each scaled axis
+    glm::vec4 clipCenter = _viewProjection * glm::vec4( center, 1.0f );
+    glm::vec4 axes[3] = { _viewProjection[0] * extents.x,
+                          _viewProjection[1] * extents.y,
+                          _viewProjection[2] * extents.z };
+
+    glm::vec3 min( INFINITY );
+    glm::vec3 max( -INFINITY );
+    for ( uint32 corner = 0; corner < 8; ++corner )
+    {
+        glm::vec4 vertex = clipCenter;
+        for ( uint32 axis = 0; axis < 3; ++axis )
+        {
+            vertex += ( corner >> axis & 1 ) != 0 ? axes[axis] : -axes[axis];
+        }
+
+        // a box that reaches the camera may be in front of everything
+        if ( !( vertex.w > 0.0f ) || vertex.z < -vertex.w )
+        {
+            return false;
+        }
+
+        glm::vec3 window = glm::vec3( vertex ) / vertex.w * 0.5f + 0.5f;
+        min = glm::min( min, window );
+        max = glm::max( max, window );
+    }
+
+    // boxes off the screen are for the frustum to cull
+    min.x *= _width;
+    max.x *= _width;
+    min.y *= _height;
+    max.y *= _height;
+    if ( !( max.x >= 0.0f && max.y >= 0.0f && min.x < _width &&
+            min.y < _height ) )
+    {
+        return false;
+    }
+
+    // the pixels the box touches
+    uint32 x0 = static_cast<uint32>( std::max( min.x, 0.0f ) );
+    uint32 y0 = static_cast<uint32>( std::max( min.y, 0.0f ) );
+    uint32 x1 = static_cast<uint32>( std::min( max.x, _width - 1.0f ) );
+    uint32 y1 = static_cast<uint32>( std::min( max.y, _height - 1.0f ) );
+
+    // the finest level where the box covers at most two by two texels
+    uint32 level = 0;
+    while ( level + 1 < _levelCount &&
+            ( ( x1 >> level ) - ( x0 >> level ) > 1 ||
+              ( y1 >> level ) - ( y0 >> level ) > 1 ) )
+    {
+        ++level;
+    }
+
+    const float* texels = &_levels[_levelOffsets[level]];
+    uint32 width = _levelWidths[level];
+    for ( uint32 y = y0 >> level; y <= y1 >> level; ++y )
+    {
+        for ( uint32 x = x0 >> level; x <= x1 >> level; ++x )
+        {
+            if ( min.z <= texels[y * width + x] )
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+uint32 OcclusionCuller::cull( uint32* visible, uint32 count,
+                              const float* const* boxes )
+{
+    DEMO_PROFILE_SCOPE( "OcclusionCuller::cull" );
+
+    if ( !_isRasterized || count == 0 )
+    {
+        return count;
+    }
+
+    uint32 batchCount = ( count + TEST_BATCH_SIZE - 1 ) / TEST_BATCH_SIZE;
+    while ( _batchCounts.size() < batchCount )
+    {
+        _batchCounts.push( 0 );
+    }
+
+    // each batch packs the boxes it keeps at its start
+    auto runBatch = [&]( uint32 batch ) {
+        uint32 first = batch * TEST_BATCH_SIZE;
+        uint32 end = std::min( first + TEST_BATCH_SIZE, count );
+        uint32 kept = first;
+        for ( uint32 i = first; i < end; ++i )
+        {
+            uint32 index = visible[i];
+            glm::vec3 center( boxes[0][index], boxes[1][index],
+                              boxes[2][index] );
+            glm::vec3 extents( boxes[3][index], boxes[4][index],
+                               boxes[5][index] );
+            visible[kept] = index;
+            kept += isHidden( center, extents ) ? 0 : 1;
+        }
+        _batchCounts[batch] = kept - first;
+    };
+
+    if ( _threadPool == nullptr )
+    {
+        for ( uint32 batch = 0; batch < batchCount; ++batch )
+        {
+            runBatch( batch );
+        }
+    }
+    else
+    {
+        _threadPool->parallelFor( batchCount, runBatch );
+    }
+
+    uint32 visibleCount = 0;
+    for ( uint32 batch = 0; batch < batchCount; ++batch )
+    {
+        uint32 first = batch * TEST_BATCH_SIZE;
+        std::copy( visible + first, visible + first + _batchCounts[batch],
+                   visible + visibleCount );
+        visibleCount += _batchCounts[batch];
+    }
+
+    return visibleCount;
+}
+
+} // End nspc rndr
+
+} // End nspc demo
@@ -0,0 +1,331 @@
+// occlusion_culler.h
+//
+// Finds boxes hidden behind occluders by rasterizing the occluders into a
+// small depth buffer on the CPU.
+//
+// Each frame starts with begin. Occluders are then carried to the screen with
+// addOccluder, and rasterize bins their triangles into square tiles and
+// rasterizes each tile with util::SimdKernels::rasterizeDepth, spreading the
+// tiles over the thread pool when there is one. Each tile then reduces its
+// depths into the levels of a hierarchical depth buffer, where each texel
+// holds the farthest depth of the two by two texels below it, and the few
+// levels coarser than a tile are reduced last. Boxes are then tested with
+// isHidden or cull, which finds the level where a box covers at most two by
+// two texels and compares them with the nearest depth of its corners.
+//
+// Depths are the window depths OpenGL would write, from 0 at the near plane
+// to 1 at the far plane, and pixels no occluder covers are at 1. Triangles
+// that cross the near plane or reach far outside the screen are dropped,
+// and boxes that cross the near plane are never hidden, so nothing is culled
+// that the rasterized occluders do not cover. Depths are sampled at pixel
+// centers though, so at this low resolution the edges of occluders may
+// hide slivers of what is behind them.
+//
+#ifndef DEMO_OCCLUSION_CULLER_H
+#define DEMO_OCCLUSION_CULLER_H
+
+#include <glm/glm.hpp>
+
+#include "demo/intdef.h"
+#include "demo/container/dynamic_array.h"
+#include "demo/render/occluder.h"
+#include "demo/utility/thread_pool.h"
+
+namespace demo
+{
+
+namespace rndr
+{
+
+class OcclusionCuller
+{
+  public:
+    // CONSTANTS
+    /**
+     * The side of the square tiles the screen is split into, in pixels.
+     */
+    static constexpr uint32 TILE_SIZE = 32;
+
+    /**
+     * The default width of the depth buffer.
+     */
+    static constexpr uint32 DEFAULT_WIDTH = 256;
+
+    /**
+     * The default height of the depth buffer.
+     */
+    static constexpr uint32 DEFAULT_HEIGHT = 128;
+
+  private:
+    // CONSTANTS
+    /**
+     * The number of levels reduced inside each tile, which halve the tile
+     * until it is a single texel.
+     */
+    static constexpr uint32 TILE_LEVELS = 5;
+
+    /**
+     * The most levels there may be, enough for 65536 pixels on a side.
+     */
+    static constexpr uint32 MAX_LEVELS = 17;
+
+    /**
+     * How far outside the screen triangles may reach, in screen sizes,
+     * before they are dropped rather than rasterized imprecisely.
+     */
+    static constexpr float GUARD_BAND = 8.0f;
+
+    /**
+     * The number of boxes tested per task.
+     */
+    static constexpr uint32 TEST_BATCH_SIZE = 256;
+
+    // MEMBERS
+    /**
+     * The width of the depth buffer.
+     */
+    uint32 _width;
+
+    /**
+     * The height of the depth buffer.
+     */
+    uint32 _height;
+
+    /**
+     * The number of columns of tiles.
+     */
+    uint32 _tileColumns;
+
+    /**
+     * The number of rows of tiles.
+     */
+    uint32 _tileRows;
+
+    /**
+     * The number of levels, including the depth buffer.
+     */
+    uint32 _levelCount;
+
+    /**
+     * The width of each level.
+     */
+    uint32 _levelWidths[MAX_LEVELS];
+
+    /**
+     * The height of each level.
+     */
+    uint32 _levelHeights[MAX_LEVELS];
+
+    /**
+     * The index of the first texel of each level.
+     */
+    uint32 _levelOffsets[MAX_LEVELS];
+
+    /**
+     * The texels of every level, finest first, each in rows.
+     */
+    cntr::DynamicArray<float> _levels;
+
+    /**
+     * The projection matrix times the view matrix of the frame.
+     */
+    glm::mat4 _viewProjection;
+
+    /**
+     * The triangles of the frame, as described by
+     * util::SimdKernels::rasterizeDepth.
+     */
+    cntr::DynamicArray<float> _triangles;
+
+    /**
+     * The vertices of the occluder being added, in clip space.
+     */
+    cntr::DynamicArray<glm::vec4> _clipVertices;
+
+    /**
+     * The index of each tile's first triangle in the binned triangles, and
+     * the number of binned triangles.
+     */
+    cntr::DynamicArray<uint32> _binOffsets;
+
+    /**
+     * The triangles that overlap each tile, tile by tile.
+     */
+    cntr::DynamicArray<uint32> _binnedTriangles;
+
+    /**
+     * The number of boxes left by each batch of a cull.
+     */
+    cntr::DynamicArray<uint32> _batchCounts;
+
+    /**
+     * The thread pool or nullptr to work on the calling thread.
+     */
+    util::ThreadPool* _threadPool;
+
+    /**
+     * Whether the depth buffer holds the occluders of the frame.
+     */
+    bool _isRasterized;
+
+    // HELPER FUNCTIONS
+    /**
+     * Add a triangle to be rasterized if it is worth it.
+     * @param a The first vertex in clip space.
+     * @param b The second vertex in clip space.
+     * @param c The third vertex in clip space.
+     */
+    void addTriangle( const glm::vec4& a, const glm::vec4& b,
+                      const glm::vec4& c );
+
+    /**
+     * Rasterize a tile and reduce it into the levels it covers.
+     * @param tile The index of the tile.
+     */
+    void rasterizeTile( uint32 tile );
+
+    /**
+     * Reduce a rectangle of a level into the next level.
+     * @param level The finer level.
+     * @param x0 The first column of the next level.
+     * @param y0 The first row of the next level.
+     * @param x1 The column past the last of the next level.
+     * @param y1 The row past the last of the next level.
+     */
+    void reduce( uint32 level, uint32 x0, uint32 y0, uint32 x1, uint32 y1 );
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct a culler with a depth buffer of the default size.
+     */
+    OcclusionCuller();
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the width of the depth buffer.
+     * @return The width in pixels.
+     */
+    uint32 width() const;
+
+    /**
+     * Get the height of the depth buffer.
+     * @return The height in pixels.
+     */
+    uint32 height() const;
+
+    /**
+     * Get the number of levels, including the depth buffer.
+     * @return The level count.
+     */
+    uint32 levelCount() const;
+
+    /**
+     * Get the number of triangles added this frame.
+     * @return The triangle count.
+     */
+    uint32 triangleCount() const;
+
+    /**
+     * Get a texel of a level.
+     * @param level The level, where 0 is the depth buffer.
+     * @param x The column.
+     * @param y The row, counted from the bottom of the screen.
+     * @return The farthest depth under the texel.
+     */
+    float depth( uint32 level, uint32 x, uint32 y ) const;
+
+    // MUTATOR FUNCTIONS
+    /**
+     * Set the size of the depth buffer, which is rounded up to whole tiles.
+     * Wider than tall suits most screens, and a few hundred pixels across
+     * is plenty.
+     * @param width The width in pixels.
+     * @param height The height in pixels.
+     */
+    void setResolution( uint32 width, uint32 height );
+
+    /**
+     * Set the thread pool the tiles and boxes are spread over.
+     * @param threadPool The thread pool or nullptr to work on the calling
+     * thread.
+     */
+    void setThreadPool( util::ThreadPool* threadPool );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Start a frame, forgetting the occluders of the last one.
+     * @param viewProjection The projection matrix times the view matrix.
+     */
+    void begin( const glm::mat4& viewProjection );
+
+    /**
+     * Add an occluder to be rasterized.
+     * @param occluder The occluder.
+     * @param world The world matrix of the occluder.
+     */
+    void addOccluder( const Occluder& occluder, const glm::mat4& world );
+
+    /**
+     * Rasterize the occluders of the frame and build the levels.
+     */
+    void rasterize();
+
+    /**
+     * Check if a box is hidden behind the occluders.
+     * Nothing is hidden until the occluders are rasterized.
+     * @param center The center of the box in world space.
+     * @param extents The distance from the center to the faces on each axis.
+     * @return Is it hidden?
+     */
+    bool isHidden( const glm::vec3& center, const glm::vec3& extents ) const;
+
+    /**
+     * Remove the indices of hidden boxes from a list, keeping the rest in
+     * order.
+     * @param visible The indices of the boxes to test.
+     * @param count The number of indices.
+     * @param boxes util::SimdKernels::BOX_COMPONENTS pointers to rows of
+     * box components, as described by util::SimdKernels::cullBoxes.
+     * @return The number of indices left.
+     */
+    uint32 cull( uint32* visible, uint32 count, const float* const* boxes );
+};
+
+// ACCESSOR FUNCTIONS
+inline
+uint32 OcclusionCuller::width() const
+{
+    return _width;
+}
+
+inline
+uint32 OcclusionCuller::height() const
+{
+    return _height;
+}
+
+inline
+uint32 OcclusionCuller::levelCount() const
+{
+    return _levelCount;
+}
+
+inline
+float OcclusionCuller::depth( uint32 level, uint32 x, uint32 y ) const
+{
+    return _levels[_levelOffsets[level] + y * _levelWidths[level] + x];
+}
+
+// MUTATOR FUNCTIONS
+inline
+void OcclusionCuller::setThreadPool( util::ThreadPool* threadPool )
+{
+    _threadPool = threadPool;
+}
+
+} // End nspc rndr
+
+} // End nspc demo
+
+#endif // DEMO_OCCLUSION_CULLER_H
@@ -4,16 +4,115 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
+#include "demo/object/entity_adapters.h"
+#include "demo/object/query.h"
+#include "demo/utility/clock.h"
+#include "demo/utility/profiler.h"
+
 namespace demo
 {
 
 namespace rndr
 {
 
-void Renderer::render( const obj::Camera& camera, const obj::Scene& scene )
+// HELPER FUNCTIONS
+void Renderer::addCandidate( const Candidate& candidate, const Bounds& bounds )
+{
+    const glm::mat4& world = *candidate.world;
+    glm::vec3 center = bounds.center();
+    glm::vec3 extents = bounds.extents();
+
+    // the world box is centered on the moved center and reaches as far along
+    // each axis as the rotated and scaled extents do
+    for ( uint32 row = 0; row < 3; ++row )
+    {
+        _boxes[row].push( world[0][row] * center.x +
+                          world[1][row] * center.y +
+                          world[2][row] * center.z + world[3][row] );
+        _boxes[row + 3].push( std::abs( world[0][row] ) * extents.x +
+                              std::abs( world[1][row] ) * extents.y +
+                              std::abs( world[2][row] ) * extents.z );
+    }
+
+    _candidates.push( candidate );
+}
+
+uint32 Renderer::cull( const Frustum& frustum, uint32 first )
+{
+    // the indices are only ever grown, so steady frames do not allocate
+    while ( _visible.size() < _candidates.size() )
+    {
+        _visible.push( 0 );
+    }
+
+    if ( !_isCulling || first == _candidates.size() )
+    {
+        for ( uint32 i = 0; i < _candidates.size(); ++i )
+        {
+            _visible[i] = i;
+        }
+        return _candidates.size();
+    }
+
+    for ( uint32 i = 0; i < first; ++i )
+    {
+        _visible[i] = i;
+    }
+
+    const float* boxes[util::SimdKernels::BOX_COMPONENTS];
+    for ( uint32 row = 0; row < util::SimdKernels::BOX_COMPONENTS; ++row )
+    {
+        boxes[row] = &_boxes[row][first];
+    }
+
+    // the kernel counts from the first candidate it is given
+    uint32 count = util::SimdKernels::cullBoxes( &_visible[first],
+                                                 frustum.planes(), boxes,
+                                                 _candidates.size() - first );
+    for ( uint32 i = first; i < first + count; ++i )
+    {
+        _visible[i] += first;
+    }
+
+    return first + count;
+}
+
+void Renderer::draw( const Candidate& candidate, const glm::mat4& view,
+                     const Frustum& frustum )
+{
+    // get matrices
+    const glm::mat4& model = *candidate.world;
+    glm::mat3 normal = glm::mat3( glm::transpose( glm::inverse(
+            view * model ) ) );
+
+    // push matrices
+    glUniformMatrix4fv( _shader->matModelAttr(), 1, GL_FALSE,
+                        glm::value_ptr( model ) );
+
+    glUniformMatrix3fv( _shader->matNormalAttr(), 1, GL_FALSE,
+                        glm::value_ptr( normal ) );
+
+    // render the meshes inside the frustum
+    Frustum local = _isCulling ? frustum.transformed( model ) : Frustum();
+    if ( candidate.object != nullptr )
+    {
+        _cullStats.meshesCulled += candidate.object->render( *_shader, local );
+    }
+    else
+    {
+        _cullStats.meshesCulled += candidate.model->render( *_shader, local );
+    }
+}
+
+// MEMBER FUNCTIONS
+void Renderer::render( const obj::Camera& camera, obj::Scene& scene )
 {
+    DEMO_PROFILE_SCOPE( "Renderer::render" );
+
     if ( !_shader->isActive() )
     {
         _shader->activate();
@@ -25,12 +124,9 @@ void Renderer::render( const obj::Camera& camera, const obj::Scene& scene )
     }
 
     // compute matrices
-    glm::mat4 project = glm::perspective( glm::radians( camera.fieldOfView() ),
-                                          _target->aspectRatio(),
-                                          camera.nearPlane(),
-                                          camera.farPlane() );
-
-    glm::mat4 view = glm::inverse( camera.transform().matrix() );
+    glm::mat4 project = camera.projection( _target->aspectRatio() );
+    glm::mat4 view = camera.view();
+    Frustum frustum( project * view );
 
     // push frame-constant matrices to GPU
     glUniformMatrix4fv( _shader->matProjectionAttr(), 1, GL_FALSE,
@@ -39,32 +135,159 @@ void Renderer::render( const obj::Camera& camera, const obj::Scene& scene )
     glUniformMatrix4fv( _shader->matViewAttr(), 1, GL_FALSE,
                         glm::value_ptr( view ) );
 
-    // render objects
-    cntr::DynamicArray<obj::Object*> objects = scene.getObjects();
-    for ( auto iter = objects.begin();
-          iter != objects.end();
-          ++iter )
+    _cullStats = CullStats();
+    util::Clock::SysClock::time_point start = util::Clock::SysClock::now();
+
+    // the spatial index finds the objects with bounds inside the frustum
+    const cntr::DynamicArray<obj::Object*>& visible = scene.updateVisibility(
+        _isCulling ? frustum : Frustum() );
+    const cntr::DynamicArray<obj::Object*>& unbounded =
+        scene.unboundedObjects();
+
+    util::Clock::SysClock::time_point queried = util::Clock::SysClock::now();
+
+    _candidates.clear();
+    for ( uint32 row = 0; row < util::SimdKernels::BOX_COMPONENTS; ++row )
     {
-        if ( ( *iter )->isRenderable() && ( *iter )->isEnabled() )
+        _boxes[row].clear();
+    }
+
+    // while occlusion culling, the visible objects become candidates too so
+    // they can be tested against the occluders with the entities
+    bool isOcclusionCulling = _isCulling && _isOcclusionCulling;
+    if ( isOcclusionCulling )
+    {
+        _occlusionCuller.begin( project * view );
+    }
+
+    const cntr::DynamicArray<obj::Object*>* drawn[] = { &unbounded,
+                                                        &visible };
+    for ( uint32 list = 0; list < 2; ++list )
+    {
+        const cntr::DynamicArray<obj::Object*>& objects = *drawn[list];
+        for ( uint32 i = 0; i < objects.size(); ++i )
+        {
+            obj::Object* object = objects[i];
+            if ( !object->isRenderable() || !object->isEnabled() )
+            {
+                continue;
+            }
+
+            Candidate candidate = { object, nullptr, &object->worldMatrix() };
+            if ( !isOcclusionCulling || list == 0 )
+            {
+                draw( candidate, view, frustum );
+                continue;
+            }
+
+            const Occluder* occluder = object->occluder();
+            if ( object->isOccluding() && occluder != nullptr &&
+                 !occluder->isEmpty() )
+            {
+                _occlusionCuller.addOccluder( *occluder,
+                                              object->worldMatrix() );
+                ++_cullStats.occluders;
+            }
+
+            addCandidate( candidate, object->bounds() );
+        }
+    }
+
+    uint32 objectCount = _candidates.size();
+    util::Clock::SysClock::time_point objectsDrawn =
+        util::Clock::SysClock::now();
+
+    // gather the entities, drawing the ones without bounds straight away
+    obj::Query<const obj::Transform, const obj::ModelComponent> models(
+        &scene.registry() );
+    models.forEach( [&]( obj::Entity entity,
+                         const obj::Transform& transform,
+                         const obj::ModelComponent& component ) {
+        if ( component.model == nullptr || !component.model->isLoaded() )
         {
-            // get matrices
-            glm::mat4 model = ( *iter )->transform().matrix();
-            glm::mat3 normal = glm::mat3( glm::transpose( glm::inverse(
-                    view * model ) ) );
+            return;
+        }
+
+        Candidate candidate = { nullptr, component.model,
+                                &transform.worldMatrix() };
+        if ( component.model->bounds().isEmpty() )
+        {
+            draw( candidate, view, frustum );
+            return;
+        }
+
+        addCandidate( candidate, component.model->bounds() );
+    } );
 
-            // push matrices
-            glUniformMatrix4fv( _shader->matModelAttr(), 1, GL_FALSE,
-                                glm::value_ptr( model ) );
+    util::Clock::SysClock::time_point gathered = util::Clock::SysClock::now();
+    uint32 visibleCount = cull( frustum, objectCount );
+    util::Clock::SysClock::time_point culled = util::Clock::SysClock::now();
 
-            glUniformMatrix3fv( _shader->matNormalAttr(), 1, GL_FALSE,
-                                glm::value_ptr( normal ) );
+    _cullStats.tested = _candidates.size() - objectCount +
+                        scene.indexedObjectCount();
+    _cullStats.visible = visibleCount - objectCount + visible.size();
+    _cullStats.gatherTime = std::chrono::duration<double>(
+        gathered - objectsDrawn ).count();
+    _cullStats.time = std::chrono::duration<double>(
+        queried - start + culled - gathered ).count();
 
-            // render object
-            ( *iter )->render( *_shader );
+    // the occluders are rasterized once everything in the frustum is known,
+    // and whatever they hide is neither drawn nor visible
+    if ( isOcclusionCulling && visibleCount > 0 )
+    {
+        _occlusionCuller.rasterize();
+
+        const float* boxes[util::SimdKernels::BOX_COMPONENTS];
+        for ( uint32 row = 0; row < util::SimdKernels::BOX_COMPONENTS; ++row )
+        {
+            boxes[row] = &_boxes[row][0];
         }
+
+        // the visible objects come first and stay in order, so the ones
+        // missing from the front of what is left were hidden
+        uint32 unoccluded = _occlusionCuller.cull( &_visible[0],
+                                                   visibleCount, boxes );
+        uint32 next = 0;
+        for ( uint32 i = 0; i < objectCount; ++i )
+        {
+            if ( next < unoccluded && _visible[next] == i )
+            {
+                ++next;
+                continue;
+            }
+
+            _candidates[i].object->setVisible( false );
+        }
+
+        _cullStats.occluded = visibleCount - unoccluded;
+        _cullStats.occlusionTime = std::chrono::duration<double>(
+            util::Clock::SysClock::now() - culled ).count();
+        visibleCount = unoccluded;
     }
+
+    // render what is left
+    for ( uint32 i = 0; i < visibleCount; ++i )
+    {
+        draw( _candidates[_visible[i]], view, frustum );
+    }
+}
+
+void Renderer::dumpCullStats( FILE* file ) const
+{
+    fprintf( file, "Culling %s:\n", _isCulling ? "on" : "off" );
+    fprintf( file, "  %u of %u visible, %u mesh(es) culled\n",
+             _cullStats.visible, _cullStats.tested, _cullStats.meshesCulled );
+    fprintf( file, "  gather %.3f ms, cull %.3f ms\n",
+             _cullStats.gatherTime * 1000.0, _cullStats.time * 1000.0 );
+    fprintf( file, "Occlusion culling %s:\n",
+             _isCulling && _isOcclusionCulling ? "on" : "off" );
+    fprintf( file, "  %u occluder(s), %u triangle(s), %u occluded\n",
+             _cullStats.occluders, _occlusionCuller.triangleCount(),
+             _cullStats.occluded );
+    fprintf( file, "  rasterize and test %.3f ms\n",
+             _cullStats.occlusionTime * 1000.0 );
 }
 
 } // End nspc rndr
 
-} // End nspc demo
\ No newline at end of file
+} // End nspc demo
@@ -6,13 +6,36 @@
 // scene to. This can be a window or it can be a portion of one such as in
 // the case of a split screen.
 //
+// Objects and entities whose bounds are entirely outside the camera's
+// frustum are not drawn. Objects are found by querying the scene's spatial
+// index, which also marks them visible or not; that is what tick groups
+// that tick only visible objects go by. Entities are not indexed, so their
+// world-space boxes are gathered into rows of components each frame and
+// culled together with a SIMD kernel. The meshes of whatever remains are
+// then culled against the frustum in their own space. Objects and entities
+// with empty bounds are always drawn.
+//
+// What is left may still be hidden behind other objects. Visible objects that
+// are marked occluding are rasterized into the depth buffer of an occlusion
+// culler, and the boxes of every visible object and entity are tested against
+// it before anything is drawn. Occluded objects are marked not visible, just
+// as the ones outside the frustum are. Occlusion culling only happens along
+// with frustum culling.
+//
 #ifndef DEMO_RENDERER_H
 #define DEMO_RENDERER_H
 
+#include <stdio.h>
+
+#include "demo/container/dynamic_array.h"
 #include "demo/object/camera.h"
 #include "demo/object/scene.h"
+#include "demo/render/model.h"
+#include "demo/render/occlusion_culler.h"
 #include "demo/render/rendertarget.h"
 #include "demo/render/shader.h"
+#include "demo/utility/simd_kernels.h"
+#include "demo/utility/thread_pool.h"
 
 namespace demo
 {
@@ -22,7 +45,69 @@ namespace rndr
 
 class Renderer
 {
+  public:
+    // TYPES
+    /**
+     * What was culled during the last render.
+     */
+    struct CullStats
+    {
+        /**
+         * The number of objects and entities tested against the frustum.
+         */
+        uint32 tested;
+
+        /**
+         * The number of those that were inside.
+         */
+        uint32 visible;
+
+        /**
+         * The number of meshes of visible objects and entities that were
+         * outside.
+         */
+        uint32 meshesCulled;
+
+        /**
+         * The number of visible objects rasterized as occluders.
+         */
+        uint32 occluders;
+
+        /**
+         * The number of visible objects and entities hidden behind them.
+         */
+        uint32 occluded;
+
+        /**
+         * The seconds spent gathering the world bounds of the entities.
+         */
+        double gatherTime;
+
+        /**
+         * The seconds spent querying the spatial index and testing the
+         * bounds of the entities against the frustum.
+         */
+        double time;
+
+        /**
+         * The seconds spent rasterizing the occluders and testing the
+         * visible bounds against them.
+         */
+        double occlusionTime;
+    };
+
   private:
+    // TYPES
+    /**
+     * An object or entity to be drawn.
+     */
+    struct Candidate
+    {
+        obj::Object* object;
+        Model* model;
+        const glm::mat4* world;
+    };
+
     // MEMBERS
     /**
      * The shader set used to draw the scene.
@@ -34,6 +119,68 @@ class Renderer
      */
     RenderTarget* _target;
 
+    /**
+     * What was culled during the last render.
+     */
+    CullStats _cullStats;
+
+    /**
+     * Whether to cull.
+     */
+    bool _isCulling;
+
+    /**
+     * Whether to cull what is hidden behind occluders.
+     */
+    bool _isOcclusionCulling;
+
+    /**
+     * The culler the occluders are rasterized into.
+     */
+    OcclusionCuller _occlusionCuller;
+
+    /**
+     * The objects and entities to cull this frame.
+     */
+    cntr::DynamicArray<Candidate> _candidates;
+
+    /**
+     * The world-space boxes of the candidates as a row per component.
+     */
+    cntr::DynamicArray<float> _boxes[util::SimdKernels::BOX_COMPONENTS];
+
+    /**
+     * The indices of the visible candidates, with room for all of them.
+     */
+    cntr::DynamicArray<uint32> _visible;
+
+    // HELPER FUNCTIONS
+    /**
+     * Add an object or entity to be culled this frame.
+     * @param candidate The object or entity.
+     * @param bounds Its bounds in its own space.
+     */
+    void addCandidate( const Candidate& candidate, const Bounds& bounds );
+
+    /**
+     * Find the candidates inside a frustum.
+     * Their indices are written to the start of the visible indices.
+     * @param frustum The frustum in world space.
+     * @param first The index of the first candidate to test, before which
+     * the candidates are already known to be inside.
+     * @return The number of visible candidates.
+     */
+    uint32 cull( const Frustum& frustum, uint32 first );
+
+    /**
+     * Draw an object or entity.
+     * @param candidate The object or entity.
+     * @param view The view matrix.
+     * @param frustum The frustum in world space.
+     */
+    void draw( const Candidate& candidate, const glm::mat4& view,
+               const Frustum& frustum );
+
   public:
     // CONSTRUCTORS
     /**
@@ -60,6 +207,31 @@ class Renderer
      */
     Renderer& operator=( const Renderer& other );
 
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get what was culled during the last render.
+     * @return The cull stats.
+     */
+    const CullStats& cullStats() const;
+
+    /**
+     * Check if objects outside the frustum are culled.
+     * @return Is it culling?
+     */
+    bool isCulling() const;
+
+    /**
+     * Check if what is hidden behind occluders is culled.
+     * @return Is it occlusion culling?
+     */
+    bool isOcclusionCulling() const;
+
+    /**
+     * Get the occlusion culler.
+     * @return The occlusion culler.
+     */
+    OcclusionCuller& occlusionCuller();
+
     // MUTATOR FUNCTIONS
     /**
      * Set the shader used to draw.
@@ -73,24 +245,60 @@ class Renderer
      */
     void setRenderTarget( RenderTarget* target );
 
+    /**
+     * Set whether objects outside the frustum are culled.
+     * This is on by default.
+     * @param isCulling Should it cull?
+     */
+    void setCulling( bool isCulling );
+
+    /**
+     * Set whether what is hidden behind occluders is culled.
+     * This is on by default, but only happens while culling.
+     * @param isOcclusionCulling Should it occlusion cull?
+     */
+    void setOcclusionCulling( bool isOcclusionCulling );
+
+    /**
+     * Set the thread pool occlusion culling is spread over.
+     * It is only used from the thread that renders.
+     * @param threadPool The thread pool or nullptr to work on the calling
+     * thread.
+     */
+    void setThreadPool( util::ThreadPool* threadPool );
+
     // MEMBER FUNCTIONS
     /**
      * Render the specified scene from the viewpoint of the specified camera.
+     * This updates which of the scene's objects are visible.
      * @param camera The camera to use to render.
      * @param scene The scene to render.
      */
-    void render( const obj::Camera& camera, const obj::Scene& scene );
+    void render( const obj::Camera& camera, obj::Scene& scene );
+
+    /**
+     * Print what was culled during the last render.
+     * @param file The file to print to.
+     */
+    void dumpCullStats( FILE* file ) const;
 };
 
 // CONSTRUCTORS
 inline
-Renderer::Renderer() : _shader( nullptr ), _target( nullptr )
+Renderer::Renderer() : _shader( nullptr ), _target( nullptr ), _cullStats(),
+                       _isCulling( true ), _isOcclusionCulling( true ),
+                       _occlusionCuller(), _candidates(), _boxes(),
+                       _visible()
 {
 }
 
 inline
 Renderer::Renderer( const Renderer& other ) 
-    : _shader( other._shader ), _target( other._target )
+    : _shader( other._shader ), _target( other._target ), _cullStats(),
+      _isCulling( other._isCulling ),
+      _isOcclusionCulling( other._isOcclusionCulling ),
+      _occlusionCuller( other._occlusionCuller ), _candidates(), _boxes(),
+      _visible()
 {
 }
 
@@ -105,9 +313,37 @@ Renderer& Renderer::operator=( const Renderer& other )
 {
     _shader = other._shader;
     _target = other._target;
+    _isCulling = other._isCulling;
+    _isOcclusionCulling = other._isOcclusionCulling;
+    _occlusionCuller = other._occlusionCuller;
     return *this;
 }
 
+// ACCESSOR FUNCTIONS
+inline
+const Renderer::CullStats& Renderer::cullStats() const
+{
+    return _cullStats;
+}
+
+inline
+bool Renderer::isCulling() const
+{
+    return _isCulling;
+}
+
+inline
+bool Renderer::isOcclusionCulling() const
+{
+    return _isOcclusionCulling;
+}
+
+inline
+OcclusionCuller& Renderer::occlusionCuller()
+{
+    return _occlusionCuller;
+}
+
 // MUTATOR FUNCTIONS
 inline
 void Renderer::setShader( Shader* shader )
@@ -121,6 +357,24 @@ void Renderer::setRenderTarget( RenderTarget* target )
     _target = target;
 }
 
+inline
+void Renderer::setCulling( bool isCulling )
+{
+    _isCulling = isCulling;
+}
+
+inline
+void Renderer::setOcclusionCulling( bool isOcclusionCulling )
+{
+    _isOcclusionCulling = isOcclusionCulling;
+}
+
+inline
+void Renderer::setThreadPool( util::ThreadPool* threadPool )
+{
+    _occlusionCuller.setThreadPool( threadPool );
+}
+
 } // End nspc rndr
 
 } // End nspc demo
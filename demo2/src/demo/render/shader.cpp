@@ -2,12 +2,13 @@
 #include "shader.h"
 
 #include <fstream>
-#include <iostream>
 #include <sstream>
 #include <vector>
 
 #include "demo/build.g.h"
 #include "demo/container/fixed_array.h"
+#include "demo/utility/log.h"
+#include "demo/utility/profiler.h"
 
 namespace demo
 {
@@ -48,6 +49,8 @@ Shader& Shader::operator=( const Shader& other )
 // MEMBER FUNCTIONS
 void Shader::load()
 {
+    DEMO_PROFILE_SCOPE( "Shader::load" );
+
     // stop if loaded
     if ( isLoaded() )
     {
@@ -125,9 +128,8 @@ void Shader::load()
 
             glGetShaderInfoLog( handle, logLength, nullptr, &error[0] );
 
-            std::cout << "Failed to compile " << shaders[i].filename <<
-                std::endl;
-            std::cout << &error[0] << std::endl;
+            DEMO_LOG_ERROR( "shader", "Failed to compile %s\n%s",
+                            shaders[i].filename, &error[0] );
 
             // release resource and remove from list
             glDeleteShader( handle );
@@ -160,8 +162,8 @@ void Shader::load()
         std::vector<GLchar> error( static_cast<uint32>( logLength ) );
         glGetProgramInfoLog( program, logLength, nullptr, &error[0] );
 
-        std::cout << "Failed to link " << _setName << std::endl;
-        std::cout << &error[0] << std::endl;
+        DEMO_LOG_ERROR( "shader", "Failed to link %s\n%s", _setName,
+                        &error[0] );
 
         // release resource and delete program
         glDeleteProgram( program );
@@ -176,7 +178,7 @@ void Shader::load()
 
     // store program and bind attributes
     _program = program;
-    rndr::GrApi::logError( "Shader.load" );
+    DEMO_GL_CHECK( "Shader.load" );
 
     glUseProgram( _program );
     bindAttributes();
@@ -238,7 +240,7 @@ void Shader::bindAttributes()
     glUniform1i( specular, TEXTURE_INT_SPECULAR );
     glUniform1i( bump, TEXTURE_INT_BUMP );
 
-    GrApi::logError( "Shader.bindAttributes" );
+    DEMO_GL_CHECK( "Shader.bindAttributes" );
 }
 
 } // End nspc rndr
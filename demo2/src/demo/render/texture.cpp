@@ -167,7 +167,7 @@ void Texture::push( const Shader& shader )
             break;
     }
 
-    GrApi::logError( "Texture[" + typeName() + "].push" );
+    DEMO_GL_CHECK( "Texture.push", typeName() );
 
     _isOnGpu = true;
 }
@@ -183,7 +183,7 @@ void Texture::bind()
     glActiveTexture( _gl.textureInt );
     glBindTexture( GL_TEXTURE_2D, _gl.id );
 
-    GrApi::logError( "Texture[" + typeName() + "].bind" );
+    DEMO_GL_CHECK( "Texture.bind", typeName() );
 
     _isBound = true;
 }
@@ -198,7 +198,7 @@ void Texture::unbind()
     glActiveTexture( _gl.textureInt );
     glBindTexture( GL_TEXTURE_2D, 0 );
 
-    GrApi::logError( "Texture[" + typeName() + "].unbind" );
+    DEMO_GL_CHECK( "Texture.unbind", typeName() );
 
     _isBound = false;
 }
@@ -216,9 +216,9 @@ void Texture::remove()
 }
 
 // HELPER FUNCTIONS
-String Texture::typeName() const
+const char* Texture::typeName() const
 {
-    String name;
+    const char* name;
     switch ( type() )
     {
         case DIFFUSE:
@@ -102,7 +102,7 @@ class Texture
      * Get the type name for logging.
      * @return The type name.
      */
-    String typeName() const;
+    const char* typeName() const;
 
     /**
      * Check if the tyep is UNKNOWN.
@@ -25,6 +25,12 @@ void Window::open()
     glfwWindowHint( GLFW_CONTEXT_VERSION_MAJOR, 4 );
     glfwWindowHint( GLFW_CONTEXT_VERSION_MINOR, 1 );
     glfwWindowHint( GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE );
+
+    // debug contexts are needed for KHR_debug to report every message
+    #if DEMO_GL_DIAGNOSTICS >= 2
+    glfwWindowHint( GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE );
+    #endif
+
     _window = glfwCreateWindow( _width, _height, _title.c_str(), nullptr,
                                 nullptr );
 }
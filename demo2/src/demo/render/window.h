@@ -150,6 +150,18 @@ class Window : public RenderTarget
      * @return Is it open?
      */
     bool isOpen() const;
+
+    /**
+     * Check if the window has input focus.
+     * @return Is it focused?
+     */
+    bool isFocused() const;
+
+    /**
+     * Check if the window is minimized.
+     * @return Is it minimized?
+     */
+    bool isMinimized() const;
 };
 
 // CONSTRUCTORS
@@ -255,6 +267,18 @@ bool Window::isOpen() const
     return _window != nullptr;
 }
 
+inline
+bool Window::isFocused() const
+{
+    return isOpen() && glfwGetWindowAttrib( _window, GLFW_FOCUSED ) != 0;
+}
+
+inline
+bool Window::isMinimized() const
+{
+    return isOpen() && glfwGetWindowAttrib( _window, GLFW_ICONIFIED ) != 0;
+}
+
 } // End nspc rndr
 
 } // End nspc demo
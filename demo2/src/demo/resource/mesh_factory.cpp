@@ -1,6 +1,9 @@
 // mesh_factory.cpp
 #include "mesh_factory.h"
 
+#include "demo/memory/large_block_allocator.h"
+#include "demo/utility/profiler.h"
+
 namespace demo
 {
 
@@ -10,14 +13,20 @@ namespace res
 // MEMBER FUNCTIONS
 void MeshFactory::create( const aiMesh& mesh, rndr::MeshPtr out )
 {
+    DEMO_PROFILE_SCOPE( "MeshFactory::create" );
+
     // ensure that there is no more than one UV channel and if there is
     // a UV channel that it has exactly 2 components.
     assert( !mesh.HasTextureCoords( 1 ) );
     assert( !mesh.HasTextureCoords( 0 ) ||
             ( mesh.HasTextureCoords( 0 ) && mesh.mNumUVComponents[0] == 2 ) );
 
-    cntr::FixedArray<rndr::Mesh::Vertex> vertices( mesh.mNumVertices );
-    cntr::FixedArray<uint32> indices( mesh.mNumFaces * 3 );
+    // large meshes are mapped outside the heap
+    cntr::FixedArray<rndr::Mesh::Vertex> vertices(
+        mem::LargeBlockAllocator<rndr::Mesh::Vertex>::inst(),
+        mesh.mNumVertices );
+    cntr::FixedArray<uint32> indices(
+        mem::LargeBlockAllocator<uint32>::inst(), mesh.mNumFaces * 3 );
     uint32 materialIndex( mesh.mMaterialIndex );
 
     bool hasUv = mesh.HasTextureCoords( 0 );
@@ -51,7 +60,17 @@ void MeshFactory::create( const aiMesh& mesh, rndr::MeshPtr out )
         indices.push( face->mIndices[2] );
     }
 
-    out->load( std::move( vertices ), std::move( indices ), materialIndex );
+    // the bounds are found once here rather than every time they are culled
+    rndr::Bounds bounds;
+    if ( vertices.size() > 0 )
+    {
+        bounds = rndr::Bounds::fromPoints( &vertices[0].position,
+                                           vertices.size(),
+                                           sizeof( rndr::Mesh::Vertex ) );
+    }
+
+    out->load( std::move( vertices ), std::move( indices ), materialIndex,
+               bounds );
 }
 
 } // End nspc res
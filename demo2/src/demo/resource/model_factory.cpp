@@ -4,7 +4,11 @@
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 
+#include <algorithm>
+
+#include "demo/container/dynamic_array.h"
 #include "demo/resource/mesh_factory.h"
+#include "demo/utility/profiler.h"
 #include "material_factory.h"
 
 namespace demo
@@ -13,9 +17,14 @@ namespace demo
 namespace res
 {
 
+// CONSTANTS
+constexpr uint32 ModelFactory::MIN_PENDING_NODES;
+
 // MEMBER FUNCTIONS
 void ModelFactory::create( const String& path, rndr::ModelPtr out )
 {
+    DEMO_PROFILE_SCOPE( "ModelFactory::create" );
+
     assert( out );
     assert( !path.empty() );
 
@@ -34,7 +43,24 @@ void ModelFactory::create( const String& path, rndr::ModelPtr out )
 
     // process meshes
     cntr::FixedArray<rndr::Mesh> meshes( scene->mNumMeshes );
-    processNode( &meshes, scene->mRootNode, scene );
+    uint32 nodeCount = countNodes( scene );
+
+    // the pending nodes never outnumber the nodes, but the array is rounded
+    // up to a power of two and each shrink while popping takes a new block
+    // above the old one, so up to four times as much may be taken
+    Size scratchBytes = 4 * sizeof( aiNode* ) *
+                        std::max<Size>( nodeCount, MIN_PENDING_NODES );
+    if ( _scratch != nullptr && _scratch->available() >= scratchBytes )
+    {
+        // traversal data is released in one step when the scope ends
+        mem::StackScope scope( *_scratch );
+        mem::StackAdapter<aiNode*> nodeAlloc( _scratch );
+        processNodes( &meshes, scene, nodeCount, &nodeAlloc );
+    }
+    else
+    {
+        processNodes( &meshes, scene, nodeCount, nullptr );
+    }
 
     // process materials
     MaterialFactory materialFactory;
@@ -52,26 +78,76 @@ void ModelFactory::create( const String& path, rndr::ModelPtr out )
 }
 
 // HELPER FUNCTIONS
-void ModelFactory::processNode( cntr::FixedArray<rndr::Mesh>* out,
-                                aiNode* node, const aiScene* scene )
+uint32 ModelFactory::countNodes( const aiScene* scene )
 {
-    assert( node );
     assert( scene );
 
-    // process the node's meshes (if any)
-    MeshFactory meshFactory;
-    for ( uint32 i = 0; i < node->mNumMeshes; ++i )
+    // walk the tree in order through the parent links so counting needs no
+    // memory of its own
+    uint32 count = 0;
+    const aiNode* node = scene->mRootNode;
+    while ( node != nullptr )
     {
-        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-
-        rndr::Mesh nativeMesh;
-        meshFactory.create( *mesh, &nativeMesh );
-        out->push( std::move( nativeMesh ) );
+        ++count;
+        if ( node->mNumChildren > 0 )
+        {
+            node = node->mChildren[0];
+            continue;
+        }
+
+        // climb until an ancestor has a sibling after it
+        const aiNode* next = nullptr;
+        while ( next == nullptr && node != scene->mRootNode )
+        {
+            const aiNode* parent = node->mParent;
+            uint32 i = 0;
+            while ( parent->mChildren[i] != node )
+            {
+                ++i;
+            }
+
+            if ( i + 1 < parent->mNumChildren )
+            {
+                next = parent->mChildren[i + 1];
+            }
+            node = parent;
+        }
+        node = next;
     }
 
-    for ( uint32 i = 0; i < node->mNumChildren; ++i )
+    return count;
+}
+
+void ModelFactory::processNodes( cntr::FixedArray<rndr::Mesh>* out,
+                                 const aiScene* scene, uint32 nodeCount,
+                                 mem::IAllocator<aiNode*>* nodeAlloc )
+{
+    assert( scene );
+
+    MeshFactory meshFactory;
+    cntr::DynamicArray<aiNode*> pending( nodeAlloc, nodeCount );
+    pending.push( scene->mRootNode );
+
+    while ( !pending.isEmpty() )
     {
-        processNode( out, node->mChildren[i], scene );
+        aiNode* node = pending.pop();
+        assert( node );
+
+        // process the node's meshes (if any)
+        for ( uint32 i = 0; i < node->mNumMeshes; ++i )
+        {
+            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+
+            rndr::Mesh nativeMesh;
+            meshFactory.create( *mesh, &nativeMesh );
+            out->push( std::move( nativeMesh ) );
+        }
+
+        // push children in reverse to keep the original mesh order
+        for ( uint32 i = node->mNumChildren; i > 0; --i )
+        {
+            pending.push( node->mChildren[i - 1] );
+        }
     }
 }
 
@@ -7,6 +7,7 @@
 
 #include <assimp/scene.h>
 
+#include "demo/memory/stack_allocator.h"
 #include "demo/render/model.h"
 
 namespace demo
@@ -18,15 +19,38 @@ namespace res
 class ModelFactory
 {
   private:
+    // CONSTANTS
+    /**
+     * The fewest pending nodes room is made for, matching the smallest
+     * capacity of a dynamic array.
+     */
+    static constexpr uint32 MIN_PENDING_NODES = 32;
+
+    // MEMBERS
+    /**
+     * The stack used for temporary data while a model is processed.
+     */
+    mem::StackAllocator* _scratch;
+
     // HELPER FUNCTIONS
     /**
-     * Process a node in the scene.
+     * Get the number of nodes in the scene.
+     * @param scene The scene.
+     * @return The number of nodes.
+     */
+    static uint32 countNodes( const aiScene* scene );
+
+    /**
+     * Process the meshes of every node in the scene.
+     * The nodes are visited depth-first without recursion.
      * @param out The output array to store the meshes.
-     * @param node The node.
      * @param scene The scene.
+     * @param nodeCount The number of nodes in the scene.
+     * @param nodeAlloc The allocator for pending nodes (null for default).
      */
-    void processNode( cntr::FixedArray<rndr::Mesh>* out, aiNode* node,
-                      const aiScene* scene );
+    void processNodes( cntr::FixedArray<rndr::Mesh>* out,
+                       const aiScene* scene, uint32 nodeCount,
+                       mem::IAllocator<aiNode*>* nodeAlloc );
 
   public:
     // CONSTRUCTORS
@@ -35,6 +59,15 @@ class ModelFactory
      */
     ModelFactory();
 
+    /**
+     * Construct a new ModelFactory that uses the given scratch stack.
+     * Everything that is pushed onto the stack while a model is created is
+     * released before create returns. Models with more nodes than the stack
+     * has room for are processed on the heap instead.
+     * @param scratch The scratch stack.
+     */
+    ModelFactory( mem::StackAllocator* scratch );
+
     /**
      * Construct a copy of another ModelFactory.
      * @param other The other ModelFactory.
@@ -65,12 +98,19 @@ class ModelFactory
 
 // CONSTRUCTORS
 inline
-ModelFactory::ModelFactory()
+ModelFactory::ModelFactory() : _scratch( nullptr )
+{
+}
+
+inline
+ModelFactory::ModelFactory( mem::StackAllocator* scratch )
+    : _scratch( scratch )
 {
 }
 
 inline
 ModelFactory::ModelFactory( const ModelFactory& other )
+    : _scratch( other._scratch )
 {
 }
 
@@ -83,6 +123,8 @@ ModelFactory::~ModelFactory()
 inline
 ModelFactory& ModelFactory::operator=( const ModelFactory& other )
 {
+    _scratch = other._scratch;
+
     return *this;
 }
 
@@ -5,6 +5,8 @@
 #include "demo/render/texture.h"
 #include "demo/resource/model_factory.h"
 #include "demo/resource/texture_factory.h"
+#include "demo/utility/log.h"
+#include "demo/utility/profiler.h"
 
 namespace demo
 {
@@ -12,6 +14,9 @@ namespace demo
 namespace res
 {
 
+// CONSTANTS
+constexpr Size ResourceManager::LOAD_SCRATCH_SIZE;
+
 // GLOBALS
 ResourceManager* ResourceManager::g_instance = nullptr;
 
@@ -40,9 +45,26 @@ ResourceManager& ResourceManager::operator=( const ResourceManager& other )
     return *this;
 }
 
+// HELPER FUNCTIONS
+bool ResourceManager::obtainPath( util::StringId resId, String* path ) const
+{
+    const char* name = resId.str();
+    if ( name == nullptr )
+    {
+        DEMO_LOG_ERROR( "res", "No resource name for id 0x%016llx",
+                        static_cast<unsigned long long>( resId.id() ) );
+        return false;
+    }
+
+    *path = DEMO_RES_PATH + '/' + name;
+    return true;
+}
+
 // MEMBER FUNCTIONS
-rndr::ModelPtr ResourceManager::loadModel( const String& resId )
+rndr::ModelPtr ResourceManager::loadModel( util::StringId resId )
 {
+    DEMO_PROFILE_SCOPE( "ResourceManager::loadModel" );
+
     rndr::ModelPtr ptr;
     if ( _models.has( resId ) )
     {
@@ -50,10 +72,14 @@ rndr::ModelPtr ResourceManager::loadModel( const String& resId )
     }
     else
     {
-        String path = obtainPath( resId );
+        String path;
+        if ( !obtainPath( resId, &path ) )
+        {
+            return nullptr;
+        }
 
         rndr::ModelPtr model = _modelAlloc.get( 1 );
-        ModelFactory().create( path, model );
+        ModelFactory( &_loadScratch ).create( path, model );
         _models.put( resId, model );
 
         ptr = model;
@@ -62,9 +88,11 @@ rndr::ModelPtr ResourceManager::loadModel( const String& resId )
     return ptr;
 }
 
-rndr::TexturePtr  ResourceManager::loadTexture( const String& resId,
-                                                rndr::Texture::Type type )
+rndr::TexturePtr ResourceManager::loadTexture( util::StringId resId,
+                                               rndr::Texture::Type type )
 {
+    DEMO_PROFILE_SCOPE( "ResourceManager::loadTexture" );
+
     rndr::TexturePtr ptr;
     if ( _textures.has( resId ) )
     {
@@ -73,7 +101,11 @@ rndr::TexturePtr  ResourceManager::loadTexture( const String& resId,
     }
     else
     {
-        String path = obtainPath( resId );
+        String path;
+        if ( !obtainPath( resId, &path ) )
+        {
+            return nullptr;
+        }
 
         rndr::TexturePtr texture = _textureAlloc.get( 1 );
         TextureFactory().create( path, type, texture );
@@ -13,8 +13,10 @@
 
 #include "demo/build.g.h"
 #include "demo/container/map.h"
+#include "demo/memory/stack_allocator.h"
 #include "demo/render/model.h"
 #include "demo/render/texture.h"
+#include "demo/utility/string_id.h"
 
 namespace demo
 {
@@ -25,6 +27,12 @@ namespace res
 class ResourceManager
 {
   private:
+    // CONSTANTS
+    /**
+     * The size of the scratch stack used while loading.
+     */
+    static constexpr Size LOAD_SCRATCH_SIZE = 64 * 1024;
+
     // GLOBALS
     /**
      * The singleton instance.
@@ -35,12 +43,12 @@ class ResourceManager
     /**
      * The set of loaded models.
      */
-    cntr::Map<String, rndr::ModelPtr> _models;
+    cntr::Map<util::StringId, rndr::ModelPtr> _models;
 
     /**
      * The set of loaded textures.
      */
-    cntr::Map<String, rndr::TexturePtr> _textures;
+    cntr::Map<util::StringId, rndr::TexturePtr> _textures;
 
     /**
      * The model allocator.
@@ -52,13 +60,21 @@ class ResourceManager
      */
     mem::AllocatorGuard<rndr::Texture> _textureAlloc;
 
+    /**
+     * The scratch stack for temporary data while loading.
+     * This is never shared between copies.
+     */
+    mem::StackAllocator _loadScratch;
+
     // HELPER FUNCTIONS
     /**
      * Obtain the file path for the resource with the specified id.
+     * An id whose text was never interned has no path; this is logged.
      * @param resId The resource id.
-     * @return The file path.
+     * @param path The file path.
+     * @return Does it have a path?
      */
-    String obtainPath( const String& resId ) const;
+    bool obtainPath( util::StringId resId, String* path ) const;
 
   public:
     // GLOBAL METHODS
@@ -116,6 +132,13 @@ class ResourceManager
      */
     rndr::ModelPtr loadModel( const String& resId );
 
+    /**
+     * Load a model.
+     * @param resId The interned resource id.
+     * @return The model, or null if the id's text was never interned.
+     */
+    rndr::ModelPtr loadModel( util::StringId resId );
+
     /**
      * Load a texture.
      * Each texture is only allowed one type. Behavior is undefined otherwise.
@@ -125,6 +148,16 @@ class ResourceManager
      */
     rndr::TexturePtr loadTexture( const String& resId,
                                   rndr::Texture::Type type );
+
+    /**
+     * Load a texture.
+     * Each texture is only allowed one type. Behavior is undefined otherwise.
+     * @param resId The interned resource id.
+     * @param type The desired texture type.
+     * @return The texture, or null if the id's text was never interned.
+     */
+    rndr::TexturePtr loadTexture( util::StringId resId,
+                                  rndr::Texture::Type type );
 };
 
 // GLOBAL METHODS
@@ -152,24 +185,34 @@ void ResourceManager::shutdown()
 // CONSTRUCTORS
 inline
 ResourceManager::ResourceManager()
-        : _models(), _textures(), _modelAlloc(), _textureAlloc()
+        : _models(), _textures(), _modelAlloc(), _textureAlloc(),
+          _loadScratch( LOAD_SCRATCH_SIZE )
 {
 }
 
 inline
 ResourceManager::ResourceManager( const ResourceManager& other )
         : _models( other._models ), _textures( other._textures ),
-          _modelAlloc( other._modelAlloc ), _textureAlloc( other._textureAlloc )
+          _modelAlloc( other._modelAlloc ), _textureAlloc( other._textureAlloc ),
+          _loadScratch( LOAD_SCRATCH_SIZE )
 {
 }
 
-// HELPER FUNCTIONS
+// MEMBER FUNCTIONS
 inline
-String ResourceManager::obtainPath( const String& resId ) const
+rndr::ModelPtr ResourceManager::loadModel( const String& resId )
 {
-    return DEMO_RES_PATH + '/' + resId;
+    return loadModel( util::StringId( resId ) );
 }
 
+inline
+rndr::TexturePtr ResourceManager::loadTexture( const String& resId,
+                                               rndr::Texture::Type type )
+{
+    return loadTexture( util::StringId( resId ), type );
+}
+
+
 } // End nspc res
 
 } // End nspc demo
@@ -4,6 +4,9 @@
 #include <assert.h>
 #include <FreeImage.h>
 
+#include "demo/memory/large_block_allocator.h"
+#include "demo/utility/profiler.h"
+
 namespace demo
 {
 
@@ -14,6 +17,8 @@ namespace res
 void TextureFactory::create( const String& path, rndr::Texture::Type type,
                              rndr::TexturePtr out )
 {
+    DEMO_PROFILE_SCOPE( "TextureFactory::create" );
+
     assert( out != nullptr );
 
     const char* filePath = path.c_str();
@@ -80,8 +85,11 @@ void TextureFactory::create( const String& path, rndr::Texture::Type type,
     uint8* imageData = FreeImage_GetBits( formattedBitmap );
     uint32 size = imageWidth * imageHeight * ( desiredBpp / 8 );
 
-    // load texture with data
-    out->load( type, cntr::FixedArray<uint8>::copy( imageData, size, size ),
+    // load texture with data (large images are mapped outside the heap)
+    mem::LargeBlockAllocator<uint8>* allocator =
+        mem::LargeBlockAllocator<uint8>::inst();
+    out->load( type, cntr::FixedArray<uint8>::copy( allocator, imageData, size,
+                                                    size ),
                imageWidth, imageHeight, desiredBpp );
 
     // release FreeImage resources
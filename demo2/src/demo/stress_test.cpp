@@ -0,0 +1,260 @@
+// stress_test.cpp
+#include "stress_test.h"
+
+#include <cmath>
+
+#include "demo/memory/allocation_counter.h"
+#include "demo/memory/no_alloc_scope.h"
+#include "demo/render/grapi.h"
+#include "demo/render/gl_recorder.h"
+#include "demo/resource/resource_manager.h"
+#include "demo/utility/cpu_features.h"
+#include "demo/utility/hash_utils.h"
+#include "demo/utility/log.h"
+#include "demo/utility/profiler.h"
+
+namespace demo
+{
+
+// CONSTANTS
+constexpr uint32 StressTest::MIN_OBJECTS;
+constexpr uint32 StressTest::MAX_OBJECTS;
+constexpr uint32 StressTest::DEFAULT_OBJECTS;
+constexpr uint32 StressTest::DEFAULT_FRAMES;
+constexpr float StressTest::FRAME_STEP;
+constexpr float StressTest::SPACING;
+constexpr float StressTest::ORBIT_PERIOD;
+constexpr float StressTest::MAX_SPIN_RATE;
+constexpr uint32 StressTest::WARMUP_FRAMES;
+
+// MEMBER FUNCTIONS
+bool StressTest::startup()
+{
+    DEMO_PROFILE_SCOPE( "StressTest::startup" );
+
+    // start up subsystems
+    bool successful = rndr::GrApi::startup();
+    res::ResourceManager::startup();
+
+    if ( !successful )
+    {
+        return false;
+    }
+
+    // set up window
+    _window.setTitle( "Demo 2: Stress Test" );
+    _window.open();
+    _window.activate();
+    char features[util::CpuFeatures::DESCRIPTION_SIZE];
+    util::CpuFeatures::describe( features, sizeof( features ) );
+    DEMO_LOG_INFO( "cpu", "%s", features );
+    rndr::GrApi::installDebugOutput();
+
+    // create and compile shader
+    _shader = rndr::Shader( "simple" );
+    _shader.load();
+
+    // prepare renderer
+    _renderer.setRenderTarget( &_window );
+    _renderer.setShader( &_shader );
+
+    // set up camera, far enough to see across the largest grid
+    _camera.setFarPlane( extent() * 4.0f + 100.0f );
+    _camera.setNearPlane( 0.01f );
+    _camera.setFieldOfView( 45.0f );
+
+    // load the shared models
+    res::ResourceManager* resMgr = res::ResourceManager::inst();
+    rndr::ModelPtr models[] = { resMgr->loadModel( "models/cyborg.obj" ),
+                                resMgr->loadModel( "models/nanosuit.obj" ),
+                                resMgr->loadModel( "models/box.obj" ) };
+    const uint32 modelCount = sizeof( models ) / sizeof( rndr::ModelPtr );
+
+    for ( uint32 i = 0; i < modelCount; ++i )
+    {
+        models[i]->push( _shader );
+    }
+    DEMO_GL_CHECK( "StressTest.startup" );
+
+    spawnObjects( models, modelCount );
+    _scene.setThreadPool( &_threadPool );
+    _renderer.setThreadPool( &_threadPool );
+    _scene.setFrameStats( &_frameStats );
+
+    _frameStats.setBudget( FRAME_STEP );
+    _clock.setFrameStats( &_frameStats );
+
+    return true;
+}
+
+bool StressTest::run()
+{
+    glEnable( GL_DEPTH_TEST );
+    glEnable( GL_CULL_FACE );
+
+    glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
+
+    _loadCalls = rndr::GlRecorder::total();
+
+    // visit the whole path so the frames see as many objects as they will
+    for ( uint32 frame = 0; frame < WARMUP_FRAMES && _window.isOpen();
+          ++frame )
+    {
+        runFrame( frame * _frameCount / WARMUP_FRAMES * FRAME_STEP );
+    }
+
+    // only count the calls made by measured frames
+    rndr::GlRecorder::reset();
+    _frameStats.reset();
+
+    _clock.setFrameStats( nullptr );
+    _clock.tick();
+    _clock.setFrameStats( &_frameStats );
+
+    _frameAllocations = 0;
+    for ( uint32 frame = 0; frame < _frameCount && _window.isOpen(); ++frame )
+    {
+        mem::NoAllocScope guard( "StressTest::run", false );
+        runFrame( frame * FRAME_STEP );
+        _frameAllocations += guard.allocations();
+    }
+
+    return _frameAllocations == 0;
+}
+
+void StressTest::report( FILE* file ) const
+{
+    uint64 frames = _frameStats.frameCount();
+
+    fprintf( file, "Stress test with %u object(s) over %llu frame(s), "
+             "%llu GL call(s) while loading:\n", _objectCount,
+             static_cast<unsigned long long>( frames ),
+             static_cast<unsigned long long>( _loadCalls ) );
+
+    if ( mem::AllocationCounter::IS_TRACKING )
+    {
+        fprintf( file, "%llu heap allocation(s) after %u warm-up frame(s)\n",
+                 static_cast<unsigned long long>( _frameAllocations ),
+                 WARMUP_FRAMES );
+    }
+    else
+    {
+        fprintf( file, "Heap allocations not tracked\n" );
+    }
+
+    _frameStats.dump( file );
+    _scene.dumpTickGroups( file );
+    _scene.dumpSpatialIndex( file );
+    _renderer.dumpCullStats( file );
+    rndr::GlRecorder::dump( file, frames );
+}
+
+void StressTest::shutdown()
+{
+    for ( uint32 i = 0; i < _objects.size(); ++i )
+    {
+        _scene.removeObject( _objects[i] );
+        delete _objects[i];
+    }
+    _objects.clear();
+    _spinRates.clear();
+
+    res::ResourceManager::shutdown();
+    rndr::GrApi::shutdown();
+}
+
+// HELPER FUNCTIONS
+void StressTest::spawnObjects( rndr::ModelPtr* models, uint32 modelCount )
+{
+    uint32 side = static_cast<uint32>(
+        std::ceil( std::sqrt( static_cast<float>( _objectCount ) ) ) );
+    float offset = ( side - 1 ) * SPACING * 0.5f;
+
+    for ( uint32 i = 0; i < _objectCount; ++i )
+    {
+        // pick the model and spin from a hash so neighbors differ
+        uint64 random = util::HashUtils::mix64( i );
+
+        // the boxes are solid, so they hide whatever is behind them
+        uint32 model = random % modelCount;
+        obj::ModelObject* object = new obj::ModelObject( models[model] );
+        object->setOccluding( model == modelCount - 1 );
+        object->transform().setPosition( ( i % side ) * SPACING - offset,
+                                         0.0f,
+                                         ( i / side ) * SPACING - offset );
+
+        float unit = static_cast<float>( ( random >> 32 ) & 0xFFFF ) /
+                     65535.0f;
+
+        _objects.push( object );
+        _spinRates.push( ( unit * 2.0f - 1.0f ) * MAX_SPIN_RATE );
+        _scene.addObject( object );
+    }
+}
+
+void StressTest::runFrame( float time )
+{
+    {
+        DEMO_PROFILE_SCOPE( "StressTest::update" );
+        util::PhaseTimer timer( &_frameStats, util::FrameStats::UPDATE );
+
+        glfwPollEvents();
+
+        moveCamera( time );
+        _scene.tick( FRAME_STEP );
+        for ( uint32 i = 0; i < _objects.size(); ++i )
+        {
+            _objects[i]->transform().setEulerRotation(
+                0.0f, std::fmod( _spinRates[i] * time, 360.0f ), 0.0f );
+        }
+        _scene.updateTransforms();
+    }
+
+    {
+        DEMO_PROFILE_SCOPE( "StressTest::render" );
+        util::PhaseTimer timer( &_frameStats, util::FrameStats::RENDER );
+
+        glViewport( 0, 0, _window.width(), _window.height() );
+        glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+
+        _renderer.render( _camera, _scene );
+
+        DEMO_GL_CHECK_FRAME( "StressTest (render)" );
+    }
+
+    {
+        DEMO_PROFILE_SCOPE( "StressTest::swap" );
+        util::PhaseTimer timer( &_frameStats, util::FrameStats::SWAP );
+
+        _window.swapBuffer();
+        _window.update();
+    }
+
+    _clock.tick();
+    DEMO_PROFILE_FRAME();
+}
+
+void StressTest::moveCamera( float time )
+{
+    // orbit the grid while moving in and out so both the whole scene and
+    // close-ups are drawn
+    const float TWO_PI = 6.2831853f;
+    float angle = TWO_PI * time / ORBIT_PERIOD;
+    float radius = ( extent() + 10.0f ) *
+                   ( 1.0f + 0.5f * std::sin( angle * 3.0f ) );
+    float height = 5.0f + extent() * 0.5f;
+
+    _camera.transform().lookAt(
+        glm::vec3( radius * std::cos( angle ), height,
+                   radius * std::sin( angle ) ),
+        glm::vec3( 0.0f, 0.0f, 0.0f ),
+        glm::vec3( 0.0f, 1.0f, 0.0f ) );
+}
+
+float StressTest::extent() const
+{
+    float side = std::ceil( std::sqrt( static_cast<float>( _objectCount ) ) );
+    return side * SPACING * 0.5f;
+}
+
+} // End nspc demo
@@ -0,0 +1,268 @@
+// stress_test.h
+//
+// Measures the CPU cost of the render path at scene scale.
+//
+// The stress test fills a scene with a grid of objects that share the loaded
+// models, spins each of them at its own rate and flies the camera along a
+// scripted orbit for a fixed number of frames. Frames are not paced and the
+// simulation always advances by a fixed step, so two runs with the same
+// settings do exactly the same work.
+//
+// When built with DEMO_HEADLESS the graphics api only records calls, which
+// allows the test to run on machines without a GPU. The report contains the
+// time spent in each phase of the frame and the number of each graphics api
+// call that was made.
+//
+// Before the measured frames, a few warm-up frames are spread over the whole
+// camera path so that the arrays the frame reuses grow to their steady size.
+// The measured frames must then not allocate from the heap on the calling
+// thread. Each frame is guarded by a mem::NoAllocScope and run reports
+// whether any frame allocated. Allocations are only seen when the allocation
+// hook is compiled in (see mem::AllocationCounter), which headless builds
+// always do.
+//
+#ifndef DEMO_STRESS_TEST_H
+#define DEMO_STRESS_TEST_H
+
+#include <stdio.h>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/object/camera.h"
+#include "demo/object/model_object.h"
+#include "demo/object/scene.h"
+#include "demo/render/renderer.h"
+#include "demo/render/shader.h"
+#include "demo/render/window.h"
+#include "demo/utility/clock.h"
+#include "demo/utility/frame_stats.h"
+#include "demo/utility/thread_pool.h"
+
+namespace demo
+{
+
+class StressTest
+{
+  public:
+    // CONSTANTS
+    /**
+     * The fewest objects the test runs with.
+     */
+    static constexpr uint32 MIN_OBJECTS = 10;
+
+    /**
+     * The most objects the test runs with.
+     */
+    static constexpr uint32 MAX_OBJECTS = 100000;
+
+    /**
+     * The default number of objects.
+     */
+    static constexpr uint32 DEFAULT_OBJECTS = 1000;
+
+    /**
+     * The default number of frames.
+     */
+    static constexpr uint32 DEFAULT_FRAMES = 600;
+
+  private:
+    // CONSTANTS
+    /**
+     * The simulated time between frames in seconds.
+     */
+    static constexpr float FRAME_STEP = 1.0f / 60.0f;
+
+    /**
+     * The distance between neighboring objects.
+     */
+    static constexpr float SPACING = 4.0f;
+
+    /**
+     * The time it takes the camera to circle the scene in seconds.
+     */
+    static constexpr float ORBIT_PERIOD = 20.0f;
+
+    /**
+     * The fastest an object spins in degrees per second.
+     */
+    static constexpr float MAX_SPIN_RATE = 90.0f;
+
+    /**
+     * The number of frames that may allocate before the measured frames,
+     * spread evenly over the camera path.
+     */
+    static constexpr uint32 WARMUP_FRAMES = 60;
+
+    // MEMBERS
+    /**
+     * The renderer.
+     */
+    rndr::Renderer _renderer;
+
+    /**
+     * The shader.
+     */
+    rndr::Shader _shader;
+
+    /**
+     * The window the test is drawn to.
+     */
+    rndr::Window _window;
+
+    /**
+     * The scripted camera.
+     */
+    obj::Camera _camera;
+
+    /**
+     * The generated objects.
+     */
+    cntr::DynamicArray<obj::ModelObject*> _objects;
+
+    /**
+     * The spin rate of each object in degrees per second.
+     */
+    cntr::DynamicArray<float> _spinRates;
+
+    /**
+     * The threads the scene spreads ticks and transform updates across.
+     */
+    util::ThreadPool _threadPool;
+
+    /**
+     * The scene.
+     */
+    obj::Scene _scene;
+
+    /**
+     * The real-time clock used to measure frames.
+     */
+    util::Clock _clock;
+
+    /**
+     * The frame time telemetry.
+     */
+    util::FrameStats _frameStats;
+
+    /**
+     * The number of objects to generate.
+     */
+    uint32 _objectCount;
+
+    /**
+     * The number of frames to run.
+     */
+    uint32 _frameCount;
+
+    /**
+     * The number of graphics api calls made while loading.
+     */
+    uint64 _loadCalls;
+
+    /**
+     * The number of heap allocations made by the measured frames.
+     */
+    uint64 _frameAllocations;
+
+    // HELPER FUNCTIONS
+    /**
+     * Generate the objects in a square grid centered on the origin.
+     * @param models The models to share between the objects.
+     * @param modelCount The number of models.
+     */
+    void spawnObjects( rndr::ModelPtr* models, uint32 modelCount );
+
+    /**
+     * Run a single frame.
+     * @param time The simulated time in seconds.
+     */
+    void runFrame( float time );
+
+    /**
+     * Move the camera to its place on the path at the given time.
+     * @param time The simulated time in seconds.
+     */
+    void moveCamera( float time );
+
+    /**
+     * Get the distance from the center of the grid to its edge.
+     * @return The extent.
+     */
+    float extent() const;
+
+    // HIDDEN FUNCTIONS
+    /**
+     * Hidden constructor.
+     */
+    StressTest( const StressTest& other ) = delete;
+
+    /**
+     * Hidden operator.
+     */
+    StressTest& operator=( const StressTest& other ) = delete;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct a new stress test.
+     * The object count is clamped to the supported range.
+     * @param objectCount The number of objects.
+     * @param frameCount The number of frames.
+     */
+    StressTest( uint32 objectCount, uint32 frameCount );
+
+    /**
+     * Destruct the stress test.
+     */
+    ~StressTest();
+
+    // MEMBER FUNCTIONS
+    /**
+     * Load the models and generate the scene.
+     * @return Whether it starts up successfully.
+     */
+    bool startup();
+
+    /**
+     * Run the warm-up frames and then every measured frame.
+     * @return Whether the measured frames made no heap allocations.
+     */
+    bool run();
+
+    /**
+     * Write the report.
+     * @param file The file to write to.
+     */
+    void report( FILE* file ) const;
+
+    /**
+     * Release the scene and the graphics api.
+     */
+    void shutdown();
+};
+
+// CONSTRUCTORS
+inline
+StressTest::StressTest( uint32 objectCount, uint32 frameCount )
+    : _renderer(), _shader(), _window(), _camera(), _objects(), _spinRates(),
+      _threadPool( util::ThreadPool::defaultThreadCount() ), _scene(),
+      _clock(), _frameStats(), _objectCount( objectCount ),
+      _frameCount( frameCount ), _loadCalls( 0 ), _frameAllocations( 0 )
+{
+    if ( _objectCount < MIN_OBJECTS )
+    {
+        _objectCount = MIN_OBJECTS;
+    }
+    else if ( _objectCount > MAX_OBJECTS )
+    {
+        _objectCount = MAX_OBJECTS;
+    }
+}
+
+inline
+StressTest::~StressTest()
+{
+}
+
+} // End nspc demo
+
+#endif // DEMO_STRESS_TEST_H
@@ -1,6 +1,8 @@
 // clock.cpp
 #include "clock.h"
 
+#include "demo/utility/frame_stats.h"
+
 namespace demo
 {
 
@@ -15,9 +17,15 @@ void Clock::tick()
     SysClock::time_point now = SysClock::now();
     SysClock::duration dt = now - _time;
 
-    _dt = _timeScale * duration_cast<FSeconds>( dt );
+    FSeconds realDt = duration_cast<FSeconds>( dt );
+    _dt = _timeScale * realDt;
     _elapsed += duration_cast<SysClock::duration>( _dt );
 
+    if ( _frameStats != nullptr )
+    {
+        _frameStats->recordFrame( realDt.count() );
+    }
+
     _time = now;
 }
 
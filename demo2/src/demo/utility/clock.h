@@ -13,6 +13,8 @@ namespace demo
 namespace util
 {
 
+class FrameStats;
+
 class Clock
 {
   public:
@@ -47,6 +49,11 @@ class Clock
      */
     float _timeScale;
 
+    /**
+     * The stats that every tick is recorded into or null.
+     */
+    FrameStats* _frameStats;
+
   public:
     // CONSTRUCTORS
     /**
@@ -92,6 +99,12 @@ class Clock
      */
     SysClock::duration elapsed() const;
 
+    /**
+     * Get the stats that ticks are recorded into.
+     * @return The frame stats or null.
+     */
+    FrameStats* frameStats() const;
+
     // MUTATOR FUNCTIONS
     /**
      * Set the time scaling factor.
@@ -100,6 +113,13 @@ class Clock
      */
     void setTimeScale( float timeScale );
 
+    /**
+     * Set the stats that ticks are recorded into.
+     * The unscaled time of every tick is recorded as the frame time.
+     * @param frameStats The frame stats or null to stop recording.
+     */
+    void setFrameStats( FrameStats* frameStats );
+
     // MEMBER FUNCTIONS
     /**
      * Recompute the elapsed time.
@@ -115,14 +135,14 @@ class Clock
 // CONSTRUCTORS
 inline
 Clock::Clock() : _time( SysClock::now() ), _elapsed( 0L ), _dt( 0.0f ),
-                 _timeScale( 1.0f )
+                 _timeScale( 1.0f ), _frameStats( nullptr )
 {
 }
 
 inline
 Clock::Clock( const Clock& other )
         : _time( other._time ), _elapsed( other._elapsed ), _dt( other._dt ),
-          _timeScale( other._timeScale )
+          _timeScale( other._timeScale ), _frameStats( other._frameStats )
 {
 }
 
@@ -159,6 +179,12 @@ Clock::SysClock::duration Clock::elapsed() const
     return _elapsed;
 }
 
+inline
+FrameStats* Clock::frameStats() const
+{
+    return _frameStats;
+}
+
 // MUTATOR FUNCTIONS
 inline
 void Clock::setTimeScale( float timeScale )
@@ -166,6 +192,12 @@ void Clock::setTimeScale( float timeScale )
     _timeScale = timeScale;
 }
 
+inline
+void Clock::setFrameStats( FrameStats* frameStats )
+{
+    _frameStats = frameStats;
+}
+
 } // End nspc util
 
 } // End nspc demo
@@ -0,0 +1,208 @@
+// cpu_features.cpp
+#include "demo/utility/cpu_features.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef DEMO_ARCH_X86
+#ifdef _MSC_VER
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace demo
+{
+
+namespace util
+{
+
+// CONSTANTS
+constexpr uint32 CpuFeatures::DESCRIPTION_SIZE;
+
+// GLOBALS
+std::atomic<bool> CpuFeatures::g_forceScalar( false );
+
+#ifdef DEMO_ARCH_X86
+// HELPER FUNCTIONS
+/**
+ * Gets the registers that cpuid reports for a leaf and sub-leaf. The
+ * registers are zero if the leaf is not supported.
+ */
+static void cpuid( uint32 leaf, uint32 subleaf, uint32 registers[4] )
+{
+    #ifdef _MSC_VER
+    int values[4];
+    __cpuidex( values, static_cast<int>( leaf ),
+               static_cast<int>( subleaf ) );
+    for ( uint32 i = 0; i < 4; ++i )
+    {
+        registers[i] = static_cast<uint32>( values[i] );
+    }
+    #else
+    registers[0] = registers[1] = registers[2] = registers[3] = 0;
+    __get_cpuid_count( leaf, subleaf, &registers[0], &registers[1],
+                       &registers[2], &registers[3] );
+    #endif
+}
+
+/**
+ * Gets the register state the operating system saves on a context switch.
+ * This must only be called if the processor supports xgetbv.
+ */
+static uint64 xgetbv()
+{
+    #ifdef _MSC_VER
+    return _xgetbv( 0 );
+    #else
+    uint32 low;
+    uint32 high;
+    __asm__ __volatile__( "xgetbv" : "=a"( low ), "=d"( high ) : "c"( 0 ) );
+    return ( static_cast<uint64>( high ) << 32 ) | low;
+    #endif
+}
+#endif
+
+uint32 CpuFeatures::detect()
+{
+    // read the environment while detection runs once
+    const char* force = getenv( "DEMO_FORCE_SCALAR" );
+    if ( force != nullptr && strcmp( force, "" ) != 0 &&
+         strcmp( force, "0" ) != 0 )
+    {
+        g_forceScalar.store( true, std::memory_order_relaxed );
+    }
+
+    uint32 features = 0;
+
+    #ifdef DEMO_ARCH_X86
+    uint32 registers[4];
+    cpuid( 0, 0, registers );
+    uint32 maxLeaf = registers[0];
+
+    cpuid( 1, 0, registers );
+    uint32 ecx = registers[2];
+    uint32 edx = registers[3];
+
+    if ( edx & ( 1u << 26 ) )
+    {
+        features |= 1u << SSE2;
+    }
+
+    if ( ecx & ( 1u << 19 ) )
+    {
+        features |= 1u << SSE41;
+    }
+
+    // the ymm and zmm registers are only usable if the os saves them
+    uint64 xcr0 = ( ecx & ( 1u << 27 ) ) != 0 ? xgetbv() : 0;
+    bool isYmmSaved = ( xcr0 & 0x06 ) == 0x06;
+    bool isZmmSaved = ( xcr0 & 0xE6 ) == 0xE6;
+
+    if ( isYmmSaved && ( ecx & ( 1u << 28 ) ) )
+    {
+        features |= 1u << AVX;
+
+        if ( ecx & ( 1u << 12 ) )
+        {
+            features |= 1u << FMA;
+        }
+    }
+
+    if ( maxLeaf >= 7 )
+    {
+        cpuid( 7, 0, registers );
+        uint32 ebx = registers[1];
+
+        if ( isYmmSaved && ( ebx & ( 1u << 5 ) ) )
+        {
+            features |= 1u << AVX2;
+        }
+
+        if ( isZmmSaved && ( ebx & ( 1u << 16 ) ) )
+        {
+            features |= 1u << AVX512F;
+        }
+    }
+    #endif
+
+    return features;
+}
+
+uint32 CpuFeatures::detected()
+{
+    static const uint32 features = detect();
+    return features;
+}
+
+// UTILITY FUNCTIONS
+CpuFeatures::Tier CpuFeatures::supportedTier()
+{
+    static const Tier best = []() {
+        if ( !isSupported( SSE2 ) || !isSupported( SSE41 ) )
+        {
+            return TIER_SCALAR;
+        }
+        else if ( !isSupported( AVX2 ) || !isSupported( FMA ) )
+        {
+            return TIER_SSE41;
+        }
+        else if ( !isSupported( AVX512F ) )
+        {
+            return TIER_AVX2;
+        }
+
+        return TIER_AVX512;
+    }();
+
+    return best;
+}
+
+const char* CpuFeatures::name( Feature feature )
+{
+    static const char* const FEATURE_NAMES[FEATURE_COUNT] = {
+        "sse2", "sse4.1", "avx", "avx2", "fma", "avx512f" };
+
+    return FEATURE_NAMES[feature];
+}
+
+const char* CpuFeatures::name( Tier tier )
+{
+    static const char* const TIER_NAMES[TIER_COUNT] = {
+        "scalar", "sse4.1", "avx2", "avx512" };
+
+    return TIER_NAMES[tier];
+}
+
+void CpuFeatures::describe( FILE* file )
+{
+    char description[DESCRIPTION_SIZE];
+    describe( description, sizeof( description ) );
+    fprintf( file, "%s\n", description );
+}
+
+void CpuFeatures::describe( char* buffer, Size size )
+{
+    int used = snprintf( buffer, size, "CPU features:" );
+    for ( uint32 i = 0; i < FEATURE_COUNT; ++i )
+    {
+        if ( used >= 0 && static_cast<Size>( used ) < size &&
+             isSupported( static_cast<Feature>( i ) ) )
+        {
+            used += snprintf( buffer + used, size - used, " %s",
+                              name( static_cast<Feature>( i ) ) );
+        }
+    }
+
+    if ( used >= 0 && static_cast<Size>( used ) < size )
+    {
+        snprintf( buffer + used, size - used, " (using %s%s)",
+                  name( tier() ), isForcedScalar() ? ", forced" : "" );
+    }
+}
+
+} // End nspc util
+
+} // End nspc demo
@@ -0,0 +1,182 @@
+// cpu_features.h
+//
+// Detects the SIMD instruction sets supported by the running machine.
+//
+// The project is built for the baseline of its architecture so that one
+// binary runs everywhere. Hot kernels provide an implementation for each
+// tier and pick the best one the machine supports at runtime through
+// util::Dispatch. A tier is only reported once both the processor and the
+// operating system support it, since the wider registers must be saved on a
+// context switch.
+//
+// Setting the DEMO_FORCE_SCALAR environment variable to anything but 0, or
+// calling setForceScalar, makes every kernel use its scalar implementation,
+// which allows the SIMD implementations to be checked against it.
+//
+#ifndef DEMO_CPU_FEATURES_H
+#define DEMO_CPU_FEATURES_H
+
+#include <atomic>
+#include <stdio.h>
+
+#include "demo/intdef.h"
+#include "demo/port.h"
+
+namespace demo
+{
+
+namespace util
+{
+
+class CpuFeatures
+{
+  public:
+    // TYPES
+    /**
+     * The detected instruction sets.
+     */
+    enum Feature
+    {
+        SSE2,
+        SSE41,
+        AVX,
+        AVX2,
+        FMA,
+        AVX512F,
+        FEATURE_COUNT
+    };
+
+    /**
+     * The sets of features that kernels are implemented for, from least to
+     * most capable. Each tier includes every tier below it.
+     */
+    enum Tier
+    {
+        TIER_SCALAR,
+        TIER_SSE41,
+        TIER_AVX2,
+        TIER_AVX512,
+        TIER_COUNT
+    };
+
+    // CONSTANTS
+    /**
+     * The size of a buffer that holds any description of the features.
+     */
+    static constexpr uint32 DESCRIPTION_SIZE = 128;
+
+  private:
+    // GLOBALS
+    /**
+     * Whether every kernel is forced to use its scalar implementation.
+     */
+    static std::atomic<bool> g_forceScalar;
+
+    // HELPER FUNCTIONS
+    /**
+     * Gets the features supported by the processor and operating system as
+     * a mask of feature bits.
+     */
+    static uint32 detect();
+
+    /**
+     * Gets the detected features, detecting them on first use.
+     */
+    static uint32 detected();
+
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Checks if a feature can be used.
+     * This is always false in forced scalar mode.
+     */
+    static bool has( Feature feature );
+
+    /**
+     * Checks if a feature is supported by the machine regardless of forced
+     * scalar mode.
+     */
+    static bool isSupported( Feature feature );
+
+    /**
+     * Gets the best tier that can be used.
+     */
+    static Tier tier();
+
+    /**
+     * Gets the best tier supported by the machine regardless of forced
+     * scalar mode.
+     */
+    static Tier supportedTier();
+
+    /**
+     * Checks if kernels are forced to use their scalar implementations.
+     */
+    static bool isForcedScalar();
+
+    /**
+     * Sets whether kernels are forced to use their scalar implementations.
+     */
+    static void setForceScalar( bool forceScalar );
+
+    /**
+     * Gets the name of a feature.
+     */
+    static const char* name( Feature feature );
+
+    /**
+     * Gets the name of a tier.
+     */
+    static const char* name( Tier tier );
+
+    /**
+     * Writes the supported features and the tier in use.
+     */
+    static void describe( FILE* file );
+
+    /**
+     * Writes the supported features and the tier in use to a buffer of at
+     * least DESCRIPTION_SIZE characters, without a line break.
+     */
+    static void describe( char* buffer, Size size );
+};
+
+// UTILITY FUNCTIONS
+inline
+bool CpuFeatures::has( Feature feature )
+{
+    return !isForcedScalar() && isSupported( feature );
+}
+
+inline
+bool CpuFeatures::isSupported( Feature feature )
+{
+    return ( detected() & ( 1u << feature ) ) != 0;
+}
+
+inline
+CpuFeatures::Tier CpuFeatures::tier()
+{
+    return isForcedScalar() ? TIER_SCALAR : supportedTier();
+}
+
+inline
+bool CpuFeatures::isForcedScalar()
+{
+    // detection reads the environment so it must happen first
+    detected();
+    return g_forceScalar.load( std::memory_order_relaxed );
+}
+
+inline
+void CpuFeatures::setForceScalar( bool forceScalar )
+{
+    detected();
+    g_forceScalar.store( forceScalar, std::memory_order_relaxed );
+}
+
+} // End nspc util
+
+} // End nspc demo
+
+#endif // DEMO_CPU_FEATURES_H
@@ -0,0 +1,2 @@
+// dispatch.cpp
+#include "demo/utility/dispatch.h"
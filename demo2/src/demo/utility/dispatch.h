@@ -0,0 +1,102 @@
+// dispatch.h
+//
+// A table of kernel implementations indexed by SIMD tier.
+//
+// A kernel provides a scalar implementation and any number of SIMD ones.
+// Each call uses the implementation for the best tier that is both
+// available and no better than the one util::CpuFeatures allows, so forcing
+// scalar mode takes effect on the next call. Tables are constant
+// initialized and may be used during static initialization.
+//
+// For example:
+// const Dispatch<FillFn> g_fill( &fillScalar, &fillSse41, &fillAvx2,
+//                                 nullptr );
+// g_fill.get()( out, value, count );
+//
+#ifndef DEMO_DISPATCH_H
+#define DEMO_DISPATCH_H
+
+#include <assert.h>
+
+#include "demo/utility/cpu_features.h"
+
+namespace demo
+{
+
+namespace util
+{
+
+template <typename F>
+class Dispatch
+{
+  private:
+    // MEMBERS
+    /**
+     * The implementation for each tier or null if there is none.
+     */
+    F _impls[CpuFeatures::TIER_COUNT];
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs a table from the implementation for each tier.
+     * Every implementation but the scalar one may be null.
+     */
+    constexpr Dispatch( F scalar, F sse41, F avx2, F avx512 );
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Gets the implementation for the best usable tier.
+     */
+    F get() const;
+
+    /**
+     * Gets the tier of the implementation returned by get.
+     */
+    CpuFeatures::Tier tier() const;
+
+    /**
+     * Gets the implementation for a tier or null if there is none.
+     * The caller must check that the machine supports the tier.
+     */
+    F at( CpuFeatures::Tier tier ) const;
+};
+
+// CONSTRUCTORS
+template <typename F>
+constexpr Dispatch<F>::Dispatch( F scalar, F sse41, F avx2, F avx512 )
+    : _impls{ scalar, sse41, avx2, avx512 }
+{
+}
+
+// ACCESSOR FUNCTIONS
+template <typename F>
+F Dispatch<F>::get() const
+{
+    return _impls[tier()];
+}
+
+template <typename F>
+CpuFeatures::Tier Dispatch<F>::tier() const
+{
+    int32 tier = CpuFeatures::tier();
+    while ( tier > CpuFeatures::TIER_SCALAR && _impls[tier] == nullptr )
+    {
+        --tier;
+    }
+
+    assert( _impls[tier] != nullptr );
+    return static_cast<CpuFeatures::Tier>( tier );
+}
+
+template <typename F>
+F Dispatch<F>::at( CpuFeatures::Tier tier ) const
+{
+    return _impls[tier];
+}
+
+} // End nspc util
+
+} // End nspc demo
+
+#endif // DEMO_DISPATCH_H
@@ -0,0 +1,115 @@
+// frame_scheduler.cpp
+#include "demo/utility/frame_scheduler.h"
+
+#include <thread>
+
+namespace demo
+{
+
+namespace util
+{
+
+// CONSTANTS
+constexpr float FrameScheduler::DEFAULT_STEP_RATE;
+constexpr float FrameScheduler::DEFAULT_FRAME_CAP;
+constexpr float FrameScheduler::BACKGROUND_FRAME_CAP;
+constexpr float FrameScheduler::MINIMIZED_FRAME_CAP;
+constexpr float FrameScheduler::MAX_FRAME_TIME;
+constexpr int64 FrameScheduler::MIN_SPIN_NS;
+
+// MEMBER FUNCTIONS
+void FrameScheduler::beginFrame()
+{
+    _frameStart = Clock::SysClock::now();
+    _clock->tick();
+
+    // the fixed step only moves forward so paused or reversed time does not
+    // advance the simulation
+    float dt = _clock->dt();
+    if ( dt > MAX_FRAME_TIME )
+    {
+        dt = MAX_FRAME_TIME;
+    }
+    else if ( dt < 0.0f )
+    {
+        dt = 0.0f;
+    }
+
+    _accumulator += dt;
+    _stepCount = 0;
+}
+
+void FrameScheduler::endFrame()
+{
+    int64 interval = frameInterval();
+    if ( interval == 0 )
+    {
+        return;
+    }
+
+    waitUntil( _frameStart + std::chrono::nanoseconds( interval ) );
+}
+
+void FrameScheduler::reset()
+{
+    _clock->reset();
+    _frameStart = Clock::SysClock::now();
+    _accumulator = 0.0f;
+    _stepCount = 0;
+}
+
+// HELPER FUNCTIONS
+int64 FrameScheduler::frameInterval() const
+{
+    float cap = _frameCap;
+    if ( _activity == BACKGROUND )
+    {
+        cap = cap > 0.0f && cap < BACKGROUND_FRAME_CAP ?
+              cap : BACKGROUND_FRAME_CAP;
+    }
+    else if ( _activity == MINIMIZED )
+    {
+        cap = MINIMIZED_FRAME_CAP;
+    }
+
+    return cap > 0.0f ? static_cast<int64>( 1.0e9f / cap ) : 0;
+}
+
+void FrameScheduler::waitUntil( Clock::SysClock::time_point deadline )
+{
+    using namespace std::chrono;
+
+    // sleep until just before the deadline
+    Clock::SysClock::time_point now = Clock::SysClock::now();
+    int64 remaining = duration_cast<nanoseconds>( deadline - now ).count();
+    int64 sleepTime = remaining - _sleepSlack;
+
+    if ( sleepTime > 0 )
+    {
+        std::this_thread::sleep_for( nanoseconds( sleepTime ) );
+
+        Clock::SysClock::time_point woke = Clock::SysClock::now();
+        int64 overshoot = duration_cast<nanoseconds>( woke - now ).count() -
+                          sleepTime;
+
+        // react to oversleeping at once but relax the slack slowly
+        if ( overshoot + MIN_SPIN_NS > _sleepSlack )
+        {
+            _sleepSlack = overshoot + MIN_SPIN_NS;
+        }
+        else
+        {
+            _sleepSlack -= ( _sleepSlack - overshoot - MIN_SPIN_NS ) / 16;
+        }
+    }
+
+    // spin the rest
+    while ( Clock::SysClock::now() < deadline )
+    {
+        std::this_thread::yield();
+    }
+}
+
+} // End nspc util
+
+} // End nspc demo
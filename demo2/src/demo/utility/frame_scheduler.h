@@ -0,0 +1,301 @@
+// frame_scheduler.h
+//
+// Paces the main loop and drives a fixed timestep simulation.
+//
+// Each frame the scheduler ticks its clock and adds the elapsed game time to
+// an accumulator. The simulation is then stepped at a fixed rate until the
+// accumulator is drained and the remainder is exposed as an interpolation
+// factor so rendering can blend between the last two simulation states.
+//
+// At the end of a frame the scheduler waits for the frame deadline given by
+// the frame cap. It sleeps for most of the wait and spins for the rest, which
+// keeps the deadline within 100us without burning a core. How early to stop
+// sleeping is learned from how much the operating system oversleeps.
+//
+// When the window is in the background or minimized the frame cap is lowered
+// so the demo does not waste power on frames that are not seen.
+//
+#ifndef DEMO_FRAME_SCHEDULER_H
+#define DEMO_FRAME_SCHEDULER_H
+
+#include "demo/intdef.h"
+#include "demo/utility/clock.h"
+
+namespace demo
+{
+
+namespace util
+{
+
+class FrameScheduler
+{
+  public:
+    // TYPES
+    /**
+     * How visible the application is.
+     */
+    enum Activity
+    {
+        FOREGROUND,
+        BACKGROUND,
+        MINIMIZED
+    };
+
+    // CONSTANTS
+    /**
+     * The default simulation rate in steps per second.
+     */
+    static constexpr float DEFAULT_STEP_RATE = 60.0f;
+
+    /**
+     * The default frame cap in frames per second.
+     */
+    static constexpr float DEFAULT_FRAME_CAP = 120.0f;
+
+    /**
+     * The frame cap while in the background.
+     */
+    static constexpr float BACKGROUND_FRAME_CAP = 15.0f;
+
+    /**
+     * The frame cap while minimized.
+     */
+    static constexpr float MINIMIZED_FRAME_CAP = 4.0f;
+
+    /**
+     * The most game time a single frame may advance the simulation by.
+     * Anything beyond this is dropped so a stall does not cause a burst of
+     * steps that stalls the next frame.
+     */
+    static constexpr float MAX_FRAME_TIME = 0.25f;
+
+  private:
+    // CONSTANTS
+    /**
+     * The smallest amount of the wait that is spun instead of slept.
+     */
+    static constexpr int64 MIN_SPIN_NS = 100000;
+
+    // MEMBERS
+    /**
+     * The clock that is ticked once per frame.
+     */
+    Clock* _clock;
+
+    /**
+     * The start of the current frame.
+     */
+    Clock::SysClock::time_point _frameStart;
+
+    /**
+     * The game time that has not been simulated yet.
+     */
+    float _accumulator;
+
+    /**
+     * The simulation timestep in seconds.
+     */
+    float _step;
+
+    /**
+     * The foreground frame cap or zero for none.
+     */
+    float _frameCap;
+
+    /**
+     * The current activity.
+     */
+    Activity _activity;
+
+    /**
+     * How long before the deadline to stop sleeping in nanoseconds.
+     */
+    int64 _sleepSlack;
+
+    /**
+     * The number of simulation steps taken this frame.
+     */
+    uint32 _stepCount;
+
+    // HELPER FUNCTIONS
+    /**
+     * Get the time a frame should take under the current activity.
+     * @return The frame interval in nanoseconds or zero for none.
+     */
+    int64 frameInterval() const;
+
+    /**
+     * Block until the given time.
+     * @param deadline The time to wait for.
+     */
+    void waitUntil( Clock::SysClock::time_point deadline );
+
+    // HIDDEN FUNCTIONS
+    FrameScheduler( const FrameScheduler& other ) = delete;
+
+    FrameScheduler& operator=( const FrameScheduler& other ) = delete;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct a scheduler that drives the given clock.
+     * @param clock The clock.
+     */
+    explicit FrameScheduler( Clock* clock );
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the simulation timestep.
+     * @return The timestep in seconds.
+     */
+    float step() const;
+
+    /**
+     * Get the foreground frame cap.
+     * @return The frame cap in frames per second or zero for none.
+     */
+    float frameCap() const;
+
+    /**
+     * Get the current activity.
+     * @return The activity.
+     */
+    Activity activity() const;
+
+    /**
+     * Get the fraction of a step between the last simulated state and the
+     * current time, for interpolating rendered state.
+     * @return The interpolation factor between 0 and 1.
+     */
+    float alpha() const;
+
+    /**
+     * Get the number of simulation steps taken this frame.
+     * @return The step count.
+     */
+    uint32 stepCount() const;
+
+    // MUTATOR FUNCTIONS
+    /**
+     * Set the simulation rate.
+     * @param stepsPerSecond The number of steps per second.
+     */
+    void setStepRate( float stepsPerSecond );
+
+    /**
+     * Set the foreground frame cap.
+     * @param framesPerSecond The frame cap or zero to run uncapped.
+     */
+    void setFrameCap( float framesPerSecond );
+
+    /**
+     * Set the activity, which lowers the frame cap when not in the
+     * foreground.
+     * @param activity The activity.
+     */
+    void setActivity( Activity activity );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Start a frame by ticking the clock and accumulating game time.
+     */
+    void beginFrame();
+
+    /**
+     * Take a simulation step if enough game time has accumulated.
+     * This is meant to be called in a loop until it returns false.
+     * @return True if the simulation should advance by one step.
+     */
+    bool advance();
+
+    /**
+     * End a frame by waiting for the frame deadline.
+     */
+    void endFrame();
+
+    /**
+     * Restart pacing from now and drop any accumulated time.
+     */
+    void reset();
+};
+
+// CONSTRUCTORS
+inline
+FrameScheduler::FrameScheduler( Clock* clock )
+        : _clock( clock ), _frameStart( Clock::SysClock::now() ),
+          _accumulator( 0.0f ), _step( 1.0f / DEFAULT_STEP_RATE ),
+          _frameCap( DEFAULT_FRAME_CAP ), _activity( FOREGROUND ),
+          _sleepSlack( 1000000 ), _stepCount( 0 )
+{
+}
+
+// ACCESSOR FUNCTIONS
+inline
+float FrameScheduler::step() const
+{
+    return _step;
+}
+
+inline
+float FrameScheduler::frameCap() const
+{
+    return _frameCap;
+}
+
+inline
+FrameScheduler::Activity FrameScheduler::activity() const
+{
+    return _activity;
+}
+
+inline
+float FrameScheduler::alpha() const
+{
+    return _accumulator / _step;
+}
+
+inline
+uint32 FrameScheduler::stepCount() const
+{
+    return _stepCount;
+}
+
+// MUTATOR FUNCTIONS
+inline
+void FrameScheduler::setStepRate( float stepsPerSecond )
+{
+    _step = 1.0f / stepsPerSecond;
+}
+
+inline
+void FrameScheduler::setFrameCap( float framesPerSecond )
+{
+    _frameCap = framesPerSecond;
+}
+
+inline
+void FrameScheduler::setActivity( Activity activity )
+{
+    _activity = activity;
+}
+
+// MEMBER FUNCTIONS
+inline
+bool FrameScheduler::advance()
+{
+    if ( _accumulator < _step )
+    {
+        return false;
+    }
+
+    _accumulator -= _step;
+    ++_stepCount;
+
+    return true;
+}
+
+} // End nspc util
+
+} // End nspc demo
+
+#endif // DEMO_FRAME_SCHEDULER_H
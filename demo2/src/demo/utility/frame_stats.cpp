@@ -0,0 +1,171 @@
+// frame_stats.cpp
+#include "demo/utility/frame_stats.h"
+
+#include <algorithm>
+#include <signal.h>
+
+namespace demo
+{
+
+namespace util
+{
+
+// CONSTANTS
+constexpr uint32 FrameStats::WINDOW_SIZE;
+constexpr float FrameStats::DEFAULT_BUDGET;
+
+// GLOBALS
+volatile sig_atomic_t FrameStats::g_dumpRequested = 0;
+
+// GLOBAL FUNCTIONS
+void FrameStats::installSignalHandler()
+{
+    #ifdef SIGUSR1
+    signal( SIGUSR1, &FrameStats::handleSignal );
+    #endif
+}
+
+// CONSTRUCTORS
+FrameStats::FrameStats()
+{
+    setBudget( DEFAULT_BUDGET );
+    reset();
+}
+
+// MEMBER FUNCTIONS
+void FrameStats::recordFrame( float seconds )
+{
+    uint64 frameTime = static_cast<uint64>(
+        static_cast<double>( seconds ) * 1.0e9 );
+    _current[FRAME] = frameTime;
+
+    uint32 slot = static_cast<uint32>( _frameCount % WINDOW_SIZE );
+    for ( uint32 i = 0; i < PHASE_COUNT; ++i )
+    {
+        _histograms[i].record( _current[i] );
+        _window[i][slot] = _current[i];
+        _current[i] = 0;
+    }
+
+    if ( frameTime > _budget )
+    {
+        ++_hitchCount;
+    }
+
+    ++_frameCount;
+
+    if ( g_dumpRequested != 0 )
+    {
+        g_dumpRequested = 0;
+        dump( stderr );
+    }
+}
+
+FrameStats::Summary FrameStats::rolling( Phase phase ) const
+{
+    return summarizeWindow( phase );
+}
+
+FrameStats::Summary FrameStats::total( Phase phase ) const
+{
+    const Histogram& histogram = _histograms[phase];
+
+    Summary summary;
+    summary.count = histogram.count();
+    summary.min = toSeconds( histogram.min() );
+    summary.avg = static_cast<float>( histogram.mean() * 1.0e-9 );
+    summary.p50 = toSeconds( histogram.percentile( 50.0 ) );
+    summary.p95 = toSeconds( histogram.percentile( 95.0 ) );
+    summary.p99 = toSeconds( histogram.percentile( 99.0 ) );
+    summary.max = toSeconds( histogram.max() );
+
+    return summary;
+}
+
+bool FrameStats::isWithinBudget( double percentile ) const
+{
+    return _histograms[FRAME].percentile( percentile ) <= _budget;
+}
+
+void FrameStats::dump( FILE* file ) const
+{
+    static const char* const PHASE_NAMES[PHASE_COUNT] = {
+        "frame", "update", "pretick", "tick", "posttick", "render", "swap" };
+
+    fprintf( file, "Frame stats over %llu frame(s), %llu hitch(es) over "
+             "%.2f ms:\n", static_cast<unsigned long long>( _frameCount ),
+             static_cast<unsigned long long>( _hitchCount ),
+             budget() * 1000.0f );
+    fprintf( file, "  %-8s %-7s %8s %8s %8s %8s %8s %8s\n", "phase", "range",
+             "min", "avg", "p50", "p95", "p99", "max" );
+
+    for ( uint32 i = 0; i < PHASE_COUNT; ++i )
+    {
+        Summary summaries[2] = { rolling( static_cast<Phase>( i ) ),
+                                 total( static_cast<Phase>( i ) ) };
+        const char* ranges[2] = { "rolling", "total" };
+
+        for ( uint32 j = 0; j < 2; ++j )
+        {
+            const Summary& summary = summaries[j];
+            fprintf( file, "  %-8s %-7s %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f\n",
+                     PHASE_NAMES[i], ranges[j], summary.min * 1000.0f,
+                     summary.avg * 1000.0f, summary.p50 * 1000.0f,
+                     summary.p95 * 1000.0f, summary.p99 * 1000.0f,
+                     summary.max * 1000.0f );
+        }
+    }
+}
+
+void FrameStats::reset()
+{
+    for ( uint32 i = 0; i < PHASE_COUNT; ++i )
+    {
+        _histograms[i].reset();
+        _current[i] = 0;
+    }
+
+    _frameCount = 0;
+    _hitchCount = 0;
+}
+
+// HELPER FUNCTIONS
+FrameStats::Summary FrameStats::summarizeWindow( Phase phase ) const
+{
+    uint32 count = static_cast<uint32>(
+        _frameCount < WINDOW_SIZE ? _frameCount : WINDOW_SIZE );
+
+    Summary summary = { count, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    if ( count == 0 )
+    {
+        return summary;
+    }
+
+    // sort a copy, the window is small enough to live on the stack
+    uint64 sorted[WINDOW_SIZE];
+    uint64 sum = 0;
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        sorted[i] = _window[phase][i];
+        sum += sorted[i];
+    }
+    std::sort( sorted, sorted + count );
+
+    summary.min = toSeconds( sorted[0] );
+    summary.avg = toSeconds( sum / count );
+    summary.p50 = toSeconds( sorted[( count - 1 ) * 50 / 100] );
+    summary.p95 = toSeconds( sorted[( count - 1 ) * 95 / 100] );
+    summary.p99 = toSeconds( sorted[( count - 1 ) * 99 / 100] );
+    summary.max = toSeconds( sorted[count - 1] );
+
+    return summary;
+}
+
+void FrameStats::handleSignal( int /* signal */ )
+{
+    g_dumpRequested = 1;
+}
+
+} // End nspc util
+
+} // End nspc demo
@@ -0,0 +1,343 @@
+// frame_stats.h
+//
+// Collects frame time telemetry.
+//
+// The time of every frame and of each phase within it is recorded into a
+// histogram that covers the whole run and into a rolling window of the most
+// recent frames. Summaries report the minimum, average, 50th, 95th and 99th
+// percentile and maximum. Frames that exceed the frame budget are counted as
+// hitches. The tick phases are recorded by the scene as part of the update, so
+// they overlap it rather than add to it.
+//
+// Recording a frame never allocates so it is safe to use in the main loop.
+//
+// On POSIX systems a summary can be requested while running by sending
+// SIGUSR1 once the signal handler is installed. The summary is written at the
+// end of the next frame.
+//
+#ifndef DEMO_FRAME_STATS_H
+#define DEMO_FRAME_STATS_H
+
+#include <signal.h>
+#include <stdio.h>
+
+#include "demo/intdef.h"
+#include "demo/utility/clock.h"
+#include "demo/utility/histogram.h"
+
+namespace demo
+{
+
+namespace util
+{
+
+class FrameStats
+{
+  public:
+    // TYPES
+    /**
+     * The timed parts of a frame.
+     */
+    enum Phase
+    {
+        FRAME,
+        UPDATE,
+        PRE_TICK,
+        TICK,
+        POST_TICK,
+        RENDER,
+        SWAP,
+        PHASE_COUNT
+    };
+
+    /**
+     * Summarizes the times of a phase in seconds.
+     */
+    struct Summary
+    {
+        uint64 count;
+        float min;
+        float avg;
+        float p50;
+        float p95;
+        float p99;
+        float max;
+    };
+
+    // CONSTANTS
+    /**
+     * The number of frames in the rolling window.
+     */
+    static constexpr uint32 WINDOW_SIZE = 300;
+
+    /**
+     * The default frame budget in seconds.
+     */
+    static constexpr float DEFAULT_BUDGET = 1.0f / 60.0f;
+
+  private:
+    // GLOBALS
+    /**
+     * Set by the signal handler when a summary was requested.
+     */
+    static volatile sig_atomic_t g_dumpRequested;
+
+    // MEMBERS
+    /**
+     * The times of every phase over the whole run in nanoseconds.
+     */
+    Histogram _histograms[PHASE_COUNT];
+
+    /**
+     * The times of every phase over the rolling window in nanoseconds.
+     */
+    uint64 _window[PHASE_COUNT][WINDOW_SIZE];
+
+    /**
+     * The times of the phases of the current frame in nanoseconds.
+     */
+    uint64 _current[PHASE_COUNT];
+
+    /**
+     * The number of recorded frames.
+     */
+    uint64 _frameCount;
+
+    /**
+     * The number of frames that exceeded the budget.
+     */
+    uint64 _hitchCount;
+
+    /**
+     * The frame budget in nanoseconds.
+     */
+    uint64 _budget;
+
+    // HELPER FUNCTIONS
+    /**
+     * Summarize the rolling window of a phase.
+     * @param phase The phase.
+     * @return The summary.
+     */
+    Summary summarizeWindow( Phase phase ) const;
+
+    /**
+     * Convert nanoseconds to seconds.
+     * @param nanoseconds The nanoseconds.
+     * @return The seconds.
+     */
+    static float toSeconds( uint64 nanoseconds );
+
+    /**
+     * Record a summary request from the signal handler.
+     * @param signal The signal.
+     */
+    static void handleSignal( int /* signal */ );
+
+  public:
+    // GLOBAL FUNCTIONS
+    /**
+     * Install the SIGUSR1 handler that requests a summary.
+     * This does nothing on platforms without SIGUSR1.
+     */
+    static void installSignalHandler();
+
+    // CONSTRUCTORS
+    /**
+     * Construct a new FrameStats with the default budget.
+     */
+    FrameStats();
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the frame budget.
+     * @return The budget in seconds.
+     */
+    float budget() const;
+
+    /**
+     * Get the number of recorded frames.
+     * @return The frame count.
+     */
+    uint64 frameCount() const;
+
+    /**
+     * Get the number of frames that exceeded the budget.
+     * @return The hitch count.
+     */
+    uint64 hitchCount() const;
+
+    /**
+     * Get the histogram of a phase over the whole run.
+     * Samples are in nanoseconds.
+     * @param phase The phase.
+     * @return The histogram.
+     */
+    const Histogram& histogram( Phase phase ) const;
+
+    // MUTATOR FUNCTIONS
+    /**
+     * Set the frame budget.
+     * @param seconds The budget in seconds.
+     */
+    void setBudget( float seconds );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Record the time spent in a phase of the current frame.
+     * Times recorded for the same phase within a frame are added.
+     * @param phase The phase.
+     * @param nanoseconds The time in nanoseconds.
+     */
+    void recordPhase( Phase phase, uint64 nanoseconds );
+
+    /**
+     * Record the time of the frame and close it.
+     * @param seconds The frame time in seconds.
+     */
+    void recordFrame( float seconds );
+
+    /**
+     * Summarize a phase over the rolling window.
+     * @param phase The phase.
+     * @return The summary.
+     */
+    Summary rolling( Phase phase ) const;
+
+    /**
+     * Summarize a phase over the whole run.
+     * @param phase The phase.
+     * @return The summary.
+     */
+    Summary total( Phase phase ) const;
+
+    /**
+     * Check if a percentile of the frame times over the whole run is within
+     * the budget.
+     * @param percentile The percentile between 0 and 100.
+     * @return True if within budget.
+     */
+    bool isWithinBudget( double percentile ) const;
+
+    /**
+     * Write a summary of every phase.
+     * @param file The output file.
+     */
+    void dump( FILE* file ) const;
+
+    /**
+     * Remove every recorded frame.
+     */
+    void reset();
+};
+
+class PhaseTimer
+{
+  private:
+    // MEMBERS
+    /**
+     * The stats to record into or null.
+     */
+    FrameStats* _stats;
+
+    /**
+     * The timed phase.
+     */
+    FrameStats::Phase _phase;
+
+    /**
+     * The time the phase started.
+     */
+    Clock::SysClock::time_point _start;
+
+    // HIDDEN FUNCTIONS
+    PhaseTimer( const PhaseTimer& other ) = delete;
+
+    PhaseTimer& operator=( const PhaseTimer& other ) = delete;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct a timer that starts timing a phase.
+     * @param stats The stats to record into or null.
+     * @param phase The phase.
+     */
+    PhaseTimer( FrameStats* stats, FrameStats::Phase phase );
+
+    /**
+     * Destruct the timer and record the phase.
+     */
+    ~PhaseTimer();
+};
+
+// ACCESSOR FUNCTIONS
+inline
+float FrameStats::budget() const
+{
+    return toSeconds( _budget );
+}
+
+inline
+uint64 FrameStats::frameCount() const
+{
+    return _frameCount;
+}
+
+inline
+uint64 FrameStats::hitchCount() const
+{
+    return _hitchCount;
+}
+
+inline
+const Histogram& FrameStats::histogram( Phase phase ) const
+{
+    return _histograms[phase];
+}
+
+// MUTATOR FUNCTIONS
+inline
+void FrameStats::setBudget( float seconds )
+{
+    _budget = static_cast<uint64>( seconds * 1.0e9f );
+}
+
+// MEMBER FUNCTIONS
+inline
+void FrameStats::recordPhase( Phase phase, uint64 nanoseconds )
+{
+    _current[phase] += nanoseconds;
+}
+
+// HELPER FUNCTIONS
+inline
+float FrameStats::toSeconds( uint64 nanoseconds )
+{
+    return static_cast<float>( static_cast<double>( nanoseconds ) * 1.0e-9 );
+}
+
+// PHASE TIMER CONSTRUCTORS
+inline
+PhaseTimer::PhaseTimer( FrameStats* stats, FrameStats::Phase phase )
+    : _stats( stats ), _phase( phase ), _start( Clock::SysClock::now() )
+{
+}
+
+inline
+PhaseTimer::~PhaseTimer()
+{
+    using namespace std::chrono;
+
+    if ( _stats != nullptr )
+    {
+        _stats->recordPhase( _phase, static_cast<uint64>(
+            duration_cast<nanoseconds>( Clock::SysClock::now() -
+                                        _start ).count() ) );
+    }
+}
+
+} // End nspc util
+
+} // End nspc demo
+
+#endif // DEMO_FRAME_STATS_H
@@ -1,12 +1,89 @@
 // hash_utils.cpp
 #include "demo/utility/hash_utils.h"
 
+#include <string.h>
+
 namespace demo
 {
 
 namespace util
 {
 
+// CONSTANTS
+constexpr uint64 HashUtils::WY_SECRET[4];
+
+// HELPER FUNCTIONS
+/**
+ * Multiplies two 64-bit values into a 128-bit product split across both.
+ */
+inline
+static void multiply128( uint64* low, uint64* high )
+{
+    #ifdef __SIZEOF_INT128__
+    __uint128_t product = static_cast<__uint128_t>( *low ) * *high;
+    *low = static_cast<uint64>( product );
+    *high = static_cast<uint64>( product >> 64 );
+    #else
+    uint64 ha = *low >> 32;
+    uint64 hb = *high >> 32;
+    uint64 la = static_cast<uint32>( *low );
+    uint64 lb = static_cast<uint32>( *high );
+    uint64 rh = ha * hb;
+    uint64 rm0 = ha * lb;
+    uint64 rm1 = hb * la;
+    uint64 rl = la * lb;
+    uint64 t = rl + ( rm0 << 32 );
+    uint64 c = t < rl;
+    uint64 lo = t + ( rm1 << 32 );
+    c += lo < t;
+    *low = lo;
+    *high = rh + ( rm0 >> 32 ) + ( rm1 >> 32 ) + c;
+    #endif
+}
+
+/**
+ * Multiplies two 64-bit values and folds the 128-bit product.
+ */
+inline
+static uint64 multiplyMix( uint64 a, uint64 b )
+{
+    multiply128( &a, &b );
+    return a ^ b;
+}
+
+/**
+ * Reads 8 unaligned bytes.
+ */
+inline
+static uint64 read64( const uint8* data )
+{
+    uint64 value;
+    memcpy( &value, data, sizeof( value ) );
+    return value;
+}
+
+/**
+ * Reads 4 unaligned bytes.
+ */
+inline
+static uint64 read32( const uint8* data )
+{
+    uint32 value;
+    memcpy( &value, data, sizeof( value ) );
+    return value;
+}
+
+/**
+ * Reads 1 to 3 bytes.
+ */
+inline
+static uint64 readSmall( const uint8* data, Size length )
+{
+    return ( static_cast<uint64>( data[0] ) << 16 ) |
+           ( static_cast<uint64>( data[length >> 1] ) << 8 ) |
+           data[length - 1];
+}
+
 uint32 HashUtils::fnv1a( const String& value )
 {
     uint32 hashCode = FNV_OFFSET_32;
@@ -21,6 +98,78 @@ uint32 HashUtils::fnv1a( const String& value )
     return hashCode;
 }
 
+uint64 HashUtils::hash64( const void* data, Size length, uint64 seed )
+{
+    const uint8* bytes = static_cast<const uint8*>( data );
+    const uint64* secret = WY_SECRET;
+    uint64 a;
+    uint64 b;
+
+    seed ^= multiplyMix( seed ^ secret[0], secret[1] );
+
+    if ( length <= 16 )
+    {
+        if ( length >= 4 )
+        {
+            Size shift = ( length >> 3 ) << 2;
+            a = ( read32( bytes ) << 32 ) | read32( bytes + shift );
+            b = ( read32( bytes + length - 4 ) << 32 ) |
+                read32( bytes + length - 4 - shift );
+        }
+        else if ( length > 0 )
+        {
+            a = readSmall( bytes, length );
+            b = 0;
+        }
+        else
+        {
+            a = 0;
+            b = 0;
+        }
+    }
+    else
+    {
+        Size remaining = length;
+        if ( remaining > 48 )
+        {
+            // three independent lanes keep the multipliers busy
+            uint64 lane1 = seed;
+            uint64 lane2 = seed;
+            do
+            {
+                seed = multiplyMix( read64( bytes ) ^ secret[1],
+                                    read64( bytes + 8 ) ^ seed );
+                lane1 = multiplyMix( read64( bytes + 16 ) ^ secret[2],
+                                     read64( bytes + 24 ) ^ lane1 );
+                lane2 = multiplyMix( read64( bytes + 32 ) ^ secret[3],
+                                     read64( bytes + 40 ) ^ lane2 );
+                bytes += 48;
+                remaining -= 48;
+            } while ( remaining > 48 );
+
+            seed ^= lane1 ^ lane2;
+        }
+
+        while ( remaining > 16 )
+        {
+            seed = multiplyMix( read64( bytes ) ^ secret[1],
+                                read64( bytes + 8 ) ^ seed );
+            bytes += 16;
+            remaining -= 16;
+        }
+
+        // the last 16 bytes overlap what was already consumed
+        a = read64( bytes + remaining - 16 );
+        b = read64( bytes + remaining - 8 );
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    multiply128( &a, &b );
+
+    return multiplyMix( a ^ secret[0] ^ length, b ^ secret[1] );
+}
+
 } // End nspc util
 
 } // End nspc demo
\ No newline at end of file
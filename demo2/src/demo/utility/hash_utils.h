@@ -16,7 +16,7 @@
  * however, only the fnv-1a hashing function is utilized.
  */
 #define chash( string ) \
-nge::util::HashUtils::compileTimeHash<sizeof( string ) - 1>( string )
+demo::util::HashUtils::compileTimeHash<sizeof( string ) - 1>( string )
 
 namespace demo
 {
@@ -50,11 +50,66 @@ struct HashUtils
      */
     static constexpr uint64 FNV_PRIME_64 = 1099511628211ULL;
 
+    /**
+     * Defines the secrets used by the 64-bit byte hash.
+     * From: https://github.com/wangyi-fudan/wyhash
+     */
+    static constexpr uint64 WY_SECRET[4] = {
+        0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+        0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL };
+
     /**
      * Computes the fnv1a hash of a string value.
      */
     static uint32 fnv1a( const String& value );
 
+    /**
+     * Computes the 64-bit hash of a span of bytes.
+     *
+     * This is based on wyhash. Inputs longer than 48 bytes are consumed in
+     * three independent lanes so that the multiplies overlap.
+     */
+    static uint64 hash64( const void* data, Size length, uint64 seed = 0 );
+
+    /**
+     * Computes the 64-bit hash of a string value.
+     */
+    static uint64 hash64( const String& value );
+
+    /**
+     * Mixes the bits of a 64-bit value so that every input bit affects every
+     * output bit.
+     *
+     * This is the MurmurHash3 finalizer.
+     */
+    static uint64 mix64( uint64 value );
+
+    /**
+     * Mixes the bits of a 32-bit value so that every input bit affects every
+     * output bit.
+     *
+     * This is the MurmurHash3 finalizer.
+     */
+    static uint32 mix32( uint32 value );
+
+    /**
+     * Folds a 64-bit hash code into 32 bits.
+     */
+    static uint32 fold( uint64 hashCode );
+
+    /**
+     * Computes the 64-bit fnv1a hash of a null terminated string.
+     *
+     * This can be evaluated at compile time.
+     */
+    static constexpr uint64 compileTimeHash64(
+        const char* value, uint64 hashCode = FNV_OFFSET_64 );
+
+    /**
+     * Computes the 64-bit fnv1a hash of a span of characters.
+     */
+    static uint64 fnv1a64( const char* value, Size length );
+
     /**
      * Compiles the fnv hash code at compile time.
      */
@@ -62,6 +117,67 @@ struct HashUtils
     static constexpr uint32 compileTimeHash( const char* value );
 };
 
+inline
+uint64 HashUtils::hash64( const String& value )
+{
+    return hash64( value.data(), value.length() );
+}
+
+inline
+constexpr uint64 HashUtils::compileTimeHash64( const char* value,
+                                               uint64 hashCode )
+{
+    return *value == '\0' ? hashCode :
+        compileTimeHash64( value + 1,
+                           ( hashCode ^ static_cast<uint8>( *value ) ) *
+                           FNV_PRIME_64 );
+}
+
+inline
+uint64 HashUtils::fnv1a64( const char* value, Size length )
+{
+    uint64 hashCode = FNV_OFFSET_64;
+    Size i;
+
+    for ( i = 0; i < length; ++i )
+    {
+        hashCode ^= static_cast<uint8>( value[i] );
+        hashCode *= FNV_PRIME_64;
+    }
+
+    return hashCode;
+}
+
+inline
+uint64 HashUtils::mix64( uint64 value )
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+
+    return value;
+}
+
+inline
+uint32 HashUtils::mix32( uint32 value )
+{
+    value ^= value >> 16;
+    value *= 0x85ebca6bU;
+    value ^= value >> 13;
+    value *= 0xc2b2ae35U;
+    value ^= value >> 16;
+
+    return value;
+}
+
+inline
+uint32 HashUtils::fold( uint64 hashCode )
+{
+    return static_cast<uint32>( hashCode ^ ( hashCode >> 32 ) );
+}
+
 template <>
 inline
 constexpr uint32 HashUtils::compileTimeHash<uint32( 0 )>( const char* value )
@@ -3,9 +3,24 @@
 // Defines default hash function implementations. To add new default hash
 // implementations specialize hasher.
 //
+// Integers, enums and pointers are hashed by mixing their bits. Any other
+// trivially copyable type is hashed by its bytes, so types with padding must
+// either zero it or specialize hasher. Floating point values and the glm
+// vector and quaternion types treat negative zero as zero so that values that
+// compare equal hash equally.
+//
+// Every hasher provides a 32-bit hash for the containers and a 64-bit hash
+// for tables that need more bits.
+//
 #ifndef DEMO_HASHER_H
 #define DEMO_HASHER_H
 
+#include <string.h>
+#include <type_traits>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
 #include "demo/intdef.h"
 #include "demo/strdef.h"
 #include "demo/utility/hash_utils.h"
@@ -19,93 +34,134 @@ namespace util
 template <typename T>
 struct Hasher
 {
+  private:
+    // HELPER FUNCTIONS
+    /**
+     * Computes the 64-bit hash for a scalar that fits into 64 bits.
+     */
+    static uint64 hashDefault( const T& value, std::true_type isScalar );
+
+    /**
+     * Computes the 64-bit hash for any other trivially copyable value.
+     */
+    static uint64 hashDefault( const T& value, std::false_type isScalar );
+
+  public:
     /**
      * Computes the hash for a give value.
      */
     static uint32 hash( const T& value );
+
+    /**
+     * Computes the 64-bit hash for a given value.
+     */
+    static uint64 hash64( const T& value );
 };
 
+// UTILITY FUNCTIONS
 template <typename T>
 inline
 uint32 Hasher<T>::hash( const T& value )
 {
-    return 0;
+    return HashUtils::fold( hash64( value ) );
 }
 
-template <>
+template <typename T>
 inline
-uint32 Hasher<String>::hash( const String& value )
+uint64 Hasher<T>::hash64( const T& value )
 {
-    return HashUtils::fnv1a( value );
+    return hashDefault(
+        value, std::integral_constant<bool, std::is_scalar<T>::value &&
+                                            sizeof( T ) <= sizeof( uint64 )>() );
 }
 
-template <>
+// HELPER FUNCTIONS
+template <typename T>
+inline
+uint64 Hasher<T>::hashDefault( const T& value, std::true_type isScalar )
+{
+    uint64 bits = 0;
+    memcpy( &bits, &value, sizeof( T ) );
+
+    return HashUtils::mix64( bits );
+}
+
+template <typename T>
 inline
-uint32 Hasher<uint8>::hash( const uint8& value )
+uint64 Hasher<T>::hashDefault( const T& value, std::false_type isScalar )
 {
-    return ( HashUtils::FNV_OFFSET_32 ^ static_cast<uint32>( value ) ) *
-           HashUtils::FNV_PRIME_32;
+    static_assert( std::is_trivially_copyable<T>::value,
+                   "Hasher must be specialized for this type" );
+
+    return HashUtils::hash64( &value, sizeof( T ) );
 }
 
+// SPECIALIZATIONS
 template <>
 inline
-uint32 Hasher<int8>::hash( const int8& value )
+uint64 Hasher<String>::hash64( const String& value )
 {
-    return ( HashUtils::FNV_OFFSET_32 ^ static_cast<uint32>( value ) ) *
-           HashUtils::FNV_PRIME_32;
+    return HashUtils::hash64( value );
 }
 
 template <>
 inline
-uint32 Hasher<uint16>::hash( const uint16& value )
+uint64 Hasher<float>::hash64( const float& value )
 {
-    return ( HashUtils::FNV_OFFSET_32 ^ static_cast<uint32>( value ) ) *
-           HashUtils::FNV_PRIME_32;
+    float normalized = value + 0.0f;
+    uint32 bits;
+    memcpy( &bits, &normalized, sizeof( bits ) );
+
+    return HashUtils::mix64( bits );
 }
 
 template <>
 inline
-uint32 Hasher<int16>::hash( const int16& value )
+uint64 Hasher<double>::hash64( const double& value )
 {
-    return ( HashUtils::FNV_OFFSET_32 ^ static_cast<uint32>( value ) ) *
-           HashUtils::FNV_PRIME_32;
+    double normalized = value + 0.0;
+    uint64 bits;
+    memcpy( &bits, &normalized, sizeof( bits ) );
+
+    return HashUtils::mix64( bits );
 }
 
 template <>
 inline
-uint32 Hasher<uint32>::hash( const uint32& value )
+uint64 Hasher<glm::vec2>::hash64( const glm::vec2& value )
 {
-    return ( HashUtils::FNV_OFFSET_32 ^ value ) * HashUtils::FNV_PRIME_32;
+    float normalized[2] = { value.x + 0.0f, value.y + 0.0f };
+
+    return HashUtils::hash64( normalized, sizeof( normalized ) );
 }
 
 template <>
 inline
-uint32 Hasher<int32>::hash( const int32& value )
+uint64 Hasher<glm::vec3>::hash64( const glm::vec3& value )
 {
-    return ( HashUtils::FNV_OFFSET_32 ^ static_cast<uint32>( value ) ) *
-        HashUtils::FNV_PRIME_32;
+    float normalized[3] = { value.x + 0.0f, value.y + 0.0f, value.z + 0.0f };
+
+    return HashUtils::hash64( normalized, sizeof( normalized ) );
 }
 
 template <>
 inline
-uint32 Hasher<uint64>::hash( const uint64& value )
+uint64 Hasher<glm::vec4>::hash64( const glm::vec4& value )
 {
-    uint64 hashCode = ( HashUtils::FNV_OFFSET_64 ^ value ) *
-        HashUtils::FNV_PRIME_64;
+    float normalized[4] = { value.x + 0.0f, value.y + 0.0f, value.z + 0.0f,
+                            value.w + 0.0f };
 
-    return static_cast<uint32>(
-        ( static_cast<uint64>( 0xFFFFFFFF ) & hashCode ) ^ hashCode >> 32 );
+    return HashUtils::hash64( normalized, sizeof( normalized ) );
 }
 
 template <>
 inline
-uint32 Hasher<int64>::hash( const int64& value )
+uint64 Hasher<glm::quat>::hash64( const glm::quat& value )
 {
-    uint64 hashCode = ( HashUtils::FNV_OFFSET_64 ^
-        static_cast<uint64>( value ) ) * HashUtils::FNV_PRIME_64;
+    float normalized[4] = { value.x + 0.0f, value.y + 0.0f, value.z + 0.0f,
+                            value.w + 0.0f };
 
-    return static_cast<uint32>(
-        ( static_cast<uint64>( 0xFFFFFFFF ) & hashCode ) ^ hashCode >> 32 );
+    return HashUtils::hash64( normalized, sizeof( normalized ) );
 }
 
 } // End nspc util
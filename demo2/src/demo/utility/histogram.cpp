@@ -0,0 +1,105 @@
+// histogram.cpp
+#include "demo/utility/histogram.h"
+
+#include <assert.h>
+
+namespace demo
+{
+
+namespace util
+{
+
+// CONSTANTS
+constexpr uint32 Histogram::SUB_BUCKET_BITS;
+constexpr uint32 Histogram::SUB_BUCKET_COUNT;
+constexpr uint32 Histogram::BUCKET_COUNT;
+
+// CONSTRUCTORS
+Histogram::Histogram()
+{
+    reset();
+}
+
+// MEMBER FUNCTIONS
+void Histogram::merge( const Histogram& other )
+{
+    for ( uint32 i = 0; i < BUCKET_COUNT; ++i )
+    {
+        _counts[i] += other._counts[i];
+    }
+
+    _count += other._count;
+    _sum += other._sum;
+
+    if ( other._min < _min )
+    {
+        _min = other._min;
+    }
+
+    if ( other._max > _max )
+    {
+        _max = other._max;
+    }
+}
+
+void Histogram::reset()
+{
+    for ( uint32 i = 0; i < BUCKET_COUNT; ++i )
+    {
+        _counts[i] = 0;
+    }
+
+    _count = 0;
+    _sum = 0;
+    _min = static_cast<uint64>( -1 );
+    _max = 0;
+}
+
+uint64 Histogram::percentile( double percentile ) const
+{
+    assert( percentile >= 0.0 && percentile <= 100.0 );
+
+    if ( _count == 0 )
+    {
+        return 0;
+    }
+
+    // the rank of the sample, rounded up so that p100 is the last sample
+    uint64 rank = static_cast<uint64>( percentile / 100.0 * _count + 0.5 );
+    if ( rank == 0 )
+    {
+        rank = 1;
+    }
+
+    uint64 seen = 0;
+    for ( uint32 i = 0; i < BUCKET_COUNT; ++i )
+    {
+        seen += _counts[i];
+        if ( seen >= rank )
+        {
+            uint64 bound = upperBound( i );
+            return bound < _max ? bound : _max;
+        }
+    }
+
+    return _max;
+}
+
+// HELPER FUNCTIONS
+uint64 Histogram::upperBound( uint32 bucket )
+{
+    if ( bucket < SUB_BUCKET_COUNT )
+    {
+        return bucket;
+    }
+
+    uint32 shift = ( bucket - SUB_BUCKET_COUNT ) / SUB_BUCKET_COUNT;
+    uint64 mantissa = SUB_BUCKET_COUNT + ( bucket - SUB_BUCKET_COUNT ) %
+                                         SUB_BUCKET_COUNT;
+
+    return ( ( mantissa + 1 ) << shift ) - 1;
+}
+
+} // End nspc util
+
+} // End nspc demo
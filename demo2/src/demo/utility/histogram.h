@@ -0,0 +1,208 @@
+// histogram.h
+//
+// A log-linear histogram of non-negative integer samples.
+//
+// Each power of two range is split into 32 linear buckets so every recorded
+// value is kept to within about three percent of its true value regardless
+// of magnitude. This is the layout used by HDR histograms and lets a single
+// fixed-size histogram cover everything from nanoseconds to minutes without
+// allocating while samples are recorded.
+//
+#ifndef DEMO_HISTOGRAM_H
+#define DEMO_HISTOGRAM_H
+
+#include "demo/intdef.h"
+
+namespace demo
+{
+
+namespace util
+{
+
+class Histogram
+{
+  public:
+    // CONSTANTS
+    /**
+     * The log2 of the number of buckets per power of two.
+     */
+    static constexpr uint32 SUB_BUCKET_BITS = 5;
+
+    /**
+     * The number of buckets per power of two.
+     */
+    static constexpr uint32 SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+
+    /**
+     * The total number of buckets.
+     */
+    static constexpr uint32 BUCKET_COUNT = SUB_BUCKET_COUNT *
+                                           ( 64 - SUB_BUCKET_BITS + 1 );
+
+  private:
+    // MEMBERS
+    /**
+     * The number of samples in each bucket.
+     */
+    uint64 _counts[BUCKET_COUNT];
+
+    /**
+     * The number of samples.
+     */
+    uint64 _count;
+
+    /**
+     * The sum of all samples.
+     */
+    uint64 _sum;
+
+    /**
+     * The smallest sample.
+     */
+    uint64 _min;
+
+    /**
+     * The largest sample.
+     */
+    uint64 _max;
+
+    // HELPER FUNCTIONS
+    /**
+     * Gets the bucket of a value.
+     */
+    static uint32 bucketOf( uint64 value );
+
+    /**
+     * Gets the largest value that maps to a bucket.
+     */
+    static uint64 upperBound( uint32 bucket );
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs an empty histogram.
+     */
+    Histogram();
+
+    // MEMBER FUNCTIONS
+    /**
+     * Records a sample.
+     */
+    void record( uint64 value );
+
+    /**
+     * Adds every sample of another histogram.
+     */
+    void merge( const Histogram& other );
+
+    /**
+     * Removes every sample.
+     */
+    void reset();
+
+    /**
+     * Gets the value at or below which the given percentage of samples lie.
+     *
+     * The result is the upper bound of the bucket that holds the percentile
+     * clamped to the largest sample. Returns zero when empty.
+     *
+     * Behavior is undefined when:
+     * percentile is not between 0 and 100
+     */
+    uint64 percentile( double percentile ) const;
+
+    /**
+     * Gets the number of samples.
+     */
+    uint64 count() const;
+
+    /**
+     * Gets the smallest sample or zero when empty.
+     */
+    uint64 min() const;
+
+    /**
+     * Gets the largest sample or zero when empty.
+     */
+    uint64 max() const;
+
+    /**
+     * Gets the average sample or zero when empty.
+     */
+    double mean() const;
+};
+
+// MEMBER FUNCTIONS
+inline
+void Histogram::record( uint64 value )
+{
+    ++_counts[bucketOf( value )];
+    ++_count;
+    _sum += value;
+
+    if ( value < _min )
+    {
+        _min = value;
+    }
+
+    if ( value > _max )
+    {
+        _max = value;
+    }
+}
+
+inline
+uint64 Histogram::count() const
+{
+    return _count;
+}
+
+inline
+uint64 Histogram::min() const
+{
+    return _count > 0 ? _min : 0;
+}
+
+inline
+uint64 Histogram::max() const
+{
+    return _max;
+}
+
+inline
+double Histogram::mean() const
+{
+    return _count > 0 ? static_cast<double>( _sum ) / _count : 0.0;
+}
+
+// HELPER FUNCTIONS
+inline
+uint32 Histogram::bucketOf( uint64 value )
+{
+    if ( value < SUB_BUCKET_COUNT )
+    {
+        return static_cast<uint32>( value );
+    }
+
+    // the top SUB_BUCKET_BITS + 1 bits select the bucket
+    uint32 msb = 0;
+    #ifdef __GNUC__
+    msb = static_cast<uint32>( 63 - __builtin_clzll( value ) );
+    #else
+    for ( uint64 bits = value >> 1; bits != 0; bits >>= 1 )
+    {
+        ++msb;
+    }
+    #endif
+
+    uint32 shift = msb - SUB_BUCKET_BITS;
+    uint32 mantissa = static_cast<uint32>( value >> shift ) - SUB_BUCKET_COUNT;
+
+    return SUB_BUCKET_COUNT + shift * SUB_BUCKET_COUNT + mantissa;
+}
+
+} // End nspc util
+
+} // End nspc demo
+
+#endif // DEMO_HISTOGRAM_H
@@ -0,0 +1,448 @@
+// log.cpp
+#include "demo/utility/log.h"
+
+#include <signal.h>
+
+namespace demo
+{
+
+namespace util
+{
+
+// CONSTANTS
+constexpr uint32 Log::MAX_ARGS;
+constexpr uint32 Log::ENTRY_SIZE;
+constexpr uint32 Log::BUFFER_CAPACITY;
+constexpr uint32 Log::DRAIN_INTERVAL_MS;
+constexpr uint32 Log::CRASH_WAIT_MS;
+
+// GLOBALS
+std::mutex Log::g_mutex;
+std::condition_variable Log::g_wake;
+cntr::DynamicArray<Log::ThreadBuffer*> Log::g_buffers;
+std::atomic<int32> Log::g_level( LEVEL_TRACE );
+std::atomic<bool> Log::g_isRunning( false );
+std::atomic<bool> Log::g_isCrashDrainNeeded( false );
+std::thread Log::g_thread;
+FILE* Log::g_file = nullptr;
+bool Log::g_ownsFile = false;
+uint64 Log::g_dropped = 0;
+uint32 Log::g_threadCount = 0;
+uint64 Log::g_epoch = Log::now();
+thread_local Log::LocalBuffer Log::t_buffer = { nullptr };
+thread_local bool Log::t_isDrainThread = false;
+
+// CONSTRUCTORS
+Log::LocalBuffer::~LocalBuffer()
+{
+    if ( buffer != nullptr )
+    {
+        buffer->isRetired.store( true, std::memory_order_release );
+    }
+}
+
+// HELPER FUNCTIONS
+/**
+ * Appends formatted text to a line, clamping to its capacity.
+ */
+template <typename T>
+static void append( char* line, Size capacity, Size* size, const char* spec,
+                    T value )
+{
+    int32 written = snprintf( line + *size, capacity - *size, spec, value );
+    if ( written > 0 )
+    {
+        *size += static_cast<Size>( written ) < capacity - *size ?
+                 static_cast<Size>( written ) : capacity - *size - 1;
+    }
+}
+
+Log::ThreadBuffer* Log::localBuffer()
+{
+    if ( t_buffer.buffer == nullptr )
+    {
+        ThreadBuffer* buffer = new ThreadBuffer();
+        buffer->head.store( 0 );
+        buffer->tail.store( 0 );
+        buffer->dropped.store( 0 );
+        buffer->isRetired.store( false );
+
+        std::lock_guard<std::mutex> lock( g_mutex );
+        buffer->thread = g_threadCount++;
+        g_buffers.push( buffer );
+
+        t_buffer.buffer = buffer;
+    }
+
+    return t_buffer.buffer;
+}
+
+Log::Entry* Log::beginEntry()
+{
+    ThreadBuffer* buffer = localBuffer();
+    uint32 head = buffer->head.load( std::memory_order_relaxed );
+    uint32 tail = buffer->tail.load( std::memory_order_acquire );
+
+    if ( head - tail >= BUFFER_CAPACITY )
+    {
+        buffer->dropped.fetch_add( 1, std::memory_order_relaxed );
+        return nullptr;
+    }
+
+    return &buffer->entries[head % BUFFER_CAPACITY];
+}
+
+void Log::commitEntry()
+{
+    ThreadBuffer* buffer = t_buffer.buffer;
+    uint32 head = buffer->head.load( std::memory_order_relaxed );
+    buffer->head.store( head + 1, std::memory_order_release );
+
+    // without a drain thread the message is written right away
+    if ( !g_isRunning.load( std::memory_order_acquire ) )
+    {
+        flush();
+    }
+
+    // wake the drain thread early during a burst rather than drop messages
+    else if ( head + 1 - buffer->tail.load( std::memory_order_relaxed ) ==
+              BUFFER_CAPACITY / 2 )
+    {
+        g_wake.notify_one();
+    }
+}
+
+void Log::captureString( Entry* entry, Arg* arg, const char* value,
+                         Size length )
+{
+    const Size capacity = sizeof( entry->text );
+    Size offset = entry->textSize < capacity ? entry->textSize :
+                  capacity - 1;
+    Size room = capacity - offset - 1;
+    Size count = length < room ? length : room;
+
+    memcpy( entry->text + offset, value, count );
+    entry->text[offset + count] = '\0';
+
+    arg->type = ARG_STRING;
+    arg->text = static_cast<uint32>( offset );
+    entry->textSize = static_cast<uint32>( offset + count + 1 );
+}
+
+void Log::output( const Entry& entry, uint32 thread, FILE* file )
+{
+    static const char LEVEL_LETTERS[LEVEL_COUNT] = {
+        'T', 'D', 'I', 'W', 'E' };
+
+    const Size capacity = 1024;
+    char line[capacity];
+    Size size = 0;
+
+    append( line, capacity, &size, "[%12.6f] ",
+            static_cast<double>( entry.time - g_epoch ) * 1.0e-9 );
+    line[size++] = LEVEL_LETTERS[entry.level];
+    append( line, capacity, &size, " %u ", thread );
+    append( line, capacity, &size, "%s: ", entry.tag );
+
+    const char* format = entry.format;
+    uint32 argIndex = 0;
+    while ( *format != '\0' && size < capacity - 2 )
+    {
+        if ( *format != '%' )
+        {
+            line[size++] = *format++;
+            continue;
+        }
+
+        if ( format[1] == '%' )
+        {
+            line[size++] = '%';
+            format += 2;
+            continue;
+        }
+
+        // copy the flags, width and precision but not the length since the
+        // captured arguments are always 64-bit
+        char spec[32];
+        Size specSize = 0;
+        spec[specSize++] = *format++;
+        while ( *format != '\0' && strchr( "-+ #0123456789.", *format ) &&
+                specSize < sizeof( spec ) - 4 )
+        {
+            spec[specSize++] = *format++;
+        }
+
+        while ( *format != '\0' && strchr( "hlLqjzt", *format ) )
+        {
+            ++format;
+        }
+
+        char conversion = *format;
+        if ( conversion == '\0' )
+        {
+            break;
+        }
+        ++format;
+
+        if ( argIndex >= entry.argCount )
+        {
+            append( line, capacity, &size, "%s", "<missing>" );
+            continue;
+        }
+
+        const Arg& arg = entry.args[argIndex++];
+        int64 integer = arg.type == ARG_INT ? arg.i :
+                        arg.type == ARG_UINT ? static_cast<int64>( arg.u ) :
+                        arg.type == ARG_DOUBLE ? static_cast<int64>( arg.d ) :
+                        0;
+
+        switch ( conversion )
+        {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                spec[specSize++] = 'l';
+                spec[specSize++] = 'l';
+                spec[specSize++] = conversion;
+                spec[specSize] = '\0';
+                append( line, capacity, &size, spec,
+                        static_cast<long long>( integer ) );
+                break;
+
+            case 'c':
+                spec[specSize++] = conversion;
+                spec[specSize] = '\0';
+                append( line, capacity, &size, spec,
+                        static_cast<int>( integer ) );
+                break;
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                spec[specSize++] = conversion;
+                spec[specSize] = '\0';
+                append( line, capacity, &size, spec,
+                        arg.type == ARG_DOUBLE ? arg.d :
+                        static_cast<double>( integer ) );
+                break;
+
+            case 's':
+                spec[specSize++] = conversion;
+                spec[specSize] = '\0';
+                append( line, capacity, &size, spec,
+                        arg.type == ARG_STRING ? entry.text + arg.text :
+                        "<not a string>" );
+                break;
+
+            case 'p':
+                spec[specSize++] = conversion;
+                spec[specSize] = '\0';
+                append( line, capacity, &size, spec,
+                        arg.type == ARG_POINTER ? arg.p : nullptr );
+                break;
+
+            default:
+                append( line, capacity, &size, "%s", "<bad format>" );
+                break;
+        }
+    }
+
+    line[size++] = '\n';
+    fwrite( line, 1, size, file );
+}
+
+void Log::drain()
+{
+    FILE* file = g_file != nullptr ? g_file : stderr;
+
+    for ( uint32 i = 0; i < g_buffers.size(); ++i )
+    {
+        ThreadBuffer* buffer = g_buffers[i];
+        bool isRetired = buffer->isRetired.load( std::memory_order_acquire );
+        uint32 head = buffer->head.load( std::memory_order_acquire );
+        uint32 tail = buffer->tail.load( std::memory_order_relaxed );
+
+        for ( ; tail != head; ++tail )
+        {
+            output( buffer->entries[tail % BUFFER_CAPACITY], buffer->thread,
+                    file );
+        }
+
+        buffer->tail.store( tail, std::memory_order_release );
+
+        uint64 dropped = buffer->dropped.exchange( 0,
+                                                   std::memory_order_relaxed );
+        if ( dropped > 0 )
+        {
+            fprintf( file, "[%12.6f] W %u log: dropped %llu message(s)\n",
+                     static_cast<double>( now() - g_epoch ) * 1.0e-9,
+                     buffer->thread,
+                     static_cast<unsigned long long>( dropped ) );
+            g_dropped += dropped;
+        }
+
+        // the thread has exited so nothing else will be written
+        if ( isRetired )
+        {
+            g_buffers.removeAt( i-- );
+            delete buffer;
+        }
+    }
+
+    fflush( file );
+}
+
+void Log::run()
+{
+    t_isDrainThread = true;
+
+    std::unique_lock<std::mutex> lock( g_mutex );
+    while ( g_isRunning.load( std::memory_order_relaxed ) )
+    {
+        // a crash handler is released only by a pass that began after it
+        // asked, so every message it could see has been written
+        bool isCrashing = g_isCrashDrainNeeded.load(
+            std::memory_order_acquire );
+        drain();
+        if ( isCrashing )
+        {
+            g_isCrashDrainNeeded.store( false, std::memory_order_release );
+        }
+
+        g_wake.wait_for( lock,
+                         std::chrono::milliseconds( DRAIN_INTERVAL_MS ) );
+    }
+}
+
+void Log::handleCrash( int signal )
+{
+    // the drain thread wakes on its own, so the handler only raises the
+    // flag and polls it, neither of which takes a lock; a crash on the drain
+    // thread itself cannot be drained
+    if ( g_isRunning.load( std::memory_order_acquire ) && !t_isDrainThread )
+    {
+        g_isCrashDrainNeeded.store( true, std::memory_order_release );
+        for ( uint32 waited = 0;
+              waited < CRASH_WAIT_MS &&
+              g_isCrashDrainNeeded.load( std::memory_order_acquire );
+              ++waited )
+        {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+    }
+
+    ::signal( signal, SIG_DFL );
+    raise( signal );
+}
+
+// UTILITY FUNCTIONS
+void Log::startup( FILE* file )
+{
+    std::lock_guard<std::mutex> lock( g_mutex );
+    if ( g_isRunning.load() )
+    {
+        return;
+    }
+
+    g_file = file;
+    g_isRunning.store( true );
+    g_thread = std::thread( &Log::run );
+}
+
+bool Log::startup( const String& path )
+{
+    FILE* file = fopen( path.c_str(), "w" );
+    if ( file == nullptr )
+    {
+        return false;
+    }
+
+    startup( file );
+
+    std::lock_guard<std::mutex> lock( g_mutex );
+    if ( g_file != file )
+    {
+        fclose( file );
+        return false;
+    }
+
+    g_ownsFile = true;
+    return true;
+}
+
+void Log::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock( g_mutex );
+        if ( !g_isRunning.load() )
+        {
+            return;
+        }
+
+        g_isRunning.store( false );
+    }
+
+    g_wake.notify_all();
+    g_thread.join();
+
+    std::lock_guard<std::mutex> lock( g_mutex );
+    drain();
+
+    if ( g_ownsFile )
+    {
+        fclose( g_file );
+        g_ownsFile = false;
+    }
+    g_file = nullptr;
+}
+
+void Log::flush()
+{
+    std::lock_guard<std::mutex> lock( g_mutex );
+    drain();
+}
+
+void Log::installCrashHandler()
+{
+    signal( SIGSEGV, &Log::handleCrash );
+    signal( SIGABRT, &Log::handleCrash );
+    signal( SIGFPE, &Log::handleCrash );
+    signal( SIGILL, &Log::handleCrash );
+
+    #ifdef SIGBUS
+    signal( SIGBUS, &Log::handleCrash );
+    #endif
+}
+
+uint64 Log::droppedMessages()
+{
+    std::lock_guard<std::mutex> lock( g_mutex );
+
+    uint64 dropped = g_dropped;
+    for ( uint32 i = 0; i < g_buffers.size(); ++i )
+    {
+        dropped += g_buffers[i]->dropped.load( std::memory_order_relaxed );
+    }
+
+    return dropped;
+}
+
+const char* Log::name( Level level )
+{
+    static const char* const LEVEL_NAMES[LEVEL_COUNT] = {
+        "trace", "debug", "info", "warn", "error" };
+
+    return LEVEL_NAMES[level];
+}
+
+} // End nspc util
+
+} // End nspc demo
@@ -0,0 +1,567 @@
+// log.h
+//
+// An asynchronous logger.
+//
+// Messages are written with the DEMO_LOG_* macros using printf-style format
+// strings. Formatting is deferred: the calling thread only copies the format
+// pointer and the arguments into its own single producer, single consumer
+// ring buffer, which never takes a lock. A background thread drains every
+// buffer, formats the messages and writes them to stdout or a file. If the
+// logger has not been started, messages are formatted and written to stderr
+// immediately instead.
+//
+// Levels below DEMO_LOG_LEVEL are compiled out, so their arguments are never
+// evaluated. DEMO_LOG_LEVEL is 0 (trace) by default and 2 (info) in release
+// builds. Levels that are compiled in can also be raised at runtime.
+//
+// Tags and format strings must be string literals or otherwise outlive the
+// logger. String arguments are copied, and truncated if the message does not
+// have room for them. Width and precision given as * are not supported.
+//
+// The crash handler has the drain thread write every buffer before the
+// process dies from a fatal signal, so the messages leading up to the crash
+// are not lost. Formatting and locking are not safe inside a signal handler,
+// so the handler only raises a flag and waits for the drain thread to finish
+// a pass. Without a drain thread messages are written as they are logged.
+//
+#ifndef DEMO_LOG_H
+#define DEMO_LOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <type_traits>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/intdef.h"
+#include "demo/strdef.h"
+
+#ifndef DEMO_LOG_LEVEL
+#ifdef NDEBUG
+#define DEMO_LOG_LEVEL 2
+#else
+#define DEMO_LOG_LEVEL 0
+#endif
+#endif
+
+#if DEMO_LOG_LEVEL <= 0
+/**
+ * Logs a message that traces the flow of the program.
+ */
+#define DEMO_LOG_TRACE( tag, ... ) \
+demo::util::Log::write( demo::util::Log::LEVEL_TRACE, tag, __VA_ARGS__ )
+#else
+#define DEMO_LOG_TRACE( tag, ... ) ( ( void ) 0 )
+#endif
+
+#if DEMO_LOG_LEVEL <= 1
+/**
+ * Logs a message that helps debugging.
+ */
+#define DEMO_LOG_DEBUG( tag, ... ) \
+demo::util::Log::write( demo::util::Log::LEVEL_DEBUG, tag, __VA_ARGS__ )
+#else
+#define DEMO_LOG_DEBUG( tag, ... ) ( ( void ) 0 )
+#endif
+
+#if DEMO_LOG_LEVEL <= 2
+/**
+ * Logs an informational message.
+ */
+#define DEMO_LOG_INFO( tag, ... ) \
+demo::util::Log::write( demo::util::Log::LEVEL_INFO, tag, __VA_ARGS__ )
+#else
+#define DEMO_LOG_INFO( tag, ... ) ( ( void ) 0 )
+#endif
+
+#if DEMO_LOG_LEVEL <= 3
+/**
+ * Logs a warning about a recoverable problem.
+ */
+#define DEMO_LOG_WARN( tag, ... ) \
+demo::util::Log::write( demo::util::Log::LEVEL_WARN, tag, __VA_ARGS__ )
+#else
+#define DEMO_LOG_WARN( tag, ... ) ( ( void ) 0 )
+#endif
+
+/**
+ * Logs an error. Errors are never compiled out.
+ */
+#define DEMO_LOG_ERROR( tag, ... ) \
+demo::util::Log::write( demo::util::Log::LEVEL_ERROR, tag, __VA_ARGS__ )
+
+namespace demo
+{
+
+namespace util
+{
+
+class Log
+{
+  public:
+    // TYPES
+    /**
+     * The severity of a message, in the same order as DEMO_LOG_LEVEL.
+     */
+    enum Level
+    {
+        LEVEL_TRACE,
+        LEVEL_DEBUG,
+        LEVEL_INFO,
+        LEVEL_WARN,
+        LEVEL_ERROR,
+        LEVEL_COUNT
+    };
+
+  private:
+    // CONSTANTS
+    /**
+     * The most arguments a message can have.
+     */
+    static constexpr uint32 MAX_ARGS = 8;
+
+    /**
+     * The size of a captured message.
+     */
+    static constexpr uint32 ENTRY_SIZE = 512;
+
+    /**
+     * The number of messages each thread can hold before they are drained.
+     */
+    static constexpr uint32 BUFFER_CAPACITY = 256;
+
+    /**
+     * How often the drain thread wakes up in milliseconds.
+     */
+    static constexpr uint32 DRAIN_INTERVAL_MS = 10;
+
+    /**
+     * The longest the crash handler waits for the drain thread in
+     * milliseconds.
+     */
+    static constexpr uint32 CRASH_WAIT_MS = 100;
+
+    // TYPES
+    /**
+     * The kinds of captured argument.
+     */
+    enum ArgType
+    {
+        ARG_INT,
+        ARG_UINT,
+        ARG_DOUBLE,
+        ARG_POINTER,
+        ARG_STRING
+    };
+
+    /**
+     * A captured argument.
+     */
+    struct Arg
+    {
+        uint32 type;
+        union
+        {
+            int64 i;
+            uint64 u;
+            double d;
+            const void* p;
+            uint32 text;
+        };
+    };
+
+    /**
+     * The fixed part of a captured message.
+     */
+    struct Header
+    {
+        uint64 time;
+        const char* tag;
+        const char* format;
+        uint32 level;
+        uint32 argCount;
+        uint32 textSize;
+        Arg args[MAX_ARGS];
+    };
+
+    /**
+     * A captured message. Copied strings are stored after the header.
+     */
+    struct Entry : Header
+    {
+        char text[ENTRY_SIZE - sizeof( Header )];
+    };
+
+    /**
+     * The messages of one thread.
+     *
+     * Only the owning thread writes messages and only the thread holding the
+     * drain lock reads them.
+     */
+    struct ThreadBuffer
+    {
+        Entry entries[BUFFER_CAPACITY];
+        std::atomic<uint32> head;
+        std::atomic<uint32> tail;
+        std::atomic<uint64> dropped;
+        std::atomic<bool> isRetired;
+        uint32 thread;
+    };
+
+    /**
+     * Owns the buffer of a thread and retires it when the thread exits so
+     * that the drain thread can write its last messages and release it.
+     */
+    struct LocalBuffer
+    {
+        ThreadBuffer* buffer;
+
+        ~LocalBuffer();
+    };
+
+    // GLOBALS
+    /**
+     * Guards the buffer list and serializes draining.
+     */
+    static std::mutex g_mutex;
+
+    /**
+     * Wakes the drain thread early.
+     */
+    static std::condition_variable g_wake;
+
+    /**
+     * The buffers of every thread that has logged a message.
+     */
+    static cntr::DynamicArray<ThreadBuffer*> g_buffers;
+
+    /**
+     * The least severe level that is written.
+     */
+    static std::atomic<int32> g_level;
+
+    /**
+     * Whether the drain thread is running.
+     */
+    static std::atomic<bool> g_isRunning;
+
+    /**
+     * Whether a crash handler is waiting for the drain thread to write
+     * every buffer.
+     */
+    static std::atomic<bool> g_isCrashDrainNeeded;
+
+    /**
+     * The drain thread.
+     */
+    static std::thread g_thread;
+
+    /**
+     * The file messages are written to.
+     */
+    static FILE* g_file;
+
+    /**
+     * Whether the file was opened by the logger.
+     */
+    static bool g_ownsFile;
+
+    /**
+     * The number of messages dropped that have been reported.
+     */
+    static uint64 g_dropped;
+
+    /**
+     * The number of threads that have logged a message.
+     */
+    static uint32 g_threadCount;
+
+    /**
+     * The time the logger was loaded, which message times are relative to.
+     */
+    static uint64 g_epoch;
+
+    /**
+     * The buffer of the current thread.
+     */
+    static thread_local LocalBuffer t_buffer;
+
+    /**
+     * Whether the current thread is the drain thread.
+     */
+    static thread_local bool t_isDrainThread;
+
+    // HELPER FUNCTIONS
+    /**
+     * Gets the buffer of the current thread, registering one if needed.
+     */
+    static ThreadBuffer* localBuffer();
+
+    /**
+     * Gets the next free entry of the current thread or null if its buffer
+     * is full.
+     */
+    static Entry* beginEntry();
+
+    /**
+     * Publishes the entry returned by beginEntry.
+     */
+    static void commitEntry();
+
+    /**
+     * Captures the remaining arguments.
+     */
+    static void capture( Entry* entry );
+
+    template <typename T, typename... Args>
+    static void capture( Entry* entry, const T& value, const Args&... args );
+
+    /**
+     * Captures an argument.
+     */
+    template <typename T>
+    static void captureValue( Entry* entry, Arg* arg, const T& value );
+
+    template <typename T>
+    static void captureValue( Entry* entry, Arg* arg, T* value );
+
+    static void captureValue( Entry* entry, Arg* arg, const char* value );
+
+    static void captureValue( Entry* entry, Arg* arg, char* value );
+
+    static void captureValue( Entry* entry, Arg* arg, const String& value );
+
+    /**
+     * Captures a floating point number.
+     */
+    template <typename T>
+    static void captureNumber( Arg* arg, T value, std::true_type isFloat );
+
+    /**
+     * Captures an integer or enumerator.
+     */
+    template <typename T>
+    static void captureNumber( Arg* arg, T value, std::false_type isFloat );
+
+    /**
+     * Copies a string into the entry text.
+     */
+    static void captureString( Entry* entry, Arg* arg, const char* value,
+                               Size length );
+
+    /**
+     * Formats an entry and writes it to the file.
+     */
+    static void output( const Entry& entry, uint32 thread, FILE* file );
+
+    /**
+     * Drains every buffer and releases those of exited threads.
+     * The drain lock must be held.
+     */
+    static void drain();
+
+    /**
+     * Drains buffers until the logger stops.
+     */
+    static void run();
+
+    /**
+     * Waits for the drain thread to write the buffers and re-raises a fatal
+     * signal.
+     */
+    static void handleCrash( int signal );
+
+    /**
+     * Gets the current time in nanoseconds.
+     */
+    static uint64 now();
+
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Starts the drain thread writing to the given file.
+     * This does nothing if the logger is already running.
+     */
+    static void startup( FILE* file );
+
+    /**
+     * Starts the drain thread writing to the file at the given path.
+     * Returns false if the file could not be opened.
+     */
+    static bool startup( const String& path );
+
+    /**
+     * Stops the drain thread and writes every remaining message.
+     */
+    static void shutdown();
+
+    /**
+     * Writes every message logged so far.
+     */
+    static void flush();
+
+    /**
+     * Installs signal handlers that flush the buffers on a crash.
+     */
+    static void installCrashHandler();
+
+    /**
+     * Checks if messages at a level are written.
+     */
+    static bool isEnabled( Level level );
+
+    /**
+     * Sets the least severe level that is written.
+     */
+    static void setLevel( Level level );
+
+    /**
+     * Gets the number of messages dropped because a buffer was full.
+     */
+    static uint64 droppedMessages();
+
+    /**
+     * Gets the name of a level.
+     */
+    static const char* name( Level level );
+
+    /**
+     * Logs a message.
+     * Prefer the DEMO_LOG_* macros so disabled levels are compiled out.
+     */
+    template <typename... Args>
+    static void write( Level level, const char* tag, const char* format,
+                       const Args&... args );
+};
+
+// UTILITY FUNCTIONS
+inline
+bool Log::isEnabled( Level level )
+{
+    return level >= g_level.load( std::memory_order_relaxed );
+}
+
+inline
+void Log::setLevel( Level level )
+{
+    g_level.store( level, std::memory_order_relaxed );
+}
+
+inline
+uint64 Log::now()
+{
+    using namespace std::chrono;
+
+    return static_cast<uint64>( duration_cast<nanoseconds>(
+        steady_clock::now().time_since_epoch() ).count() );
+}
+
+template <typename... Args>
+void Log::write( Level level, const char* tag, const char* format,
+                 const Args&... args )
+{
+    static_assert( sizeof...( Args ) <= MAX_ARGS,
+                   "too many arguments for a log message" );
+
+    if ( !isEnabled( level ) )
+    {
+        return;
+    }
+
+    Entry* entry = beginEntry();
+    if ( entry == nullptr )
+    {
+        return;
+    }
+
+    entry->time = now();
+    entry->tag = tag;
+    entry->format = format;
+    entry->level = level;
+    entry->argCount = 0;
+    entry->textSize = 0;
+    capture( entry, args... );
+
+    commitEntry();
+}
+
+// HELPER FUNCTIONS
+inline
+void Log::capture( Entry* /* entry */ )
+{
+}
+
+template <typename T, typename... Args>
+void Log::capture( Entry* entry, const T& value, const Args&... args )
+{
+    captureValue( entry, &entry->args[entry->argCount++], value );
+    capture( entry, args... );
+}
+
+template <typename T>
+void Log::captureValue( Entry* /* entry */, Arg* arg, const T& value )
+{
+    static_assert( std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                   "log arguments must be numbers, pointers or strings" );
+
+    captureNumber( arg, value, std::is_floating_point<T>() );
+}
+
+template <typename T>
+void Log::captureValue( Entry* /* entry */, Arg* arg, T* value )
+{
+    arg->type = ARG_POINTER;
+    arg->p = value;
+}
+
+template <typename T>
+void Log::captureNumber( Arg* arg, T value, std::true_type /* isFloat */ )
+{
+    arg->type = ARG_DOUBLE;
+    arg->d = static_cast<double>( value );
+}
+
+template <typename T>
+void Log::captureNumber( Arg* arg, T value,
+                          std::false_type /* isFloat */ )
+{
+    if ( std::is_signed<T>::value || std::is_enum<T>::value )
+    {
+        arg->type = ARG_INT;
+        arg->i = static_cast<int64>( value );
+    }
+    else
+    {
+        arg->type = ARG_UINT;
+        arg->u = static_cast<uint64>( value );
+    }
+}
+
+inline
+void Log::captureValue( Entry* entry, Arg* arg, const char* value )
+{
+    value = value != nullptr ? value : "(null)";
+    captureString( entry, arg, value, strlen( value ) );
+}
+
+inline
+void Log::captureValue( Entry* entry, Arg* arg, char* value )
+{
+    captureValue( entry, arg, static_cast<const char*>( value ) );
+}
+
+inline
+void Log::captureValue( Entry* entry, Arg* arg, const String& value )
+{
+    captureString( entry, arg, value.c_str(), value.length() );
+}
+
+} // End nspc util
+
+} // End nspc demo
+
+#endif // DEMO_LOG_H
@@ -0,0 +1,251 @@
+// profiler.cpp
+#include "demo/utility/profiler.h"
+
+#include <string.h>
+
+#include "demo/utility/hash_utils.h"
+#include "demo/utility/string_id.h"
+
+namespace demo
+{
+
+namespace util
+{
+
+// CONSTANTS
+constexpr uint32 Profiler::BUFFER_CAPACITY;
+constexpr uint32 Profiler::CAPTURE_CAPACITY;
+
+// GLOBALS
+std::mutex Profiler::g_mutex;
+cntr::DynamicArray<Profiler::ThreadBuffer*> Profiler::g_buffers;
+cntr::DynamicArray<Profiler::ZoneStats> Profiler::g_zones;
+cntr::Map<uint64, uint32> Profiler::g_zoneIndices;
+Profiler::Event* Profiler::g_capture = nullptr;
+uint32 Profiler::g_captureCount = 0;
+uint64 Profiler::g_frameCount = 0;
+uint64 Profiler::g_epoch = Profiler::now();
+thread_local Profiler::ThreadBuffer* Profiler::t_buffer = nullptr;
+thread_local uint32 Profiler::t_depth = 0;
+
+// UTILITY FUNCTIONS
+void Profiler::record( const char* name, uint64 start, uint64 end,
+                       uint32 depth )
+{
+    --t_depth;
+
+    ThreadBuffer* buffer = localBuffer();
+    uint32 head = buffer->head.load( std::memory_order_relaxed );
+    uint32 tail = buffer->tail.load( std::memory_order_acquire );
+
+    if ( head - tail >= BUFFER_CAPACITY )
+    {
+        buffer->dropped.fetch_add( 1, std::memory_order_relaxed );
+        return;
+    }
+
+    Event& event = buffer->events[head % BUFFER_CAPACITY];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    event.depth = depth;
+    event.thread = buffer->thread;
+
+    buffer->head.store( head + 1, std::memory_order_release );
+}
+
+void Profiler::endFrame()
+{
+    std::lock_guard<std::mutex> lock( g_mutex );
+
+    for ( auto iter = g_buffers.cbegin(); iter != g_buffers.cend(); ++iter )
+    {
+        ThreadBuffer* buffer = *iter;
+        uint32 tail = buffer->tail.load( std::memory_order_relaxed );
+        uint32 head = buffer->head.load( std::memory_order_acquire );
+
+        for ( uint32 i = tail; i != head; ++i )
+        {
+            const Event& event = buffer->events[i % BUFFER_CAPACITY];
+            const char* name = accumulate( event );
+
+            if ( g_capture != nullptr && g_captureCount < CAPTURE_CAPACITY )
+            {
+                g_capture[g_captureCount] = event;
+                g_capture[g_captureCount++].name = name;
+            }
+        }
+
+        buffer->tail.store( head, std::memory_order_release );
+    }
+
+    for ( uint32 i = 0; i < g_zones.size(); ++i )
+    {
+        ZoneStats& zone = g_zones[i];
+        zone.lastFrameNs = zone.frameNs;
+        if ( zone.frameNs > zone.maxFrameNs )
+        {
+            zone.maxFrameNs = zone.frameNs;
+        }
+        zone.frameNs = 0;
+    }
+
+    ++g_frameCount;
+}
+
+void Profiler::startCapture()
+{
+    std::lock_guard<std::mutex> lock( g_mutex );
+
+    if ( g_capture == nullptr )
+    {
+        g_capture = new Event[CAPTURE_CAPACITY];
+    }
+    g_captureCount = 0;
+}
+
+bool Profiler::stopCapture( const String& path )
+{
+    std::lock_guard<std::mutex> lock( g_mutex );
+
+    if ( g_capture == nullptr )
+    {
+        return false;
+    }
+
+    FILE* file = fopen( path.c_str(), "w" );
+    if ( file != nullptr )
+    {
+        fprintf( file, "{\"traceEvents\":[\n" );
+        for ( uint32 i = 0; i < g_captureCount; ++i )
+        {
+            const Event& event = g_capture[i];
+            fprintf( file,
+                     "%s{\"name\":\"%s\",\"cat\":\"demo\",\"ph\":\"X\","
+                     "\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u}\n",
+                     i == 0 ? "" : ",", event.name,
+                     static_cast<double>( event.start - g_epoch ) / 1000.0,
+                     static_cast<double>( event.end - event.start ) / 1000.0,
+                     event.thread );
+        }
+        fprintf( file, "],\"displayTimeUnit\":\"ms\"}\n" );
+        fclose( file );
+    }
+
+    delete[] g_capture;
+    g_capture = nullptr;
+    g_captureCount = 0;
+
+    return file != nullptr;
+}
+
+bool Profiler::isCapturing()
+{
+    std::lock_guard<std::mutex> lock( g_mutex );
+    return g_capture != nullptr;
+}
+
+uint64 Profiler::droppedEvents()
+{
+    std::lock_guard<std::mutex> lock( g_mutex );
+
+    uint64 dropped = 0;
+    for ( auto iter = g_buffers.cbegin(); iter != g_buffers.cend(); ++iter )
+    {
+        dropped += ( *iter )->dropped.load( std::memory_order_relaxed );
+    }
+
+    return dropped;
+}
+
+void Profiler::report( FILE* file )
+{
+    std::lock_guard<std::mutex> lock( g_mutex );
+
+    uint64 frames = g_frameCount > 0 ? g_frameCount : 1;
+
+    fprintf( file, "Profile over %llu frame(s):\n",
+             static_cast<unsigned long long>( g_frameCount ) );
+    fprintf( file, "  %-40s %10s %10s %10s\n", "zone", "avg ms", "max ms",
+             "calls" );
+    for ( uint32 i = 0; i < g_zones.size(); ++i )
+    {
+        const ZoneStats& zone = g_zones[i];
+        fprintf( file, "  %*s%-*s %10.3f %10.3f %10.1f\n",
+                 zone.depth * 2, "", 40 - zone.depth * 2, zone.name,
+                 static_cast<double>( zone.totalNs ) / frames / 1.0e6,
+                 static_cast<double>( zone.maxFrameNs ) / 1.0e6,
+                 static_cast<double>( zone.calls ) / frames );
+    }
+}
+
+void Profiler::reset()
+{
+    std::lock_guard<std::mutex> lock( g_mutex );
+
+    for ( uint32 i = 0; i < g_zones.size(); ++i )
+    {
+        ZoneStats& zone = g_zones[i];
+        zone.calls = 0;
+        zone.totalNs = 0;
+        zone.frameNs = 0;
+        zone.lastFrameNs = 0;
+        zone.maxFrameNs = 0;
+    }
+    g_frameCount = 0;
+}
+
+// HELPER FUNCTIONS
+Profiler::ThreadBuffer* Profiler::localBuffer()
+{
+    if ( t_buffer != nullptr )
+    {
+        return t_buffer;
+    }
+
+    // buffers are kept until exit so the frame thread can always drain them
+    ThreadBuffer* buffer = new ThreadBuffer();
+    buffer->head.store( 0, std::memory_order_relaxed );
+    buffer->tail.store( 0, std::memory_order_relaxed );
+    buffer->dropped.store( 0, std::memory_order_relaxed );
+
+    std::lock_guard<std::mutex> lock( g_mutex );
+    buffer->thread = g_buffers.size();
+    g_buffers.push( buffer );
+    t_buffer = buffer;
+
+    return buffer;
+}
+
+const char* Profiler::accumulate( const Event& event )
+{
+    uint64 key = HashUtils::fnv1a64( event.name, strlen( event.name ) );
+    uint32 index;
+    if ( g_zoneIndices.has( key ) )
+    {
+        index = g_zoneIndices[key];
+    }
+    else
+    {
+        index = g_zones.size();
+        g_zoneIndices.put( key, index );
+
+        // keep a copy that outlives the name the zone was recorded with
+        ZoneStats zone = { StringId( event.name ).str(), event.depth, 0, 0, 0,
+                           0, 0 };
+        g_zones.push( zone );
+    }
+
+    uint64 duration = event.end - event.start;
+
+    ZoneStats& zone = g_zones[index];
+    ++zone.calls;
+    zone.totalNs += duration;
+    zone.frameNs += duration;
+
+    return zone.name;
+}
+
+} // End nspc util
+
+} // End nspc demo
@@ -0,0 +1,343 @@
+// profiler.h
+//
+// A scoped CPU profiler.
+//
+// Zones are marked with DEMO_PROFILE_SCOPE and record their name, start and
+// end time and nesting depth when they close. Each thread writes its events
+// into its own single producer, single consumer ring buffer so that recording
+// never takes a lock. Once per frame the main thread drains every buffer and
+// accumulates the time spent in each zone. Events can also be captured on
+// demand and written out in the Chrome trace event format which can be opened
+// with about://tracing or Perfetto.
+//
+// Profiling is compiled in when DEMO_PROFILE is defined. Without it the
+// macros expand to nothing and the profiler costs nothing.
+//
+// Zones are keyed by a hash of their name's text, so the same name used in
+// several places shares a zone. A name is interned as a StringId the first
+// time its zone is seen, and the accumulated zones and captured events refer
+// to the interned copy, so a name only has to stay valid until the end of the
+// frame it was recorded in.
+//
+#ifndef DEMO_PROFILER_H
+#define DEMO_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/container/map.h"
+#include "demo/intdef.h"
+#include "demo/strdef.h"
+
+#define DEMO_PROFILE_CONCAT_IMPL( a, b ) a##b
+#define DEMO_PROFILE_CONCAT( a, b ) DEMO_PROFILE_CONCAT_IMPL( a, b )
+
+#ifdef DEMO_PROFILE
+/**
+ * Profiles the enclosing scope under the given name.
+ */
+#define DEMO_PROFILE_SCOPE( name ) \
+demo::util::ProfileScope DEMO_PROFILE_CONCAT( _profileScope, __LINE__ )( name )
+
+/**
+ * Marks the end of a frame.
+ */
+#define DEMO_PROFILE_FRAME() demo::util::Profiler::endFrame()
+#else
+#define DEMO_PROFILE_SCOPE( name )
+#define DEMO_PROFILE_FRAME()
+#endif
+
+namespace demo
+{
+
+namespace util
+{
+
+class Profiler
+{
+  public:
+    // TYPES
+    /**
+     * A closed zone.
+     */
+    struct Event
+    {
+        const char* name;
+        uint64 start;
+        uint64 end;
+        uint32 depth;
+        uint32 thread;
+    };
+
+    /**
+     * The accumulated time of a zone.
+     */
+    struct ZoneStats
+    {
+        const char* name;
+        uint32 depth;
+        uint64 calls;
+        uint64 totalNs;
+        uint64 frameNs;
+        uint64 lastFrameNs;
+        uint64 maxFrameNs;
+    };
+
+  private:
+    // CONSTANTS
+    /**
+     * The number of events each thread can hold between two frames.
+     */
+    static constexpr uint32 BUFFER_CAPACITY = 16 * 1024;
+
+    /**
+     * The number of events a capture can hold.
+     */
+    static constexpr uint32 CAPTURE_CAPACITY = 1024 * 1024;
+
+    // TYPES
+    /**
+     * The events of one thread.
+     *
+     * Only the owning thread writes events and only the frame thread reads
+     * them.
+     */
+    struct ThreadBuffer
+    {
+        Event events[BUFFER_CAPACITY];
+        std::atomic<uint32> head;
+        std::atomic<uint32> tail;
+        std::atomic<uint64> dropped;
+        uint32 thread;
+    };
+
+    // GLOBALS
+    /**
+     * Guards the buffer list and the capture.
+     */
+    static std::mutex g_mutex;
+
+    /**
+     * The buffers of every thread that has recorded an event.
+     */
+    static cntr::DynamicArray<ThreadBuffer*> g_buffers;
+
+    /**
+     * The accumulated zones.
+     */
+    static cntr::DynamicArray<ZoneStats> g_zones;
+
+    /**
+     * The index of each zone by the hash of its name, so that copies of a
+     * name in different places share a zone.
+     */
+    static cntr::Map<uint64, uint32> g_zoneIndices;
+
+    /**
+     * The captured events or null when not capturing.
+     */
+    static Event* g_capture;
+
+    /**
+     * The number of captured events.
+     */
+    static uint32 g_captureCount;
+
+    /**
+     * The number of frames since the last reset.
+     */
+    static uint64 g_frameCount;
+
+    /**
+     * The time the profiler was started, which trace times are relative to.
+     */
+    static uint64 g_epoch;
+
+    /**
+     * The buffer of the current thread.
+     */
+    static thread_local ThreadBuffer* t_buffer;
+
+    /**
+     * The current zone depth of this thread.
+     */
+    static thread_local uint32 t_depth;
+
+    // HELPER FUNCTIONS
+    /**
+     * Gets the buffer of the current thread, registering one if needed.
+     */
+    static ThreadBuffer* localBuffer();
+
+    /**
+     * Accumulates an event into its zone and gets the zone's interned name.
+     */
+    static const char* accumulate( const Event& event );
+
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Gets the current time in nanoseconds.
+     */
+    static uint64 now();
+
+    /**
+     * Enters a zone on the current thread and gets its depth.
+     */
+    static uint32 enter();
+
+    /**
+     * Records a closed zone on the current thread.
+     */
+    static void record( const char* name, uint64 start, uint64 end,
+                        uint32 depth );
+
+    /**
+     * Drains every thread's events and closes the frame.
+     *
+     * This must be called from one thread only.
+     */
+    static void endFrame();
+
+    /**
+     * Starts capturing events for a trace.
+     */
+    static void startCapture();
+
+    /**
+     * Stops capturing and writes the trace in the Chrome trace event format.
+     *
+     * Returns false if nothing was being captured or the file could not be
+     * written.
+     */
+    static bool stopCapture( const String& path );
+
+    /**
+     * Checks if events are being captured.
+     */
+    static bool isCapturing();
+
+    /**
+     * Gets the accumulated zones.
+     */
+    static const cntr::DynamicArray<ZoneStats>& zones();
+
+    /**
+     * Gets the number of frames since the last reset.
+     */
+    static uint64 frameCount();
+
+    /**
+     * Gets the number of events dropped because a buffer was full.
+     */
+    static uint64 droppedEvents();
+
+    /**
+     * Writes the average time per frame of every zone.
+     *
+     * Zones are listed in the order they first closed and indented by depth.
+     */
+    static void report( FILE* file );
+
+    /**
+     * Clears the accumulated zones.
+     */
+    static void reset();
+};
+
+class ProfileScope
+{
+  private:
+    // MEMBERS
+    /**
+     * The zone name.
+     */
+    const char* _name;
+
+    /**
+     * The time the zone was entered.
+     */
+    uint64 _start;
+
+    /**
+     * The zone depth.
+     */
+    uint32 _depth;
+
+    /**
+     * Constructs a copy of the given scope.
+     *
+     * This is not a supported operation for scopes.
+     */
+    ProfileScope( const ProfileScope& other );
+
+    /**
+     * Assigns this as a copy of the other scope.
+     *
+     * This is not a supported operation for scopes.
+     */
+    ProfileScope& operator=( const ProfileScope& other );
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs a scope that enters the named zone.
+     */
+    ProfileScope( const char* name );
+
+    /**
+     * Destructs the scope and records the zone.
+     */
+    ~ProfileScope();
+};
+
+// UTILITY FUNCTIONS
+inline
+uint64 Profiler::now()
+{
+    using namespace std::chrono;
+
+    return static_cast<uint64>( duration_cast<nanoseconds>(
+        steady_clock::now().time_since_epoch() ).count() );
+}
+
+inline
+uint32 Profiler::enter()
+{
+    return t_depth++;
+}
+
+inline
+const cntr::DynamicArray<Profiler::ZoneStats>& Profiler::zones()
+{
+    return g_zones;
+}
+
+inline
+uint64 Profiler::frameCount()
+{
+    return g_frameCount;
+}
+
+// SCOPE CONSTRUCTORS
+inline
+ProfileScope::ProfileScope( const char* name )
+    : _name( name ), _start( Profiler::now() ), _depth( Profiler::enter() )
+{
+}
+
+inline
+ProfileScope::~ProfileScope()
+{
+    Profiler::record( _name, _start, Profiler::now(), _depth );
+}
+
+} // End nspc util
+
+} // End nspc demo
+
+#endif // DEMO_PROFILER_H
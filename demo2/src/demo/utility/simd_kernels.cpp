@@ -0,0 +1,820 @@
+// simd_kernels.cpp
+#include "demo/utility/simd_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef DEMO_ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace demo
+{
+
+namespace util
+{
+
+// CONSTANTS
+constexpr uint32 SimdKernels::TRANSFORM_COMPONENTS;
+constexpr uint32 SimdKernels::BOX_COMPONENTS;
+constexpr uint32 SimdKernels::CULL_PLANES;
+constexpr uint32 SimdKernels::TRIANGLE_COMPONENTS;
+constexpr uint32 SimdKernels::RASTER_ALIGNMENT;
+
+namespace
+{
+
+// SCALAR KERNELS
+void multiplyMatricesScalar( float* out, const float* left,
+                             const float* right, uint32 count )
+{
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        const float* a = left + i * 16;
+        const float* b = right + i * 16;
+        float* o = out + i * 16;
+
+        // each output column is the left columns weighted by a right column
+        for ( uint32 column = 0; column < 4; ++column )
+        {
+            for ( uint32 row = 0; row < 4; ++row )
+            {
+                o[column * 4 + row] = a[row] * b[column * 4] +
+                                      a[4 + row] * b[column * 4 + 1] +
+                                      a[8 + row] * b[column * 4 + 2] +
+                                      a[12 + row] * b[column * 4 + 3];
+            }
+        }
+    }
+}
+
+/**
+ * Composes the transform at the given index of a batch.
+ */
+void composeTransform( float* out, const float* const* components,
+                       uint32 index )
+{
+    float* o = out + index * 16;
+
+    float qx = components[3][index];
+    float qy = components[4][index];
+    float qz = components[5][index];
+    float qw = components[6][index];
+    float sx = components[7][index];
+    float sy = components[8][index];
+    float sz = components[9][index];
+
+    // the doubled quaternion products of the rotation matrix
+    float xx = qx * ( qx + qx );
+    float yy = qy * ( qy + qy );
+    float zz = qz * ( qz + qz );
+    float xy = qx * ( qy + qy );
+    float xz = qx * ( qz + qz );
+    float yz = qy * ( qz + qz );
+    float wx = qw * ( qx + qx );
+    float wy = qw * ( qy + qy );
+    float wz = qw * ( qz + qz );
+
+    o[0] = ( 1.0f - yy - zz ) * sx;
+    o[1] = ( xy + wz ) * sx;
+    o[2] = ( xz - wy ) * sx;
+    o[3] = 0.0f;
+    o[4] = ( xy - wz ) * sy;
+    o[5] = ( 1.0f - xx - zz ) * sy;
+    o[6] = ( yz + wx ) * sy;
+    o[7] = 0.0f;
+    o[8] = ( xz + wy ) * sz;
+    o[9] = ( yz - wx ) * sz;
+    o[10] = ( 1.0f - xx - yy ) * sz;
+    o[11] = 0.0f;
+    o[12] = components[0][index];
+    o[13] = components[1][index];
+    o[14] = components[2][index];
+    o[15] = 1.0f;
+}
+
+void composeTransformsScalar( float* out, const float* const* components,
+                              uint32 count )
+{
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        composeTransform( out, components, i );
+    }
+}
+
+/**
+ * Checks if the box at the given index of a batch is inside the planes.
+ */
+bool isBoxVisible( const float* planes, const float* const* boxes,
+                   uint32 index )
+{
+    float cx = boxes[0][index];
+    float cy = boxes[1][index];
+    float cz = boxes[2][index];
+    float ex = boxes[3][index];
+    float ey = boxes[4][index];
+    float ez = boxes[5][index];
+
+    // the box is outside when even its corner nearest the inside is behind
+    // a plane
+    for ( uint32 p = 0; p < SimdKernels::CULL_PLANES; ++p )
+    {
+        const float* plane = planes + p * 4;
+        float distance = plane[0] * cx + plane[1] * cy + plane[2] * cz +
+                         plane[3];
+        float reach = std::abs( plane[0] ) * ex + std::abs( plane[1] ) * ey +
+                      std::abs( plane[2] ) * ez;
+        if ( distance + reach < 0.0f )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Copies the planes with the absolute values of their normals, which weight
+ * the extents of a box by how far they reach towards each plane.
+ */
+void absolutePlanes( float* out, const float* planes )
+{
+    for ( uint32 i = 0; i < SimdKernels::CULL_PLANES * 4; ++i )
+    {
+        out[i] = std::abs( planes[i] );
+    }
+}
+
+uint32 cullBoxesScalar( uint32* visible, const float* planes,
+                        const float* const* boxes, uint32 count )
+{
+    uint32 visibleCount = 0;
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        visible[visibleCount] = i;
+        visibleCount += isBoxVisible( planes, boxes, i ) ? 1 : 0;
+    }
+    return visibleCount;
+}
+
+/**
+ * Finds the pixels of a rectangle that a triangle may cover.
+ * @return Whether there are any.
+ */
+bool clipTriangle( const float* triangle, const uint32* rect, uint32* area )
+{
+    area[0] = std::max( rect[0], static_cast<uint32>( triangle[12] ) );
+    area[1] = std::max( rect[1], static_cast<uint32>( triangle[13] ) );
+    area[2] = std::min( rect[2], static_cast<uint32>( triangle[14] ) + 1 );
+    area[3] = std::min( rect[3], static_cast<uint32>( triangle[15] ) + 1 );
+    return area[0] < area[2] && area[1] < area[3];
+}
+
+void rasterizeDepthScalar( float* depth, uint32 stride, const uint32* rect,
+                           const float* triangles, const uint32* indices,
+                           uint32 count )
+{
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        const float* t = triangles +
+                         indices[i] * SimdKernels::TRIANGLE_COMPONENTS;
+        uint32 area[4];
+        if ( !clipTriangle( t, rect, area ) )
+        {
+            continue;
+        }
+
+        for ( uint32 y = area[1]; y < area[3]; ++y )
+        {
+            float py = y + 0.5f;
+            float* row = depth + y * stride;
+            for ( uint32 x = area[0]; x < area[2]; ++x )
+            {
+                float px = x + 0.5f;
+                float e0 = t[0] * px + ( t[1] * py + t[2] );
+                float e1 = t[3] * px + ( t[4] * py + t[5] );
+                float e2 = t[6] * px + ( t[7] * py + t[8] );
+                if ( e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f )
+                {
+                    float z = t[9] * px + ( t[10] * py + t[11] );
+                    row[x] = std::min( row[x], z );
+                }
+            }
+        }
+    }
+}
+
+void fillScalar( uint32* out, uint32 value, uint32 count )
+{
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        out[i] = value;
+    }
+}
+
+#ifdef DEMO_ARCH_X86
+// SSE4.1 KERNELS
+DEMO_TARGET( "sse4.1" )
+void multiplyMatricesSse41( float* out, const float* left,
+                            const float* right, uint32 count )
+{
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        const float* a = left + i * 16;
+        const float* b = right + i * 16;
+        float* o = out + i * 16;
+
+        __m128 a0 = _mm_loadu_ps( a );
+        __m128 a1 = _mm_loadu_ps( a + 4 );
+        __m128 a2 = _mm_loadu_ps( a + 8 );
+        __m128 a3 = _mm_loadu_ps( a + 12 );
+
+        for ( uint32 column = 0; column < 16; column += 4 )
+        {
+            __m128 result = _mm_mul_ps( a0, _mm_set1_ps( b[column] ) );
+            result = _mm_add_ps( result, _mm_mul_ps(
+                a1, _mm_set1_ps( b[column + 1] ) ) );
+            result = _mm_add_ps( result, _mm_mul_ps(
+                a2, _mm_set1_ps( b[column + 2] ) ) );
+            result = _mm_add_ps( result, _mm_mul_ps(
+                a3, _mm_set1_ps( b[column + 3] ) ) );
+
+            _mm_storeu_ps( o + column, result );
+        }
+    }
+}
+
+/**
+ * Stores one column of four consecutive matrices from registers holding the
+ * column's x, y, z and w values of each matrix.
+ */
+DEMO_TARGET( "sse4.1" )
+inline void storeColumn( float* out, uint32 column, __m128 x, __m128 y,
+                         __m128 z, __m128 w )
+{
+    _MM_TRANSPOSE4_PS( x, y, z, w );
+
+    _mm_storeu_ps( out + column * 4, x );
+    _mm_storeu_ps( out + 16 + column * 4, y );
+    _mm_storeu_ps( out + 32 + column * 4, z );
+    _mm_storeu_ps( out + 48 + column * 4, w );
+}
+
+DEMO_TARGET( "sse4.1" )
+void composeTransformsSse41( float* out, const float* const* components,
+                             uint32 count )
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps( 1.0f );
+
+    uint32 i = 0;
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        __m128 qx = _mm_loadu_ps( components[3] + i );
+        __m128 qy = _mm_loadu_ps( components[4] + i );
+        __m128 qz = _mm_loadu_ps( components[5] + i );
+        __m128 qw = _mm_loadu_ps( components[6] + i );
+        __m128 sx = _mm_loadu_ps( components[7] + i );
+        __m128 sy = _mm_loadu_ps( components[8] + i );
+        __m128 sz = _mm_loadu_ps( components[9] + i );
+
+        __m128 x2 = _mm_add_ps( qx, qx );
+        __m128 y2 = _mm_add_ps( qy, qy );
+        __m128 z2 = _mm_add_ps( qz, qz );
+        __m128 xx = _mm_mul_ps( qx, x2 );
+        __m128 yy = _mm_mul_ps( qy, y2 );
+        __m128 zz = _mm_mul_ps( qz, z2 );
+        __m128 xy = _mm_mul_ps( qx, y2 );
+        __m128 xz = _mm_mul_ps( qx, z2 );
+        __m128 yz = _mm_mul_ps( qy, z2 );
+        __m128 wx = _mm_mul_ps( qw, x2 );
+        __m128 wy = _mm_mul_ps( qw, y2 );
+        __m128 wz = _mm_mul_ps( qw, z2 );
+
+        float* o = out + i * 16;
+        storeColumn( o, 0,
+            _mm_mul_ps( _mm_sub_ps( _mm_sub_ps( one, yy ), zz ), sx ),
+            _mm_mul_ps( _mm_add_ps( xy, wz ), sx ),
+            _mm_mul_ps( _mm_sub_ps( xz, wy ), sx ), zero );
+        storeColumn( o, 1,
+            _mm_mul_ps( _mm_sub_ps( xy, wz ), sy ),
+            _mm_mul_ps( _mm_sub_ps( _mm_sub_ps( one, xx ), zz ), sy ),
+            _mm_mul_ps( _mm_add_ps( yz, wx ), sy ), zero );
+        storeColumn( o, 2,
+            _mm_mul_ps( _mm_add_ps( xz, wy ), sz ),
+            _mm_mul_ps( _mm_sub_ps( yz, wx ), sz ),
+            _mm_mul_ps( _mm_sub_ps( _mm_sub_ps( one, xx ), yy ), sz ), zero );
+        storeColumn( o, 3, _mm_loadu_ps( components[0] + i ),
+                     _mm_loadu_ps( components[1] + i ),
+                     _mm_loadu_ps( components[2] + i ), one );
+    }
+
+    for ( ; i < count; ++i )
+    {
+        composeTransform( out, components, i );
+    }
+}
+
+DEMO_TARGET( "sse4.1" )
+uint32 cullBoxesSse41( uint32* visible, const float* planes,
+                       const float* const* boxes, uint32 count )
+{
+    const __m128 zero = _mm_setzero_ps();
+
+    float reaches[SimdKernels::CULL_PLANES * 4];
+    absolutePlanes( reaches, planes );
+
+    uint32 visibleCount = 0;
+    uint32 i = 0;
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        __m128 cx = _mm_loadu_ps( boxes[0] + i );
+        __m128 cy = _mm_loadu_ps( boxes[1] + i );
+        __m128 cz = _mm_loadu_ps( boxes[2] + i );
+        __m128 ex = _mm_loadu_ps( boxes[3] + i );
+        __m128 ey = _mm_loadu_ps( boxes[4] + i );
+        __m128 ez = _mm_loadu_ps( boxes[5] + i );
+
+        // test four boxes against one plane at a time, marking a box once
+        // any plane has it entirely behind
+        __m128 outside = zero;
+        for ( uint32 p = 0; p < SimdKernels::CULL_PLANES; ++p )
+        {
+            __m128 a = _mm_set1_ps( planes[p * 4] );
+            __m128 b = _mm_set1_ps( planes[p * 4 + 1] );
+            __m128 c = _mm_set1_ps( planes[p * 4 + 2] );
+            __m128 d = _mm_set1_ps( planes[p * 4 + 3] );
+
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps( _mm_mul_ps( a, cx ), _mm_mul_ps( b, cy ) ),
+                _mm_add_ps( _mm_mul_ps( c, cz ), d ) );
+            __m128 reach = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps( _mm_set1_ps( reaches[p * 4] ), ex ),
+                    _mm_mul_ps( _mm_set1_ps( reaches[p * 4 + 1] ), ey ) ),
+                _mm_mul_ps( _mm_set1_ps( reaches[p * 4 + 2] ), ez ) );
+
+            outside = _mm_or_ps( outside, _mm_cmplt_ps(
+                _mm_add_ps( distance, reach ), zero ) );
+        }
+
+        // append the inside indices without branching on them, unless
+        // they are all outside as is common for a run of nearby boxes
+        uint32 mask = ~_mm_movemask_ps( outside ) & 0xF;
+        if ( mask == 0 )
+        {
+            continue;
+        }
+
+        for ( uint32 lane = 0; lane < 4; ++lane )
+        {
+            visible[visibleCount] = i + lane;
+            visibleCount += ( mask >> lane ) & 1;
+        }
+    }
+
+    for ( ; i < count; ++i )
+    {
+        visible[visibleCount] = i;
+        visibleCount += isBoxVisible( planes, boxes, i ) ? 1 : 0;
+    }
+    return visibleCount;
+}
+
+DEMO_TARGET( "sse4.1" )
+void rasterizeDepthSse41( float* depth, uint32 stride, const uint32* rect,
+                          const float* triangles, const uint32* indices,
+                          uint32 count )
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 step = _mm_set1_ps( 4.0f );
+    const __m128 centers = _mm_setr_ps( 0.5f, 1.5f, 2.5f, 3.5f );
+
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        const float* t = triangles +
+                         indices[i] * SimdKernels::TRIANGLE_COMPONENTS;
+        uint32 area[4];
+        if ( !clipTriangle( t, rect, area ) )
+        {
+            continue;
+        }
+
+        // the spans start on a multiple of four, which stays in the rect
+        area[0] &= ~3u;
+
+        __m128 a0 = _mm_set1_ps( t[0] );
+        __m128 a1 = _mm_set1_ps( t[3] );
+        __m128 a2 = _mm_set1_ps( t[6] );
+        __m128 az = _mm_set1_ps( t[9] );
+        for ( uint32 y = area[1]; y < area[3]; ++y )
+        {
+            float py = y + 0.5f;
+            __m128 c0 = _mm_set1_ps( t[1] * py + t[2] );
+            __m128 c1 = _mm_set1_ps( t[4] * py + t[5] );
+            __m128 c2 = _mm_set1_ps( t[7] * py + t[8] );
+            __m128 cz = _mm_set1_ps( t[10] * py + t[11] );
+
+            float* row = depth + y * stride;
+            __m128 px = _mm_add_ps( _mm_set1_ps(
+                static_cast<float>( area[0] ) ), centers );
+            for ( uint32 x = area[0]; x < area[2]; x += 4 )
+            {
+                __m128 e0 = _mm_add_ps( _mm_mul_ps( a0, px ), c0 );
+                __m128 e1 = _mm_add_ps( _mm_mul_ps( a1, px ), c1 );
+                __m128 e2 = _mm_add_ps( _mm_mul_ps( a2, px ), c2 );
+                __m128 inside = _mm_and_ps(
+                    _mm_and_ps( _mm_cmpge_ps( e0, zero ),
+                                _mm_cmpge_ps( e1, zero ) ),
+                    _mm_cmpge_ps( e2, zero ) );
+
+                // spans the triangle misses are not touched
+                if ( _mm_movemask_ps( inside ) != 0 )
+                {
+                    __m128 z = _mm_add_ps( _mm_mul_ps( az, px ), cz );
+                    __m128 old = _mm_loadu_ps( row + x );
+                    _mm_storeu_ps( row + x, _mm_blendv_ps(
+                        old, _mm_min_ps( old, z ), inside ) );
+                }
+                px = _mm_add_ps( px, step );
+            }
+        }
+    }
+}
+
+DEMO_TARGET( "sse4.1" )
+void fillSse41( uint32* out, uint32 value, uint32 count )
+{
+    __m128i values = _mm_set1_epi32( static_cast<int32>( value ) );
+
+    uint32 i = 0;
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( out + i ), values );
+    }
+
+    for ( ; i < count; ++i )
+    {
+        out[i] = value;
+    }
+}
+
+// AVX2 KERNELS
+DEMO_TARGET( "avx2,fma" )
+void multiplyMatricesAvx2( float* out, const float* left,
+                           const float* right, uint32 count )
+{
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        const float* a = left + i * 16;
+        const float* b = right + i * 16;
+        float* o = out + i * 16;
+
+        // repeat each left column in both lanes
+        __m256 a0 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( a ) );
+        __m256 a1 = _mm256_broadcast_ps(
+            reinterpret_cast<const __m128*>( a + 4 ) );
+        __m256 a2 = _mm256_broadcast_ps(
+            reinterpret_cast<const __m128*>( a + 8 ) );
+        __m256 a3 = _mm256_broadcast_ps(
+            reinterpret_cast<const __m128*>( a + 12 ) );
+
+        // compute two output columns at a time, one per lane
+        for ( uint32 column = 0; column < 16; column += 8 )
+        {
+            __m256 columns = _mm256_loadu_ps( b + column );
+
+            __m256 result = _mm256_mul_ps(
+                a0, _mm256_permute_ps( columns, 0x00 ) );
+            result = _mm256_fmadd_ps(
+                a1, _mm256_permute_ps( columns, 0x55 ), result );
+            result = _mm256_fmadd_ps(
+                a2, _mm256_permute_ps( columns, 0xAA ), result );
+            result = _mm256_fmadd_ps(
+                a3, _mm256_permute_ps( columns, 0xFF ), result );
+
+            _mm256_storeu_ps( o + column, result );
+        }
+    }
+}
+
+/**
+ * Stores one column of eight consecutive matrices.
+ */
+DEMO_TARGET( "avx2,fma" )
+inline void storeColumn( float* out, uint32 column, __m256 x, __m256 y,
+                         __m256 z, __m256 w )
+{
+    storeColumn( out, column, _mm256_castps256_ps128( x ),
+                 _mm256_castps256_ps128( y ), _mm256_castps256_ps128( z ),
+                 _mm256_castps256_ps128( w ) );
+    storeColumn( out + 64, column, _mm256_extractf128_ps( x, 1 ),
+                 _mm256_extractf128_ps( y, 1 ), _mm256_extractf128_ps( z, 1 ),
+                 _mm256_extractf128_ps( w, 1 ) );
+}
+
+DEMO_TARGET( "avx2,fma" )
+void composeTransformsAvx2( float* out, const float* const* components,
+                            uint32 count )
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps( 1.0f );
+
+    uint32 i = 0;
+    for ( ; i + 8 <= count; i += 8 )
+    {
+        __m256 qx = _mm256_loadu_ps( components[3] + i );
+        __m256 qy = _mm256_loadu_ps( components[4] + i );
+        __m256 qz = _mm256_loadu_ps( components[5] + i );
+        __m256 qw = _mm256_loadu_ps( components[6] + i );
+        __m256 sx = _mm256_loadu_ps( components[7] + i );
+        __m256 sy = _mm256_loadu_ps( components[8] + i );
+        __m256 sz = _mm256_loadu_ps( components[9] + i );
+
+        __m256 x2 = _mm256_add_ps( qx, qx );
+        __m256 y2 = _mm256_add_ps( qy, qy );
+        __m256 z2 = _mm256_add_ps( qz, qz );
+        __m256 xx = _mm256_mul_ps( qx, x2 );
+        __m256 yy = _mm256_mul_ps( qy, y2 );
+        __m256 zz = _mm256_mul_ps( qz, z2 );
+        __m256 xy = _mm256_mul_ps( qx, y2 );
+        __m256 xz = _mm256_mul_ps( qx, z2 );
+        __m256 yz = _mm256_mul_ps( qy, z2 );
+        __m256 wx = _mm256_mul_ps( qw, x2 );
+        __m256 wy = _mm256_mul_ps( qw, y2 );
+        __m256 wz = _mm256_mul_ps( qw, z2 );
+
+        float* o = out + i * 16;
+        storeColumn( o, 0,
+            _mm256_mul_ps( _mm256_sub_ps( _mm256_sub_ps( one, yy ), zz ), sx ),
+            _mm256_mul_ps( _mm256_add_ps( xy, wz ), sx ),
+            _mm256_mul_ps( _mm256_sub_ps( xz, wy ), sx ), zero );
+        storeColumn( o, 1,
+            _mm256_mul_ps( _mm256_sub_ps( xy, wz ), sy ),
+            _mm256_mul_ps( _mm256_sub_ps( _mm256_sub_ps( one, xx ), zz ), sy ),
+            _mm256_mul_ps( _mm256_add_ps( yz, wx ), sy ), zero );
+        storeColumn( o, 2,
+            _mm256_mul_ps( _mm256_add_ps( xz, wy ), sz ),
+            _mm256_mul_ps( _mm256_sub_ps( yz, wx ), sz ),
+            _mm256_mul_ps( _mm256_sub_ps( _mm256_sub_ps( one, xx ), yy ), sz ),
+            zero );
+        storeColumn( o, 3, _mm256_loadu_ps( components[0] + i ),
+                     _mm256_loadu_ps( components[1] + i ),
+                     _mm256_loadu_ps( components[2] + i ), one );
+    }
+
+    for ( ; i < count; ++i )
+    {
+        composeTransform( out, components, i );
+    }
+}
+
+DEMO_TARGET( "avx2,fma" )
+uint32 cullBoxesAvx2( uint32* visible, const float* planes,
+                      const float* const* boxes, uint32 count )
+{
+    const __m256 zero = _mm256_setzero_ps();
+
+    float reaches[SimdKernels::CULL_PLANES * 4];
+    absolutePlanes( reaches, planes );
+
+    uint32 visibleCount = 0;
+    uint32 i = 0;
+    for ( ; i + 8 <= count; i += 8 )
+    {
+        __m256 cx = _mm256_loadu_ps( boxes[0] + i );
+        __m256 cy = _mm256_loadu_ps( boxes[1] + i );
+        __m256 cz = _mm256_loadu_ps( boxes[2] + i );
+        __m256 ex = _mm256_loadu_ps( boxes[3] + i );
+        __m256 ey = _mm256_loadu_ps( boxes[4] + i );
+        __m256 ez = _mm256_loadu_ps( boxes[5] + i );
+
+        __m256 outside = zero;
+        for ( uint32 p = 0; p < SimdKernels::CULL_PLANES; ++p )
+        {
+            __m256 a = _mm256_broadcast_ss( planes + p * 4 );
+            __m256 b = _mm256_broadcast_ss( planes + p * 4 + 1 );
+            __m256 c = _mm256_broadcast_ss( planes + p * 4 + 2 );
+            __m256 d = _mm256_broadcast_ss( planes + p * 4 + 3 );
+
+            __m256 distance = _mm256_fmadd_ps( a, cx, _mm256_fmadd_ps(
+                b, cy, _mm256_fmadd_ps( c, cz, d ) ) );
+            __m256 reach = _mm256_fmadd_ps(
+                _mm256_broadcast_ss( reaches + p * 4 ), ex, _mm256_fmadd_ps(
+                    _mm256_broadcast_ss( reaches + p * 4 + 1 ), ey,
+                    _mm256_mul_ps( _mm256_broadcast_ss( reaches + p * 4 + 2 ),
+                                   ez ) ) );
+
+            outside = _mm256_or_ps( outside, _mm256_cmp_ps(
+                _mm256_add_ps( distance, reach ), zero, _CMP_LT_OQ ) );
+        }
+
+        uint32 mask = ~_mm256_movemask_ps( outside ) & 0xFF;
+        if ( mask == 0 )
+        {
+            continue;
+        }
+
+        for ( uint32 lane = 0; lane < 8; ++lane )
+        {
+            visible[visibleCount] = i + lane;
+            visibleCount += ( mask >> lane ) & 1;
+        }
+    }
+
+    for ( ; i < count; ++i )
+    {
+        visible[visibleCount] = i;
+        visibleCount += isBoxVisible( planes, boxes, i ) ? 1 : 0;
+    }
+    return visibleCount;
+}
+
+DEMO_TARGET( "avx2,fma" )
+void rasterizeDepthAvx2( float* depth, uint32 stride, const uint32* rect,
+                         const float* triangles, const uint32* indices,
+                         uint32 count )
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 step = _mm256_set1_ps( 8.0f );
+    const __m256 centers = _mm256_setr_ps( 0.5f, 1.5f, 2.5f, 3.5f, 4.5f,
+                                           5.5f, 6.5f, 7.5f );
+
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        const float* t = triangles +
+                         indices[i] * SimdKernels::TRIANGLE_COMPONENTS;
+        uint32 area[4];
+        if ( !clipTriangle( t, rect, area ) )
+        {
+            continue;
+        }
+
+        // the spans start on a multiple of eight, which stays in the rect
+        area[0] &= ~7u;
+
+        __m256 a0 = _mm256_set1_ps( t[0] );
+        __m256 a1 = _mm256_set1_ps( t[3] );
+        __m256 a2 = _mm256_set1_ps( t[6] );
+        __m256 az = _mm256_set1_ps( t[9] );
+        for ( uint32 y = area[1]; y < area[3]; ++y )
+        {
+            float py = y + 0.5f;
+            __m256 c0 = _mm256_set1_ps( t[1] * py + t[2] );
+            __m256 c1 = _mm256_set1_ps( t[4] * py + t[5] );
+            __m256 c2 = _mm256_set1_ps( t[7] * py + t[8] );
+            __m256 cz = _mm256_set1_ps( t[10] * py + t[11] );
+
+            float* row = depth + y * stride;
+            __m256 px = _mm256_add_ps( _mm256_set1_ps(
+                static_cast<float>( area[0] ) ), centers );
+            for ( uint32 x = area[0]; x < area[2]; x += 8 )
+            {
+                __m256 inside = _mm256_and_ps(
+                    _mm256_and_ps(
+                        _mm256_cmp_ps( _mm256_fmadd_ps( a0, px, c0 ), zero,
+                                       _CMP_GE_OQ ),
+                        _mm256_cmp_ps( _mm256_fmadd_ps( a1, px, c1 ), zero,
+                                       _CMP_GE_OQ ) ),
+                    _mm256_cmp_ps( _mm256_fmadd_ps( a2, px, c2 ), zero,
+                                   _CMP_GE_OQ ) );
+
+                // spans the triangle misses are not touched
+                if ( _mm256_movemask_ps( inside ) != 0 )
+                {
+                    __m256 z = _mm256_fmadd_ps( az, px, cz );
+                    __m256 old = _mm256_loadu_ps( row + x );
+                    _mm256_storeu_ps( row + x, _mm256_blendv_ps(
+                        old, _mm256_min_ps( old, z ), inside ) );
+                }
+                px = _mm256_add_ps( px, step );
+            }
+        }
+    }
+}
+
+DEMO_TARGET( "avx2,fma" )
+void fillAvx2( uint32* out, uint32 value, uint32 count )
+{
+    __m256i values = _mm256_set1_epi32( static_cast<int32>( value ) );
+
+    uint32 i = 0;
+    for ( ; i + 8 <= count; i += 8 )
+    {
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( out + i ), values );
+    }
+
+    for ( ; i < count; ++i )
+    {
+        out[i] = value;
+    }
+}
+
+// AVX-512 KERNELS
+DEMO_TARGET( "avx512f" )
+void multiplyMatricesAvx512( float* out, const float* left,
+                             const float* right, uint32 count )
+{
+    for ( uint32 i = 0; i < count; ++i )
+    {
+        const float* a = left + i * 16;
+        const float* b = right + i * 16;
+        float* o = out + i * 16;
+
+        // repeat each left column in all four lanes; the zero-masked forms
+        // start from zero rather than an undefined register, which the
+        // compiler would warn may be used uninitialized
+        const __mmask16 ALL = 0xFFFF;
+        __m512 a0 = _mm512_maskz_broadcast_f32x4( ALL, _mm_loadu_ps( a ) );
+        __m512 a1 = _mm512_maskz_broadcast_f32x4( ALL,
+                                                  _mm_loadu_ps( a + 4 ) );
+        __m512 a2 = _mm512_maskz_broadcast_f32x4( ALL,
+                                                  _mm_loadu_ps( a + 8 ) );
+        __m512 a3 = _mm512_maskz_broadcast_f32x4( ALL,
+                                                  _mm_loadu_ps( a + 12 ) );
+
+        // compute every output column at once, one per lane
+        __m512 columns = _mm512_loadu_ps( b );
+
+        __m512 result = _mm512_mul_ps(
+            a0, _mm512_maskz_permute_ps( ALL, columns, 0x00 ) );
+        result = _mm512_fmadd_ps(
+            a1, _mm512_maskz_permute_ps( ALL, columns, 0x55 ), result );
+        result = _mm512_fmadd_ps(
+            a2, _mm512_maskz_permute_ps( ALL, columns, 0xAA ), result );
+        result = _mm512_fmadd_ps(
+            a3, _mm512_maskz_permute_ps( ALL, columns, 0xFF ), result );
+
+        _mm512_storeu_ps( o, result );
+    }
+}
+
+DEMO_TARGET( "avx512f" )
+void fillAvx512( uint32* out, uint32 value, uint32 count )
+{
+    __m512i values = _mm512_set1_epi32( static_cast<int32>( value ) );
+
+    uint32 i = 0;
+    for ( ; i + 16 <= count; i += 16 )
+    {
+        _mm512_storeu_si512( out + i, values );
+    }
+
+    // the last few words are written under a mask
+    if ( i < count )
+    {
+        __mmask16 rest = static_cast<__mmask16>( ( 1u << ( count - i ) ) - 1 );
+        _mm512_mask_storeu_epi32( out + i, rest, values );
+    }
+}
+#endif
+
+} // End nspc anonymous
+
+// GLOBALS
+#ifdef DEMO_ARCH_X86
+const Dispatch<SimdKernels::MultiplyMatricesFn>
+SimdKernels::g_multiplyMatrices( &multiplyMatricesScalar,
+                                 &multiplyMatricesSse41,
+                                 &multiplyMatricesAvx2,
+                                 &multiplyMatricesAvx512 );
+
+// the transpose to matrices bounds the batch, so AVX-512 adds nothing
+const Dispatch<SimdKernels::ComposeTransformsFn>
+SimdKernels::g_composeTransforms( &composeTransformsScalar,
+                                  &composeTransformsSse41,
+                                  &composeTransformsAvx2, nullptr );
+
+const Dispatch<SimdKernels::CullBoxesFn>
+SimdKernels::g_cullBoxes( &cullBoxesScalar, &cullBoxesSse41, &cullBoxesAvx2,
+                          nullptr );
+
+const Dispatch<SimdKernels::RasterizeDepthFn>
+SimdKernels::g_rasterizeDepth( &rasterizeDepthScalar, &rasterizeDepthSse41,
+                               &rasterizeDepthAvx2, nullptr );
+
+const Dispatch<SimdKernels::FillFn>
+SimdKernels::g_fill( &fillScalar, &fillSse41, &fillAvx2, &fillAvx512 );
+#else
+const Dispatch<SimdKernels::MultiplyMatricesFn>
+SimdKernels::g_multiplyMatrices( &multiplyMatricesScalar, nullptr, nullptr,
+                                 nullptr );
+
+const Dispatch<SimdKernels::ComposeTransformsFn>
+SimdKernels::g_composeTransforms( &composeTransformsScalar, nullptr, nullptr,
+                                  nullptr );
+
+const Dispatch<SimdKernels::CullBoxesFn>
+SimdKernels::g_cullBoxes( &cullBoxesScalar, nullptr, nullptr, nullptr );
+
+const Dispatch<SimdKernels::RasterizeDepthFn>
+SimdKernels::g_rasterizeDepth( &rasterizeDepthScalar, nullptr, nullptr,
+                               nullptr );
+
+const Dispatch<SimdKernels::FillFn>
+SimdKernels::g_fill( &fillScalar, nullptr, nullptr, nullptr );
+#endif
+
+} // End nspc util
+
+} // End nspc demo
@@ -0,0 +1,276 @@
+// simd_kernels.h
+//
+// Hot math kernels with an implementation per SIMD tier.
+//
+// Matrices are 4x4 single precision and column-major, the same layout as
+// glm::mat4, so arrays of glm::mat4 may be passed directly. Inputs that are
+// batched per component, such as transforms and boxes, are laid out in rows so
+// that consecutive items fill the lanes of a register, while triangles are
+// rasterized a span of pixels at a time, one pixel per lane. Fills set whole
+// registers of words at a time and back mem::MemoryUtils::set. Each kernel
+// chooses its implementation through a util::Dispatch table; the tables are
+// exposed so that benchmarks and tests can compare every tier.
+//
+#ifndef DEMO_SIMD_KERNELS_H
+#define DEMO_SIMD_KERNELS_H
+
+#include "demo/intdef.h"
+#include "demo/utility/dispatch.h"
+
+namespace demo
+{
+
+namespace util
+{
+
+class SimdKernels
+{
+  public:
+    // TYPES
+    /**
+     * Multiplies pairs of matrices.
+     */
+    typedef void ( *MultiplyMatricesFn )( float* out, const float* left,
+                                          const float* right, uint32 count );
+
+    /**
+     * Composes transformation matrices.
+     */
+    typedef void ( *ComposeTransformsFn )( float* out,
+                                           const float* const* components,
+                                           uint32 count );
+
+    /**
+     * Finds the boxes that are at least partly inside a set of planes.
+     */
+    typedef uint32 ( *CullBoxesFn )( uint32* visible, const float* planes,
+                                     const float* const* boxes,
+                                     uint32 count );
+
+    /**
+     * Rasterizes the depths of triangles into part of a depth buffer.
+     */
+    typedef void ( *RasterizeDepthFn )( float* depth, uint32 stride,
+                                        const uint32* rect,
+                                        const float* triangles,
+                                        const uint32* indices,
+                                        uint32 count );
+
+    /**
+     * Sets words of memory to a value.
+     */
+    typedef void ( *FillFn )( uint32* out, uint32 value, uint32 count );
+
+    // CONSTANTS
+    /**
+     * The number of rows of components of a transform.
+     */
+    static constexpr uint32 TRANSFORM_COMPONENTS = 10;
+
+    /**
+     * The number of rows of components of a box.
+     */
+    static constexpr uint32 BOX_COMPONENTS = 6;
+
+    /**
+     * The number of planes boxes are culled against.
+     */
+    static constexpr uint32 CULL_PLANES = 6;
+
+    /**
+     * The number of floats that describe a triangle to rasterize.
+     */
+    static constexpr uint32 TRIANGLE_COMPONENTS = 16;
+
+    /**
+     * The multiple of pixels the columns of rasterized rectangles are
+     * aligned to.
+     */
+    static constexpr uint32 RASTER_ALIGNMENT = 8;
+
+  private:
+    // GLOBALS
+    /**
+     * The implementations of multiplyMatrices.
+     */
+    static const Dispatch<MultiplyMatricesFn> g_multiplyMatrices;
+
+    /**
+     * The implementations of composeTransforms.
+     */
+    static const Dispatch<ComposeTransformsFn> g_composeTransforms;
+
+    /**
+     * The implementations of cullBoxes.
+     */
+    static const Dispatch<CullBoxesFn> g_cullBoxes;
+
+    /**
+     * The implementations of rasterizeDepth.
+     */
+    static const Dispatch<RasterizeDepthFn> g_rasterizeDepth;
+
+    /**
+     * The implementations of fill.
+     */
+    static const Dispatch<FillFn> g_fill;
+
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Computes out[i] = left[i] * right[i] for count matrices.
+     * The output must not overlap either input.
+     */
+    static void multiplyMatrices( float* out, const float* left,
+                                  const float* right, uint32 count );
+
+    /**
+     * Gets the implementations of multiplyMatrices.
+     */
+    static const Dispatch<MultiplyMatricesFn>& multiplyMatricesDispatch();
+
+    /**
+     * Computes out[i] = translate * rotate * scale for count transforms
+     * without forming the intermediate matrices.
+     *
+     * The components are TRANSFORM_COMPONENTS pointers to rows of count
+     * floats each: the position x, y and z, the rotation quaternion x, y, z
+     * and w, and the scale x, y and z.
+     */
+    static void composeTransforms( float* out,
+                                   const float* const* components,
+                                   uint32 count );
+
+    /**
+     * Gets the implementations of composeTransforms.
+     */
+    static const Dispatch<ComposeTransformsFn>& composeTransformsDispatch();
+
+    /**
+     * Writes the indices of the boxes that are not entirely behind any of
+     * CULL_PLANES planes to visible, in order, and returns how many there
+     * are. Visible must have room for count indices.
+     *
+     * The planes are groups of four floats ( a, b, c, d ) whose inner side
+     * is where a * x + b * y + c * z + d >= 0, as laid out by rndr::Frustum;
+     * they need not be normalized. The boxes are BOX_COMPONENTS pointers to
+     * rows of count floats each: the center x, y and z, and the distance
+     * from the center to the faces on x, y and z.
+     */
+    static uint32 cullBoxes( uint32* visible, const float* planes,
+                             const float* const* boxes, uint32 count );
+
+    /**
+     * Gets the implementations of cullBoxes.
+     */
+    static const Dispatch<CullBoxesFn>& cullBoxesDispatch();
+
+    /**
+     * Keeps the nearest of each pixel's depth and the depths of the
+     * triangles at the given indices that cover its center, for the pixels
+     * inside a rectangle of a depth buffer.
+     *
+     * The depth buffer is rows of stride floats. The rectangle is the first
+     * column and row and the column and row past the last, and its columns
+     * are multiples of RASTER_ALIGNMENT. Each triangle is
+     * TRIANGLE_COMPONENTS floats: three edge functions ( a, b, c ) that are
+     * all at least 0 where a * x + b * y + c is inside it, the depth plane
+     * ( a, b, c ) in the same form, and the first column, first row, last
+     * column and last row of the pixels it may cover. Pixel centers are at
+     * ( x + 0.5, y + 0.5 ).
+     */
+    static void rasterizeDepth( float* depth, uint32 stride,
+                                const uint32* rect, const float* triangles,
+                                const uint32* indices, uint32 count );
+
+    /**
+     * Gets the implementations of rasterizeDepth.
+     */
+    static const Dispatch<RasterizeDepthFn>& rasterizeDepthDispatch();
+
+    /**
+     * Sets out[i] = value for count words.
+     */
+    static void fill( uint32* out, uint32 value, uint32 count );
+
+    /**
+     * Gets the implementations of fill.
+     */
+    static const Dispatch<FillFn>& fillDispatch();
+};
+
+// UTILITY FUNCTIONS
+inline
+void SimdKernels::multiplyMatrices( float* out, const float* left,
+                                    const float* right, uint32 count )
+{
+    g_multiplyMatrices.get()( out, left, right, count );
+}
+
+inline
+const Dispatch<SimdKernels::MultiplyMatricesFn>&
+SimdKernels::multiplyMatricesDispatch()
+{
+    return g_multiplyMatrices;
+}
+
+inline
+void SimdKernels::composeTransforms( float* out,
+                                     const float* const* components,
+                                     uint32 count )
+{
+    g_composeTransforms.get()( out, components, count );
+}
+
+inline
+const Dispatch<SimdKernels::ComposeTransformsFn>&
+SimdKernels::composeTransformsDispatch()
+{
+    return g_composeTransforms;
+}
+
+inline
+uint32 SimdKernels::cullBoxes( uint32* visible, const float* planes,
+                               const float* const* boxes, uint32 count )
+{
+    return g_cullBoxes.get()( visible, planes, boxes, count );
+}
+
+inline
+const Dispatch<SimdKernels::CullBoxesFn>& SimdKernels::cullBoxesDispatch()
+{
+    return g_cullBoxes;
+}
+
+inline
+void SimdKernels::rasterizeDepth( float* depth, uint32 stride,
+                                  const uint32* rect, const float* triangles,
+                                  const uint32* indices, uint32 count )
+{
+    g_rasterizeDepth.get()( depth, stride, rect, triangles, indices, count );
+}
+
+inline
+const Dispatch<SimdKernels::RasterizeDepthFn>&
+SimdKernels::rasterizeDepthDispatch()
+{
+    return g_rasterizeDepth;
+}
+
+inline
+void SimdKernels::fill( uint32* out, uint32 value, uint32 count )
+{
+    g_fill.get()( out, value, count );
+}
+
+inline
+const Dispatch<SimdKernels::FillFn>& SimdKernels::fillDispatch()
+{
+    return g_fill;
+}
+
+} // End nspc util
+
+} // End nspc demo
+
+#endif // DEMO_SIMD_KERNELS_H
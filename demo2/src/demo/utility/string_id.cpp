@@ -0,0 +1,90 @@
+// string_id.cpp
+#include "demo/utility/string_id.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace demo
+{
+
+namespace util
+{
+
+// CONSTANTS
+constexpr Size StringId::POOL_BLOCK_SIZE;
+
+// CONSTRUCTORS
+StringId::StringId( const char* value )
+    : _id( intern( value, strlen( value ) ) )
+{
+}
+
+// ACCESSOR FUNCTIONS
+const char* StringId::str() const
+{
+    Pool& strings = pool();
+    std::lock_guard<std::mutex> lock( strings.mutex );
+
+    return strings.strings.has( _id ) ? strings.strings[_id] : nullptr;
+}
+
+// HELPER FUNCTIONS
+StringId::Pool& StringId::pool()
+{
+    // never destroyed so ids stay printable during shutdown
+    static Pool* instance = new Pool();
+    return *instance;
+}
+
+uint64 StringId::intern( const char* value, Size length )
+{
+    uint64 id = HashUtils::fnv1a64( value, length );
+
+    Pool& strings = pool();
+    std::lock_guard<std::mutex> lock( strings.mutex );
+
+    if ( strings.strings.has( id ) )
+    {
+        #ifndef NDEBUG
+        const char* existing = strings.strings[id];
+        if ( strlen( existing ) != length ||
+             memcmp( existing, value, length ) != 0 )
+        {
+            fprintf( stderr, "StringId collision: \"%s\" and \"%.*s\"\n",
+                     existing, static_cast<int>( length ), value );
+            assert( false );
+        }
+        #endif
+
+        return id;
+    }
+
+    // copy the string into the current block, long strings get their own
+    char* copy;
+    if ( length + 1 > POOL_BLOCK_SIZE / 4 )
+    {
+        copy = new char[length + 1];
+    }
+    else
+    {
+        if ( strings.remaining < length + 1 )
+        {
+            strings.block = new char[POOL_BLOCK_SIZE];
+            strings.remaining = POOL_BLOCK_SIZE;
+        }
+
+        copy = strings.block;
+        strings.block += length + 1;
+        strings.remaining -= length + 1;
+    }
+
+    memcpy( copy, value, length );
+    copy[length] = '\0';
+    strings.strings.put( id, copy );
+
+    return id;
+}
+
+} // End nspc util
+
+} // End nspc demo
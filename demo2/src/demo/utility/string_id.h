@@ -0,0 +1,213 @@
+// string_id.h
+//
+// An interned string identifier.
+//
+// A string id is the 64-bit hash of a string. Comparing two ids compares two
+// integers and maps keyed by ids never touch the characters. Ids created from
+// strings at run-time register the string in a global pool so that it can be
+// recovered for logging. Ids of literals can be computed at compile-time with
+// csid, and can be resolved back to their string once the same string has
+// been interned at run-time.
+//
+// Debug builds check every interned string against the pool and report two
+// different strings that hash to the same id.
+//
+#ifndef DEMO_STRING_ID_H
+#define DEMO_STRING_ID_H
+
+#include <mutex>
+
+#include "demo/container/map.h"
+#include "demo/intdef.h"
+#include "demo/strdef.h"
+#include "demo/utility/hash_utils.h"
+#include "demo/utility/hasher.h"
+
+/**
+ * csid computes the string id of a string literal at compile-time.
+ *
+ * The string is not added to the pool.
+ */
+#define csid( string ) \
+demo::util::StringId( demo::util::HashUtils::compileTimeHash64( string ) )
+
+namespace demo
+{
+
+namespace util
+{
+
+class StringId
+{
+  private:
+    // TYPES
+    /**
+     * The interned strings.
+     */
+    struct Pool
+    {
+        std::mutex mutex;
+        cntr::Map<uint64, const char*> strings;
+        char* block;
+        Size remaining;
+    };
+
+    // CONSTANTS
+    /**
+     * The size of the blocks that interned strings are copied into.
+     */
+    static constexpr Size POOL_BLOCK_SIZE = 4096;
+
+    // MEMBERS
+    /**
+     * The hash of the string.
+     */
+    uint64 _id;
+
+    // HELPER FUNCTIONS
+    /**
+     * Get the global string pool.
+     * This is created on first use so ids can be interned during static
+     * initialization.
+     * @return The pool.
+     */
+    static Pool& pool();
+
+    /**
+     * Add a string to the pool.
+     * @param value The characters.
+     * @param length The number of characters.
+     * @return The id.
+     */
+    static uint64 intern( const char* value, Size length );
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct an empty StringId.
+     */
+    constexpr StringId();
+
+    /**
+     * Construct a StringId from a precomputed id.
+     * This does not add a string to the pool.
+     * @param id The id.
+     */
+    constexpr explicit StringId( uint64 id );
+
+    /**
+     * Construct a StringId by interning a string.
+     * @param value The null terminated string.
+     */
+    explicit StringId( const char* value );
+
+    /**
+     * Construct a StringId by interning a string.
+     * @param value The string.
+     */
+    explicit StringId( const String& value );
+
+    // OPERATORS
+    /**
+     * Check if two ids are equal.
+     * @param other The other id.
+     * @return True if they are equal.
+     */
+    constexpr bool operator==( const StringId& other ) const;
+
+    /**
+     * Check if two ids are not equal.
+     * @param other The other id.
+     * @return True if they are not equal.
+     */
+    constexpr bool operator!=( const StringId& other ) const;
+
+    /**
+     * Order two ids by their value.
+     * @param other The other id.
+     * @return True if this orders before the other.
+     */
+    constexpr bool operator<( const StringId& other ) const;
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the id.
+     * @return The id.
+     */
+    constexpr uint64 id() const;
+
+    /**
+     * Check if this is the empty id.
+     * @return True if empty.
+     */
+    constexpr bool isEmpty() const;
+
+    /**
+     * Get the string that the id was created from.
+     * @return The string or null if it was never interned.
+     */
+    const char* str() const;
+};
+
+// CONSTRUCTORS
+inline
+constexpr StringId::StringId() : _id( 0 )
+{
+}
+
+inline
+constexpr StringId::StringId( uint64 id ) : _id( id )
+{
+}
+
+inline
+StringId::StringId( const String& value )
+    : _id( intern( value.data(), value.length() ) )
+{
+}
+
+// OPERATORS
+inline
+constexpr bool StringId::operator==( const StringId& other ) const
+{
+    return _id == other._id;
+}
+
+inline
+constexpr bool StringId::operator!=( const StringId& other ) const
+{
+    return _id != other._id;
+}
+
+inline
+constexpr bool StringId::operator<( const StringId& other ) const
+{
+    return _id < other._id;
+}
+
+// ACCESSOR FUNCTIONS
+inline
+constexpr uint64 StringId::id() const
+{
+    return _id;
+}
+
+inline
+constexpr bool StringId::isEmpty() const
+{
+    return _id == 0;
+}
+
+// SPECIALIZATIONS
+template <>
+inline
+uint64 Hasher<StringId>::hash64( const StringId& value )
+{
+    return HashUtils::mix64( value.id() );
+}
+
+} // End nspc util
+
+} // End nspc demo
+
+#endif // DEMO_STRING_ID_H
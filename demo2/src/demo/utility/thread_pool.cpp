@@ -0,0 +1,125 @@
+// thread_pool.cpp
+#include "demo/utility/thread_pool.h"
+
+namespace demo
+{
+
+namespace util
+{
+
+// CONSTRUCTORS
+ThreadPool::ThreadPool( uint32 threadCount )
+    : _threads( nullptr ), _threadCount( threadCount ), _invoke( nullptr ),
+      _task( nullptr ), _taskCount( 0 ), _scope( nullptr ), _nextTask( 0 ),
+      _activeCount( 0 ), _batch( 0 ), _isStopping( false )
+{
+    if ( _threadCount > 0 )
+    {
+        _threads = new std::thread[_threadCount];
+        for ( uint32 i = 0; i < _threadCount; ++i )
+        {
+            _threads[i] = std::thread( &ThreadPool::work, this );
+        }
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _isStopping = true;
+    }
+
+    _wake.notify_all();
+    for ( uint32 i = 0; i < _threadCount; ++i )
+    {
+        _threads[i].join();
+    }
+
+    delete[] _threads;
+}
+
+// HELPER FUNCTIONS
+void ThreadPool::runTasks( InvokeFn invoke, const void* task,
+                           uint32 taskCount )
+{
+    uint32 index = _nextTask.fetch_add( 1, std::memory_order_relaxed );
+    while ( index < taskCount )
+    {
+        invoke( task, index );
+        index = _nextTask.fetch_add( 1, std::memory_order_relaxed );
+    }
+}
+
+void ThreadPool::run( InvokeFn invoke, const void* task, uint32 taskCount )
+{
+    {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _invoke = invoke;
+        _task = task;
+        _taskCount = taskCount;
+        _scope = mem::NoAllocScope::active();
+        _nextTask.store( 0, std::memory_order_relaxed );
+        ++_batch;
+    }
+
+    _wake.notify_all();
+    runTasks( invoke, task, taskCount );
+
+    // every task has been claimed, but a worker may still be running one,
+    // and a worker that joins late must leave before the next batch reuses
+    // the counter
+    std::unique_lock<std::mutex> lock( _mutex );
+    _done.wait( lock, [this]() { return _activeCount == 0; } );
+    _task = nullptr;
+    _taskCount = 0;
+    _scope = nullptr;
+}
+
+void ThreadPool::work()
+{
+    uint64 batch = 0;
+
+    std::unique_lock<std::mutex> lock( _mutex );
+    while ( true )
+    {
+        _wake.wait( lock, [this, batch]() {
+            return _isStopping || ( _batch != batch && _task != nullptr );
+        } );
+
+        if ( _isStopping )
+        {
+            return;
+        }
+
+        batch = _batch;
+        InvokeFn invoke = _invoke;
+        const void* task = _task;
+        uint32 taskCount = _taskCount;
+        mem::NoAllocScope* scope = _scope;
+        ++_activeCount;
+
+        // allocations made for the caller count against its guard
+        lock.unlock();
+        mem::NoAllocScope* previous = mem::NoAllocScope::setActive( scope );
+        runTasks( invoke, task, taskCount );
+        mem::NoAllocScope::setActive( previous );
+        lock.lock();
+
+        if ( --_activeCount == 0 )
+        {
+            _done.notify_one();
+        }
+    }
+}
+
+// UTILITY FUNCTIONS
+uint32 ThreadPool::defaultThreadCount()
+{
+    uint32 cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+}
+
+} // End nspc util
+
+} // End nspc demo
@@ -0,0 +1,217 @@
+// thread_pool.h
+//
+// A fixed set of worker threads that run batches of indexed tasks.
+//
+// A batch is started with parallelFor, which hands out task indices to the
+// workers and the calling thread until every task has run and then returns.
+// Tasks are claimed one at a time from a shared counter, so uneven tasks
+// balance themselves as long as there are a few more tasks than threads.
+//
+// Only one batch runs at a time and parallelFor must not be called from
+// inside a task.
+//
+// A worker runs the tasks of a batch under the calling thread's
+// mem::NoAllocScope, so allocations made by tasks count against the caller's
+// guard wherever they run.
+//
+#ifndef DEMO_THREAD_POOL_H
+#define DEMO_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "demo/intdef.h"
+#include "demo/memory/no_alloc_scope.h"
+
+namespace demo
+{
+
+namespace util
+{
+
+class ThreadPool
+{
+  private:
+    // TYPES
+    /**
+     * Runs one task of a batch.
+     */
+    typedef void (*InvokeFn)( const void* task, uint32 index );
+
+    // MEMBERS
+    /**
+     * The worker threads.
+     */
+    std::thread* _threads;
+
+    /**
+     * The number of worker threads.
+     */
+    uint32 _threadCount;
+
+    /**
+     * Guards the batch while it is being started and finished.
+     */
+    std::mutex _mutex;
+
+    /**
+     * Wakes the workers when a batch starts or the pool stops.
+     */
+    std::condition_variable _wake;
+
+    /**
+     * Wakes the caller when the last worker leaves a batch.
+     */
+    std::condition_variable _done;
+
+    /**
+     * Runs a task of the current batch.
+     */
+    InvokeFn _invoke;
+
+    /**
+     * The current batch.
+     */
+    const void* _task;
+
+    /**
+     * The number of tasks in the current batch.
+     */
+    uint32 _taskCount;
+
+    /**
+     * The scope guarding the thread that started the current batch.
+     */
+    mem::NoAllocScope* _scope;
+
+    /**
+     * The next task index to hand out.
+     */
+    std::atomic<uint32> _nextTask;
+
+    /**
+     * The number of workers still inside the current batch.
+     */
+    uint32 _activeCount;
+
+    /**
+     * Incremented for every batch so workers can tell it is new.
+     */
+    uint64 _batch;
+
+    /**
+     * Whether the workers should exit.
+     */
+    bool _isStopping;
+
+    // HELPER FUNCTIONS
+    /**
+     * Run a task through its real type.
+     */
+    template <typename Function>
+    static void invoke( const void* task, uint32 index );
+
+    /**
+     * Claim and run tasks of the current batch until none are left.
+     */
+    void runTasks( InvokeFn invoke, const void* task, uint32 taskCount );
+
+    /**
+     * Run a batch of tasks on the workers and this thread.
+     */
+    void run( InvokeFn invoke, const void* task, uint32 taskCount );
+
+    /**
+     * Wait for batches and run them until the pool stops.
+     */
+    void work();
+
+    // HIDDEN FUNCTIONS
+    ThreadPool( const ThreadPool& other ) = delete;
+
+    ThreadPool& operator=( const ThreadPool& other ) = delete;
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Construct a pool with the given number of worker threads.
+     * The thread that starts a batch also runs its tasks, so a pool with no
+     * workers runs everything on the caller.
+     * @param threadCount The number of worker threads.
+     */
+    explicit ThreadPool( uint32 threadCount );
+
+    /**
+     * Stop and join the worker threads.
+     */
+    ~ThreadPool();
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Get the number of worker threads.
+     * @return The thread count.
+     */
+    uint32 threadCount() const;
+
+    // MEMBER FUNCTIONS
+    /**
+     * Call a function once for every index from zero to the task count and
+     * return once every call has finished.
+     * @param taskCount The number of tasks.
+     * @param task The function, which takes the task index.
+     */
+    template <typename Function>
+    void parallelFor( uint32 taskCount, const Function& task );
+
+    // UTILITY FUNCTIONS
+    /**
+     * Get the number of worker threads that keeps every core busy alongside
+     * the calling thread.
+     * @return The thread count.
+     */
+    static uint32 defaultThreadCount();
+};
+
+// HELPER FUNCTIONS
+template <typename Function>
+void ThreadPool::invoke( const void* task, uint32 index )
+{
+    ( *static_cast<const Function*>( task ) )( index );
+}
+
+// ACCESSOR FUNCTIONS
+inline
+uint32 ThreadPool::threadCount() const
+{
+    return _threadCount;
+}
+
+// MEMBER FUNCTIONS
+template <typename Function>
+void ThreadPool::parallelFor( uint32 taskCount, const Function& task )
+{
+    if ( taskCount == 0 )
+    {
+        return;
+    }
+
+    // a single task is not worth waking anyone for
+    if ( taskCount == 1 || _threadCount == 0 )
+    {
+        for ( uint32 i = 0; i < taskCount; ++i )
+        {
+            task( i );
+        }
+        return;
+    }
+
+    run( &ThreadPool::invoke<Function>, &task, taskCount );
+}
+
+} // End nspc util
+
+} // End nspc demo
+
+#endif // DEMO_THREAD_POOL_H
@@ -0,0 +1,34 @@
+// checker.cpp
+#include "checker.h"
+
+namespace demo
+{
+
+namespace test
+{
+
+// MEMBER FUNCTIONS
+bool Checker::check( bool holds, const char* condition, const char* file,
+                     uint32 line )
+{
+    ++_checkCount;
+    if ( !holds )
+    {
+        ++_failureCount;
+        fprintf( stderr, "%s:%u: %s: check failed: %s\n", file, line, _suite,
+                 condition );
+    }
+
+    return holds;
+}
+
+void Checker::writeSummary( FILE* file ) const
+{
+    fprintf( file, "%llu check(s), %llu failure(s)\n",
+             static_cast<unsigned long long>( _checkCount ),
+             static_cast<unsigned long long>( _failureCount ) );
+}
+
+} // End nspc test
+
+} // End nspc demo
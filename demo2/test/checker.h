@@ -0,0 +1,133 @@
+// checker.h
+//
+// A small self-contained set of checks.
+//
+// A check suite is a function that sets up its own state and states what
+// must hold with DEMO_CHECK. Every failed check is printed with its file and
+// line as soon as it fails, and the summary counts the checks and failures of
+// the run so that the test executable can exit non-zero.
+//
+#ifndef DEMO_TEST_CHECKER_H
+#define DEMO_TEST_CHECKER_H
+
+#include <stdio.h>
+
+#include "demo/intdef.h"
+
+/**
+ * Checks that a condition holds, printing it when it does not.
+ */
+#define DEMO_CHECK( checker, condition ) \
+( checker ).check( ( condition ), #condition, __FILE__, __LINE__ )
+
+namespace demo
+{
+
+namespace test
+{
+
+class Checker
+{
+  private:
+    // MEMBERS
+    /**
+     * The suite that checks belong to.
+     */
+    const char* _suite;
+
+    /**
+     * The number of checks made.
+     */
+    uint64 _checkCount;
+
+    /**
+     * The number of checks that failed.
+     */
+    uint64 _failureCount;
+
+    /**
+     * Constructs a copy of the given checker.
+     *
+     * This is not a supported operation for checkers.
+     */
+    Checker( const Checker& other );
+
+    /**
+     * Assigns this as a copy of the other checker.
+     *
+     * This is not a supported operation for checkers.
+     */
+    Checker& operator=( const Checker& other );
+
+  public:
+    // CONSTRUCTORS
+    /**
+     * Constructs a checker with no checks made.
+     */
+    Checker();
+
+    // ACCESSOR FUNCTIONS
+    /**
+     * Gets the number of checks made.
+     */
+    uint64 checkCount() const;
+
+    /**
+     * Gets the number of checks that failed.
+     */
+    uint64 failureCount() const;
+
+    // MUTATOR FUNCTIONS
+    /**
+     * Sets the suite that checks belong to.
+     *
+     * The name must outlive the checks.
+     */
+    void setSuite( const char* suite );
+
+    // MEMBER FUNCTIONS
+    /**
+     * Records a check, printing the condition when it does not hold.
+     *
+     * This is called by DEMO_CHECK and should not be called directly.
+     */
+    bool check( bool holds, const char* condition, const char* file,
+                uint32 line );
+
+    /**
+     * Writes the number of checks and failures.
+     */
+    void writeSummary( FILE* file ) const;
+};
+
+// CONSTRUCTORS
+inline
+Checker::Checker() : _suite( "" ), _checkCount( 0 ), _failureCount( 0 )
+{
+}
+
+// ACCESSOR FUNCTIONS
+inline
+uint64 Checker::checkCount() const
+{
+    return _checkCount;
+}
+
+inline
+uint64 Checker::failureCount() const
+{
+    return _failureCount;
+}
+
+// MUTATOR FUNCTIONS
+inline
+void Checker::setSuite( const char* suite )
+{
+    _suite = suite;
+}
+
+} // End nspc test
+
+} // End nspc demo
+
+#endif // DEMO_TEST_CHECKER_H
@@ -0,0 +1,28 @@
+#include <stdio.h>
+
+#include "checker.h"
+#include "occlusion_test.h"
+
+#include "demo/utility/cpu_features.h"
+
+int main( int argc, char** argv )
+{
+    using namespace demo;
+
+    if ( argc > 1 )
+    {
+        fprintf( stderr, "usage: demo_test\n" );
+        return 1;
+    }
+
+    util::CpuFeatures::describe( stderr );
+
+    // run checks
+    test::Checker checker;
+    test::OcclusionTest::run( checker );
+
+    // report results
+    checker.writeSummary( stderr );
+
+    return checker.failureCount() == 0 ? 0 : 1;
+}
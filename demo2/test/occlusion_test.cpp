@@ -0,0 +1,507 @@
+// occlusion_test.cpp
+#include "occlusion_test.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+#include "demo/container/dynamic_array.h"
+#include "demo/render/occluder.h"
+#include "demo/render/occlusion_culler.h"
+#include "demo/utility/cpu_features.h"
+#include "demo/utility/hash_utils.h"
+#include "demo/utility/simd_kernels.h"
+#include "demo/utility/thread_pool.h"
+
+namespace demo
+{
+
+namespace test
+{
+
+namespace
+{
+
+// CONSTANTS
+/**
+ * The depth window depths may differ by and still be the same.
+ */
+constexpr float DEPTH_TOLERANCE = 1e-5f;
+
+/**
+ * The number of random boxes the tiers are compared with.
+ */
+constexpr uint32 RANDOM_BOXES = 2000;
+
+/**
+ * The number of random occluders the tiers are compared with.
+ */
+constexpr uint32 RANDOM_OCCLUDERS = 24;
+
+/**
+ * The number of random triangles the rasterizer tiers are compared with.
+ */
+constexpr uint32 RANDOM_TRIANGLES = 500;
+
+// HELPER FUNCTIONS
+/**
+ * Gets a pseudo-random value from 0 to 1.
+ */
+float random( uint64 seed )
+{
+    return static_cast<float>( util::HashUtils::mix64( seed ) & 0xFFFF ) /
+           65535.0f;
+}
+
+/**
+ * Builds an occluder of a single quad from its corners in order around it.
+ */
+void buildQuad( rndr::Occluder& occluder, const glm::vec3& a,
+                const glm::vec3& b, const glm::vec3& c, const glm::vec3& d )
+{
+    cntr::DynamicArray<glm::vec3> positions;
+    positions.push( a );
+    positions.push( b );
+    positions.push( c );
+    positions.push( d );
+
+    const uint32 INDICES[] = { 0, 1, 2, 0, 2, 3 };
+    cntr::DynamicArray<uint32> indices;
+    for ( uint32 i = 0; i < 6; ++i )
+    {
+        indices.push( INDICES[i] );
+    }
+
+    occluder.build( positions, indices );
+}
+
+/**
+ * Builds an occluder of a quad facing the camera at a depth.
+ */
+void buildQuad( rndr::Occluder& occluder, float x0, float y0, float x1,
+                float y1, float z )
+{
+    buildQuad( occluder, glm::vec3( x0, y0, z ), glm::vec3( x1, y0, z ),
+               glm::vec3( x1, y1, z ), glm::vec3( x0, y1, z ) );
+}
+
+/**
+ * Gets the perspective projection the quad checks look through, from the
+ * origin down the negative z axis.
+ */
+glm::mat4 perspective()
+{
+    return glm::perspective( glm::radians( 60.0f ), 2.0f, 0.1f, 100.0f );
+}
+
+/**
+ * Gets the world x coordinate of a column of the depth buffer under the
+ * identity view projection, where the whole buffer is -1 to 1.
+ */
+float columnX( const rndr::OcclusionCuller& culler, float column )
+{
+    return column / culler.width() * 2.0f - 1.0f;
+}
+
+/**
+ * Gets the world y coordinate of a row of the depth buffer under the
+ * identity view projection.
+ */
+float rowY( const rndr::OcclusionCuller& culler, float row )
+{
+    return row / culler.height() * 2.0f - 1.0f;
+}
+
+/**
+ * Checks if a box over a rectangle of pixels is hidden under the identity
+ * view projection.
+ */
+bool isPixelBoxHidden( const rndr::OcclusionCuller& culler, float x0,
+                       float y0, float x1, float y1, float z )
+{
+    glm::vec3 min( columnX( culler, x0 ), rowY( culler, y0 ), z - 0.1f );
+    glm::vec3 max( columnX( culler, x1 ), rowY( culler, y1 ), z + 0.1f );
+    return culler.isHidden( ( min + max ) * 0.5f, ( max - min ) * 0.5f );
+}
+
+/**
+ * Checks a quad in front of the camera against boxes around it.
+ */
+void checkQuad( Checker& checker )
+{
+    rndr::Occluder quad;
+    buildQuad( quad, -5.0f, -5.0f, 5.0f, 5.0f, -10.0f );
+    DEMO_CHECK( checker, quad.triangleCount() == 2 );
+
+    rndr::OcclusionCuller culler;
+    culler.begin( perspective() );
+    culler.addOccluder( quad, glm::mat4( 1.0f ) );
+
+    // nothing is hidden until the occluders are rasterized
+    DEMO_CHECK( checker, !culler.isHidden( glm::vec3( 0.0f, 0.0f, -20.0f ),
+                                           glm::vec3( 1.0f ) ) );
+
+    culler.rasterize();
+    DEMO_CHECK( checker, culler.triangleCount() == 2 );
+
+    // behind it
+    DEMO_CHECK( checker, culler.isHidden( glm::vec3( 0.0f, 0.0f, -20.0f ),
+                                          glm::vec3( 1.0f ) ) );
+    DEMO_CHECK( checker, culler.isHidden( glm::vec3( 6.0f, -6.0f, -20.0f ),
+                                          glm::vec3( 1.0f ) ) );
+
+    // in front of it, touching it and beside it
+    DEMO_CHECK( checker, !culler.isHidden( glm::vec3( 0.0f, 0.0f, -5.0f ),
+                                           glm::vec3( 1.0f ) ) );
+    DEMO_CHECK( checker, !culler.isHidden( glm::vec3( 0.0f, 0.0f, -10.5f ),
+                                           glm::vec3( 1.0f ) ) );
+    DEMO_CHECK( checker, !culler.isHidden( glm::vec3( 12.0f, 0.0f, -20.0f ),
+                                           glm::vec3( 1.0f ) ) );
+
+    // through the near plane, from behind the camera to behind the quad
+    DEMO_CHECK( checker,
+                !culler.isHidden( glm::vec3( 0.0f, 0.0f, -12.5f ),
+                                  glm::vec3( 0.5f, 0.5f, 17.5f ) ) );
+    DEMO_CHECK( checker, !culler.isHidden( glm::vec3( 0.0f, 0.0f, 0.0f ),
+                                           glm::vec3( 1.0f ) ) );
+
+    // cull keeps what is left in order
+    const float BOXES[][6] = { { 0.0f, 0.0f, -20.0f, 1.0f, 1.0f, 1.0f },
+                               { 0.0f, 0.0f, -5.0f, 1.0f, 1.0f, 1.0f },
+                               { 0.0f, 0.0f, -30.0f, 2.0f, 2.0f, 2.0f },
+                               { 12.0f, 0.0f, -20.0f, 1.0f, 1.0f, 1.0f } };
+    const uint32 BOX_COUNT = sizeof( BOXES ) / sizeof( BOXES[0] );
+
+    float components[util::SimdKernels::BOX_COMPONENTS][BOX_COUNT];
+    const float* rows[util::SimdKernels::BOX_COMPONENTS];
+    for ( uint32 row = 0; row < util::SimdKernels::BOX_COMPONENTS; ++row )
+    {
+        for ( uint32 i = 0; i < BOX_COUNT; ++i )
+        {
+            components[row][i] = BOXES[i][row];
+        }
+        rows[row] = components[row];
+    }
+
+    uint32 visible[BOX_COUNT] = { 0, 1, 2, 3 };
+    uint32 visibleCount = culler.cull( visible, BOX_COUNT, rows );
+    DEMO_CHECK( checker, visibleCount == 2 );
+    DEMO_CHECK( checker, visible[0] == 1 && visible[1] == 3 );
+}
+
+/**
+ * Checks that the levels built from tiles are conservative where the tiles
+ * meet.
+ */
+void checkTileEdges( Checker& checker )
+{
+    rndr::OcclusionCuller culler;
+    const uint32 TILE = rndr::OcclusionCuller::TILE_SIZE;
+    uint32 tileLevel = 0;
+    while ( ( 1u << tileLevel ) < TILE )
+    {
+        ++tileLevel;
+    }
+
+    // a quad that ends on the edge between the first and second columns of
+    // tiles, at a depth of one half
+    rndr::Occluder quad;
+    buildQuad( quad, -1.0f, -1.0f, columnX( culler, TILE ), 1.0f, 0.0f );
+
+    culler.begin( glm::mat4( 1.0f ) );
+    culler.addOccluder( quad, glm::mat4( 1.0f ) );
+    culler.rasterize();
+
+    uint32 wrong = 0;
+    for ( uint32 y = 0; y < culler.height(); ++y )
+    {
+        for ( uint32 x = 0; x < culler.width(); ++x )
+        {
+            float expected = x < TILE ? 0.5f : 1.0f;
+            wrong += std::abs( culler.depth( 0, x, y ) - expected ) >
+                     DEPTH_TOLERANCE ? 1 : 0;
+        }
+    }
+    DEMO_CHECK( checker, wrong == 0 );
+
+    // every texel holds the farthest depth of the texels below it, including
+    // those reduced across tiles
+    uint32 width = culler.width();
+    uint32 height = culler.height();
+    wrong = 0;
+    for ( uint32 level = 1; level < culler.levelCount(); ++level )
+    {
+        uint32 coarseWidth = ( width + 1 ) / 2;
+        uint32 coarseHeight = ( height + 1 ) / 2;
+        for ( uint32 y = 0; y < coarseHeight; ++y )
+        {
+            for ( uint32 x = 0; x < coarseWidth; ++x )
+            {
+                uint32 right = std::min( x * 2 + 1, width - 1 );
+                uint32 top = std::min( y * 2 + 1, height - 1 );
+                float farthest = std::max(
+                    std::max( culler.depth( level - 1, x * 2, y * 2 ),
+                              culler.depth( level - 1, right, y * 2 ) ),
+                    std::max( culler.depth( level - 1, x * 2, top ),
+                              culler.depth( level - 1, right, top ) ) );
+                wrong += culler.depth( level, x, y ) != farthest ? 1 : 0;
+            }
+        }
+        width = coarseWidth;
+        height = coarseHeight;
+    }
+    DEMO_CHECK( checker, wrong == 0 );
+
+    // one texel per tile, and only the first column of tiles is covered
+    for ( uint32 row = 0; row < culler.height() / TILE; ++row )
+    {
+        DEMO_CHECK( checker, std::abs( culler.depth( tileLevel, 0, row ) -
+                                       0.5f ) <= DEPTH_TOLERANCE );
+        DEMO_CHECK( checker, culler.depth( tileLevel, 1, row ) == 1.0f );
+    }
+    DEMO_CHECK( checker,
+                culler.depth( culler.levelCount() - 1, 0, 0 ) == 1.0f );
+
+    // boxes behind the quad up to the edge are hidden, and boxes that reach
+    // past it are not
+    DEMO_CHECK( checker, isPixelBoxHidden( culler, 20.0f, 40.0f, 30.0f,
+                                           50.0f, 0.5f ) );
+    DEMO_CHECK( checker, isPixelBoxHidden( culler, 28.0f, 40.0f, 31.9f,
+                                           50.0f, 0.5f ) );
+    DEMO_CHECK( checker, !isPixelBoxHidden( culler, 28.0f, 40.0f, 36.0f,
+                                            50.0f, 0.5f ) );
+    DEMO_CHECK( checker, !isPixelBoxHidden( culler, 28.0f, 40.0f, 32.0f,
+                                            50.0f, 0.5f ) );
+    DEMO_CHECK( checker, !isPixelBoxHidden( culler, 20.0f, 40.0f, 30.0f,
+                                            50.0f, -0.5f ) );
+
+    // a quad over four columns of tiles, tested with boxes large enough to
+    // reach the levels reduced across tiles
+    buildQuad( quad, -1.0f, -1.0f, columnX( culler, TILE * 4 ), 1.0f, 0.0f );
+
+    culler.begin( glm::mat4( 1.0f ) );
+    culler.addOccluder( quad, glm::mat4( 1.0f ) );
+    culler.rasterize();
+
+    DEMO_CHECK( checker, isPixelBoxHidden( culler, 4.0f, 40.0f, 124.0f,
+                                           50.0f, 0.5f ) );
+    DEMO_CHECK( checker, !isPixelBoxHidden( culler, 4.0f, 40.0f, 132.0f,
+                                            50.0f, 0.5f ) );
+    DEMO_CHECK( checker, !isPixelBoxHidden( culler, 4.0f, 4.0f, 252.0f,
+                                            124.0f, 0.5f ) );
+}
+
+/**
+ * Adds a pseudo-random triangle as described by
+ * util::SimdKernels::rasterizeDepth, at a pseudo-random tilted depth.
+ */
+void addTriangle( cntr::DynamicArray<float>& triangles, uint32 width,
+                  uint32 height, uint64 seed )
+{
+    float x[3];
+    float y[3];
+    for ( uint32 i = 0; i < 3; ++i )
+    {
+        x[i] = ( random( seed + i * 2 ) * 1.4f - 0.2f ) * width;
+        y[i] = ( random( seed + i * 2 + 1 ) * 1.4f - 0.2f ) * height;
+    }
+
+    double area = ( static_cast<double>( x[1] ) - x[0] ) * ( y[2] - y[0] ) -
+                  ( static_cast<double>( x[2] ) - x[0] ) * ( y[1] - y[0] );
+    if ( area == 0.0 )
+    {
+        return;
+    }
+    else if ( area < 0.0 )
+    {
+        std::swap( x[1], x[2] );
+        std::swap( y[1], y[2] );
+    }
+
+    float first[2] = { std::max( std::ceil(
+                           std::min( x[0], std::min( x[1], x[2] ) ) - 0.5f ),
+                           0.0f ),
+                       std::max( std::ceil(
+                           std::min( y[0], std::min( y[1], y[2] ) ) - 0.5f ),
+                           0.0f ) };
+    float last[2] = { std::min( std::floor(
+                          std::max( x[0], std::max( x[1], x[2] ) ) - 0.5f ),
+                          width - 1.0f ),
+                      std::min( std::floor(
+                          std::max( y[0], std::max( y[1], y[2] ) ) - 0.5f ),
+                          height - 1.0f ) };
+    if ( first[0] > last[0] || first[1] > last[1] )
+    {
+        return;
+    }
+
+    for ( uint32 edge = 0; edge < 3; ++edge )
+    {
+        uint32 i = ( edge + 1 ) % 3;
+        uint32 j = ( edge + 2 ) % 3;
+        float dx = x[j] - x[i];
+        float dy = y[j] - y[i];
+        triangles.push( -dy );
+        triangles.push( dx );
+        triangles.push( dy * x[i] - dx * y[i] );
+    }
+
+    // a plane that stays inside 0 to 1 over the buffer
+    triangles.push( ( random( seed + 6 ) - 0.5f ) * 0.25f / width );
+    triangles.push( ( random( seed + 7 ) - 0.5f ) * 0.25f / height );
+    triangles.push( 0.25f + random( seed + 8 ) * 0.5f );
+
+    triangles.push( first[0] );
+    triangles.push( first[1] );
+    triangles.push( last[0] );
+    triangles.push( last[1] );
+}
+
+/**
+ * Checks that every SIMD tier rasterizes the same depths and hides the same
+ * boxes as the scalar one.
+ */
+void checkTiers( Checker& checker )
+{
+    // the rasterizer itself, over the whole buffer and unaligned rectangles
+    const uint32 WIDTH = rndr::OcclusionCuller::DEFAULT_WIDTH;
+    const uint32 HEIGHT = rndr::OcclusionCuller::DEFAULT_HEIGHT;
+
+    cntr::DynamicArray<float> triangles;
+    for ( uint32 i = 0; i < RANDOM_TRIANGLES; ++i )
+    {
+        addTriangle( triangles, WIDTH, HEIGHT, i * 16 );
+    }
+
+    cntr::DynamicArray<uint32> indices;
+    for ( uint32 i = 0;
+          i < triangles.size() / util::SimdKernels::TRIANGLE_COMPONENTS;
+          ++i )
+    {
+        indices.push( i );
+    }
+
+    const util::Dispatch<util::SimdKernels::RasterizeDepthFn>& dispatch =
+        util::SimdKernels::rasterizeDepthDispatch();
+    const uint32 RECTS[][4] = { { 0, 0, WIDTH, HEIGHT },
+                                { 32, 32, 64, 64 },
+                                { 8, 5, 200, 77 } };
+
+    cntr::DynamicArray<float> expected;
+    cntr::DynamicArray<float> actual;
+    for ( uint32 i = 0; i < WIDTH * HEIGHT; ++i )
+    {
+        expected.push( 1.0f );
+        actual.push( 1.0f );
+    }
+
+    for ( uint32 rect = 0; rect < sizeof( RECTS ) / sizeof( RECTS[0] );
+          ++rect )
+    {
+        std::fill( &expected[0], &expected[0] + expected.size(), 1.0f );
+        dispatch.at( util::CpuFeatures::TIER_SCALAR )(
+            &expected[0], WIDTH, RECTS[rect], &triangles[0], &indices[0],
+            indices.size() );
+
+        for ( uint32 tier = util::CpuFeatures::TIER_SCALAR + 1;
+              tier <= util::CpuFeatures::supportedTier();
+              ++tier )
+        {
+            util::SimdKernels::RasterizeDepthFn rasterize = dispatch.at(
+                static_cast<util::CpuFeatures::Tier>( tier ) );
+            if ( rasterize == nullptr )
+            {
+                continue;
+            }
+
+            std::fill( &actual[0], &actual[0] + actual.size(), 1.0f );
+            rasterize( &actual[0], WIDTH, RECTS[rect], &triangles[0],
+                       &indices[0], indices.size() );
+
+            uint32 wrong = 0;
+            for ( uint32 i = 0; i < actual.size(); ++i )
+            {
+                wrong += std::abs( actual[i] - expected[i] ) >
+                         DEPTH_TOLERANCE ? 1 : 0;
+            }
+            DEMO_CHECK( checker, wrong == 0 );
+        }
+    }
+
+    // the whole culler, with tilted quads in front of the camera
+    cntr::DynamicArray<rndr::Occluder> quads;
+    for ( uint32 i = 0; i < RANDOM_OCCLUDERS; ++i )
+    {
+        uint64 seed = 100000 + i * 8;
+        glm::vec3 center( random( seed ) * 40.0f - 20.0f,
+                          random( seed + 1 ) * 20.0f - 10.0f,
+                          -10.0f - random( seed + 2 ) * 40.0f );
+        float size = 1.0f + random( seed + 3 ) * 4.0f;
+        float tilt = random( seed + 4 ) * 4.0f - 2.0f;
+
+        rndr::Occluder quad;
+        buildQuad( quad,
+                   center + glm::vec3( -size, -size, -tilt ),
+                   center + glm::vec3( size, -size, tilt ),
+                   center + glm::vec3( size, size, tilt ),
+                   center + glm::vec3( -size, size, -tilt ) );
+        quads.push( quad );
+    }
+
+    rndr::OcclusionCuller culler;
+    util::ThreadPool threadPool( 3 );
+    bool isHidden[2][RANDOM_BOXES];
+    for ( uint32 pass = 0; pass < 2; ++pass )
+    {
+        // the scalar tier alone and then the best one, on several threads
+        util::CpuFeatures::setForceScalar( pass == 0 );
+        culler.setThreadPool( pass == 0 ? nullptr : &threadPool );
+
+        culler.begin( perspective() );
+        for ( uint32 i = 0; i < quads.size(); ++i )
+        {
+            culler.addOccluder( quads[i], glm::mat4( 1.0f ) );
+        }
+        culler.rasterize();
+
+        for ( uint32 i = 0; i < RANDOM_BOXES; ++i )
+        {
+            uint64 seed = 200000 + i * 8;
+            glm::vec3 center( random( seed ) * 80.0f - 40.0f,
+                              random( seed + 1 ) * 40.0f - 20.0f,
+                              -1.0f - random( seed + 2 ) * 90.0f );
+            glm::vec3 extents( random( seed + 3 ) * 2.0f,
+                               random( seed + 4 ) * 2.0f,
+                               random( seed + 5 ) * 2.0f );
+            isHidden[pass][i] = culler.isHidden( center, extents );
+        }
+    }
+    util::CpuFeatures::setForceScalar( false );
+
+    uint32 hiddenCount = 0;
+    uint32 wrong = 0;
+    for ( uint32 i = 0; i < RANDOM_BOXES; ++i )
+    {
+        hiddenCount += isHidden[0][i] ? 1 : 0;
+        wrong += isHidden[0][i] != isHidden[1][i] ? 1 : 0;
+    }
+    DEMO_CHECK( checker, hiddenCount > 0 && hiddenCount < RANDOM_BOXES );
+    DEMO_CHECK( checker, wrong == 0 );
+}
+
+} // End nspc anonymous
+
+// UTILITY FUNCTIONS
+void OcclusionTest::run( Checker& checker )
+{
+    checker.setSuite( "occlusion" );
+
+    checkQuad( checker );
+    checkTileEdges( checker );
+    checkTiers( checker );
+}
+
+} // End nspc test
+
+} // End nspc demo
@@ -0,0 +1,36 @@
+// occlusion_test.h
+//
+// Checks that the occlusion culler hides what is behind its occluders and
+// nothing else.
+//
+// The checks need no GPU. They cover boxes behind, in front of and through
+// the near plane of an occluder quad, boxes at the edges of the tiles the
+// depth buffer is rasterized in, and every SIMD tier of the rasterizer
+// against the scalar one.
+//
+#ifndef DEMO_TEST_OCCLUSION_TEST_H
+#define DEMO_TEST_OCCLUSION_TEST_H
+
+#include "checker.h"
+
+namespace demo
+{
+
+namespace test
+{
+
+class OcclusionTest
+{
+  public:
+    // UTILITY FUNCTIONS
+    /**
+     * Runs every occlusion culling check.
+     */
+    static void run( Checker& checker );
+};
+
+} // End nspc test
+
+} // End nspc demo
+
+#endif // DEMO_TEST_OCCLUSION_TEST_H